@@ -20,19 +20,191 @@
 
 // Slicer includes
 #include "vtkSlicerApplicationLogic.h"
+#include "vtkSlicerTask.h"
 #include "vtkMRMLCoreTestingMacros.h"
 #include "vtkSlicerConfigure.h"
 
 // Slicer MRML includes
+#include "vtkMRMLAbstractLogic.h"
 #include "vtkMRMLScene.h"
 #include "vtkMRMLModelHierarchyNode.h"
 
 // VTK includes
 #include <vtkNew.h>
+#include <vtkObjectFactory.h>
+
+// STD includes
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+// Logic that records the order and concurrency of the tasks it executes.
+class vtkTestTaskLogic : public vtkMRMLAbstractLogic
+{
+public:
+  static vtkTestTaskLogic* New();
+  vtkTypeMacro(vtkTestTaskLogic, vtkMRMLAbstractLogic);
+
+  /// Task function, client data is the ID of the task.
+  /// Task with ID 0 does not return until ReleaseBlockingTask() is called.
+  void RunTask(void* clientData)
+  {
+    int taskId = static_cast<int>(reinterpret_cast<intptr_t>(clientData));
+    int numberOfRunningTasks = ++this->NumberOfRunningTasks;
+    int maximumNumberOfRunningTasks = this->MaximumNumberOfRunningTasks;
+    while (numberOfRunningTasks > maximumNumberOfRunningTasks
+      && !this->MaximumNumberOfRunningTasks.compare_exchange_weak(maximumNumberOfRunningTasks, numberOfRunningTasks))
+    {
+    }
+    if (taskId == 0)
+    {
+      this->BlockingTaskStarted = true;
+      while (!this->BlockingTaskReleased)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      }
+    }
+    else
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    --this->NumberOfRunningTasks;
+    std::lock_guard<std::mutex> lock(this->ExecutionOrderMutex);
+    this->ExecutionOrder.push_back(taskId);
+  }
+
+  void ScheduleTask(vtkSlicerApplicationLogic* appLogic, int taskId, int priority)
+  {
+    vtkNew<vtkSlicerTask> task;
+    task->SetTypeToProcessing();
+    task->SetPriority(priority);
+    task->SetTaskFunction(this, (vtkSlicerTask::TaskFunctionPointer)&vtkTestTaskLogic::RunTask,
+      reinterpret_cast<void*>(static_cast<intptr_t>(taskId)));
+    appLogic->ScheduleTask(task);
+  }
+
+  /// Wait until the given number of tasks are completed (or timeout).
+  std::vector<int> WaitForTasks(size_t numberOfTasks)
+  {
+    for (int i = 0; i < 1000; ++i)
+    {
+      {
+        std::lock_guard<std::mutex> lock(this->ExecutionOrderMutex);
+        if (this->ExecutionOrder.size() >= numberOfTasks)
+        {
+          return this->ExecutionOrder;
+        }
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::lock_guard<std::mutex> lock(this->ExecutionOrderMutex);
+    return this->ExecutionOrder;
+  }
+
+  std::atomic<int> NumberOfRunningTasks{0};
+  std::atomic<int> MaximumNumberOfRunningTasks{0};
+  std::atomic<bool> BlockingTaskStarted{false};
+  std::atomic<bool> BlockingTaskReleased{false};
+
+protected:
+  vtkTestTaskLogic() = default;
+  ~vtkTestTaskLogic() override = default;
+
+  std::mutex ExecutionOrderMutex;
+  std::vector<int> ExecutionOrder;
+
+private:
+  vtkTestTaskLogic(const vtkTestTaskLogic&) = delete;
+  void operator=(const vtkTestTaskLogic&) = delete;
+};
+
+vtkStandardNewMacro(vtkTestTaskLogic);
+
+//-----------------------------------------------------------------------------
+int TestTaskPriority()
+{
+  vtkNew<vtkSlicerApplicationLogic> appLogic;
+  vtkNew<vtkMRMLScene> scene;
+  appLogic->SetMRMLScene(scene);
+  appLogic->SetNumberOfProcessingThreads(1);
+  CHECK_INT(appLogic->GetNumberOfProcessingThreads(), 1);
+  appLogic->CreateProcessingThread();
+
+  vtkNew<vtkTestTaskLogic> taskLogic;
+
+  // Keep the only processing thread busy while the other tasks are scheduled
+  taskLogic->ScheduleTask(appLogic, 0, 0);
+  for (int i = 0; i < 1000 && !taskLogic->BlockingTaskStarted; ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  CHECK_BOOL(taskLogic->BlockingTaskStarted, true);
+
+  // Tasks with higher priority are executed first, tasks with the same
+  // priority are executed in the order they were scheduled.
+  taskLogic->ScheduleTask(appLogic, 1, 0);
+  taskLogic->ScheduleTask(appLogic, 2, 10);
+  taskLogic->ScheduleTask(appLogic, 3, 5);
+  taskLogic->ScheduleTask(appLogic, 4, 10);
+  taskLogic->ScheduleTask(appLogic, 5, -1);
+  taskLogic->BlockingTaskReleased = true;
+
+  std::vector<int> executionOrder = taskLogic->WaitForTasks(6);
+  CHECK_INT(static_cast<int>(executionOrder.size()), 6);
+  const int expectedExecutionOrder[6] = { 0, 2, 4, 3, 1, 5 };
+  for (int i = 0; i < 6; ++i)
+  {
+    CHECK_INT(executionOrder[i], expectedExecutionOrder[i]);
+  }
+  CHECK_INT(taskLogic->MaximumNumberOfRunningTasks, 1);
+
+  appLogic->TerminateProcessingThread();
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestNumberOfProcessingThreads()
+{
+  const int numberOfThreads = 3;
+  const int numberOfTasks = 12;
+
+  vtkNew<vtkSlicerApplicationLogic> appLogic;
+  vtkNew<vtkMRMLScene> scene;
+  appLogic->SetMRMLScene(scene);
+  appLogic->SetNumberOfProcessingThreads(numberOfThreads);
+  CHECK_INT(appLogic->GetNumberOfProcessingThreads(), numberOfThreads);
+  appLogic->CreateProcessingThread();
+
+  // Tasks run concurrently, but never more than the number of processing threads
+  vtkNew<vtkTestTaskLogic> taskLogic;
+  for (int taskId = 1; taskId <= numberOfTasks; ++taskId)
+  {
+    taskLogic->ScheduleTask(appLogic, taskId, 0);
+  }
+  std::vector<int> executionOrder = taskLogic->WaitForTasks(numberOfTasks);
+  CHECK_INT(static_cast<int>(executionOrder.size()), numberOfTasks);
+  CHECK_INT(taskLogic->MaximumNumberOfRunningTasks, numberOfThreads);
+  CHECK_INT(taskLogic->NumberOfRunningTasks, 0);
+
+  appLogic->TerminateProcessingThread();
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
 
 //-----------------------------------------------------------------------------
 int vtkSlicerApplicationLogicTest1(int , char * [])
 {
+  CHECK_EXIT_SUCCESS(TestTaskPriority());
+  CHECK_EXIT_SUCCESS(TestNumberOfProcessingThreads());
+
   //-----------------------------------------------------------------------------
   // Test GetModuleShareDirectory(const std::string& moduleName, const std::string& filePath);
   //-----------------------------------------------------------------------------
@@ -12,6 +12,7 @@
 
 // VTK includes
 #include <vtkCallbackCommand.h>
+#include <vtkCollection.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 
@@ -22,6 +23,8 @@
 
 // STD includes
 #include <cassert>
+#include <string>
+#include <vector>
 
 #ifdef linux
 #include "unistd.h"
@@ -354,6 +357,7 @@ int vtkDataIOManagerLogic::QueueRead ( vtkMRMLNode *node )
        ( !(cm->GetEnableForceRedownload())) )
   {
     dnode->GetNthStorageNode(storageNodeIndex)->SetReadStateTransferDone();
+    cm->MarkCachedFileAsUsed ( dest );
     vtkDebugMacro("QueueRead: the destination file is there and we're not forceing redownload");
     return 1;
   }
@@ -384,113 +388,87 @@ int vtkDataIOManagerLogic::QueueRead ( vtkMRMLNode *node )
     return 0;
   }
 
-  //--- construct and add a record of the transfer
-  //--- which includes the ID of associated node
-  vtkNew<vtkDataTransfer> transfer0;
-  transfer0->SetTransferID ( this->GetDataIOManager()->GetUniqueTransferID() );
-  transfer0->SetTransferNodeID ( node->GetID() );
-  transfer0->SetSourceURI ( source );
-  transfer0->SetDestinationURI ( dest );
-  transfer0->SetHandler ( handler );
-  transfer0->SetTransferType ( vtkDataTransfer::RemoteDownload );
-  transfer0->SetTransferStatus ( vtkDataTransfer::Idle );
-  transfer0->SetCancelRequested ( 0 );
-  //--- Add the data transfer to the collection, and
-  //--- the resulting mrml call will trigger an event
-  //--- that causes GUI to refresh.
-  this->AddNewDataTransfer ( transfer0.GetPointer(), node );
+  //--- construct and add a record of the transfer of each file
+  //--- of the storage node, which includes the ID of associated node.
+  //--- All files are downloaded in one batch, so that the handler can
+  //--- download them in parallel.
+  vtkMRMLStorageNode *storageNode = dnode->GetNthStorageNode(storageNodeIndex);
+  std::vector<std::string> sources;
+  std::vector<std::string> destinations;
+  sources.emplace_back(source);
+  destinations.emplace_back(dest);
+  for (int n = 0; n < storageNode->GetNumberOfURIs(); n++)
+  {
+    const char *sourceN = storageNode->GetNthURI(n);
+    const char *destN = storageNode->GetNthFileName(n);
+    if (sourceN == nullptr || destN == nullptr)
+    {
+      continue;
+    }
+    sources.emplace_back(sourceN);
+    destinations.emplace_back(destN);
+  }
+
+  //--- the collection is deleted by ApplyTransfers
+  vtkCollection *transfers = vtkCollection::New();
+  for (size_t fileIndex = 0; fileIndex < sources.size(); fileIndex++)
+  {
+    vtkNew<vtkDataTransfer> transfer;
+    transfer->SetTransferID ( this->GetDataIOManager()->GetUniqueTransferID() );
+    transfer->SetTransferNodeID ( node->GetID() );
+    transfer->SetSourceURI ( sources[fileIndex].c_str() );
+    transfer->SetDestinationURI ( destinations[fileIndex].c_str() );
+    // use one handler for all files in the storage node
+    transfer->SetHandler ( handler );
+    transfer->SetTransferType ( vtkDataTransfer::RemoteDownload );
+    transfer->SetTransferStatus ( vtkDataTransfer::Idle );
+    transfer->SetCancelRequested ( 0 );
+    //--- Add the data transfer to the collection, and
+    //--- the resulting mrml call will trigger an event
+    //--- that causes GUI to refresh.
+    this->AddNewDataTransfer ( transfer.GetPointer(), node );
+    transfers->AddItem ( transfer.GetPointer() );
+  }
   this->GetDataIOManager()->InvokeEvent ( vtkDataIOManager::RefreshDisplayEvent );
 
   vtkDebugMacro("QueueRead: asynchronous enabled = " << this->GetDataIOManager()->GetEnableAsynchronousIO());
 
   if ( this->GetDataIOManager()->GetEnableAsynchronousIO() )
   {
-    vtkDebugMacro("QueueRead: Schedule an ASYNCHRONOUS data transfer");
+    vtkDebugMacro("QueueRead: Schedule an ASYNCHRONOUS data transfer of " << sources.size() << " files");
     //---
     //--- Schedule an ASYNCHRONOUS data transfer
     //---
     vtkNew<vtkSlicerTask> task;
     task->SetTypeToNetworking();
-    transfer0->SetTransferStatus ( vtkDataTransfer::Pending );
+    for (int i = 0; i < transfers->GetNumberOfItems(); i++)
+    {
+      vtkDataTransfer::SafeDownCast(transfers->GetItemAsObject(i))->SetTransferStatus ( vtkDataTransfer::Pending );
+    }
     task->SetTaskFunction(this, (vtkSlicerTask::TaskFunctionPointer)
-                          &vtkDataIOManagerLogic::ApplyTransfer, transfer0.GetPointer());
+                          &vtkDataIOManagerLogic::ApplyTransfers, transfers);
 
     // Schedule the transfer
     if ( ! this->GetApplicationLogic()->ScheduleTask( task.GetPointer() ) )
     {
-      transfer0->SetTransferStatus( vtkDataTransfer::CompletedWithErrors);
+      for (int i = 0; i < transfers->GetNumberOfItems(); i++)
+      {
+        vtkDataTransfer::SafeDownCast(transfers->GetItemAsObject(i))->SetTransferStatus( vtkDataTransfer::CompletedWithErrors);
+      }
+      transfers->Delete();
       return 0;
     }
   }
   else
   {
-    vtkDebugMacro("QueueRead: Schedule a SYNCHRONOUS data transfer");
+    vtkDebugMacro("QueueRead: Schedule a SYNCHRONOUS data transfer of " << sources.size() << " files");
     //---
     //--- Execute a SYNCHRONOUS data transfer
     //---
-    transfer0->SetTransferStatus( vtkDataTransfer::Running);
-    this->ApplyTransfer ( transfer0.GetPointer() );
-    transfer0->SetTransferStatus( vtkDataTransfer::Completed);
+    this->ApplyTransfers ( transfers );
     // now set the node's storage node state to ready
-    vtkDebugMacro("QueueRead: setting storage node state to transferdone: " << dnode->GetNthStorageNode(storageNodeIndex)->GetURI());
-    if (dnode->GetNthStorageNode(storageNodeIndex)->GetNumberOfURIs() == 0)
-    {
-      // done
-      dnode->GetNthStorageNode(storageNodeIndex)->SetReadStateTransferDone();
-    }
-  }
-//  this->DebugOff();
-
-  // loop over any other files in the storage node
-  for (int n = 0; n < dnode->GetNthStorageNode(storageNodeIndex)->GetNumberOfURIs(); n++)
-  {
-    const char *sourceN =  dnode->GetNthStorageNode(storageNodeIndex)->GetNthURI(n);
-    const char *destN = dnode->GetNthStorageNode(storageNodeIndex)->GetNthFileName(n);
-
-    vtkNew<vtkDataTransfer> transfer1;
-    transfer1->SetTransferID ( this->GetDataIOManager()->GetUniqueTransferID() );
-    transfer1->SetTransferNodeID ( node->GetID() );
-    transfer1->SetSourceURI ( sourceN );
-    transfer1->SetDestinationURI ( destN );
-    // use one handler for all files in the storage node
-    transfer1->SetHandler ( handler );
-    transfer1->SetTransferType ( vtkDataTransfer::RemoteDownload );
-    transfer1->SetTransferStatus ( vtkDataTransfer::Idle );
-    transfer1->SetCancelRequested ( 0 );
-    this->AddNewDataTransfer ( transfer1.GetPointer(), node );
-    this->GetDataIOManager()->InvokeEvent ( vtkDataIOManager::RefreshDisplayEvent );
-
-    if ( this->GetDataIOManager()->GetEnableAsynchronousIO() )
-    {
-      vtkDebugMacro("QueueRead: Schedule an ASYNCHRONOUS data transfer, n = " << n);
-      vtkNew<vtkSlicerTask> task;
-      task->SetTypeToNetworking();
-      transfer1->SetTransferStatus ( vtkDataTransfer::Pending );
-      task->SetTaskFunction(this, (vtkSlicerTask::TaskFunctionPointer)
-                            &vtkDataIOManagerLogic::ApplyTransfer, transfer1.GetPointer());
-
-      // Schedule the transfer
-      if ( ! this->GetApplicationLogic()->ScheduleTask( task.GetPointer() ) )
-      {
-        transfer1->SetTransferStatus( vtkDataTransfer::CompletedWithErrors);
-        return 0;
-      }
-    }
-    else
-    {
-      vtkDebugMacro("QueueRead: Schedule a SYNCHRONOUS data transfer, n = " << n);
-      transfer1->SetTransferStatus( vtkDataTransfer::Running);
-      this->ApplyTransfer ( transfer1.GetPointer() );
-      transfer1->SetTransferStatus( vtkDataTransfer::Completed);
-      // now set the node's storage node state to ready
-
-    }
-  }
-  if ( dnode->GetNthStorageNode(storageNodeIndex)->GetNumberOfURIs() > 0 &&
-       !this->GetDataIOManager()->GetEnableAsynchronousIO())
-  {
-    vtkDebugMacro("QueueRead: setting storage node state to transferdone after synchronous transfer of all files: " << dnode->GetNthStorageNode(storageNodeIndex)->GetURI());
-    dnode->GetNthStorageNode(storageNodeIndex)->SetReadStateTransferDone();
+    vtkDebugMacro("QueueRead: setting storage node state to transferdone after synchronous transfer of all files: " << storageNode->GetURI());
+    storageNode->SetReadStateTransferDone();
   }
 
   return 1;
@@ -667,6 +645,125 @@ int vtkDataIOManagerLogic::QueueWrite ( vtkMRMLNode *node )
 
 
 
+//----------------------------------------------------------------------------
+void vtkDataIOManagerLogic::ApplyTransfers( void *clientdata )
+{
+  //--- collection of data transfers is on the input
+  vtkCollection *transfers = reinterpret_cast < vtkCollection*> (clientdata);
+  if ( transfers == nullptr )
+  {
+    vtkErrorMacro ( "ApplyTransfers: No transfer target was found");
+    return;
+  }
+
+  //assume synchronous io if no data manager exists.
+  int asynchIO = 0;
+  vtkCacheManager *cm = nullptr;
+  vtkDataIOManager *iom = this->GetDataIOManager();
+  if (iom != nullptr)
+  {
+    asynchIO = iom->GetEnableAsynchronousIO();
+    cm = iom->GetCacheManager();
+  }
+
+  std::vector<vtkDataTransfer*> downloads;
+  std::vector<std::string> sources;
+  std::vector<std::string> destinations;
+  vtkURIHandler *handler = nullptr;
+  for (int i = 0; i < transfers->GetNumberOfItems(); i++)
+  {
+    vtkDataTransfer *dt = vtkDataTransfer::SafeDownCast( transfers->GetItemAsObject(i) );
+    if ( dt == nullptr || dt->GetTransferType() != vtkDataTransfer::RemoteDownload
+      || dt->GetHandler() == nullptr || dt->GetSourceURI() == nullptr || dt->GetDestinationURI() == nullptr )
+    {
+      vtkErrorMacro("ApplyTransfers: invalid data transfer, only downloads with handler, source, and destination are supported.");
+      continue;
+    }
+    if ( asynchIO && dt->GetTransferStatus() != vtkDataTransfer::Pending )
+    {
+      // cancelled
+      continue;
+    }
+    handler = dt->GetHandler();
+    downloads.push_back(dt);
+    sources.emplace_back(dt->GetSourceURI());
+    destinations.emplace_back(dt->GetDestinationURI());
+    if ( asynchIO )
+    {
+      dt->SetTransferStatusNoModify ( vtkDataTransfer::Running );
+      this->GetApplicationLogic()->RequestModified( dt );
+    }
+    else
+    {
+      dt->SetTransferStatus ( vtkDataTransfer::Running );
+    }
+  }
+
+  //---
+  //--- Download data
+  //---
+  std::vector<bool> succeeded(downloads.size(), false);
+  if ( handler != nullptr )
+  {
+    vtkDebugMacro("ApplyTransfers: stage " << sources.size() << " files read on the handler, first source = " << sources[0]);
+    handler->StageFilesRead( sources, destinations, &succeeded );
+  }
+  for (size_t fileIndex = 0; fileIndex < downloads.size(); fileIndex++)
+  {
+    vtkDataTransfer *dt = downloads[fileIndex];
+    int status = succeeded[fileIndex] ? vtkDataTransfer::Completed : vtkDataTransfer::CompletedWithErrors;
+    if ( asynchIO )
+    {
+      dt->SetTransferStatusNoModify ( status );
+      this->GetApplicationLogic()->RequestModified( dt );
+    }
+    else
+    {
+      dt->SetTransferStatus ( status );
+    }
+    if ( succeeded[fileIndex] && cm != nullptr )
+    {
+      cm->AddFileToCacheIndex( destinations[fileIndex].c_str() );
+    }
+  }
+
+  //--- all files of the storage node are transferred, read the node
+  if ( asynchIO && !downloads.empty() )
+  {
+    const char *source = sources[0].c_str();
+    vtkMRMLStorableNode *storableNode = vtkMRMLStorableNode::SafeDownCast(
+      this->GetMRMLScene()->GetNodeByID( downloads[0]->GetTransferNodeID() ) );
+    vtkMRMLStorageNode *storageNode = nullptr;
+    if ( storableNode != nullptr )
+    {
+      // find the storage node that's been scheduled and we're working on it
+      for (int i = 0; i < storableNode->GetNumberOfStorageNodes(); i++)
+      {
+        if (storableNode->GetNthStorageNode(i)->GetReadState() == vtkMRMLStorageNode::Transferring &&
+            strcmp(storableNode->GetNthStorageNode(i)->GetURI(), source) == 0)
+        {
+          storageNode = storableNode->GetNthStorageNode(i);
+          break;
+        }
+      }
+    }
+    if ( storageNode == nullptr )
+    {
+      vtkErrorMacro( "ApplyTransfers: no storage node found for scheduled data transfer of " << source );
+    }
+    else
+    {
+      storageNode->SetDisableModifiedEvent( 1 );
+      // let the storage node know that the remote transfer is done
+      storageNode->SetReadStateTransferDone();
+      storageNode->SetDisableModifiedEvent( 0 );
+      this->GetApplicationLogic()->RequestReadFile( storableNode->GetID(), destinations[0].c_str(), 0, 0 );
+    }
+  }
+
+  transfers->Delete();
+}
+
 //----------------------------------------------------------------------------
 void vtkDataIOManagerLogic::ApplyTransfer( void *clientdata )
 {
@@ -45,6 +45,13 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkDataIOManagerLogic : public vtkSlicerModul
   /// The method that executes the data transfer in another thread
   virtual void ApplyTransfer(void *clientdata);
 
+  ///
+  /// Downloads all files of a storage node in one batch, so that the URI handler
+  /// can download them in parallel. The storage node is read when all files are transferred.
+  /// The client data is a vtkCollection of vtkDataTransfer objects, which is deleted
+  /// by this method.
+  virtual void ApplyTransfers(void *clientdata);
+
   /// Description
   /// Communicates progress back to the DataIOManager
   static void ProgressCallback ( void * );
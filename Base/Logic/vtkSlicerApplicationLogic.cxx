@@ -40,6 +40,7 @@
 
 // STD includes
 #include <algorithm>
+#include <chrono>
 
 #ifdef ITK_USE_PTHREADS
 # include <unistd.h>
@@ -47,12 +48,13 @@
 # include <sys/resource.h>
 #endif
 
+#include <deque>
 #include <queue>
 
 #include "vtkSlicerApplicationLogicRequests.h"
 
 //----------------------------------------------------------------------------
-class ProcessingTaskQueue : public std::queue<vtkSmartPointer<vtkSlicerTask> > {};
+class ProcessingTaskQueue : public std::deque<vtkSmartPointer<vtkSlicerTask> > {};
 class ModifiedQueue : public std::queue<vtkSmartPointer<vtkObject> > {};
 class ReadDataQueue : public std::queue<DataRequest*> {};
 class WriteDataQueue : public std::queue<DataRequest*> {};
@@ -64,7 +66,7 @@ vtkStandardNewMacro(vtkSlicerApplicationLogic);
 vtkSlicerApplicationLogic::vtkSlicerApplicationLogic()
 {
   this->ProcessingThreader = itk::PlatformMultiThreader::New();
-  this->ProcessingThreadId = -1;
+  this->NumberOfProcessingThreads = 1;
   this->ProcessingThreadActive = false;
 
   this->ModifiedQueueActive = false;
@@ -88,17 +90,20 @@ vtkSlicerApplicationLogic::~vtkSlicerApplicationLogic()
   // Note that TerminateThread does not kill a thread, it only waits
   // for the thread to finish.  We need to signal the thread that we
   // want to terminate
-  if (this->ProcessingThreadId != -1 && this->ProcessingThreader)
+  if (!this->ProcessingThreadIDs.empty() && this->ProcessingThreader)
   {
-    // Signal the processingThread that we are terminating.
+    // Signal the processing threads that we are terminating.
     this->ProcessingThreadActiveLock.lock();
     this->ProcessingThreadActive = false;
     this->ProcessingThreadActiveLock.unlock();
+    this->NotifyProcessingThreads();
 
-    // Wait for the thread to finish and clean up the state of the threader
-    this->ProcessingThreader->TerminateThread( this->ProcessingThreadId );
-
-    this->ProcessingThreadId = -1;
+    // Wait for the threads to finish and clean up the state of the threader
+    for (int threadId : this->ProcessingThreadIDs)
+    {
+      this->ProcessingThreader->TerminateThread(threadId);
+    }
+    this->ProcessingThreadIDs.clear();
   }
 
   delete this->InternalTaskQueue;
@@ -169,17 +174,17 @@ void vtkSlicerApplicationLogic::PrintSelf(ostream& os, vtkIndent indent)
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::CreateProcessingThread()
 {
-  if (this->ProcessingThreadId == -1)
+  if (this->ProcessingThreadIDs.empty())
   {
     this->ProcessingThreadActiveLock.lock();
     this->ProcessingThreadActive = true;
+    for (int threadIndex = 0; threadIndex < this->NumberOfProcessingThreads; ++threadIndex)
+    {
+      this->ProcessingThreadIDs.push_back(this->ProcessingThreader
+        ->SpawnThread(vtkSlicerApplicationLogic::ProcessingThreaderCallback, this));
+    }
     this->ProcessingThreadActiveLock.unlock();
 
-    this->ProcessingThreadId
-      = this->ProcessingThreader
-      ->SpawnThread(vtkSlicerApplicationLogic::ProcessingThreaderCallback,
-                    this);
-
     // Start four network threads (TODO: make the number of threads a setting)
     this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
           ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
@@ -221,7 +226,7 @@ void vtkSlicerApplicationLogic::CreateProcessingThread()
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::TerminateProcessingThread()
 {
-  if (this->ProcessingThreadId != -1)
+  if (!this->ProcessingThreadIDs.empty())
   {
     this->ModifiedQueueActiveLock.lock();
     this->ModifiedQueueActive = false;
@@ -238,9 +243,13 @@ void vtkSlicerApplicationLogic::TerminateProcessingThread()
     this->ProcessingThreadActiveLock.lock();
     this->ProcessingThreadActive = false;
     this->ProcessingThreadActiveLock.unlock();
+    this->NotifyProcessingThreads();
 
-    this->ProcessingThreader->TerminateThread( this->ProcessingThreadId );
-    this->ProcessingThreadId = -1;
+    for (int threadId : this->ProcessingThreadIDs)
+    {
+      this->ProcessingThreader->TerminateThread(threadId);
+    }
+    this->ProcessingThreadIDs.clear();
 
     std::vector<int>::const_iterator idIterator;
     idIterator = this->NetworkingThreadIDs.begin();
@@ -268,58 +277,71 @@ vtkSlicerApplicationLogic::ProcessingThreaderCallback(void* arg)
   appLogic->SetCurrentThreadPriorityToBackground();
 
   // Start background processing tasks in this thread
-  appLogic->ProcessProcessingTasks();
+  appLogic->ProcessProcessingTasks(((itk::PlatformMultiThreader::WorkUnitInfo*)(arg))->WorkUnitID);
 
   return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
 }
 
 //----------------------------------------------------------------------------
-void vtkSlicerApplicationLogic::ProcessProcessingTasks()
+void vtkSlicerApplicationLogic::ProcessProcessingTasks(int threadId)
 {
   int active = true;
   vtkSmartPointer<vtkSlicerTask> task = nullptr;
 
   while (active)
   {
-    // Check to see if we should be shutting down
+    // Check to see if we should be shutting down, and if this thread
+    // is within the requested number of processing threads
     this->ProcessingThreadActiveLock.lock();
     active = this->ProcessingThreadActive;
+    std::vector<int>::iterator threadIt =
+      std::find(this->ProcessingThreadIDs.begin(), this->ProcessingThreadIDs.end(), threadId);
+    bool enabled = (threadIt - this->ProcessingThreadIDs.begin()) < this->NumberOfProcessingThreads;
     this->ProcessingThreadActiveLock.unlock();
 
-    if (active)
+    if (!active)
     {
-      // pull a task off the queue
-      this->ProcessingTaskQueueLock.lock();
-      if ((*this->InternalTaskQueue).size() > 0)
-      {
-        // std::cout << "Number of queued tasks: " << (*this->InternalTaskQueue).size() << std::endl;
+      break;
+    }
 
-        // only handle processing tasks in this thread
-        task = (*this->InternalTaskQueue).front();
-        if ( task->GetType() == vtkSlicerTask::Processing )
-        {
-          (*this->InternalTaskQueue).pop();
-        }
-        else
-        {
-          task = nullptr;
-        }
+    {
+      // pull a processing task off the queue
+      std::unique_lock<std::mutex> queueLock(this->ProcessingTaskQueueLock);
+      if (enabled)
+      {
+        task = this->PopTask(vtkSlicerTask::Processing);
       }
-      this->ProcessingTaskQueueLock.unlock();
-
-      // process the task (should this be in a separate thread?)
-      if (task)
+      if (!task)
       {
-        task->Execute();
-        task = nullptr;
+        // Wait until a task is scheduled or the threads are reconfigured or terminated.
+        // The active flag is checked again while holding the queue lock so that
+        // a notification sent after the check above is not missed.
+        this->ProcessingThreadActiveLock.lock();
+        active = this->ProcessingThreadActive;
+        this->ProcessingThreadActiveLock.unlock();
+        if (active)
+        {
+          this->ProcessingTaskQueueCondition.wait_for(queueLock, std::chrono::milliseconds(500));
+        }
+        continue;
       }
     }
 
-    // busy wait
-    itksys::SystemTools::Delay(100);
+    task->Execute();
+    task = nullptr;
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::NotifyProcessingThreads()
+{
+  // Acquire the queue lock so that a processing thread cannot be between
+  // checking its state and starting to wait when the notification is sent.
+  this->ProcessingTaskQueueLock.lock();
+  this->ProcessingTaskQueueLock.unlock();
+  this->ProcessingTaskQueueCondition.notify_all();
+}
+
 itk::ITK_THREAD_RETURN_TYPE
 vtkSlicerApplicationLogic::NetworkingThreaderCallback(void* arg)
 {
@@ -353,21 +375,9 @@ void vtkSlicerApplicationLogic::ProcessNetworkingTasks()
 
     if (active)
     {
-      // pull a task off the queue
+      // pull a networking task off the queue
       this->ProcessingTaskQueueLock.lock();
-      if ((*this->InternalTaskQueue).size() > 0)
-      {
-        // std::cout << "Number of queued tasks: " << (*this->InternalTaskQueue).size() << std::endl;
-        task = (*this->InternalTaskQueue).front();
-        if ( task->GetType() == vtkSlicerTask::Networking )
-        {
-          (*this->InternalTaskQueue).pop();
-        }
-        else
-        {
-          task = nullptr;
-        }
-      }
+      task = this->PopTask(vtkSlicerTask::Networking);
       this->ProcessingTaskQueueLock.unlock();
 
       // process the task (should this be in a separate thread?)
@@ -383,6 +393,55 @@ void vtkSlicerApplicationLogic::ProcessNetworkingTasks()
   }
 }
 
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkSlicerTask> vtkSlicerApplicationLogic::PopTask(int taskType)
+{
+  ProcessingTaskQueue::iterator taskIt = std::find_if(
+    (*this->InternalTaskQueue).begin(), (*this->InternalTaskQueue).end(),
+    [taskType](const vtkSmartPointer<vtkSlicerTask>& queuedTask) { return queuedTask->GetType() == taskType; });
+  if (taskIt == (*this->InternalTaskQueue).end())
+  {
+    return nullptr;
+  }
+  vtkSmartPointer<vtkSlicerTask> task = *taskIt;
+  (*this->InternalTaskQueue).erase(taskIt);
+  return task;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::SetNumberOfProcessingThreads(int numberOfThreads)
+{
+  // Processing and networking threads share the slots of the threader
+  numberOfThreads = std::max(1, std::min(numberOfThreads, ITK_MAX_THREADS / 2));
+  {
+    std::lock_guard<std::mutex> lock(this->ProcessingThreadActiveLock);
+    if (numberOfThreads == this->NumberOfProcessingThreads)
+    {
+      return;
+    }
+    this->NumberOfProcessingThreads = numberOfThreads;
+    if (this->ProcessingThreadActive)
+    {
+      // Add threads if there are not enough, extra threads just stay idle
+      while (static_cast<int>(this->ProcessingThreadIDs.size()) < numberOfThreads)
+      {
+        this->ProcessingThreadIDs.push_back(this->ProcessingThreader
+          ->SpawnThread(vtkSlicerApplicationLogic::ProcessingThreaderCallback, this));
+      }
+    }
+  }
+  // Wake up idle threads that became enabled
+  this->NotifyProcessingThreads();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerApplicationLogic::GetNumberOfProcessingThreads()
+{
+  std::lock_guard<std::mutex> lock(this->ProcessingThreadActiveLock);
+  return this->NumberOfProcessingThreads;
+}
+
 //----------------------------------------------------------------------------
 int vtkSlicerApplicationLogic::ScheduleTask( vtkSlicerTask *task )
 {
@@ -395,9 +454,15 @@ int vtkSlicerApplicationLogic::ScheduleTask( vtkSlicerTask *task )
     return false;
   }
 
+  // Insert the task after all tasks that have the same or higher priority
   this->ProcessingTaskQueueLock.lock();
-  (*this->InternalTaskQueue).push( task );
+  int priority = task->GetPriority();
+  ProcessingTaskQueue::iterator insertIt = std::find_if(
+    (*this->InternalTaskQueue).begin(), (*this->InternalTaskQueue).end(),
+    [priority](const vtkSmartPointer<vtkSlicerTask>& queuedTask) { return queuedTask->GetPriority() < priority; });
+  (*this->InternalTaskQueue).insert(insertIt, task);
   this->ProcessingTaskQueueLock.unlock();
+  this->ProcessingTaskQueueCondition.notify_all();
   return true;
 }
 
@@ -654,6 +719,21 @@ void vtkSlicerApplicationLogic::ProcessReadData()
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::ProcessPendingReadData()
+{
+  // Requests are processed in the order they were added, therefore processing
+  // as many requests as there are in the queue now processes exactly the pending
+  // requests, even if other threads keep adding new requests meanwhile.
+  this->ReadDataQueueLock.lock();
+  size_t numberOfPendingRequests = (*this->InternalReadDataQueue).size();
+  this->ReadDataQueueLock.unlock();
+  for (size_t requestIndex = 0; requestIndex < numberOfPendingRequests; ++requestIndex)
+  {
+    this->ProcessReadData();
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::ProcessWriteData()
 {
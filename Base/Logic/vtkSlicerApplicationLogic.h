@@ -26,11 +26,13 @@
 
 // VTK includes
 #include <vtkCollection.h>
+#include <vtkSmartPointer.h>
 
 // ITK includes
 #include <itkPlatformMultiThreader.h>
 
 // STL includes
+#include <condition_variable>
 #include <mutex>
 
 class vtkMRMLSelectionNode;
@@ -68,11 +70,18 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
                           vtkDataIOManagerLogic *dataIOManagerLogic);
 
 
-  /// Create a thread for processing
+  /// Create the threads for processing
   void CreateProcessingThread();
 
-  /// Shutdown the processing thread
+  /// Shutdown the processing threads
   void TerminateProcessingThread();
+
+  /// Set the number of threads that run processing tasks concurrently (default: 1).
+  /// If the processing threads are already running then the new value is applied immediately:
+  /// threads are added as needed, and threads above the new count finish their
+  /// current task and then stay idle.
+  void SetNumberOfProcessingThreads(int numberOfThreads);
+  int GetNumberOfProcessingThreads();
   /// List of events potentially fired by the application logic
   enum RequestEvents
   {
@@ -89,6 +98,7 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
   /// Schedule a task to run in the processing thread. Returns true if
   /// task was successfully scheduled. ScheduleTask() is called from the
   /// main thread to run something in the processing thread.
+  /// Tasks are started in the order of their priority (see vtkSlicerTask::SetPriority()).
   int ScheduleTask( vtkSlicerTask* );
 
   /// Request a Modified call on an object.  This method allows a
@@ -178,6 +188,12 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
   /// which can force a render.
   void ProcessReadData();
 
+  /// Process all the requests that are in the read data queue when this method
+  /// is called. Requests that are added to the queue while processing (for example
+  /// by other processing threads) are left for later calls of ProcessReadData().
+  /// Must be called from the main thread.
+  void ProcessPendingReadData();
+
   /// Process a request to write data from a referenced node.
   void ProcessWriteData();
 
@@ -233,8 +249,17 @@ protected:
    /// Callback used by a MultiThreader to start a networking thread
   static itk::ITK_THREAD_RETURN_TYPE NetworkingThreaderCallback( void * );
 
-  /// Task processing loop that is run in the processing thread
-  void ProcessProcessingTasks();
+  /// Task processing loop that is run in a processing thread
+  /// \param threadId ID of the processing thread, as returned by SpawnThread
+  void ProcessProcessingTasks(int threadId);
+
+  /// Remove the first task of the given type from the queue.
+  /// Returns nullptr if there is no such task. The caller must hold ProcessingTaskQueueLock.
+  vtkSmartPointer<vtkSlicerTask> PopTask(int taskType);
+
+  /// Wake up processing threads that are waiting for a task.
+  /// The caller must not hold ProcessingTaskQueueLock.
+  void NotifyProcessingThreads();
 
   /// Networking Task processing loop that is run in a networking thread
   void ProcessNetworkingTasks();
@@ -259,6 +284,8 @@ private:
   itk::PlatformMultiThreader::Pointer ProcessingThreader;
   std::mutex ProcessingThreadActiveLock;
   std::mutex ProcessingTaskQueueLock;
+  /// Notified when a task is added to the queue or the processing threads are reconfigured
+  std::condition_variable ProcessingTaskQueueCondition;
   std::mutex ModifiedQueueActiveLock;
   std::mutex ModifiedQueueLock;
   std::mutex ReadDataQueueActiveLock;
@@ -266,7 +293,8 @@ private:
   std::mutex WriteDataQueueActiveLock;
   std::mutex WriteDataQueueLock;
   vtkTimeStamp RequestTimeStamp;
-  int ProcessingThreadId;
+  std::vector<int> ProcessingThreadIDs;
+  int NumberOfProcessingThreads;
   std::vector<int> NetworkingThreadIDs;
   int ProcessingThreadActive;
   int ModifiedQueueActive;
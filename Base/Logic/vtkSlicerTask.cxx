@@ -13,6 +13,7 @@ vtkSlicerTask::vtkSlicerTask()
   this->TaskFunction = nullptr;
   this->TaskClientData = nullptr;
   this->Type = vtkSlicerTask::Undefined;
+  this->Priority = 0;
 }
 //----------------------------------------------------------------------------
 vtkSlicerTask::~vtkSlicerTask() = default;
@@ -40,4 +41,6 @@ void vtkSlicerTask::Execute()
 void vtkSlicerTask::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "Type: " << this->GetTypeAsString() << "\n";
+  os << indent << "Priority: " << this->Priority << "\n";
 }
@@ -48,6 +48,13 @@ public:
     return "Unknown";
   }
 
+  ///
+  /// Priority of the task. Tasks with higher priority are started first,
+  /// tasks with the same priority are started in the order they were scheduled.
+  /// Default is 0.
+  vtkSetMacro(Priority, int);
+  vtkGetMacro(Priority, int);
+
 protected:
   vtkSlicerTask();
   ~vtkSlicerTask() override;
@@ -60,6 +67,7 @@ private:
   void *TaskClientData;
 
   int Type;
+  int Priority;
 
 };
 #endif
@@ -28,15 +28,18 @@
 #include <vtkMRMLROIListNode.h>
 #include <vtkMRMLStorageNode.h>
 #include <vtkMRMLModelStorageNode.h>
+#include <vtkMRMLTraceLogger.h>
 #include <vtkMRMLTransformNode.h>
 
 // VTK includes
 #include <vtkCallbackCommand.h>
+#include <vtkCollection.h>
 #include <vtkIntArray.h>
 #include <vtkMultiThreader.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkStringArray.h>
+#include <vtkTimerLog.h>
 #include <vtksys/SystemTools.hxx>
 
 // ITKSYS includes
@@ -46,11 +49,15 @@
 
 // STL includes
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <ctime>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <random>
 #include <set>
+#include <thread>
 
 #ifdef _WIN32
 #else
@@ -85,8 +92,13 @@ public:
   }
   void Execute(vtkObject* caller, unsigned long eid, void *callData) override
   {
-    if (std::find(this->ThreadIDs.begin(), this->ThreadIDs.end(),
-                  vtkMultiThreader::GetCurrentThreadID()) != this->ThreadIDs.end())
+    bool reschedule = false;
+    {
+      std::lock_guard<std::mutex> lock(this->ThreadIDsMutex);
+      reschedule = (std::find(this->ThreadIDs.begin(), this->ThreadIDs.end(),
+        vtkMultiThreader::GetCurrentThreadID()) != this->ThreadIDs.end());
+    }
+    if (reschedule)
     {
       if (this->CLIModuleLogic)
       {
@@ -122,6 +134,7 @@ public:
     {
       return;
     }
+    std::lock_guard<std::mutex> lock(this->ThreadIDsMutex);
     if (reschedule)
     {
       this->ThreadIDs.push_back(id);
@@ -144,6 +157,7 @@ protected:
 
   vtkSlicerCLIModuleLogic* CLIModuleLogic;
   int Delay;
+  std::mutex ThreadIDsMutex;
   std::vector<vtkMultiThreaderIDType> ThreadIDs;
 };
 
@@ -185,6 +199,172 @@ public:
   ~vtkSlicerCLIOneShotCallbackCallback() override  = default;
 };
 
+//---------------------------------------------------------------------------
+// Stream buffer that forwards the output of each thread to the buffer that is
+// registered for that thread (or to the original buffer of the stream).
+// This allows capturing the output of shared object CLIs that run concurrently.
+class vtkSlicerCLIThreadStreamBuffer : public std::streambuf
+{
+public:
+  vtkSlicerCLIThreadStreamBuffer(std::streambuf* defaultBuffer)
+    : DefaultBuffer(defaultBuffer)
+  {
+  }
+
+  std::streambuf* GetDefaultBuffer()
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    return this->DefaultBuffer;
+  }
+
+  void SetDefaultBuffer(std::streambuf* buffer)
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->DefaultBuffer = buffer;
+  }
+
+  void SetThreadBuffer(std::streambuf* buffer)
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    if (buffer)
+    {
+      this->ThreadBuffers[std::this_thread::get_id()] = buffer;
+    }
+    else
+    {
+      this->ThreadBuffers.erase(std::this_thread::get_id());
+    }
+  }
+
+protected:
+  std::streambuf* GetBuffer()
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    std::map<std::thread::id, std::streambuf*>::iterator it = this->ThreadBuffers.find(std::this_thread::get_id());
+    return (it != this->ThreadBuffers.end()) ? it->second : this->DefaultBuffer;
+  }
+
+  int_type overflow(int_type c) override
+  {
+    if (traits_type::eq_int_type(c, traits_type::eof()))
+    {
+      return traits_type::not_eof(c);
+    }
+    std::streambuf* buffer = this->GetBuffer();
+    return buffer ? buffer->sputc(traits_type::to_char_type(c)) : traits_type::eof();
+  }
+
+  std::streamsize xsputn(const char* s, std::streamsize n) override
+  {
+    std::streambuf* buffer = this->GetBuffer();
+    return buffer ? buffer->sputn(s, n) : 0;
+  }
+
+  int sync() override
+  {
+    std::streambuf* buffer = this->GetBuffer();
+    return buffer ? buffer->pubsync() : -1;
+  }
+
+  std::streambuf* DefaultBuffer;
+  std::mutex Mutex;
+  std::map<std::thread::id, std::streambuf*> ThreadBuffers;
+};
+
+//---------------------------------------------------------------------------
+// Redirect std::cout and std::cerr of the current thread while the object exists.
+// The thread stream buffers are installed on the standard streams while
+// at least one redirection is active.
+class vtkSlicerCLIModuleStreamRedirection
+{
+public:
+  vtkSlicerCLIModuleStreamRedirection(std::streambuf* coutBuffer, std::streambuf* cerrBuffer)
+  {
+    std::lock_guard<std::mutex> lock(vtkSlicerCLIModuleStreamRedirection::GetMutex());
+    if (vtkSlicerCLIModuleStreamRedirection::GetNumberOfRedirections()++ == 0)
+    {
+      vtkSlicerCLIModuleStreamRedirection::InstallBuffer(std::cout, vtkSlicerCLIModuleStreamRedirection::GetCoutBuffer());
+      vtkSlicerCLIModuleStreamRedirection::InstallBuffer(std::cerr, vtkSlicerCLIModuleStreamRedirection::GetCerrBuffer());
+    }
+    vtkSlicerCLIModuleStreamRedirection::GetCoutBuffer()->SetThreadBuffer(coutBuffer);
+    vtkSlicerCLIModuleStreamRedirection::GetCerrBuffer()->SetThreadBuffer(cerrBuffer);
+  }
+
+  ~vtkSlicerCLIModuleStreamRedirection()
+  {
+    std::lock_guard<std::mutex> lock(vtkSlicerCLIModuleStreamRedirection::GetMutex());
+    std::cout.flush();
+    std::cerr.flush();
+    vtkSlicerCLIModuleStreamRedirection::GetCoutBuffer()->SetThreadBuffer(nullptr);
+    vtkSlicerCLIModuleStreamRedirection::GetCerrBuffer()->SetThreadBuffer(nullptr);
+    if (--vtkSlicerCLIModuleStreamRedirection::GetNumberOfRedirections() == 0)
+    {
+      vtkSlicerCLIModuleStreamRedirection::RestoreBuffer(std::cout, vtkSlicerCLIModuleStreamRedirection::GetCoutBuffer());
+      vtkSlicerCLIModuleStreamRedirection::RestoreBuffer(std::cerr, vtkSlicerCLIModuleStreamRedirection::GetCerrBuffer());
+    }
+  }
+
+protected:
+  static void InstallBuffer(std::ostream& stream, vtkSlicerCLIThreadStreamBuffer* threadBuffer)
+  {
+    if (stream.rdbuf() != threadBuffer)
+    {
+      threadBuffer->SetDefaultBuffer(stream.rdbuf());
+      stream.rdbuf(threadBuffer);
+    }
+  }
+  static void RestoreBuffer(std::ostream& stream, vtkSlicerCLIThreadStreamBuffer* threadBuffer)
+  {
+    // Only restore if nobody else replaced the stream buffer meanwhile
+    if (stream.rdbuf() == threadBuffer)
+    {
+      stream.rdbuf(threadBuffer->GetDefaultBuffer());
+    }
+  }
+  static std::mutex& GetMutex()
+  {
+    static std::mutex mutex;
+    return mutex;
+  }
+  static int& GetNumberOfRedirections()
+  {
+    static int numberOfRedirections = 0;
+    return numberOfRedirections;
+  }
+  // The thread stream buffers are never deleted: other threads may still be
+  // writing to them (through a stream buffer pointer they obtained before the
+  // original buffer was restored), they just forward to the original buffer.
+  static vtkSlicerCLIThreadStreamBuffer* GetCoutBuffer()
+  {
+    static vtkSlicerCLIThreadStreamBuffer* buffer = new vtkSlicerCLIThreadStreamBuffer(std::cout.rdbuf());
+    return buffer;
+  }
+  static vtkSlicerCLIThreadStreamBuffer* GetCerrBuffer()
+  {
+    static vtkSlicerCLIThreadStreamBuffer* buffer = new vtkSlicerCLIThreadStreamBuffer(std::cerr.rdbuf());
+    return buffer;
+  }
+};
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+// Environment variables are shared by all threads of the process, they must be
+// modified only while holding this lock (e.g., when starting a CLI process).
+std::mutex& GetProcessEnvironmentMutex()
+{
+  static std::mutex mutex;
+  return mutex;
+}
+
+//---------------------------------------------------------------------------
+// Tag of the CLI job that is executed in the current thread. It makes the names
+// of temporary files unique when multiple CLIs run concurrently.
+thread_local std::string CurrentJobTag;
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 class vtkSlicerCLIModuleLogic::vtkInternal
 {
@@ -195,8 +375,16 @@ public:
 
   int RedirectModuleStreams;
 
+  std::mutex RandomGeneratorMutex;
   std::default_random_engine RandomGenerator;
 
+  /// Counter for creating unique job tags
+  std::atomic<unsigned int> JobCounter{0};
+
+  /// Time when each scheduled CLI node was added to the processing queue
+  std::mutex ScheduleTimesMutex;
+  std::map<vtkMRMLCommandLineModuleNode*, double> ScheduleTimes;
+
   std::mutex ProcessesKillLock;
   std::vector<itksysProcess*> Processes;
 
@@ -517,10 +705,9 @@ vtkSlicerCLIModuleLogic
   // encoded to the same filename every time within that running
   // instance of Slicer).  This last point is an optimization to
   // minimize the number of times a file is written when running a
-  // module.  However, if we change the execution model such that more
-  // than one module can run at the same time within the same Slicer
-  // process, then this encoding will need to be changed to be unique
-  // per module execution.
+  // module. Since multiple modules can run at the same time within the
+  // same Slicer process, the tag of the current CLI job is also included
+  // in the filename to make it unique per module execution.
   //
 
   // Encode process id into a string.  To avoid confusing the
@@ -546,7 +733,7 @@ vtkSlicerCLIModuleLogic
   {
     temporaryDirectory = appLogic->GetTemporaryPath();
   }
-  fname = temporaryDirectory + "/" + pid + "_" + fname;
+  fname = temporaryDirectory + "/" + pid + "_" + CurrentJobTag + fname;
 
   if (tag == "image")
   {
@@ -674,10 +861,9 @@ void vtkSlicerCLIModuleLogic::ApplyAndWait ( vtkMRMLCommandLineModuleNode* node,
 
   vtkSlicerCLIModuleLogic::ApplyTask ( node );
 
-  while (this->GetApplicationLogic()->GetReadDataQueueSize())
-  {
-    this->GetApplicationLogic()->ProcessReadData();
-  }
+  // Load the outputs of this module. Requests that other jobs add to the
+  // queue meanwhile are left for the application event loop.
+  this->GetApplicationLogic()->ProcessPendingReadData();
 }
 
 //-----------------------------------------------------------------------------
@@ -716,6 +902,14 @@ void vtkSlicerCLIModuleLogic::Apply ( vtkMRMLCommandLineModuleNode* node, bool u
   node->Register(this);
   node->SetAttribute("UpdateDisplay", updateDisplay ? "true" : "false");
 
+  // Jobs with higher priority are started first
+  task->SetPriority(vtkSlicerCLIModuleLogic::GetJobPriority(node));
+
+  {
+    std::lock_guard<std::mutex> lock(this->Internal->ScheduleTimesMutex);
+    this->Internal->ScheduleTimes[node] = vtkTimerLog::GetUniversalTime();
+  }
+
   // Schedule the task
   ret = this->GetApplicationLogic()->ScheduleTask( task.GetPointer() );
 
@@ -731,6 +925,82 @@ void vtkSlicerCLIModuleLogic::Apply ( vtkMRMLCommandLineModuleNode* node, bool u
   }
 }
 
+//-----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::ApplyBatch(vtkMRMLCommandLineModuleNode* node,
+  const std::vector<std::string>& parameterNames,
+  const std::vector<std::vector<std::string> >& parameterValues,
+  vtkCollection* jobNodes, bool updateDisplay)
+{
+  if (!node || !this->GetMRMLScene())
+  {
+    vtkErrorMacro("ApplyBatch: invalid CLI node or scene");
+    return;
+  }
+  for (const std::vector<std::string>& jobParameterValues : parameterValues)
+  {
+    if (jobParameterValues.size() != parameterNames.size())
+    {
+      vtkErrorMacro("ApplyBatch: expected " << parameterNames.size() << " parameter values for each job, got "
+        << jobParameterValues.size() << ". Job is skipped.");
+      continue;
+    }
+    vtkMRMLCommandLineModuleNode* jobNode = this->CreateNodeInScene();
+    if (!jobNode)
+    {
+      vtkErrorMacro("ApplyBatch: failed to create CLI node");
+      return;
+    }
+    jobNode->Copy(node);
+    for (size_t parameterIndex = 0; parameterIndex < parameterNames.size(); ++parameterIndex)
+    {
+      if (!jobNode->SetParameterAsString(parameterNames[parameterIndex].c_str(), jobParameterValues[parameterIndex]))
+      {
+        vtkWarningMacro("ApplyBatch: parameter " << parameterNames[parameterIndex] << " is not set");
+      }
+    }
+    if (jobNodes)
+    {
+      jobNodes->AddItem(jobNode);
+    }
+    this->Apply(jobNode, updateDisplay);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetJobPriority(vtkMRMLCommandLineModuleNode* node, int priority)
+{
+  if (!node)
+  {
+    return;
+  }
+  node->SetAttribute(vtkSlicerCLIModuleLogic::GetJobPriorityAttributeName(), std::to_string(priority).c_str());
+}
+
+//-----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetJobPriority(vtkMRMLCommandLineModuleNode* node)
+{
+  const char* priority = node ? node->GetAttribute(vtkSlicerCLIModuleLogic::GetJobPriorityAttributeName()) : nullptr;
+  return priority ? atoi(priority) : 0;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetJobNumberOfThreads(vtkMRMLCommandLineModuleNode* node, int numberOfThreads)
+{
+  if (!node)
+  {
+    return;
+  }
+  node->SetAttribute(vtkSlicerCLIModuleLogic::GetJobNumberOfThreadsAttributeName(),
+    std::to_string(std::max(numberOfThreads, 0)).c_str());
+}
+
+//-----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetJobNumberOfThreads(vtkMRMLCommandLineModuleNode* node)
+{
+  const char* numberOfThreads = node ? node->GetAttribute(vtkSlicerCLIModuleLogic::GetJobNumberOfThreadsAttributeName()) : nullptr;
+  return numberOfThreads ? std::max(atoi(numberOfThreads), 0) : 0;
+}
+
 //----------------------------------------------------------------------------
 void vtkSlicerCLIModuleLogic
 ::SetMRMLApplicationLogic(vtkMRMLApplicationLogic* logic)
@@ -833,6 +1103,33 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
   // release it when it goes out of scope
   node0.TakeReference(reinterpret_cast<vtkMRMLCommandLineModuleNode*>(clientdata));
 
+  // Time spent in the processing queue
+  double startTime = vtkTimerLog::GetUniversalTime();
+  double queueTime = 0.0;
+  {
+    std::lock_guard<std::mutex> lock(this->Internal->ScheduleTimesMutex);
+    std::map<vtkMRMLCommandLineModuleNode*, double>::iterator scheduleTimeIt = this->Internal->ScheduleTimes.find(node0);
+    if (scheduleTimeIt != this->Internal->ScheduleTimes.end())
+    {
+      queueTime = startTime - scheduleTimeIt->second;
+      this->Internal->ScheduleTimes.erase(scheduleTimeIt);
+    }
+  }
+
+  MRML_TRACE_SCOPE_DETAIL("CLI", "vtkSlicerCLIModuleLogic::ApplyTask", node0->GetModuleTitle().c_str());
+#ifdef MRML_USE_TRACING
+  if (vtkMRMLTraceLogger::IsTracing())
+  {
+    // Show time spent waiting in the queue before the task started
+    double queueTimeMicroseconds = queueTime * 1e6;
+    vtkMRMLTraceLogger::GetInstance()->AddCompleteEvent("CLI", "vtkSlicerCLIModuleLogic queued",
+      node0->GetModuleTitle().c_str(), vtkMRMLTraceLogger::GetTimestamp() - queueTimeMicroseconds, queueTimeMicroseconds);
+  }
+#endif
+
+  // Unique tag for temporary files of this job
+  CurrentJobTag = std::to_string(++this->Internal->JobCounter) + "_";
+
   // Check to see if this node/task has been cancelled
   if (node0->GetStatus() == vtkMRMLCommandLineModuleNode::Cancelling ||
       node0->GetStatus() == vtkMRMLCommandLineModuleNode::Cancelled)
@@ -1264,9 +1561,12 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
         "abcdefghijklmnopqrstuvwxyz";
 
     std::ostringstream code;
-    for (int ii = 0; ii < 10; ii++)
     {
-      code << alphanum[this->Internal->RandomGenerator() % (sizeof(alphanum)-1)];
+      std::lock_guard<std::mutex> lock(this->Internal->RandomGeneratorMutex);
+      for (int ii = 0; ii < 10; ii++)
+      {
+        code << alphanum[this->Internal->RandomGenerator() % (sizeof(alphanum)-1)];
+      }
     }
     std::string returnFile = temporaryDirectory + "/" + pidString.str()
       + "_" + code.str() + ".params";
@@ -1749,6 +2049,9 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     // statically linked to the executable.
     // Historically, there was an nvidia driver bug that causes the module
     // to fail on exit with undefined symbol.
+     // Environment variables are modified until the process is started,
+    // make sure other CLIs do not modify them meanwhile.
+    std::unique_lock<std::mutex> environmentLock(GetProcessEnvironmentMutex());
      std::string saveITKAutoLoadPath;
      itksys::SystemTools::GetEnv("ITK_AUTOLOAD_PATH", saveITKAutoLoadPath);
      std::string emptyString("ITK_AUTOLOAD_PATH=");
@@ -1761,9 +2064,21 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     //
     // now run the process
     //
+    // Limit the number of threads that the CLI uses, if requested
+    std::string saveITKNumberOfThreads;
+    bool hadITKNumberOfThreads = itksys::SystemTools::GetEnv("ITK_GLOBAL_DEFAULT_NUMBER_OF_THREADS", saveITKNumberOfThreads);
+    int jobNumberOfThreads = vtkSlicerCLIModuleLogic::GetJobNumberOfThreads(node0);
+    if (jobNumberOfThreads > 0)
+    {
+      std::string numberOfThreadsString = "ITK_GLOBAL_DEFAULT_NUMBER_OF_THREADS=" + std::to_string(jobNumberOfThreads);
+      itksys::SystemTools::PutEnv(numberOfThreadsString);
+    }
+
     itksysProcess *process = itksysProcess_New();
 
+    this->Internal->ProcessesKillLock.lock();
     this->Internal->Processes.push_back(process);
+    this->Internal->ProcessesKillLock.unlock();
 
     // setup the command
     itksysProcess_SetCommand(process, command);
@@ -1785,6 +2100,18 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     {
       vtkErrorMacro( "Unable to restore ITK_AUTOLOAD_PATH. ");
     }
+    if (jobNumberOfThreads > 0)
+    {
+      if (hadITKNumberOfThreads)
+      {
+        itksys::SystemTools::PutEnv("ITK_GLOBAL_DEFAULT_NUMBER_OF_THREADS=" + saveITKNumberOfThreads);
+      }
+      else
+      {
+        itksys::SystemTools::UnPutEnv("ITK_GLOBAL_DEFAULT_NUMBER_OF_THREADS");
+      }
+    }
+    environmentLock.unlock();
 
     // Wait for the command to finish
     char *tbuffer;
@@ -1812,9 +2139,11 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       // Check to see if the plugin was cancelled
       if (node0->GetModuleDescription().GetProcessInformation()->Abort)
       {
+        this->Internal->ProcessesKillLock.lock();
         itksysProcess_Kill(process);
         this->Internal->Processes.erase(
               std::find(this->Internal->Processes.begin(), this->Internal->Processes.end(), process));
+        this->Internal->ProcessesKillLock.unlock();
         node0->GetModuleDescription().GetProcessInformation()->Progress = 0;
         node0->GetModuleDescription().GetProcessInformation()->StageProgress =0;
         this->GetApplicationLogic()->RequestModified( node0 );
@@ -1907,9 +2236,9 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
         }
       }
     }
-    this->Internal->ProcessesKillLock.lock();
+    // Do not hold ProcessesKillLock while waiting, other jobs must be able to
+    // start and kill their processes meanwhile.
     itksysProcess_WaitForExit(process, nullptr);
-    this->Internal->ProcessesKillLock.unlock();
 
     vtkSlicerCLIModuleLogic::RemoveProgressInfoFromProcessOutput(stdoutbuffer);
     if (stdoutbuffer.size() > 0)
@@ -2014,16 +2343,15 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
 
     std::ostringstream coutstringstream;
     std::ostringstream cerrstringstream;
-    std::streambuf* origcoutrdbuf = std::cout.rdbuf();
-    std::streambuf* origcerrrdbuf = std::cerr.rdbuf();
+    std::unique_ptr<vtkSlicerCLIModuleStreamRedirection> streamRedirection;
     int returnValue = 0;
     try
     {
       if (this->Internal->RedirectModuleStreams)
       {
-        // redirect the streams
-        std::cout.rdbuf( coutstringstream.rdbuf() );
-        std::cerr.rdbuf( cerrstringstream.rdbuf() );
+        // redirect the streams of this thread
+        streamRedirection.reset(new vtkSlicerCLIModuleStreamRedirection(
+          coutstringstream.rdbuf(), cerrstringstream.rdbuf()));
       }
 
       // run the module
@@ -2043,12 +2371,8 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       }
       node0->SetErrorText(cerrstringstream.str(), false);
 
-      if (this->Internal->RedirectModuleStreams)
-      {
-        // reset the streams
-        std::cout.rdbuf( origcoutrdbuf );
-        std::cerr.rdbuf( origcerrrdbuf );
-      }
+      // reset the streams
+      streamRedirection.reset();
     }
     catch (itk::ExceptionObject& exc)
     {
@@ -2063,8 +2387,7 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
         this->GetApplicationLogic()->RequestModified( node0 );
       }
 
-      std::cout.rdbuf( origcoutrdbuf );
-      std::cerr.rdbuf( origcerrrdbuf );
+      streamRedirection.reset();
     }
     catch (...)
     {
@@ -2072,8 +2395,7 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       node0->SetStatus(vtkMRMLCommandLineModuleNode::CompletedWithErrors, false);
       this->GetApplicationLogic()->RequestModified( node0 );
 
-      std::cout.rdbuf( origcoutrdbuf );
-      std::cerr.rdbuf( origcerrrdbuf );
+      streamRedirection.reset();
     }
     if (node0->GetStatus() == vtkMRMLCommandLineModuleNode::Cancelling)
     {
@@ -2087,8 +2409,7 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
         << " returned " << returnValue << " which probably indicates an error.");
       node0->SetStatus(vtkMRMLCommandLineModuleNode::CompletedWithErrors, false);
       this->GetApplicationLogic()->RequestModified( node0 );
-      std::cout.rdbuf( origcoutrdbuf );
-      std::cerr.rdbuf( origcerrrdbuf );
+      streamRedirection.reset();
     }
   }
 
@@ -2366,6 +2687,10 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     node0->SetStatus(vtkMRMLCommandLineModuleNode::Completed, false);
     this->GetApplicationLogic()->RequestModified( node0 );
   }
+
+  vtkInfoMacro(<< node0->GetModuleDescription().GetTitle() << " job finished in "
+    << (vtkTimerLog::GetUniversalTime() - startTime) << "s (waited " << queueTime << "s in the processing queue)");
+  CurrentJobTag.clear();
 }
 
 //-----------------------------------------------------------------------------
@@ -26,8 +26,12 @@ class ModuleParameter;
 class vtkMRMLModelHierarchyNode;
 class MRMLIDMap;
 
+// VTK includes
+class vtkCollection;
+
 // STL includes
 #include <string>
+#include <vector>
 
 #include "qSlicerBaseQTCLIExport.h"
 
@@ -118,6 +122,37 @@ public:
   /// in the node selectors.
   void ApplyAndWait ( vtkMRMLCommandLineModuleNode* node, bool updateDisplay = true);
 
+  /// Schedules a batch of jobs of the command line module.
+  /// For each job a new CLI node is added to the scene, initialized from \a node,
+  /// the parameters \a parameterNames are set to the values of the job in
+  /// \a parameterValues, then the job is scheduled using Apply().
+  /// The created CLI nodes are added to \a jobNodes (if not nullptr), they can be used
+  /// for monitoring the status of each job or cancelling it (by calling Cancel() on the node).
+  /// The number of jobs that run concurrently is set by
+  /// vtkSlicerApplicationLogic::SetNumberOfProcessingThreads(), which is initialized
+  /// from the "Modules/NumberOfProcessingThreads" application setting.
+  /// \sa Apply(), SetJobPriority(), SetJobNumberOfThreads()
+  void ApplyBatch(vtkMRMLCommandLineModuleNode* node,
+                  const std::vector<std::string>& parameterNames,
+                  const std::vector<std::vector<std::string> >& parameterValues,
+                  vtkCollection* jobNodes = nullptr, bool updateDisplay = false);
+
+  /// Set scheduling priority of the CLI node. Jobs with higher priority are started first
+  /// if several jobs are waiting in the processing queue. Default priority is 0.
+  /// The value is stored in the node attribute returned by GetJobPriorityAttributeName().
+  static void SetJobPriority(vtkMRMLCommandLineModuleNode* node, int priority);
+  static int GetJobPriority(vtkMRMLCommandLineModuleNode* node);
+  static const char* GetJobPriorityAttributeName() { return "CLI.JobPriority"; };
+
+  /// Set maximum number of threads that an executable CLI may use.
+  /// Value of 0 (default) means that the number of threads is not limited.
+  /// Shared object CLIs run in the application process, therefore they use
+  /// the global ITK thread settings.
+  /// The value is stored in the node attribute returned by GetJobNumberOfThreadsAttributeName().
+  static void SetJobNumberOfThreads(vtkMRMLCommandLineModuleNode* node, int numberOfThreads);
+  static int GetJobNumberOfThreads(vtkMRMLCommandLineModuleNode* node);
+  static const char* GetJobNumberOfThreadsAttributeName() { return "CLI.JobNumberOfThreads"; };
+
   void KillProcesses();
 
 //   void LazyEvaluateModuleTarget(ModuleDescription& moduleDescriptionObject);
@@ -105,6 +105,7 @@
 #endif
 #include <vtkMRMLI18N.h>
 #include <vtkMRMLScene.h>
+#include <vtkMRMLTraceLogger.h>
 #include <vtkMRMLTranslator.h>
 
 // CTK includes
@@ -593,6 +594,14 @@ void qSlicerCoreApplicationPrivate::init()
     this->AppLogic->SetFontFileName(VTK_TIMES, viewsFontFileSerif.toStdString());
   }
 
+  // Number of processing tasks (such as CLI module jobs) that may run concurrently.
+  // Slicer core does not provide GUI to set this value yet.
+  if (q->userSettings()->contains("Modules/NumberOfProcessingThreads"))
+  {
+    this->AppLogic->SetNumberOfProcessingThreads(
+      q->userSettings()->value("Modules/NumberOfProcessingThreads").toInt());
+  }
+
   q->connect(q, SIGNAL(aboutToQuit()), q, SLOT(onAboutToQuit()));
 }
 
@@ -1129,6 +1138,14 @@ void qSlicerCoreApplication::handlePreApplicationCommandLineArguments()
     this->setAttribute(AA_EnableTesting);
   }
 
+  if (!options->traceFile().isEmpty())
+  {
+    vtkMRMLTraceLogger* traceLogger = vtkMRMLTraceLogger::GetInstance();
+    traceLogger->SetTraceFileName(options->traceFile().toUtf8().constData());
+    traceLogger->SetCurrentThreadName("Main");
+    traceLogger->StartTracing();
+  }
+
 #ifdef Slicer_USE_PYTHONQT
   if (options->isPythonDisabled())
   {
@@ -2063,6 +2080,16 @@ void qSlicerCoreApplication::onAboutToQuit()
 
   d->ModuleManager->factoryManager()->unloadModules();
 
+  vtkMRMLTraceLogger* traceLogger = vtkMRMLTraceLogger::GetInstance();
+  if (traceLogger->GetTraceFileName() && strlen(traceLogger->GetTraceFileName()) > 0)
+  {
+    traceLogger->StopTracing();
+    if (!traceLogger->WriteTraceFile())
+    {
+      qWarning() << "Failed to write trace file:" << traceLogger->GetTraceFileName();
+    }
+  }
+
 #ifdef Slicer_USE_PYTHONQT
   // Override return code only if testing mode is enabled
   if (this->corePythonManager()->pythonErrorOccured() && this->testAttribute(AA_EnableTesting))
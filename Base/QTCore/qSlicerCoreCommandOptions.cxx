@@ -373,6 +373,13 @@ bool qSlicerCoreCommandOptions::keepTemporarySettings() const
   return d->ParsedArgs.value("keep-temporary-settings").toBool();
 }
 
+//-----------------------------------------------------------------------------
+QString qSlicerCoreCommandOptions::traceFile() const
+{
+  Q_D(const qSlicerCoreCommandOptions);
+  return d->ParsedArgs.value("trace-file").toString();
+}
+
 //-----------------------------------------------------------------------------
 bool qSlicerCoreCommandOptions::isTestingEnabled() const
 {
@@ -492,6 +499,11 @@ void qSlicerCoreCommandOptions::addArguments()
   this->addArgument("disable-message-handlers", "", QVariant::Bool,
                     /*no tr*/"Start application disabling the 'terminal' message handlers.");
 
+  this->addArgument("trace-file", "", QVariant::String,
+                    /*no tr*/"Record timing of scene loading, saving and event processing and write it "
+                    "to the specified file when the application exits. The file can be viewed "
+                    "in chrome://tracing or https://ui.perfetto.dev.");
+
 #if defined (Q_OS_WIN32) && !defined (Slicer_BUILD_WIN32_CONSOLE)
 #else
   this->addArgument("disable-terminal-outputs", "", QVariant::Bool,
@@ -55,6 +55,7 @@ class Q_SLICER_BASE_QTCORE_EXPORT qSlicerCoreCommandOptions : public ctkCommandL
   Q_PROPERTY(bool displayMessageAndExit READ displayMessageAndExit STORED false CONSTANT)
   Q_PROPERTY(bool verboseModuleDiscovery READ verboseModuleDiscovery CONSTANT)
   Q_PROPERTY(bool disableMessageHandlers READ disableMessageHandlers CONSTANT)
+  Q_PROPERTY(QString traceFile READ traceFile CONSTANT)
   Q_PROPERTY(bool testingEnabled READ isTestingEnabled CONSTANT)
 #ifdef Slicer_USE_PYTHONQT
   Q_PROPERTY(bool pythonDisabled READ isPythonDisabled CONSTANT)
@@ -191,6 +192,12 @@ public:
   /// are cleared by default.
   bool keepTemporarySettings() const;
 
+  /// Return the file where timing of scene loading, saving and event processing
+  /// is written when the application exits, in Chrome trace event format.
+  /// Tracing is started at startup if the file name is not empty.
+  /// \sa vtkMRMLTraceLogger
+  QString traceFile() const;
+
   /// Return True if slicer is in testing mode.
   /// Typically set when running unit tests:
   ///  ./Slicer --testing --launch ./bin/qSlicerXXXTests ...
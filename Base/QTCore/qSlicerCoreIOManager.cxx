@@ -23,6 +23,9 @@
 #include <QDir>
 #include <QElapsedTimer>
 #include <QFileInfo>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QThreadPool>
 
 // CTK includes
 #include <ctkUtils.h>
@@ -52,6 +55,13 @@
 #include <vtkStringArray.h>
 #include <vtkGeneralTransform.h>
 
+// STD includes
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <vector>
+
 //-----------------------------------------------------------------------------
 class qSlicerCoreIOManagerPrivate
 {
@@ -75,8 +85,49 @@ public:
   QMap<qSlicerIO::IOFileType, QStringList> FileTypes;
 
   QString DefaultSceneFileType;
+
+  /// Worker threads for reading files in the background in loadNodes()
+  QThreadPool ReadThreadPool;
+};
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+/// File read by qSlicerFileReader::readData() in a worker thread
+struct BackgroundReadJob
+{
+  qSlicerFileReader* Reader{nullptr};
+  qSlicerIO::IOProperties Properties;
+  vtkSmartPointer<vtkObject> ReadJob;
+  vtkNew<vtkMRMLMessageCollection> UserMessages;
+  std::shared_ptr<std::atomic<bool>> Canceled;
+  std::promise<bool> Result;
+};
+
+//-----------------------------------------------------------------------------
+class BackgroundReadRunnable : public QRunnable
+{
+public:
+  BackgroundReadRunnable(QSharedPointer<BackgroundReadJob> job)
+    : Job(job)
+  {
+  }
+  void run() override
+  {
+    bool success = false;
+    if (!this->Job->Canceled->load())
+    {
+      success = this->Job->Reader->readData(this->Job->Properties, this->Job->ReadJob, this->Job->UserMessages);
+    }
+    this->Job->Result.set_value(success);
+  }
+protected:
+  QSharedPointer<BackgroundReadJob> Job;
 };
 
+}
+
 //-----------------------------------------------------------------------------
 qSlicerCoreIOManagerPrivate::qSlicerCoreIOManagerPrivate() = default;
 
@@ -692,23 +743,189 @@ bool qSlicerCoreIOManager::loadNodes(const qSlicerIO::IOFileType& fileType,
 bool qSlicerCoreIOManager::loadNodes(const QList<qSlicerIO::IOProperties>& files,
           vtkCollection* loadedNodes, vtkMRMLMessageCollection* userMessages/*=nullptr*/)
 {
+  Q_D(qSlicerCoreIOManager);
+  vtkMRMLScene* scene = d->currentScene();
+
+  // Start reading all files that the readers can read in the background.
+  // Files are read in parallel in worker threads, while nodes are added to the scene
+  // in the main thread, in the original order of the files.
+  std::shared_ptr<std::atomic<bool>> canceled = std::make_shared<std::atomic<bool>>(false);
+  QList<QSharedPointer<BackgroundReadJob>> backgroundJobs;
+  std::vector<std::future<bool>> backgroundResults(files.count());
+  foreach(const qSlicerIO::IOProperties& fileProperties, files)
+  {
+    QSharedPointer<BackgroundReadJob> job;
+    QString fileName = fileProperties.value("fileName").toString();
+    if (fileProperties.value("fileName").type() != QVariant::StringList && !fileName.isEmpty())
+    {
+      const QList<qSlicerFileReader*>& readers =
+        this->readers(static_cast<qSlicerIO::IOFileType>(fileProperties["fileType"].toString()));
+      foreach (qSlicerFileReader* reader, readers)
+      {
+        reader->setMRMLScene(scene);
+        if (reader->canLoadFileConfidence(fileName) <= 0.0)
+        {
+          continue;
+        }
+        // Only the reader that would be tried first in sequential loading is used
+        vtkSmartPointer<vtkObject> readJob = reader->prepareBackgroundRead(fileProperties);
+        if (readJob)
+        {
+          job = QSharedPointer<BackgroundReadJob>(new BackgroundReadJob);
+          job->Reader = reader;
+          job->Properties = fileProperties;
+          job->ReadJob = readJob;
+          job->Canceled = canceled;
+          backgroundResults[backgroundJobs.count()] = job->Result.get_future();
+          d->ReadThreadPool.start(new BackgroundReadRunnable(job));
+        }
+        break;
+      }
+    }
+    backgroundJobs << job;
+  }
+
   bool success = true;
-  foreach(qSlicerIO::IOProperties fileProperties, files)
+  bool batchProcessing = false;
+  for (int fileIndex = 0; fileIndex < files.count(); ++fileIndex)
   {
+    const qSlicerIO::IOProperties& fileProperties = files[fileIndex];
+    QString fileName = fileProperties["fileName"].toString();
     int numberOfUserMessagesBefore = userMessages ? userMessages->GetNumberOfMessages() : 0;
-    success = this->loadNodes(
-      static_cast<qSlicerIO::IOFileType>(fileProperties["fileType"].toString()),
-      fileProperties, loadedNodes, userMessages)
-      && success;
+    QSharedPointer<BackgroundReadJob> job = backgroundJobs[fileIndex];
+    bool readSuccess = false;
+    if (this->updateLoadNodesProgress(fileIndex, files.count(), fileName))
+    {
+      canceled->store(true);
+    }
+    if (job && !canceled->load())
+    {
+      std::future<bool>& result = backgroundResults[fileIndex];
+      if (result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+      {
+        // Let the application update while the file is being read
+        if (batchProcessing)
+        {
+          scene->EndState(vtkMRMLScene::BatchProcessState);
+          batchProcessing = false;
+        }
+        while (result.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready)
+        {
+          if (this->updateLoadNodesProgress(fileIndex, files.count(), fileName))
+          {
+            canceled->store(true);
+          }
+        }
+      }
+      readSuccess = result.get() && !canceled->load();
+    }
+    if (canceled->load())
+    {
+      success = false;
+      break;
+    }
+
+    if (readSuccess)
+    {
+      // Adding of nodes of consecutive files that are already read is batched
+      if (!batchProcessing)
+      {
+        scene->StartState(vtkMRMLScene::BatchProcessState);
+        batchProcessing = true;
+      }
+      //: %1 is the filename
+      QString userMessagePrefix = tr("Loading %1").arg(fileName) + " - ";
+      qSlicerFileReader* reader = job->Reader;
+      reader->userMessages()->ClearMessages();
+      reader->setMRMLScene(scene);
+      readSuccess = reader->loadData(fileProperties, job->ReadJob);
+      if (readSuccess)
+      {
+        if (userMessages)
+        {
+          userMessages->AddMessages(job->UserMessages, userMessagePrefix.toStdString());
+          userMessages->AddMessages(reader->userMessages(), userMessagePrefix.toStdString());
+        }
+        qDebug() << reader->description() << "Reader has successfully read the file" << fileName << "in the background";
+        QStringList nodes = reader->loadedNodes();
+        qSlicerIO::IOProperties loadedFileParameters = fileProperties;
+        loadedFileParameters.insert("nodeIDs", nodes);
+        emit newFileLoaded(loadedFileParameters);
+        if (loadedNodes)
+        {
+          foreach(const QString& node, nodes)
+          {
+            vtkMRMLNode* loadedNode = scene->GetNodeByID(node.toUtf8());
+            if (!loadedNode)
+            {
+              qWarning() << Q_FUNC_INFO << " error: cannot find node by ID " << node;
+              continue;
+            }
+            loadedNodes->AddItem(loadedNode);
+          }
+        }
+      }
+    }
+    // Read job is not needed anymore, release the memory that it uses
+    if (job)
+    {
+      job->ReadJob = nullptr;
+    }
+
+    if (!readSuccess)
+    {
+      // Load the file in the main thread, trying all the readers that can load it
+      // (this is also the fallback if background reading failed).
+      if (batchProcessing)
+      {
+        scene->EndState(vtkMRMLScene::BatchProcessState);
+        batchProcessing = false;
+      }
+      success = this->loadNodes(
+        static_cast<qSlicerIO::IOFileType>(fileProperties["fileType"].toString()),
+        fileProperties, loadedNodes, userMessages)
+        && success;
+    }
+
     // Add a separator between nodes
     if (userMessages && userMessages->GetNumberOfMessages() > numberOfUserMessagesBefore)
     {
       userMessages->AddSeparator();
     }
+
+    if (this->updateLoadNodesProgress(fileIndex + 1, files.count(), fileName))
+    {
+      canceled->store(true);
+      success = false;
+      break;
+    }
+  }
+
+  if (batchProcessing)
+  {
+    scene->EndState(vtkMRMLScene::BatchProcessState);
+  }
+  if (canceled->load())
+  {
+    // Files that are queued for reading are skipped
+    d->ReadThreadPool.waitForDone();
+    if (userMessages)
+    {
+      userMessages->AddMessage(vtkCommand::WarningEvent, tr("Loading of files was canceled.").toStdString());
+    }
   }
   return success;
 }
 
+//-----------------------------------------------------------------------------
+bool qSlicerCoreIOManager::updateLoadNodesProgress(int numberOfLoadedFiles, int numberOfFiles, const QString& fileName)
+{
+  Q_UNUSED(numberOfLoadedFiles);
+  Q_UNUSED(numberOfFiles);
+  Q_UNUSED(fileName);
+  return false;
+}
+
 //-----------------------------------------------------------------------------
 vtkMRMLNode* qSlicerCoreIOManager::loadNodesAndGetFirst(qSlicerIO::IOFileType fileType,
   const qSlicerIO::IOProperties& parameters, vtkMRMLMessageCollection* userMessages/*=nullptr*/)
@@ -139,7 +139,11 @@ public:
 
   /// Utility function that loads a bunch of files. The "fileType" attribute should
   /// in the parameter map for each node to load.
+  /// Files that their reader can read in the background (see qSlicerFileReader::prepareBackgroundRead())
+  /// are read in parallel in worker threads, other files are loaded using loadNodes(fileType, ...).
+  /// Nodes are added to the scene in the main thread, in the order of the files.
   /// If a valid pointer is passed to userMessages additional error or warning information may be returned in it.
+  /// \sa updateLoadNodesProgress()
   virtual bool loadNodes(const QList<qSlicerIO::IOProperties>& files,
                          vtkCollection* loadedNodes = nullptr,
                          vtkMRMLMessageCollection* userMessages = nullptr);
@@ -291,6 +295,13 @@ signals:
 
 protected:
 
+  /// Called by loadNodes(files, ...) from the main thread when loading of a file starts, each time a file is loaded,
+  /// and periodically while waiting for files being read in the background.
+  /// fileName is the name of the file that is being loaded (or that has just been loaded).
+  /// Return true to cancel loading of the remaining files.
+  /// Default implementation returns false.
+  virtual bool updateLoadNodesProgress(int numberOfLoadedFiles, int numberOfFiles, const QString& fileName);
+
   /// Returns the list of registered readers
   const QList<qSlicerFileReader*>& readers()const;
 
@@ -27,6 +27,9 @@
 /// QtCore includes
 #include "qSlicerFileReader.h"
 
+// VTK includes
+#include <vtkObject.h>
+
 //-----------------------------------------------------------------------------
 class qSlicerFileReaderPrivate
 {
@@ -134,6 +137,33 @@ QStringList qSlicerFileReader::loadedNodes()const
   return d->LoadedNodes;
 }
 
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkObject> qSlicerFileReader::prepareBackgroundRead(const IOProperties& properties)
+{
+  Q_UNUSED(properties);
+  return nullptr;
+}
+
+//----------------------------------------------------------------------------
+bool qSlicerFileReader::readData(const IOProperties& properties, vtkObject* readJob,
+  vtkMRMLMessageCollection* userMessages)const
+{
+  Q_UNUSED(properties);
+  Q_UNUSED(readJob);
+  Q_UNUSED(userMessages);
+  return false;
+}
+
+//----------------------------------------------------------------------------
+bool qSlicerFileReader::loadData(const IOProperties& properties, vtkObject* readJob)
+{
+  Q_D(qSlicerFileReader);
+  Q_UNUSED(properties);
+  Q_UNUSED(readJob);
+  d->LoadedNodes.clear();
+  return false;
+}
+
 //----------------------------------------------------------------------------
 bool qSlicerFileReader::examineFileInfoList(QFileInfoList &fileInfoList, QFileInfo &archetypeFileInfo, qSlicerIO::IOProperties &ioProperties)const
 {
@@ -28,8 +28,12 @@
 #include "qSlicerIO.h"
 #include "qSlicerBaseQTCoreExport.h"
 
+// VTK includes
+#include <vtkSmartPointer.h>
+
 class qSlicerFileReaderOptions;
 class qSlicerFileReaderPrivate;
+class vtkObject;
 
 class Q_SLICER_BASE_QTCORE_EXPORT qSlicerFileReader
   : public qSlicerIO
@@ -80,6 +84,31 @@ public:
   /// \sa setLoadedNodes(), load()
   Q_INVOKABLE virtual QStringList loadedNodes()const;
 
+  /// Readers that can read file content without accessing the MRML scene
+  /// may implement prepareBackgroundRead(), readData(), and loadData() to allow
+  /// qSlicerCoreIOManager to read multiple files in parallel, in background threads.
+  ///
+  /// prepareBackgroundRead() is called in the main thread. It returns an object that
+  /// stores everything that readData() needs, or nullptr if the file cannot be
+  /// read in the background (in that case load() is used). Default implementation returns nullptr.
+  /// \sa readData(), loadData()
+  virtual vtkSmartPointer<vtkObject> prepareBackgroundRead(const IOProperties& properties);
+
+  /// Read file content into the object created by prepareBackgroundRead().
+  /// Called in a worker thread, possibly for several files at the same time, therefore
+  /// it must not access the MRML scene or modify the reader. It must only read raw data
+  /// (such as vtkPolyData or vtkImageData) and must not create or modify MRML nodes,
+  /// because node observations are managed by vtkEventBroker, which is not thread-safe.
+  /// Errors and warnings are reported in userMessages.
+  /// \sa prepareBackgroundRead(), loadData()
+  virtual bool readData(const IOProperties& properties, vtkObject* readJob,
+    vtkMRMLMessageCollection* userMessages)const;
+
+  /// Create nodes from the data read by readData() and add them into the scene. Called in the main thread.
+  /// Must call setLoadedNodes() the same way as load() does.
+  /// \sa prepareBackgroundRead(), readData()
+  virtual bool loadData(const IOProperties& properties, vtkObject* readJob);
+
   /// Implements the file list examination for the corresponding method in the core
   /// IO manager.
   /// \sa qSlicerCoreIOManager
@@ -471,27 +471,7 @@ bool qSlicerIOManager::loadNodes(const QList<qSlicerIO::IOProperties>& files,
   // (it can make a big difference if hundreds of nodes are loaded)
   SlicerRenderBlocker renderBlocker;
   bool needStop = d->startProgressDialog(files.count());
-  bool success = true;
-  foreach(qSlicerIO::IOProperties fileProperties, files)
-  {
-    int numberOfUserMessagesBefore = userMessages ? userMessages->GetNumberOfMessages() : 0;
-    success = this->loadNodes(
-      static_cast<qSlicerIO::IOFileType>(fileProperties["fileType"].toString()),
-      fileProperties,
-      loadedNodes, userMessages) && success;
-    if (userMessages && userMessages->GetNumberOfMessages() > numberOfUserMessagesBefore)
-    {
-      userMessages->AddSeparator();
-    }
-
-    this->updateProgressDialog();
-    if (d->ProgressDialog->wasCanceled())
-    {
-      success = false;
-      break;
-    }
-  }
-
+  bool success = this->qSlicerCoreIOManager::loadNodes(files, loadedNodes, userMessages);
   if (needStop)
   {
     d->stopProgressDialog();
@@ -499,6 +479,20 @@ bool qSlicerIOManager::loadNodes(const QList<qSlicerIO::IOProperties>& files,
   return success;
 }
 
+//-----------------------------------------------------------------------------
+bool qSlicerIOManager::updateLoadNodesProgress(int numberOfLoadedFiles, int numberOfFiles, const QString& fileName)
+{
+  Q_D(qSlicerIOManager);
+  Q_UNUSED(numberOfFiles);
+  if (!d->ProgressDialog)
+  {
+    return false;
+  }
+  d->ProgressDialog->setLabelText(qSlicerIOManager::tr("Loading file ") + fileName + " ...");
+  d->ProgressDialog->setValue(qMin(numberOfLoadedFiles, d->ProgressDialog->maximum() - 1));
+  return d->ProgressDialog->wasCanceled();
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerIOManager::updateProgressDialog()
 {
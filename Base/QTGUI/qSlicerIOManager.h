@@ -72,7 +72,7 @@ public:
     vtkCollection* loadedNodes = nullptr, vtkMRMLMessageCollection* userMessages = nullptr) override;
   /// If you have a list of nodes to load, it's best to use this function
   /// in order to have a unique progress dialog instead of multiple ones.
-  /// It internally calls loadNodes() for each file.
+  /// Loading of the remaining files can be canceled in the progress dialog.
   bool loadNodes(const QList<qSlicerIO::IOProperties>& files, vtkCollection* loadedNodes = nullptr,
     vtkMRMLMessageCollection* userMessages = nullptr) override;
 
@@ -120,6 +120,9 @@ protected slots:
   void execDelayedFileDialog();
 
 protected:
+  /// Update the progress dialog and return true if the user canceled loading.
+  bool updateLoadNodesProgress(int numberOfLoadedFiles, int numberOfFiles, const QString& fileName) override;
+
   friend class qSlicerFileDialog;
   using qSlicerCoreIOManager::readers;
 protected:
@@ -0,0 +1,116 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkCacheManager.h"
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkNew.h>
+
+// VTKSYS includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <fstream>
+#include <string>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void WriteFile(const std::string& fileName, size_t size)
+{
+  std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary);
+  std::string content(size, 'x');
+  file.write(content.data(), content.size());
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkCacheManagerTest1(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string cacheDir = std::string(argv[1]) + "/vtkCacheManagerTest1";
+  vtksys::SystemTools::RemoveADirectory(cacheDir);
+
+  vtkNew<vtkCacheManager> cacheManager;
+  cacheManager->SetRemoteCacheDirectory(cacheDir.c_str());
+  CHECK_BOOL(vtksys::SystemTools::FileIsDirectory(cacheDir), true);
+  CHECK_DOUBLE_TOLERANCE(cacheManager->GetCurrentCacheSize(), 0.0, 1e-6);
+
+  // Files written into the cache are accounted without scanning the cache directory
+  std::string fileA = cacheDir + "/a.nrrd";
+  std::string fileB = cacheDir + "/b.nrrd";
+  std::string fileC = cacheDir + "/c.nrrd";
+  WriteFile(fileA, 100000);
+  WriteFile(fileB, 100000);
+  WriteFile(fileC, 100000);
+  // relative file names are relative to the cache directory
+  cacheManager->AddFileToCacheIndex("a.nrrd");
+  cacheManager->AddFileToCacheIndex(fileB.c_str());
+  cacheManager->AddFileToCacheIndex(fileC.c_str());
+  CHECK_DOUBLE_TOLERANCE(cacheManager->GetCurrentCacheSize(), 0.3, 1e-6);
+  CHECK_INT(static_cast<int>(cacheManager->GetCachedFiles().size()), 3);
+
+  // Adding a file again updates its size
+  WriteFile(fileA, 200000);
+  cacheManager->AddFileToCacheIndex(fileA.c_str());
+  CHECK_DOUBLE_TOLERANCE(cacheManager->GetCurrentCacheSize(), 0.4, 1e-6);
+  CHECK_INT(static_cast<int>(cacheManager->GetCachedFiles().size()), 3);
+  WriteFile(fileA, 100000);
+  cacheManager->AddFileToCacheIndex(fileA.c_str());
+  CHECK_DOUBLE_TOLERANCE(cacheManager->GetCurrentCacheSize(), 0.3, 1e-6);
+
+  // Least recently used files are evicted first (use order: b, c, a)
+  cacheManager->MarkCachedFileAsUsed(fileA.c_str());
+  CHECK_INT(cacheManager->EvictLeastRecentlyUsedFiles(0.25), 1);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(fileB), false);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(fileC), true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(fileA), true);
+  CHECK_DOUBLE_TOLERANCE(cacheManager->GetCurrentCacheSize(), 0.2, 1e-6);
+  CHECK_INT(static_cast<int>(cacheManager->GetCachedFiles().size()), 2);
+  // No eviction if the cache is already small enough
+  CHECK_INT(cacheManager->EvictLeastRecentlyUsedFiles(0.2), 0);
+
+  // Rescanning the cache finds files that were not added to the index
+  // and keeps the order of use of indexed files (use order: d, c, a)
+  std::string fileD = cacheDir + "/d.nrrd";
+  WriteFile(fileD, 100000);
+  cacheManager->UpdateCacheInformation();
+  CHECK_DOUBLE_TOLERANCE(cacheManager->GetCurrentCacheSize(), 0.3, 1e-6);
+  CHECK_INT(static_cast<int>(cacheManager->GetCachedFiles().size()), 3);
+  CHECK_INT(cacheManager->EvictLeastRecentlyUsedFiles(0.15), 2);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(fileD), false);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(fileC), false);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(fileA), true);
+
+  // Deleting a file from the cache updates the size
+  cacheManager->DeleteFromCache(fileA.c_str());
+  CHECK_BOOL(vtksys::SystemTools::FileExists(fileA), false);
+  CHECK_DOUBLE_TOLERANCE(cacheManager->GetCurrentCacheSize(), 0.0, 1e-6);
+  CHECK_INT(static_cast<int>(cacheManager->GetCachedFiles().size()), 0);
+
+  // Clearing the cache empties the index
+  WriteFile(fileA, 100000);
+  cacheManager->AddFileToCacheIndex(fileA.c_str());
+  CHECK_DOUBLE_TOLERANCE(cacheManager->GetCurrentCacheSize(), 0.1, 1e-6);
+  CHECK_INT(cacheManager->ClearCache(), 1);
+  CHECK_DOUBLE_TOLERANCE(cacheManager->GetCurrentCacheSize(), 0.0, 1e-6);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,186 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLBinarySceneWriter.h"
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLModelDisplayNode.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLParser.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLSubjectHierarchyNode.h"
+#include "vtkMRMLTextNode.h"
+#include "vtkTagTable.h"
+
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+
+// VTKSYS includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <fstream>
+#include <string>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void PopulateScene(vtkMRMLScene* scene, int numberOfTransforms)
+{
+  scene->GetUserTagTable()->AddOrUpdateTag("SceneType", "BinaryTest", 0);
+
+  vtkNew<vtkMRMLModelDisplayNode> displayNode;
+  scene->AddNode(displayNode);
+  vtkNew<vtkMRMLModelNode> modelNode;
+  // name with characters that must be escaped in XML
+  modelNode->SetName("Model \"1\" & <2>");
+  scene->AddNode(modelNode);
+  modelNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+
+  vtkNew<vtkMRMLTextNode> textNode;
+  textNode->SetText("First line\nSecond line with 'quotes' & \"double quotes\"");
+  scene->AddNode(textNode);
+
+  vtkMRMLSubjectHierarchyNode* shNode = scene->GetSubjectHierarchyNode();
+  vtkIdType folderItemID = shNode->CreateFolderItem(shNode->GetSceneItemID(), "Folder");
+  shNode->SetItemParent(shNode->GetItemByDataNode(modelNode), folderItemID);
+
+  vtkNew<vtkMatrix4x4> matrix;
+  for (int transformIndex = 0; transformIndex < numberOfTransforms; ++transformIndex)
+  {
+    vtkNew<vtkMRMLLinearTransformNode> transformNode;
+    matrix->SetElement(0, 3, transformIndex * 0.5);
+    transformNode->SetMatrixTransformToParent(matrix);
+    scene->AddNode(transformNode);
+  }
+}
+
+//----------------------------------------------------------------------------
+std::string GetSceneAsXMLString(vtkMRMLScene* scene)
+{
+  scene->SetSaveToXMLString(1);
+  scene->Commit();
+  scene->SetSaveToXMLString(0);
+  return scene->GetSceneXMLString();
+}
+
+//----------------------------------------------------------------------------
+double LoadScene(vtkMRMLScene* scene, const std::string& fileName)
+{
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  scene->SetURL(fileName.c_str());
+  int success = scene->Connect();
+  timer->StopTimer();
+  return success ? timer->GetElapsedTime() : -1.0;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLBinarySceneTest1(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string tempDir = argv[1];
+  std::string xmlFileName = tempDir + "/vtkMRMLBinarySceneTest1.mrml";
+  std::string binaryFileName = tempDir + "/vtkMRMLBinarySceneTest1-binary.mrml";
+
+  vtkNew<vtkMRMLScene> scene;
+  PopulateScene(scene, 5000);
+
+  // Save the scene in both formats
+  CHECK_BOOL(scene->GetSaveInBinaryFormat(), false);
+  CHECK_INT(scene->Commit(xmlFileName.c_str()), 1);
+  scene->SaveInBinaryFormatOn();
+  CHECK_INT(scene->Commit(binaryFileName.c_str()), 1);
+  CHECK_BOOL(vtkMRMLParser::IsBinarySceneFile(binaryFileName.c_str()), true);
+  CHECK_BOOL(vtkMRMLParser::IsBinarySceneFile(xmlFileName.c_str()), false);
+  unsigned long xmlFileSize = vtksys::SystemTools::FileLength(xmlFileName);
+  unsigned long binaryFileSize = vtksys::SystemTools::FileLength(binaryFileName);
+  CHECK_BOOL(binaryFileSize < xmlFileSize, true);
+
+  // Binary format is not used when saving to string
+  std::string sceneXML = GetSceneAsXMLString(scene);
+  CHECK_BOOL(sceneXML.find("<MRML") != std::string::npos, true);
+
+  // Loading a binary scene file results in the same scene as loading the XML scene file
+  vtkNew<vtkMRMLScene> xmlScene;
+  double xmlLoadTime = LoadScene(xmlScene, xmlFileName);
+  CHECK_BOOL(xmlLoadTime >= 0.0, true);
+  vtkNew<vtkMRMLScene> binaryScene;
+  double binaryLoadTime = LoadScene(binaryScene, binaryFileName);
+  CHECK_BOOL(binaryLoadTime >= 0.0, true);
+  CHECK_INT(binaryScene->GetNumberOfNodes(), xmlScene->GetNumberOfNodes());
+  CHECK_STD_STRING(GetSceneAsXMLString(binaryScene), GetSceneAsXMLString(xmlScene));
+
+  vtkMRMLModelNode* loadedModelNode = vtkMRMLModelNode::SafeDownCast(
+    binaryScene->GetFirstNodeByClass("vtkMRMLModelNode"));
+  CHECK_NOT_NULL(loadedModelNode);
+  CHECK_STRING(loadedModelNode->GetName(), "Model \"1\" & <2>");
+  CHECK_NOT_NULL(loadedModelNode->GetDisplayNode());
+  vtkMRMLTextNode* loadedTextNode = vtkMRMLTextNode::SafeDownCast(
+    binaryScene->GetFirstNodeByClass("vtkMRMLTextNode"));
+  CHECK_NOT_NULL(loadedTextNode);
+  CHECK_STD_STRING(loadedTextNode->GetText(), "First line\nSecond line with 'quotes' & \"double quotes\"");
+  vtkMRMLSubjectHierarchyNode* shNode = binaryScene->GetSubjectHierarchyNode();
+  vtkIdType modelItemID = shNode->GetItemByDataNode(loadedModelNode);
+  CHECK_STD_STRING(shNode->GetItemName(shNode->GetItemParent(modelItemID)), "Folder");
+  CHECK_STRING(binaryScene->GetUserTagTable()->GetTagValue("SceneType"), "BinaryTest");
+
+  std::cout << "Scene file size: XML " << xmlFileSize << " bytes, binary " << binaryFileSize << " bytes" << std::endl;
+  std::cout << "Scene loading time: XML " << xmlLoadTime << "s, binary " << binaryLoadTime << "s" << std::endl;
+
+  // Truncated binary scene file cannot be loaded
+  std::string truncatedFileName = tempDir + "/vtkMRMLBinarySceneTest1-truncated.mrml";
+  {
+    std::ifstream binaryFile(binaryFileName.c_str(), std::ios::in | std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(binaryFile)), std::istreambuf_iterator<char>());
+    std::ofstream truncatedFile(truncatedFileName.c_str(), std::ios::out | std::ios::binary);
+    truncatedFile.write(content.data(), content.size() / 2);
+  }
+  CHECK_BOOL(vtkMRMLParser::IsBinarySceneFile(truncatedFileName.c_str()), true);
+  vtkNew<vtkMRMLScene> truncatedScene;
+  vtkNew<vtkCollection> loadedNodes;
+  vtkNew<vtkMRMLParser> parser;
+  parser->SetMRMLScene(truncatedScene);
+  parser->SetNodeCollection(loadedNodes);
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  CHECK_INT(parser->ParseBinaryFile(truncatedFileName.c_str()), 0);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+
+  // Record size larger than the file is rejected without allocating memory for it
+  std::string invalidSizeFileName = tempDir + "/vtkMRMLBinarySceneTest1-invalidsize.mrml";
+  {
+    std::ofstream invalidSizeFile(invalidSizeFileName.c_str(), std::ios::out | std::ios::binary);
+    invalidSizeFile.write(vtkMRMLBinarySceneWriter::GetFileSignature(), vtkMRMLBinarySceneWriter::FileSignatureSize);
+    const char formatVersion[4] = { 1, 0, 0, 0 };
+    invalidSizeFile.write(formatVersion, 4);
+    const char recordHeader[5] = { vtkMRMLBinarySceneWriter::RecordSchema,
+      static_cast<char>(0xf0), static_cast<char>(0xff), static_cast<char>(0xff), static_cast<char>(0xff) };
+    invalidSizeFile.write(recordHeader, 5);
+  }
+  CHECK_BOOL(vtkMRMLParser::IsBinarySceneFile(invalidSizeFileName.c_str()), true);
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  CHECK_INT(parser->ParseBinaryFile(invalidSizeFileName.c_str()), 0);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLImageStatisticsCache.h"
+
+// VTK includes
+#include <vtkIdTypeArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <cmath>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void FillRamp(vtkImageData* image, int dim)
+{
+  image->SetDimensions(dim, dim, dim);
+  image->AllocateScalars(VTK_SHORT, 1);
+  short* voxels = static_cast<short*>(image->GetScalarPointer());
+  for (int z = 0; z < dim; ++z)
+  {
+    for (int y = 0; y < dim; ++y)
+    {
+      for (int x = 0; x < dim; ++x)
+      {
+        *(voxels++) = static_cast<short>((x + y + z) % 1000);
+      }
+    }
+  }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLImageStatisticsCacheTest1(int , char * [] )
+{
+  vtkMRMLImageStatisticsCache* cache = vtkMRMLImageStatisticsCache::GetInstance();
+  CHECK_NOT_NULL(cache);
+  cache->RemoveAllImages();
+  cache->BackgroundRefinementOff();
+  // Approximation is opt-in
+  CHECK_INT(cache->GetMaximumNumberOfApproximationSamples(), 0);
+
+  // Invalid input
+  double range[2] = { 0.0, 0.0 };
+  CHECK_BOOL(cache->GetAutoRange(nullptr, range), false);
+  vtkNew<vtkImageData> emptyImage;
+  CHECK_BOOL(cache->GetAutoRange(emptyImage, range), false);
+
+  // Small image: statistics are always exact
+  vtkNew<vtkImageData> image;
+  FillRamp(image, 64);
+  CHECK_BOOL(cache->GetScalarRange(image, range), true);
+  CHECK_DOUBLE_TOLERANCE(range[0], 0.0, 1e-6);
+  CHECK_DOUBLE_TOLERANCE(range[1], 189.0, 1e-6);
+  CHECK_BOOL(cache->IsExact(image), true);
+  CHECK_INT(cache->GetNumberOfCachedImages(), 1);
+
+  double median = 0.0;
+  CHECK_BOOL(cache->GetPercentile(image, 50.0, median), true);
+  CHECK_DOUBLE_TOLERANCE(median, 94.0, 1.0);
+
+  vtkNew<vtkIdTypeArray> histogram;
+  double binOrigin = 0.0;
+  double binSpacing = 0.0;
+  CHECK_BOOL(cache->GetHistogram(image, histogram, binOrigin, binSpacing), true);
+  vtkIdType totalCount = 0;
+  for (vtkIdType i = 0; i < histogram->GetNumberOfTuples(); ++i)
+  {
+    totalCount += histogram->GetValue(i);
+  }
+  CHECK_INT(totalCount, 64 * 64 * 64);
+
+  // Modifying the image invalidates the statistics
+  image->Modified();
+  CHECK_BOOL(cache->IsExact(image), false);
+  CHECK_BOOL(cache->GetScalarRange(image, range), true);
+  CHECK_BOOL(cache->IsExact(image), true);
+
+  // Large image: approximate statistics first (if enabled)
+  cache->SetMaximumNumberOfApproximationSamples(32 * 32 * 32);
+  vtkNew<vtkImageData> largeImage;
+  FillRamp(largeImage, 200);
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  double approximateRange[2] = { 0.0, 0.0 };
+  CHECK_BOOL(cache->GetAutoRange(largeImage, approximateRange), true);
+  timer->StopTimer();
+  std::cout << "Approximate statistics: " << timer->GetElapsedTime() << "s" << std::endl;
+  CHECK_BOOL(cache->IsExact(largeImage), false);
+
+  timer->StartTimer();
+  double exactRange[2] = { 0.0, 0.0 };
+  CHECK_BOOL(cache->GetAutoRange(largeImage, exactRange, true), true);
+  timer->StopTimer();
+  std::cout << "Exact statistics: " << timer->GetElapsedTime() << "s" << std::endl;
+  CHECK_BOOL(cache->IsExact(largeImage), true);
+
+  // Approximate percentiles are close to the exact ones
+  CHECK_BOOL(std::abs(approximateRange[0] - exactRange[0]) < 10.0, true);
+  CHECK_BOOL(std::abs(approximateRange[1] - exactRange[1]) < 10.0, true);
+
+  // Background refinement
+  cache->BackgroundRefinementOn();
+  largeImage->Modified();
+  CHECK_BOOL(cache->GetAutoRange(largeImage, approximateRange), true);
+  cache->WaitForBackgroundRefinement();
+  CHECK_BOOL(cache->IsExact(largeImage), true);
+  double refinedRange[2] = { 0.0, 0.0 };
+  CHECK_BOOL(cache->GetAutoRange(largeImage, refinedRange), true);
+  CHECK_DOUBLE_TOLERANCE(refinedRange[0], exactRange[0], 1e-6);
+  CHECK_DOUBLE_TOLERANCE(refinedRange[1], exactRange[1], 1e-6);
+
+  // Least recently used images are removed
+  cache->SetMaximumNumberOfCachedImages(1);
+  image->Modified();
+  CHECK_BOOL(cache->GetScalarRange(image, range), true);
+  CHECK_INT(cache->GetNumberOfCachedImages(), 1);
+  CHECK_BOOL(cache->IsExact(largeImage), false);
+
+  cache->RemoveImage(image);
+  CHECK_INT(cache->GetNumberOfCachedImages(), 0);
+
+  // Restore defaults
+  cache->SetMaximumNumberOfCachedImages(100);
+  cache->SetMaximumNumberOfApproximationSamples(0);
+
+  return EXIT_SUCCESS;
+}
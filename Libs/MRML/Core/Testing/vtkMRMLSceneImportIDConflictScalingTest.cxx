@@ -0,0 +1,161 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLModelDisplayNode.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <set>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+// Scene that allows specifying node ID changes directly
+class vtkMRMLSceneWithIDChanges : public vtkMRMLScene
+{
+public:
+  static vtkMRMLSceneWithIDChanges* New();
+  vtkTypeMacro(vtkMRMLSceneWithIDChanges, vtkMRMLScene);
+
+  void AddIDChange(const std::string& oldID, const std::string& newID)
+  {
+    this->ReferencedIDChanges[oldID] = newID;
+  }
+};
+vtkStandardNewMacro(vtkMRMLSceneWithIDChanges);
+
+//---------------------------------------------------------------------------
+// Add model nodes, each referencing its own display node
+void PopulateScene(vtkMRMLScene* scene, int numberOfModels)
+{
+  scene->StartState(vtkMRMLScene::BatchProcessState);
+  for (int modelIndex = 0; modelIndex < numberOfModels; ++modelIndex)
+  {
+    vtkNew<vtkMRMLModelDisplayNode> displayNode;
+    displayNode->SetName(("Display_" + std::to_string(modelIndex)).c_str());
+    scene->AddNode(displayNode);
+    vtkNew<vtkMRMLModelNode> modelNode;
+    modelNode->SetName(("Model_" + std::to_string(modelIndex)).c_str());
+    scene->AddNode(modelNode);
+    modelNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  }
+  scene->EndState(vtkMRMLScene::BatchProcessState);
+}
+
+//---------------------------------------------------------------------------
+// Import a scene into a scene that has the same node IDs and check the result
+int MergeScenes(int numberOfModels, double& importTime)
+{
+  vtkNew<vtkMRMLScene> sceneToImport;
+  PopulateScene(sceneToImport, numberOfModels);
+  sceneToImport->SetSaveToXMLString(1);
+  sceneToImport->Commit();
+
+  vtkNew<vtkMRMLScene> scene;
+  PopulateScene(scene, numberOfModels);
+
+  scene->SetSceneXMLString(sceneToImport->GetSceneXMLString());
+  scene->SetLoadFromXMLString(1);
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  scene->Import();
+  timer->StopTimer();
+
+  // All node IDs are unique
+  int numberOfNodes = scene->GetNumberOfNodes();
+  std::set<std::string> nodeIDs;
+  for (int nodeIndex = 0; nodeIndex < numberOfNodes; ++nodeIndex)
+  {
+    nodeIDs.insert(scene->GetNthNode(nodeIndex)->GetID());
+  }
+  CHECK_INT(static_cast<int>(nodeIDs.size()), numberOfNodes);
+
+  // All imported nodes are added and each model refers to its own display node,
+  // both in the original and in the imported nodes
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelDisplayNode"), 2 * numberOfModels);
+  std::vector<vtkMRMLNode*> modelNodes;
+  scene->GetNodesByClass("vtkMRMLModelNode", modelNodes);
+  CHECK_INT(static_cast<int>(modelNodes.size()), 2 * numberOfModels);
+  std::set<vtkMRMLNode*> displayNodes;
+  for (vtkMRMLNode* node : modelNodes)
+  {
+    vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(node);
+    vtkMRMLDisplayNode* displayNode = modelNode->GetDisplayNode();
+    CHECK_NOT_NULL(displayNode);
+    std::string expectedDisplayNodeName = std::string(modelNode->GetName()).replace(0, 5, "Display");
+    CHECK_STD_STRING(displayNode->GetName(), expectedDisplayNodeName);
+    displayNodes.insert(displayNode);
+  }
+  CHECK_INT(static_cast<int>(displayNodes.size()), 2 * numberOfModels);
+
+  importTime = timer->GetElapsedTime();
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+// Each reference is updated using the original ID changes, even if a new ID is also changed
+int TestChainedIDChanges()
+{
+  vtkNew<vtkMRMLSceneWithIDChanges> scene;
+  vtkNew<vtkMRMLModelDisplayNode> displayNodeA;
+  scene->AddNode(displayNodeA);
+  vtkNew<vtkMRMLModelDisplayNode> displayNodeB;
+  scene->AddNode(displayNodeB);
+  vtkNew<vtkMRMLModelDisplayNode> displayNodeC;
+  scene->AddNode(displayNodeC);
+  vtkNew<vtkMRMLModelNode> modelNode;
+  scene->AddNode(modelNode);
+  modelNode->AddAndObserveDisplayNodeID(displayNodeA->GetID());
+  modelNode->AddAndObserveDisplayNodeID(displayNodeB->GetID());
+
+  // A->B, B->C
+  scene->AddIDChange(displayNodeA->GetID(), displayNodeB->GetID());
+  scene->AddIDChange(displayNodeB->GetID(), displayNodeC->GetID());
+  scene->UpdateNodeReferences();
+
+  CHECK_INT(modelNode->GetNumberOfDisplayNodes(), 2);
+  CHECK_STRING(modelNode->GetNthDisplayNodeID(0), displayNodeB->GetID());
+  CHECK_STRING(modelNode->GetNthDisplayNodeID(1), displayNodeC->GetID());
+  CHECK_POINTER(modelNode->GetNthDisplayNode(0), displayNodeB.GetPointer());
+  CHECK_POINTER(modelNode->GetNthDisplayNode(1), displayNodeC.GetPointer());
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneImportIDConflictScalingTest(int vtkNotUsed(argc), char * vtkNotUsed(argv) [])
+{
+  CHECK_EXIT_SUCCESS(TestChainedIDChanges());
+
+  // Import time must grow about linearly with the number of nodes.
+  // The largest case merges a 10k-node scene into a 10k-node scene with all node IDs conflicting.
+  for (int numberOfModels = 625; numberOfModels <= 5000; numberOfModels *= 2)
+  {
+    double importTime = 0.0;
+    CHECK_EXIT_SUCCESS(MergeScenes(numberOfModels, importTime));
+    std::cout << "Merging " << 2 * numberOfModels << "-node scene into " << 2 * numberOfModels
+      << "-node scene: " << importTime << "s" << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
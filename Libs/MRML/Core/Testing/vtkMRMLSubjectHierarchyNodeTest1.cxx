@@ -15,10 +15,14 @@
 ==============================================================================*/
 
 #include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLCoreTestingUtilities.h"
 #include "vtkMRMLModelNode.h"
 #include "vtkMRMLScene.h"
 #include "vtkMRMLSubjectHierarchyNode.h"
 
+// VTK includes
+#include <vtkIdList.h>
+
 int vtkMRMLSubjectHierarchyNodeTest1(int , char * [])
 {
   // Add a scene with 3 text nodes
@@ -115,5 +119,100 @@ int vtkMRMLSubjectHierarchyNodeTest1(int , char * [])
   CHECK_BOOL(std::find(atts.begin(), atts.end(), "zxcv") != atts.end(), true);
   CHECK_BOOL(std::find(atts.begin(), atts.end(), "qwer") != atts.end(), true);
 
+  // Test lookups by UID, name, and attribute
+  /////////////////////////
+
+  vtkIdType folderId1 = shNode->CreateFolderItem(shNode->GetSceneItemID(), "folder1");
+  vtkIdType folderId2 = shNode->CreateFolderItem(folderId1, "folder2");
+  shNode->SetItemUID(folderId2, uidName, uidValue);
+  CHECK_INT(shNode->GetItemByUID(uidName.c_str(), uidValue.c_str()), folderId2);
+  shNode->RemoveItemUID(folderId2, uidName);
+  shNode->SetItemUID(folderId2, uidName, "456");
+  CHECK_INT(shNode->GetItemByUID(uidName.c_str(), uidValue.c_str()), vtkMRMLSubjectHierarchyNode::GetInvalidItemID());
+  CHECK_INT(shNode->GetItemByUID(uidName.c_str(), "456"), folderId2);
+
+  // Name of items with data node follows the name of the data node
+  dataNode1->SetName("model1");
+  CHECK_INT(shNode->GetItemByName("model1"), itemId1);
+  dataNode1->SetName("model2");
+  CHECK_INT(shNode->GetItemByName("model1"), vtkMRMLSubjectHierarchyNode::GetInvalidItemID());
+  CHECK_INT(shNode->GetItemByName("model2"), itemId1);
+  shNode->SetItemName(folderId2, "folder3");
+  CHECK_INT(shNode->GetItemByName("folder2"), vtkMRMLSubjectHierarchyNode::GetInvalidItemID());
+  CHECK_INT(shNode->GetItemChildWithName(folderId1, "folder3"), folderId2);
+
+  vtkNew<vtkIdList> foundItemIds;
+  shNode->GetItemsByAttribute("zxcv", "fff", foundItemIds);
+  CHECK_INT(foundItemIds->GetNumberOfIds(), 1);
+  CHECK_INT(foundItemIds->GetId(0), itemId1);
+  shNode->SetItemAttribute(folderId2, "zxcv", "fff");
+  shNode->GetItemsByAttribute("zxcv", "fff", foundItemIds);
+  CHECK_INT(foundItemIds->GetNumberOfIds(), 2);
+  shNode->RemoveItemAttribute(itemId1, "zxcv");
+  shNode->GetItemsByAttribute("zxcv", "fff", foundItemIds);
+  CHECK_INT(foundItemIds->GetNumberOfIds(), 1);
+  CHECK_INT(foundItemIds->GetId(0), folderId2);
+
+  // Non-recursive search only finds direct children
+  shNode->SetItemParent(itemId1, folderId2);
+  CHECK_INT(shNode->GetItemChildWithName(folderId1, "model2"), vtkMRMLSubjectHierarchyNode::GetInvalidItemID());
+  CHECK_INT(shNode->GetItemChildWithName(folderId1, "model2", true), itemId1);
+
+  // Test batch update
+  /////////////////////////
+
+  vtkNew<vtkMRMLCoreTestingUtilities::vtkMRMLNodeCallback> callback;
+  shNode->AddObserver(vtkCommand::ModifiedEvent, callback);
+  shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemModifiedEvent, callback);
+  shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemReparentedEvent, callback);
+  shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemAddedEvent, callback);
+  shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyStartBatchUpdateEvent, callback);
+  shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyEndBatchUpdateEvent, callback);
+
+  shNode->StartBatchUpdate();
+  shNode->StartBatchUpdate(); // nested
+  CHECK_BOOL(shNode->IsBatchUpdating(), true);
+  vtkIdType folderId4 = shNode->CreateFolderItem(shNode->GetSceneItemID(), "folder4");
+  shNode->SetItemParent(itemId1, folderId4);
+  shNode->SetItemName(folderId2, "folder5");
+  shNode->EndBatchUpdate();
+  CHECK_BOOL(shNode->IsBatchUpdating(), true);
+  // Lookups are up-to-date during batch update
+  CHECK_INT(shNode->GetItemChildWithName(folderId4, "model2"), itemId1);
+  CHECK_INT(shNode->GetItemByName("folder5"), folderId2);
+  CHECK_INT(callback->GetNumberOfEvents(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemAddedEvent), 1);
+  CHECK_INT(callback->GetNumberOfEvents(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemModifiedEvent), 0);
+  CHECK_INT(callback->GetNumberOfEvents(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemReparentedEvent), 0);
+  CHECK_INT(callback->GetNumberOfModified(), 0);
+  shNode->EndBatchUpdate();
+  CHECK_BOOL(shNode->IsBatchUpdating(), false);
+  CHECK_INT(callback->GetNumberOfEvents(vtkMRMLSubjectHierarchyNode::SubjectHierarchyStartBatchUpdateEvent), 1);
+  CHECK_INT(callback->GetNumberOfEvents(vtkMRMLSubjectHierarchyNode::SubjectHierarchyEndBatchUpdateEvent), 1);
+  CHECK_INT(callback->GetNumberOfEvents(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemModifiedEvent), 0);
+  CHECK_INT(callback->GetNumberOfModified(), 1);
+  CHECK_EXIT_SUCCESS(callback->CheckStatus());
+
+  // Removed items are not found anymore
+  shNode->RemoveItem(folderId2);
+  CHECK_INT(shNode->GetItemByUID(uidName.c_str(), "456"), vtkMRMLSubjectHierarchyNode::GetInvalidItemID());
+  CHECK_INT(shNode->GetItemByName("folder5"), vtkMRMLSubjectHierarchyNode::GetInvalidItemID());
+  shNode->GetItemsByAttribute("zxcv", "fff", foundItemIds);
+  CHECK_INT(foundItemIds->GetNumberOfIds(), 0);
+
+  // Lookups return items in tree order, not in order of creation
+  vtkIdType folderIdA = shNode->CreateFolderItem(shNode->GetSceneItemID(), "folder6");
+  vtkIdType folderIdB = shNode->CreateFolderItem(shNode->GetSceneItemID(), "folder6");
+  shNode->SetItemParent(folderIdA, folderIdB);
+  shNode->SetItemUID(folderIdA, uidName, "789");
+  shNode->SetItemUID(folderIdB, uidName, "789");
+  shNode->SetItemAttribute(folderIdA, "zxcv", "fff");
+  shNode->SetItemAttribute(folderIdB, "zxcv", "fff");
+  CHECK_INT(shNode->GetItemByUID(uidName.c_str(), "789"), folderIdB);
+  CHECK_INT(shNode->GetItemByName("folder6"), folderIdB);
+  shNode->GetItemsByAttribute("zxcv", "fff", foundItemIds);
+  CHECK_INT(foundItemIds->GetNumberOfIds(), 2);
+  CHECK_INT(foundItemIds->GetId(0), folderIdB);
+  CHECK_INT(foundItemIds->GetId(1), folderIdA);
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,163 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLTraceLogger.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+const int NumberOfThreads = 4;
+const int NumberOfEventsPerThread = 100;
+
+//----------------------------------------------------------------------------
+void RecordEvents(int threadIndex)
+{
+  std::string threadName = "Worker " + std::to_string(threadIndex);
+  vtkMRMLTraceLogger::GetInstance()->SetCurrentThreadName(threadName.c_str());
+  for (int eventIndex = 0; eventIndex < NumberOfEventsPerThread; ++eventIndex)
+  {
+    MRML_TRACE_SCOPE("Test", "RecordEvents");
+  }
+}
+
+//----------------------------------------------------------------------------
+std::string ReadFile(const std::string& fileName)
+{
+  std::ifstream ifs(fileName.c_str());
+  std::stringstream content;
+  content << ifs.rdbuf();
+  return content.str();
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLTraceLoggerTest1(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string traceFileName = std::string(argv[1]) + "/vtkMRMLTraceLoggerTest1.json";
+
+  vtkMRMLTraceLogger* logger = vtkMRMLTraceLogger::GetInstance();
+  CHECK_NOT_NULL(logger);
+  logger->ClearEvents();
+
+#ifdef MRML_USE_TRACING
+  // No events are recorded when tracing is off
+  CHECK_BOOL(vtkMRMLTraceLogger::IsTracing(), false);
+  {
+    MRML_TRACE_SCOPE("Test", "NotRecorded");
+  }
+  CHECK_INT(logger->GetNumberOfEvents(), 0);
+
+  logger->SetCurrentThreadName("Main");
+  logger->StartTracing();
+  CHECK_BOOL(vtkMRMLTraceLogger::IsTracing(), true);
+
+  // Scene import is instrumented
+  vtkNew<vtkMRMLScene> scene;
+  const char sceneXML[] =
+    "<MRML  version=\"Slicer4.4.0\" userTags=\"\">"
+    " <Model id=\"vtkMRMLModelNode1\" name=\"Model1\" displayNodeRef=\"vtkMRMLModelDisplayNode1\" ></Model>"
+    " <ModelDisplay id=\"vtkMRMLModelDisplayNode1\" name=\"ModelDisplay1\" ></ModelDisplay>"
+    "</MRML>";
+  scene->SetSceneXMLString(sceneXML);
+  scene->SetLoadFromXMLString(1);
+  scene->Import();
+  int numberOfSceneEvents = logger->GetNumberOfEvents();
+  CHECK_BOOL(numberOfSceneEvents > 0, true);
+
+  // Events are recorded concurrently from several threads
+  std::vector<std::thread> threads;
+  for (int threadIndex = 0; threadIndex < NumberOfThreads; ++threadIndex)
+  {
+    threads.emplace_back(RecordEvents, threadIndex);
+  }
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+  CHECK_INT(logger->GetNumberOfEvents(), numberOfSceneEvents + NumberOfThreads * NumberOfEventsPerThread);
+
+  logger->AddInstantEvent("Test", "Instant", "detail with \"quotes\"");
+  logger->StopTracing();
+  {
+    MRML_TRACE_SCOPE("Test", "NotRecorded");
+  }
+  int numberOfEvents = logger->GetNumberOfEvents();
+  CHECK_INT(numberOfEvents, numberOfSceneEvents + NumberOfThreads * NumberOfEventsPerThread + 1);
+
+  // Write and check trace file content
+  logger->SetTraceFileName(traceFileName.c_str());
+  CHECK_BOOL(logger->WriteTraceFile(), true);
+  std::string trace = ReadFile(traceFileName);
+  CHECK_BOOL(trace.find("\"traceEvents\":[") != std::string::npos, true);
+  CHECK_BOOL(trace.find("\"vtkMRMLScene::Import\"") != std::string::npos, true);
+  CHECK_BOOL(trace.find("\"vtkMRMLParser::StartElement\"") != std::string::npos, true);
+  CHECK_BOOL(trace.find("\"Main\"") != std::string::npos, true);
+  CHECK_BOOL(trace.find("\"Worker 3\"") != std::string::npos, true);
+  CHECK_BOOL(trace.find("detail with \\\"quotes\\\"") != std::string::npos, true);
+  CHECK_BOOL(trace.find("NotRecorded") == std::string::npos, true);
+
+  // Number of recorded events is limited
+  logger->ClearEvents();
+  CHECK_INT(logger->GetNumberOfEvents(), 0);
+  logger->SetMaximumNumberOfEvents(10);
+  logger->StartTracing();
+  for (int eventIndex = 0; eventIndex < 20; ++eventIndex)
+  {
+    MRML_TRACE_SCOPE("Test", "Limited");
+  }
+  logger->StopTracing();
+  CHECK_INT(logger->GetNumberOfEvents(), 10);
+  logger->SetMaximumNumberOfEvents(10000000);
+
+  // Overhead of instrumented sections when tracing is off
+  const int numberOfIterations = 10000000;
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (int iteration = 0; iteration < numberOfIterations; ++iteration)
+  {
+    MRML_TRACE_SCOPE("Test", "Overhead");
+  }
+  timer->StopTimer();
+  std::cout << "Instrumented section overhead when tracing is off: "
+    << timer->GetElapsedTime() / numberOfIterations * 1e9 << "ns" << std::endl;
+  logger->ClearEvents();
+#endif
+
+  // Writing fails if the file cannot be created
+  logger->SetTraceFileName(nullptr);
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  CHECK_BOOL(logger->WriteTraceFile(), false);
+  CHECK_BOOL(logger->WriteTraceFile((std::string(argv[1]) + "/nonexistent/folder/trace.json").c_str()), false);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+
+  return EXIT_SUCCESS;
+}
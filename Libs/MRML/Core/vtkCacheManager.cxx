@@ -10,13 +10,148 @@
 #include <vtkCallbackCommand.h>
 #include <vtkObjectFactory.h>
 
+// STD includes
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
 vtkStandardNewMacro ( vtkCacheManager );
 
 #define MB 1000000.0
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+std::string GetCacheIndexKey(const std::string& cacheDirectory, const char* fileName)
+{
+  std::string path = fileName;
+  if (!vtksys::SystemTools::FileIsFullPath(path) && !cacheDirectory.empty())
+  {
+    path = cacheDirectory + "/" + path;
+  }
+  return vtksys::SystemTools::CollapseFullPath(path);
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+/// Index of cached files, keyed by full path of the cached file.
+/// Total size is updated incrementally and files are kept in least recently used
+/// order, so that size queries and eviction do not require directory traversal.
+class vtkCacheManager::vtkInternal
+{
+public:
+  struct CacheEntry
+  {
+    unsigned long long Size{ 0 };
+    std::list<std::string>::iterator UsePosition;
+  };
+
+  struct ScannedFile
+  {
+    std::string Path;
+    unsigned long long Size;
+    long ModifiedTime;
+  };
+
+  /// Adds or updates the entry and makes it most recently used
+  void AddOrUpdate(const std::string& path, unsigned long long size);
+  /// Makes the entry most recently used. Returns false if the file is not indexed.
+  bool MarkAsUsed(const std::string& path);
+  /// Returns false if the file is not indexed.
+  bool Remove(const std::string& path);
+  /// Removes all files in the directory and its subdirectories.
+  void RemoveDirectory(const std::string& path);
+  void Clear();
+
+  std::unordered_map<std::string, CacheEntry> Entries;
+  /// Cached file paths, least recently used first
+  std::list<std::string> UseOrder;
+  unsigned long long TotalSize{ 0 };
+  /// Files found by the last directory scan
+  std::vector<ScannedFile> ScannedFiles;
+  /// Protects the index and CachedFileList, as downloads are completed in networking threads
+  std::mutex Mutex;
+};
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::vtkInternal::AddOrUpdate(const std::string& path, unsigned long long size)
+{
+  auto entryIt = this->Entries.find(path);
+  if (entryIt != this->Entries.end())
+  {
+    this->TotalSize -= entryIt->second.Size;
+    entryIt->second.Size = size;
+    this->UseOrder.splice(this->UseOrder.end(), this->UseOrder, entryIt->second.UsePosition);
+  }
+  else
+  {
+    CacheEntry& entry = this->Entries[path];
+    entry.Size = size;
+    entry.UsePosition = this->UseOrder.insert(this->UseOrder.end(), path);
+  }
+  this->TotalSize += size;
+}
+
+//----------------------------------------------------------------------------
+bool vtkCacheManager::vtkInternal::MarkAsUsed(const std::string& path)
+{
+  auto entryIt = this->Entries.find(path);
+  if (entryIt == this->Entries.end())
+  {
+    return false;
+  }
+  this->UseOrder.splice(this->UseOrder.end(), this->UseOrder, entryIt->second.UsePosition);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkCacheManager::vtkInternal::Remove(const std::string& path)
+{
+  auto entryIt = this->Entries.find(path);
+  if (entryIt == this->Entries.end())
+  {
+    return false;
+  }
+  this->TotalSize -= entryIt->second.Size;
+  this->UseOrder.erase(entryIt->second.UsePosition);
+  this->Entries.erase(entryIt);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::vtkInternal::RemoveDirectory(const std::string& path)
+{
+  std::string prefix = path + "/";
+  for (auto entryIt = this->Entries.begin(); entryIt != this->Entries.end(); )
+  {
+    if (entryIt->first.compare(0, prefix.size(), prefix) == 0)
+    {
+      this->TotalSize -= entryIt->second.Size;
+      this->UseOrder.erase(entryIt->second.UsePosition);
+      entryIt = this->Entries.erase(entryIt);
+    }
+    else
+    {
+      ++entryIt;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::vtkInternal::Clear()
+{
+  this->Entries.clear();
+  this->UseOrder.clear();
+  this->TotalSize = 0;
+}
+
 //----------------------------------------------------------------------------
 vtkCacheManager::vtkCacheManager()
 {
+  this->Internal = new vtkInternal;
   this->MRMLScene = nullptr;
   this->CallbackCommand = vtkCallbackCommand::New();
   this->CachedFileList.clear();
@@ -48,6 +183,7 @@ vtkCacheManager::~vtkCacheManager()
   this->EnableForceRedownload = 0;
   this->InsufficientFreeBufferNotificationFlag = 0;
 //  this->EnableRemoteCacheOverwriting = 1;
+  delete this->Internal;
 }
 
 
@@ -259,15 +395,15 @@ void vtkCacheManager::PrintSelf(ostream& os, vtkIndent indent)
 //----------------------------------------------------------------------------
 std::vector< std::string > vtkCacheManager::GetAllCachedFiles ( )
 {
-  this->CachedFileList.clear();
-  this->GetCachedFileList ( this->GetRemoteCacheDirectory() );
-  return ( this->CachedFileList );
+  this->UpdateCacheInformation();
+  return this->GetCachedFiles();
 }
 
 
 //----------------------------------------------------------------------------
 std::vector< std::string > vtkCacheManager::GetCachedFiles ( ) const
 {
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
   return this->CachedFileList;
 }
 
@@ -309,6 +445,11 @@ int vtkCacheManager::GetCachedFileList ( const char *dirname )
           else
           {
             this->CachedFileList.emplace_back(dir.GetFile(static_cast<unsigned long>(fileNum)));
+            vtkInternal::ScannedFile scannedFile;
+            scannedFile.Path = vtksys::SystemTools::CollapseFullPath(fullName);
+            scannedFile.Size = vtksys::SystemTools::FileLength(fullName);
+            scannedFile.ModifiedTime = vtksys::SystemTools::ModifiedTime(fullName);
+            this->Internal->ScannedFiles.push_back(scannedFile);
           }
         }
       }
@@ -507,24 +648,122 @@ const char* vtkCacheManager::GetFilenameFromURI ( const char *uri )
 //----------------------------------------------------------------------------
 void vtkCacheManager::UpdateCacheInformation ( )
 {
-  //--- now recompute cache size
-  // this->CurrentCacheSize = ?;
-
-  //--- recompute free buffer size
-  // this->RemoteCacheFreeBufferSize = ?;
+  {
+    std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+
+    //--- refresh list of cached files.
+    this->CachedFileList.clear();
+    this->Internal->ScannedFiles.clear();
+    this->GetCachedFileList ( this->GetRemoteCacheDirectory() );
+
+    //--- rebuild the cache index: files that were not used in this session
+    //--- are ordered by modification time, followed by files in their
+    //--- previous order of use.
+    std::vector<vtkInternal::ScannedFile>& scannedFiles = this->Internal->ScannedFiles;
+    std::stable_sort(scannedFiles.begin(), scannedFiles.end(),
+      [](const vtkInternal::ScannedFile& a, const vtkInternal::ScannedFile& b)
+      { return a.ModifiedTime < b.ModifiedTime; });
+    std::list<std::string> previousUseOrder;
+    previousUseOrder.swap(this->Internal->UseOrder);
+    this->Internal->Clear();
+    for (const vtkInternal::ScannedFile& scannedFile : scannedFiles)
+    {
+      this->Internal->AddOrUpdate(scannedFile.Path, scannedFile.Size);
+    }
+    for (const std::string& path : previousUseOrder)
+    {
+      this->Internal->MarkAsUsed(path);
+    }
+    scannedFiles.clear();
 
-  //--- and refresh list of cached files.
-  this->CachedFileList.clear();
-  this->GetCachedFileList ( this->GetRemoteCacheDirectory() );
+    //--- recompute cache size
+    this->CurrentCacheSize = static_cast<float>(this->Internal->TotalSize / MB);
+  }
   this->Modified();
 }
 
+//----------------------------------------------------------------------------
+void vtkCacheManager::AddFileToCacheIndex ( const char *filename )
+{
+  if ( filename == nullptr )
+  {
+    return;
+  }
+  std::string key = GetCacheIndexKey( this->RemoteCacheDirectory, filename );
+  if ( !vtksys::SystemTools::FileExists( key, true ) )
+  {
+    vtkDebugMacro("AddFileToCacheIndex: file " << key << " does not exist.");
+    return;
+  }
+  unsigned long long size = vtksys::SystemTools::FileLength( key );
+  std::string name = vtksys::SystemTools::GetFilenameName( key );
+
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  if ( this->Internal->Entries.find(key) == this->Internal->Entries.end() )
+  {
+    this->CachedFileList.push_back( name );
+  }
+  this->Internal->AddOrUpdate( key, size );
+  this->CurrentCacheSize = static_cast<float>(this->Internal->TotalSize / MB);
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::MarkCachedFileAsUsed ( const char *filename )
+{
+  if ( filename == nullptr )
+  {
+    return;
+  }
+  std::string key = GetCacheIndexKey( this->RemoteCacheDirectory, filename );
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  this->Internal->MarkAsUsed( key );
+}
+
+//----------------------------------------------------------------------------
+int vtkCacheManager::EvictLeastRecentlyUsedFiles ( float targetCacheSize )
+{
+  unsigned long long targetSize = 0;
+  if ( targetCacheSize > 0 )
+  {
+    targetSize = static_cast<unsigned long long>( targetCacheSize * MB );
+  }
+  int numberOfEvictedFiles = 0;
+  while (true)
+  {
+    std::string path;
+    {
+      std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+      if ( this->Internal->TotalSize <= targetSize || this->Internal->UseOrder.empty() )
+      {
+        break;
+      }
+      path = this->Internal->UseOrder.front();
+      this->Internal->Remove( path );
+      this->CurrentCacheSize = static_cast<float>(this->Internal->TotalSize / MB);
+    }
+    vtkDebugMacro ( "EvictLeastRecentlyUsedFiles: removing " << path << " from cache." );
+    this->MarkNode ( path );
+    if ( vtksys::SystemTools::FileExists ( path, true ) && !vtksys::SystemTools::RemoveFile ( path ) )
+    {
+      vtkWarningMacro ( "EvictLeastRecentlyUsedFiles: unable to remove cached file " << path << " from disk." );
+    }
+    this->DeleteFromCachedFileList ( vtksys::SystemTools::GetFilenameName( path ).c_str() );
+    ++numberOfEvictedFiles;
+  }
+  if ( numberOfEvictedFiles > 0 )
+  {
+    this->InvokeEvent ( vtkCacheManager::CacheDeleteEvent );
+  }
+  return numberOfEvictedFiles;
+}
+
 
 
 
 //----------------------------------------------------------------------------
 void vtkCacheManager::DeleteFromCachedFileList ( const char * target )
 {
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
 
   std::string tstring = target;
   std::vector< std::string > tmp = this->CachedFileList;
@@ -591,7 +830,14 @@ void vtkCacheManager::DeleteFromCache( const char *target )
       }
       else
       {
-        this->UpdateCacheInformation ( );
+        //--- a single file is removed, update the cache index without scanning the cache
+        {
+          std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+          this->Internal->Remove ( GetCacheIndexKey( this->RemoteCacheDirectory, str.c_str() ) );
+          this->CurrentCacheSize = static_cast<float>(this->Internal->TotalSize / MB);
+        }
+        this->DeleteFromCachedFileList ( vtksys::SystemTools::GetFilenameName( str ).c_str() );
+        this->Modified();
         this->InvokeEvent ( vtkCacheManager::CacheDeleteEvent );
       }
     }
@@ -661,14 +907,13 @@ int vtkCacheManager::ClearCache()
 //----------------------------------------------------------------------------
 float vtkCacheManager::GetCurrentCacheSize ()
 {
-  if ( this->RemoteCacheDirectory.c_str() == nullptr )
+  if ( this->RemoteCacheDirectory.empty() )
   {
     return (0.0);
   }
-  float size = this->ComputeCacheSize ( this->RemoteCacheDirectory.c_str(), 0 );
-  this->SetCurrentCacheSize ( size );
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  this->CurrentCacheSize = static_cast<float>(this->Internal->TotalSize / MB);
   return ( this->CurrentCacheSize );
-
 }
 
 
@@ -679,6 +924,10 @@ void vtkCacheManager::MarkNode ( std::string str )
   //--- If such a node exists, mark it as modified since read,
   //--- so that a user will be prompted to save the
   //--- data elsewhere (since it'll be deleted from cache.)
+  if ( this->MRMLScene == nullptr )
+  {
+    return;
+  }
   int nnodes = this->MRMLScene->GetNumberOfNodesByClass ( "vtkMRMLStorableNode" );
   vtkMRMLStorableNode *node;
   std::string uri;
@@ -833,10 +1082,8 @@ float vtkCacheManager::ComputeCacheSize( const char *dirName, unsigned long sz )
 void vtkCacheManager::CacheSizeCheck()
 {
 
-  //--- Compute size of the current cache
-  this->ComputeCacheSize(this->RemoteCacheDirectory.c_str(), 0);
   //--- Invoke an event if cache size is exceeded.
-  if ( this->CurrentCacheSize > (float) (this->RemoteCacheLimit) )
+  if ( this->GetCurrentCacheSize() > (float) (this->RemoteCacheLimit) )
   {
     // remove the file just downloaded?
      this->InvokeEvent ( vtkCacheManager::CacheLimitExceededEvent );
@@ -847,7 +1094,7 @@ void vtkCacheManager::CacheSizeCheck()
 float vtkCacheManager::GetFreeCacheSpaceRemaining()
 {
 
-  float cachesize = this->ComputeCacheSize(this->RemoteCacheDirectory.c_str(), 0);
+  float cachesize = this->GetCurrentCacheSize();
   // cache limit - current cache size = total space left in cache.
   // total space in cache - free buffer size = amount that can be used.
   float diff = ( float (this->RemoteCacheLimit) - cachesize );
@@ -42,7 +42,9 @@ class VTK_MRML_EXPORT vtkCacheManager : public vtkObject
   const char *GetRemoteCacheDirectory ();
 
   ///
-  /// Called when a file is loaded or removed from the cache.
+  /// Scans the cache directory and rebuilds the list of cached files
+  /// and the cache index. Files are ordered by modification time
+  /// for least recently used eviction.
   void UpdateCacheInformation ( );
   ///
   /// Removes a target from the list of locally cached files and directories
@@ -110,10 +112,34 @@ class VTK_MRML_EXPORT vtkCacheManager : public vtkObject
 
   void CacheSizeCheck();
   void FreeCacheBufferCheck();
+  /// Traverses the directory and returns the combined size of all files in MB.
+  /// Slow for large caches, GetCurrentCacheSize() uses the cache index instead.
   float ComputeCacheSize( const char *dirname, unsigned long size );
+  /// Returns the size of all cached files in MB.
+  /// The size is maintained by the cache index, so no directory traversal is needed.
   float GetCurrentCacheSize();
   float GetFreeCacheSpaceRemaining();
 
+  ///
+  /// Adds a file to the cache index (or updates its size if already indexed)
+  /// and marks it as most recently used. Must be called when a file is written
+  /// into the cache directory, for example when a download is completed.
+  /// Relative file names are interpreted relative to the RemoteCacheDirectory.
+  /// This method is thread-safe.
+  void AddFileToCacheIndex ( const char *filename );
+
+  ///
+  /// Marks a cached file as most recently used, so that it is evicted last.
+  /// This method is thread-safe.
+  void MarkCachedFileAsUsed ( const char *filename );
+
+  ///
+  /// Deletes least recently used files from the cache until the cache size
+  /// is not larger than the specified size (in MB).
+  /// Nodes that refer to deleted files are marked the same way as in DeleteFromCache().
+  /// Returns the number of deleted files.
+  int EvictLeastRecentlyUsedFiles ( float targetCacheSize );
+
   std::vector< std::string > GetCachedFiles()const;
 
   ///
@@ -164,6 +190,7 @@ class VTK_MRML_EXPORT vtkCacheManager : public vtkObject
   vtkMRMLScene *MRMLScene;
 
   std::string RemoteCacheDirectory;
+  /// Adds files in the directory to CachedFileList and to the cache index scan results.
   int GetCachedFileList(const char *dirname);
   std::vector< std::string > GetAllCachedFiles();
   /// This array contains a list of cached file names (without paths)
@@ -182,6 +209,9 @@ class VTK_MRML_EXPORT vtkCacheManager : public vtkObject
   /// Holder for callback
   vtkCallbackCommand *CallbackCommand;
 
+  class vtkInternal;
+  vtkInternal* Internal;
+
 };
 
 #endif
@@ -398,6 +398,15 @@ void vtkDataIOManager::QueueRead ( vtkMRMLNode *node )
     //--- forget to adjust the cache size, but aren't notified again...
     float bufsize = (cm->GetRemoteCacheLimit() * 1000000.0) -  (cm->GetRemoteCacheFreeBufferSize() * 1000000.0);
     if ( (cm->GetCurrentCacheSize()*1000000.0) >= bufsize )
+    {
+      //--- Try to make space by removing least recently used files,
+      //--- leaving a free buffer for the file to be downloaded.
+      //--- The file of this node is used now, so it is removed last.
+      cm->MarkCachedFileAsUsed ( dest );
+      float targetCacheSize = cm->GetRemoteCacheLimit() - 2 * cm->GetRemoteCacheFreeBufferSize();
+      cm->EvictLeastRecentlyUsedFiles ( targetCacheSize > 0 ? targetCacheSize : 0 );
+    }
+    if ( (cm->GetCurrentCacheSize()*1000000.0) >= bufsize )
     {
       //--- No space left in cache. Don't trigger logic to download;
       //--- by invoking a RemoteReadEvent.
@@ -424,8 +433,8 @@ void vtkDataIOManager::QueueRead ( vtkMRMLNode *node )
       //--- trigger logic to download, if there's cache space.
       //--- and signal this remote read event to Logic and GUI.
       vtkDebugMacro("QueueRead: invoking a remote read event on the data io manager");
+      //--- Downloaded files are added to the cache index when their transfer is completed.
       this->InvokeEvent ( vtkDataIOManager::RemoteReadEvent, node);
-      cm->UpdateCacheInformation();
     }
   }
   else
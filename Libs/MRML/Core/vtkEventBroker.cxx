@@ -14,6 +14,7 @@
 
 // MRML includes
 #include "vtkEventBroker.h"
+#include "vtkMRMLTraceLogger.h"
 #include "vtkObservation.h"
 
 // VTK includes
@@ -819,6 +820,9 @@ void vtkEventBroker::InvokeObservation ( vtkObservation *observation,
 {
   this->EventNestingLevel++;
 
+  MRML_TRACE_SCOPE_DETAIL("Events", "vtkEventBroker::InvokeObservation",
+    observation->GetObserver() ? observation->GetObserver()->GetClassName() : nullptr);
+
   double startTime = this->TimerLog->GetUniversalTime();
 
   // Register so observation won't be deleted while callback is running
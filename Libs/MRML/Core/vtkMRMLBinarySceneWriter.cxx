@@ -0,0 +1,317 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLBinarySceneWriter.h"
+#include "vtkMRMLNode.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtkXMLParser.h>
+
+// STD includes
+#include <cstring>
+#include <sstream>
+#include <unordered_map>
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+void EncodeUInt32(unsigned int value, char* bytes)
+{
+  bytes[0] = static_cast<char>(value & 0xff);
+  bytes[1] = static_cast<char>((value >> 8) & 0xff);
+  bytes[2] = static_cast<char>((value >> 16) & 0xff);
+  bytes[3] = static_cast<char>((value >> 24) & 0xff);
+}
+
+} // end of anonymous namespace
+
+//------------------------------------------------------------------------------
+/// \brief Converts the XML written by a node into binary scene element records.
+///
+/// Node content is tokenized by the same XML parser that reads XML scene files,
+/// so attribute values are stored exactly as vtkMRMLParser would receive them.
+class vtkMRMLBinarySceneWriterXMLParser : public vtkXMLParser
+{
+public:
+  static vtkMRMLBinarySceneWriterXMLParser *New();
+  vtkTypeMacro(vtkMRMLBinarySceneWriterXMLParser, vtkXMLParser);
+
+  vtkMRMLBinarySceneWriter* Writer{ nullptr };
+
+protected:
+  vtkMRMLBinarySceneWriterXMLParser() = default;
+  ~vtkMRMLBinarySceneWriterXMLParser() override = default;
+
+  void StartElement(const char* name, const char** atts) override
+  {
+    this->Writer->WriteStartElement(name, atts);
+  }
+  void EndElement(const char* vtkNotUsed(name)) override
+  {
+    this->Writer->WriteEndElement();
+  }
+};
+
+vtkStandardNewMacro(vtkMRMLBinarySceneWriterXMLParser);
+
+//------------------------------------------------------------------------------
+class vtkMRMLBinarySceneWriter::vtkInternal
+{
+public:
+  void AppendUInt32(unsigned int value);
+  void AppendString(const char* str);
+  void WriteRecord(unsigned char recordType);
+  unsigned int GetSchemaIndex(const char* tagName, const char** attributes);
+
+  std::ostream* Stream{ nullptr };
+  /// Payload of the record being written. Reused between records to avoid reallocations.
+  std::string Payload;
+  /// Schema key is tag name and attribute names, separated by null characters.
+  std::unordered_map<std::string, unsigned int> SchemaIndices;
+  std::string SchemaKey;
+  int NumberOfOpenElements{ 0 };
+  bool Valid{ true };
+  vtkSmartPointer<vtkMRMLBinarySceneWriterXMLParser> NodeParser;
+};
+
+//------------------------------------------------------------------------------
+void vtkMRMLBinarySceneWriter::vtkInternal::AppendUInt32(unsigned int value)
+{
+  char bytes[4];
+  EncodeUInt32(value, bytes);
+  this->Payload.append(bytes, 4);
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLBinarySceneWriter::vtkInternal::AppendString(const char* str)
+{
+  if (!str)
+  {
+    str = "";
+  }
+  // Terminating null character is stored so that the reader can use strings from its buffer
+  unsigned int size = static_cast<unsigned int>(strlen(str) + 1);
+  this->AppendUInt32(size);
+  this->Payload.append(str, size);
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLBinarySceneWriter::vtkInternal::WriteRecord(unsigned char recordType)
+{
+  if (!this->Stream)
+  {
+    this->Valid = false;
+    return;
+  }
+  char recordHeader[5];
+  recordHeader[0] = static_cast<char>(recordType);
+  EncodeUInt32(static_cast<unsigned int>(this->Payload.size()), recordHeader + 1);
+  this->Stream->write(recordHeader, 5);
+  this->Stream->write(this->Payload.data(), this->Payload.size());
+  if (this->Stream->fail())
+  {
+    this->Valid = false;
+  }
+}
+
+//------------------------------------------------------------------------------
+unsigned int vtkMRMLBinarySceneWriter::vtkInternal::GetSchemaIndex(const char* tagName, const char** attributes)
+{
+  this->SchemaKey.assign(tagName);
+  for (const char** attribute = attributes; *attribute != nullptr; attribute += 2)
+  {
+    this->SchemaKey.push_back('\0');
+    this->SchemaKey.append(attribute[0]);
+  }
+  auto schemaIt = this->SchemaIndices.find(this->SchemaKey);
+  if (schemaIt != this->SchemaIndices.end())
+  {
+    return schemaIt->second;
+  }
+
+  // New combination of tag name and attribute names, write a schema record
+  unsigned int schemaIndex = static_cast<unsigned int>(this->SchemaIndices.size());
+  this->SchemaIndices[this->SchemaKey] = schemaIndex;
+  unsigned int numberOfAttributes = 0;
+  for (const char** attribute = attributes; *attribute != nullptr; attribute += 2)
+  {
+    ++numberOfAttributes;
+  }
+  this->Payload.clear();
+  this->AppendString(tagName);
+  this->AppendUInt32(numberOfAttributes);
+  for (const char** attribute = attributes; *attribute != nullptr; attribute += 2)
+  {
+    this->AppendString(attribute[0]);
+  }
+  this->WriteRecord(vtkMRMLBinarySceneWriter::RecordSchema);
+  return schemaIndex;
+}
+
+//------------------------------------------------------------------------------
+vtkStandardNewMacro(vtkMRMLBinarySceneWriter);
+
+//------------------------------------------------------------------------------
+vtkMRMLBinarySceneWriter::vtkMRMLBinarySceneWriter()
+{
+  this->Internal = new vtkInternal;
+  this->Internal->NodeParser = vtkSmartPointer<vtkMRMLBinarySceneWriterXMLParser>::New();
+  this->Internal->NodeParser->Writer = this;
+}
+
+//------------------------------------------------------------------------------
+vtkMRMLBinarySceneWriter::~vtkMRMLBinarySceneWriter()
+{
+  delete this->Internal;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLBinarySceneWriter::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfSchemas: " << this->Internal->SchemaIndices.size() << "\n";
+  os << indent << "NumberOfOpenElements: " << this->Internal->NumberOfOpenElements << "\n";
+  os << indent << "Valid: " << (this->Internal->Valid ? "true" : "false") << "\n";
+}
+
+//------------------------------------------------------------------------------
+const char* vtkMRMLBinarySceneWriter::GetFileSignature()
+{
+  // PNG-style signature: non-ASCII first byte, line endings to detect text mode conversions
+  return "\x89MRMLB\r\n";
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLBinarySceneWriter::SetStream(std::ostream* stream)
+{
+  this->Internal->Stream = stream;
+  this->Internal->SchemaIndices.clear();
+  this->Internal->NumberOfOpenElements = 0;
+  this->Internal->Valid = true;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLBinarySceneWriter::WriteHeader()
+{
+  if (!this->Internal->Stream)
+  {
+    vtkErrorMacro("WriteHeader failed: stream is not set");
+    this->Internal->Valid = false;
+    return;
+  }
+  this->Internal->Stream->write(vtkMRMLBinarySceneWriter::GetFileSignature(), vtkMRMLBinarySceneWriter::FileSignatureSize);
+  char formatVersion[4];
+  EncodeUInt32(vtkMRMLBinarySceneWriter::FormatVersion, formatVersion);
+  this->Internal->Stream->write(formatVersion, 4);
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLBinarySceneWriter::WriteStartElement(const char* tagName, const std::vector<std::string>& attributes)
+{
+  std::vector<const char*> attributePointers;
+  attributePointers.reserve(attributes.size() + 1);
+  // attributes must be name, value pairs
+  for (size_t attributeIndex = 0; attributeIndex + 1 < attributes.size(); attributeIndex += 2)
+  {
+    attributePointers.push_back(attributes[attributeIndex].c_str());
+    attributePointers.push_back(attributes[attributeIndex + 1].c_str());
+  }
+  attributePointers.push_back(nullptr);
+  this->WriteStartElement(tagName, attributePointers.data());
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLBinarySceneWriter::WriteStartElement(const char* tagName, const char** attributes)
+{
+  if (!tagName || !attributes)
+  {
+    vtkErrorMacro("WriteStartElement failed: invalid tag name or attributes");
+    this->Internal->Valid = false;
+    return;
+  }
+  unsigned int schemaIndex = this->Internal->GetSchemaIndex(tagName, attributes);
+  this->Internal->Payload.clear();
+  this->Internal->AppendUInt32(schemaIndex);
+  for (const char** attribute = attributes; *attribute != nullptr; attribute += 2)
+  {
+    this->Internal->Payload.push_back(static_cast<char>(vtkMRMLBinarySceneWriter::ValueString));
+    this->Internal->AppendString(attribute[1]);
+  }
+  this->Internal->WriteRecord(vtkMRMLBinarySceneWriter::RecordStartElement);
+  this->Internal->NumberOfOpenElements++;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLBinarySceneWriter::WriteEndElement()
+{
+  if (this->Internal->NumberOfOpenElements <= 0)
+  {
+    vtkErrorMacro("WriteEndElement failed: there is no open element");
+    this->Internal->Valid = false;
+    return;
+  }
+  this->Internal->Payload.clear();
+  this->Internal->WriteRecord(vtkMRMLBinarySceneWriter::RecordEndElement);
+  this->Internal->NumberOfOpenElements--;
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLBinarySceneWriter::WriteNode(vtkMRMLNode* node)
+{
+  if (!node)
+  {
+    vtkErrorMacro("WriteNode failed: invalid node");
+    return false;
+  }
+  // Generate the same XML as vtkMRMLScene::Commit() would write into an XML scene file
+  std::stringstream nodeXML;
+  nodeXML << "<" << node->GetNodeTagName() << "\n ";
+  node->WriteXML(nodeXML, 1);
+  nodeXML << ">";
+  node->WriteNodeBodyXML(nodeXML, 1);
+  nodeXML << "</" << node->GetNodeTagName() << ">\n";
+
+  int numberOfOpenElements = this->Internal->NumberOfOpenElements;
+  std::string nodeXMLString = nodeXML.str();
+  if (!this->Internal->NodeParser->Parse(nodeXMLString.c_str(), static_cast<unsigned int>(nodeXMLString.size()))
+    || this->Internal->NumberOfOpenElements != numberOfOpenElements)
+  {
+    vtkErrorMacro("WriteNode failed: invalid XML content in node "
+      << (node->GetID() ? node->GetID() : "(unknown)"));
+    this->Internal->Valid = false;
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLBinarySceneWriter::WriteEndOfScene()
+{
+  if (this->Internal->NumberOfOpenElements != 0)
+  {
+    vtkErrorMacro("WriteEndOfScene: " << this->Internal->NumberOfOpenElements << " elements are not ended");
+    this->Internal->Valid = false;
+  }
+  this->Internal->Payload.clear();
+  this->Internal->WriteRecord(vtkMRMLBinarySceneWriter::RecordEndOfScene);
+  if (this->Internal->Stream)
+  {
+    this->Internal->Stream->flush();
+  }
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLBinarySceneWriter::IsValid()
+{
+  return this->Internal->Valid && this->Internal->Stream && !this->Internal->Stream->fail();
+}
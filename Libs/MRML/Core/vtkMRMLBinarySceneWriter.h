@@ -0,0 +1,123 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#ifndef __vtkMRMLBinarySceneWriter_h
+#define __vtkMRMLBinarySceneWriter_h
+
+// MRML includes
+#include "vtkMRML.h"
+class vtkMRMLNode;
+
+// VTK includes
+#include <vtkObject.h>
+
+// STD includes
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// \brief Writes a scene file in compact binary format.
+///
+/// The binary scene format stores the same elements and attributes as the XML scene
+/// format, but as length-prefixed records instead of text. Attribute names of each
+/// element type are stored once in a schema record. Element records then refer to
+/// the schema and store only the attribute values. This allows vtkMRMLParser to read
+/// the scene without XML tokenization, entity decoding, or repeated attribute names.
+/// Nodes do not need to implement anything specific to the binary format: node
+/// content is captured from vtkMRMLNode::WriteXML() and vtkMRMLNode::WriteNodeBodyXML(),
+/// and read back using vtkMRMLNode::ReadXMLAttributes().
+/// Since the XML text of each node is generated and then parsed again by the expat
+/// XML parser (vtkXMLParser), writing a binary scene file is slower than writing
+/// an XML scene file. The format is optimized for reading.
+///
+/// File layout (all integers are little-endian):
+/// - header: 8-byte signature (see GetFileSignature()) and uint32 format version
+/// - records: uint8 record type, uint32 payload size, payload
+///   - RecordSchema: tag name, uint32 number of attributes, attribute names
+///   - RecordStartElement: uint32 schema index, then for each attribute of the schema
+///     a uint8 value type and the value
+///   - RecordEndElement: no payload
+///   - RecordEndOfScene: no payload, must be the last record
+///
+/// Strings are stored as uint32 size (including the terminating null character)
+/// followed by the characters and the null character, so that they can be used
+/// directly from the read buffer. Readers skip records of unknown type.
+///
+/// \sa vtkMRMLScene::SetSaveInBinaryFormat(), vtkMRMLParser::ParseBinaryFile()
+class VTK_MRML_EXPORT vtkMRMLBinarySceneWriter : public vtkObject
+{
+public:
+  static vtkMRMLBinarySceneWriter *New();
+  vtkTypeMacro(vtkMRMLBinarySceneWriter, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  enum RecordTypes
+  {
+    RecordEndOfScene = 0,
+    RecordSchema = 1,
+    RecordStartElement = 2,
+    RecordEndElement = 3
+  };
+
+  /// Type of attribute values in RecordStartElement records.
+  /// Currently all values are stored as strings, as nodes parse their own attribute values.
+  enum ValueTypes
+  {
+    ValueString = 0
+  };
+
+  /// Current binary scene format version.
+  static const unsigned int FormatVersion = 1;
+
+  /// Number of bytes in the file signature.
+  static const int FileSignatureSize = 8;
+
+  /// Signature at the beginning of binary scene files.
+  /// The first byte is not a valid first character of an XML document,
+  /// therefore binary and XML scene files can be distinguished.
+  static const char* GetFileSignature();
+
+  /// Set stream that the scene is written into. The stream must be opened in binary mode.
+  /// Must be called before WriteHeader().
+  void SetStream(std::ostream* stream);
+
+  /// Write file signature and format version.
+  void WriteHeader();
+
+  /// Write start of an element. Attributes are specified as a list of name, value pairs.
+  void WriteStartElement(const char* tagName, const std::vector<std::string>& attributes);
+
+  /// Write start of an element. Attributes are specified as a null-terminated array
+  /// of name, value pairs (same as in vtkXMLParser::StartElement).
+  void WriteStartElement(const char* tagName, const char** attributes);
+
+  /// Write end of the last started element.
+  void WriteEndElement();
+
+  /// Write node attributes and node body as element records.
+  /// Returns false if the node content could not be written.
+  bool WriteNode(vtkMRMLNode* node);
+
+  /// Write end of scene marker. Must be the last record.
+  void WriteEndOfScene();
+
+  /// Returns true if no errors occurred while writing.
+  bool IsValid();
+
+protected:
+  vtkMRMLBinarySceneWriter();
+  ~vtkMRMLBinarySceneWriter() override;
+  vtkMRMLBinarySceneWriter(const vtkMRMLBinarySceneWriter&);
+  void operator=(const vtkMRMLBinarySceneWriter&);
+
+  class vtkInternal;
+  vtkInternal* Internal;
+};
+
+#endif
@@ -28,6 +28,7 @@
 
 // VTK includes
 #include <vtkCallbackCommand.h>
+#include <vtkIdList.h>
 
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLFolderDisplayNode);
@@ -107,6 +108,11 @@ void vtkMRMLFolderDisplayNode::SetScene(vtkMRMLScene* scene)
     {
       shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemReparentedEvent, this->MRMLCallbackCommand);
     }
+    // Reparented items are reported in the end batch update event during batch update of the hierarchy
+    if (!shNode->HasObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyEndBatchUpdateEvent, this->MRMLCallbackCommand))
+    {
+      shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyEndBatchUpdateEvent, this->MRMLCallbackCommand);
+    }
   }
 }
 
@@ -115,14 +121,19 @@ void vtkMRMLFolderDisplayNode::ProcessMRMLEvents(vtkObject *caller, unsigned lon
 {
   Superclass::ProcessMRMLEvents(caller, event, callData);
 
-  if ( event == vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemReparentedEvent
-    && vtkMRMLSubjectHierarchyNode::SafeDownCast(caller) )
+  vtkMRMLSubjectHierarchyNode* shNode = vtkMRMLSubjectHierarchyNode::SafeDownCast(caller);
+  if (!shNode)
+  {
+    return;
+  }
+  // No-op if this folder node does not apply display properties on its branch
+  if (!this->ApplyDisplayPropertiesOnBranch)
+  {
+    return;
+  }
+
+  if (event == vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemReparentedEvent)
   {
-    // No-op if this folder node does not apply display properties on its branch
-    if (!this->ApplyDisplayPropertiesOnBranch)
-    {
-      return;
-    }
     // Get item ID for subject hierarchy node events
     vtkIdType reparentedItemID = vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID;
     if (callData)
@@ -133,20 +144,42 @@ void vtkMRMLFolderDisplayNode::ProcessMRMLEvents(vtkObject *caller, unsigned lon
         reparentedItemID = *itemIdPtr;
       }
     }
-    vtkMRMLSubjectHierarchyNode* shNode = vtkMRMLSubjectHierarchyNode::SafeDownCast(caller);
-    vtkMRMLDisplayableNode* displayableReparentedNode = vtkMRMLDisplayableNode::SafeDownCast(
-      shNode->GetItemDataNode(reparentedItemID) );
-    // Trigger display update for reparented displayable node if it is in a folder that applies
-    // display properties on its branch (only display nodes that allow overriding)
-    for (int i=0; i<displayableReparentedNode->GetNumberOfDisplayNodes(); ++i)
-    {
-      vtkMRMLDisplayNode* currentDisplayNode = displayableReparentedNode->GetNthDisplayNode(i);
-      if (currentDisplayNode && currentDisplayNode->GetFolderDisplayOverrideAllowed())
-      {
-        currentDisplayNode->Modified();
-      }
-    } // For all display nodes
+    this->UpdateReparentedItemDisplay(shNode, reparentedItemID);
   } // SubjectHierarchyItemReparentedEvent
+  else if (event == vtkMRMLSubjectHierarchyNode::SubjectHierarchyEndBatchUpdateEvent)
+  {
+    // Call data contains all the items that were modified or reparented during the batch update
+    vtkIdList* modifiedItemIDs = reinterpret_cast<vtkIdList*>(callData);
+    if (!modifiedItemIDs)
+    {
+      return;
+    }
+    for (vtkIdType i=0; i<modifiedItemIDs->GetNumberOfIds(); ++i)
+    {
+      this->UpdateReparentedItemDisplay(shNode, modifiedItemIDs->GetId(i));
+    }
+  } // SubjectHierarchyEndBatchUpdateEvent
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLFolderDisplayNode::UpdateReparentedItemDisplay(vtkMRMLSubjectHierarchyNode* shNode, vtkIdType itemID)
+{
+  vtkMRMLDisplayableNode* displayableReparentedNode = vtkMRMLDisplayableNode::SafeDownCast(
+    shNode->GetItemDataNode(itemID) );
+  if (!displayableReparentedNode)
+  {
+    return;
+  }
+  // Trigger display update for reparented displayable node if it is in a folder that applies
+  // display properties on its branch (only display nodes that allow overriding)
+  for (int i=0; i<displayableReparentedNode->GetNumberOfDisplayNodes(); ++i)
+  {
+    vtkMRMLDisplayNode* currentDisplayNode = displayableReparentedNode->GetNthDisplayNode(i);
+    if (currentDisplayNode && currentDisplayNode->GetFolderDisplayOverrideAllowed())
+    {
+      currentDisplayNode->Modified();
+    }
+  } // For all display nodes
 }
 
 //----------------------------------------------------------------------------
@@ -26,6 +26,7 @@
 #include "vtkMRMLDisplayNode.h"
 
 class vtkMRMLDisplayableNode;
+class vtkMRMLSubjectHierarchyNode;
 
 /// \brief MRML node to represent a display property for child nodes of a
 ///        subject hierarchy folder.
@@ -115,6 +116,9 @@ protected:
   vtkMRMLFolderDisplayNode(const vtkMRMLFolderDisplayNode&);
   void operator=(const vtkMRMLFolderDisplayNode&);
 
+  /// Trigger display update for the displayable node of a reparented subject hierarchy item
+  void UpdateReparentedItemDisplay(vtkMRMLSubjectHierarchyNode* shNode, vtkIdType itemID);
+
 private:
   /// Flag determining whether the display node is to be applied on the
   /// displayable nodes in the subject hierarchy branch under the item that
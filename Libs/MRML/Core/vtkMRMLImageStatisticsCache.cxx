@@ -0,0 +1,562 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkEventBroker.h"
+#include "vtkMRMLImageStatisticsCache.h"
+
+// VTK includes
+#include <vtkExtractVOI.h>
+#include <vtkIdTypeArray.h>
+#include <vtkImageData.h>
+#include <vtkImageHistogramStatistics.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// The singleton instance.
+// This MUST be default initialized to zero by the compiler and is
+// therefore not initialized here. The ClassInitialize and
+// ClassFinalize methods handle this instance.
+static vtkMRMLImageStatisticsCache* vtkMRMLImageStatisticsCacheInstance;
+
+//----------------------------------------------------------------------------
+// Must NOT be initialized. Default initialization to zero is necessary.
+unsigned int vtkMRMLImageStatisticsCacheInitialize::Count;
+
+//----------------------------------------------------------------------------
+vtkMRMLImageStatisticsCacheInitialize::vtkMRMLImageStatisticsCacheInitialize()
+{
+  if (++Self::Count == 1)
+  {
+    vtkMRMLImageStatisticsCache::classInitialize();
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLImageStatisticsCacheInitialize::~vtkMRMLImageStatisticsCacheInitialize()
+{
+  if (--Self::Count == 0)
+  {
+    vtkMRMLImageStatisticsCache::classFinalize();
+  }
+}
+
+//----------------------------------------------------------------------------
+namespace
+{
+struct ImageStatistics
+{
+  vtkWeakPointer<vtkImageData> Image;
+  vtkMTimeType ImageMTime{ 0 };
+  bool Exact{ false };
+  unsigned long LastAccess{ 0 };
+
+  double ScalarRange[2]{ 0.0, 0.0 };
+  double Mean{ 0.0 };
+  double StandardDeviation{ 0.0 };
+  double BinOrigin{ 0.0 };
+  double BinSpacing{ 1.0 };
+  std::vector<vtkIdType> Histogram;
+  vtkIdType TotalCount{ 0 };
+
+  void CopyValues(const ImageStatistics& source)
+  {
+    this->Exact = source.Exact;
+    this->ScalarRange[0] = source.ScalarRange[0];
+    this->ScalarRange[1] = source.ScalarRange[1];
+    this->Mean = source.Mean;
+    this->StandardDeviation = source.StandardDeviation;
+    this->BinOrigin = source.BinOrigin;
+    this->BinSpacing = source.BinSpacing;
+    this->Histogram = source.Histogram;
+    this->TotalCount = source.TotalCount;
+  }
+
+  double GetPercentile(double percentile) const
+  {
+    if (this->TotalCount == 0 || this->Histogram.empty())
+    {
+      return this->ScalarRange[0];
+    }
+    double targetCount = this->TotalCount * std::min(std::max(percentile, 0.0), 100.0) / 100.0;
+    vtkIdType cumulativeCount = 0;
+    for (size_t binIndex = 0; binIndex < this->Histogram.size(); ++binIndex)
+    {
+      cumulativeCount += this->Histogram[binIndex];
+      if (cumulativeCount >= targetCount)
+      {
+        return this->BinOrigin + binIndex * this->BinSpacing;
+      }
+    }
+    return this->BinOrigin + (this->Histogram.size() - 1) * this->BinSpacing;
+  }
+};
+
+struct RefinementJob
+{
+  vtkImageData* Key{ nullptr };
+  vtkMTimeType ImageMTime{ 0 };
+  /// Shallow copy of the input image, it keeps the scalar array alive
+  /// even if the original image is modified or deleted meanwhile.
+  vtkSmartPointer<vtkImageData> Image;
+};
+}
+
+//----------------------------------------------------------------------------
+class vtkMRMLImageStatisticsCache::vtkInternal
+{
+public:
+  vtkInternal(vtkMRMLImageStatisticsCache* external)
+    : External(external)
+  {
+  }
+
+  ~vtkInternal()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->StopWorker = true;
+      this->Jobs.clear();
+    }
+    this->JobsCondition.notify_all();
+    if (this->Worker.joinable())
+    {
+      this->Worker.join();
+    }
+  }
+
+  /// Compute statistics of the image. Only uses objects that are private to the
+  /// calling thread, therefore it may be called from the background thread.
+  static void ComputeStatistics(vtkImageData* image, int sampleRate, ImageStatistics& stats)
+  {
+    vtkNew<vtkImageHistogramStatistics> histogramStatistics;
+    histogramStatistics->AutomaticBinningOn();
+    vtkNew<vtkExtractVOI> subsample;
+    if (sampleRate > 1)
+    {
+      subsample->SetInputData(image);
+      subsample->SetVOI(image->GetExtent());
+      subsample->SetSampleRate(sampleRate, sampleRate, sampleRate);
+      histogramStatistics->SetInputConnection(subsample->GetOutputPort());
+    }
+    else
+    {
+      histogramStatistics->SetInputData(image);
+    }
+    histogramStatistics->Update();
+
+    stats.Exact = (sampleRate <= 1);
+    stats.ScalarRange[0] = histogramStatistics->GetMinimum();
+    stats.ScalarRange[1] = histogramStatistics->GetMaximum();
+    stats.Mean = histogramStatistics->GetMean();
+    stats.StandardDeviation = histogramStatistics->GetStandardDeviation();
+    stats.BinOrigin = histogramStatistics->GetBinOrigin();
+    stats.BinSpacing = histogramStatistics->GetBinSpacing();
+    vtkIdTypeArray* histogram = histogramStatistics->GetHistogram();
+    vtkIdType numberOfBins = histogram->GetNumberOfTuples();
+    stats.Histogram.resize(numberOfBins);
+    stats.TotalCount = 0;
+    for (vtkIdType binIndex = 0; binIndex < numberOfBins; ++binIndex)
+    {
+      stats.Histogram[binIndex] = histogram->GetValue(binIndex);
+      stats.TotalCount += stats.Histogram[binIndex];
+    }
+  }
+
+  /// Return the sampling rate along each axis that keeps the number of samples
+  /// below the maximum.
+  int GetSampleRate(vtkImageData* image, bool exact)
+  {
+    vtkIdType maximumNumberOfSamples = this->External->MaximumNumberOfApproximationSamples;
+    vtkIdType numberOfVoxels = image->GetNumberOfPoints();
+    if (exact || maximumNumberOfSamples <= 0 || numberOfVoxels <= maximumNumberOfSamples)
+    {
+      return 1;
+    }
+    int* dims = image->GetDimensions();
+    int numberOfSampledAxes = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+      if (dims[i] > 1)
+      {
+        numberOfSampledAxes++;
+      }
+    }
+    double reductionFactor = static_cast<double>(numberOfVoxels) / maximumNumberOfSamples;
+    return std::max(1, static_cast<int>(std::ceil(std::pow(reductionFactor, 1.0 / numberOfSampledAxes))));
+  }
+
+  /// Get statistics from the cache or compute them. Must be called from the main thread.
+  bool GetStatistics(vtkImageData* image, bool exact, ImageStatistics& stats)
+  {
+    if (!image || !image->GetPointData() || !image->GetPointData()->GetScalars()
+      || image->GetNumberOfPoints() < 1)
+    {
+      return false;
+    }
+    vtkMTimeType imageMTime = image->GetMTime();
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      std::map<vtkImageData*, ImageStatistics>::iterator statsIt = this->Statistics.find(image);
+      if (statsIt != this->Statistics.end()
+        && statsIt->second.Image.GetPointer() == image
+        && statsIt->second.ImageMTime == imageMTime
+        && (statsIt->second.Exact || !exact))
+      {
+        statsIt->second.LastAccess = ++this->AccessCounter;
+        stats = statsIt->second;
+        return true;
+      }
+    }
+
+    int sampleRate = this->GetSampleRate(image, exact);
+    ComputeStatistics(image, sampleRate, stats);
+    stats.Image = image;
+    stats.ImageMTime = imageMTime;
+
+    bool requestRefinement = !stats.Exact && this->External->BackgroundRefinement;
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      stats.LastAccess = ++this->AccessCounter;
+      this->Statistics[image] = stats;
+      this->RemoveLeastRecentlyUsed();
+    }
+    if (requestRefinement)
+    {
+      RefinementJob job;
+      job.Key = image;
+      job.ImageMTime = imageMTime;
+      job.Image = vtkSmartPointer<vtkImageData>::New();
+      job.Image->ShallowCopy(image);
+      this->AddJob(job);
+    }
+    return true;
+  }
+
+  /// Must be called with the mutex locked.
+  void RemoveLeastRecentlyUsed()
+  {
+    for (std::map<vtkImageData*, ImageStatistics>::iterator statsIt = this->Statistics.begin();
+      statsIt != this->Statistics.end();)
+    {
+      if (statsIt->second.Image.GetPointer() == nullptr)
+      {
+        // image has been deleted
+        statsIt = this->Statistics.erase(statsIt);
+      }
+      else
+      {
+        ++statsIt;
+      }
+    }
+    int maximumNumberOfCachedImages = std::max(1, this->External->MaximumNumberOfCachedImages);
+    while (static_cast<int>(this->Statistics.size()) > maximumNumberOfCachedImages)
+    {
+      std::map<vtkImageData*, ImageStatistics>::iterator oldestIt = this->Statistics.begin();
+      for (std::map<vtkImageData*, ImageStatistics>::iterator statsIt = this->Statistics.begin();
+        statsIt != this->Statistics.end(); ++statsIt)
+      {
+        if (statsIt->second.LastAccess < oldestIt->second.LastAccess)
+        {
+          oldestIt = statsIt;
+        }
+      }
+      this->Statistics.erase(oldestIt);
+    }
+  }
+
+  void AddJob(const RefinementJob& job)
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      // Only the latest request for an image is relevant
+      this->Jobs.erase(std::remove_if(this->Jobs.begin(), this->Jobs.end(),
+        [&job](const RefinementJob& queuedJob) { return queuedJob.Key == job.Key; }), this->Jobs.end());
+      this->Jobs.push_back(job);
+      if (!this->Worker.joinable())
+      {
+        this->Worker = std::thread(&vtkInternal::ProcessJobs, this);
+      }
+    }
+    this->JobsCondition.notify_one();
+  }
+
+  /// Background thread main loop.
+  void ProcessJobs()
+  {
+    while (true)
+    {
+      RefinementJob job;
+      {
+        std::unique_lock<std::mutex> lock(this->Mutex);
+        this->JobsCondition.wait(lock, [this] { return this->StopWorker || !this->Jobs.empty(); });
+        if (this->StopWorker)
+        {
+          return;
+        }
+        job = this->Jobs.front();
+        this->Jobs.pop_front();
+        this->WorkerBusy = true;
+      }
+
+      ImageStatistics exactStats;
+      ComputeStatistics(job.Image, 1, exactStats);
+      job.Image = nullptr;
+
+      bool updated = false;
+      {
+        std::lock_guard<std::mutex> lock(this->Mutex);
+        std::map<vtkImageData*, ImageStatistics>::iterator statsIt = this->Statistics.find(job.Key);
+        if (statsIt != this->Statistics.end()
+          && statsIt->second.ImageMTime == job.ImageMTime
+          && !statsIt->second.Exact)
+        {
+          // The image has not changed since the approximate statistics were computed.
+          // Image weak pointer is only accessed from the main thread, so only
+          // the computed values are updated here.
+          statsIt->second.CopyValues(exactStats);
+          updated = true;
+        }
+        this->WorkerBusy = false;
+      }
+      this->IdleCondition.notify_all();
+      if (updated)
+      {
+        // Notify observers on the main thread (if the application has set up a main thread
+        // event queue, otherwise the refined statistics are used the next time they are requested).
+        vtkEventBroker::GetInstance()->RequestModified(this->External);
+      }
+    }
+  }
+
+  void WaitForJobs()
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->IdleCondition.wait(lock, [this] { return this->StopWorker || (this->Jobs.empty() && !this->WorkerBusy); });
+  }
+
+  vtkMRMLImageStatisticsCache* External;
+
+  /// Protects all members below
+  std::mutex Mutex;
+  std::map<vtkImageData*, ImageStatistics> Statistics;
+  unsigned long AccessCounter{ 0 };
+
+  std::deque<RefinementJob> Jobs;
+  std::condition_variable JobsCondition;
+  std::condition_variable IdleCondition;
+  bool StopWorker{ false };
+  bool WorkerBusy{ false };
+  std::thread Worker;
+};
+
+//----------------------------------------------------------------------------
+// Up the reference count so it behaves like New
+vtkMRMLImageStatisticsCache* vtkMRMLImageStatisticsCache::New()
+{
+  vtkMRMLImageStatisticsCache* ret = vtkMRMLImageStatisticsCache::GetInstance();
+  ret->Register(nullptr);
+  return ret;
+}
+
+//----------------------------------------------------------------------------
+// Return the single instance of the vtkMRMLImageStatisticsCache
+vtkMRMLImageStatisticsCache* vtkMRMLImageStatisticsCache::GetInstance()
+{
+  if (!vtkMRMLImageStatisticsCacheInstance)
+  {
+    // Try the factory first
+    vtkMRMLImageStatisticsCacheInstance = (vtkMRMLImageStatisticsCache*)
+      vtkObjectFactory::CreateInstance("vtkMRMLImageStatisticsCache");
+    // if the factory did not provide one, then create it here
+    if (!vtkMRMLImageStatisticsCacheInstance)
+    {
+      vtkMRMLImageStatisticsCacheInstance = new vtkMRMLImageStatisticsCache;
+#ifdef VTK_HAS_INITIALIZE_OBJECT_BASE
+      vtkMRMLImageStatisticsCacheInstance->InitializeObjectBase();
+#endif
+    }
+  }
+  // return the instance
+  return vtkMRMLImageStatisticsCacheInstance;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLImageStatisticsCache::classInitialize()
+{
+  // Allocate the singleton
+  vtkMRMLImageStatisticsCacheInstance = vtkMRMLImageStatisticsCache::GetInstance();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLImageStatisticsCache::classFinalize()
+{
+  vtkMRMLImageStatisticsCacheInstance->Delete();
+  vtkMRMLImageStatisticsCacheInstance = nullptr;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLImageStatisticsCache::vtkMRMLImageStatisticsCache()
+{
+  this->AutoRangePercentiles[0] = 0.1;
+  this->AutoRangePercentiles[1] = 99.9;
+  this->MaximumNumberOfApproximationSamples = 0;
+  this->BackgroundRefinement = true;
+  this->MaximumNumberOfCachedImages = 100;
+  this->Internal = new vtkInternal(this);
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLImageStatisticsCache::~vtkMRMLImageStatisticsCache()
+{
+  delete this->Internal;
+  this->Internal = nullptr;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLImageStatisticsCache::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "AutoRangePercentiles: " << this->AutoRangePercentiles[0] << ", " << this->AutoRangePercentiles[1] << "\n";
+  os << indent << "MaximumNumberOfApproximationSamples: " << this->MaximumNumberOfApproximationSamples << "\n";
+  os << indent << "BackgroundRefinement: " << this->BackgroundRefinement << "\n";
+  os << indent << "MaximumNumberOfCachedImages: " << this->MaximumNumberOfCachedImages << "\n";
+  os << indent << "NumberOfCachedImages: " << this->GetNumberOfCachedImages() << "\n";
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLImageStatisticsCache::GetAutoRange(vtkImageData* image, double range[2], bool exact/*=false*/)
+{
+  ImageStatistics stats;
+  if (!this->Internal->GetStatistics(image, exact, stats))
+  {
+    return false;
+  }
+  range[0] = stats.GetPercentile(this->AutoRangePercentiles[0]);
+  range[1] = stats.GetPercentile(this->AutoRangePercentiles[1]);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLImageStatisticsCache::GetPercentile(vtkImageData* image, double percentile, double& value, bool exact/*=false*/)
+{
+  ImageStatistics stats;
+  if (!this->Internal->GetStatistics(image, exact, stats))
+  {
+    return false;
+  }
+  value = stats.GetPercentile(percentile);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLImageStatisticsCache::GetScalarRange(vtkImageData* image, double range[2], bool exact/*=false*/)
+{
+  ImageStatistics stats;
+  if (!this->Internal->GetStatistics(image, exact, stats))
+  {
+    return false;
+  }
+  range[0] = stats.ScalarRange[0];
+  range[1] = stats.ScalarRange[1];
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLImageStatisticsCache::GetMeanAndStandardDeviation(vtkImageData* image,
+  double& mean, double& standardDeviation, bool exact/*=false*/)
+{
+  ImageStatistics stats;
+  if (!this->Internal->GetStatistics(image, exact, stats))
+  {
+    return false;
+  }
+  mean = stats.Mean;
+  standardDeviation = stats.StandardDeviation;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLImageStatisticsCache::GetHistogram(vtkImageData* image, vtkIdTypeArray* counts,
+  double& binOrigin, double& binSpacing, bool exact/*=false*/)
+{
+  if (!counts)
+  {
+    vtkErrorMacro("GetHistogram: invalid counts array");
+    return false;
+  }
+  ImageStatistics stats;
+  if (!this->Internal->GetStatistics(image, exact, stats))
+  {
+    return false;
+  }
+  counts->SetNumberOfComponents(1);
+  counts->SetNumberOfTuples(static_cast<vtkIdType>(stats.Histogram.size()));
+  std::copy(stats.Histogram.begin(), stats.Histogram.end(), counts->GetPointer(0));
+  counts->Modified();
+  binOrigin = stats.BinOrigin;
+  binSpacing = stats.BinSpacing;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLImageStatisticsCache::IsExact(vtkImageData* image)
+{
+  if (!image)
+  {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  std::map<vtkImageData*, ImageStatistics>::iterator statsIt = this->Internal->Statistics.find(image);
+  return statsIt != this->Internal->Statistics.end()
+    && statsIt->second.Image.GetPointer() == image
+    && statsIt->second.ImageMTime == image->GetMTime()
+    && statsIt->second.Exact;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLImageStatisticsCache::RemoveImage(vtkImageData* image)
+{
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  this->Internal->Statistics.erase(image);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLImageStatisticsCache::RemoveAllImages()
+{
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  this->Internal->Statistics.clear();
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLImageStatisticsCache::GetNumberOfCachedImages()
+{
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  return static_cast<int>(this->Internal->Statistics.size());
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLImageStatisticsCache::WaitForBackgroundRefinement()
+{
+  this->Internal->WaitForJobs();
+}
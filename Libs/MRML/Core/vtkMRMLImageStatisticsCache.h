@@ -0,0 +1,160 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#ifndef __vtkMRMLImageStatisticsCache_h
+#define __vtkMRMLImageStatisticsCache_h
+
+// MRML includes
+#include "vtkMRML.h"
+
+// VTK includes
+#include <vtkObject.h>
+class vtkIdTypeArray;
+class vtkImageData;
+
+/// \brief Shared cache of image intensity statistics.
+///
+/// Computes histogram, scalar range, mean, standard deviation and percentiles
+/// of the first scalar component of an image and keeps the results until the
+/// image is modified, so that all display nodes and modules that need
+/// statistics of the same image (automatic window/level, thresholds, presets)
+/// compute them only once.
+///
+/// By default, exact statistics are computed. Approximation can be enabled
+/// by setting MaximumNumberOfApproximationSamples: for images larger than
+/// this number of voxels, the statistics are then first computed from a
+/// regularly subsampled image, which is fast and gives good estimates of
+/// the percentiles (but may slightly change the automatic window/level
+/// until the exact values are available). If BackgroundRefinement
+/// is enabled, the exact statistics are then computed in a background thread
+/// and a modified event is requested (see vtkEventBroker::RequestModified)
+/// on this object when they are available. Exact statistics can also be
+/// computed immediately by requesting them explicitly.
+///
+/// Results are indexed by image object and its modification time.
+/// The cache is a singleton, use GetInstance() to access it.
+class VTK_MRML_EXPORT vtkMRMLImageStatisticsCache : public vtkObject
+{
+public:
+  vtkTypeMacro(vtkMRMLImageStatisticsCache, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Return the singleton instance with no reference counting.
+  static vtkMRMLImageStatisticsCache* GetInstance();
+
+  /// This is a singleton pattern New. There will only be ONE
+  /// reference to a vtkMRMLImageStatisticsCache object per process.
+  /// Clients that call this must call Delete on the object so that
+  /// the reference counting will work.
+  static vtkMRMLImageStatisticsCache* New();
+
+  /// Compute the intensity range between the lower and upper AutoRangePercentiles.
+  /// Returns false if the image has no scalars.
+  /// If \a exact is true then approximate statistics are not accepted.
+  bool GetAutoRange(vtkImageData* image, double range[2], bool exact = false);
+
+  /// Get the intensity value at the given percentile (between 0 and 100).
+  /// Returns false if the image has no scalars.
+  bool GetPercentile(vtkImageData* image, double percentile, double& value, bool exact = false);
+
+  /// Get the minimum and maximum intensity value.
+  /// If statistics are approximate then the range of the sampled voxels is returned.
+  bool GetScalarRange(vtkImageData* image, double range[2], bool exact = false);
+
+  /// Get mean and standard deviation of the intensity values.
+  bool GetMeanAndStandardDeviation(vtkImageData* image, double& mean, double& standardDeviation, bool exact = false);
+
+  /// Get the histogram of the intensity values.
+  /// The center of bin i is at binOrigin + i * binSpacing.
+  /// Returns false if the image has no scalars.
+  bool GetHistogram(vtkImageData* image, vtkIdTypeArray* counts,
+    double& binOrigin, double& binSpacing, bool exact = false);
+
+  /// Return true if exact statistics are available for the current
+  /// state of the image (without computing anything).
+  bool IsExact(vtkImageData* image);
+
+  /// Remove cached statistics of an image.
+  void RemoveImage(vtkImageData* image);
+
+  /// Remove all cached statistics.
+  void RemoveAllImages();
+
+  /// Get number of images that have statistics in the cache.
+  int GetNumberOfCachedImages();
+
+  /// Percentiles used for computing the automatic intensity range.
+  /// Default is 0.1 and 99.9 (a very thin tail of the distribution does not decrease
+  /// image contrast too much but most of the intensity range is included).
+  vtkSetVector2Macro(AutoRangePercentiles, double);
+  vtkGetVector2Macro(AutoRangePercentiles, double);
+
+  /// Images that have more voxels than this are first subsampled to compute
+  /// approximate statistics. Default is 0 (always compute exact statistics).
+  /// A value of 2^22 (about 4 million voxels) makes computation of statistics
+  /// of large images interactive.
+  vtkSetMacro(MaximumNumberOfApproximationSamples, vtkIdType);
+  vtkGetMacro(MaximumNumberOfApproximationSamples, vtkIdType);
+
+  /// Compute exact statistics in a background thread after approximate
+  /// statistics are computed. Enabled by default.
+  vtkSetMacro(BackgroundRefinement, bool);
+  vtkGetMacro(BackgroundRefinement, bool);
+  vtkBooleanMacro(BackgroundRefinement, bool);
+
+  /// Maximum number of images to keep statistics for.
+  /// Least recently used statistics are removed first. Default is 100.
+  vtkSetMacro(MaximumNumberOfCachedImages, int);
+  vtkGetMacro(MaximumNumberOfCachedImages, int);
+
+  /// Wait until all background computations are completed.
+  /// Mostly useful for testing.
+  void WaitForBackgroundRefinement();
+
+protected:
+  vtkMRMLImageStatisticsCache();
+  ~vtkMRMLImageStatisticsCache() override;
+  vtkMRMLImageStatisticsCache(const vtkMRMLImageStatisticsCache&);
+  void operator=(const vtkMRMLImageStatisticsCache&);
+
+  /// Singleton management functions.
+  static void classInitialize();
+  static void classFinalize();
+
+  friend class vtkMRMLImageStatisticsCacheInitialize;
+  typedef vtkMRMLImageStatisticsCache Self;
+
+  double AutoRangePercentiles[2];
+  vtkIdType MaximumNumberOfApproximationSamples;
+  bool BackgroundRefinement;
+  int MaximumNumberOfCachedImages;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+  friend class vtkInternal;
+};
+
+/// Utility class to make sure vtkMRMLImageStatisticsCache is initialized before it is used.
+class VTK_MRML_EXPORT vtkMRMLImageStatisticsCacheInitialize
+{
+public:
+  typedef vtkMRMLImageStatisticsCacheInitialize Self;
+
+  vtkMRMLImageStatisticsCacheInitialize();
+  ~vtkMRMLImageStatisticsCacheInitialize();
+private:
+  static unsigned int Count;
+};
+
+/// This instance will show up in any translation unit that uses
+/// vtkMRMLImageStatisticsCache. It will make sure vtkMRMLImageStatisticsCache
+/// is initialized before it is used.
+static vtkMRMLImageStatisticsCacheInitialize vtkMRMLImageStatisticsCacheInitializer;
+
+#endif
@@ -99,6 +99,7 @@ vtkMRMLModelStorageNode::vtkMRMLModelStorageNode()
 {
   this->DefaultWriteFileExtension = "vtk";
   this->CoordinateSystem = vtkMRMLStorageNode::CoordinateSystemLPS;
+  this->PreReadMeshCoordinateSystem = -1;
 }
 
 //----------------------------------------------------------------------------
@@ -155,60 +156,45 @@ bool vtkMRMLModelStorageNode::CanReadInReferenceNode(vtkMRMLNode *refNode)
 }
 
 //----------------------------------------------------------------------------
-int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
+vtkPointSet* vtkMRMLModelStorageNode::ReadMeshFromFile(const char* fullNamePtr,
+  int& coordinateSystemInFileHeader, vtkMRMLMessageCollection* userMessages)
 {
-  if (this->GetWriteState() == SkippedNoData)
-  {
-    vtkDebugMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): empty model file was not saved, ignore loading");
-    return 1;
-  }
-
-  vtkMRMLModelNode *modelNode = dynamic_cast <vtkMRMLModelNode *> (refNode);
-  if (!modelNode)
+  coordinateSystemInFileHeader = -1;
+  if (!userMessages)
   {
-    vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
-      "Node for storing reading result (" << (this->ID ? this->ID : "(unknown)") << ") is not a valid model node.");
-    return 0;
-  }
-
-  std::string fullName = this->GetFullNameFromFileName();
-  if (fullName.empty())
-  {
-    vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
-      "Filename is not specified (" << (this->ID ? this->ID : "(unknown)") << ").");
-    return 0;
+    vtkGenericWarningMacro("vtkMRMLModelStorageNode::ReadMeshFromFile failed: invalid message collection");
+    return nullptr;
   }
+  std::string fullName = (fullNamePtr ? fullNamePtr : "");
+  int numberOfErrorsBeforeRead = userMessages->GetNumberOfMessagesOfType(vtkCommand::ErrorEvent);
 
   // check that the file exists
   if (vtksys::SystemTools::FileExists(fullName.c_str()) == false)
   {
-    vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
-      "Model file '" << fullName.c_str() << "' is not found while trying to read node (" << (this->ID ? this->ID : "(unknown)") << ").");
-    return 0;
+    vtkErrorToMessageCollectionWithObjectMacro(userMessages, userMessages, "vtkMRMLModelStorageNode::ReadMeshFromFile",
+      "Model file '" << fullName.c_str() << "' is not found.");
+    return nullptr;
   }
 
   // compute file prefix
   std::string extension = vtkMRMLStorageNode::GetLowercaseExtensionFromFileName(fullName);
   if( extension.empty() )
   {
-    vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
-      "Model file '" << fullName.c_str() << "' has no file extension while trying to read node (" << (this->ID ? this->ID : "(unknown)") << ").");
-    return 0;
+    vtkErrorToMessageCollectionWithObjectMacro(userMessages, userMessages, "vtkMRMLModelStorageNode::ReadMeshFromFile",
+      "Model file '" << fullName.c_str() << "' has no file extension.");
+    return nullptr;
   }
 
-  vtkDebugMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): extension = " << extension.c_str());
-
-  int coordinateSystemInFileHeader = -1;
   vtkSmartPointer<vtkPointSet> meshFromFile;
   try
   {
     if (extension == std::string(".g") || extension == std::string(".byu"))
     {
       vtkNew<vtkBYUReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetGeometryFileName(fullName.c_str());
       reader->Update();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
       meshFromFile = reader->GetOutput();
     }
     else if (extension == std::string(".vtk"))
@@ -227,10 +213,10 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
         reader->ReadAllColorScalarsOn();
         reader->ReadAllTCoordsOn();
         reader->ReadAllFieldsOn();
-        this->GetUserMessages()->SetObservedObject(reader);
+        userMessages->SetObservedObject(reader);
         reader->Update();
         meshFromFile = reader->GetOutput();
-        this->GetUserMessages()->SetObservedObject(nullptr);
+        userMessages->SetObservedObject(nullptr);
       }
       else if (unstructuredGridReader->IsFileUnstructuredGrid())
       {
@@ -241,14 +227,14 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
         unstructuredGridReader->ReadAllColorScalarsOn();
         unstructuredGridReader->ReadAllTCoordsOn();
         unstructuredGridReader->ReadAllFieldsOn();
-        this->GetUserMessages()->SetObservedObject(unstructuredGridReader);
+        userMessages->SetObservedObject(unstructuredGridReader);
         unstructuredGridReader->Update();
         meshFromFile = unstructuredGridReader->GetOutput();
-        this->GetUserMessages()->SetObservedObject(nullptr);
+        userMessages->SetObservedObject(nullptr);
       }
       else
       {
-        vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
+        vtkErrorToMessageCollectionWithObjectMacro(userMessages, userMessages, "vtkMRMLModelStorageNode::ReadMeshFromFile",
           "Failed to load model from VTK file " << fullName << " as it does not contain polydata nor unstructured grid."
           << " The file might be loadable as a volume.");
       }
@@ -257,50 +243,50 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     else if (extension == std::string(".vtp"))
     {
       vtkNew<vtkXMLPolyDataReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetFileName(fullName.c_str());
       reader->Update();
       meshFromFile = reader->GetOutput();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
       coordinateSystemInFileHeader = vtkMRMLModelStorageNode::GetCoordinateSystemFromFieldData(meshFromFile);
     }
     else if (extension == std::string(".ucd"))
     {
       vtkNew<vtkAVSucdReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetFileName(fullName.c_str());
       reader->Update();
       meshFromFile = reader->GetOutput();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
     }
     else if (extension == std::string(".vtu"))
     {
       vtkNew<vtkXMLUnstructuredGridReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetFileName(fullName.c_str());
       reader->Update();
       meshFromFile = reader->GetOutput();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
       coordinateSystemInFileHeader = vtkMRMLModelStorageNode::GetCoordinateSystemFromFieldData(meshFromFile);
     }
     else if (extension == std::string(".stl"))
     {
       vtkNew<vtkSTLReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetFileName(fullName.c_str());
       reader->Update();
       meshFromFile = reader->GetOutput();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
       coordinateSystemInFileHeader = vtkMRMLModelStorageNode::GetCoordinateSystemFromFileHeader(reader->GetHeader());
     }
     else if (extension == std::string(".ply"))
     {
       vtkNew<vtkPLYReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetFileName(fullName.c_str());
       reader->Update();
       meshFromFile = reader->GetOutput();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
       vtkStringArray* comments = reader->GetComments();
       for (int commentIndex = 0; commentIndex < comments->GetNumberOfValues(); commentIndex++)
       {
@@ -315,11 +301,11 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     else if (extension == std::string(".obj"))
     {
       vtkNew<vtkOBJReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetFileName(fullName.c_str());
       reader->Update();
       meshFromFile = reader->GetOutput();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
       coordinateSystemInFileHeader = vtkMRMLModelStorageNode::GetCoordinateSystemFromFileHeader(reader->GetComment());
     }
     else if (extension == std::string(".meta"))  // model in meta format
@@ -340,9 +326,9 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
       }
       catch(itk::ExceptionObject &ex)
       {
-        vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
+        vtkErrorToMessageCollectionWithObjectMacro(userMessages, userMessages, "vtkMRMLModelStorageNode::ReadMeshFromFile",
           "Failed to load model from ITK .meta file " << fullName << ": " << ex.GetDescription());
-        return 0;
+        return nullptr;
       }
       vtkNew<vtkPolyData> vtkMesh;
       // Get the number of points in the mesh
@@ -384,19 +370,79 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     }
     else
     {
-      vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
+      vtkErrorToMessageCollectionWithObjectMacro(userMessages, userMessages, "vtkMRMLModelStorageNode::ReadMeshFromFile",
         "Failed to load model: unrecognized file extension '" << extension << "' of file '" << fullName << "'.");
-      return 0;
+      return nullptr;
     }
   }
   catch (...)
   {
-    vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
+    vtkErrorToMessageCollectionWithObjectMacro(userMessages, userMessages, "vtkMRMLModelStorageNode::ReadMeshFromFile",
       "Failed to load model: unknown exception while trying to load the file '" << fullName << "'.");
+    return nullptr;
+  }
+
+  if (!meshFromFile
+    || userMessages->GetNumberOfMessagesOfType(vtkCommand::ErrorEvent) > numberOfErrorsBeforeRead)
+  {
+    // User messages are already logged, no need for logging more
+    return nullptr;
+  }
+
+  meshFromFile->Register(nullptr);
+  return meshFromFile;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLModelStorageNode::SetPreReadMesh(const char* fullName, vtkPointSet* meshFromFile, int coordinateSystemInFileHeader)
+{
+  this->PreReadMesh = meshFromFile;
+  this->PreReadMeshFileName = (fullName ? fullName : "");
+  this->PreReadMeshCoordinateSystem = coordinateSystemInFileHeader;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
+{
+  if (this->GetWriteState() == SkippedNoData)
+  {
+    vtkDebugMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): empty model file was not saved, ignore loading");
+    return 1;
+  }
+
+  vtkMRMLModelNode *modelNode = dynamic_cast <vtkMRMLModelNode *> (refNode);
+  if (!modelNode)
+  {
+    vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
+      "Node for storing reading result (" << (this->ID ? this->ID : "(unknown)") << ") is not a valid model node.");
+    return 0;
+  }
+
+  std::string fullName = this->GetFullNameFromFileName();
+  if (fullName.empty())
+  {
+    vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
+      "Filename is not specified (" << (this->ID ? this->ID : "(unknown)") << ").");
     return 0;
   }
 
-  if (this->GetUserMessages()->GetNumberOfMessagesOfType(vtkCommand::ErrorEvent) > 0)
+  int coordinateSystemInFileHeader = -1;
+  vtkSmartPointer<vtkPointSet> meshFromFile;
+  if (this->PreReadMesh && this->PreReadMeshFileName == fullName)
+  {
+    // mesh has been already read from this file (in a background thread)
+    meshFromFile = this->PreReadMesh;
+    coordinateSystemInFileHeader = this->PreReadMeshCoordinateSystem;
+  }
+  else
+  {
+    meshFromFile.TakeReference(vtkMRMLModelStorageNode::ReadMeshFromFile(
+      fullName.c_str(), coordinateSystemInFileHeader, this->GetUserMessages()));
+  }
+  // pre-read mesh is only used once
+  this->PreReadMesh = nullptr;
+  this->PreReadMeshFileName.clear();
+  if (!meshFromFile)
   {
     // User messages are already logged, no need for logging more
     return 0;
@@ -17,6 +17,9 @@
 
 #include "vtkMRMLStorageNode.h"
 
+// VTK includes
+#include <vtkSmartPointer.h>
+
 class vtkMRMLModelNode;
 class vtkPointSet;
 
@@ -55,6 +58,21 @@ public:
   /// between RAS and LPS coordinate system.
   static void ConvertBetweenRASAndLPS(vtkPointSet* inputMesh, vtkPointSet* outputMesh);
 
+  /// Read a mesh from file, without converting its coordinate system.
+  /// The function does not access any MRML node, therefore it can be called from a background thread
+  /// (for example, to read multiple files in parallel).
+  /// coordinateSystemInFileHeader is set to the coordinate system specified in the file (-1 if not specified).
+  /// Errors are added to userMessages, which must not be nullptr.
+  /// Returns nullptr if the file could not be read.
+  VTK_NEWINSTANCE
+  static vtkPointSet* ReadMeshFromFile(const char* fullName, int& coordinateSystemInFileHeader,
+    vtkMRMLMessageCollection* userMessages);
+
+  /// Set a mesh that has been already read from file by ReadMeshFromFile.
+  /// The next ReadData call uses this mesh instead of reading the file again if fullName
+  /// matches the full file name of the storage node. The mesh is used only once.
+  void SetPreReadMesh(const char* fullName, vtkPointSet* meshFromFile, int coordinateSystemInFileHeader);
+
 protected:
   vtkMRMLModelStorageNode();
   ~vtkMRMLModelStorageNode() override;
@@ -81,6 +99,10 @@ protected:
   static int GetCoordinateSystemFromFieldData(vtkPointSet* mesh);
 
   int CoordinateSystem;
+
+  vtkSmartPointer<vtkPointSet> PreReadMesh;
+  std::string PreReadMeshFileName;
+  int PreReadMeshCoordinateSystem;
 };
 
 #endif
@@ -774,7 +774,8 @@ void vtkMRMLNode::UpdateReferenceID(const char *oldID, const char *newID)
         vtkErrorMacro(<< "UpdateReferenceID: Reference " << i << " is expected to be non nullptr.");
         continue;
       }
-      if (std::string(oldID) == std::string(reference->GetReferencedNodeID()))
+      const char* referencedNodeID = reference->GetReferencedNodeID();
+      if (referencedNodeID && oldID && !strcmp(oldID, referencedNodeID))
       {
         this->SetAndObserveNthNodeReferenceID(reference->GetReferenceRole(), i, newID,
           reference->GetStaticEvents(), reference->GetObserveContentModifiedEvents());
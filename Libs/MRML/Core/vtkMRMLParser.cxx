@@ -13,6 +13,7 @@ Version:   $Revision: 1.8 $
 =========================================================================auto=*/
 
 // MRML includes
+#include "vtkMRMLBinarySceneWriter.h"
 #include "vtkMRMLParser.h"
 #include "vtkMRMLScene.h"
 #include "vtkMRMLStorageNode.h"
@@ -20,6 +21,7 @@ Version:   $Revision: 1.8 $
 #include "vtkMRMLSubjectHierarchyNode.h"
 #include "vtkMRMLSubjectHierarchyLegacyNode.h"
 #include "vtkMRMLSceneViewNode.h"
+#include "vtkMRMLTraceLogger.h"
 #include "vtkTagTable.h"
 
 // VTK includes
@@ -28,7 +30,52 @@ Version:   $Revision: 1.8 $
 #include <vtkStdString.h>
 
 // STD includes
+#include <cstring>
+#include <fstream>
 #include <sstream>
+#include <vector>
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+unsigned int DecodeUInt32(const char* bytes)
+{
+  const unsigned char* data = reinterpret_cast<const unsigned char*>(bytes);
+  return static_cast<unsigned int>(data[0])
+    | (static_cast<unsigned int>(data[1]) << 8)
+    | (static_cast<unsigned int>(data[2]) << 16)
+    | (static_cast<unsigned int>(data[3]) << 24);
+}
+
+//------------------------------------------------------------------------------
+/// Get a null-terminated string from the record buffer.
+/// Returns nullptr if the string is not within the record.
+const char* ReadString(const std::vector<char>& buffer, size_t& position)
+{
+  if (position + 4 > buffer.size())
+  {
+    return nullptr;
+  }
+  unsigned int size = DecodeUInt32(buffer.data() + position);
+  position += 4;
+  if (size == 0 || position + size > buffer.size() || buffer[position + size - 1] != '\0')
+  {
+    return nullptr;
+  }
+  const char* str = buffer.data() + position;
+  position += size;
+  return str;
+}
+
+//------------------------------------------------------------------------------
+struct BinarySceneSchema
+{
+  std::string TagName;
+  std::vector<std::string> AttributeNames;
+};
+
+} // end of anonymous namespace
 
 //------------------------------------------------------------------------------
 vtkStandardNewMacro(vtkMRMLParser);
@@ -36,6 +83,7 @@ vtkStandardNewMacro(vtkMRMLParser);
 //------------------------------------------------------------------------------
 void vtkMRMLParser::StartElement(const char* tagName, const char** atts)
 {
+  MRML_TRACE_SCOPE_DETAIL("MRML", "vtkMRMLParser::StartElement", tagName);
   if (!strcmp(tagName, "MRML"))
   {
     //--- BEGIN test of user tags
@@ -147,7 +195,10 @@ void vtkMRMLParser::StartElement(const char* tagName, const char** atts)
     node->SetScene(this->GetMRMLScene());
   }
 
-  node->ReadXMLAttributes(atts);
+  {
+    MRML_TRACE_SCOPE_DETAIL("MRML", "vtkMRMLNode::ReadXMLAttributes", node->GetClassName());
+    node->ReadXMLAttributes(atts);
+  }
 
   // Slicer3 snap shot nodes were hidden by default, show them so that
   // they show up in the tree views
@@ -249,3 +300,172 @@ void vtkMRMLParser::EndElement(const char *name)
 
   this->NodeStack.pop();
 }
+
+//-----------------------------------------------------------------------------
+bool vtkMRMLParser::IsBinarySceneFile(const char* fileName)
+{
+  if (!fileName)
+  {
+    return false;
+  }
+  std::ifstream ifs(fileName, std::ios::in | std::ios::binary);
+  char signature[vtkMRMLBinarySceneWriter::FileSignatureSize];
+  if (!ifs.read(signature, vtkMRMLBinarySceneWriter::FileSignatureSize))
+  {
+    return false;
+  }
+  return memcmp(signature, vtkMRMLBinarySceneWriter::GetFileSignature(), vtkMRMLBinarySceneWriter::FileSignatureSize) == 0;
+}
+
+//-----------------------------------------------------------------------------
+int vtkMRMLParser::ParseBinaryFile(const char* fileName)
+{
+  MRML_TRACE_SCOPE_DETAIL("MRML", "vtkMRMLParser::ParseBinaryFile", fileName);
+  if (!fileName)
+  {
+    vtkErrorMacro("ParseBinaryFile failed: invalid file name");
+    return 0;
+  }
+  std::ifstream ifs(fileName, std::ios::in | std::ios::binary);
+  if (!ifs.is_open())
+  {
+    vtkErrorMacro("ParseBinaryFile failed: cannot open file " << fileName);
+    return 0;
+  }
+  // File size is used for validating record sizes before allocating memory for them
+  ifs.seekg(0, std::ios::end);
+  const std::streamoff fileSize = ifs.tellg();
+  ifs.seekg(0, std::ios::beg);
+
+  char header[vtkMRMLBinarySceneWriter::FileSignatureSize + 4];
+  if (!ifs.read(header, sizeof(header))
+    || memcmp(header, vtkMRMLBinarySceneWriter::GetFileSignature(), vtkMRMLBinarySceneWriter::FileSignatureSize) != 0)
+  {
+    vtkErrorMacro("ParseBinaryFile failed: " << fileName << " is not a binary scene file");
+    return 0;
+  }
+  unsigned int formatVersion = DecodeUInt32(header + vtkMRMLBinarySceneWriter::FileSignatureSize);
+  if (formatVersion > vtkMRMLBinarySceneWriter::FormatVersion)
+  {
+    vtkErrorMacro("ParseBinaryFile failed: " << fileName << " has format version " << formatVersion
+      << ", only versions up to " << vtkMRMLBinarySceneWriter::FormatVersion << " are supported");
+    return 0;
+  }
+
+  std::vector<BinarySceneSchema> schemas;
+  // Schema index of each open element, needed for calling EndElement with the tag name
+  std::vector<unsigned int> openElements;
+  // Record buffer is reused, attribute values are used directly from it
+  std::vector<char> buffer;
+  std::vector<const char*> atts;
+  bool endOfScene = false;
+  while (!endOfScene)
+  {
+    char recordHeader[5];
+    if (!ifs.read(recordHeader, 5))
+    {
+      vtkErrorMacro("ParseBinaryFile failed: unexpected end of file " << fileName);
+      return 0;
+    }
+    unsigned char recordType = static_cast<unsigned char>(recordHeader[0]);
+    unsigned int recordSize = DecodeUInt32(recordHeader + 1);
+    const std::streamoff remainingSize = fileSize - static_cast<std::streamoff>(ifs.tellg());
+    if (static_cast<std::streamoff>(recordSize) > remainingSize)
+    {
+      vtkErrorMacro("ParseBinaryFile failed: record size " << recordSize << " exceeds the remaining "
+        << remainingSize << " bytes in file " << fileName);
+      return 0;
+    }
+    buffer.resize(recordSize);
+    if (recordSize > 0 && !ifs.read(buffer.data(), recordSize))
+    {
+      vtkErrorMacro("ParseBinaryFile failed: unexpected end of file " << fileName);
+      return 0;
+    }
+
+    size_t position = 0;
+    switch (recordType)
+    {
+      case vtkMRMLBinarySceneWriter::RecordSchema:
+      {
+        BinarySceneSchema schema;
+        const char* tagName = ReadString(buffer, position);
+        if (!tagName || position + 4 > buffer.size())
+        {
+          vtkErrorMacro("ParseBinaryFile failed: invalid schema record in " << fileName);
+          return 0;
+        }
+        schema.TagName = tagName;
+        unsigned int numberOfAttributes = DecodeUInt32(buffer.data() + position);
+        position += 4;
+        for (unsigned int attributeIndex = 0; attributeIndex < numberOfAttributes; ++attributeIndex)
+        {
+          const char* attributeName = ReadString(buffer, position);
+          if (!attributeName)
+          {
+            vtkErrorMacro("ParseBinaryFile failed: invalid schema record in " << fileName);
+            return 0;
+          }
+          schema.AttributeNames.emplace_back(attributeName);
+        }
+        schemas.push_back(std::move(schema));
+        break;
+      }
+      case vtkMRMLBinarySceneWriter::RecordStartElement:
+      {
+        unsigned int schemaIndex = (buffer.size() >= 4 ? DecodeUInt32(buffer.data()) : static_cast<unsigned int>(schemas.size()));
+        if (schemaIndex >= schemas.size())
+        {
+          vtkErrorMacro("ParseBinaryFile failed: invalid element record in " << fileName);
+          return 0;
+        }
+        position = 4;
+        const BinarySceneSchema& schema = schemas[schemaIndex];
+        atts.clear();
+        for (const std::string& attributeName : schema.AttributeNames)
+        {
+          const char* value = nullptr;
+          if (position < buffer.size() && buffer[position] == vtkMRMLBinarySceneWriter::ValueString)
+          {
+            ++position;
+            value = ReadString(buffer, position);
+          }
+          if (!value)
+          {
+            vtkErrorMacro("ParseBinaryFile failed: invalid value of attribute " << attributeName
+              << " in element " << schema.TagName << " in " << fileName);
+            return 0;
+          }
+          atts.push_back(attributeName.c_str());
+          atts.push_back(value);
+        }
+        atts.push_back(nullptr);
+        this->StartElement(schema.TagName.c_str(), atts.data());
+        openElements.push_back(schemaIndex);
+        break;
+      }
+      case vtkMRMLBinarySceneWriter::RecordEndElement:
+        if (openElements.empty())
+        {
+          vtkErrorMacro("ParseBinaryFile failed: unexpected end element record in " << fileName);
+          return 0;
+        }
+        this->EndElement(schemas[openElements.back()].TagName.c_str());
+        openElements.pop_back();
+        break;
+      case vtkMRMLBinarySceneWriter::RecordEndOfScene:
+        endOfScene = true;
+        break;
+      default:
+        // Unknown record types are optional additions to the format, skip them
+        break;
+    }
+  }
+
+  if (!openElements.empty())
+  {
+    vtkErrorMacro("ParseBinaryFile failed: " << openElements.size() << " elements are not ended in " << fileName);
+    return 0;
+  }
+  return 1;
+}
@@ -34,6 +34,15 @@ public:
   vtkCollection* GetNodeCollection() {return this->NodeCollection;};
   void SetNodeCollection(vtkCollection* scene) {this->NodeCollection = scene;};
 
+  /// Read a scene file that was written in binary format.
+  /// Nodes are created the same way as when an XML scene file is parsed.
+  /// Returns 1 on success, 0 on failure.
+  /// \sa vtkMRMLBinarySceneWriter, IsBinarySceneFile()
+  int ParseBinaryFile(const char* fileName);
+
+  /// Returns true if the file starts with the binary scene file signature.
+  static bool IsBinarySceneFile(const char* fileName);
+
 protected:
   vtkMRMLParser() = default;;
   ~vtkMRMLParser() override  = default;
@@ -14,6 +14,7 @@ Version:   $Revision: 1.2 $
 
 // MRML includes
 #include "vtkEventBroker.h"
+#include "vtkMRMLImageStatisticsCache.h"
 #include "vtkMRMLScalarVolumeDisplayNode.h"
 #include "vtkMRMLScene.h"
 #include "vtkMRMLProceduralColorNode.h"
@@ -107,6 +108,9 @@ vtkMRMLScalarVolumeDisplayNode::vtkMRMLScalarVolumeDisplayNode()
 
   vtkEventBroker::GetInstance()->AddObservation(
     this, vtkCommand::ModifiedEvent, this, this->MRMLCallbackCommand  , 10000.);
+  // Get notified when approximate image statistics are refined
+  vtkEventBroker::GetInstance()->AddObservation(
+    vtkMRMLImageStatisticsCache::GetInstance(), vtkCommand::ModifiedEvent, this, this->MRMLCallbackCommand);
 }
 
 //----------------------------------------------------------------------------
@@ -128,6 +132,9 @@ vtkMRMLScalarVolumeDisplayNode::~vtkMRMLScalarVolumeDisplayNode()
     this->HistogramStatistics->Delete();
     this->HistogramStatistics = nullptr;
   }
+
+  vtkEventBroker::GetInstance()->RemoveObservations(
+    vtkMRMLImageStatisticsCache::GetInstance(), vtkCommand::ModifiedEvent, this, this->MRMLCallbackCommand);
 }
 
 //----------------------------------------------------------------------------
@@ -412,6 +419,18 @@ void vtkMRMLScalarVolumeDisplayNode::ProcessMRMLEvents ( vtkObject *caller,
   {
     this->CalculateAutoLevels();
   }
+  if (caller == vtkMRMLImageStatisticsCache::GetInstance() &&
+      event == vtkCommand::ModifiedEvent)
+  {
+    // Exact statistics may have become available for the image
+    // (only update if it is already in the cache to not trigger computations
+    // for every display node)
+    vtkImageData* imageDataScalar = this->GetScalarImageData();
+    if (imageDataScalar && vtkMRMLImageStatisticsCache::GetInstance()->IsExact(imageDataScalar))
+    {
+      this->CalculateAutoLevels();
+    }
+  }
   if (caller == this && event == vtkCommand::ModifiedEvent &&
       !this->IsInCalculateAutoLevels)
   {
@@ -746,32 +765,27 @@ void vtkMRMLScalarVolumeDisplayNode::CalculateAutoLevels()
     return;
   }
 
-  if (this->HistogramStatistics == nullptr)
-  {
-    this->HistogramStatistics = vtkImageHistogramStatistics::New();
-
-    // Set automatic window/level to include the entire intensity range
-    // (except top/bottom 0.1%, to not let a very thin tail of the intensity
-    // distribution to decrease the image contrast too much).
-    // While in CT and sometimes in MRI, there may be a large empty area
-    // outside the reconstructed image, which could be suppressed
-    // by a larger lower percentile value, it would make the method
-    // too specific to particular imaging modalities and could lead to
-    // suboptimal results for other types of images.
-    // Therefore, we choose small, symmetric percentile values here
-    // and maybe add modality-specific methods later (e.g., for CT
-    // images we could set lower value to -1000HU).
-    this->HistogramStatistics->SetAutoRangePercentiles(0.1, 99.9);
-
-    // Percentiles are very low (0.1%), so there is no need for
-    // range expansion.
-    this->HistogramStatistics->SetAutoRangeExpansionFactors(0.0, 0.0);
+  // Set automatic window/level to include the entire intensity range
+  // (except top/bottom 0.1%, to not let a very thin tail of the intensity
+  // distribution to decrease the image contrast too much).
+  // While in CT and sometimes in MRI, there may be a large empty area
+  // outside the reconstructed image, which could be suppressed
+  // by a larger lower percentile value, it would make the method
+  // too specific to particular imaging modalities and could lead to
+  // suboptimal results for other types of images.
+  // Therefore, the shared statistics cache uses small, symmetric percentile
+  // values (see vtkMRMLImageStatisticsCache::AutoRangePercentiles).
+  // Statistics are exact unless approximation is enabled in the cache
+  // (then large images are first estimated from a subsampled image
+  // and refined in the background).
+  double intensityRange[2] = { 0.0, 0.0 };
+  if (!vtkMRMLImageStatisticsCache::GetInstance()->GetAutoRange(imageDataScalar, intensityRange))
+  {
+    vtkDebugMacro("CalculateScalarAutoLevels: failed to compute image statistics");
+    return;
   }
 
   this->IsInCalculateAutoLevels = true;
-  this->HistogramStatistics->SetInputData(imageDataScalar);
-  this->HistogramStatistics->Update();
-  double* intensityRange = this->HistogramStatistics->GetAutoRange();
   vtkDebugMacro("CalculateScalarAutoLevels:"
                 << " lower: " << intensityRange[0] << " upper: " << intensityRange[1]);
 
@@ -248,8 +248,12 @@ protected:
   std::vector<WindowLevelPreset> WindowLevelPresets;
 
   ///
-  /// Used internally in CalculateScalarAutoLevels and CalculateStatisticsAutoLevels
+  /// \deprecated Kept only for backward compatibility of subclasses, not used anymore.
+  /// Image statistics are computed by vtkMRMLImageStatisticsCache.
   vtkImageHistogramStatistics *HistogramStatistics;
+
+  ///
+  /// Used internally in CalculateAutoLevels
   bool IsInCalculateAutoLevels;
 };
 
@@ -13,6 +13,7 @@ Version:   $Revision: 1.18 $
 =========================================================================auto=*/
 
 #include "vtkMRMLScene.h"
+#include "vtkMRMLBinarySceneWriter.h"
 #include "vtkMRMLParser.h"
 
 #include "vtkArchive.h"
@@ -65,6 +66,7 @@ Version:   $Revision: 1.18 $
 #include "vtkMRMLTableViewNode.h"
 #include "vtkMRMLTextNode.h"
 #include "vtkMRMLTextStorageNode.h"
+#include "vtkMRMLTraceLogger.h"
 #include "vtkMRMLTransformDisplayNode.h"
 #include "vtkMRMLTransformNode.h"
 #include "vtkMRMLTransformStorageNode.h"
@@ -99,6 +101,8 @@ Version:   $Revision: 1.18 $
 // STD includes
 #include <algorithm>
 #include <numeric>
+#include <unordered_map>
+#include <unordered_set>
 
 //#define MRMLSCENE_VERBOSE
 
@@ -131,6 +135,8 @@ vtkMRMLScene::vtkMRMLScene()
 
   this->SaveToXMLString = 0;
 
+  this->SaveInBinaryFormat = false;
+
   this->ReadDataOnLoad = 1;
 
   this->LastLoadedVersion = nullptr;
@@ -718,6 +724,9 @@ void vtkMRMLScene::StartState(unsigned long state, int anticipatedMaxProgress)
 //------------------------------------------------------------------------------
 void vtkMRMLScene::EndState(unsigned long state)
 {
+  // Observers of end state events (displayable managers, widgets, etc.)
+  // typically perform full updates here.
+  MRML_TRACE_SCOPE("MRML", "vtkMRMLScene::EndState");
   if (this->States.empty())
   {
     vtkErrorMacro("vtkMRMLScene::EndState failed: there was no previous state");
@@ -763,6 +772,7 @@ void vtkMRMLScene::ProgressState(unsigned long state, int progress)
 //------------------------------------------------------------------------------
 int vtkMRMLScene::Connect(vtkMRMLMessageCollection* userMessagesInput/*=nullptr*/)
 {
+  MRML_TRACE_SCOPE_DETAIL("MRML", "vtkMRMLScene::Connect", this->URL.c_str());
   if (this->IsClosing())
   {
     vtkWarningMacro("vtkMRMLScene::Connect(): scene is in closing state");
@@ -801,6 +811,7 @@ int vtkMRMLScene::Connect(vtkMRMLMessageCollection* userMessagesInput/*=nullptr*
 //------------------------------------------------------------------------------
 int vtkMRMLScene::Import(vtkMRMLMessageCollection* userMessagesInput/*=nullptr*/)
 {
+  MRML_TRACE_SCOPE_DETAIL("MRML", "vtkMRMLScene::Import", this->URL.c_str());
   bool wasSceneModified = this->GetModifiedSinceRead();
 
   // We use userMessages for collecting error information, so make sure we have it, even if the caller does not need it.
@@ -846,10 +857,13 @@ int vtkMRMLScene::Import(vtkMRMLMessageCollection* userMessagesInput/*=nullptr*/
     // in case of singleton nodes the existing singleton node is kept
     // and only the contents is overwritten.
     vtkSmartPointer<vtkCollection> addedNodes = vtkSmartPointer<vtkCollection>::New();
-    for (loadedNodes->InitTraversal(it);
-         (node = (vtkMRMLNode*)loadedNodes->GetNextItemAsObject(it)) ;)
     {
-      addedNodes->AddItem(this->AddNode(node));
+      MRML_TRACE_SCOPE("MRML", "vtkMRMLScene::Import AddNodes");
+      for (loadedNodes->InitTraversal(it);
+           (node = (vtkMRMLNode*)loadedNodes->GetNextItemAsObject(it)) ;)
+      {
+        addedNodes->AddItem(this->AddNode(node));
+      }
     }
 #ifdef MRMLSCENE_VERBOSE
     addNodesTimer->StopTimer();
@@ -885,6 +899,7 @@ int vtkMRMLScene::Import(vtkMRMLMessageCollection* userMessagesInput/*=nullptr*/
       vtkDebugMacro("Adding Node: " << (node->GetName() ? node->GetName() : "(undefined)"));
       if (node->GetAddToScene())
       {
+        MRML_TRACE_SCOPE_DETAIL("MRML", "vtkMRMLNode::UpdateScene", node->GetID());
         int errorsBefore = userMessages->GetNumberOfMessagesOfType(vtkCommand::ErrorEvent);
         userMessages->SetObservedObject(node);
         node->UpdateScene(this);
@@ -954,6 +969,7 @@ int vtkMRMLScene::Import(vtkMRMLMessageCollection* userMessagesInput/*=nullptr*/
 //------------------------------------------------------------------------------
 int vtkMRMLScene::LoadIntoScene(vtkCollection* nodeCollection, vtkMRMLMessageCollection* userMessagesInput/*=nullptr*/)
 {
+  MRML_TRACE_SCOPE_DETAIL("MRML", "vtkMRMLScene::LoadIntoScene", this->URL.c_str());
   // We use userMessages for collecting error information, so make sure we have it, even if the caller does not need it.
   vtkSmartPointer<vtkMRMLMessageCollection> userMessages = userMessagesInput;
   if (!userMessages)
@@ -1021,6 +1037,11 @@ int vtkMRMLScene::LoadIntoScene(vtkCollection* nodeCollection, vtkMRMLMessageCol
     {
       success = parser->Parse(this->GetSceneXMLString().c_str());
     }
+    else if (vtkMRMLParser::IsBinarySceneFile(this->URL.c_str()))
+    {
+      vtkDebugMacro("Parsing binary scene file: " << this->URL.c_str());
+      success = parser->ParseBinaryFile(this->URL.c_str());
+    }
     else
     {
       vtkDebugMacro("Parsing: " << this->URL.c_str());
@@ -1038,6 +1059,7 @@ int vtkMRMLScene::LoadIntoScene(vtkCollection* nodeCollection, vtkMRMLMessageCol
 //------------------------------------------------------------------------------
 int vtkMRMLScene::Commit(const char* url, vtkMRMLMessageCollection * userMessagesInput/*=nullptr*/)
 {
+  MRML_TRACE_SCOPE_DETAIL("MRML", "vtkMRMLScene::Commit", url ? url : this->URL.c_str());
   // We use userMessages for collecting error information, so make sure we have it, even if the caller does not need it.
   vtkSmartPointer<vtkMRMLMessageCollection> userMessages = userMessagesInput;
   if (!userMessages)
@@ -1065,6 +1087,9 @@ int vtkMRMLScene::Commit(const char* url, vtkMRMLMessageCollection * userMessage
 
   std::ostream *os = nullptr;
 
+  // Binary format is only used for scene files
+  bool saveInBinaryFormat = this->SaveInBinaryFormat && !this->GetSaveToXMLString();
+
   if (this->GetSaveToXMLString())
   {
     os = &oss;
@@ -1079,7 +1104,7 @@ int vtkMRMLScene::Commit(const char* url, vtkMRMLMessageCollection * userMessage
 #ifdef _WIN32
     ofs.open(url, std::ios::out | std::ios::binary);
 #else
-    ofs.open(url, std::ios::out);
+    ofs.open(url, saveInBinaryFormat ? (std::ios::out | std::ios::binary) : std::ios::out);
 #endif
     if (ofs.fail())
     {
@@ -1088,6 +1113,13 @@ int vtkMRMLScene::Commit(const char* url, vtkMRMLMessageCollection * userMessage
     }
   }
 
+  vtkNew<vtkMRMLBinarySceneWriter> binaryWriter;
+  if (saveInBinaryFormat)
+  {
+    binaryWriter->SetStream(os);
+    binaryWriter->WriteHeader();
+  }
+
   int indent=0;
 
   // this event is being detected by GUI to provide feedback during load
@@ -1098,21 +1130,19 @@ int vtkMRMLScene::Commit(const char* url, vtkMRMLMessageCollection * userMessage
   //file << "<?xml version=\"1.0\" standalone='no'?>\n";
   //file << "<!DOCTYPE MRML SYSTEM \"mrml20.dtd\">\n";
 
-  // Add XML encoding specification. Slicer uses the UTF-8 character set.
-  *os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
-
-  //--- BEGIN test of user tags
-  //file << "<MRML>\n";
-  *os << "<MRML";
+  // Scene attributes (name, value pairs)
+  std::vector<std::string> sceneAttributes;
 
   // write version
   if (this->GetVersion())
   {
-    *os << " version=\"" << this->GetVersion() << "\"";
+    sceneAttributes.emplace_back("version");
+    sceneAttributes.emplace_back(this->GetVersion());
   }
   if (this->GetExtensions() && strlen(this->GetExtensions())>0)
   {
-    *os << " extensions=\"" << this->GetExtensions() << "\"";
+    sceneAttributes.emplace_back("extensions");
+    sceneAttributes.emplace_back(this->GetExtensions());
   }
 
   //---write any user tags.
@@ -1138,12 +1168,30 @@ int vtkMRMLScene::Commit(const char* url, vtkMRMLMessageCollection * userMessage
     }
     if ( ss.str().c_str()!= nullptr )
     {
-      *os << " userTags=\"" << ss.str().c_str() << "\"";
+      sceneAttributes.emplace_back("userTags");
+      sceneAttributes.emplace_back(ss.str());
     }
   }
 
-  *os << ">\n";
-  //--- END test of user tags
+  if (saveInBinaryFormat)
+  {
+    binaryWriter->WriteStartElement("MRML", sceneAttributes);
+  }
+  else
+  {
+    // Add XML encoding specification. Slicer uses the UTF-8 character set.
+    *os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+
+    //--- BEGIN test of user tags
+    //file << "<MRML>\n";
+    *os << "<MRML";
+    for (size_t attributeIndex = 0; attributeIndex + 1 < sceneAttributes.size(); attributeIndex += 2)
+    {
+      *os << " " << sceneAttributes[attributeIndex] << "=\"" << sceneAttributes[attributeIndex + 1] << "\"";
+    }
+    *os << ">\n";
+    //--- END test of user tags
+  }
 
   // Write each node
   int n;
@@ -1155,15 +1203,26 @@ int vtkMRMLScene::Commit(const char* url, vtkMRMLMessageCollection * userMessage
       continue;
     }
 
-    vtkIndent vindent(indent);
-    *os << vindent << "<" << node->GetNodeTagName() << "\n ";
-
-    if(indent<=0)
-      indent = 1;
-
     vtkNew<vtkMRMLMessageCollection> nodeWritingMessages;
     nodeWritingMessages->SetObservedObject(node);
-    node->WriteXML(*os, indent);
+    if (saveInBinaryFormat)
+    {
+      // node attributes and body are captured from the node's XML output
+      binaryWriter->WriteNode(node);
+    }
+    else
+    {
+      vtkIndent vindent(indent);
+      *os << vindent << "<" << node->GetNodeTagName() << "\n ";
+
+      if(indent<=0)
+        indent = 1;
+
+      node->WriteXML(*os, indent);
+      *os << vindent << ">";
+      node->WriteNodeBodyXML(*os, indent);
+      *os << "</" << node->GetNodeTagName() << ">\n";
+    }
     nodeWritingMessages->SetObservedObject(nullptr);
     if (nodeWritingMessages->GetNumberOfMessagesOfType(vtkCommand::ErrorEvent) > 0)
     {
@@ -1177,13 +1236,22 @@ int vtkMRMLScene::Commit(const char* url, vtkMRMLMessageCollection * userMessage
         << (node->GetName() ? node->GetName() : "(unknown)") << " (" << (node->GetID() ? node->GetID() : "unknown") << ")"
         << " node to XML - see application log for details");
     }
-
-    *os << vindent << ">";
-    node->WriteNodeBodyXML(*os, indent);
-    *os << "</" << node->GetNodeTagName() << ">\n";
   }
 
-  *os << "</MRML>\n";
+  if (saveInBinaryFormat)
+  {
+    binaryWriter->WriteEndElement();
+    binaryWriter->WriteEndOfScene();
+    if (!binaryWriter->IsValid())
+    {
+      vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLScene::Commit",
+        "Scene writing failed: error while writing binary scene file " << url);
+    }
+  }
+  else
+  {
+    *os << "</MRML>\n";
+  }
 
   // Close file
   if (this->GetSaveToXMLString())
@@ -3236,7 +3304,7 @@ int vtkMRMLScene::IsFilePathRelative(const char * filepath)
 //------------------------------------------------------------------------------
 const char* vtkMRMLScene::GetChangedID(const char* id)
 {
-  std::map< std::string, std::string>::const_iterator iter = this->ReferencedIDChanges.find(std::string(id));
+  ReferencedIDChangesType::const_iterator iter = this->ReferencedIDChanges.find(std::string(id));
   if (iter == this->ReferencedIDChanges.end())
   {
     return nullptr;
@@ -3250,35 +3318,100 @@ const char* vtkMRMLScene::GetChangedID(const char* id)
 //------------------------------------------------------------------------------
 void vtkMRMLScene::UpdateNodeReferences(vtkCollection* checkNodes/*=nullptr*/)
 {
-  for (std::map< std::string, std::string>::const_iterator iterChanged = this->ReferencedIDChanges.begin();
+  MRML_TRACE_SCOPE("MRML", "vtkMRMLScene::UpdateNodeReferences");
+  if (this->ReferencedIDChanges.empty())
+  {
+    return;
+  }
+
+  // Set of nodes to update. vtkCollection::IsItemPresent is a linear search,
+  // which would make the update quadratic when many nodes are imported.
+  std::unordered_set<vtkMRMLNode*> nodesToUpdate;
+  if (checkNodes)
+  {
+    vtkMRMLNode* node = nullptr;
+    vtkCollectionSimpleIterator it;
+    for (checkNodes->InitTraversal(it);
+      (node = vtkMRMLNode::SafeDownCast(checkNodes->GetNextItemAsObject(it)));)
+    {
+      nodesToUpdate.insert(node);
+    }
+  }
+
+  // Collect all reference updates in one pass over the ID changes before modifying
+  // any node, so that references are not modified while they are being iterated.
+  typedef std::pair< vtkMRMLNode*, std::vector<ReferencedIDChangesType::const_iterator> > NodeReferenceUpdatesType;
+  std::vector<NodeReferenceUpdatesType> referenceUpdates;
+  std::unordered_map<vtkMRMLNode*, size_t> referenceUpdateIndices;
+  for (ReferencedIDChangesType::const_iterator iterChanged = this->ReferencedIDChanges.begin();
     iterChanged != this->ReferencedIDChanges.end(); iterChanged++)
   {
-    const std::string& oldID = iterChanged->first;
-    const std::string& newID = iterChanged->second;
-    NodeReferencesType::iterator referencedIdIt=this->NodeReferences.find(oldID);
-    if (referencedIdIt==this->NodeReferences.end())
+    NodeReferencesType::iterator referencedIdIt = this->NodeReferences.find(iterChanged->first);
+    if (referencedIdIt == this->NodeReferences.end())
     {
       // this updated ID is not observed by any node
       continue;
     }
-    // make a copy of the node list, as the list may change as a result of UpdateReferenceID calls
-    std::set<std::string> nodesToNotify=referencedIdIt->second;
-    for (NodeReferencesType::value_type::second_type::iterator referringNodesIt = nodesToNotify.begin();
-      referringNodesIt!=nodesToNotify.end();
-      ++referringNodesIt)
+    for (const std::string& referencingNodeID : referencedIdIt->second)
     {
-      vtkMRMLNode *node = this->GetNodeByID(*referringNodesIt);
-      if (node==nullptr)
+      vtkMRMLNode* node = this->GetNodeByID(referencingNodeID);
+      if (node == nullptr)
       {
         continue;
       }
-      if (checkNodes!=nullptr && !checkNodes->IsItemPresent(node))
+      if (checkNodes != nullptr && nodesToUpdate.find(node) == nodesToUpdate.end())
       {
         continue;
       }
-      node->UpdateReferenceID(oldID.c_str(), newID.c_str());
+      auto updateIndexIt = referenceUpdateIndices.find(node);
+      if (updateIndexIt == referenceUpdateIndices.end())
+      {
+        updateIndexIt = referenceUpdateIndices.emplace(node, referenceUpdates.size()).first;
+        referenceUpdates.emplace_back(node, std::vector<ReferencedIDChangesType::const_iterator>());
+      }
+      referenceUpdates[updateIndexIt->second].second.push_back(iterChanged);
     }
   }
+
+  // Update all references of each node in a single modification.
+  // All references are resolved against the original ID changes: if a new ID is also
+  // an old ID (A->B, B->C) then a reference to A must be changed to B and not to C.
+  for (const NodeReferenceUpdatesType& nodeUpdates : referenceUpdates)
+  {
+    vtkMRMLNode* node = nodeUpdates.first;
+    bool chainedChanges = false;
+    for (ReferencedIDChangesType::const_iterator iterChanged : nodeUpdates.second)
+    {
+      if (this->ReferencedIDChanges.find(iterChanged->second) != this->ReferencedIDChanges.end())
+      {
+        chainedChanges = true;
+        break;
+      }
+    }
+    int wasModifying = node->StartModify();
+    if (!chainedChanges)
+    {
+      for (ReferencedIDChangesType::const_iterator iterChanged : nodeUpdates.second)
+      {
+        node->UpdateReferenceID(iterChanged->first.c_str(), iterChanged->second.c_str());
+      }
+    }
+    else
+    {
+      // Change references to temporary IDs first, which are not in ReferencedIDChanges,
+      // so that an updated reference is not updated again.
+      const std::string temporaryIDPrefix = "UpdateNodeReferences:";
+      for (ReferencedIDChangesType::const_iterator iterChanged : nodeUpdates.second)
+      {
+        node->UpdateReferenceID(iterChanged->first.c_str(), (temporaryIDPrefix + iterChanged->first).c_str());
+      }
+      for (ReferencedIDChangesType::const_iterator iterChanged : nodeUpdates.second)
+      {
+        node->UpdateReferenceID((temporaryIDPrefix + iterChanged->first).c_str(), iterChanged->second.c_str());
+      }
+    }
+    node->EndModify(wasModifying);
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -3407,22 +3540,35 @@ void vtkMRMLScene::CopyNodeChangedIDs(vtkMRMLScene *scene)
 //------------------------------------------------------------------------------
 void vtkMRMLScene::UpdateNodeChangedIDs()
 {
-  std::map< std::string, std::string>::const_iterator iterChanged;
-  vtkMRMLNode *node;
+  this->UpdateNodeIDs();
 
-  for (iterChanged = this->ReferencedIDChanges.begin(); iterChanged != this->ReferencedIDChanges.end(); iterChanged++)
+  // Find all nodes first, so that a node that gets the old ID of another
+  // node does not hide that node.
+  std::vector< std::pair< vtkSmartPointer<vtkMRMLNode>, const std::string* > > nodesToUpdate;
+  for (ReferencedIDChangesType::const_iterator iterChanged = this->ReferencedIDChanges.begin();
+    iterChanged != this->ReferencedIDChanges.end(); iterChanged++)
   {
-    if (iterChanged->first.c_str() && iterChanged->first != "")
+    if (iterChanged->first.empty())
     {
-      node = this->GetNodeByID(iterChanged->first.c_str());
-      if (node)
-      {
-        node->SetID(iterChanged->second.c_str());
-      }
+      continue;
+    }
+    std::map< std::string, vtkSmartPointer<vtkMRMLNode> >::iterator nodeIt = this->NodeIDs.find(iterChanged->first);
+    if (nodeIt != this->NodeIDs.end())
+    {
+      nodesToUpdate.emplace_back(nodeIt->second, &iterChanged->second);
     }
   }
-  this->NodeIDsMTime = 0;
-  this->UpdateNodeIDs();
+
+  // Update the node ID map incrementally instead of rebuilding it
+  for (const auto& nodeToUpdate : nodesToUpdate)
+  {
+    this->NodeIDs.erase(nodeToUpdate.first->GetID());
+  }
+  for (const auto& nodeToUpdate : nodesToUpdate)
+  {
+    nodeToUpdate.first->SetID(nodeToUpdate.second->c_str());
+    this->AddNodeID(nodeToUpdate.first);
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -3860,6 +4006,7 @@ void vtkMRMLScene::TrimUndoStack()
 //----------------------------------------------------------------------------
 bool vtkMRMLScene::WriteToMRB(const char* filename, vtkImageData* thumbnail/*=nullptr*/, vtkMRMLMessageCollection* userMessages/*=nullptr*/)
 {
+  MRML_TRACE_SCOPE_DETAIL("MRML", "vtkMRMLScene::WriteToMRB", filename);
   //
   // make a temp directory to save the scene into - this will
   // be a uniquely named directory that contains a directory
@@ -3946,6 +4093,7 @@ bool vtkMRMLScene::WriteToMRB(const char* filename, vtkImageData* thumbnail/*=nu
 //-----------------------------------------------------------------------------
 bool vtkMRMLScene::ReadFromMRB(const char* fullName, bool clear/*=false*/, vtkMRMLMessageCollection* userMessagesInput/*=nullptr*/)
 {
+  MRML_TRACE_SCOPE_DETAIL("MRML", "vtkMRMLScene::ReadFromMRB", fullName);
   // We use userMessages for collecting error information, so make sure we have it, even if the caller does not need it.
   vtkSmartPointer<vtkMRMLMessageCollection> userMessages = userMessagesInput;
   if (!userMessages)
@@ -4120,6 +4268,7 @@ std::string vtkMRMLScene::UnpackSlicerDataBundle(const char* sdbFilePath, const
 bool vtkMRMLScene::SaveSceneToSlicerDataBundleDirectory(const char* sdbDir,
   vtkImageData* screenShot/*=nullptr*/, vtkMRMLMessageCollection* userMessagesInput/*=nullptr*/)
 {
+  MRML_TRACE_SCOPE_DETAIL("MRML", "vtkMRMLScene::SaveSceneToSlicerDataBundleDirectory", sdbDir);
   // Overview:
   // - confirm the arguments are valid and create directories if needed
   // - save all current file storage paths in the scene
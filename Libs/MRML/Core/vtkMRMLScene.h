@@ -517,6 +517,20 @@ public:
   vtkSetMacro(SaveToXMLString,int);
   vtkGetMacro(SaveToXMLString,int);
 
+  /// \brief This property controls whether Commit() should save the scene file
+  /// in compact binary format instead of XML.
+  ///
+  /// Binary scene files are faster to read and are smaller than XML scene files,
+  /// but they cannot be read by application versions that precede the binary format.
+  /// Writing is slower than writing XML, as node content is still generated as
+  /// XML and then parsed again to convert it (see vtkMRMLBinarySceneWriter).
+  /// Import() detects the format of the scene file automatically.
+  /// The property is ignored if SaveToXMLString is enabled. Disabled by default.
+  /// \sa Commit(), vtkMRMLBinarySceneWriter
+  vtkSetMacro(SaveInBinaryFormat,bool);
+  vtkGetMacro(SaveInBinaryFormat,bool);
+  vtkBooleanMacro(SaveInBinaryFormat,bool);
+
   vtkSetMacro(ReadDataOnLoad,int);
   vtkGetMacro(ReadDataOnLoad,int);
 
@@ -833,6 +847,7 @@ public:
 protected:
 
   typedef std::map< std::string, std::set<std::string> > NodeReferencesType;
+  typedef std::map< std::string, std::string > ReferencedIDChangesType;
 
   vtkMRMLScene();
   ~vtkMRMLScene() override;
@@ -945,7 +960,7 @@ protected:
   std::map< std::string, std::string > RegisteredAbstractNodeClassTypeDisplayNames; // map class name to type display name
 
   NodeReferencesType NodeReferences; // ReferencedIDs (string), ReferencingNodes (node pointer)
-  std::map< std::string, std::string > ReferencedIDChanges;
+  ReferencedIDChangesType ReferencedIDChanges; // old node ID -> new node ID
   std::map< std::string, vtkSmartPointer<vtkMRMLNode> > NodeIDs;
 
   // Stores default nodes. If a class is created or reset (using CreateNodeByClass or Clear) and
@@ -959,6 +974,8 @@ protected:
 
   int SaveToXMLString;
 
+  bool SaveInBinaryFormat;
+
   int ReadDataOnLoad;
 
   vtkMTimeType  NodeIDsMTime;
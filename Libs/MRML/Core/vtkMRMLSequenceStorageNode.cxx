@@ -185,7 +185,12 @@ int vtkMRMLSequenceStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
 
     sequenceScene->AddNode(embeddedSequenceNode.GetPointer());
 
+    // Sequence scenes may contain a very large number of nodes, use binary scene format
+    // to make loading faster
+    bool wasSaveInBinaryFormat = sequenceScene->GetSaveInBinaryFormat();
+    sequenceScene->SaveInBinaryFormatOn();
     success = sequenceScene->WriteToMRB(fullName.c_str(), nullptr, this->GetUserMessages());
+    sequenceScene->SetSaveInBinaryFormat(wasSaveInBinaryFormat);
 
     // It is important to remove the embeddedSequenceNode from the scene, because if
     // an embeddedSequenceNode already exists in the sequenceScene then calling AddNode()
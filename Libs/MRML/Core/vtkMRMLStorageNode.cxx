@@ -21,6 +21,7 @@ Version:   $Revision: 1.1.1.1 $
 #include "vtkMRMLScene.h"
 #include "vtkMRMLStorableNode.h"
 #include "vtkMRMLStorageNode.h"
+#include "vtkMRMLTraceLogger.h"
 
 // VTK includes
 #include <vtkCollection.h>
@@ -1212,6 +1213,7 @@ bool vtkMRMLStorageNode::CanWriteFromReferenceNode(vtkMRMLNode *refNode)
 //------------------------------------------------------------------------------
 int vtkMRMLStorageNode::ReadData(vtkMRMLNode* refNode, bool temporary)
 {
+  MRML_TRACE_SCOPE_DETAIL("Storage", "vtkMRMLStorageNode::ReadData", this->GetFileName());
   if (refNode == nullptr)
   {
     vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLStorageNode::ReadData",
@@ -1311,6 +1313,7 @@ int vtkMRMLStorageNode::ReadData(vtkMRMLNode* refNode, bool temporary)
 //------------------------------------------------------------------------------
 int vtkMRMLStorageNode::WriteData(vtkMRMLNode* refNode)
 {
+  MRML_TRACE_SCOPE_DETAIL("Storage", "vtkMRMLStorageNode::WriteData", this->GetFileName());
   this->WriteState = this->Idle;
   if (refNode == nullptr)
   {
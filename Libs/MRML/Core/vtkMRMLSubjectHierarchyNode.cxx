@@ -31,6 +31,7 @@
 
 // VTK includes
 #include <vtkCollection.h>
+#include <vtkIdList.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkSmartPointer.h>
@@ -41,6 +42,7 @@
 #include <sstream>
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <algorithm>
 
 //----------------------------------------------------------------------------
@@ -108,6 +110,21 @@ public:
   static std::map<vtkIdType, vtkWeakPointer<vtkSubjectHierarchyItem> > ItemCache;
   static std::map<vtkMRMLNode*, vtkWeakPointer<vtkSubjectHierarchyItem> > DataNodeCache;
 
+  /// Hashed indices of items by UID, attribute, and name, to avoid traversing the tree in exact match lookups.
+  /// Keys of the UID and attribute indices are created by \sa GetCacheKey from the name and value.
+  /// Item IDs are stored in ordered sets so that lookups return the earliest created item if there are multiple matches.
+  /// Only items that are added to a tree (see \sa AddToCache) are indexed.
+  typedef std::unordered_map<std::string, std::set<vtkIdType> > IndexCacheType;
+  static IndexCacheType UIDCache;
+  static IndexCacheType AttributeCache;
+  static IndexCacheType NameCache;
+
+  /// Flag indicating that the item is registered in the caches
+  bool Cached{false};
+  /// Name that the item is registered with in the name cache.
+  /// Needed because the item name comes from the data node, which can be renamed without the item knowing it.
+  std::string CachedName;
+
 // Get/set functions
 public:
   /// Add data item to tree under parent, specifying basic properties
@@ -127,6 +144,25 @@ public:
   /// Get name of the item. If has data node associated then return name of data node, \sa Name member otherwise
   std::string GetName();
 
+  /// Register item in the item, data node, UID, attribute, and name caches
+  void AddToCache();
+  /// Remove item from all the caches
+  void RemoveFromCache();
+  /// Update name cache if name of the item has changed (e.g., because the data node was renamed)
+  void UpdateNameCache();
+  /// Get key of UID and attribute caches
+  static std::string GetCacheKey(const std::string& name, const std::string& value);
+  /// Get IDs of items from an index cache that are in the branch of the given item.
+  /// Items are returned in the order of a depth-first traversal of the tree, same as non-cached lookups.
+  /// \param recursive If false then only direct children of the given item are returned
+  static void GetCachedItems(const IndexCacheType& cache, const std::string& key,
+    vtkSubjectHierarchyItem* branchItem, bool recursive, std::vector<vtkIdType>& foundItemIDs);
+  /// Determine whether the item is in the branch of the given item (not including the given item itself)
+  bool IsInBranch(vtkSubjectHierarchyItem* branchItem);
+  /// Get position of the item in the tree: index under parent for each ancestor, starting from the root.
+  /// Comparing positions lexicographically gives depth-first (pre-order) traversal order.
+  void GetTreePosition(std::vector<size_t>& position);
+
   /// Set UID to the item
   void SetUID(std::string uidName, std::string uidValue);
   /// Remove UID from the item
@@ -197,6 +233,8 @@ public:
   void GetDataNodesInBranch(vtkCollection *children, const char* childClass=nullptr);
   /// Get IDs of all children in the branch recursively
   void GetAllChildren(std::vector<vtkIdType> &childIDs);
+  /// Append IDs of all children in the branch recursively (depth-first order)
+  void AppendAllChildren(std::vector<vtkIdType> &childIDs);
   /// Get list of IDs of all direct children of this item
   void GetDirectChildren(std::vector<vtkIdType> &childIDs);
   /// Print all children with correct indentation
@@ -261,6 +299,33 @@ std::map<vtkIdType, vtkWeakPointer<vtkSubjectHierarchyItem> > vtkSubjectHierarch
   std::map<vtkIdType, vtkWeakPointer<vtkSubjectHierarchyItem> >();
 std::map<vtkMRMLNode*, vtkWeakPointer<vtkSubjectHierarchyItem> > vtkSubjectHierarchyItem::DataNodeCache =
   std::map<vtkMRMLNode*, vtkWeakPointer<vtkSubjectHierarchyItem> >();
+vtkSubjectHierarchyItem::IndexCacheType vtkSubjectHierarchyItem::UIDCache;
+vtkSubjectHierarchyItem::IndexCacheType vtkSubjectHierarchyItem::AttributeCache;
+vtkSubjectHierarchyItem::IndexCacheType vtkSubjectHierarchyItem::NameCache;
+
+namespace
+{
+//---------------------------------------------------------------------------
+void AddToIndexCache(vtkSubjectHierarchyItem::IndexCacheType& cache, const std::string& key, vtkIdType itemID)
+{
+  cache[key].insert(itemID);
+}
+
+//---------------------------------------------------------------------------
+void RemoveFromIndexCache(vtkSubjectHierarchyItem::IndexCacheType& cache, const std::string& key, vtkIdType itemID)
+{
+  vtkSubjectHierarchyItem::IndexCacheType::iterator cacheIt = cache.find(key);
+  if (cacheIt == cache.end())
+  {
+    return;
+  }
+  cacheIt->second.erase(itemID);
+  if (cacheIt->second.empty())
+  {
+    cache.erase(cacheIt);
+  }
+}
+}
 
 //---------------------------------------------------------------------------
 // vtkSubjectHierarchyItem methods
@@ -284,6 +349,10 @@ vtkSubjectHierarchyItem::vtkSubjectHierarchyItem()
 vtkSubjectHierarchyItem::~vtkSubjectHierarchyItem()
 {
   this->RemoveAllChildren();
+  if (this->Cached)
+  {
+    this->RemoveFromCache();
+  }
 
   this->Attributes.clear();
   this->UIDs.clear();
@@ -313,11 +382,7 @@ vtkIdType vtkSubjectHierarchyItem::AddToTree(vtkSubjectHierarchyItem* parent, vt
     this->Parent->Children.push_back(childPointer);
 
     // Add to cache
-    vtkSubjectHierarchyItem::ItemCache[this->ID] = this;
-    if (dataNode)
-    {
-      vtkSubjectHierarchyItem::DataNodeCache[dataNode] = this;
-    }
+    this->AddToCache();
   }
   else
   {
@@ -360,8 +425,8 @@ vtkIdType vtkSubjectHierarchyItem::AddToTree(vtkSubjectHierarchyItem* parent, st
       this->Parent->Children.insert(this->Parent->Children.begin() + positionUnderParent, childPointer);
     }
 
-    // Add to cache (DataNode is nullptr, so no need to add to node cache)
-    vtkSubjectHierarchyItem::ItemCache[this->ID] = this;
+    // Add to cache
+    this->AddToCache();
   }
   else if (! ( (!name.compare("Scene") && !level.compare("Scene"))
             || (!name.compare("UnresolvedItems") && !level.compare("UnresolvedItems")) ) )
@@ -707,6 +772,151 @@ std::string vtkSubjectHierarchyItem::GetName()
   return this->Name;
 }
 
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::AddToCache()
+{
+  vtkSubjectHierarchyItem::ItemCache[this->ID] = this;
+  if (this->DataNode)
+  {
+    vtkSubjectHierarchyItem::DataNodeCache[this->DataNode] = this;
+  }
+  for (std::map<std::string, std::string>::iterator uidIt = this->UIDs.begin(); uidIt != this->UIDs.end(); ++uidIt)
+  {
+    AddToIndexCache(vtkSubjectHierarchyItem::UIDCache, GetCacheKey(uidIt->first, uidIt->second), this->ID);
+  }
+  for (std::map<std::string, std::string>::iterator attIt = this->Attributes.begin(); attIt != this->Attributes.end(); ++attIt)
+  {
+    AddToIndexCache(vtkSubjectHierarchyItem::AttributeCache, GetCacheKey(attIt->first, attIt->second), this->ID);
+  }
+  this->CachedName = this->GetName();
+  AddToIndexCache(vtkSubjectHierarchyItem::NameCache, this->CachedName, this->ID);
+  this->Cached = true;
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::RemoveFromCache()
+{
+  vtkSubjectHierarchyItem::ItemCache.erase(this->ID);
+  if (this->DataNode)
+  {
+    vtkSubjectHierarchyItem::DataNodeCache.erase(this->DataNode);
+  }
+  if (!this->Cached)
+  {
+    return;
+  }
+  for (std::map<std::string, std::string>::iterator uidIt = this->UIDs.begin(); uidIt != this->UIDs.end(); ++uidIt)
+  {
+    RemoveFromIndexCache(vtkSubjectHierarchyItem::UIDCache, GetCacheKey(uidIt->first, uidIt->second), this->ID);
+  }
+  for (std::map<std::string, std::string>::iterator attIt = this->Attributes.begin(); attIt != this->Attributes.end(); ++attIt)
+  {
+    RemoveFromIndexCache(vtkSubjectHierarchyItem::AttributeCache, GetCacheKey(attIt->first, attIt->second), this->ID);
+  }
+  RemoveFromIndexCache(vtkSubjectHierarchyItem::NameCache, this->CachedName, this->ID);
+  this->CachedName.clear();
+  this->Cached = false;
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::UpdateNameCache()
+{
+  if (!this->Cached)
+  {
+    return;
+  }
+  std::string name = this->GetName();
+  if (name == this->CachedName)
+  {
+    return;
+  }
+  RemoveFromIndexCache(vtkSubjectHierarchyItem::NameCache, this->CachedName, this->ID);
+  this->CachedName = name;
+  AddToIndexCache(vtkSubjectHierarchyItem::NameCache, this->CachedName, this->ID);
+}
+
+//---------------------------------------------------------------------------
+std::string vtkSubjectHierarchyItem::GetCacheKey(const std::string& name, const std::string& value)
+{
+  return name + vtkMRMLSubjectHierarchyNode::SUBJECTHIERARCHY_NAME_VALUE_SEPARATOR + value;
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::GetCachedItems(const IndexCacheType& cache, const std::string& key,
+  vtkSubjectHierarchyItem* branchItem, bool recursive, std::vector<vtkIdType>& foundItemIDs)
+{
+  IndexCacheType::const_iterator cacheIt = cache.find(key);
+  if (cacheIt == cache.end())
+  {
+    return;
+  }
+  std::vector<vtkSubjectHierarchyItem*> foundItems;
+  for (std::set<vtkIdType>::const_iterator idIt = cacheIt->second.begin(); idIt != cacheIt->second.end(); ++idIt)
+  {
+    std::map<vtkIdType, vtkWeakPointer<vtkSubjectHierarchyItem> >::iterator itemIt = vtkSubjectHierarchyItem::ItemCache.find(*idIt);
+    if (itemIt == vtkSubjectHierarchyItem::ItemCache.end() || itemIt->second == nullptr)
+    {
+      continue;
+    }
+    vtkSubjectHierarchyItem* item = itemIt->second;
+    if (recursive ? item->IsInBranch(branchItem) : item->Parent == branchItem)
+    {
+      foundItems.push_back(item);
+    }
+  }
+  if (foundItems.size() < 2)
+  {
+    for (vtkSubjectHierarchyItem* item : foundItems)
+    {
+      foundItemIDs.push_back(item->ID);
+    }
+    return;
+  }
+
+  // The cache is ordered by item ID, sort the found items in tree order
+  std::vector<std::pair<std::vector<size_t>, vtkIdType> > itemPositions(foundItems.size());
+  for (size_t index = 0; index < foundItems.size(); ++index)
+  {
+    foundItems[index]->GetTreePosition(itemPositions[index].first);
+    itemPositions[index].second = foundItems[index]->ID;
+  }
+  std::sort(itemPositions.begin(), itemPositions.end());
+  for (const std::pair<std::vector<size_t>, vtkIdType>& itemPosition : itemPositions)
+  {
+    foundItemIDs.push_back(itemPosition.second);
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::GetTreePosition(std::vector<size_t>& position)
+{
+  position.clear();
+  for (vtkSubjectHierarchyItem* item = this; item->Parent; item = item->Parent)
+  {
+    ChildVector& siblings = item->Parent->Children;
+    size_t indexUnderParent = 0;
+    while (indexUnderParent < siblings.size() && siblings[indexUnderParent].GetPointer() != item)
+    {
+      ++indexUnderParent;
+    }
+    position.push_back(indexUnderParent);
+  }
+  std::reverse(position.begin(), position.end());
+}
+
+//---------------------------------------------------------------------------
+bool vtkSubjectHierarchyItem::IsInBranch(vtkSubjectHierarchyItem* branchItem)
+{
+  for (vtkSubjectHierarchyItem* ancestor = this->Parent; ancestor; ancestor = ancestor->Parent)
+  {
+    if (ancestor == branchItem)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
 //---------------------------------------------------------------------------
 bool vtkSubjectHierarchyItem::HasChildren()
 {
@@ -764,7 +974,7 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByID(vtkIdType itemID
   }
   if (foundItem)
   {
-    vtkSubjectHierarchyItem::ItemCache[itemID] = this;
+    vtkSubjectHierarchyItem::ItemCache[itemID] = foundItem;
   }
 
   return foundItem;
@@ -805,24 +1015,14 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByUID(std::string uid
   {
     return nullptr;
   }
-  ChildVector::iterator childIt;
-  for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
+  std::vector<vtkIdType> foundItemIDs;
+  vtkSubjectHierarchyItem::GetCachedItems(vtkSubjectHierarchyItem::UIDCache,
+    vtkSubjectHierarchyItem::GetCacheKey(uidName, uidValue), this, recursive, foundItemIDs);
+  if (foundItemIDs.empty())
   {
-    vtkSubjectHierarchyItem* currentItem = childIt->GetPointer();
-    if (!currentItem->GetUID(uidName).compare(uidValue))
-    {
-      return currentItem;
-    }
-    if (recursive)
-    {
-      vtkSubjectHierarchyItem* foundItemInBranch = currentItem->FindChildByUID(uidName, uidValue);
-      if (foundItemInBranch)
-      {
-        return foundItemInBranch;
-      }
-    }
+    return nullptr;
   }
-  return nullptr;
+  return vtkSubjectHierarchyItem::ItemCache[foundItemIDs[0]];
 }
 
 //---------------------------------------------------------------------------
@@ -855,6 +1055,12 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByUIDList(std::string
 //---------------------------------------------------------------------------
 void vtkSubjectHierarchyItem::FindChildrenByName(std::string name, std::vector<vtkIdType> &foundItemIDs, bool contains/*=false*/, bool recursive/*=true*/)
 {
+  if (!contains && !name.empty())
+  {
+    // Exact match can be looked up in the name cache
+    vtkSubjectHierarchyItem::GetCachedItems(vtkSubjectHierarchyItem::NameCache, name, this, recursive, foundItemIDs);
+    return;
+  }
   if (contains && !name.empty())
   {
     std::transform(name.begin(), name.end(), name.begin(), ::tolower); // Make it lowercase for case-insensitive comparison
@@ -926,7 +1132,17 @@ void vtkSubjectHierarchyItem::GetDataNodesInBranch(vtkCollection* dataNodeCollec
 void vtkSubjectHierarchyItem::GetAllChildren(std::vector<vtkIdType> &childIDs)
 {
   childIDs.clear();
-  this->FindChildrenByName("", childIDs, true);
+  this->AppendAllChildren(childIDs);
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::AppendAllChildren(std::vector<vtkIdType> &childIDs)
+{
+  for (ChildVector::iterator childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
+  {
+    childIDs.push_back((*childIt)->ID);
+    (*childIt)->AppendAllChildren(childIDs);
+  }
 }
 
 //---------------------------------------------------------------------------
@@ -1140,11 +1356,7 @@ bool vtkSubjectHierarchyItem::RemoveChild(vtkSubjectHierarchyItem* item)
   removedItem->ReparentChildrenToParent();
 
   // Remove from cache
-  vtkSubjectHierarchyItem::ItemCache.erase(removedItem->ID);
-  if (removedItem->DataNode)
-  {
-    vtkSubjectHierarchyItem::DataNodeCache.erase(removedItem->DataNode);
-  }
+  removedItem->RemoveFromCache();
 
   // Invoke events
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemRemovedEvent, item);
@@ -1202,11 +1414,7 @@ bool vtkSubjectHierarchyItem::RemoveChild(vtkIdType itemID)
   removedItem->ReparentChildrenToParent();
 
   // Remove from cache
-  vtkSubjectHierarchyItem::ItemCache.erase(removedItem->ID);
-  if (removedItem->DataNode)
-  {
-    vtkSubjectHierarchyItem::DataNodeCache.erase(removedItem->DataNode);
-  }
+  removedItem->RemoveFromCache();
 
   // Invoke events
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemRemovedEvent, removedItem.GetPointer());
@@ -1302,9 +1510,17 @@ void vtkSubjectHierarchyItem::SetUID(std::string uidName, std::string uidValue)
     {
       vtkWarningMacro( "SetUID: UID with name '" << uidName << "' already exists in subject hierarchy item '" << this->GetName()
         << "' with value '" << it->second << "'. Replacing it with value '" << uidValue << "'" );
+      if (this->Cached)
+      {
+        RemoveFromIndexCache(vtkSubjectHierarchyItem::UIDCache, GetCacheKey(uidName, it->second), this->ID);
+      }
     }
   }
   this->UIDs[uidName] = uidValue;
+  if (this->Cached)
+  {
+    AddToIndexCache(vtkSubjectHierarchyItem::UIDCache, GetCacheKey(uidName, uidValue), this->ID);
+  }
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemUIDAddedEvent, this);
   this->Modified();
 }
@@ -1319,6 +1535,10 @@ bool vtkSubjectHierarchyItem::RemoveUID(std::string uidName)
     return false;
   }
 
+  if (this->Cached)
+  {
+    RemoveFromIndexCache(vtkSubjectHierarchyItem::UIDCache, GetCacheKey(uidName, it->second), this->ID);
+  }
   // Use the find function to prevent adding an empty UID to the map
   this->UIDs.erase(it);
   this->Modified();
@@ -1371,6 +1591,14 @@ void vtkSubjectHierarchyItem::SetAttribute(std::string attributeName, std::strin
     // Attribute to set is same as original value, nothing to do
     return;
   }
+  if (this->Cached)
+  {
+    if (it != this->Attributes.end())
+    {
+      RemoveFromIndexCache(vtkSubjectHierarchyItem::AttributeCache, GetCacheKey(attributeName, it->second), this->ID);
+    }
+    AddToIndexCache(vtkSubjectHierarchyItem::AttributeCache, GetCacheKey(attributeName, attributeValue), this->ID);
+  }
   this->Attributes[attributeName] = attributeValue;
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemOwnerPluginSearchRequested, this);
   this->Modified();
@@ -1386,6 +1614,10 @@ bool vtkSubjectHierarchyItem::RemoveAttribute(std::string attributeName)
     return false;
   }
 
+  if (this->Cached)
+  {
+    RemoveFromIndexCache(vtkSubjectHierarchyItem::AttributeCache, GetCacheKey(attributeName, it->second), this->ID);
+  }
   // Use the find function to prevent adding an empty attribute to the map
   this->Attributes.erase(it);
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemOwnerPluginSearchRequested, this);
@@ -1508,6 +1740,11 @@ public:
   /// Add item and data node observers (if observers has not been added yet)
   void AddItemObservers(vtkSubjectHierarchyItem* item);
 
+  /// Invoke per-item modified event (modified, display modified, transform modified, reparented).
+  /// During batch update the event is not invoked, the item is just recorded to be included
+  /// in the notification at the end of the batch.
+  void InvokeItemModifiedEvent(unsigned long eventId, vtkIdType itemID);
+
 public:
   /// Scene subject hierarchy item. This is the ancestor of all subject hierarchy items in the tree
   vtkSubjectHierarchyItem* SceneItem;
@@ -1526,6 +1763,13 @@ public:
   /// Flag indicating whether resolving unresolved items is underway (after scene import or restore)
   bool IsResolving;
 
+  /// Number of nested batch updates in progress (\sa StartBatchUpdate)
+  int BatchUpdateCount;
+  /// Items that were modified or reparented during the batch update
+  std::set<vtkIdType> BatchModifiedItemIDs;
+  /// Flag indicating that the node content has changed during the batch update
+  bool BatchNodeModified;
+
 private:
   vtkMRMLSubjectHierarchyNode* External;
 };
@@ -1537,6 +1781,8 @@ private:
 vtkMRMLSubjectHierarchyNode::vtkInternal::vtkInternal(vtkMRMLSubjectHierarchyNode* external)
 : EventsDisabled(false)
 , IsResolving(false)
+, BatchUpdateCount(0)
+, BatchNodeModified(false)
 , External(external)
 {
   // Create scene item
@@ -1789,6 +2035,17 @@ void vtkMRMLSubjectHierarchyNode::vtkInternal::AddItemObservers(vtkSubjectHierar
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLSubjectHierarchyNode::vtkInternal::InvokeItemModifiedEvent(unsigned long eventId, vtkIdType itemID)
+{
+  if (this->BatchUpdateCount > 0)
+  {
+    this->BatchModifiedItemIDs.insert(itemID);
+    return;
+  }
+  this->External->InvokeCustomModifiedEvent(eventId, (void*)&itemID);
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLSubjectHierarchyNode::vtkInternal::CopyAsUnresolved(vtkMRMLSubjectHierarchyNode* otherShNode)
 {
@@ -2143,6 +2400,7 @@ void vtkMRMLSubjectHierarchyNode::SetItemDataNode(vtkIdType itemID, vtkMRMLNode*
   {
     vtkSubjectHierarchyItem::DataNodeCache[item->DataNode] = item;
   }
+  item->UpdateNameCache();
 
   // Add observers for data node
   this->Internal->AddItemObservers(item);
@@ -2205,7 +2463,8 @@ void vtkMRMLSubjectHierarchyNode::SetItemName(vtkIdType itemID, std::string name
 
   if (nameChanged)
   {
-    this->InvokeCustomModifiedEvent(SubjectHierarchyItemModifiedEvent, (void*)&itemID);
+    item->UpdateNameCache();
+    this->Internal->InvokeItemModifiedEvent(SubjectHierarchyItemModifiedEvent, itemID);
   }
 }
 
@@ -2284,7 +2543,7 @@ void vtkMRMLSubjectHierarchyNode::SetItemOwnerPluginName(vtkIdType itemID, std::
   if (item->OwnerPluginName.compare(ownerPluginName))
   {
     item->OwnerPluginName = ownerPluginName;
-    this->InvokeCustomModifiedEvent(SubjectHierarchyItemModifiedEvent, (void*)&itemID);
+    this->Internal->InvokeItemModifiedEvent(SubjectHierarchyItemModifiedEvent, itemID);
   }
 }
 
@@ -2324,7 +2583,7 @@ void vtkMRMLSubjectHierarchyNode::SetItemExpanded(vtkIdType itemID, bool expande
   if (item->Expanded != expanded)
   {
     item->Expanded = expanded;
-    this->InvokeCustomModifiedEvent(SubjectHierarchyItemModifiedEvent, (void*)&itemID);
+    this->Internal->InvokeItemModifiedEvent(SubjectHierarchyItemModifiedEvent, itemID);
   }
 }
 
@@ -2581,7 +2840,7 @@ void vtkMRMLSubjectHierarchyNode::ItemModified(vtkIdType itemID)
   }
 
   // Invoke the node event directly, thus saving an extra callback round
-  this->InvokeCustomModifiedEvent(SubjectHierarchyItemModifiedEvent, (void*)&itemID);
+  this->Internal->InvokeItemModifiedEvent(SubjectHierarchyItemModifiedEvent, itemID);
 }
 
 //---------------------------------------------------------------------------
@@ -2638,6 +2897,7 @@ vtkIdType vtkMRMLSubjectHierarchyNode::CreateItem(vtkIdType parentItemID, vtkMRM
 
     // The name of the data node is used, so empty name is set
     item->Name = "";
+    item->UpdateNameCache();
     if (ownerPluginName)
     {
       item->OwnerPluginName = ownerPluginName;
@@ -2749,61 +3009,34 @@ bool vtkMRMLSubjectHierarchyNode::RemoveItem(vtkIdType itemID, bool removeDataNo
   // Start with the leaf nodes so that triggered updates are faster (no reparenting done after deleting intermediate items)
   if (recursive || item->IsVirtualBranchParent())
   {
-    std::vector<vtkIdType> virtualItemIDs; // List of virtual item IDs that do not need to be explicitly deleted
     std::vector<vtkIdType> childIDs;
     item->GetAllChildren(childIDs);
-    while (childIDs.size())
+    // Children are listed in depth-first order (an item always comes before its children),
+    // therefore in reverse order all children of an item are removed before the item itself.
+    for (std::vector<vtkIdType>::reverse_iterator childIt=childIDs.rbegin(); childIt!=childIDs.rend(); ++childIt)
     {
-      // Remove first leaf node found
-      // (or if the parent of a virtual branch, in which the items are automatically removed when their parent is removed)
-      std::vector<vtkIdType>::iterator childIt;
-      for (childIt=childIDs.begin(); childIt!=childIDs.end(); ++childIt)
+      // Get item by ID and delete it if leaf or virtual branch parent
+      vtkSubjectHierarchyItem* currentItem = this->Internal->SceneItem->FindChildByID(*childIt);
+      if (!currentItem)
       {
-        // Skip if virtual item, because its data node and subject hierarchy item was already deleted
-        if (std::find(virtualItemIDs.begin(), virtualItemIDs.end(), (*childIt)) != virtualItemIDs.end())
-        {
-          childIDs.erase(childIt);
-          break;
-        }
+        // Already deleted item ID was in the list
+        vtkErrorMacro("RemoveItem: Failed to find subject hierarchy item by ID " << (*childIt));
+        continue;
+      }
 
-        // Get item by ID and delete it if leaf or virtual branch parent
-        vtkSubjectHierarchyItem* currentItem = this->Internal->SceneItem->FindChildByID(*childIt);
-        if (!currentItem)
-        {
-          // Already deleted item ID was in the list
-          vtkErrorMacro("RemoveItem: Failed to find subject hierarchy item by ID " << (*childIt));
-          childIDs.erase(childIt);
-          break;
-        }
-        if ( !currentItem->HasChildren() || currentItem->IsVirtualBranchParent() )
-        {
-          // Mark child item IDs in case it is a virtual branch parent, because those items do not need to be explicitly deleted
-          if (currentItem->IsVirtualBranchParent())
-          {
-            std::vector<vtkIdType> currentVirtualItemIDs;
-            currentItem->GetDirectChildren(currentVirtualItemIDs);
-            virtualItemIDs.insert(virtualItemIDs.end(), currentVirtualItemIDs.begin(), currentVirtualItemIDs.end());
-          }
-
-          // Remove data node from scene if requested.. In that case removing the item explicitly
-          // is not necessary because removing the node triggers removing the item automatically
-          if (removeDataNode && currentItem->DataNode && this->Scene)
-          {
-            this->Scene->RemoveNode(currentItem->DataNode.GetPointer());
-          }
-          // Remove leaf item from its parent if not in virtual branch (if in virtual branch, then they will be removed
-          // automatically when their parent is removed)
-          else if (!currentItem->Parent->IsVirtualBranchParent())
-          {
-            currentItem->Parent->RemoveChild(*childIt);
-          }
-
-          // Remove ID of deleted item (or virtual branch leaf) from list and keep deleting until empty
-          childIDs.erase(childIt);
-          break;
-        }
+      // Remove data node from scene if requested.. In that case removing the item explicitly
+      // is not necessary because removing the node triggers removing the item automatically
+      if (removeDataNode && currentItem->DataNode && this->Scene)
+      {
+        this->Scene->RemoveNode(currentItem->DataNode.GetPointer());
+      }
+      // Remove leaf item from its parent if not in virtual branch (if in virtual branch, then they will be removed
+      // automatically when their parent is removed)
+      else if (!currentItem->Parent->IsVirtualBranchParent())
+      {
+        currentItem->Parent->RemoveChild(*childIt);
       }
-    } // While there are children to delete
+    }
   }
 
   // Remove data node of given item from scene if requested. In that case removing the item explicitly
@@ -3680,7 +3913,26 @@ int vtkMRMLSubjectHierarchyNode::GetNumberOfItemChildren(vtkIdType itemID, bool
 void vtkMRMLSubjectHierarchyNode::ItemEventCallback(vtkObject* caller, unsigned long eid, void* clientData, void* callData)
 {
   vtkMRMLSubjectHierarchyNode* self = reinterpret_cast<vtkMRMLSubjectHierarchyNode*>(clientData);
-  if (!self || self->Internal->EventsDisabled)
+  if (!self)
+  {
+    return;
+  }
+
+  // Keep the name cache up-to-date even if events are disabled, as the item name is the name of the data node
+  if (eid == vtkCommand::ModifiedEvent)
+  {
+    vtkMRMLNode* dataNode = vtkMRMLNode::SafeDownCast(caller);
+    if (dataNode)
+    {
+      auto itemIt = vtkSubjectHierarchyItem::DataNodeCache.find(dataNode);
+      if (itemIt != vtkSubjectHierarchyItem::DataNodeCache.end() && itemIt->second)
+      {
+        itemIt->second->UpdateNameCache();
+      }
+    }
+  }
+
+  if (self->Internal->EventsDisabled)
   {
     return;
   }
@@ -3693,14 +3945,25 @@ void vtkMRMLSubjectHierarchyNode::ItemEventCallback(vtkObject* caller, unsigned
     case vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemRemovedEvent:
     case vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemUIDAddedEvent:
     case vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemOwnerPluginSearchRequested:
-    case vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemReparentedEvent:
     {
       // Get item from call data
       vtkSubjectHierarchyItem* item = reinterpret_cast<vtkSubjectHierarchyItem*>(callData);
       if (item)
       {
         self->InvokeCustomModifiedEvent(eid, (void*)&item->ID);
-        self->Modified(); // Indicate that the content of the subject hierarchy node has changed, so it needs to be saved
+        self->ContentModified(); // Indicate that the content of the subject hierarchy node has changed, so it needs to be saved
+      }
+    }
+      break;
+
+    case vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemReparentedEvent:
+    {
+      // Get item from call data
+      vtkSubjectHierarchyItem* item = reinterpret_cast<vtkSubjectHierarchyItem*>(callData);
+      if (item)
+      {
+        self->Internal->InvokeItemModifiedEvent(eid, item->ID);
+        self->ContentModified();
       }
     }
       break;
@@ -3712,8 +3975,8 @@ void vtkMRMLSubjectHierarchyNode::ItemEventCallback(vtkObject* caller, unsigned
       if (item)
       {
         // Propagate item modified event
-        self->InvokeCustomModifiedEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemModifiedEvent, (void*)&item->ID);
-        self->Modified(); // Indicate that the content of the subject hierarchy node has changed, so it needs to be saved
+        self->Internal->InvokeItemModifiedEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemModifiedEvent, item->ID);
+        self->ContentModified(); // Indicate that the content of the subject hierarchy node has changed, so it needs to be saved
       }
       else if (dataNode)
       {
@@ -3721,7 +3984,7 @@ void vtkMRMLSubjectHierarchyNode::ItemEventCallback(vtkObject* caller, unsigned
         vtkIdType itemID = self->GetItemByDataNode(dataNode);
         if (itemID != vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
         {
-          self->InvokeCustomModifiedEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemModifiedEvent, (void*)&itemID);
+          self->Internal->InvokeItemModifiedEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemModifiedEvent, itemID);
         }
       }
     }
@@ -3736,7 +3999,7 @@ void vtkMRMLSubjectHierarchyNode::ItemEventCallback(vtkObject* caller, unsigned
         vtkIdType itemID = self->GetItemByDataNode(dataNode);
         if (itemID != vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
         {
-          self->InvokeCustomModifiedEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemTransformModifiedEvent, (void*)&itemID);
+          self->Internal->InvokeItemModifiedEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemTransformModifiedEvent, itemID);
         }
       }
     }
@@ -3751,7 +4014,7 @@ void vtkMRMLSubjectHierarchyNode::ItemEventCallback(vtkObject* caller, unsigned
         vtkIdType itemID = self->GetItemByDataNode(dataNode);
         if (itemID != vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
         {
-          self->InvokeCustomModifiedEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemDisplayModifiedEvent, (void*)&itemID);
+          self->Internal->InvokeItemModifiedEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemDisplayModifiedEvent, itemID);
         }
       }
     }
@@ -3784,3 +4047,92 @@ void vtkMRMLSubjectHierarchyNode::ShowItemsInView(vtkIdList* itemIDs, vtkMRMLAbs
   this->InvokeEvent(SubjectHierarchyItemsShowInViewRequestedEvent, &eventData);
   // The event will be processed by qSlicerSubjectHierarchyPluginHandler
 }
+
+//----------------------------------------------------------------------------
+void vtkMRMLSubjectHierarchyNode::StartBatchUpdate()
+{
+  this->Internal->BatchUpdateCount++;
+  if (this->Internal->BatchUpdateCount > 1)
+  {
+    // Nested batch update, the notification is sent when the outermost batch update ends
+    return;
+  }
+  this->Internal->BatchModifiedItemIDs.clear();
+  this->Internal->BatchNodeModified = false;
+  this->InvokeEvent(SubjectHierarchyStartBatchUpdateEvent);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSubjectHierarchyNode::EndBatchUpdate()
+{
+  if (this->Internal->BatchUpdateCount <= 0)
+  {
+    vtkErrorMacro("EndBatchUpdate: No batch update is in progress");
+    return;
+  }
+  this->Internal->BatchUpdateCount--;
+  if (this->Internal->BatchUpdateCount > 0)
+  {
+    return;
+  }
+
+  // Items may have been removed since they were modified
+  vtkNew<vtkIdList> modifiedItemIDs;
+  for (std::set<vtkIdType>::iterator itemIt = this->Internal->BatchModifiedItemIDs.begin();
+    itemIt != this->Internal->BatchModifiedItemIDs.end(); ++itemIt)
+  {
+    if (this->Internal->FindItemByID(*itemIt))
+    {
+      modifiedItemIDs->InsertNextId(*itemIt);
+    }
+  }
+  this->Internal->BatchModifiedItemIDs.clear();
+
+  if (this->Internal->BatchNodeModified)
+  {
+    this->Internal->BatchNodeModified = false;
+    this->Modified();
+  }
+  this->InvokeEvent(SubjectHierarchyEndBatchUpdateEvent, modifiedItemIDs.GetPointer());
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSubjectHierarchyNode::IsBatchUpdating()
+{
+  return this->Internal->BatchUpdateCount > 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSubjectHierarchyNode::ContentModified()
+{
+  if (this->Internal->BatchUpdateCount > 0)
+  {
+    this->Internal->BatchNodeModified = true;
+    return;
+  }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSubjectHierarchyNode::GetItemsByAttribute(std::string attributeName, std::string attributeValue, vtkIdList* foundItemIds)
+{
+  if (!foundItemIds)
+  {
+    vtkErrorMacro("GetItemsByAttribute: Invalid output ID list");
+    return;
+  }
+  foundItemIds->Reset();
+  if (attributeName.empty())
+  {
+    vtkErrorMacro("GetItemsByAttribute: Empty attribute name given, returning empty list");
+    return;
+  }
+
+  std::vector<vtkIdType> foundItemsVector;
+  vtkSubjectHierarchyItem::GetCachedItems(vtkSubjectHierarchyItem::AttributeCache,
+    vtkSubjectHierarchyItem::GetCacheKey(attributeName, attributeValue), this->Internal->SceneItem, true, foundItemsVector);
+  for (std::vector<vtkIdType>::iterator itemIt=foundItemsVector.begin(); itemIt!=foundItemsVector.end(); ++itemIt)
+  {
+    foundItemIds->InsertNextId(*itemIt);
+  }
+}
@@ -90,6 +90,11 @@ public:
     /// Use vtkMRMLSubjectHierarchyNode::ShowItemsInView or qSlicerSubjectHierarchyPluginHandler::showItemsInView
     /// method to request view of subject hierarchy items in a view.
     SubjectHierarchyItemsShowInViewRequestedEvent,
+    /// Event invoked when a batch update starts (\sa StartBatchUpdate)
+    SubjectHierarchyStartBatchUpdateEvent,
+    /// Event invoked when a batch update ends (\sa EndBatchUpdate).
+    /// Call data is a vtkIdList containing the items that were modified or reparented during the batch update.
+    SubjectHierarchyEndBatchUpdateEvent,
   };
 
   /// Event data used with SubjectHierarchyItemsShowInViewRequestedEvent.
@@ -313,6 +318,12 @@ public:
   /// \return Item ID of the first item found by name using exact match. Warning is logged if more than one found
   void GetItemsByName(std::string name, vtkIdList* foundItemIds, bool contains=false);
 
+  /// Get items in whole subject hierarchy that have an attribute with the given value (by exact match)
+  /// \param attributeName Name of the attribute
+  /// \param attributeValue Value that needs to _exactly match_ the attribute value of the item
+  /// \param foundItemIds List of found items, in the order of creation
+  void GetItemsByAttribute(std::string attributeName, std::string attributeValue, vtkIdList* foundItemIds);
+
   /// Get child subject hierarchy item with specific name
   /// \param parent Parent subject hierarchy item to start from
   /// \param name Name to find
@@ -420,7 +431,22 @@ public:
   /// Show items in selected view (used for drag&drop of subject hierarchy items into the viewer)
   void ShowItemsInView(vtkIdList* itemIDs, vtkMRMLAbstractViewNode* viewNode);
 
+  /// Start batch update of the hierarchy (e.g. when many items are created, reparented or modified at once).
+  /// During batch update the item modified, display modified, transform modified and reparented events are not
+  /// invoked, instead the affected items are reported in SubjectHierarchyEndBatchUpdateEvent when the batch ends.
+  /// Item added and removed events are still invoked immediately.
+  /// Batch updates can be nested, each StartBatchUpdate call must be followed by an EndBatchUpdate call.
+  void StartBatchUpdate();
+  /// End batch update of the hierarchy. \sa StartBatchUpdate
+  void EndBatchUpdate();
+  /// Determine whether a batch update is in progress
+  bool IsBatchUpdating();
+
 protected:
+  /// Indicate that the content of the hierarchy has changed.
+  /// Invokes ModifiedEvent immediately, or when the batch update ends if there is one in progress.
+  void ContentModified();
+
   /// Callback function for all events from the subject hierarchy items
   static void ItemEventCallback(vtkObject* caller, unsigned long eid, void* clientData, void* callData);
 
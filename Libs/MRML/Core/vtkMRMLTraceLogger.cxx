@@ -0,0 +1,432 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLTraceLogger.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+
+// STD includes
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// The singleton instance.
+// This MUST be default initialized to zero by the compiler and is
+// therefore not initialized here. The ClassInitialize and
+// ClassFinalize methods handle this instance.
+static vtkMRMLTraceLogger* vtkMRMLTraceLoggerInstance;
+
+//----------------------------------------------------------------------------
+// Must NOT be initialized. Default initialization to zero is necessary.
+unsigned int vtkMRMLTraceLoggerInitialize::Count;
+
+//----------------------------------------------------------------------------
+vtkMRMLTraceLoggerInitialize::vtkMRMLTraceLoggerInitialize()
+{
+  if (++Self::Count == 1)
+  {
+    vtkMRMLTraceLogger::classInitialize();
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLTraceLoggerInitialize::~vtkMRMLTraceLoggerInitialize()
+{
+  if (--Self::Count == 0)
+  {
+    vtkMRMLTraceLogger::classFinalize();
+  }
+}
+
+//----------------------------------------------------------------------------
+namespace
+{
+/// Checked by every instrumented section, kept outside of the logger object
+/// so that the check does not require accessing the singleton.
+std::atomic<bool> TracingEnabled(false);
+
+struct TraceEvent
+{
+  /// Static strings, not owned
+  const char* Category{ nullptr };
+  const char* Name{ nullptr };
+  /// Used if category and name are not static strings
+  std::string CopiedCategory;
+  std::string CopiedName;
+  std::string Detail;
+  double StartTime{ 0.0 };
+  /// Negative duration means instant event
+  double Duration{ -1.0 };
+
+  const char* GetCategory() const { return this->Category ? this->Category : this->CopiedCategory.c_str(); }
+  const char* GetName() const { return this->Name ? this->Name : this->CopiedName.c_str(); }
+};
+
+struct ThreadBuffer
+{
+  /// Only contended when events are written or cleared while the thread is recording
+  std::mutex Mutex;
+  std::vector<TraceEvent> Events;
+  std::string ThreadName;
+  int ThreadIndex{ 0 };
+};
+
+//----------------------------------------------------------------------------
+std::chrono::steady_clock::time_point GetTimeOrigin()
+{
+  static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+  return origin;
+}
+
+//----------------------------------------------------------------------------
+void WriteJSONString(std::ostream& os, const char* text)
+{
+  os << '"';
+  for (const char* c = text; c && *c; ++c)
+  {
+    switch (*c)
+    {
+      case '"': os << "\\\""; break;
+      case '\\': os << "\\\\"; break;
+      case '\n': os << "\\n"; break;
+      case '\r': os << "\\r"; break;
+      case '\t': os << "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(*c) < 0x20)
+        {
+          os << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+            << static_cast<int>(static_cast<unsigned char>(*c)) << std::dec << std::setfill(' ');
+        }
+        else
+        {
+          os << *c;
+        }
+    }
+  }
+  os << '"';
+}
+}
+
+//----------------------------------------------------------------------------
+class vtkMRMLTraceLogger::vtkInternal
+{
+public:
+  /// Get the event buffer of the calling thread. The buffer is created
+  /// and registered at the first call from each thread.
+  std::shared_ptr<ThreadBuffer> GetCurrentThreadBuffer()
+  {
+    // Buffers are shared with the logger so that events remain available
+    // after the recording thread exits.
+    thread_local std::shared_ptr<ThreadBuffer> currentThreadBuffer;
+    thread_local vtkInternal* currentThreadBufferOwner = nullptr;
+    if (!currentThreadBuffer || currentThreadBufferOwner != this)
+    {
+      currentThreadBuffer = std::make_shared<ThreadBuffer>();
+      currentThreadBufferOwner = this;
+      std::lock_guard<std::mutex> lock(this->BuffersMutex);
+      currentThreadBuffer->ThreadIndex = static_cast<int>(this->Buffers.size());
+      this->Buffers.push_back(currentThreadBuffer);
+    }
+    return currentThreadBuffer;
+  }
+
+  /// Return false if the maximum number of events is reached.
+  bool ReserveEvent(int maximumNumberOfEvents)
+  {
+    if (this->NumberOfEvents.fetch_add(1) >= maximumNumberOfEvents)
+    {
+      this->NumberOfEvents.fetch_sub(1);
+      return false;
+    }
+    return true;
+  }
+
+  void AddEvent(const char* category, const char* name, bool staticNames, const char* detail,
+    double startTime, double duration, int maximumNumberOfEvents)
+  {
+    if (!name || !this->ReserveEvent(maximumNumberOfEvents))
+    {
+      return;
+    }
+    TraceEvent event;
+    if (staticNames)
+    {
+      event.Category = category;
+      event.Name = name;
+    }
+    else
+    {
+      event.CopiedCategory = (category ? category : "");
+      event.CopiedName = name;
+    }
+    if (detail)
+    {
+      event.Detail = detail;
+    }
+    event.StartTime = startTime;
+    event.Duration = duration;
+    std::shared_ptr<ThreadBuffer> buffer = this->GetCurrentThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer->Mutex);
+    buffer->Events.push_back(std::move(event));
+  }
+
+  std::vector<std::shared_ptr<ThreadBuffer> > GetBuffers()
+  {
+    std::lock_guard<std::mutex> lock(this->BuffersMutex);
+    return this->Buffers;
+  }
+
+  std::mutex BuffersMutex;
+  std::vector<std::shared_ptr<ThreadBuffer> > Buffers;
+  std::atomic<int> NumberOfEvents{ 0 };
+};
+
+//----------------------------------------------------------------------------
+vtkMRMLTraceLogger* vtkMRMLTraceLogger::New()
+{
+  vtkMRMLTraceLogger* ret = vtkMRMLTraceLogger::GetInstance();
+  ret->Register(nullptr);
+  return ret;
+}
+
+//----------------------------------------------------------------------------
+// Return the single instance of the vtkMRMLTraceLogger
+vtkMRMLTraceLogger* vtkMRMLTraceLogger::GetInstance()
+{
+  if (!vtkMRMLTraceLoggerInstance)
+  {
+    // Try the factory first
+    vtkMRMLTraceLoggerInstance = (vtkMRMLTraceLogger*)
+      vtkObjectFactory::CreateInstance("vtkMRMLTraceLogger");
+    // if the factory did not provide one, then create it here
+    if (!vtkMRMLTraceLoggerInstance)
+    {
+      vtkMRMLTraceLoggerInstance = new vtkMRMLTraceLogger;
+#ifdef VTK_HAS_INITIALIZE_OBJECT_BASE
+      vtkMRMLTraceLoggerInstance->InitializeObjectBase();
+#endif
+    }
+  }
+  // return the instance
+  return vtkMRMLTraceLoggerInstance;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTraceLogger::classInitialize()
+{
+  // Allocate the singleton
+  vtkMRMLTraceLoggerInstance = vtkMRMLTraceLogger::GetInstance();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTraceLogger::classFinalize()
+{
+  TracingEnabled = false;
+  vtkMRMLTraceLoggerInstance->Delete();
+  vtkMRMLTraceLoggerInstance = nullptr;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLTraceLogger::vtkMRMLTraceLogger()
+{
+  this->MaximumNumberOfEvents = 10000000;
+  this->TraceFileName = nullptr;
+  this->Internal = new vtkInternal;
+  // Make sure the time origin is set before any event is recorded
+  GetTimeOrigin();
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLTraceLogger::~vtkMRMLTraceLogger()
+{
+  delete this->Internal;
+  this->Internal = nullptr;
+  this->SetTraceFileName(nullptr);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTraceLogger::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Tracing: " << (vtkMRMLTraceLogger::IsTracing() ? "true" : "false") << "\n";
+  os << indent << "NumberOfEvents: " << this->Internal->NumberOfEvents << "\n";
+  os << indent << "MaximumNumberOfEvents: " << this->MaximumNumberOfEvents << "\n";
+  os << indent << "TraceFileName: " << (this->TraceFileName ? this->TraceFileName : "(none)") << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTraceLogger::StartTracing()
+{
+  if (TracingEnabled)
+  {
+    return;
+  }
+  TracingEnabled = true;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTraceLogger::StopTracing()
+{
+  if (!TracingEnabled)
+  {
+    return;
+  }
+  TracingEnabled = false;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLTraceLogger::IsTracing()
+{
+  return TracingEnabled.load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTraceLogger::ClearEvents()
+{
+  for (std::shared_ptr<ThreadBuffer>& buffer : this->Internal->GetBuffers())
+  {
+    std::lock_guard<std::mutex> lock(buffer->Mutex);
+    this->Internal->NumberOfEvents -= static_cast<int>(buffer->Events.size());
+    buffer->Events.clear();
+  }
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLTraceLogger::GetNumberOfEvents()
+{
+  return this->Internal->NumberOfEvents;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTraceLogger::SetCurrentThreadName(const char* name)
+{
+  std::shared_ptr<ThreadBuffer> buffer = this->Internal->GetCurrentThreadBuffer();
+  std::lock_guard<std::mutex> lock(buffer->Mutex);
+  buffer->ThreadName = (name ? name : "");
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTraceLogger::AddCompleteEvent(const char* category, const char* name, const char* detail,
+  double startTime, double duration)
+{
+  this->Internal->AddEvent(category, name, false, detail, startTime,
+    duration >= 0.0 ? duration : 0.0, this->MaximumNumberOfEvents);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTraceLogger::AddStaticCompleteEvent(const char* category, const char* name, const char* detail,
+  double startTime, double duration)
+{
+  this->Internal->AddEvent(category, name, true, detail, startTime,
+    duration >= 0.0 ? duration : 0.0, this->MaximumNumberOfEvents);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTraceLogger::AddInstantEvent(const char* category, const char* name, const char* detail/*=nullptr*/)
+{
+  if (!vtkMRMLTraceLogger::IsTracing())
+  {
+    return;
+  }
+  this->Internal->AddEvent(category, name, false, detail, vtkMRMLTraceLogger::GetTimestamp(),
+    -1.0, this->MaximumNumberOfEvents);
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLTraceLogger::GetTimestamp()
+{
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - GetTimeOrigin()).count();
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLTraceLogger::WriteTraceFile(const char* fileName/*=nullptr*/)
+{
+  if (!fileName)
+  {
+    fileName = this->TraceFileName;
+  }
+  if (!fileName || strlen(fileName) == 0)
+  {
+    vtkErrorMacro("WriteTraceFile failed: file name is not specified");
+    return false;
+  }
+  std::ofstream ofs;
+#ifdef _WIN32
+  ofs.open(fileName, std::ios::out | std::ios::binary);
+#else
+  ofs.open(fileName, std::ios::out);
+#endif
+  if (ofs.fail())
+  {
+    vtkErrorMacro("WriteTraceFile failed: cannot open file " << fileName);
+    return false;
+  }
+
+  const int processId = 1;
+  ofs << std::fixed << std::setprecision(3);
+  ofs << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  ofs << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << processId << ",\"tid\":0,\"args\":{\"name\":\"MRML\"}}";
+  for (std::shared_ptr<ThreadBuffer>& buffer : this->Internal->GetBuffers())
+  {
+    std::lock_guard<std::mutex> lock(buffer->Mutex);
+    std::string threadName = buffer->ThreadName;
+    if (threadName.empty())
+    {
+      threadName = "Thread " + std::to_string(buffer->ThreadIndex);
+    }
+    ofs << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << processId
+      << ",\"tid\":" << buffer->ThreadIndex << ",\"args\":{\"name\":";
+    WriteJSONString(ofs, threadName.c_str());
+    ofs << "}}";
+    // Keep the order of threads in viewers the same as the order of their first event
+    ofs << ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":" << processId
+      << ",\"tid\":" << buffer->ThreadIndex << ",\"args\":{\"sort_index\":" << buffer->ThreadIndex << "}}";
+    for (const TraceEvent& event : buffer->Events)
+    {
+      ofs << ",\n{\"name\":";
+      WriteJSONString(ofs, event.GetName());
+      ofs << ",\"cat\":";
+      WriteJSONString(ofs, event.GetCategory());
+      if (event.Duration >= 0.0)
+      {
+        ofs << ",\"ph\":\"X\",\"ts\":" << event.StartTime << ",\"dur\":" << event.Duration;
+      }
+      else
+      {
+        ofs << ",\"ph\":\"i\",\"s\":\"t\",\"ts\":" << event.StartTime;
+      }
+      ofs << ",\"pid\":" << processId << ",\"tid\":" << buffer->ThreadIndex;
+      if (!event.Detail.empty())
+      {
+        ofs << ",\"args\":{\"detail\":";
+        WriteJSONString(ofs, event.Detail.c_str());
+        ofs << "}";
+      }
+      ofs << "}";
+    }
+  }
+  ofs << "\n]}\n";
+  ofs.close();
+  if (ofs.fail())
+  {
+    vtkErrorMacro("WriteTraceFile failed: error while writing file " << fileName);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,212 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#ifndef __vtkMRMLTraceLogger_h
+#define __vtkMRMLTraceLogger_h
+
+// MRML includes
+#include "vtkMRML.h"
+
+// VTK includes
+#include <vtkObject.h>
+
+// STD includes
+#include <string>
+
+/// \brief Records timing of scene loading, saving and event processing.
+///
+/// Code sections are instrumented with the MRML_TRACE_SCOPE and MRML_TRACE_SCOPE_DETAIL
+/// macros. When tracing is started, each instrumented section that is executed adds
+/// an event with its start time and duration. Events are recorded into per-thread
+/// buffers, so recording does not block other threads. Recorded events can be written
+/// to a JSON file in Chrome trace event format, which can be viewed in chrome://tracing
+/// or https://ui.perfetto.dev, with a separate track for each thread.
+///
+/// When tracing is not started, instrumented sections only check a flag. Instrumentation
+/// can be completely removed at compile time by turning off the MRML_USE_TRACING option.
+///
+/// Tracing can be started from the command line (see --trace-file application option)
+/// or from Python:
+/// \code{.py}
+/// logger = slicer.vtkMRMLTraceLogger.GetInstance()
+/// logger.StartTracing()
+/// slicer.util.loadScene("path/to/scene.mrml")
+/// logger.StopTracing()
+/// logger.WriteTraceFile("path/to/trace.json")
+/// \endcode
+///
+/// The logger is a singleton, use GetInstance() to access it.
+class VTK_MRML_EXPORT vtkMRMLTraceLogger : public vtkObject
+{
+public:
+  vtkTypeMacro(vtkMRMLTraceLogger, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Return the singleton instance with no reference counting.
+  static vtkMRMLTraceLogger* GetInstance();
+
+  /// This is a singleton pattern New. There will only be ONE
+  /// reference to a vtkMRMLTraceLogger object per process.
+  /// Clients that call this must call Delete on the object so that
+  /// the reference counting will work.
+  static vtkMRMLTraceLogger* New();
+
+  /// Start recording events. Previously recorded events are kept.
+  void StartTracing();
+
+  /// Stop recording events. Recorded events are kept until ClearEvents() is called.
+  void StopTracing();
+
+  /// Return true if events are being recorded.
+  /// This is a fast check that can be called from any thread.
+  static bool IsTracing();
+
+  /// Remove all recorded events.
+  void ClearEvents();
+
+  /// Get number of recorded events (in all threads).
+  int GetNumberOfEvents();
+
+  /// Maximum number of events to record. Events are not recorded above this limit
+  /// to prevent unbounded memory usage if tracing is left on. Default is 10 million.
+  vtkSetMacro(MaximumNumberOfEvents, int);
+  vtkGetMacro(MaximumNumberOfEvents, int);
+
+  /// Write recorded events in Chrome trace event JSON format.
+  /// If no filename is specified then TraceFileName is used.
+  /// Returns false if the file cannot be written.
+  bool WriteTraceFile(const char* fileName = nullptr);
+
+  /// Default file name for WriteTraceFile.
+  vtkSetStringMacro(TraceFileName);
+  vtkGetStringMacro(TraceFileName);
+
+  /// Set name of the calling thread, which is displayed as track name in trace viewers.
+  /// If not set then threads are named by their index.
+  void SetCurrentThreadName(const char* name);
+
+  /// Add an event with the given start time and duration (in microseconds, see GetTimestamp())
+  /// to the calling thread's buffer.
+  void AddCompleteEvent(const char* category, const char* name, const char* detail,
+    double startTime, double duration);
+
+  /// Add an event without duration to the calling thread's buffer.
+  void AddInstantEvent(const char* category, const char* name, const char* detail = nullptr);
+
+#ifndef __VTK_WRAP__
+  /// Same as AddCompleteEvent but category and name are not copied,
+  /// therefore they must be static strings. Used by vtkMRMLTraceScope.
+  void AddStaticCompleteEvent(const char* category, const char* name, const char* detail,
+    double startTime, double duration);
+#endif
+
+  /// Get current time in microseconds since the logger was created.
+  static double GetTimestamp();
+
+protected:
+  vtkMRMLTraceLogger();
+  ~vtkMRMLTraceLogger() override;
+  vtkMRMLTraceLogger(const vtkMRMLTraceLogger&);
+  void operator=(const vtkMRMLTraceLogger&);
+
+  /// Singleton management functions.
+  static void classInitialize();
+  static void classFinalize();
+
+  friend class vtkMRMLTraceLoggerInitialize;
+  typedef vtkMRMLTraceLogger Self;
+
+  int MaximumNumberOfEvents;
+  char* TraceFileName;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+};
+
+/// Utility class to make sure vtkMRMLTraceLogger is initialized before it is used.
+class VTK_MRML_EXPORT vtkMRMLTraceLoggerInitialize
+{
+public:
+  typedef vtkMRMLTraceLoggerInitialize Self;
+
+  vtkMRMLTraceLoggerInitialize();
+  ~vtkMRMLTraceLoggerInitialize();
+private:
+  static unsigned int Count;
+};
+
+/// This instance will show up in any translation unit that uses
+/// vtkMRMLTraceLogger. It will make sure vtkMRMLTraceLogger
+/// is initialized before it is used.
+static vtkMRMLTraceLoggerInitialize vtkMRMLTraceLoggerInitializer;
+
+#ifndef __VTK_WRAP__
+
+/// \brief Records a trace event spanning the lifetime of the object.
+///
+/// Use MRML_TRACE_SCOPE or MRML_TRACE_SCOPE_DETAIL macros instead of using
+/// this class directly, so that tracing can be removed at compile time.
+class vtkMRMLTraceScope
+{
+public:
+  vtkMRMLTraceScope(const char* category, const char* name, const char* detail = nullptr)
+  {
+    if (!vtkMRMLTraceLogger::IsTracing())
+    {
+      return;
+    }
+    this->Category = category;
+    this->Name = name;
+    if (detail)
+    {
+      this->Detail = detail;
+    }
+    this->StartTime = vtkMRMLTraceLogger::GetTimestamp();
+  }
+  ~vtkMRMLTraceScope()
+  {
+    if (!this->Name)
+    {
+      return;
+    }
+    vtkMRMLTraceLogger::GetInstance()->AddStaticCompleteEvent(this->Category, this->Name,
+      this->Detail.empty() ? nullptr : this->Detail.c_str(),
+      this->StartTime, vtkMRMLTraceLogger::GetTimestamp() - this->StartTime);
+  }
+private:
+  vtkMRMLTraceScope(const vtkMRMLTraceScope&) = delete;
+  void operator=(const vtkMRMLTraceScope&) = delete;
+
+  const char* Category{ nullptr };
+  const char* Name{ nullptr };
+  std::string Detail;
+  double StartTime{ 0.0 };
+};
+
+#define MRML_TRACE_CONCAT_IMPL(a, b) a##b
+#define MRML_TRACE_CONCAT(a, b) MRML_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef MRML_USE_TRACING
+/// Record execution time of the enclosing scope.
+/// Category and name must be string literals.
+# define MRML_TRACE_SCOPE(category, name) \
+  vtkMRMLTraceScope MRML_TRACE_CONCAT(mrmlTraceScope, __LINE__)(category, name)
+/// Record execution time of the enclosing scope, with additional information
+/// (such as node ID or file name) that is displayed when the event is selected.
+/// Detail is only copied if tracing is on.
+# define MRML_TRACE_SCOPE_DETAIL(category, name, detail) \
+  vtkMRMLTraceScope MRML_TRACE_CONCAT(mrmlTraceScope, __LINE__)(category, name, detail)
+#else
+# define MRML_TRACE_SCOPE(category, name)
+# define MRML_TRACE_SCOPE_DETAIL(category, name, detail)
+#endif
+
+#endif // __VTK_WRAP__
+
+#endif
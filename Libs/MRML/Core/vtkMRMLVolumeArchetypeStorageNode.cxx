@@ -51,6 +51,7 @@ Version:   $Revision: 1.6 $
 // STD includes
 #include <algorithm>
 #include <iterator>
+#include <vector>
 
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLVolumeArchetypeStorageNode);
@@ -250,9 +251,9 @@ namespace
 {
 
 //----------------------------------------------------------------------------
-void ApplyImageSeriesReaderWorkaround(vtkMRMLVolumeArchetypeStorageNode * storageNode,
-                                      vtkITKArchetypeImageSeriesReader * reader,
-                                      const std::string& fullName)
+void ApplyImageSeriesReaderWorkaround(vtkITKArchetypeImageSeriesReader * reader,
+                                      const std::string& fullName,
+                                      const std::vector<std::string>& fullFileNames)
 {
   // TODO: this is a workaround for an issue in itk::ImageSeriesReader
   // where is assumes that all the filenames that have been passed
@@ -272,18 +273,58 @@ void ApplyImageSeriesReaderWorkaround(vtkMRMLVolumeArchetypeStorageNode * storag
       && fileExt != std::string(".mhd")
       && fileExt != std::string(".nhdr") )
   {
-    for (int n = 0; n < storageNode->GetNumberOfFileNames(); n++)
+    for (const std::string& nthFileName : fullFileNames)
     {
-      std::string nthFileName = storageNode->GetFullNameFromNthFileName(n);
-      vtkDebugWithObjectMacro(storageNode,
-                              "ReadData: got full name for " << n << "th file: " << nthFileName
-                              << ", adding it to reader, current num files on it = "
-                              << reader->GetNumberOfFileNames());
       reader->AddFileName(nthFileName.c_str());
     }
   }
 }
 
+//----------------------------------------------------------------------------
+void SetupReader(vtkITKArchetypeImageSeriesReader* reader, const std::string& fullName,
+  const std::vector<std::string>& fullFileNames, bool centerImage)
+{
+  // Set the list of file names on the reader
+  reader->ResetFileNames();
+  reader->SetArchetype(fullName.c_str());
+
+  // Workaround
+  ApplyImageSeriesReaderWorkaround(reader, fullName, fullFileNames);
+
+  // Center image
+  reader->SetOutputScalarTypeToNative();
+  reader->SetDesiredCoordinateOrientationToNative();
+  if (centerImage)
+  {
+    reader->SetUseNativeOriginOff();
+  }
+  else
+  {
+    reader->SetUseNativeOriginOn();
+  }
+}
+
+//----------------------------------------------------------------------------
+bool UpdateReader(vtkITKArchetypeImageSeriesReader* reader, std::string& errorMessage)
+{
+  try
+  {
+    reader->Update();
+    if (reader->GetErrorCode() != vtkErrorCode::NoError)
+    {
+      errorMessage = std::string(vtkErrorCode::GetStringFromErrorCode(reader->GetErrorCode()));
+      return false;
+    }
+  }
+  catch (itk::ExceptionObject& e)
+  {
+    errorMessage = std::string("ITK exception info: error in ") + e.GetLocation() + "\n"
+                                                + e.GetDescription() + "\n";
+    return false;
+  }
+  return true;
+}
+
 //----------------------------------------------------------------------------
 bool IsIJKCoordinateSystemLeftHanded(vtkMatrix4x4* rasToIjkMatrix)
 {
@@ -311,6 +352,42 @@ void FlipIJKCoordinateSystemHandedness(vtkImageData* imageData, vtkMatrix4x4* ra
 }
 } // end of anonymous namespace
 
+//----------------------------------------------------------------------------
+vtkITKArchetypeImageSeriesReader* vtkMRMLVolumeArchetypeStorageNode::PreReadScalarImage(const char* fullName,
+  vtkStringArray* fullFileNames, bool singleFile, bool useOrientationFromFile, bool centerImage)
+{
+  if (!fullName)
+  {
+    return nullptr;
+  }
+  std::vector<std::string> fileNames;
+  if (fullFileNames)
+  {
+    for (vtkIdType n = 0; n < fullFileNames->GetNumberOfValues(); n++)
+    {
+      fileNames.push_back(fullFileNames->GetValue(n));
+    }
+  }
+  vtkITKArchetypeImageSeriesReader* reader = vtkITKArchetypeImageSeriesScalarReader::New();
+  reader->SetSingleFile(singleFile);
+  reader->SetUseOrientationFromFile(useOrientationFromFile);
+  SetupReader(reader, fullName, fileNames, centerImage);
+  std::string errorMessage;
+  if (!UpdateReader(reader, errorMessage))
+  {
+    // ReadData() reads the file again and reports the error
+    reader->Delete();
+    return nullptr;
+  }
+  return reader;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeArchetypeStorageNode::SetPreReadScalarImageReader(vtkITKArchetypeImageSeriesReader* reader)
+{
+  this->PreReadScalarImageReader = reader;
+}
+
 //----------------------------------------------------------------------------
 int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
 {
@@ -354,8 +431,22 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
   }
 
   vtkSmartPointer<vtkITKArchetypeImageSeriesReader> reader;
+  // Image read by PreReadScalarImage() is only used once
+  vtkSmartPointer<vtkITKArchetypeImageSeriesReader> preReadReader = this->PreReadScalarImageReader;
+  this->PreReadScalarImageReader = nullptr;
+  bool usePreReadReader = preReadReader
+    && !refNode->IsA("vtkMRMLVectorVolumeNode")
+    && !refNode->IsA("vtkMRMLDiffusionTensorVolumeNode")
+    && preReadReader->GetArchetype() && fullName == preReadReader->GetArchetype()
+    && preReadReader->GetSingleFile() == this->GetSingleFile()
+    && preReadReader->GetUseOrientationFromFile() == this->GetUseOrientationFromFile();
 
-  if (refNode->IsA("vtkMRMLVectorVolumeNode"))
+  if (usePreReadReader)
+  {
+    vtkDebugMacro("ReadDataInternal: using image that was already read from " << fullName);
+    reader = preReadReader;
+  }
+  else if (refNode->IsA("vtkMRMLVectorVolumeNode"))
   {
     reader.TakeReference(this->InstantiateVectorVolumeReader(fullName));
   }
@@ -378,49 +469,26 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     return 0;
   }
 
-  reader->AddObserver( vtkCommand::ProgressEvent,  this->MRMLCallbackCommand);
-
   if (volNode->GetImageData())
   {
     volNode->SetAndObserveImageData(nullptr);
   }
 
-  // Set the list of file names on the reader
-  reader->ResetFileNames();
-  reader->SetArchetype(fullName.c_str());
-
-  // Workaround
-  ApplyImageSeriesReaderWorkaround(this, reader, fullName);
-
-  // Center image
-  reader->SetOutputScalarTypeToNative();
-  reader->SetDesiredCoordinateOrientationToNative();
-  if (this->CenterImage)
-  {
-    reader->SetUseNativeOriginOff();
-  }
-  else
-  {
-    reader->SetUseNativeOriginOn();
-  }
-
   bool readingWorked = true;
   std::string errorMessage = "";
-  try
+  if (!usePreReadReader)
   {
-    vtkDebugMacro("ReadDataInternal: right before reader update, reader num files = " << reader->GetNumberOfFileNames());
-    reader->Update();
-    if (reader->GetErrorCode() != vtkErrorCode::NoError)
+    reader->AddObserver( vtkCommand::ProgressEvent,  this->MRMLCallbackCommand);
+
+    std::vector<std::string> fullFileNames;
+    for (int n = 0; n < this->GetNumberOfFileNames(); n++)
     {
-      readingWorked = false;
-      errorMessage = std::string(vtkErrorCode::GetStringFromErrorCode(reader->GetErrorCode()));
+      fullFileNames.push_back(this->GetFullNameFromNthFileName(n));
     }
-  }
-  catch (itk::ExceptionObject& e)
-  {
-    readingWorked = false;
-    errorMessage = std::string("ITK exception info: error in ") + e.GetLocation() + "\n"
-                                                + e.GetDescription() + "\n";
+    SetupReader(reader, fullName, fullFileNames, this->CenterImage);
+
+    vtkDebugMacro("ReadDataInternal: right before reader update, reader num files = " << reader->GetNumberOfFileNames());
+    readingWorked = UpdateReader(reader, errorMessage);
   }
   if (!readingWorked)
   {
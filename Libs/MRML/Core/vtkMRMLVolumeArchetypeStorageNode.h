@@ -17,9 +17,13 @@
 
 #include "vtkMRMLStorageNode.h"
 
+// VTK includes
+#include <vtkSmartPointer.h>
+
 class vtkImageData;
 class vtkITKArchetypeImageSeriesReader;
 class vtkMRMLVolumeNode;
+class vtkStringArray;
 
 /// \brief MRML node for representing a volume storage.
 ///
@@ -92,6 +96,24 @@ public:
   /// using only wrapped types.
   static void SetMetaDataDictionaryFromReader(vtkMRMLVolumeNode*, vtkITKArchetypeImageSeriesReader*);
 
+  /// Read a scalar volume from file the same way as ReadData() does, but without accessing
+  /// any MRML node or scene. Therefore, it can be called from a background thread
+  /// (for example, for reading multiple files in parallel).
+  /// \param fullFileNames optional list of all the files of the volume (full paths).
+  /// Returns a reader that contains the image in its output, nullptr if reading failed.
+  /// The caller is responsible for deleting the returned reader.
+  /// \sa SetPreReadScalarImageReader()
+  VTK_NEWINSTANCE
+  static vtkITKArchetypeImageSeriesReader* PreReadScalarImage(const char* fullName, vtkStringArray* fullFileNames,
+    bool singleFile, bool useOrientationFromFile, bool centerImage);
+
+  /// Set a reader returned by PreReadScalarImage() so that the next ReadData() call uses
+  /// its output instead of reading the file again. The reader is only used if the storage node
+  /// reads into a scalar or labelmap volume node, and the file name, single file and orientation settings
+  /// are the same. CenterImage must be the same as the value used in PreReadScalarImage().
+  /// The reader is released by the next ReadData() call.
+  void SetPreReadScalarImageReader(vtkITKArchetypeImageSeriesReader* reader);
+
 protected:
   vtkMRMLVolumeArchetypeStorageNode();
   ~vtkMRMLVolumeArchetypeStorageNode() override;
@@ -115,6 +137,8 @@ protected:
   int SingleFile;
   int UseOrientationFromFile;
 
+  vtkSmartPointer<vtkITKArchetypeImageSeriesReader> PreReadScalarImageReader;
+
 };
 
 #endif
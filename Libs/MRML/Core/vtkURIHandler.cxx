@@ -5,6 +5,9 @@
 // VTK includes
 #include <vtkObjectFactory.h>
 
+// VTKsys includes
+#include <vtksys/SystemTools.hxx>
+
 vtkStandardNewMacro ( vtkURIHandler );
 vtkCxxSetObjectMacro( vtkURIHandler, PermissionPrompter, vtkPermissionPrompter );
 //----------------------------------------------------------------------------
@@ -120,6 +123,49 @@ void vtkURIHandler::StageFileRead(const char * vtkNotUsed( source ),
 {
 }
 
+//----------------------------------------------------------------------------
+bool vtkURIHandler::StageFileReadWithStatus(const char* source, const char* destination)
+{
+  if (source == nullptr || destination == nullptr)
+  {
+    vtkErrorMacro("StageFileReadWithStatus: source or destination is null");
+    return false;
+  }
+  this->StageFileRead(source, destination);
+  // StageFileRead does not report errors, so check if the file is there
+  return vtksys::SystemTools::FileExists(destination, true);
+}
+
+//----------------------------------------------------------------------------
+int vtkURIHandler::StageFilesRead(const std::vector<std::string>& sources,
+                                  const std::vector<std::string>& destinations,
+                                  std::vector<bool>* succeeded)
+{
+  if (sources.size() != destinations.size())
+  {
+    vtkErrorMacro("StageFilesRead: number of sources (" << sources.size()
+      << ") and destinations (" << destinations.size() << ") differ");
+    return 0;
+  }
+  if (succeeded)
+  {
+    succeeded->assign(sources.size(), false);
+  }
+  int numberOfSucceeded = 0;
+  for (size_t fileIndex = 0; fileIndex < sources.size(); ++fileIndex)
+  {
+    if (this->StageFileReadWithStatus(sources[fileIndex].c_str(), destinations[fileIndex].c_str()))
+    {
+      ++numberOfSucceeded;
+      if (succeeded)
+      {
+        (*succeeded)[fileIndex] = true;
+      }
+    }
+  }
+  return numberOfSucceeded;
+}
+
 //----------------------------------------------------------------------------
 void vtkURIHandler::StageFileWrite(const char * vtkNotUsed( source ),
                               const char * vtkNotUsed( username ),
@@ -8,6 +8,10 @@ class vtkPermissionPrompter;
 // VTK includes
 #include <vtkObject.h>
 
+// STD includes
+#include <string>
+#include <vector>
+
 class VTK_MRML_EXPORT vtkURIHandler : public vtkObject
 {
 public:
@@ -40,6 +44,23 @@ public:
                               const char *hostname,
                               const char *sessionID );
 
+  ///
+  /// Download a single file and return true if the transfer was successful.
+  /// The default implementation calls StageFileRead(), which does not report
+  /// the result of the transfer, and returns true if the destination file exists.
+  /// Handlers should override it to return the actual result of the transfer.
+  virtual bool StageFileReadWithStatus(const char* source, const char* destination);
+
+  ///
+  /// Download multiple files, the i-th source is downloaded to the i-th destination.
+  /// Returns the number of successfully downloaded files. If succeeded is not null
+  /// then it is set to the download result of each file.
+  /// The default implementation downloads files one by one using StageFileReadWithStatus(),
+  /// handlers may override it to download files in parallel.
+  virtual int StageFilesRead(const std::vector<std::string>& sources,
+                             const std::vector<std::string>& destinations,
+                             std::vector<bool>* succeeded = nullptr);
+
   /// need something that goes the other way too...
 
   ///
@@ -0,0 +1,302 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLDisplayableManager includes
+#include <vtkMRMLDisplayableManagerGroup.h>
+#include <vtkMRMLModelDisplayableManager.h>
+
+// MRMLLogic includes
+#include <vtkMRMLApplicationLogic.h>
+
+// MRML includes
+#include <vtkMRMLModelDisplayNode.h>
+#include <vtkMRMLModelNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLViewNode.h>
+
+// VTK includes
+#include <vtkCamera.h>
+#include <vtkNew.h>
+#include <vtkProp3D.h>
+#include <vtkPropCollection.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkSphereSource.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const double ModelRadius = 1.0;
+const double ModelSpacing = 3.0;
+
+//----------------------------------------------------------------------------
+// Add small sphere models arranged in a square grid in the XY plane
+void AddModels(vtkMRMLScene* scene, int numberOfModels, std::vector<vtkMRMLModelDisplayNode*>& displayNodes,
+  std::vector<vtkMRMLModelNode*>& modelNodes, std::vector<std::vector<double> >& centers)
+{
+  int numberOfColumns = static_cast<int>(ceil(sqrt(static_cast<double>(numberOfModels))));
+  scene->StartState(vtkMRMLScene::BatchProcessState);
+  for (int modelIndex = 0; modelIndex < numberOfModels; ++modelIndex)
+  {
+    std::vector<double> center(3, 0.0);
+    center[0] = (modelIndex % numberOfColumns) * ModelSpacing;
+    center[1] = (modelIndex / numberOfColumns) * ModelSpacing;
+    vtkNew<vtkSphereSource> sphereSource;
+    sphereSource->SetRadius(ModelRadius);
+    sphereSource->SetCenter(center[0], center[1], center[2]);
+    sphereSource->SetThetaResolution(12);
+    sphereSource->SetPhiResolution(8);
+    sphereSource->Update();
+
+    vtkNew<vtkMRMLModelNode> modelNode;
+    modelNode->SetAndObservePolyData(sphereSource->GetOutput());
+    scene->AddNode(modelNode);
+    vtkNew<vtkMRMLModelDisplayNode> displayNode;
+    displayNode->SetColor((modelIndex % 7) / 6.0, (modelIndex % 5) / 4.0, (modelIndex % 3) / 2.0);
+    scene->AddNode(displayNode);
+    modelNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+
+    modelNodes.push_back(modelNode);
+    displayNodes.push_back(displayNode);
+    centers.push_back(center);
+  }
+  scene->EndState(vtkMRMLScene::BatchProcessState);
+}
+
+//----------------------------------------------------------------------------
+bool CheckNumberOfProps(vtkRenderer* renderer, int expectedNumberOfProps, int line)
+{
+  int numberOfProps = renderer->GetViewProps()->GetNumberOfItems();
+  if (numberOfProps != expectedNumberOfProps)
+  {
+    std::cerr << "Line " << line << ": expected " << expectedNumberOfProps
+      << " props, found " << numberOfProps << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool CheckPick(vtkMRMLModelDisplayableManager* displayableManager, const std::vector<double>& center,
+  vtkMRMLModelDisplayNode* expectedDisplayNode, int line)
+{
+  double position[3] = { center[0], center[1], center[2] };
+  displayableManager->Pick3D(position);
+  std::string pickedNodeID = displayableManager->GetPickedNodeID();
+  std::string expectedNodeID = expectedDisplayNode ? expectedDisplayNode->GetID() : "";
+  if (pickedNodeID != expectedNodeID)
+  {
+    std::cerr << "Line " << line << ": picked node is " << pickedNodeID
+      << ", expected " << expectedNodeID << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Check that the display node has its own actor (if expected) and the actor maps back to the display node.
+bool CheckActor(vtkMRMLModelDisplayableManager* displayableManager, vtkMRMLModelDisplayNode* displayNode,
+  bool expectedOwnActor, int line)
+{
+  vtkProp3D* actor = displayableManager->GetActorByID(displayNode->GetID());
+  if ((actor != nullptr) != expectedOwnActor)
+  {
+    std::cerr << "Line " << line << ": actor of " << displayNode->GetID()
+      << (expectedOwnActor ? " is not found" : " is expected to be nullptr for batched model") << std::endl;
+    return false;
+  }
+  if (actor)
+  {
+    const char* actorID = displayableManager->GetIDByActor(actor);
+    if (!actorID || std::string(actorID) != displayNode->GetID())
+    {
+      std::cerr << "Line " << line << ": actor of " << displayNode->GetID() << " is mapped to "
+        << (actorID ? actorID : "(none)") << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int TestModels(int numberOfModels, bool batchedRendering, bool checkResults)
+{
+  vtkNew<vtkRenderer> renderer;
+  vtkNew<vtkRenderWindow> renderWindow;
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  renderWindow->SetSize(600, 600);
+  renderWindow->SetMultiSamples(0);
+  renderWindow->SetOffScreenRendering(1);
+  renderWindow->AddRenderer(renderer);
+  renderWindow->SetInteractor(renderWindowInteractor);
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLApplicationLogic> applicationLogic;
+  applicationLogic->SetMRMLScene(scene);
+
+  vtkNew<vtkMRMLViewNode> viewNode;
+  scene->AddNode(viewNode);
+
+  vtkNew<vtkMRMLDisplayableManagerGroup> displayableManagerGroup;
+  displayableManagerGroup->SetRenderer(renderer);
+  displayableManagerGroup->SetMRMLDisplayableNode(viewNode);
+
+  vtkNew<vtkMRMLModelDisplayableManager> displayableManager;
+  displayableManager->SetMRMLApplicationLogic(applicationLogic);
+  displayableManager->SetBatchedRendering(batchedRendering);
+  displayableManagerGroup->AddDisplayableManager(displayableManager);
+  displayableManagerGroup->GetInteractor()->Initialize();
+
+  // Pipeline setup and first render
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  std::vector<vtkMRMLModelDisplayNode*> displayNodes;
+  std::vector<vtkMRMLModelNode*> modelNodes;
+  std::vector<std::vector<double> > centers;
+  AddModels(scene, numberOfModels, displayNodes, modelNodes, centers);
+  renderer->ResetCamera();
+  renderWindow->Render();
+  timer->StopTimer();
+  double setupTime = timer->GetElapsedTime();
+
+  // Frame time
+  const int numberOfFrames = 20;
+  timer->StartTimer();
+  for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+  {
+    renderer->GetActiveCamera()->Azimuth(1.0);
+    renderWindow->Render();
+  }
+  timer->StopTimer();
+  double frameTime = timer->GetElapsedTime() / numberOfFrames;
+  renderer->GetActiveCamera()->Azimuth(-numberOfFrames);
+  renderer->ResetCameraClippingRange();
+
+  std::cout << numberOfModels << " models, batched rendering "
+    << (batchedRendering ? "on" : "off") << ": setup and first render " << setupTime
+    << "s, frame time " << frameTime * 1000.0 << "ms" << std::endl;
+
+  int result = EXIT_SUCCESS;
+  if (checkResults)
+  {
+    int lastModelIndex = numberOfModels - 1;
+    if (!CheckNumberOfProps(renderer, batchedRendering ? 1 : numberOfModels, __LINE__)
+      || !CheckActor(displayableManager, displayNodes[0], !batchedRendering, __LINE__)
+      || !CheckPick(displayableManager, centers[0], displayNodes[0], __LINE__)
+      || !CheckPick(displayableManager, centers[lastModelIndex], displayNodes[lastModelIndex], __LINE__))
+    {
+      result = EXIT_FAILURE;
+    }
+  }
+  if (checkResults && batchedRendering && result == EXIT_SUCCESS)
+  {
+    // Batch actor does not correspond to a single display node
+    vtkProp3D* batchActor = vtkProp3D::SafeDownCast(renderer->GetViewProps()->GetItemAsObject(0));
+    if (!batchActor || displayableManager->GetIDByActor(batchActor) != nullptr)
+    {
+      std::cerr << "Line " << __LINE__ << ": batch actor is mapped to a display node" << std::endl;
+      result = EXIT_FAILURE;
+    }
+
+    // Color, opacity and visibility are set per model, they do not split the batch
+    displayNodes[0]->SetColor(1.0, 0.0, 0.0);
+    displayNodes[1]->SetOpacity(0.5);
+    displayNodes[2]->SetVisibility(false);
+    renderWindow->Render();
+    if (!CheckNumberOfProps(renderer, 1, __LINE__)
+      || !CheckPick(displayableManager, centers[0], displayNodes[0], __LINE__))
+    {
+      result = EXIT_FAILURE;
+    }
+
+    // Different shared display properties move the model to another batch
+    displayNodes[3]->SetRepresentation(vtkMRMLDisplayNode::WireframeRepresentation);
+    // Scalar coloring is not supported in batches, the model gets its own actor
+    displayNodes[4]->SetScalarVisibility(true);
+    renderWindow->Render();
+    if (displayableManager->GetNumberOfModelBatches() != 2
+      || !CheckNumberOfProps(renderer, 3, __LINE__)
+      || !CheckActor(displayableManager, displayNodes[3], false, __LINE__)
+      || !CheckActor(displayableManager, displayNodes[4], true, __LINE__)
+      || !CheckPick(displayableManager, centers[4], displayNodes[4], __LINE__))
+    {
+      std::cerr << "Line " << __LINE__ << ": incorrect batches after display property change" << std::endl;
+      result = EXIT_FAILURE;
+    }
+
+    // Removing the only model of a batch removes the batch
+    scene->RemoveNode(modelNodes[3]);
+    renderWindow->Render();
+    if (displayableManager->GetNumberOfModelBatches() != 1
+      || !CheckNumberOfProps(renderer, 2, __LINE__))
+    {
+      std::cerr << "Line " << __LINE__ << ": incorrect batches after model removal" << std::endl;
+      result = EXIT_FAILURE;
+    }
+
+    // Disabling batched rendering restores one actor per model
+    displayableManager->SetBatchedRendering(false);
+    renderWindow->Render();
+    if (displayableManager->GetNumberOfModelBatches() != 0
+      || !CheckNumberOfProps(renderer, numberOfModels - 1, __LINE__)
+      || !CheckActor(displayableManager, displayNodes[0], true, __LINE__)
+      || !CheckPick(displayableManager, centers[0], displayNodes[0], __LINE__))
+    {
+      std::cerr << "Line " << __LINE__ << ": incorrect props after disabling batched rendering" << std::endl;
+      result = EXIT_FAILURE;
+    }
+  }
+
+  displayableManager->SetMRMLApplicationLogic(nullptr);
+  return result;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLModelDisplayableManagerBatchingTest(int argc, char* argv[])
+{
+  // Run with --Benchmark to measure frame time with larger number of models
+  bool benchmark = false;
+  for (int i = 0; i < argc; i++)
+  {
+    benchmark |= (strcmp("--Benchmark", argv[i]) == 0);
+  }
+
+  if (TestModels(100, false, true) != EXIT_SUCCESS
+    || TestModels(100, true, true) != EXIT_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+
+  if (benchmark)
+  {
+    const int numberOfModels[] = { 1000, 10000 };
+    for (int numberOfModelsIndex = 0; numberOfModelsIndex < 2; ++numberOfModelsIndex)
+    {
+      TestModels(numberOfModels[numberOfModelsIndex], false, false);
+      TestModels(numberOfModels[numberOfModelsIndex], true, false);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -31,6 +31,7 @@
 #include <vtkMRMLInteractionNode.h>
 #include <vtkMRMLScene.h>
 #include <vtkMRMLSelectionNode.h>
+#include <vtkMRMLTraceLogger.h>
 
 // VTK includes
 #include <vtkCallbackCommand.h>
@@ -831,6 +832,7 @@ void vtkMRMLAbstractDisplayableManager::RequestRender()
 
   if (this->Internal->UpdateFromMRMLRequested)
   {
+    MRML_TRACE_SCOPE_DETAIL("DisplayableManager", "vtkMRMLAbstractDisplayableManager::UpdateFromMRML", this->GetClassName());
     this->UpdateFromMRML();
   }
 
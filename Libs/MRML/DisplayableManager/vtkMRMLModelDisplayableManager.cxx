@@ -12,6 +12,9 @@
 #include "vtkMRMLThreeDViewInteractorStyle.h"
 #include "vtkMRMLApplicationLogic.h"
 
+// MRMLLogic includes
+#include <vtkIncrementalPlaneClipPolyData.h>
+
 // MRML/Slicer includes
 #include <vtkEventBroker.h>
 #include <vtkMRMLClipModelsNode.h>
@@ -41,6 +44,8 @@
 #include <vtkClipDataSet.h>
 #include <vtkClipPolyData.h>
 #include <vtkColorTransferFunction.h>
+#include <vtkCompositeDataDisplayAttributes.h>
+#include <vtkCompositePolyDataMapper2.h>
 #include <vtkDataSetAttributes.h>
 #include <vtkDataSetMapper.h>
 #include <vtkExtractGeometry.h>
@@ -52,11 +57,13 @@
 #include <vtkImplicitBoolean.h>
 #include <vtkLookupTable.h>
 #include <vtkMatrix4x4.h>
+#include <vtkMultiBlockDataSet.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPlane.h>
 #include <vtkPointData.h>
 #include <vtkPointSet.h>
+#include <vtkPolyData.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkProp3DCollection.h>
 #include <vtkProperty.h>
@@ -73,6 +80,10 @@
 #include <vtkRendererCollection.h>
 #include <vtkWorldPointPicker.h>
 
+// STD includes
+#include <sstream>
+#include <vector>
+
 //---------------------------------------------------------------------------
 vtkStandardNewMacro (vtkMRMLModelDisplayableManager );
 
@@ -96,6 +107,51 @@ public:
   /// Find first picked node from prop3Ds in cell picker and set PickedNodeID in Internal
   void FindFirstPickedDisplayNodeFromPickerProp3Ds();
 
+  /// Models that share all display properties except color, opacity and visibility.
+  /// They are rendered by a single actor, each model mesh is a block of the mapper input.
+  struct ModelBatch
+  {
+    vtkSmartPointer<vtkActor> Actor;
+    vtkSmartPointer<vtkMultiBlockDataSet> Blocks;
+    vtkSmartPointer<vtkCompositeDataDisplayAttributes> Attributes;
+    std::map<vtkDataObject*, std::string> BlockDisplayNodeIDs;
+    std::vector<unsigned int> FreeBlockIndices;
+  };
+
+  struct BatchedModel
+  {
+    std::string BatchKey;
+    unsigned int BlockIndex;
+    vtkMTimeType MeshTime;
+  };
+
+  /// Return true if the display node can be rendered in a model batch.
+  /// propertiesDisplayNode is the display node that defines display properties
+  /// (display node of the model or an overriding folder display node).
+  bool IsBatchable(vtkMRMLDisplayableNode* model, vtkMRMLModelDisplayNode* modelDisplayNode,
+    vtkMRMLDisplayNode* propertiesDisplayNode, bool hasNonLinearTransform, int clipping,
+    vtkMRMLModelNode::MeshTypeHint meshType);
+  /// Get a string that identifies all display properties that are shared within a batch
+  std::string GetBatchKey(vtkMRMLDisplayableNode* model, vtkMRMLDisplayNode* propertiesDisplayNode);
+  /// Add the mesh of the display node to the batch or update it.
+  /// \return Actor of the batch, nullptr if the mesh cannot be added to the batch.
+  vtkActor* UpdateBatchedModel(const std::string& displayNodeID, const std::string& batchKey, vtkPolyData* mesh);
+  /// Remove mesh of the display node from its batch. The batch is removed when it becomes empty.
+  void RemoveBatchedModel(const std::string& displayNodeID);
+  /// Remove all batches from the renderer
+  void RemoveModelBatches();
+  /// Get the batch and mesh of a batched display node. Returns nullptr if the display node is not batched.
+  ModelBatch* GetModelBatch(const std::string& displayNodeID, vtkDataObject*& mesh);
+  /// Get the batch that uses the actor. Returns nullptr if the actor is not a batch actor.
+  ModelBatch* GetModelBatchByActor(vtkProp3D* prop);
+  /// Set color, opacity and visibility of a batched model
+  void SetBatchedModelDisplayProperty(const std::string& displayNodeID, vtkMRMLDisplayNode* displayNode,
+    bool visible, double opacity);
+  /// Remove the actor of the display node from the renderer, or the model from its batch
+  void RemoveDisplayedProp(const std::string& displayNodeID, vtkProp3D* prop);
+  /// Set actor properties that are not specific to a model in a batch
+  void UpdateActorProperty(vtkProperty* actorProperties, vtkMRMLDisplayNode* displayNode);
+
 public:
   vtkMRMLModelDisplayableManager* External;
 
@@ -105,6 +161,7 @@ public:
   std::map<std::string, vtkMRMLDisplayableNode*>   DisplayableNodes;
   std::map<std::string, int>                       RegisteredModelHierarchies;
   std::map<std::string, vtkTransformFilter*>       DisplayNodeTransformFilters;
+  std::map<std::string, vtkSmartPointer<vtkIncrementalPlaneClipPolyData> > DisplayNodeClippers;
 
   vtkMRMLSliceNode* RedSliceNode;
   vtkMRMLSliceNode* GreenSliceNode;
@@ -125,6 +182,10 @@ public:
 
   bool IsUpdatingModelsFromMRML;
 
+  bool BatchedRendering;
+  std::map<std::string, ModelBatch>   ModelBatches;
+  std::map<std::string, BatchedModel> BatchedModels;
+
   vtkSmartPointer<vtkWorldPointPicker> WorldPointPicker;
   vtkSmartPointer<vtkPropPicker>       PropPicker;
   vtkSmartPointer<vtkCellPicker>       CellPicker;
@@ -162,6 +223,7 @@ vtkMRMLModelDisplayableManager::vtkInternal::vtkInternal(vtkMRMLModelDisplayable
   this->ResetPick();
 
   this->IsUpdatingModelsFromMRML = false;
+  this->BatchedRendering = false;
 }
 
 //---------------------------------------------------------------------------
@@ -311,6 +373,24 @@ void vtkMRMLModelDisplayableManager::vtkInternal::FindFirstPickedDisplayNodeFrom
     {
       continue;
     }
+    if (this->GetModelBatchByActor(pickedProp))
+    {
+      // Batch actors render many models, the picked model is identified by the picked block.
+      // The picked block is only known for the closest prop.
+      if (pickedProp != this->CellPicker->GetProp3D())
+      {
+        continue;
+      }
+      ModelBatch* batch = this->GetModelBatchByActor(pickedProp);
+      std::map<vtkDataObject*, std::string>::iterator blockIt =
+        batch->BlockDisplayNodeIDs.find(this->CellPicker->GetDataSet());
+      if (blockIt != batch->BlockDisplayNodeIDs.end())
+      {
+        this->PickedDisplayNodeID = blockIt->second;
+        return; // Display node found
+      }
+      continue;
+    }
     std::map<std::string, vtkProp3D*>::iterator propIt;
     for (propIt = this->DisplayedActors.begin(); propIt != this->DisplayedActors.end(); propIt++)
     {
@@ -323,6 +403,305 @@ void vtkMRMLModelDisplayableManager::vtkInternal::FindFirstPickedDisplayNodeFrom
   }
 }
 
+//---------------------------------------------------------------------------
+bool vtkMRMLModelDisplayableManager::vtkInternal::IsBatchable(vtkMRMLDisplayableNode* model,
+  vtkMRMLModelDisplayNode* modelDisplayNode, vtkMRMLDisplayNode* propertiesDisplayNode,
+  bool hasNonLinearTransform, int clipping, vtkMRMLModelNode::MeshTypeHint meshType)
+{
+  if (!this->BatchedRendering || !modelDisplayNode || !propertiesDisplayNode)
+  {
+    return false;
+  }
+  if (meshType != vtkMRMLModelNode::PolyDataMeshType || hasNonLinearTransform)
+  {
+    return false;
+  }
+  if (this->ClippingOn && clipping)
+  {
+    return false;
+  }
+  if (vtkMRMLSliceLogic::IsSliceModelNode(model))
+  {
+    return false;
+  }
+  // Colors of a batched model are defined by a single color per block
+  if (propertiesDisplayNode->GetScalarVisibility()
+    || propertiesDisplayNode->GetTextureImageDataConnection() != nullptr)
+  {
+    return false;
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+std::string vtkMRMLModelDisplayableManager::vtkInternal::GetBatchKey(
+  vtkMRMLDisplayableNode* model, vtkMRMLDisplayNode* propertiesDisplayNode)
+{
+  vtkMRMLDisplayNode* displayNode = propertiesDisplayNode;
+  vtkMRMLTransformNode* transformNode = model->GetParentTransformNode();
+  bool selected = displayNode->GetSelected();
+  double* edgeColor = displayNode->GetEdgeColor();
+  std::ostringstream key;
+  key << (transformNode && transformNode->GetID() ? transformNode->GetID() : "")
+    << "|" << model->GetSelectable()
+    << "|" << displayNode->GetRepresentation()
+    << "|" << displayNode->GetPointSize()
+    << "|" << displayNode->GetLineWidth()
+    << "|" << displayNode->GetLighting()
+    << "|" << displayNode->GetInterpolation()
+    << "|" << displayNode->GetShading()
+    << "|" << displayNode->GetFrontfaceCulling()
+    << "|" << displayNode->GetBackfaceCulling()
+    << "|" << (selected ? displayNode->GetSelectedAmbient() : displayNode->GetAmbient())
+    << "|" << (selected ? displayNode->GetSelectedSpecular() : displayNode->GetSpecular())
+    << "|" << displayNode->GetDiffuse()
+    << "|" << displayNode->GetPower()
+    << "|" << displayNode->GetMetallic()
+    << "|" << displayNode->GetRoughness()
+    << "|" << displayNode->GetEdgeVisibility()
+    << "|" << edgeColor[0] << "," << edgeColor[1] << "," << edgeColor[2];
+  return key.str();
+}
+
+//---------------------------------------------------------------------------
+vtkActor* vtkMRMLModelDisplayableManager::vtkInternal::UpdateBatchedModel(
+  const std::string& displayNodeID, const std::string& batchKey, vtkPolyData* mesh)
+{
+  if (!mesh)
+  {
+    return nullptr;
+  }
+
+  // Block properties are stored per mesh, therefore a mesh can appear only once in a batch
+  std::map<std::string, ModelBatch>::iterator batchIt = this->ModelBatches.find(batchKey);
+  if (batchIt != this->ModelBatches.end())
+  {
+    std::map<vtkDataObject*, std::string>::iterator blockIt = batchIt->second.BlockDisplayNodeIDs.find(mesh);
+    if (blockIt != batchIt->second.BlockDisplayNodeIDs.end() && blockIt->second != displayNodeID)
+    {
+      return nullptr;
+    }
+  }
+
+  std::map<std::string, BatchedModel>::iterator batchedModelIt = this->BatchedModels.find(displayNodeID);
+  if (batchedModelIt != this->BatchedModels.end() && batchedModelIt->second.BatchKey != batchKey)
+  {
+    // Shared display properties have changed, move the model to another batch
+    this->RemoveBatchedModel(displayNodeID);
+    batchedModelIt = this->BatchedModels.end();
+  }
+
+  if (batchIt == this->ModelBatches.end())
+  {
+    ModelBatch& newBatch = this->ModelBatches[batchKey];
+    newBatch.Blocks = vtkSmartPointer<vtkMultiBlockDataSet>::New();
+    newBatch.Attributes = vtkSmartPointer<vtkCompositeDataDisplayAttributes>::New();
+    vtkNew<vtkCompositePolyDataMapper2> mapper;
+    mapper->SetInputDataObject(newBatch.Blocks);
+    mapper->SetCompositeDataDisplayAttributes(newBatch.Attributes);
+    mapper->ScalarVisibilityOff();
+    newBatch.Actor = vtkSmartPointer<vtkActor>::New();
+    newBatch.Actor->SetMapper(mapper);
+    this->External->GetRenderer()->AddViewProp(newBatch.Actor);
+    batchIt = this->ModelBatches.find(batchKey);
+  }
+  ModelBatch& batch = batchIt->second;
+
+  bool meshModified = false;
+  if (batchedModelIt == this->BatchedModels.end())
+  {
+    unsigned int blockIndex = batch.Blocks->GetNumberOfBlocks();
+    if (!batch.FreeBlockIndices.empty())
+    {
+      blockIndex = batch.FreeBlockIndices.back();
+      batch.FreeBlockIndices.pop_back();
+    }
+    batch.Blocks->SetBlock(blockIndex, mesh);
+    batch.BlockDisplayNodeIDs[mesh] = displayNodeID;
+    BatchedModel& batchedModel = this->BatchedModels[displayNodeID];
+    batchedModel.BatchKey = batchKey;
+    batchedModel.BlockIndex = blockIndex;
+    batchedModel.MeshTime = mesh->GetMTime();
+    meshModified = true;
+  }
+  else
+  {
+    BatchedModel& batchedModel = batchedModelIt->second;
+    vtkDataObject* previousMesh = batch.Blocks->GetBlock(batchedModel.BlockIndex);
+    if (previousMesh != mesh)
+    {
+      batch.BlockDisplayNodeIDs.erase(previousMesh);
+      batch.Attributes->RemoveBlockVisibility(previousMesh);
+      batch.Attributes->RemoveBlockPickability(previousMesh);
+      batch.Attributes->RemoveBlockColor(previousMesh);
+      batch.Attributes->RemoveBlockOpacity(previousMesh);
+      batch.Blocks->SetBlock(batchedModel.BlockIndex, mesh);
+      batch.BlockDisplayNodeIDs[mesh] = displayNodeID;
+      meshModified = true;
+    }
+    // Only rebuild the batch if the mesh content changed, not on every display property change
+    if (mesh->GetMTime() > batchedModel.MeshTime)
+    {
+      batchedModel.MeshTime = mesh->GetMTime();
+      meshModified = true;
+    }
+  }
+  if (meshModified)
+  {
+    batch.Blocks->Modified();
+  }
+  return batch.Actor;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::vtkInternal::RemoveBatchedModel(const std::string& displayNodeID)
+{
+  std::map<std::string, BatchedModel>::iterator batchedModelIt = this->BatchedModels.find(displayNodeID);
+  if (batchedModelIt == this->BatchedModels.end())
+  {
+    return;
+  }
+  std::map<std::string, ModelBatch>::iterator batchIt = this->ModelBatches.find(batchedModelIt->second.BatchKey);
+  if (batchIt != this->ModelBatches.end())
+  {
+    ModelBatch& batch = batchIt->second;
+    unsigned int blockIndex = batchedModelIt->second.BlockIndex;
+    vtkDataObject* mesh = batch.Blocks->GetBlock(blockIndex);
+    if (mesh)
+    {
+      batch.BlockDisplayNodeIDs.erase(mesh);
+      batch.Attributes->RemoveBlockVisibility(mesh);
+      batch.Attributes->RemoveBlockPickability(mesh);
+      batch.Attributes->RemoveBlockColor(mesh);
+      batch.Attributes->RemoveBlockOpacity(mesh);
+    }
+    batch.Blocks->SetBlock(blockIndex, nullptr);
+    batch.Blocks->Modified();
+    batch.FreeBlockIndices.push_back(blockIndex);
+    if (batch.BlockDisplayNodeIDs.empty())
+    {
+      if (this->External->GetRenderer())
+      {
+        this->External->GetRenderer()->RemoveViewProp(batch.Actor);
+      }
+      this->ModelBatches.erase(batchIt);
+    }
+  }
+  this->BatchedModels.erase(batchedModelIt);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::vtkInternal::RemoveModelBatches()
+{
+  vtkRenderer* renderer = this->External->GetRenderer();
+  for (std::pair<const std::string, ModelBatch>& batch : this->ModelBatches)
+  {
+    if (renderer)
+    {
+      renderer->RemoveViewProp(batch.second.Actor);
+    }
+  }
+  this->ModelBatches.clear();
+  this->BatchedModels.clear();
+}
+
+//---------------------------------------------------------------------------
+vtkMRMLModelDisplayableManager::vtkInternal::ModelBatch* vtkMRMLModelDisplayableManager::vtkInternal::GetModelBatch(
+  const std::string& displayNodeID, vtkDataObject*& mesh)
+{
+  mesh = nullptr;
+  std::map<std::string, BatchedModel>::iterator batchedModelIt = this->BatchedModels.find(displayNodeID);
+  if (batchedModelIt == this->BatchedModels.end())
+  {
+    return nullptr;
+  }
+  std::map<std::string, ModelBatch>::iterator batchIt = this->ModelBatches.find(batchedModelIt->second.BatchKey);
+  if (batchIt == this->ModelBatches.end())
+  {
+    return nullptr;
+  }
+  mesh = batchIt->second.Blocks->GetBlock(batchedModelIt->second.BlockIndex);
+  return &batchIt->second;
+}
+
+//---------------------------------------------------------------------------
+vtkMRMLModelDisplayableManager::vtkInternal::ModelBatch* vtkMRMLModelDisplayableManager::vtkInternal::GetModelBatchByActor(
+  vtkProp3D* prop)
+{
+  if (!prop)
+  {
+    return nullptr;
+  }
+  // There are only a few batches, one for each combination of shared display properties
+  for (std::pair<const std::string, ModelBatch>& batch : this->ModelBatches)
+  {
+    if (batch.second.Actor.GetPointer() == prop)
+    {
+      return &batch.second;
+    }
+  }
+  return nullptr;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::vtkInternal::SetBatchedModelDisplayProperty(
+  const std::string& displayNodeID, vtkMRMLDisplayNode* displayNode, bool visible, double opacity)
+{
+  vtkDataObject* mesh = nullptr;
+  ModelBatch* batch = this->GetModelBatch(displayNodeID, mesh);
+  if (!batch || !mesh)
+  {
+    return;
+  }
+  batch->Attributes->SetBlockVisibility(mesh, visible);
+  batch->Attributes->SetBlockPickability(mesh, visible);
+  batch->Attributes->SetBlockColor(mesh,
+    displayNode->GetSelected() ? displayNode->GetSelectedColor() : displayNode->GetColor());
+  batch->Attributes->SetBlockOpacity(mesh, opacity);
+  batch->Attributes->Modified();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::vtkInternal::RemoveDisplayedProp(const std::string& displayNodeID, vtkProp3D* prop)
+{
+  if (this->BatchedModels.find(displayNodeID) != this->BatchedModels.end())
+  {
+    this->RemoveBatchedModel(displayNodeID);
+    return;
+  }
+  this->External->GetRenderer()->RemoveViewProp(prop);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::vtkInternal::UpdateActorProperty(vtkProperty* actorProperties,
+  vtkMRMLDisplayNode* displayNode)
+{
+  actorProperties->SetRepresentation(displayNode->GetRepresentation());
+  actorProperties->SetPointSize(displayNode->GetPointSize());
+  actorProperties->SetLineWidth(displayNode->GetLineWidth());
+  actorProperties->SetLighting(displayNode->GetLighting());
+  actorProperties->SetInterpolation(displayNode->GetInterpolation());
+  actorProperties->SetShading(displayNode->GetShading());
+  actorProperties->SetFrontfaceCulling(displayNode->GetFrontfaceCulling());
+  actorProperties->SetBackfaceCulling(displayNode->GetBackfaceCulling());
+  if (displayNode->GetSelected())
+  {
+    actorProperties->SetAmbient(displayNode->GetSelectedAmbient());
+    actorProperties->SetSpecular(displayNode->GetSelectedSpecular());
+  }
+  else
+  {
+    actorProperties->SetAmbient(displayNode->GetAmbient());
+    actorProperties->SetSpecular(displayNode->GetSpecular());
+  }
+  actorProperties->SetDiffuse(displayNode->GetDiffuse());
+  actorProperties->SetSpecularPower(displayNode->GetPower());
+  actorProperties->SetMetallic(displayNode->GetMetallic());
+  actorProperties->SetRoughness(displayNode->GetRoughness());
+  actorProperties->SetEdgeVisibility(displayNode->GetEdgeVisibility());
+  actorProperties->SetEdgeColor(displayNode->GetEdgeColor());
+}
+
 
 //---------------------------------------------------------------------------
 // vtkMRMLModelDisplayableManager methods
@@ -381,6 +760,34 @@ void vtkMRMLModelDisplayableManager::PrintSelf ( ostream& os, vtkIndent indent )
       << this->Internal->PickedRAS[1] << ", "<< this->Internal->PickedRAS[2] << ")\n";
   os << indent << "PickedCellID = " << this->Internal->PickedCellID << "\n";
   os << indent << "PickedPointID = " << this->Internal->PickedPointID << "\n";
+  os << indent << "BatchedRendering = " << (this->Internal->BatchedRendering ? "true" : "false") << "\n";
+  os << indent << "NumberOfModelBatches = " << this->Internal->ModelBatches.size() << "\n";
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::SetBatchedRendering(bool batched)
+{
+  if (this->Internal->BatchedRendering == batched)
+  {
+    return;
+  }
+  this->Internal->BatchedRendering = batched;
+  this->Modified();
+  // Actors are created or removed as needed in the next update
+  this->SetUpdateFromMRMLRequested(true);
+  this->RequestRender();
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLModelDisplayableManager::GetBatchedRendering()
+{
+  return this->Internal->BatchedRendering;
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLModelDisplayableManager::GetNumberOfModelBatches()
+{
+  return static_cast<int>(this->Internal->ModelBatches.size());
 }
 
 //---------------------------------------------------------------------------
@@ -939,13 +1346,14 @@ void vtkMRMLModelDisplayableManager::UpdateModelsFromMRML()
   {
     for (std::pair< const std::string, vtkProp3D* > iter : this->Internal->DisplayedActors)
     {
-      this->GetRenderer()->RemoveViewProp(iter.second);
+      this->Internal->RemoveDisplayedProp(iter.first, iter.second);
     }
     this->RemoveModelObservers(1);
     this->Internal->DisplayedActors.clear();
     this->Internal->DisplayedNodes.clear();
     this->Internal->DisplayedClipState.clear();
     this->Internal->DisplayNodeTransformFilters.clear();
+    this->Internal->DisplayNodeClippers.clear();
   }
 
   // render slices first
@@ -1052,6 +1460,43 @@ void vtkMRMLModelDisplayableManager::UpdateModelMesh(vtkMRMLDisplayableNode *dis
       continue;
     }
 
+    vtkMRMLModelNode::MeshTypeHint meshType = modelNode ? modelNode->GetMeshType() : vtkMRMLModelNode::PolyDataMeshType;
+
+    // Render the model in a shared batch if possible
+    std::string displayNodeID = displayNode->GetID();
+    vtkMRMLDisplayNode* propertiesDisplayNode =
+      (hdnode && displayNode->GetFolderDisplayOverrideAllowed()) ? hdnode : displayNode;
+    if (this->Internal->IsBatchable(displayableNode, modelDisplayNode, propertiesDisplayNode,
+      hasNonLinearTransform, clipping, meshType))
+    {
+      // Batched meshes are not updated by the rendering pipeline, update them now
+      meshConnection->GetProducer()->Update();
+      vtkPolyData* mesh = vtkPolyData::SafeDownCast(
+        meshConnection->GetProducer()->GetOutputDataObject(meshConnection->GetIndex()));
+      std::map<std::string, vtkProp3D*>::iterator displayedActorIt = this->Internal->DisplayedActors.find(displayNodeID);
+      vtkProp3D* previousProp = (displayedActorIt != this->Internal->DisplayedActors.end() ? displayedActorIt->second : nullptr);
+      bool wasBatched = this->Internal->BatchedModels.find(displayNodeID) != this->Internal->BatchedModels.end();
+      vtkActor* batchActor = this->Internal->UpdateBatchedModel(displayNodeID,
+        this->Internal->GetBatchKey(displayableNode, propertiesDisplayNode), mesh);
+      if (batchActor)
+      {
+        if (previousProp && !wasBatched)
+        {
+          this->GetRenderer()->RemoveViewProp(previousProp);
+        }
+        this->Internal->DisplayedActors[displayNodeID] = batchActor;
+        this->Internal->DisplayedNodes[displayNodeID] = modelDisplayNode;
+        this->Internal->DisplayedClipState[displayNodeID] = 0;
+        continue;
+      }
+    }
+    if (this->Internal->BatchedModels.find(displayNodeID) != this->Internal->BatchedModels.end())
+    {
+      // The model cannot be rendered in a batch anymore, create its own actor
+      this->Internal->RemoveBatchedModel(displayNodeID);
+      this->RemoveDisplayedID(displayNodeID);
+    }
+
     // create TransformFilter for non-linear transform
     vtkTransformFilter* transformFilter = nullptr;
     if (hasNonLinearTransform)
@@ -1080,8 +1525,6 @@ void vtkMRMLModelDisplayableManager::UpdateModelMesh(vtkMRMLDisplayableNode *dis
       }
     }
 
-    vtkMRMLModelNode::MeshTypeHint meshType = modelNode ? modelNode->GetMeshType() : vtkMRMLModelNode::PolyDataMeshType;
-
     std::map<std::string, vtkProp3D *>::iterator ait;
     ait = this->Internal->DisplayedActors.find(displayNode->GetID());
     if (ait == this->Internal->DisplayedActors.end() )
@@ -1101,6 +1544,26 @@ void vtkMRMLModelDisplayableManager::UpdateModelMesh(vtkMRMLDisplayableNode *dis
       }
       if (cit != this->Internal->DisplayedClipState.end() && cit->second == clipping )
       {
+        // clipped polydata is clipped incrementally, only the clip planes need to be updated
+        std::map<std::string, vtkSmartPointer<vtkIncrementalPlaneClipPolyData> >::iterator clipperIt =
+          this->Internal->DisplayNodeClippers.find(displayNodeID);
+        vtkActor* clippedActor = vtkActor::SafeDownCast(prop);
+        if (this->Internal->ClippingOn && clipping && clipperIt != this->Internal->DisplayNodeClippers.end()
+          && meshType == vtkMRMLModelNode::PolyDataMeshType && clippedActor && clippedActor->GetMapper())
+        {
+          vtkIncrementalPlaneClipPolyData* incrementalClipper = clipperIt->second;
+          if (transformFilter)
+          {
+            incrementalClipper->SetInputConnection(transformFilter->GetOutputPort());
+          }
+          else
+          {
+            incrementalClipper->SetInputConnection(meshConnection);
+          }
+          this->UpdateIncrementalClipper(incrementalClipper, displayableNode->GetParentTransformNode());
+          clippedActor->GetMapper()->SetInputConnection(incrementalClipper->GetOutputPort());
+          continue;
+        }
         // make sure that we are looking at the current mesh (most of the code in here
         // assumes a display node will never change what mesh it wants to view and hence
         // caches information to skip steps if the display node has already rendered. but we
@@ -1138,9 +1601,23 @@ void vtkMRMLModelDisplayableManager::UpdateModelMesh(vtkMRMLDisplayableNode *dis
     vtkAlgorithm *clipper = nullptr;
     if(actor)
     {
-      if (this->Internal->ClippingOn && modelDisplayNode != nullptr && clipping)
+      if (this->Internal->ClippingOn && modelDisplayNode != nullptr && clipping
+        && meshType == vtkMRMLModelNode::PolyDataMeshType)
+      {
+        // Keep the clipper so that only intersected cells are clipped again when slices move
+        vtkIncrementalPlaneClipPolyData* incrementalClipper = vtkIncrementalPlaneClipPolyData::New();
+        this->UpdateIncrementalClipper(incrementalClipper, displayableNode->GetParentTransformNode());
+        this->Internal->DisplayNodeClippers[displayNodeID] = incrementalClipper;
+        clipper = incrementalClipper;
+      }
+      else if (this->Internal->ClippingOn && modelDisplayNode != nullptr && clipping)
       {
         clipper = this->CreateTransformedClipper(modelNode->GetParentTransformNode(), meshType);
+        this->Internal->DisplayNodeClippers.erase(displayNodeID);
+      }
+      else
+      {
+        this->Internal->DisplayNodeClippers.erase(displayNodeID);
       }
 
       vtkMapper *mapper = nullptr;
@@ -1252,7 +1729,7 @@ void vtkMRMLModelDisplayableManager::RemoveModelProps()
       this->GetMRMLScene() ? this->GetMRMLScene()->GetNodeByID(iter->first) : nullptr);
     if (modelDisplayNode == nullptr)
     {
-      this->GetRenderer()->RemoveViewProp(iter->second);
+      this->Internal->RemoveDisplayedProp(iter->first, iter->second);
       removedIDs.push_back(iter->first);
     }
     else
@@ -1269,10 +1746,12 @@ void vtkMRMLModelDisplayableManager::RemoveModelProps()
       }
       else
       {
-
-        if (clipIter->second  || (this->Internal->ClippingOn && clipIter->second != clipModel))
+        // incrementally clipped models are kept, their clip planes are updated in UpdateModelMesh
+        bool keepClipped = clipIter->second && this->Internal->ClippingOn && clipModel
+          && this->Internal->DisplayNodeClippers.find(iter->first) != this->Internal->DisplayNodeClippers.end();
+        if ((clipIter->second && !keepClipped) || (this->Internal->ClippingOn && clipIter->second != clipModel))
         {
-          this->GetRenderer()->RemoveViewProp(iter->second);
+          this->Internal->RemoveDisplayedProp(iter->first, iter->second);
           removedIDs.push_back(iter->first);
         }
       }
@@ -1304,7 +1783,7 @@ void vtkMRMLModelDisplayableManager::RemoveDisplayable(vtkMRMLDisplayableNode* m
       this->Internal->DisplayedActors.find(displayNodeIDToRemove);
     if (iter != this->Internal->DisplayedActors.end())
     {
-      this->GetRenderer()->RemoveViewProp(iter->second);
+      this->Internal->RemoveDisplayedProp(iter->first, iter->second);
       removedIDs.push_back(iter->first);
     }
   }
@@ -1323,6 +1802,7 @@ void vtkMRMLModelDisplayableManager::RemoveDisplayedID(std::string &id)
   std::map<std::string, vtkMRMLDisplayNode *>::iterator modelIter;
   this->Internal->DisplayedActors.erase(id);
   this->Internal->DisplayedClipState.erase(id);
+  this->Internal->DisplayNodeClippers.erase(id);
   modelIter = this->Internal->DisplayedNodes.find(id);
   if (modelIter != this->Internal->DisplayedNodes.end())
   {
@@ -1345,6 +1825,13 @@ int vtkMRMLModelDisplayableManager::GetDisplayedModelsVisibility(vtkMRMLDisplayN
     return 0;
   }
 
+  vtkDataObject* batchedMesh = nullptr;
+  vtkInternal::ModelBatch* batch = this->Internal->GetModelBatch(displayNode->GetID(), batchedMesh);
+  if (batch)
+  {
+    return batch->Attributes->GetBlockVisibility(batchedMesh) ? 1 : 0;
+  }
+
   vtkProp3D* actor = it->second;
   return actor->GetVisibility();
 }
@@ -1370,10 +1857,12 @@ void vtkMRMLModelDisplayableManager::RemoveModelObservers(int clearCache)
   }
   if (clearCache)
   {
+    this->Internal->RemoveModelBatches();
     this->Internal->DisplayableNodes.clear();
     this->Internal->DisplayedActors.clear();
     this->Internal->DisplayedNodes.clear();
     this->Internal->DisplayedClipState.clear();
+    this->Internal->DisplayNodeClippers.clear();
   }
 }
 
@@ -1421,7 +1910,9 @@ void vtkMRMLModelDisplayableManager::SetModelDisplayProperty(vtkMRMLDisplayableN
     {
       continue;
     }
-    vtkProp3D *prop = this->GetActorByID(modelDisplayNode->GetID());
+    // GetActorByID() does not return shared batch actors, therefore get the prop directly
+    std::map<std::string, vtkProp3D*>::iterator propIt = this->Internal->DisplayedActors.find(modelDisplayNode->GetID());
+    vtkProp3D *prop = (propIt != this->Internal->DisplayedActors.end() ? propIt->second : nullptr);
     if (prop == nullptr)
     {
       continue;
@@ -1458,6 +1949,20 @@ void vtkMRMLModelDisplayableManager::SetModelDisplayProperty(vtkMRMLDisplayableN
     bool visible = hierarchyVisibility
       && modelDisplayNode->GetVisibility() && modelDisplayNode->GetVisibility3D()
       && modelDisplayNode->IsDisplayableInView(this->GetMRMLViewNode()->GetID());
+
+    if (this->Internal->BatchedModels.find(modelDisplayNode->GetID()) != this->Internal->BatchedModels.end())
+    {
+      // The batch actor is shared, only color, opacity and visibility are specific to this model
+      if (actor)
+      {
+        this->Internal->UpdateActorProperty(actor->GetProperty(), displayNode);
+        actor->SetPickable(model->GetSelectable());
+      }
+      this->Internal->SetBatchedModelDisplayProperty(modelDisplayNode->GetID(), displayNode,
+        visible, hierarchyOpacity * modelDisplayNode->GetOpacity());
+      continue;
+    }
+
     prop->SetVisibility(visible);
 
     vtkMapper* mapper = actor ? actor->GetMapper() : nullptr;
@@ -1513,37 +2018,13 @@ void vtkMRMLModelDisplayableManager::SetModelDisplayProperty(vtkMRMLDisplayableN
       }
 
       vtkProperty* actorProperties = actor->GetProperty();
-      actorProperties->SetRepresentation(displayNode->GetRepresentation());
-      actorProperties->SetPointSize(displayNode->GetPointSize());
-      actorProperties->SetLineWidth(displayNode->GetLineWidth());
-      actorProperties->SetLighting(displayNode->GetLighting());
-      actorProperties->SetInterpolation(displayNode->GetInterpolation());
-      actorProperties->SetShading(displayNode->GetShading());
-      actorProperties->SetFrontfaceCulling(displayNode->GetFrontfaceCulling());
-      actorProperties->SetBackfaceCulling(displayNode->GetBackfaceCulling());
+      this->Internal->UpdateActorProperty(actorProperties, displayNode);
 
       actor->SetPickable(model->GetSelectable());
-      if (displayNode->GetSelected())
-      {
-        actorProperties->SetColor(displayNode->GetSelectedColor());
-        actorProperties->SetAmbient(displayNode->GetSelectedAmbient());
-        actorProperties->SetSpecular(displayNode->GetSelectedSpecular());
-      }
-      else
-      {
-        actorProperties->SetColor(displayNode->GetColor());
-        actorProperties->SetAmbient(displayNode->GetAmbient());
-        actorProperties->SetSpecular(displayNode->GetSpecular());
-      }
+      actorProperties->SetColor(displayNode->GetSelected() ? displayNode->GetSelectedColor() : displayNode->GetColor());
       // Opacity will be the product of the opacities of the model and the overriding
       // hierarchy, in order to keep the relative opacities the same.
       actorProperties->SetOpacity(hierarchyOpacity * modelDisplayNode->GetOpacity());
-      actorProperties->SetDiffuse(displayNode->GetDiffuse());
-      actorProperties->SetSpecularPower(displayNode->GetPower());
-      actorProperties->SetMetallic(displayNode->GetMetallic());
-      actorProperties->SetRoughness(displayNode->GetRoughness());
-      actorProperties->SetEdgeVisibility(displayNode->GetEdgeVisibility());
-      actorProperties->SetEdgeColor(displayNode->GetEdgeColor());
       if (displayNode->GetTextureImageDataConnection() != nullptr)
       {
         if (actor->GetTexture() == nullptr)
@@ -1675,6 +2156,12 @@ vtkProp3D * vtkMRMLModelDisplayableManager::GetActorByID(const char *id)
     return (nullptr);
   }
 
+  // Batch actors are shared by many display nodes, they are not returned as actor of a display node
+  if (this->Internal->BatchedModels.find(std::string(id)) != this->Internal->BatchedModels.end())
+  {
+    return (nullptr);
+  }
+
   std::map<std::string, vtkProp3D *>::iterator iter =
     this->Internal->DisplayedActors.find(std::string(id));
   if (iter != this->Internal->DisplayedActors.end())
@@ -1695,6 +2182,12 @@ const char * vtkMRMLModelDisplayableManager::GetIDByActor(vtkProp3D *actor)
     return (nullptr);
   }
 
+  // A batch actor does not correspond to a single display node
+  if (this->Internal->GetModelBatchByActor(actor))
+  {
+    return (nullptr);
+  }
+
   std::map<std::string, vtkProp3D *>::iterator iter;
   for(iter=this->Internal->DisplayedActors.begin();
       iter != this->Internal->DisplayedActors.end();
@@ -2028,6 +2521,73 @@ vtkAlgorithm* vtkMRMLModelDisplayableManager
   }
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::UpdateIncrementalClipper(vtkIncrementalPlaneClipPolyData* clipper,
+  vtkMRMLTransformNode* tnode)
+{
+  if (!clipper)
+  {
+    return;
+  }
+  if (this->Internal->ClipType == vtkMRMLClipModelsNode::ClipUnion)
+  {
+    clipper->SetOperationTypeToUnion();
+  }
+  else
+  {
+    clipper->SetOperationTypeToIntersection();
+  }
+  if (this->Internal->ClippingMethod == vtkMRMLClipModelsNode::WholeCells)
+  {
+    clipper->SetClipMethod(vtkIncrementalPlaneClipPolyData::ClipWholeCells);
+  }
+  else if (this->Internal->ClippingMethod == vtkMRMLClipModelsNode::WholeCellsWithBoundary)
+  {
+    clipper->SetClipMethod(vtkIncrementalPlaneClipPolyData::ClipWholeCellsWithBoundary);
+  }
+  else
+  {
+    clipper->SetClipMethod(vtkIncrementalPlaneClipPolyData::ClipStraight);
+  }
+
+  // Models under non-linear transforms are clipped after the transform filter, in world coordinates
+  vtkNew<vtkMatrix4x4> worldToLocal;
+  if (tnode != nullptr && tnode->IsTransformToWorldLinear())
+  {
+    tnode->GetMatrixTransformFromWorld(worldToLocal.GetPointer());
+  }
+
+  vtkMRMLSliceNode* sliceNodes[3] =
+    { this->Internal->RedSliceNode, this->Internal->GreenSliceNode, this->Internal->YellowSliceNode };
+  int sliceClipStates[3] =
+    { this->Internal->RedSliceClipState, this->Internal->GreenSliceClipState, this->Internal->YellowSliceClipState };
+  std::vector<int> clippingSliceIndices;
+  for (int sliceIndex = 0; sliceIndex < 3; ++sliceIndex)
+  {
+    if (sliceClipStates[sliceIndex] != vtkMRMLClipModelsNode::ClipOff && sliceNodes[sliceIndex])
+    {
+      clippingSliceIndices.push_back(sliceIndex);
+    }
+  }
+  clipper->SetNumberOfPlanes(static_cast<int>(clippingSliceIndices.size()));
+  for (int planeIndex = 0; planeIndex < static_cast<int>(clippingSliceIndices.size()); ++planeIndex)
+  {
+    int sliceIndex = clippingSliceIndices[planeIndex];
+    vtkNew<vtkMatrix4x4> sliceToLocal;
+    vtkMatrix4x4::Multiply4x4(worldToLocal.GetPointer(), sliceNodes[sliceIndex]->GetSliceToRAS(), sliceToLocal.GetPointer());
+    int planeDirection = (sliceClipStates[sliceIndex] == vtkMRMLClipModelsNode::ClipNegativeSpace) ? -1 : 1;
+    double normal[3] = { 0.0, 0.0, 0.0 };
+    double origin[3] = { 0.0, 0.0, 0.0 };
+    for (int i = 0; i < 3; i++)
+    {
+      normal[i] = planeDirection * sliceToLocal->GetElement(i, 2);
+      origin[i] = sliceToLocal->GetElement(i, 3);
+    }
+    // the clipper is only modified if the plane is changed
+    clipper->SetPlane(planeIndex, origin, normal);
+  }
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLModelDisplayableManager::OnInteractorStyleEvent(int eventid)
 {
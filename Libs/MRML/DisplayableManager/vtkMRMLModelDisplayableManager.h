@@ -26,6 +26,7 @@ class vtkMRMLTransformNode;
 class vtkActor;
 class vtkAlgorithm;
 class vtkCellPicker;
+class vtkIncrementalPlaneClipPolyData;
 class vtkLookupTable;
 class vtkMatrix4x4;
 class vtkPlane;
@@ -55,9 +56,13 @@ public:
   void SetClipModelsNode(vtkMRMLClipModelsNode *snode);
 
   /// Return the current model actor corresponding to a give MRML ID
+  /// Returns nullptr for display nodes that are rendered in a shared batch actor.
+  /// \sa SetBatchedRendering()
   vtkProp3D *GetActorByID(const char *id);
 
   /// Return the current node ID corresponding to a given vtkProp3D
+  /// Returns nullptr for batch actors, as they render models of multiple display nodes.
+  /// \sa SetBatchedRendering()
   const char *GetIDByActor(vtkProp3D *actor);
 
   /// Get world point picker
@@ -118,6 +123,23 @@ public:
   ///   False otherwise.
   static bool IsCellScalarsActive(vtkMRMLDisplayNode* displayNode, vtkMRMLModelNode* model = nullptr);
 
+  /// Render models that have compatible display properties in shared batches.
+  /// Model display nodes that have no scalar coloring, no texture, no clipping and no
+  /// non-linear transform are merged into one actor per combination of shared display
+  /// properties (representation, lighting, material, parent transform, ...). The actor uses a
+  /// composite mapper with per-model color, opacity and visibility, which greatly reduces
+  /// pipeline setup and rendering time of scenes that contain thousands of small models.
+  /// Picking still resolves to the display node of the picked model.
+  /// Backface color offset is not applied on batched models.
+  /// Batched models have no actor of their own, so GetActorByID() returns nullptr for them.
+  /// Disabled by default.
+  void SetBatchedRendering(bool batched);
+  bool GetBatchedRendering();
+  vtkBooleanMacro(BatchedRendering, bool);
+
+  /// Return the number of actors that are used for rendering batched models.
+  int GetNumberOfModelBatches();
+
 protected:
   int ActiveInteractionModes() override;
 
@@ -161,6 +183,10 @@ protected:
   int UpdateClipSlicesFromMRML();
   vtkAlgorithm *CreateTransformedClipper(vtkMRMLTransformNode *tnode,
                                          vtkMRMLModelNode::MeshTypeHint type);
+  /// Set clip planes, operation, and clipping method of an incremental clipper from the
+  /// current slice clip state. Planes are transformed to the local coordinate system of
+  /// the model if the model is under a linear transform.
+  void UpdateIncrementalClipper(vtkIncrementalPlaneClipPolyData* clipper, vtkMRMLTransformNode* tnode);
 
   void RemoveDisplayedID(std::string &id);
 
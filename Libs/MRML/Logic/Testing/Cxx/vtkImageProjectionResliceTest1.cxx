@@ -0,0 +1,318 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkImageProjectionReslice.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkImageReslice.h>
+#include <vtkImageStencilData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkTransform.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+
+const int VolumeSize = 64;
+
+//----------------------------------------------------------------------------
+// Constant background with a few noisy bright and dark spheres
+void CreateVolume(vtkImageData* volume)
+{
+  volume->SetDimensions(VolumeSize, VolumeSize, VolumeSize);
+  volume->AllocateScalars(VTK_SHORT, 1);
+  short* scalars = static_cast<short*>(volume->GetScalarPointer());
+  std::fill(scalars, scalars + VolumeSize * VolumeSize * VolumeSize, static_cast<short>(-1000));
+
+  struct Sphere
+  {
+    double Center[3];
+    double Radius;
+    int Value;
+  };
+  const Sphere spheres[] =
+  {
+    { { 20.0, 24.0, 30.0 }, 8.0, 300 },
+    { { 40.0, 40.0, 36.0 }, 10.0, 1200 },
+    { { 34.0, 22.0, 44.0 }, 6.0, -2000 },
+  };
+  std::minstd_rand randomGenerator(1);
+  std::uniform_int_distribution<int> noise(-50, 50);
+  for (int z = 0; z < VolumeSize; ++z)
+  {
+    for (int y = 0; y < VolumeSize; ++y)
+    {
+      for (int x = 0; x < VolumeSize; ++x)
+      {
+        for (const Sphere& sphere : spheres)
+        {
+          double dx = x - sphere.Center[0];
+          double dy = y - sphere.Center[1];
+          double dz = z - sphere.Center[2];
+          if (dx * dx + dy * dy + dz * dz <= sphere.Radius * sphere.Radius)
+          {
+            scalars[x + VolumeSize * (y + VolumeSize * z)] = static_cast<short>(sphere.Value + noise(randomGenerator));
+          }
+        }
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+// Oblique slab that is entirely inside the volume
+void SetupObliqueSlab(vtkImageReslice* reslice, vtkImageData* volume, int slabMode, int interpolationMode)
+{
+  vtkNew<vtkTransform> resliceAxes;
+  resliceAxes->Translate(32.0, 32.0, 32.0);
+  resliceAxes->RotateWXYZ(20.0, 1.0, 1.0, 0.0);
+  reslice->SetInputData(volume);
+  reslice->SetResliceAxes(resliceAxes->GetMatrix());
+  reslice->SetOutputDimensionality(2);
+  reslice->SetOutputSpacing(1.0, 1.0, 1.0);
+  reslice->SetOutputOrigin(0.0, 0.0, 0.0);
+  reslice->SetOutputExtent(-20, 20, -20, 20, 0, 0);
+  reslice->SetInterpolationMode(interpolationMode);
+  reslice->SetSlabMode(slabMode);
+  reslice->SetSlabNumberOfSlices(9);
+  reslice->SetSlabSliceSpacingFraction(0.5);
+  reslice->SetBackgroundLevel(-3000.0);
+}
+
+//----------------------------------------------------------------------------
+// Check that images are the same. Values may differ for a few pixels,
+// where sample positions are rounded differently.
+int CheckImagesEqual(vtkImageData* actual, vtkImageData* expected, double maximumMismatchFraction = 0.0)
+{
+  int actualExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  int expectedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  actual->GetExtent(actualExtent);
+  expected->GetExtent(expectedExtent);
+  for (int i = 0; i < 6; ++i)
+  {
+    CHECK_INT(actualExtent[i], expectedExtent[i]);
+  }
+  CHECK_INT(actual->GetScalarType(), expected->GetScalarType());
+  vtkDataArray* actualScalars = actual->GetPointData()->GetScalars();
+  vtkDataArray* expectedScalars = expected->GetPointData()->GetScalars();
+  vtkIdType numberOfMismatches = 0;
+  for (vtkIdType pointId = 0; pointId < actual->GetNumberOfPoints(); ++pointId)
+  {
+    if (std::abs(actualScalars->GetTuple1(pointId) - expectedScalars->GetTuple1(pointId)) > 1.0)
+    {
+      numberOfMismatches++;
+    }
+  }
+  if (numberOfMismatches > maximumMismatchFraction * actual->GetNumberOfPoints())
+  {
+    std::cerr << "Line " << __LINE__ << ": " << numberOfMismatches << " of "
+      << actual->GetNumberOfPoints() << " pixels are different" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// Slab reconstruction must give the same result as vtkImageReslice
+int TestSlabReconstruction(vtkImageData* volume)
+{
+  const int slabModes[] = { VTK_IMAGE_SLAB_MAX, VTK_IMAGE_SLAB_MIN, VTK_IMAGE_SLAB_MEAN };
+  const int interpolationModes[] = { VTK_NEAREST_INTERPOLATION, VTK_LINEAR_INTERPOLATION };
+  for (int slabMode : slabModes)
+  {
+    for (int interpolationMode : interpolationModes)
+    {
+      vtkNew<vtkImageReslice> reslice;
+      SetupObliqueSlab(reslice, volume, slabMode, interpolationMode);
+      reslice->Update();
+
+      vtkNew<vtkImageProjectionReslice> projection;
+      SetupObliqueSlab(projection, volume, slabMode, interpolationMode);
+      projection->SetBrickSize(8);
+      projection->GenerateStencilOutputOn();
+      projection->Update();
+
+      // Fast projection was used
+      CHECK_BOOL(projection->GetNumberOfInterpolatedSamples() > 0, true);
+      CHECK_BOOL(projection->GetNumberOfInterpolatedSamples() <= 41 * 41 * 9, true);
+      CHECK_INT(projection->GetNumberOfBrickIndexComputations(), 1);
+      CHECK_EXIT_SUCCESS(CheckImagesEqual(projection->GetOutput(), reslice->GetOutput(), 0.01));
+
+      // All pixels are inside the volume
+      vtkImageStencilData* stencil = projection->GetStencilOutput();
+      for (int y = -20; y <= 20; ++y)
+      {
+        for (int x = -20; x <= 20; ++x)
+        {
+          CHECK_BOOL(stencil->IsInside(x, y, 0) != 0, true);
+        }
+      }
+    }
+  }
+
+  // Unsupported settings are computed by vtkImageReslice
+  vtkNew<vtkImageReslice> reslice;
+  SetupObliqueSlab(reslice, volume, VTK_IMAGE_SLAB_MAX, VTK_CUBIC_INTERPOLATION);
+  reslice->Update();
+  vtkNew<vtkImageProjectionReslice> projection;
+  SetupObliqueSlab(projection, volume, VTK_IMAGE_SLAB_MAX, VTK_CUBIC_INTERPOLATION);
+  projection->Update();
+  CHECK_INT(projection->GetNumberOfInterpolatedSamples(), 0);
+  CHECK_EXIT_SUCCESS(CheckImagesEqual(projection->GetOutput(), reslice->GetOutput()));
+
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// Projection through the whole volume along the z axis
+int TestProjectThroughInput(vtkImageData* volume)
+{
+  vtkNew<vtkImageProjectionReslice> projection;
+  projection->SetInputData(volume);
+  projection->SetOutputDimensionality(2);
+  projection->SetOutputSpacing(1.0, 1.0, 1.0);
+  projection->SetOutputOrigin(0.0, 0.0, 0.0);
+  projection->SetOutputExtent(0, VolumeSize - 1, 0, VolumeSize - 1, 0, 0);
+  projection->SetInterpolationModeToNearestNeighbor();
+  projection->ProjectThroughInputOn();
+  projection->SetBrickSize(8);
+
+  const int slabModes[] = { VTK_IMAGE_SLAB_MAX, VTK_IMAGE_SLAB_MIN, VTK_IMAGE_SLAB_MEAN };
+  for (int slabMode : slabModes)
+  {
+    projection->SetSlabMode(slabMode);
+    projection->EmptySpaceSkippingOn();
+    projection->Update();
+    vtkIdType numberOfSamplesWithSkipping = projection->GetNumberOfInterpolatedSamples();
+
+    // Compare to projection computed along the columns of the volume
+    vtkImageData* output = projection->GetOutput();
+    const short* scalars = static_cast<const short*>(volume->GetScalarPointer());
+    for (int y = 0; y < VolumeSize; ++y)
+    {
+      for (int x = 0; x < VolumeSize; ++x)
+      {
+        double expected = (slabMode == VTK_IMAGE_SLAB_MIN) ? VTK_SHORT_MAX : (slabMode == VTK_IMAGE_SLAB_MAX ? VTK_SHORT_MIN : 0.0);
+        for (int z = 0; z < VolumeSize; ++z)
+        {
+          double value = scalars[x + VolumeSize * (y + VolumeSize * z)];
+          if (slabMode == VTK_IMAGE_SLAB_MAX)
+          {
+            expected = std::max(expected, value);
+          }
+          else if (slabMode == VTK_IMAGE_SLAB_MIN)
+          {
+            expected = std::min(expected, value);
+          }
+          else
+          {
+            expected += value;
+          }
+        }
+        if (slabMode == VTK_IMAGE_SLAB_MEAN)
+        {
+          expected = std::floor(expected / VolumeSize + 0.5);
+        }
+        CHECK_DOUBLE_TOLERANCE(output->GetScalarComponentAsDouble(x, y, 0, 0), expected, 1e-6);
+      }
+    }
+
+    // Same result without empty space skipping, but more samples are needed
+    vtkNew<vtkImageData> outputWithSkipping;
+    outputWithSkipping->DeepCopy(output);
+    projection->EmptySpaceSkippingOff();
+    projection->Update();
+    CHECK_EXIT_SUCCESS(CheckImagesEqual(projection->GetOutput(), outputWithSkipping));
+    CHECK_INT(projection->GetNumberOfInterpolatedSamples(), VolumeSize * VolumeSize * VolumeSize);
+    CHECK_BOOL(numberOfSamplesWithSkipping < VolumeSize * VolumeSize * VolumeSize, true);
+  }
+
+  // The brick index is only computed again if the input is modified
+  CHECK_INT(projection->GetNumberOfBrickIndexComputations(), 1);
+  projection->EmptySpaceSkippingOn();
+  volume->Modified();
+  projection->Update();
+  CHECK_INT(projection->GetNumberOfBrickIndexComputations(), 2);
+
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// Projection through the whole volume from an oblique view direction
+int TestObliqueProjection(vtkImageData* volume)
+{
+  vtkNew<vtkTransform> viewDirection;
+  viewDirection->Translate(32.0, 32.0, 32.0);
+  viewDirection->RotateWXYZ(35.0, 1.0, 0.5, 0.2);
+
+  vtkNew<vtkImageProjectionReslice> projection;
+  projection->SetInputData(volume);
+  projection->SetResliceAxes(viewDirection->GetMatrix());
+  projection->SetOutputDimensionality(2);
+  projection->AutoCropOutputOn();
+  projection->SetInterpolationModeToLinear();
+  projection->SetSlabSliceSpacingFraction(0.5);
+  projection->ProjectThroughInputOn();
+  projection->GenerateStencilOutputOn();
+
+  const int slabModes[] = { VTK_IMAGE_SLAB_MAX, VTK_IMAGE_SLAB_MIN, VTK_IMAGE_SLAB_MEAN };
+  for (int slabMode : slabModes)
+  {
+    projection->SetSlabMode(slabMode);
+    projection->EmptySpaceSkippingOn();
+    projection->Update();
+    vtkIdType numberOfSamplesWithSkipping = projection->GetNumberOfInterpolatedSamples();
+    vtkNew<vtkImageData> outputWithSkipping;
+    outputWithSkipping->DeepCopy(projection->GetOutput());
+
+    projection->EmptySpaceSkippingOff();
+    projection->Update();
+    CHECK_EXIT_SUCCESS(CheckImagesEqual(projection->GetOutput(), outputWithSkipping));
+    CHECK_BOOL(numberOfSamplesWithSkipping < projection->GetNumberOfInterpolatedSamples(), true);
+  }
+
+  // Output corners are outside of the volume
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  projection->GetOutput()->GetExtent(extent);
+  vtkImageStencilData* stencil = projection->GetStencilOutput();
+  CHECK_BOOL(stencil->IsInside(extent[0], extent[2], extent[4]) != 0, false);
+  CHECK_BOOL(stencil->IsInside((extent[0] + extent[1]) / 2, (extent[2] + extent[3]) / 2, extent[4]) != 0, true);
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImageProjectionResliceTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkImageData> volume;
+  CreateVolume(volume);
+
+  CHECK_EXIT_SUCCESS(TestSlabReconstruction(volume));
+  CHECK_EXIT_SUCCESS(TestProjectThroughInput(volume));
+  CHECK_EXIT_SUCCESS(TestObliqueProjection(volume));
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,193 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkIncrementalPlaneClipPolyData.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkClipPolyData.h>
+#include <vtkExtractPolyDataGeometry.h>
+#include <vtkImplicitBoolean.h>
+#include <vtkMassProperties.h>
+#include <vtkNew.h>
+#include <vtkPlane.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+#include <vtkTimerLog.h>
+#include <vtkTriangleFilter.h>
+
+// STD includes
+#include <cmath>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+double GetSurfaceArea(vtkPolyData* polyData)
+{
+  vtkNew<vtkTriangleFilter> triangleFilter;
+  triangleFilter->SetInputData(polyData);
+  vtkNew<vtkMassProperties> massProperties;
+  massProperties->SetInputConnection(triangleFilter->GetOutputPort());
+  massProperties->Update();
+  return massProperties->GetSurfaceArea();
+}
+
+//----------------------------------------------------------------------------
+// Compare incremental clipping result with clipping the whole mesh using VTK filters
+int CheckClipResult(vtkPolyData* input, vtkIncrementalPlaneClipPolyData* incrementalClipper)
+{
+  vtkNew<vtkImplicitBoolean> clipFunction;
+  clipFunction->SetOperationType(incrementalClipper->GetOperationType()
+    == vtkIncrementalPlaneClipPolyData::OperationUnion ? 0 : 1);
+  for (int planeIndex = 0; planeIndex < incrementalClipper->GetNumberOfPlanes(); ++planeIndex)
+  {
+    double origin[3] = { 0.0, 0.0, 0.0 };
+    double normal[3] = { 0.0, 0.0, 1.0 };
+    incrementalClipper->GetPlane(planeIndex, origin, normal);
+    vtkNew<vtkPlane> plane;
+    plane->SetOrigin(origin);
+    plane->SetNormal(normal);
+    clipFunction->AddFunction(plane);
+  }
+
+  vtkSmartPointer<vtkPolyData> expected;
+  if (incrementalClipper->GetClipMethod() == vtkIncrementalPlaneClipPolyData::ClipStraight)
+  {
+    vtkNew<vtkClipPolyData> clipper;
+    clipper->SetInputData(input);
+    clipper->SetClipFunction(clipFunction);
+    clipper->SetValue(0.0);
+    clipper->Update();
+    expected = clipper->GetOutput();
+  }
+  else
+  {
+    vtkNew<vtkExtractPolyDataGeometry> extractor;
+    extractor->SetInputData(input);
+    extractor->SetImplicitFunction(clipFunction);
+    extractor->ExtractInsideOff();
+    extractor->SetExtractBoundaryCells(
+      incrementalClipper->GetClipMethod() == vtkIncrementalPlaneClipPolyData::ClipWholeCellsWithBoundary);
+    extractor->Update();
+    expected = extractor->GetOutput();
+  }
+
+  incrementalClipper->Update();
+  vtkPolyData* output = incrementalClipper->GetOutput();
+  CHECK_INT(output->GetNumberOfCells(), expected->GetNumberOfCells());
+  double expectedArea = GetSurfaceArea(expected);
+  CHECK_DOUBLE_TOLERANCE(GetSurfaceArea(output), expectedArea, 1e-6 * expectedArea);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkIncrementalPlaneClipPolyDataTest1(int , char * [] )
+{
+  vtkNew<vtkSphereSource> sphereSource;
+  sphereSource->SetRadius(50.0);
+  sphereSource->SetThetaResolution(400);
+  sphereSource->SetPhiResolution(400);
+  sphereSource->Update();
+  vtkPolyData* sphere = sphereSource->GetOutput();
+
+  vtkNew<vtkIncrementalPlaneClipPolyData> incrementalClipper;
+  incrementalClipper->SetInputData(sphere);
+
+  // No planes: input is passed through
+  incrementalClipper->Update();
+  CHECK_INT(incrementalClipper->GetOutput()->GetNumberOfCells(), sphere->GetNumberOfCells());
+
+  // Moving a plane along its normal reuses cell ranges and only clips intersected cells
+  incrementalClipper->SetNumberOfPlanes(1);
+  double normal[3] = { 0.0, 0.0, 1.0 };
+  for (int step = 0; step < 5; ++step)
+  {
+    double origin[3] = { 0.0, 0.0, -40.0 + step * 20.0 };
+    incrementalClipper->SetPlane(0, origin, normal);
+    CHECK_EXIT_SUCCESS(CheckClipResult(sphere, incrementalClipper));
+    CHECK_BOOL(incrementalClipper->GetNumberOfIntersectedCells() < sphere->GetNumberOfCells() / 20, true);
+  }
+  CHECK_INT(incrementalClipper->GetNumberOfCellRangeComputations(), 1);
+
+  // Setting the same plane does not modify the filter
+  vtkMTimeType mtime = incrementalClipper->GetMTime();
+  double origin[3] = { 0.0, 0.0, 40.0 };
+  incrementalClipper->SetPlane(0, origin, normal);
+  CHECK_INT(static_cast<int>(incrementalClipper->GetMTime() - mtime), 0);
+
+  // Rotating the plane requires new cell ranges
+  double obliqueNormal[3] = { 0.0, 1.0 / sqrt(2.0), 1.0 / sqrt(2.0) };
+  double obliqueOrigin[3] = { 0.0, 10.0, 5.0 };
+  incrementalClipper->SetPlane(0, obliqueOrigin, obliqueNormal);
+  CHECK_EXIT_SUCCESS(CheckClipResult(sphere, incrementalClipper));
+  CHECK_INT(incrementalClipper->GetNumberOfCellRangeComputations(), 2);
+
+  // Three planes, all operations and clip methods
+  incrementalClipper->SetNumberOfPlanes(3);
+  double origins[3][3] = { { 0.0, 0.0, 10.0 }, { 0.0, -5.0, 0.0 }, { 20.0, 0.0, 0.0 } };
+  double normals[3][3] = { { 0.0, 0.0, 1.0 }, { 0.0, -1.0, 0.0 }, { 1.0, 0.0, 0.0 } };
+  for (int planeIndex = 0; planeIndex < 3; ++planeIndex)
+  {
+    incrementalClipper->SetPlane(planeIndex, origins[planeIndex], normals[planeIndex]);
+  }
+  for (int operation = vtkIncrementalPlaneClipPolyData::OperationUnion;
+    operation <= vtkIncrementalPlaneClipPolyData::OperationIntersection; ++operation)
+  {
+    incrementalClipper->SetOperationType(operation);
+    for (int clipMethod = vtkIncrementalPlaneClipPolyData::ClipStraight;
+      clipMethod <= vtkIncrementalPlaneClipPolyData::ClipWholeCellsWithBoundary; ++clipMethod)
+    {
+      incrementalClipper->SetClipMethod(clipMethod);
+      CHECK_EXIT_SUCCESS(CheckClipResult(sphere, incrementalClipper));
+    }
+  }
+
+  // Timing of moving a plane, compared to clipping the whole mesh
+  incrementalClipper->SetNumberOfPlanes(1);
+  incrementalClipper->SetOperationTypeToIntersection();
+  incrementalClipper->SetClipMethod(vtkIncrementalPlaneClipPolyData::ClipStraight);
+  vtkNew<vtkPlane> plane;
+  plane->SetNormal(normal);
+  vtkNew<vtkClipPolyData> clipper;
+  clipper->SetInputData(sphere);
+  clipper->SetClipFunction(plane);
+  const int numberOfSteps = 20;
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (int step = 0; step < numberOfSteps; ++step)
+  {
+    double stepOrigin[3] = { 0.0, 0.0, -45.0 + step * 90.0 / numberOfSteps };
+    plane->SetOrigin(stepOrigin);
+    clipper->Update();
+  }
+  timer->StopTimer();
+  double clipTime = timer->GetElapsedTime();
+  timer->StartTimer();
+  for (int step = 0; step < numberOfSteps; ++step)
+  {
+    double stepOrigin[3] = { 0.0, 0.0, -45.0 + step * 90.0 / numberOfSteps };
+    incrementalClipper->SetPlane(0, stepOrigin, normal);
+    incrementalClipper->Update();
+  }
+  timer->StopTimer();
+  double incrementalClipTime = timer->GetElapsedTime();
+  std::cout << "Moving clip plane " << numberOfSteps << " times on " << sphere->GetNumberOfCells()
+    << " cells: vtkClipPolyData " << clipTime << "s, incremental " << incrementalClipTime << "s" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -35,6 +35,7 @@
 #include <vtkTimerLog.h>
 
 // STD includes
+#include <thread>
 
 #include "vtkMRMLCoreTestingMacros.h"
 
@@ -44,6 +45,7 @@ namespace
 bool TestPerformance();
 bool TestNodeIDs();
 bool TestDefaults();
+int TestLazyDefaultColorNodes();
 bool TestCopy();
 bool TestProceduralCopy();
 }
@@ -55,6 +57,7 @@ int vtkMRMLColorLogicTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv)[] )
   res = TestPerformance() && res;
   res = TestNodeIDs() && res;
   res = TestDefaults() && res;
+  res = (TestLazyDefaultColorNodes() == EXIT_SUCCESS) && res;
   res = TestCopy() && res;
   res = TestProceduralCopy() && res;
   return res ? EXIT_SUCCESS : EXIT_FAILURE;
@@ -192,6 +195,63 @@ bool TestDefaults()
   return true;
 }
 
+//----------------------------------------------------------------------------
+int TestLazyDefaultColorNodes()
+{
+  vtkNew<vtkMRMLScene> eagerScene;
+  vtkNew<vtkMRMLColorLogic> eagerColorLogic;
+  eagerColorLogic->SetMRMLScene(eagerScene.GetPointer());
+  int eagerNumberOfNodes = eagerScene->GetNumberOfNodesByClass("vtkMRMLColorNode");
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLColorLogic> colorLogic;
+  colorLogic->LazyDefaultColorNodesOn();
+  colorLogic->SetMRMLScene(scene.GetPointer());
+
+  // Default nodes must be available immediately
+  CHECK_NOT_NULL(scene->GetNodeByID(colorLogic->GetDefaultVolumeColorNodeID()));
+  CHECK_NOT_NULL(scene->GetNodeByID(colorLogic->GetDefaultLabelMapColorNodeID()));
+  CHECK_NOT_NULL(scene->GetNodeByID(colorLogic->GetDefaultModelColorNodeID()));
+  CHECK_NOT_NULL(scene->GetNodeByID(vtkMRMLColorLogic::GetColorTableNodeID(vtkMRMLColorTableNode::Labels)));
+
+  // Other nodes are only created on request
+  std::string ironNodeID = vtkMRMLColorLogic::GetColorTableNodeID(vtkMRMLColorTableNode::Iron);
+  CHECK_NULL(scene->GetNodeByID(ironNodeID));
+  CHECK_BOOL(colorLogic->IsDefaultColorNodePending(ironNodeID.c_str()), true);
+
+  // Nodes are not created from other threads
+  vtkMRMLColorNode* nodeCreatedInThread = nullptr;
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  std::thread requestThread([&]() { nodeCreatedInThread = colorLogic->MaterializeDefaultColorNode(ironNodeID.c_str()); });
+  requestThread.join();
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+  CHECK_NULL(nodeCreatedInThread);
+  CHECK_NULL(scene->GetNodeByID(ironNodeID));
+  CHECK_BOOL(colorLogic->IsDefaultColorNodePending(ironNodeID.c_str()), true);
+
+  vtkMRMLColorNode* ironNode = colorLogic->MaterializeDefaultColorNode(ironNodeID.c_str());
+  CHECK_NOT_NULL(ironNode);
+  CHECK_STRING(ironNode->GetID(), ironNodeID.c_str());
+  CHECK_POINTER(scene->GetNodeByID(ironNodeID), ironNode);
+  CHECK_BOOL(colorLogic->IsDefaultColorNodePending(ironNodeID.c_str()), false);
+  // Requesting it again returns the same node
+  CHECK_POINTER(colorLogic->MaterializeDefaultColorNode(ironNodeID.c_str()), ironNode);
+  CHECK_NULL(colorLogic->MaterializeDefaultColorNode("vtkMRMLColorTableNodeInvalid"));
+
+  CHECK_BOOL(colorLogic->GetNumberOfPendingDefaultColorNodes() > 0, true);
+  colorLogic->MaterializeDefaultColorNodes();
+  CHECK_INT(colorLogic->GetNumberOfPendingDefaultColorNodes(), 0);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLColorNode"), eagerNumberOfNodes);
+
+  // Pending nodes are registered again when the default nodes are re-added
+  scene->Clear(1);
+  colorLogic->AddDefaultColorNodes();
+  CHECK_BOOL(colorLogic->GetNumberOfPendingDefaultColorNodes() > 0, true);
+  CHECK_NOT_NULL(scene->GetNodeByID(colorLogic->GetDefaultVolumeColorNodeID()));
+
+  return EXIT_SUCCESS;
+}
+
 //----------------------------------------------------------------------------
 bool TestCopy()
 {
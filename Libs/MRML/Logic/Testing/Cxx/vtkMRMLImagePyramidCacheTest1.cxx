@@ -0,0 +1,141 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkMRMLImagePyramidCache.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <cmath>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void FillRamp(vtkImageData* image, int dimX, int dimY, int dimZ)
+{
+  image->SetDimensions(dimX, dimY, dimZ);
+  image->AllocateScalars(VTK_SHORT, 1);
+  short* voxels = static_cast<short*>(image->GetScalarPointer());
+  for (int z = 0; z < dimZ; ++z)
+  {
+    for (int y = 0; y < dimY; ++y)
+    {
+      for (int x = 0; x < dimX; ++x)
+      {
+        *(voxels++) = static_cast<short>(x);
+      }
+    }
+  }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLImagePyramidCacheTest1(int , char * [] )
+{
+  vtkMRMLImagePyramidCache* cache = vtkMRMLImagePyramidCache::GetInstance();
+  CHECK_NOT_NULL(cache);
+  cache->RemoveAllImages();
+  cache->SetMinimumLevelSize(16);
+
+  CHECK_INT(vtkMRMLImagePyramidCache::GetLevelForSamplingStep(0.5), 0);
+  CHECK_INT(vtkMRMLImagePyramidCache::GetLevelForSamplingStep(1.9), 0);
+  CHECK_INT(vtkMRMLImagePyramidCache::GetLevelForSamplingStep(2.0), 1);
+  CHECK_INT(vtkMRMLImagePyramidCache::GetLevelForSamplingStep(5.0), 2);
+
+  // Invalid input
+  int level = -1;
+  CHECK_NULL(cache->GetLevel(nullptr, 2, level));
+  CHECK_INT(level, 0);
+  vtkNew<vtkImageData> emptyImage;
+  CHECK_POINTER(cache->GetLevel(emptyImage, 2, level), emptyImage.GetPointer());
+  CHECK_INT(level, 0);
+
+  // Levels are not reduced below MinimumLevelSize and single-voxel axes are kept
+  vtkNew<vtkImageData> image;
+  FillRamp(image, 64, 32, 1);
+  image->SetSpacing(0.5, 0.5, 2.0);
+  image->SetOrigin(10.0, 20.0, 30.0);
+  CHECK_INT(cache->GetMaximumNumberOfLevels(image), 3);
+
+  // Synchronous computation
+  CHECK_INT(cache->BuildLevels(image, 5), 3);
+  CHECK_INT(cache->GetNumberOfAvailableLevels(image), 3);
+  CHECK_INT(cache->GetNumberOfCachedImages(), 1);
+  double expectedMemorySizeMB = (32 * 16 + 16 * 8) * sizeof(short) / (1024.0 * 1024.0);
+  CHECK_DOUBLE_TOLERANCE(cache->GetMemorySizeMB(), expectedMemorySizeMB, 1e-9);
+
+  vtkImageData* level1 = cache->GetLevel(image, 1, level);
+  CHECK_INT(level, 1);
+  CHECK_NOT_NULL(level1);
+  int* dims = level1->GetDimensions();
+  CHECK_INT(dims[0], 32);
+  CHECK_INT(dims[1], 16);
+  CHECK_INT(dims[2], 1);
+  CHECK_DOUBLE_TOLERANCE(level1->GetSpacing()[0], 1.0, 1e-9);
+  CHECK_DOUBLE_TOLERANCE(level1->GetSpacing()[2], 2.0, 1e-9);
+  // Center of the first voxel is the center of the averaged 2x2 block
+  CHECK_DOUBLE_TOLERANCE(level1->GetOrigin()[0], 10.25, 1e-9);
+  CHECK_DOUBLE_TOLERANCE(level1->GetOrigin()[1], 20.25, 1e-9);
+  CHECK_DOUBLE_TOLERANCE(level1->GetOrigin()[2], 30.0, 1e-9);
+  // Average of 2*x and 2*x+1 is rounded to 2*x+1
+  CHECK_DOUBLE_TOLERANCE(level1->GetScalarComponentAsDouble(5, 3, 0, 0), 11.0, 1e-9);
+
+  vtkImageData* level2 = cache->GetLevel(image, 2, level);
+  CHECK_INT(level, 2);
+  CHECK_INT(level2->GetDimensions()[0], 16);
+  // Average of 4*x ... 4*x+3 is 4*x+1.5, which is computed from the rounded level 1 values
+  CHECK_DOUBLE_TOLERANCE(level2->GetScalarComponentAsDouble(5, 3, 0, 0), 22.0, 1e-9);
+
+  // Requesting a higher level than available returns the coarsest level
+  CHECK_POINTER(cache->GetLevel(image, 10, level), level2);
+  CHECK_INT(level, 2);
+
+  // Levels are discarded when the image is modified and computed again in the background
+  image->Modified();
+  CHECK_INT(cache->GetNumberOfAvailableLevels(image), 1);
+  CHECK_POINTER(cache->GetLevel(image, 2, level), image.GetPointer());
+  CHECK_INT(level, 0);
+  cache->WaitForBackgroundComputation();
+  CHECK_INT(cache->GetNumberOfAvailableLevels(image), 3);
+  cache->GetLevel(image, 2, level);
+  CHECK_INT(level, 2);
+
+  // Memory limit
+  vtkNew<vtkImageData> image2;
+  FillRamp(image2, 64, 64, 64);
+  cache->SetMaximumMemorySizeMB(32 * 32 * 32 * sizeof(short) / (1024.0 * 1024.0));
+  CHECK_INT(cache->BuildLevels(image2, 1), 2);
+  // Least recently used pyramid is released to make room for the new levels
+  CHECK_INT(cache->GetNumberOfAvailableLevels(image), 1);
+  CHECK_INT(cache->GetNumberOfCachedImages(), 1);
+  // Next level does not fit
+  CHECK_INT(cache->BuildLevels(image2, 2), 2);
+  CHECK_BOOL(cache->GetMemorySizeMB() <= cache->GetMaximumMemorySizeMB(), true);
+
+  cache->RemoveImage(image2);
+  CHECK_INT(cache->GetNumberOfCachedImages(), 0);
+  CHECK_DOUBLE_TOLERANCE(cache->GetMemorySizeMB(), 0.0, 1e-9);
+
+  cache->SetMaximumMemorySizeMB(1024.0);
+  cache->SetMinimumLevelSize(64);
+  cache->RemoveAllImages();
+
+  return EXIT_SUCCESS;
+}
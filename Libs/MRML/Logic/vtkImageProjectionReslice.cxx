@@ -0,0 +1,702 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkImageProjectionReslice.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkImageInterpolator.h>
+#include <vtkImageStencilData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkMatrix4x4.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkSMPTools.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+vtkStandardNewMacro(vtkImageProjectionReslice);
+
+namespace
+{
+
+// Output pixels are processed in tiles of TileSize x TileSize pixels
+const int TileSize = 16;
+
+//----------------------------------------------------------------------------
+/// Minimum and maximum value of each brick of the input.
+/// Brick b along an axis contains voxels b*Size..(b+1)*Size (inclusive), so that all voxels
+/// that are used for interpolating a sample in the brick are taken into account.
+struct BrickIndex
+{
+  /// Recompute the index if the image changed since it was last computed.
+  /// Returns true if the index was computed.
+  bool Update(vtkImageData* image, int brickSize);
+
+  /// Returns true if the index is up-to-date for the image.
+  bool IsValid(vtkImageData* image, int brickSize) const;
+
+  /// Get the ID of the brick that contains a point (in input structured coordinates).
+  vtkIdType GetBrickId(const double point[3], int brick[3]) const
+  {
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      int brickIndex = static_cast<int>(std::floor((point[axis] - this->Extent[2 * axis]) / this->Size));
+      brick[axis] = std::min(std::max(brickIndex, 0), this->NumberOfBricks[axis] - 1);
+    }
+    return brick[0] + static_cast<vtkIdType>(this->NumberOfBricks[0]) * (brick[1] + static_cast<vtkIdType>(this->NumberOfBricks[1]) * brick[2]);
+  }
+
+  /// Get the index of the first sample of the ray after sample k that is not in the brick.
+  /// The returned value is clamped to lastSample + 1.
+  long long GetExitSample(const int brick[3], const double rayStart[3], const double sampleStep[3],
+    long long k, long long lastSample) const
+  {
+    double exitSample = static_cast<double>(lastSample + 1);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      if (sampleStep[axis] > 0.0 && brick[axis] < this->NumberOfBricks[axis] - 1)
+      {
+        double boundary = this->Extent[2 * axis] + (brick[axis] + 1) * this->Size;
+        exitSample = std::min(exitSample, std::ceil((boundary - rayStart[axis]) / sampleStep[axis]));
+      }
+      else if (sampleStep[axis] < 0.0 && brick[axis] > 0)
+      {
+        double boundary = this->Extent[2 * axis] + brick[axis] * this->Size;
+        exitSample = std::min(exitSample, std::floor((boundary - rayStart[axis]) / sampleStep[axis]) + 1.0);
+      }
+    }
+    return std::max(static_cast<long long>(exitSample), k + 1);
+  }
+
+  std::vector<double> Minimum;
+  std::vector<double> Maximum;
+  int NumberOfBricks[3] = { 0, 0, 0 };
+  int Extent[6] = { 0, -1, 0, -1, 0, -1 };
+  int Size = 0;
+  double ScalarRange[2] = { 0.0, 0.0 };
+  const void* ScalarPointer = nullptr;
+  vtkTimeStamp ComputeTime;
+};
+
+//----------------------------------------------------------------------------
+vtkDataArray* GetProjectionScalars(vtkImageData* image)
+{
+  if (!image)
+  {
+    return nullptr;
+  }
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  if (!scalars || scalars->GetNumberOfComponents() != 1 || scalars->GetNumberOfTuples() == 0)
+  {
+    return nullptr;
+  }
+  return scalars;
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void ComputeBrickRanges(const T* scalars, const int extent[6], const vtkIdType increments[3],
+  int brickSize, const int numberOfBricks[3], double* minimum, double* maximum)
+{
+  vtkSMPTools::For(0, static_cast<vtkIdType>(numberOfBricks[1]) * numberOfBricks[2],
+    [&](vtkIdType beginRow, vtkIdType endRow)
+  {
+    for (vtkIdType row = beginRow; row < endRow; ++row)
+    {
+      int brickY = static_cast<int>(row % numberOfBricks[1]);
+      int brickZ = static_cast<int>(row / numberOfBricks[1]);
+      int j0 = brickY * brickSize;
+      int j1 = std::min(j0 + brickSize, extent[3] - extent[2]);
+      int k0 = brickZ * brickSize;
+      int k1 = std::min(k0 + brickSize, extent[5] - extent[4]);
+      for (int brickX = 0; brickX < numberOfBricks[0]; ++brickX)
+      {
+        int i0 = brickX * brickSize;
+        int i1 = std::min(i0 + brickSize, extent[1] - extent[0]);
+        T brickMinimum = scalars[i0 * increments[0] + j0 * increments[1] + k0 * increments[2]];
+        T brickMaximum = brickMinimum;
+        for (int k = k0; k <= k1; ++k)
+        {
+          for (int j = j0; j <= j1; ++j)
+          {
+            const T* voxel = scalars + j * increments[1] + k * increments[2];
+            for (int i = i0; i <= i1; ++i)
+            {
+              T value = voxel[i * increments[0]];
+              brickMinimum = std::min(brickMinimum, value);
+              brickMaximum = std::max(brickMaximum, value);
+            }
+          }
+        }
+        vtkIdType brickId = brickX + static_cast<vtkIdType>(numberOfBricks[0]) * row;
+        minimum[brickId] = static_cast<double>(brickMinimum);
+        maximum[brickId] = static_cast<double>(brickMaximum);
+      }
+    }
+  });
+}
+
+//----------------------------------------------------------------------------
+bool BrickIndex::IsValid(vtkImageData* image, int brickSize) const
+{
+  vtkDataArray* scalars = GetProjectionScalars(image);
+  if (!scalars || this->Size != brickSize || this->ScalarPointer != scalars->GetVoidPointer(0))
+  {
+    return false;
+  }
+  const int* extent = image->GetExtent();
+  if (!std::equal(extent, extent + 6, this->Extent))
+  {
+    return false;
+  }
+  return this->ComputeTime > image->GetMTime() && this->ComputeTime > scalars->GetMTime();
+}
+
+//----------------------------------------------------------------------------
+bool BrickIndex::Update(vtkImageData* image, int brickSize)
+{
+  if (this->IsValid(image, brickSize))
+  {
+    return false;
+  }
+  vtkDataArray* scalars = GetProjectionScalars(image);
+  if (!scalars)
+  {
+    this->Size = 0;
+    this->ScalarPointer = nullptr;
+    return false;
+  }
+
+  image->GetExtent(this->Extent);
+  this->Size = brickSize;
+  vtkIdType numberOfBricks = 1;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    int dimension = this->Extent[2 * axis + 1] - this->Extent[2 * axis] + 1;
+    this->NumberOfBricks[axis] = std::max(1, (dimension - 1 + brickSize - 1) / brickSize);
+    numberOfBricks *= this->NumberOfBricks[axis];
+  }
+  this->Minimum.resize(numberOfBricks);
+  this->Maximum.resize(numberOfBricks);
+
+  vtkIdType increments[3] = { 0, 0, 0 };
+  image->GetIncrements(increments);
+  switch (scalars->GetDataType())
+  {
+    vtkTemplateMacro(ComputeBrickRanges<VTK_TT>(static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)),
+      this->Extent, increments, brickSize, this->NumberOfBricks, this->Minimum.data(), this->Maximum.data()));
+    default:
+      this->Size = 0;
+      this->ScalarPointer = nullptr;
+      return false;
+  }
+  this->ScalarRange[0] = *std::min_element(this->Minimum.begin(), this->Minimum.end());
+  this->ScalarRange[1] = *std::max_element(this->Maximum.begin(), this->Maximum.end());
+  this->ScalarPointer = scalars->GetVoidPointer(0);
+  this->ComputeTime.Modified();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Projection settings shared by all threads.
+/// Positions are in input structured coordinates.
+struct ProjectionParameters
+{
+  double Origin[3];
+  double XStep[3];
+  double YStep[3];
+  double ZStep[3];
+  double SampleStep[3];
+  /// Index of the first sample of the slab relative to the output point
+  double SampleOffset;
+  /// Number of samples in the slab (ignored if ProjectThroughInput is enabled)
+  long long NumberOfSamples;
+  bool ProjectThroughInput;
+  int SlabMode;
+  bool Linear;
+  bool EmptySpaceSkipping;
+  /// Input extent extended by the interpolator tolerance
+  double Bounds[6];
+  int InputExtent[6];
+  vtkIdType InputIncrements[3];
+  double Background;
+};
+
+//----------------------------------------------------------------------------
+template <class T>
+T ConvertValue(double value)
+{
+  if (std::is_integral<T>::value)
+  {
+    value = std::floor(value + 0.5);
+    value = std::min(std::max(value, static_cast<double>(std::numeric_limits<T>::lowest())),
+      static_cast<double>(std::numeric_limits<T>::max()));
+  }
+  return static_cast<T>(value);
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+double SampleNearest(const T* scalars, const ProjectionParameters& params, const double point[3])
+{
+  vtkIdType offset = 0;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    int index = static_cast<int>(std::floor(point[axis] + 0.5));
+    index = std::min(std::max(index, params.InputExtent[2 * axis]), params.InputExtent[2 * axis + 1]);
+    offset += (index - params.InputExtent[2 * axis]) * params.InputIncrements[axis];
+  }
+  return static_cast<double>(scalars[offset]);
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+double SampleLinear(const T* scalars, const ProjectionParameters& params, const double point[3])
+{
+  vtkIdType offset0[3];
+  vtkIdType offset1[3];
+  double fraction[3];
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    double floorPosition = std::floor(point[axis]);
+    int index0 = static_cast<int>(floorPosition);
+    int index1 = index0 + 1;
+    fraction[axis] = point[axis] - floorPosition;
+    if (index0 < params.InputExtent[2 * axis])
+    {
+      index0 = index1 = params.InputExtent[2 * axis];
+      fraction[axis] = 0.0;
+    }
+    else if (index0 >= params.InputExtent[2 * axis + 1])
+    {
+      index0 = index1 = params.InputExtent[2 * axis + 1];
+      fraction[axis] = 0.0;
+    }
+    offset0[axis] = (index0 - params.InputExtent[2 * axis]) * params.InputIncrements[axis];
+    offset1[axis] = (index1 - params.InputExtent[2 * axis]) * params.InputIncrements[axis];
+  }
+  const T* row00 = scalars + offset0[1] + offset0[2];
+  const T* row10 = scalars + offset1[1] + offset0[2];
+  const T* row01 = scalars + offset0[1] + offset1[2];
+  const T* row11 = scalars + offset1[1] + offset1[2];
+  double v00 = row00[offset0[0]] + fraction[0] * (static_cast<double>(row00[offset1[0]]) - row00[offset0[0]]);
+  double v10 = row10[offset0[0]] + fraction[0] * (static_cast<double>(row10[offset1[0]]) - row10[offset0[0]]);
+  double v01 = row01[offset0[0]] + fraction[0] * (static_cast<double>(row01[offset1[0]]) - row01[offset0[0]]);
+  double v11 = row11[offset0[0]] + fraction[0] * (static_cast<double>(row11[offset1[0]]) - row11[offset0[0]]);
+  double v0 = v00 + fraction[1] * (v10 - v00);
+  double v1 = v01 + fraction[1] * (v11 - v01);
+  return v0 + fraction[2] * (v1 - v0);
+}
+
+//----------------------------------------------------------------------------
+/// Cast a ray starting at rayStart (position of sample 0).
+/// Returns false if no sample of the ray is inside the input.
+template <class T, bool Linear>
+bool CastRay(const T* scalars, const ProjectionParameters& params, const BrickIndex& bricks,
+  const double rayStart[3], double& result, vtkIdType& numberOfSamples)
+{
+  // Clip the ray to the input bounds
+  double firstSampleBound = params.ProjectThroughInput ? -std::numeric_limits<double>::infinity() : 0.0;
+  double lastSampleBound = params.ProjectThroughInput ?
+    std::numeric_limits<double>::infinity() : static_cast<double>(params.NumberOfSamples - 1);
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    double step = params.SampleStep[axis];
+    if (step == 0.0)
+    {
+      if (rayStart[axis] < params.Bounds[2 * axis] || rayStart[axis] > params.Bounds[2 * axis + 1])
+      {
+        return false;
+      }
+      continue;
+    }
+    double t0 = (params.Bounds[2 * axis] - rayStart[axis]) / step;
+    double t1 = (params.Bounds[2 * axis + 1] - rayStart[axis]) / step;
+    firstSampleBound = std::max(firstSampleBound, std::min(t0, t1));
+    lastSampleBound = std::min(lastSampleBound, std::max(t0, t1));
+  }
+  if (firstSampleBound > lastSampleBound)
+  {
+    return false;
+  }
+  long long firstSample = static_cast<long long>(std::ceil(firstSampleBound));
+  long long lastSample = static_cast<long long>(std::floor(lastSampleBound));
+  // Make sure that the first and last samples are inside, despite rounding errors
+  auto isInside = [&](long long k)
+  {
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      double position = rayStart[axis] + k * params.SampleStep[axis];
+      if (position < params.Bounds[2 * axis] || position > params.Bounds[2 * axis + 1])
+      {
+        return false;
+      }
+    }
+    return true;
+  };
+  if (firstSample <= lastSample && !isInside(firstSample))
+  {
+    ++firstSample;
+  }
+  if (firstSample <= lastSample && !isInside(lastSample))
+  {
+    --lastSample;
+  }
+  if (firstSample > lastSample)
+  {
+    return false;
+  }
+
+  const int slabMode = params.SlabMode;
+  double value = 0.0;
+  if (slabMode == VTK_IMAGE_SLAB_MAX)
+  {
+    value = -std::numeric_limits<double>::infinity();
+  }
+  else if (slabMode == VTK_IMAGE_SLAB_MIN)
+  {
+    value = std::numeric_limits<double>::infinity();
+  }
+
+  long long k = firstSample;
+  while (k <= lastSample)
+  {
+    long long blockEnd = lastSample + 1;
+    if (params.EmptySpaceSkipping)
+    {
+      // Skip the part of the ray that is in the current brick if it cannot change the result
+      double point[3];
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        point[axis] = rayStart[axis] + k * params.SampleStep[axis];
+      }
+      int brick[3];
+      vtkIdType brickId = bricks.GetBrickId(point, brick);
+      blockEnd = bricks.GetExitSample(brick, rayStart, params.SampleStep, k, lastSample);
+      if ((slabMode == VTK_IMAGE_SLAB_MAX && bricks.Maximum[brickId] <= value)
+        || (slabMode == VTK_IMAGE_SLAB_MIN && bricks.Minimum[brickId] >= value))
+      {
+        k = blockEnd;
+        continue;
+      }
+      if (slabMode == VTK_IMAGE_SLAB_MEAN && bricks.Minimum[brickId] == bricks.Maximum[brickId])
+      {
+        value += bricks.Minimum[brickId] * static_cast<double>(blockEnd - k);
+        k = blockEnd;
+        continue;
+      }
+    }
+
+    for (; k < blockEnd; ++k)
+    {
+      double point[3];
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        point[axis] = rayStart[axis] + k * params.SampleStep[axis];
+      }
+      double sample = Linear ? SampleLinear(scalars, params, point) : SampleNearest(scalars, params, point);
+      ++numberOfSamples;
+      if (slabMode == VTK_IMAGE_SLAB_MAX)
+      {
+        value = std::max(value, sample);
+      }
+      else if (slabMode == VTK_IMAGE_SLAB_MIN)
+      {
+        value = std::min(value, sample);
+      }
+      else
+      {
+        value += sample;
+      }
+    }
+
+    // Terminate the ray if the extremum of the input is reached
+    if (params.EmptySpaceSkipping
+      && ((slabMode == VTK_IMAGE_SLAB_MAX && value >= bricks.ScalarRange[1])
+        || (slabMode == VTK_IMAGE_SLAB_MIN && value <= bricks.ScalarRange[0])))
+    {
+      break;
+    }
+  }
+
+  if (slabMode == VTK_IMAGE_SLAB_MEAN)
+  {
+    value /= static_cast<double>(lastSample - firstSample + 1);
+  }
+  result = value;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void ProjectionExecute(const ProjectionParameters& params, const BrickIndex& bricks,
+  vtkImageData* inData, vtkImageData* outData, const int outExt[6],
+  vtkImageStencilData* stencil, vtkIdType& numberOfSamples)
+{
+  const T* scalars = static_cast<const T*>(inData->GetScalarPointer());
+  T* outPtr = static_cast<T*>(outData->GetScalarPointerForExtent(const_cast<int*>(outExt)));
+  vtkIdType outIncrements[3] = { 0, 0, 0 };
+  outData->GetIncrements(outIncrements);
+  const T background = ConvertValue<T>(params.Background);
+
+  // First pixel of the current run of pixels that are inside the input, for each row of a tile
+  std::vector<int> runStart(TileSize, -1);
+
+  for (int z = outExt[4]; z <= outExt[5]; ++z)
+  {
+    for (int tileY = outExt[2]; tileY <= outExt[3]; tileY += TileSize)
+    {
+      int tileYEnd = std::min(tileY + TileSize - 1, outExt[3]);
+      std::fill(runStart.begin(), runStart.end(), -1);
+      for (int tileX = outExt[0]; tileX <= outExt[1]; tileX += TileSize)
+      {
+        int tileXEnd = std::min(tileX + TileSize - 1, outExt[1]);
+        for (int y = tileY; y <= tileYEnd; ++y)
+        {
+          T* outPixel = outPtr + (tileX - outExt[0]) * outIncrements[0]
+            + (y - outExt[2]) * outIncrements[1] + (z - outExt[4]) * outIncrements[2];
+          for (int x = tileX; x <= tileXEnd; ++x, outPixel += outIncrements[0])
+          {
+            double rayStart[3];
+            for (int axis = 0; axis < 3; ++axis)
+            {
+              rayStart[axis] = params.Origin[axis] + x * params.XStep[axis] + y * params.YStep[axis]
+                + z * params.ZStep[axis] + params.SampleOffset * params.SampleStep[axis];
+            }
+            double value = 0.0;
+            bool inside = params.Linear
+              ? CastRay<T, true>(scalars, params, bricks, rayStart, value, numberOfSamples)
+              : CastRay<T, false>(scalars, params, bricks, rayStart, value, numberOfSamples);
+            *outPixel = inside ? ConvertValue<T>(value) : background;
+
+            if (stencil)
+            {
+              int& rowRunStart = runStart[y - tileY];
+              if (inside && rowRunStart < 0)
+              {
+                rowRunStart = x;
+              }
+              else if (!inside && rowRunStart >= 0)
+              {
+                stencil->InsertNextExtent(rowRunStart, x - 1, y, z);
+                rowRunStart = -1;
+              }
+            }
+          }
+        }
+      }
+      if (stencil)
+      {
+        for (int y = tileY; y <= tileYEnd; ++y)
+        {
+          if (runStart[y - tileY] >= 0)
+          {
+            stencil->InsertNextExtent(runStart[y - tileY], outExt[1], y, z);
+          }
+        }
+      }
+    }
+  }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+class vtkImageProjectionReslice::vtkInternal
+{
+public:
+  BrickIndex Bricks;
+  std::atomic<vtkIdType> NumberOfInterpolatedSamples{ 0 };
+  /// Output stencil of the current execution (nullptr if stencil output is not generated)
+  vtkImageStencilData* StencilOutput{ nullptr };
+};
+
+//----------------------------------------------------------------------------
+vtkImageProjectionReslice::vtkImageProjectionReslice()
+{
+  this->ProjectThroughInput = false;
+  this->BrickSize = 16;
+  this->EmptySpaceSkipping = true;
+  this->NumberOfInterpolatedSamples = 0;
+  this->NumberOfBrickIndexComputations = 0;
+  this->Internal = new vtkInternal;
+}
+
+//----------------------------------------------------------------------------
+vtkImageProjectionReslice::~vtkImageProjectionReslice()
+{
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageProjectionReslice::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "ProjectThroughInput: " << (this->ProjectThroughInput ? "true" : "false") << "\n";
+  os << indent << "BrickSize: " << this->BrickSize << "\n";
+  os << indent << "EmptySpaceSkipping: " << (this->EmptySpaceSkipping ? "true" : "false") << "\n";
+  os << indent << "NumberOfInterpolatedSamples: " << this->NumberOfInterpolatedSamples << "\n";
+  os << indent << "NumberOfBrickIndexComputations: " << this->NumberOfBrickIndexComputations << "\n";
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageProjectionReslice::IsProjectionRequested()
+{
+  if (!this->ProjectThroughInput && this->GetSlabNumberOfSlices() <= 1)
+  {
+    return false;
+  }
+  int slabMode = this->GetSlabMode();
+  if (slabMode != VTK_IMAGE_SLAB_MIN && slabMode != VTK_IMAGE_SLAB_MAX && slabMode != VTK_IMAGE_SLAB_MEAN)
+  {
+    return false;
+  }
+  return !this->GetSlabTrapezoidIntegration();
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageProjectionReslice::CanUseProjection(vtkImageData* inData, vtkImageData* outData)
+{
+  if (!this->IsProjectionRequested() || !inData || !outData || !GetProjectionScalars(inData))
+  {
+    return false;
+  }
+  // Only linear transforms are supported, which are fully described by the index matrix
+  if (this->OptimizedTransform || !this->IndexMatrix
+    || this->IndexMatrix->GetElement(3, 0) != 0.0 || this->IndexMatrix->GetElement(3, 1) != 0.0
+    || this->IndexMatrix->GetElement(3, 2) != 0.0 || this->IndexMatrix->GetElement(3, 3) != 1.0)
+  {
+    return false;
+  }
+  if (this->ProjectThroughInput && this->IndexMatrix->GetElement(0, 2) == 0.0
+    && this->IndexMatrix->GetElement(1, 2) == 0.0 && this->IndexMatrix->GetElement(2, 2) == 0.0)
+  {
+    return false;
+  }
+  if (outData->GetNumberOfScalarComponents() != 1 || outData->GetScalarType() != inData->GetScalarType()
+    || this->GetScalarShift() != 0.0 || this->GetScalarScale() != 1.0 || this->GetStencil())
+  {
+    return false;
+  }
+  vtkImageInterpolator* interpolator = vtkImageInterpolator::SafeDownCast(this->GetInterpolator());
+  if (!interpolator || interpolator->GetBorderMode() != VTK_IMAGE_BORDER_CLAMP
+    || (interpolator->GetInterpolationMode() != VTK_NEAREST_INTERPOLATION
+      && interpolator->GetInterpolationMode() != VTK_LINEAR_INTERPOLATION))
+  {
+    return false;
+  }
+  if (this->EmptySpaceSkipping && !this->Internal->Bricks.IsValid(inData, this->BrickSize))
+  {
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageProjectionReslice::RequestUpdateExtent(vtkInformation* request,
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  int result = this->Superclass::RequestUpdateExtent(request, inputVector, outputVector);
+  if (this->ProjectThroughInput)
+  {
+    // Rays go through the entire input
+    vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
+    int wholeExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExtent);
+    inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), wholeExtent, 6);
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageProjectionReslice::RequestData(vtkInformation* request,
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  this->Internal->NumberOfInterpolatedSamples = 0;
+  if (this->IsProjectionRequested() && this->EmptySpaceSkipping)
+  {
+    // The index is computed before the threads start, it is only read during projection
+    if (this->Internal->Bricks.Update(vtkImageData::GetData(inputVector[0]), this->BrickSize))
+    {
+      this->NumberOfBrickIndexComputations++;
+    }
+  }
+  this->Internal->StencilOutput = this->GetGenerateStencilOutput() ? vtkImageStencilData::GetData(outputVector, 1) : nullptr;
+
+  int result = this->Superclass::RequestData(request, inputVector, outputVector);
+
+  this->Internal->StencilOutput = nullptr;
+  this->NumberOfInterpolatedSamples = this->Internal->NumberOfInterpolatedSamples;
+  return result;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageProjectionReslice::ThreadedRequestData(vtkInformation* request,
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector,
+  vtkImageData*** inData, vtkImageData** outData, int outExt[6], int threadId)
+{
+  vtkImageData* input = inData[0][0];
+  if (!this->CanUseProjection(input, outData[0]))
+  {
+    this->Superclass::ThreadedRequestData(request, inputVector, outputVector, inData, outData, outExt, threadId);
+    return;
+  }
+
+  ProjectionParameters params;
+  double sampleSpacingFraction = this->GetSlabSliceSpacingFraction();
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    params.Origin[axis] = this->IndexMatrix->GetElement(axis, 3);
+    params.XStep[axis] = this->IndexMatrix->GetElement(axis, 0);
+    params.YStep[axis] = this->IndexMatrix->GetElement(axis, 1);
+    params.ZStep[axis] = this->IndexMatrix->GetElement(axis, 2);
+    params.SampleStep[axis] = params.ZStep[axis] * sampleSpacingFraction;
+  }
+  params.ProjectThroughInput = this->ProjectThroughInput;
+  params.NumberOfSamples = this->ProjectThroughInput ? 0 : this->GetSlabNumberOfSlices();
+  params.SampleOffset = this->ProjectThroughInput ? 0.0 : -0.5 * (params.NumberOfSamples - 1);
+  params.SlabMode = this->GetSlabMode();
+  vtkImageInterpolator* interpolator = vtkImageInterpolator::SafeDownCast(this->GetInterpolator());
+  params.Linear = (interpolator->GetInterpolationMode() == VTK_LINEAR_INTERPOLATION);
+  params.EmptySpaceSkipping = this->EmptySpaceSkipping;
+  input->GetExtent(params.InputExtent);
+  input->GetIncrements(params.InputIncrements);
+  double tolerance = interpolator->GetTolerance();
+  for (int i = 0; i < 3; ++i)
+  {
+    params.Bounds[2 * i] = params.InputExtent[2 * i] - tolerance;
+    params.Bounds[2 * i + 1] = params.InputExtent[2 * i + 1] + tolerance;
+  }
+  params.Background = this->GetBackgroundColor()[0];
+
+  vtkIdType numberOfSamples = 0;
+  switch (input->GetScalarType())
+  {
+    vtkTemplateMacro(ProjectionExecute<VTK_TT>(params, this->Internal->Bricks, input, outData[0], outExt,
+      this->Internal->StencilOutput, numberOfSamples));
+    default:
+      vtkErrorMacro("ThreadedRequestData: unsupported scalar type " << input->GetScalarType());
+      return;
+  }
+  this->Internal->NumberOfInterpolatedSamples += numberOfSamples;
+}
@@ -0,0 +1,106 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkImageProjectionReslice_h
+#define __vtkImageProjectionReslice_h
+
+// VTK includes
+#include <vtkImageReslice.h>
+
+#include "vtkMRMLLogicExport.h"
+
+/// \brief Reslice filter with a fast CPU implementation of minimum, maximum, and mean intensity projection.
+///
+/// The filter is a drop-in replacement for vtkImageReslice. When slab reconstruction is enabled
+/// (SlabNumberOfSlices > 1) with minimum, maximum, or mean slab mode, the projection is computed
+/// by casting a ray along the output z axis for each output pixel, instead of interpolating
+/// each slice of the slab separately:
+/// - output pixels are processed in tiles, in parallel, so that neighboring rays traverse the same
+///   part of the input,
+/// - the minimum and maximum value of each brick of the input is stored in an index that is only
+///   recomputed when the input changes. Bricks that cannot change the result of a ray are skipped
+///   (bricks of constant value are accumulated without sampling in mean mode),
+/// - rays are terminated as soon as they reach the maximum (or minimum) value of the input.
+///
+/// In all other cases (nonlinear reslice transform, multi-component or stencil input, cubic interpolation,
+/// wrap/mirror border mode, output type conversion, trapezoid integration, sum mode)
+/// the projection is computed by vtkImageReslice.
+///
+/// If ProjectThroughInput is enabled then rays are cast through the entire input instead of only
+/// through the slab, which allows computing maximum intensity projection images of a volume
+/// from arbitrary view directions without an OpenGL context: set the view direction as the z axis
+/// of the reslice axes, set output dimensionality to 2, and enable AutoCropOutput.
+/// The distance between samples along the ray is SlabSliceSpacingFraction times the output spacing along z.
+class VTK_MRML_LOGIC_EXPORT vtkImageProjectionReslice : public vtkImageReslice
+{
+public:
+  static vtkImageProjectionReslice *New();
+  vtkTypeMacro(vtkImageProjectionReslice, vtkImageReslice);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Cast rays through the entire input instead of only through the slab.
+  /// SlabNumberOfSlices is ignored if enabled. Only supported for linear reslice transforms.
+  /// Default is off.
+  vtkSetMacro(ProjectThroughInput, bool);
+  vtkGetMacro(ProjectThroughInput, bool);
+  vtkBooleanMacro(ProjectThroughInput, bool);
+
+  /// Size of the input bricks (in voxels along each axis) that are skipped when they cannot
+  /// change the projection result. Default is 16.
+  vtkSetClampMacro(BrickSize, int, 2, 256);
+  vtkGetMacro(BrickSize, int);
+
+  /// Skip bricks and terminate rays early. The result is the same when disabled,
+  /// which is useful for testing and performance comparison. Default is on.
+  vtkSetMacro(EmptySpaceSkipping, bool);
+  vtkGetMacro(EmptySpaceSkipping, bool);
+  vtkBooleanMacro(EmptySpaceSkipping, bool);
+
+  /// Number of input samples that were interpolated in the last execution by the fast projection.
+  /// It is 0 if the output was computed by vtkImageReslice.
+  vtkGetMacro(NumberOfInterpolatedSamples, vtkIdType);
+
+  /// Number of times the brick index was computed. It is only recomputed when the input changes.
+  vtkGetMacro(NumberOfBrickIndexComputations, int);
+
+protected:
+  vtkImageProjectionReslice();
+  ~vtkImageProjectionReslice() override;
+
+  int RequestUpdateExtent(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) override;
+  int RequestData(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) override;
+  void ThreadedRequestData(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector, vtkImageData*** inData, vtkImageData** outData,
+    int outExt[6], int threadId) override;
+
+  /// Returns true if slab settings allow computing the output by fast projection.
+  bool IsProjectionRequested();
+  /// Returns true if the output can be computed by fast projection for the current input and output.
+  bool CanUseProjection(vtkImageData* inData, vtkImageData* outData);
+
+  bool ProjectThroughInput;
+  int BrickSize;
+  bool EmptySpaceSkipping;
+  vtkIdType NumberOfInterpolatedSamples;
+  int NumberOfBrickIndexComputations;
+
+private:
+  vtkImageProjectionReslice(const vtkImageProjectionReslice&) = delete;
+  void operator=(const vtkImageProjectionReslice&) = delete;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+};
+
+#endif
@@ -0,0 +1,597 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkIncrementalPlaneClipPolyData.h"
+
+// VTK includes
+#include <vtkAppendPolyData.h>
+#include <vtkCellArray.h>
+#include <vtkCellArrayIterator.h>
+#include <vtkCellData.h>
+#include <vtkClipPolyData.h>
+#include <vtkIdTypeArray.h>
+#include <vtkImplicitBoolean.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPlane.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <vector>
+
+vtkStandardNewMacro(vtkIncrementalPlaneClipPolyData);
+
+namespace
+{
+
+// Vertices, lines, polygons, and triangle strips, in the order of cell IDs in vtkPolyData
+const int NumberOfCellTypes = 4;
+
+enum CellStates
+{
+  CellRemoved = -1,
+  CellIntersected = 0,
+  CellKept = 1
+};
+
+//----------------------------------------------------------------------------
+vtkCellArray* GetCellArray(vtkPolyData* polyData, int cellType)
+{
+  switch (cellType)
+  {
+    case 0: return polyData->GetVerts();
+    case 1: return polyData->GetLines();
+    case 2: return polyData->GetPolys();
+    default: return polyData->GetStrips();
+  }
+}
+
+//----------------------------------------------------------------------------
+void SetCellArray(vtkPolyData* polyData, int cellType, vtkCellArray* cells)
+{
+  switch (cellType)
+  {
+    case 0: polyData->SetVerts(cells); break;
+    case 1: polyData->SetLines(cells); break;
+    case 2: polyData->SetPolys(cells); break;
+    default: polyData->SetStrips(cells); break;
+  }
+}
+
+//----------------------------------------------------------------------------
+// Copy the selected cells of a cell array, in parallel
+void CopyCells(vtkCellArray* inputCells, const std::vector<vtkIdType>& cellIds, vtkCellArray* outputCells)
+{
+  vtkIdType numberOfCells = static_cast<vtkIdType>(cellIds.size());
+  vtkNew<vtkIdTypeArray> offsets;
+  offsets->SetNumberOfValues(numberOfCells + 1);
+  vtkIdType* offsetsPtr = offsets->GetPointer(0);
+  offsetsPtr[0] = 0;
+  for (vtkIdType i = 0; i < numberOfCells; ++i)
+  {
+    offsetsPtr[i + 1] = offsetsPtr[i] + inputCells->GetCellSize(cellIds[i]);
+  }
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfValues(offsetsPtr[numberOfCells]);
+  vtkIdType* connectivityPtr = connectivity->GetPointer(0);
+  vtkSMPTools::For(0, numberOfCells, [&](vtkIdType begin, vtkIdType end)
+  {
+    vtkSmartPointer<vtkCellArrayIterator> cellIterator = vtk::TakeSmartPointer(inputCells->NewIterator());
+    vtkIdType numberOfCellPoints = 0;
+    const vtkIdType* cellPointIds = nullptr;
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      cellIterator->GetCellAtId(cellIds[i], numberOfCellPoints, cellPointIds);
+      std::copy(cellPointIds, cellPointIds + numberOfCellPoints, connectivityPtr + offsetsPtr[i]);
+    }
+  });
+  outputCells->SetData(offsets, connectivity);
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+class vtkIncrementalPlaneClipPolyData::vtkInternal
+{
+public:
+  struct Plane
+  {
+    double Origin[3];
+    double Normal[3];
+  };
+
+  struct CellRanges
+  {
+    bool Valid{false};
+    double Normal[3];
+    /// Minimum and maximum of the projection of cell points on the normal (2 values per cell)
+    std::vector<double> Ranges;
+  };
+
+  /// Compute range of each cell along the normal
+  void ComputeCellRanges(vtkPolyData* input, const double normal[3], CellRanges& cellRanges);
+
+  /// Compute implicit function value at a point, same as vtkImplicitBoolean of vtkPlane functions
+  double EvaluateFunction(const double point[3], const std::vector<double>& offsets, bool intersection) const;
+
+  std::vector<Plane> Planes;
+  std::vector<CellRanges> PlaneCellRanges;
+  vtkWeakPointer<vtkPolyData> CachedInput;
+  vtkMTimeType CachedInputTime{0};
+  /// Input point ID to intersected cells point ID (-1 if not used)
+  std::vector<vtkIdType> PointMap;
+};
+
+//----------------------------------------------------------------------------
+void vtkIncrementalPlaneClipPolyData::vtkInternal::ComputeCellRanges(vtkPolyData* input,
+  const double normal[3], CellRanges& cellRanges)
+{
+  vtkPoints* points = input->GetPoints();
+  std::vector<double> pointProjections(input->GetNumberOfPoints());
+  vtkSMPTools::For(0, input->GetNumberOfPoints(), [&](vtkIdType begin, vtkIdType end)
+  {
+    double point[3] = { 0.0, 0.0, 0.0 };
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+    {
+      points->GetPoint(pointId, point);
+      pointProjections[pointId] = vtkMath::Dot(normal, point);
+    }
+  });
+
+  cellRanges.Ranges.resize(2 * input->GetNumberOfCells());
+  vtkIdType cellOffset = 0;
+  for (int cellType = 0; cellType < NumberOfCellTypes; ++cellType)
+  {
+    vtkCellArray* cells = GetCellArray(input, cellType);
+    if (!cells)
+    {
+      continue;
+    }
+    double* ranges = cellRanges.Ranges.data() + 2 * cellOffset;
+    vtkSMPTools::For(0, cells->GetNumberOfCells(), [&](vtkIdType begin, vtkIdType end)
+    {
+      vtkSmartPointer<vtkCellArrayIterator> cellIterator = vtk::TakeSmartPointer(cells->NewIterator());
+      vtkIdType numberOfCellPoints = 0;
+      const vtkIdType* cellPointIds = nullptr;
+      for (vtkIdType cellId = begin; cellId < end; ++cellId)
+      {
+        cellIterator->GetCellAtId(cellId, numberOfCellPoints, cellPointIds);
+        double minimum = std::numeric_limits<double>::max();
+        double maximum = std::numeric_limits<double>::lowest();
+        for (vtkIdType i = 0; i < numberOfCellPoints; ++i)
+        {
+          double projection = pointProjections[cellPointIds[i]];
+          minimum = std::min(minimum, projection);
+          maximum = std::max(maximum, projection);
+        }
+        ranges[2 * cellId] = minimum;
+        ranges[2 * cellId + 1] = maximum;
+      }
+    });
+    cellOffset += cells->GetNumberOfCells();
+  }
+
+  std::copy(normal, normal + 3, cellRanges.Normal);
+  cellRanges.Valid = true;
+}
+
+//----------------------------------------------------------------------------
+double vtkIncrementalPlaneClipPolyData::vtkInternal::EvaluateFunction(const double point[3],
+  const std::vector<double>& offsets, bool intersection) const
+{
+  double value = 0.0;
+  for (size_t planeIndex = 0; planeIndex < this->Planes.size(); ++planeIndex)
+  {
+    double planeValue = vtkMath::Dot(this->Planes[planeIndex].Normal, point) - offsets[planeIndex];
+    if (planeIndex == 0)
+    {
+      value = planeValue;
+    }
+    else
+    {
+      value = intersection ? std::max(value, planeValue) : std::min(value, planeValue);
+    }
+  }
+  return value;
+}
+
+//----------------------------------------------------------------------------
+vtkIncrementalPlaneClipPolyData::vtkIncrementalPlaneClipPolyData()
+{
+  this->OperationType = OperationIntersection;
+  this->ClipMethod = ClipStraight;
+  this->NumberOfIntersectedCells = 0;
+  this->NumberOfCellRangeComputations = 0;
+  this->Internal = new vtkInternal;
+}
+
+//----------------------------------------------------------------------------
+vtkIncrementalPlaneClipPolyData::~vtkIncrementalPlaneClipPolyData()
+{
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkIncrementalPlaneClipPolyData::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "OperationType: " << this->OperationType << "\n";
+  os << indent << "ClipMethod: " << this->ClipMethod << "\n";
+  os << indent << "NumberOfPlanes: " << this->GetNumberOfPlanes() << "\n";
+  os << indent << "NumberOfIntersectedCells: " << this->NumberOfIntersectedCells << "\n";
+  os << indent << "NumberOfCellRangeComputations: " << this->NumberOfCellRangeComputations << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkIncrementalPlaneClipPolyData::SetNumberOfPlanes(int numberOfPlanes)
+{
+  if (numberOfPlanes < 0 || static_cast<int>(this->Internal->Planes.size()) == numberOfPlanes)
+  {
+    return;
+  }
+  vtkInternal::Plane defaultPlane = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 1.0 } };
+  this->Internal->Planes.resize(numberOfPlanes, defaultPlane);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkIncrementalPlaneClipPolyData::GetNumberOfPlanes()
+{
+  return static_cast<int>(this->Internal->Planes.size());
+}
+
+//----------------------------------------------------------------------------
+void vtkIncrementalPlaneClipPolyData::SetPlane(int planeIndex, const double origin[3], const double normal[3])
+{
+  if (planeIndex < 0 || planeIndex >= this->GetNumberOfPlanes())
+  {
+    vtkErrorMacro("SetPlane: invalid plane index " << planeIndex);
+    return;
+  }
+  vtkInternal::Plane& plane = this->Internal->Planes[planeIndex];
+  if (std::equal(origin, origin + 3, plane.Origin) && std::equal(normal, normal + 3, plane.Normal))
+  {
+    return;
+  }
+  std::copy(origin, origin + 3, plane.Origin);
+  std::copy(normal, normal + 3, plane.Normal);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkIncrementalPlaneClipPolyData::GetPlane(int planeIndex, double origin[3], double normal[3])
+{
+  if (planeIndex < 0 || planeIndex >= this->GetNumberOfPlanes())
+  {
+    vtkErrorMacro("GetPlane: invalid plane index " << planeIndex);
+    return;
+  }
+  const vtkInternal::Plane& plane = this->Internal->Planes[planeIndex];
+  std::copy(plane.Origin, plane.Origin + 3, origin);
+  std::copy(plane.Normal, plane.Normal + 3, normal);
+}
+
+//----------------------------------------------------------------------------
+int vtkIncrementalPlaneClipPolyData::RequestData(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  vtkPolyData* input = vtkPolyData::GetData(inputVector[0]);
+  vtkPolyData* output = vtkPolyData::GetData(outputVector);
+  vtkInternal* internal = this->Internal;
+  this->NumberOfIntersectedCells = 0;
+
+  int numberOfPlanes = this->GetNumberOfPlanes();
+  if (numberOfPlanes == 0 || !input->GetPoints() || input->GetNumberOfCells() == 0)
+  {
+    output->ShallowCopy(input);
+    return 1;
+  }
+
+  // Cell ranges are only valid for the input they were computed for
+  if (internal->CachedInput != input || internal->CachedInputTime < input->GetMTime())
+  {
+    internal->PlaneCellRanges.clear();
+    internal->PointMap.clear();
+    internal->CachedInput = input;
+    internal->CachedInputTime = input->GetMTime();
+  }
+
+  // Cell ranges only need to be computed if a plane normal is changed
+  internal->PlaneCellRanges.resize(numberOfPlanes);
+  std::vector<double> offsets(numberOfPlanes);
+  std::vector<const double*> planeRanges(numberOfPlanes);
+  for (int planeIndex = 0; planeIndex < numberOfPlanes; ++planeIndex)
+  {
+    const vtkInternal::Plane& plane = internal->Planes[planeIndex];
+    vtkInternal::CellRanges& cellRanges = internal->PlaneCellRanges[planeIndex];
+    if (!cellRanges.Valid || !std::equal(plane.Normal, plane.Normal + 3, cellRanges.Normal))
+    {
+      internal->ComputeCellRanges(input, plane.Normal, cellRanges);
+      this->NumberOfCellRangeComputations++;
+    }
+    offsets[planeIndex] = vtkMath::Dot(plane.Normal, plane.Origin);
+    planeRanges[planeIndex] = cellRanges.Ranges.data();
+  }
+
+  // Classify cells as kept, removed, or intersected using the cached cell ranges.
+  // Intersected cells are resolved here if whole cells are extracted.
+  vtkPoints* inputPoints = input->GetPoints();
+  bool intersection = (this->OperationType == OperationIntersection);
+  int clipMethod = this->ClipMethod;
+  std::vector<signed char> cellStates(input->GetNumberOfCells());
+  std::atomic<vtkIdType> numberOfIntersectedCells(0);
+  vtkIdType cellOffset = 0;
+  for (int cellType = 0; cellType < NumberOfCellTypes; ++cellType)
+  {
+    vtkCellArray* cells = GetCellArray(input, cellType);
+    if (!cells)
+    {
+      continue;
+    }
+    vtkSMPTools::For(0, cells->GetNumberOfCells(), [&](vtkIdType begin, vtkIdType end)
+    {
+      vtkSmartPointer<vtkCellArrayIterator> cellIterator;
+      vtkIdType numberOfCellPoints = 0;
+      const vtkIdType* cellPointIds = nullptr;
+      double point[3] = { 0.0, 0.0, 0.0 };
+      vtkIdType localNumberOfIntersectedCells = 0;
+      for (vtkIdType cellId = begin; cellId < end; ++cellId)
+      {
+        vtkIdType inputCellId = cellOffset + cellId;
+        int numberOfKeptPlanes = 0;
+        int numberOfRemovedPlanes = 0;
+        for (int planeIndex = 0; planeIndex < numberOfPlanes; ++planeIndex)
+        {
+          if (planeRanges[planeIndex][2 * inputCellId] > offsets[planeIndex])
+          {
+            numberOfKeptPlanes++;
+          }
+          else if (planeRanges[planeIndex][2 * inputCellId + 1] < offsets[planeIndex])
+          {
+            numberOfRemovedPlanes++;
+          }
+        }
+        signed char state = CellIntersected;
+        if (intersection)
+        {
+          if (numberOfKeptPlanes > 0)
+          {
+            state = CellKept;
+          }
+          else if (numberOfRemovedPlanes == numberOfPlanes)
+          {
+            state = CellRemoved;
+          }
+        }
+        else
+        {
+          if (numberOfKeptPlanes == numberOfPlanes)
+          {
+            state = CellKept;
+          }
+          else if (numberOfRemovedPlanes > 0)
+          {
+            state = CellRemoved;
+          }
+        }
+
+        if (state == CellIntersected)
+        {
+          localNumberOfIntersectedCells++;
+          if (clipMethod != ClipStraight)
+          {
+            if (!cellIterator)
+            {
+              cellIterator = vtk::TakeSmartPointer(cells->NewIterator());
+            }
+            cellIterator->GetCellAtId(cellId, numberOfCellPoints, cellPointIds);
+            vtkIdType numberOfPositivePoints = 0;
+            for (vtkIdType i = 0; i < numberOfCellPoints; ++i)
+            {
+              inputPoints->GetPoint(cellPointIds[i], point);
+              if (internal->EvaluateFunction(point, offsets, intersection) > 0.0)
+              {
+                numberOfPositivePoints++;
+              }
+            }
+            bool keep = (clipMethod == ClipWholeCells) ? (numberOfPositivePoints == numberOfCellPoints)
+              : (numberOfPositivePoints > 0);
+            state = keep ? CellKept : CellRemoved;
+          }
+        }
+        cellStates[inputCellId] = state;
+      }
+      numberOfIntersectedCells += localNumberOfIntersectedCells;
+    });
+    cellOffset += cells->GetNumberOfCells();
+  }
+  this->NumberOfIntersectedCells = numberOfIntersectedCells;
+
+  // Collect kept and intersected cells of each cell type
+  std::vector<vtkIdType> keptCellIds[NumberOfCellTypes];
+  std::vector<vtkIdType> intersectedCellIds[NumberOfCellTypes];
+  cellOffset = 0;
+  for (int cellType = 0; cellType < NumberOfCellTypes; ++cellType)
+  {
+    vtkCellArray* cells = GetCellArray(input, cellType);
+    vtkIdType numberOfCells = cells ? cells->GetNumberOfCells() : 0;
+    for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+      signed char state = cellStates[cellOffset + cellId];
+      if (state == CellKept)
+      {
+        keptCellIds[cellType].push_back(cellId);
+      }
+      else if (state == CellIntersected)
+      {
+        intersectedCellIds[cellType].push_back(cellId);
+      }
+    }
+    cellOffset += numberOfCells;
+  }
+
+  // Kept cells use the input points
+  vtkNew<vtkPolyData> keptPolyData;
+  keptPolyData->SetPoints(inputPoints);
+  keptPolyData->GetPointData()->PassData(input->GetPointData());
+  vtkCellData* inputCellData = input->GetCellData();
+  vtkCellData* keptCellData = keptPolyData->GetCellData();
+  bool hasCellData = (inputCellData->GetNumberOfArrays() > 0);
+  vtkIdType numberOfKeptCells = 0;
+  for (int cellType = 0; cellType < NumberOfCellTypes; ++cellType)
+  {
+    numberOfKeptCells += static_cast<vtkIdType>(keptCellIds[cellType].size());
+  }
+  if (hasCellData)
+  {
+    keptCellData->CopyAllocate(inputCellData, numberOfKeptCells);
+  }
+  cellOffset = 0;
+  vtkIdType keptCellId = 0;
+  for (int cellType = 0; cellType < NumberOfCellTypes; ++cellType)
+  {
+    vtkCellArray* cells = GetCellArray(input, cellType);
+    if (!cells)
+    {
+      continue;
+    }
+    if (!keptCellIds[cellType].empty())
+    {
+      vtkNew<vtkCellArray> keptCells;
+      CopyCells(cells, keptCellIds[cellType], keptCells);
+      SetCellArray(keptPolyData, cellType, keptCells);
+      if (hasCellData)
+      {
+        for (vtkIdType cellId : keptCellIds[cellType])
+        {
+          keptCellData->CopyData(inputCellData, cellOffset + cellId, keptCellId++);
+        }
+      }
+    }
+    cellOffset += cells->GetNumberOfCells();
+  }
+
+  if (this->NumberOfIntersectedCells == 0 || clipMethod != ClipStraight)
+  {
+    output->ShallowCopy(keptPolyData);
+    output->GetFieldData()->PassData(input->GetFieldData());
+    return 1;
+  }
+
+  // Extract intersected cells with only the points they use and clip them
+  vtkNew<vtkPolyData> intersectedPolyData;
+  vtkNew<vtkPoints> intersectedPoints;
+  intersectedPoints->SetDataType(inputPoints->GetDataType());
+  intersectedPolyData->SetPoints(intersectedPoints);
+  vtkPointData* inputPointData = input->GetPointData();
+  vtkPointData* intersectedPointData = intersectedPolyData->GetPointData();
+  vtkCellData* intersectedCellData = intersectedPolyData->GetCellData();
+  intersectedPointData->CopyAllocate(inputPointData);
+  intersectedCellData->CopyAllocate(inputCellData, this->NumberOfIntersectedCells);
+  if (static_cast<vtkIdType>(internal->PointMap.size()) != input->GetNumberOfPoints())
+  {
+    internal->PointMap.assign(input->GetNumberOfPoints(), -1);
+  }
+  std::vector<vtkIdType> usedPointIds;
+  std::vector<vtkIdType> newCellPointIds;
+  cellOffset = 0;
+  vtkIdType intersectedCellId = 0;
+  for (int cellType = 0; cellType < NumberOfCellTypes; ++cellType)
+  {
+    vtkCellArray* cells = GetCellArray(input, cellType);
+    if (!cells)
+    {
+      continue;
+    }
+    if (!intersectedCellIds[cellType].empty())
+    {
+      vtkNew<vtkCellArray> intersectedCells;
+      vtkSmartPointer<vtkCellArrayIterator> cellIterator = vtk::TakeSmartPointer(cells->NewIterator());
+      vtkIdType numberOfCellPoints = 0;
+      const vtkIdType* cellPointIds = nullptr;
+      for (vtkIdType cellId : intersectedCellIds[cellType])
+      {
+        cellIterator->GetCellAtId(cellId, numberOfCellPoints, cellPointIds);
+        newCellPointIds.resize(numberOfCellPoints);
+        for (vtkIdType i = 0; i < numberOfCellPoints; ++i)
+        {
+          vtkIdType inputPointId = cellPointIds[i];
+          if (internal->PointMap[inputPointId] < 0)
+          {
+            vtkIdType newPointId = intersectedPoints->InsertNextPoint(inputPoints->GetPoint(inputPointId));
+            intersectedPointData->CopyData(inputPointData, inputPointId, newPointId);
+            internal->PointMap[inputPointId] = newPointId;
+            usedPointIds.push_back(inputPointId);
+          }
+          newCellPointIds[i] = internal->PointMap[inputPointId];
+        }
+        intersectedCells->InsertNextCell(numberOfCellPoints, newCellPointIds.data());
+        intersectedCellData->CopyData(inputCellData, cellOffset + cellId, intersectedCellId++);
+      }
+      SetCellArray(intersectedPolyData, cellType, intersectedCells);
+    }
+    cellOffset += cells->GetNumberOfCells();
+  }
+  for (vtkIdType pointId : usedPointIds)
+  {
+    internal->PointMap[pointId] = -1;
+  }
+
+  vtkNew<vtkImplicitBoolean> clipFunction;
+  if (intersection)
+  {
+    clipFunction->SetOperationTypeToIntersection();
+  }
+  else
+  {
+    clipFunction->SetOperationTypeToUnion();
+  }
+  for (const vtkInternal::Plane& plane : internal->Planes)
+  {
+    vtkNew<vtkPlane> clipPlane;
+    clipPlane->SetOrigin(plane.Origin[0], plane.Origin[1], plane.Origin[2]);
+    clipPlane->SetNormal(plane.Normal[0], plane.Normal[1], plane.Normal[2]);
+    clipFunction->AddFunction(clipPlane);
+  }
+  vtkNew<vtkClipPolyData> clipper;
+  clipper->SetInputData(intersectedPolyData);
+  clipper->SetClipFunction(clipFunction);
+  clipper->SetValue(0.0);
+  clipper->Update();
+
+  if (clipper->GetOutput()->GetNumberOfCells() == 0)
+  {
+    output->ShallowCopy(keptPolyData);
+  }
+  else
+  {
+    vtkNew<vtkAppendPolyData> append;
+    append->AddInputData(keptPolyData);
+    append->AddInputData(clipper->GetOutput());
+    append->Update();
+    output->ShallowCopy(append->GetOutput());
+  }
+  output->GetFieldData()->PassData(input->GetFieldData());
+  return 1;
+}
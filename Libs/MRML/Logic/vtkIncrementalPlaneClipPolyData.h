@@ -0,0 +1,107 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkIncrementalPlaneClipPolyData_h
+#define __vtkIncrementalPlaneClipPolyData_h
+
+// VTK includes
+#include <vtkPolyDataAlgorithm.h>
+
+#include "vtkMRMLLogicExport.h"
+
+/// \brief Clip polydata with a set of planes, reusing computations between executions.
+///
+/// The output is equivalent to clipping the input with vtkClipPolyData (ClipStraight) or
+/// vtkExtractPolyDataGeometry with ExtractInside off (ClipWholeCells, ClipWholeCellsWithBoundary),
+/// using the union or intersection (vtkImplicitBoolean) of the planes as implicit function:
+/// the part of the mesh where the implicit function is positive is kept.
+///
+/// The range of each cell along each plane normal is cached. When a plane is only translated,
+/// which is the case when a slice is moved, cells are classified as kept, removed, or
+/// intersected without evaluating their points. Only intersected cells are clipped.
+/// The cache is invalidated when the input is modified or a plane normal changes.
+/// Classification is performed in parallel.
+///
+/// Output point data is not compacted: points of the input that are not used by any output
+/// cell are kept in the output.
+class VTK_MRML_LOGIC_EXPORT vtkIncrementalPlaneClipPolyData : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkIncrementalPlaneClipPolyData *New();
+  vtkTypeMacro(vtkIncrementalPlaneClipPolyData, vtkPolyDataAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  enum OperationTypes
+  {
+    OperationUnion = 0,
+    OperationIntersection
+  };
+
+  enum ClipMethods
+  {
+    ClipStraight = 0,
+    ClipWholeCells,
+    ClipWholeCellsWithBoundary
+  };
+
+  /// Combination of plane functions, same as in vtkImplicitBoolean:
+  /// union takes the minimum, intersection takes the maximum of the plane functions.
+  /// Default is OperationIntersection.
+  vtkSetClampMacro(OperationType, int, OperationUnion, OperationIntersection);
+  vtkGetMacro(OperationType, int);
+  void SetOperationTypeToUnion() { this->SetOperationType(OperationUnion); }
+  void SetOperationTypeToIntersection() { this->SetOperationType(OperationIntersection); }
+
+  /// Cut cells at the planes (ClipStraight) or keep whole cells that are entirely
+  /// (ClipWholeCells) or partially (ClipWholeCellsWithBoundary) in the kept region.
+  /// Default is ClipStraight.
+  vtkSetClampMacro(ClipMethod, int, ClipStraight, ClipWholeCellsWithBoundary);
+  vtkGetMacro(ClipMethod, int);
+
+  /// Set number of clipping planes. If there are no planes then the input is passed to the output.
+  void SetNumberOfPlanes(int numberOfPlanes);
+  int GetNumberOfPlanes();
+
+  /// Set a clipping plane. Points on the side the normal points to are kept
+  /// (same as the sign of vtkPlane function value).
+  /// The filter is only modified if the plane is changed.
+  void SetPlane(int planeIndex, const double origin[3], const double normal[3]);
+  void GetPlane(int planeIndex, double origin[3], double normal[3]);
+
+  /// Number of cells that had to be clipped or evaluated point by point in the last execution.
+  vtkGetMacro(NumberOfIntersectedCells, vtkIdType);
+
+  /// Number of times cell ranges were computed along a plane normal. Translating a plane
+  /// does not require computing cell ranges again.
+  vtkGetMacro(NumberOfCellRangeComputations, int);
+
+protected:
+  vtkIncrementalPlaneClipPolyData();
+  ~vtkIncrementalPlaneClipPolyData() override;
+
+  int RequestData(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) override;
+
+  int OperationType;
+  int ClipMethod;
+  vtkIdType NumberOfIntersectedCells;
+  int NumberOfCellRangeComputations;
+
+private:
+  vtkIncrementalPlaneClipPolyData(const vtkIncrementalPlaneClipPolyData&) = delete;
+  void operator=(const vtkIncrementalPlaneClipPolyData&) = delete;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+};
+
+#endif
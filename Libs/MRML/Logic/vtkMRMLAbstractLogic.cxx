@@ -19,6 +19,7 @@
 // MRML includes
 #include "vtkMRMLNode.h"
 #include "vtkMRMLScene.h"
+#include "vtkMRMLTraceLogger.h"
 
 // VTK includes
 #include <vtkCallbackCommand.h>
@@ -166,6 +167,7 @@ void vtkMRMLAbstractLogic::MRMLSceneCallback(vtkObject*caller, unsigned long eid
 
   vtkDebugWithObjectMacro(self, "In vtkMRMLAbstractLogic MRMLSceneCallback");
 
+  MRML_TRACE_SCOPE_DETAIL("Logic", "vtkMRMLAbstractLogic::ProcessMRMLSceneEvents", self->GetClassName());
   self->SetInMRMLSceneCallbackFlag(self->GetInMRMLSceneCallbackFlag() + 1);
   int oldProcessingEvent = self->GetProcessingMRMLSceneEvent();
   self->SetProcessingMRMLSceneEvent(eid);
@@ -208,6 +210,7 @@ void vtkMRMLAbstractLogic::MRMLNodesCallback(vtkObject* caller, unsigned long ei
   }
   vtkDebugWithObjectMacro(self, "In vtkMRMLAbstractLogic MRMLNodesCallback");
 
+  MRML_TRACE_SCOPE_DETAIL("Logic", "vtkMRMLAbstractLogic::ProcessMRMLNodesEvents", self->GetClassName());
   self->SetInMRMLNodesCallbackFlag(self->GetInMRMLNodesCallbackFlag() + 1);
   self->ProcessMRMLNodesEvents(caller, eid, callData);
   self->SetInMRMLNodesCallbackFlag(self->GetInMRMLNodesCallbackFlag() - 1);
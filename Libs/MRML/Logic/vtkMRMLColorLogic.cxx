@@ -51,6 +51,8 @@ vtkStandardNewMacro(vtkMRMLColorLogic);
 vtkMRMLColorLogic::vtkMRMLColorLogic()
 {
   this->UserColorFilePaths = nullptr;
+  this->LazyDefaultColorNodes = false;
+  this->MainThreadID = std::this_thread::get_id();
 }
 
 //----------------------------------------------------------------------------
@@ -62,6 +64,7 @@ vtkMRMLColorLogic::~vtkMRMLColorLogic()
   // clear out the lists of files
   this->ColorFiles.clear();
   this->UserColorFiles.clear();
+  this->ColorFileCache.clear();
 
   if (this->UserColorFilePaths)
   {
@@ -73,10 +76,11 @@ vtkMRMLColorLogic::~vtkMRMLColorLogic()
 //------------------------------------------------------------------------------
 void vtkMRMLColorLogic::SetMRMLSceneInternal(vtkMRMLScene* newScene)
 {
-  // We are solely interested in vtkMRMLScene::NewSceneEvent,
-  // we don't want to listen to any other events.
+  // We are solely interested in vtkMRMLScene::NewSceneEvent and
+  // vtkMRMLScene::StartImportEvent, we don't want to listen to any other events.
   vtkNew<vtkIntArray> sceneEvents;
   sceneEvents->InsertNextValue(vtkMRMLScene::NewSceneEvent);
+  sceneEvents->InsertNextValue(vtkMRMLScene::StartImportEvent);
   this->SetAndObserveMRMLSceneEventsInternal(newScene, sceneEvents.GetPointer());
 
   if (newScene)
@@ -91,6 +95,13 @@ void vtkMRMLColorLogic::OnMRMLSceneNewEvent()
   this->AddDefaultColorNodes();
 }
 
+//------------------------------------------------------------------------------
+void vtkMRMLColorLogic::OnMRMLSceneStartImport()
+{
+  // Imported nodes may refer to any of the default color nodes
+  this->MaterializeDefaultColorNodes();
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLColorLogic::PrintSelf(ostream& os, vtkIndent indent)
 {
@@ -99,6 +110,9 @@ void vtkMRMLColorLogic::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "vtkMRMLColorLogic:             " << this->GetClassName() << "\n";
 
   os << indent << "UserColorFilePaths: " << this->GetUserColorFilePaths() << "\n";
+  os << indent << "LazyDefaultColorNodes: " << this->LazyDefaultColorNodes << "\n";
+  os << indent << "Pending default color nodes: " << this->PendingDefaultColorNodes.size() << "\n";
+  os << indent << "Cached color files: " << this->ColorFileCache.size() << "\n";
   os << indent << "Color Files:\n";
   for (size_t i = 0; i < this->ColorFiles.size(); i++)
   {
@@ -125,6 +139,9 @@ void vtkMRMLColorLogic::AddDefaultColorNodes()
 
   this->GetMRMLScene()->StartState(vtkMRMLScene::BatchProcessState);
 
+  // nodes registered for a previous scene are not valid anymore
+  this->PendingDefaultColorNodes.clear();
+
   // add the labels first
   this->AddLabelsNode();
 
@@ -150,6 +167,34 @@ void vtkMRMLColorLogic::AddDefaultColorNodes()
   // from the editors
   this->AddUserFileNodes();
 
+  if (this->LazyDefaultColorNodes)
+  {
+    // The default nodes are expected to be found in the scene, create them now.
+    // The returned IDs may point to a shared temporary string, so copy them first.
+    std::vector<std::string> defaultNodeIDs;
+    defaultNodeIDs.emplace_back(vtkMRMLColorLogic::GetColorTableNodeID(vtkMRMLColorTableNode::Labels));
+    const char* (vtkMRMLColorLogic::*defaultNodeIDGetters[])() = {
+      &vtkMRMLColorLogic::GetDefaultVolumeColorNodeID,
+      &vtkMRMLColorLogic::GetDefaultLabelMapColorNodeID,
+      &vtkMRMLColorLogic::GetDefaultEditorColorNodeID,
+      &vtkMRMLColorLogic::GetDefaultModelColorNodeID,
+      &vtkMRMLColorLogic::GetDefaultChartColorNodeID,
+      &vtkMRMLColorLogic::GetDefaultPlotColorNodeID };
+    for (auto getter : defaultNodeIDGetters)
+    {
+      const char* nodeID = (this->*getter)();
+      if (nodeID)
+      {
+        defaultNodeIDs.emplace_back(nodeID);
+      }
+    }
+    for (const std::string& nodeID : defaultNodeIDs)
+    {
+      this->MaterializeDefaultColorNode(nodeID.c_str());
+    }
+    vtkDebugMacro("AddDefaultColorNodes: " << this->PendingDefaultColorNodes.size() << " default color nodes are pending");
+  }
+
   vtkDebugMacro("Done adding default color nodes");
   this->GetMRMLScene()->EndState(vtkMRMLScene::BatchProcessState);
 }
@@ -164,6 +209,9 @@ void vtkMRMLColorLogic::RemoveDefaultColorNodes()
     return;
   }
 
+  // pending nodes are simply forgotten
+  this->PendingDefaultColorNodes.clear();
+
   this->GetMRMLScene()->StartState(vtkMRMLScene::BatchProcessState);
 
   vtkMRMLColorTableNode *basicNode = vtkMRMLColorTableNode::New();
@@ -253,6 +301,147 @@ void vtkMRMLColorLogic::RemoveDefaultColorNodes()
   this->GetMRMLScene()->EndState(vtkMRMLScene::BatchProcessState);
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLColorLogic::AddDefaultColorNode(const std::string& nodeID, std::function<vtkMRMLColorNode*()> creator)
+{
+  if (this->LazyDefaultColorNodes)
+  {
+    if (this->GetMRMLScene()->GetNodeByID(nodeID) == nullptr)
+    {
+      this->PendingDefaultColorNodes[nodeID] = creator;
+    }
+    return;
+  }
+  vtkMRMLColorNode* node = creator();
+  if (node == nullptr)
+  {
+    return;
+  }
+  this->GetMRMLScene()->AddNode(node);
+  vtkDebugMacro("AddDefaultColorNode: added node " << node->GetID() << ", requested id was " << nodeID);
+  node->Delete();
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLColorNode* vtkMRMLColorLogic::MaterializeDefaultColorNode(const char* nodeID)
+{
+  vtkMRMLScene* scene = this->GetMRMLScene();
+  if (scene == nullptr || nodeID == nullptr)
+  {
+    return nullptr;
+  }
+  // nodeID may point to TempColorNodeID that can be modified by the creator
+  std::string id(nodeID);
+  std::map<std::string, std::function<vtkMRMLColorNode*()> >::iterator pendingIt =
+    this->PendingDefaultColorNodes.find(id);
+  if (pendingIt == this->PendingDefaultColorNodes.end())
+  {
+    return vtkMRMLColorNode::SafeDownCast(scene->GetNodeByID(id));
+  }
+  if (std::this_thread::get_id() != this->MainThreadID)
+  {
+    // Nodes must not be added to the scene from worker threads
+    vtkErrorMacro("MaterializeDefaultColorNode: color node " << id << " can only be created in the main thread");
+    return nullptr;
+  }
+  std::function<vtkMRMLColorNode*()> creator = pendingIt->second;
+  this->PendingDefaultColorNodes.erase(pendingIt);
+
+  vtkSmartPointer<vtkMRMLColorNode> node = vtkSmartPointer<vtkMRMLColorNode>::Take(creator());
+  if (node == nullptr)
+  {
+    vtkWarningMacro("MaterializeDefaultColorNode: failed to create color node " << id);
+    return nullptr;
+  }
+  vtkMRMLColorNode* addedNode = vtkMRMLColorNode::SafeDownCast(scene->AddNode(node));
+  if (addedNode && id != addedNode->GetID())
+  {
+    vtkWarningMacro("MaterializeDefaultColorNode: node " << id << " was added with ID " << addedNode->GetID());
+  }
+  return addedNode;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLColorLogic::MaterializeDefaultColorNodes()
+{
+  if (this->GetMRMLScene() == nullptr || this->PendingDefaultColorNodes.empty())
+  {
+    return;
+  }
+  if (std::this_thread::get_id() != this->MainThreadID)
+  {
+    vtkErrorMacro("MaterializeDefaultColorNodes: color nodes can only be created in the main thread");
+    return;
+  }
+  this->GetMRMLScene()->StartState(vtkMRMLScene::BatchProcessState);
+  while (!this->PendingDefaultColorNodes.empty())
+  {
+    std::string nodeID = this->PendingDefaultColorNodes.begin()->first;
+    this->MaterializeDefaultColorNode(nodeID.c_str());
+  }
+  this->GetMRMLScene()->EndState(vtkMRMLScene::BatchProcessState);
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLColorLogic::IsDefaultColorNodePending(const char* nodeID)
+{
+  return nodeID != nullptr
+    && this->PendingDefaultColorNodes.find(nodeID) != this->PendingDefaultColorNodes.end();
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLColorLogic::GetNumberOfPendingDefaultColorNodes()
+{
+  return static_cast<int>(this->PendingDefaultColorNodes.size());
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLColorLogic::ClearColorFileCache()
+{
+  this->ColorFileCache.clear();
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLColorNode* vtkMRMLColorLogic::CreateNodeFromColorFileCache(const char* fileName, const char* className)
+{
+  if (fileName == nullptr)
+  {
+    return nullptr;
+  }
+  std::map<std::string, ColorFileCacheEntry>::iterator cacheIt = this->ColorFileCache.find(fileName);
+  if (cacheIt == this->ColorFileCache.end())
+  {
+    return nullptr;
+  }
+  if (cacheIt->second.ModifiedTime != vtksys::SystemTools::ModifiedTime(fileName)
+    || !cacheIt->second.Node->IsA(className))
+  {
+    // file has changed since it was parsed
+    this->ColorFileCache.erase(cacheIt);
+    return nullptr;
+  }
+  vtkMRMLColorNode* node = vtkMRMLColorNode::SafeDownCast(cacheIt->second.Node->CreateNodeInstance());
+  node->Copy(cacheIt->second.Node);
+  vtkDebugMacro("CreateNodeFromColorFileCache: reused parsed color file " << fileName);
+  return node;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLColorLogic::AddNodeToColorFileCache(const char* fileName, vtkMRMLColorNode* node)
+{
+  if (fileName == nullptr || node == nullptr)
+  {
+    return;
+  }
+  ColorFileCacheEntry entry;
+  entry.ModifiedTime = vtksys::SystemTools::ModifiedTime(fileName);
+  entry.Node = vtkSmartPointer<vtkMRMLColorNode>::Take(vtkMRMLColorNode::SafeDownCast(node->CreateNodeInstance()));
+  entry.Node->Copy(node);
+  // the cached node is not in any scene, it must not refer to the storage node
+  entry.Node->SetAndObserveStorageNodeID(nullptr);
+  this->ColorFileCache[fileName] = entry;
+}
+
 //----------------------------------------------------------------------------
 const char *vtkMRMLColorLogic::GetColorTableNodeID(int type)
 {
@@ -639,7 +828,13 @@ std::vector<std::string> vtkMRMLColorLogic::FindUserColorFiles()
 //--------------------------------------------------------------------------------
 vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateFileNode(const char* fileName)
 {
-  vtkMRMLColorTableNode * ctnode =  vtkMRMLColorTableNode::New();
+  vtkMRMLColorTableNode * ctnode = vtkMRMLColorTableNode::SafeDownCast(
+    this->CreateNodeFromColorFileCache(fileName, "vtkMRMLColorTableNode"));
+  bool cached = (ctnode != nullptr);
+  if (!cached)
+  {
+    ctnode = vtkMRMLColorTableNode::New();
+  }
   ctnode->SetTypeToFile();
   ctnode->SaveWithSceneOff();
   ctnode->HideFromEditorsOn();
@@ -665,6 +860,14 @@ vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateFileNode(const char* fileName)
   {
     ctnode->SetName(basename.c_str());
   }
+  if (cached)
+  {
+    ctnode->SetFileName(fileName);
+    ctnode->SetSingletonTag(
+      this->GetFileColorNodeSingletonTag(fileName).c_str());
+    return ctnode;
+  }
+
   vtkDebugMacro("CreateFileNode: About to read user file " << fileName);
 
   if (ctnode->GetStorageNode()->ReadData(ctnode) == 0)
@@ -682,6 +885,7 @@ vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateFileNode(const char* fileName)
       return nullptr;
   }
   vtkDebugMacro("CreateFileNode: finished reading user file " << fileName);
+  this->AddNodeToColorFileCache(fileName, ctnode);
   ctnode->SetSingletonTag(
     this->GetFileColorNodeSingletonTag(fileName).c_str());
 
@@ -691,7 +895,13 @@ vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateFileNode(const char* fileName)
 //--------------------------------------------------------------------------------
 vtkMRMLProceduralColorNode* vtkMRMLColorLogic::CreateProceduralFileNode(const char* fileName)
 {
-  vtkMRMLProceduralColorNode * cpnode =  vtkMRMLProceduralColorNode::New();
+  vtkMRMLProceduralColorNode * cpnode = vtkMRMLProceduralColorNode::SafeDownCast(
+    this->CreateNodeFromColorFileCache(fileName, "vtkMRMLProceduralColorNode"));
+  bool cached = (cpnode != nullptr);
+  if (!cached)
+  {
+    cpnode = vtkMRMLProceduralColorNode::New();
+  }
   cpnode->SetTypeToFile();
   cpnode->SaveWithSceneOff();
   cpnode->HideFromEditorsOn();
@@ -719,6 +929,14 @@ vtkMRMLProceduralColorNode* vtkMRMLColorLogic::CreateProceduralFileNode(const ch
     cpnode->SetName(basename.c_str());
   }
 
+  if (cached)
+  {
+    cpnode->SetFileName(fileName);
+    cpnode->SetSingletonTag(
+      this->GetFileColorNodeSingletonTag(fileName).c_str());
+    return cpnode;
+  }
+
   vtkDebugMacro("CreateProceduralFileNode: About to read user file " << fileName);
 
   if (cpnode->GetStorageNode()->ReadData(cpnode) == 0)
@@ -734,6 +952,7 @@ vtkMRMLProceduralColorNode* vtkMRMLColorLogic::CreateProceduralFileNode(const ch
       return nullptr;
   }
   vtkDebugMacro("CreateProceduralFileNode: finished reading user procedural color file " << fileName);
+  this->AddNodeToColorFileCache(fileName, cpnode);
   cpnode->SetSingletonTag(
     this->GetFileColorNodeSingletonTag(fileName).c_str());
 
@@ -743,122 +962,84 @@ vtkMRMLProceduralColorNode* vtkMRMLColorLogic::CreateProceduralFileNode(const ch
 //----------------------------------------------------------------------------------------
 void vtkMRMLColorLogic::AddLabelsNode()
 {
-  vtkMRMLColorTableNode* labelsNode = this->CreateLabelsNode();
-  //if (this->GetMRMLScene()->GetNodeByID(labelsNode->GetSingletonTag()) == nullptr)
-  {
-    //this->GetMRMLScene()->RequestNodeID(labelsNode, labelsNode->GetSingletonTag());
-    this->GetMRMLScene()->AddNode(labelsNode);
-  }
-  labelsNode->Delete();
+  this->AddDefaultColorNode(vtkMRMLColorLogic::GetColorTableNodeID(vtkMRMLColorTableNode::Labels),
+    [this]() -> vtkMRMLColorNode* { return this->CreateLabelsNode(); });
 }
 
 //----------------------------------------------------------------------------------------
 void vtkMRMLColorLogic::AddDefaultTableNode(int i)
 {
-  vtkMRMLColorTableNode* node = this->CreateDefaultTableNode(i);
-  //if (node->GetSingletonTag())
-  {
-    //if (this->GetMRMLScene()->GetNodeByID(node->GetSingletonTag()) == nullptr)
-    {
-      vtkDebugMacro("vtkMRMLColorLogic::AddDefaultColorNodes: requesting id " << node->GetSingletonTag() << endl);
-      //this->GetMRMLScene()->RequestNodeID(node, node->GetSingletonTag());
-      this->GetMRMLScene()->AddNode(node);
-      vtkDebugMacro("vtkMRMLColorLogic::AddDefaultColorNodes: added node " << node->GetID() << ", requested id was " << node->GetSingletonTag() << ", type = " << node->GetTypeAsString() << endl);
-    }
-    //else
-    //  {
-    //  vtkDebugMacro("vtkMRMLColorLogic::AddDefaultColorNodes: didn't add node " << node->GetID() << " as it was already in the scene.\n");
-    //  }
-  }
-  node->Delete();
+  vtkDebugMacro("vtkMRMLColorLogic::AddDefaultColorNodes: adding table node of type " << i);
+  this->AddDefaultColorNode(vtkMRMLColorLogic::GetColorTableNodeID(i),
+    [this, i]() -> vtkMRMLColorNode* { return this->CreateDefaultTableNode(i); });
 }
 
 //----------------------------------------------------------------------------------------
 void vtkMRMLColorLogic::AddDefaultProceduralNodes()
 {
   // random one
-  vtkMRMLProceduralColorNode* randomNode = this->CreateRandomNode();
-  this->GetMRMLScene()->AddNode(randomNode);
-  randomNode->Delete();
+  this->AddDefaultColorNode(vtkMRMLColorLogic::GetProceduralColorNodeID("RandomIntegers"),
+    [this]() -> vtkMRMLColorNode* { return this->CreateRandomNode(); });
 
   // red green blue one
-  vtkMRMLProceduralColorNode* rgbNode = this->CreateRedGreenBlueNode();
-  this->GetMRMLScene()->AddNode(rgbNode);
-  rgbNode->Delete();
+  this->AddDefaultColorNode(vtkMRMLColorLogic::GetProceduralColorNodeID("RedGreenBlue"),
+    [this]() -> vtkMRMLColorNode* { return this->CreateRedGreenBlueNode(); });
 }
 
 //----------------------------------------------------------------------------------------
 void vtkMRMLColorLogic::AddPETNode(int type)
 {
   vtkDebugMacro("AddDefaultColorNodes: adding PET nodes");
-  vtkMRMLPETProceduralColorNode *nodepcn = this->CreatePETColorNode(type);
-  //if (this->GetMRMLScene()->GetNodeByID( nodepcn->GetSingletonTag() ) == nullptr)
-  {
-    //this->GetMRMLScene()->RequestNodeID(nodepcn, nodepcn->GetSingletonTag() );
-    this->GetMRMLScene()->AddNode(nodepcn);
-  }
-  nodepcn->Delete();
+  this->AddDefaultColorNode(vtkMRMLColorLogic::GetPETColorNodeID(type),
+    [this, type]() -> vtkMRMLColorNode* { return this->CreatePETColorNode(type); });
 }
 
 //----------------------------------------------------------------------------------------
 void vtkMRMLColorLogic::AddDGEMRICNode(int type)
 {
   vtkDebugMacro("AddDefaultColorNodes: adding dGEMRIC nodes");
-  vtkMRMLdGEMRICProceduralColorNode *pcnode = this->CreatedGEMRICColorNode(type);
-  //if (this->GetMRMLScene()->GetNodeByID(pcnode->GetSingletonTag()) == nullptr)
-  {
-    //this->GetMRMLScene()->RequestNodeID(pcnode, pcnode->GetSingletonTag());
-    this->GetMRMLScene()->AddNode(pcnode);
-  }
-  pcnode->Delete();
+  this->AddDefaultColorNode(vtkMRMLColorLogic::GetdGEMRICColorNodeID(type),
+    [this, type]() -> vtkMRMLColorNode* { return this->CreatedGEMRICColorNode(type); });
 }
 
 //----------------------------------------------------------------------------------------
 void vtkMRMLColorLogic::AddDefaultFileNode(int i)
 {
-  vtkMRMLColorTableNode* ctnode =  this->CreateDefaultFileNode(this->ColorFiles[i]);
-  if (ctnode)
-  {
-    //if (this->GetMRMLScene()->GetNodeByID(ctnode->GetSingletonTag()) == nullptr)
+  std::string fileName = this->ColorFiles[i];
+  this->AddDefaultColorNode(vtkMRMLColorLogic::GetFileColorNodeID(fileName.c_str()),
+    [this, fileName]() -> vtkMRMLColorNode*
     {
-        //this->GetMRMLScene()->RequestNodeID(ctnode, ctnode->GetSingletonTag());
-        this->GetMRMLScene()->AddNode(ctnode);
-        ctnode->Delete();
-        vtkDebugMacro("AddDefaultColorFiles: Read and added file node: " <<  this->ColorFiles[i].c_str());
-    }
-    //else
-    //  {
-    //  vtkDebugMacro("AddDefaultColorFiles: node " << ctnode->GetSingletonTag() << " already in scene");
-    //  }
-  }
-  else
-  {
-    vtkWarningMacro("Unable to read color file " << this->ColorFiles[i].c_str());
-  }
+      vtkMRMLColorTableNode* ctnode = this->CreateDefaultFileNode(fileName);
+      if (ctnode)
+      {
+        vtkDebugMacro("AddDefaultColorFiles: Read file node: " << fileName);
+      }
+      else
+      {
+        vtkWarningMacro("Unable to read color file " << fileName);
+      }
+      return ctnode;
+    });
 }
 
 //----------------------------------------------------------------------------------------
 void vtkMRMLColorLogic::AddUserFileNode(int i)
 {
-  vtkMRMLColorTableNode* ctnode = this->CreateUserFileNode(this->UserColorFiles[i]);
-  if (ctnode)
-  {
-    //if (this->GetMRMLScene()->GetNodeByID(ctnode->GetSingletonTag()) == nullptr)
+  std::string fileName = this->UserColorFiles[i];
+  this->AddDefaultColorNode(vtkMRMLColorLogic::GetFileColorNodeID(fileName.c_str()),
+    [this, fileName]() -> vtkMRMLColorNode*
     {
-      //this->GetMRMLScene()->RequestNodeID(ctnode, ctnode->GetSingletonTag());
-      this->GetMRMLScene()->AddNode(ctnode);
-      vtkDebugMacro("AddDefaultColorFiles: Read and added user file node: " <<  this->UserColorFiles[i].c_str());
-    }
-    //else
-    //  {
-    //  vtkDebugMacro("AddDefaultColorFiles: node " << ctnode->GetSingletonTag() << " already in scene");
-    //  }
-  }
-  else
-  {
-    vtkWarningMacro("Unable to read user color file " << this->UserColorFiles[i].c_str());
-  }
-  ctnode->Delete();
+      vtkMRMLColorTableNode* ctnode = this->CreateUserFileNode(fileName);
+      if (ctnode)
+      {
+        vtkDebugMacro("AddDefaultColorFiles: Read user file node: " << fileName);
+      }
+      else
+      {
+        vtkWarningMacro("Unable to read user color file " << fileName);
+      }
+      return ctnode;
+    });
 }
 
 //----------------------------------------------------------------------------------------
@@ -22,8 +22,14 @@ class vtkMRMLPETProceduralColorNode;
 class vtkMRMLdGEMRICProceduralColorNode;
 class vtkMRMLColorTableNode;
 
+// VTK includes
+#include <vtkSmartPointer.h>
+
 // STD includes
 #include <cstdlib>
+#include <functional>
+#include <map>
+#include <thread>
 #include <vector>
 
 /// \brief MRML logic class for color manipulation.
@@ -128,8 +134,52 @@ public:
   /// \sa AddDGEMRICNodes()
   /// \sa AddDefaultFileNodes()
   /// \sa AddUserFileNodes()
+  /// \sa LazyDefaultColorNodes
   virtual void AddDefaultColorNodes();
 
+  /// \brief Defer creation of the default color nodes until they are used.
+  ///
+  /// When enabled, AddDefaultColorNodes() only registers the default color
+  /// nodes: each one is created (and its color file parsed) the first time
+  /// MaterializeDefaultColorNode() is called with its ID. The nodes returned
+  /// by the GetDefault*ColorNodeID() methods and the Labels node are always
+  /// created immediately. All pending nodes are created before a scene is
+  /// imported so that references to them can be resolved.
+  /// Must be set before the scene is set. Disabled by default.
+  vtkSetMacro(LazyDefaultColorNodes, bool);
+  vtkGetMacro(LazyDefaultColorNodes, bool);
+  vtkBooleanMacro(LazyDefaultColorNodes, bool);
+
+  /// \brief Make sure the default color node with the given ID is in the scene.
+  ///
+  /// Creates and adds the node if it has been registered but not created yet.
+  /// Returns the node from the scene, or nullptr if the ID does not
+  /// correspond to any node in the scene or any pending default color node.
+  /// Pending nodes are only created if the method is called from the main thread
+  /// (the thread that created the logic), as nodes must not be added to the scene
+  /// from other threads. Node lookups in the scene never create pending nodes.
+  /// \sa LazyDefaultColorNodes, MaterializeDefaultColorNodes()
+  vtkMRMLColorNode* MaterializeDefaultColorNode(const char* nodeID);
+
+  /// Add all the pending default color nodes to the scene.
+  /// Typically called before showing the full list of color nodes to the user.
+  /// \sa MaterializeDefaultColorNode()
+  void MaterializeDefaultColorNodes();
+
+  /// Return true if the default color node with the given ID is registered
+  /// but not created yet.
+  bool IsDefaultColorNodePending(const char* nodeID);
+
+  /// Return the number of default color nodes that are registered but not created yet.
+  int GetNumberOfPendingDefaultColorNodes();
+
+  /// \brief Clear the cache of parsed color files.
+  ///
+  /// Color files are parsed only once: the resulting colors are kept and reused
+  /// when the default color nodes are re-created (for example after the scene
+  /// is cleared), as long as the file modification time does not change.
+  void ClearColorFileCache();
+
   /// \brief Remove default color nodes.
   ///
   /// \sa AddDefaultColorNodes()
@@ -220,6 +270,23 @@ protected:
   /// We add the default LUTs.
   virtual void OnMRMLSceneNewEvent();
 
+  /// Reimplemented to create pending default color nodes before import,
+  /// as the imported nodes may reference them.
+  void OnMRMLSceneStartImport() override;
+
+  /// Register a default color node. The node is either created and added to
+  /// the scene immediately or, if LazyDefaultColorNodes is enabled, when
+  /// MaterializeDefaultColorNode() is called.
+  /// The creator function returns a new reference (or nullptr on failure).
+  void AddDefaultColorNode(const std::string& nodeID, std::function<vtkMRMLColorNode*()> creator);
+
+  /// Return a node created from the cache of parsed color files or nullptr
+  /// if the file has not been parsed yet or it has been modified since.
+  vtkMRMLColorNode* CreateNodeFromColorFileCache(const char* fileName, const char* className);
+
+  /// Store the content of a successfully parsed color file node.
+  void AddNodeToColorFileCache(const char* fileName, vtkMRMLColorNode* node);
+
   vtkMRMLColorTableNode* CreateLabelsNode();
   vtkMRMLColorTableNode* CreateDefaultTableNode(int type);
   vtkMRMLProceduralColorNode* CreateRandomNode();
@@ -268,6 +335,23 @@ protected:
 
   static std::string TempColorNodeID;
 
+  bool LazyDefaultColorNodes;
+
+  /// Creator functions of the registered default color nodes that are not
+  /// in the scene yet, indexed by node ID.
+  std::map<std::string, std::function<vtkMRMLColorNode*()> > PendingDefaultColorNodes;
+
+  /// Thread that created the logic. Pending default color nodes are only created in this thread.
+  std::thread::id MainThreadID;
+
+  struct ColorFileCacheEntry
+  {
+    long ModifiedTime;
+    vtkSmartPointer<vtkMRMLColorNode> Node;
+  };
+  /// Parsed color files, indexed by file name. It is not cleared with the scene.
+  std::map<std::string, ColorFileCacheEntry> ColorFileCache;
+
   std::string RemoveLeadAndTrailSpaces(std::string);
 };
 
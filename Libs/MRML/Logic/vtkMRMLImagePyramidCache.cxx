@@ -0,0 +1,720 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkMRMLImagePyramidCache.h"
+
+// MRML includes
+#include <vtkEventBroker.h>
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMatrix3x3.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// The singleton instance.
+// This MUST be default initialized to zero by the compiler and is
+// therefore not initialized here. The ClassInitialize and
+// ClassFinalize methods handle this instance.
+static vtkMRMLImagePyramidCache* vtkMRMLImagePyramidCacheInstance;
+
+//----------------------------------------------------------------------------
+// Must NOT be initialized. Default initialization to zero is necessary.
+unsigned int vtkMRMLImagePyramidCacheInitialize::Count;
+
+//----------------------------------------------------------------------------
+vtkMRMLImagePyramidCacheInitialize::vtkMRMLImagePyramidCacheInitialize()
+{
+  if (++Self::Count == 1)
+  {
+    vtkMRMLImagePyramidCache::classInitialize();
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLImagePyramidCacheInitialize::~vtkMRMLImagePyramidCacheInitialize()
+{
+  if (--Self::Count == 0)
+  {
+    vtkMRMLImagePyramidCache::classFinalize();
+  }
+}
+
+//----------------------------------------------------------------------------
+namespace
+{
+const int MAXIMUM_NUMBER_OF_LEVELS = 16;
+
+struct ImagePyramid
+{
+  /// Only accessed from the main thread.
+  vtkWeakPointer<vtkImageData> Image;
+  vtkMTimeType ImageMTime{ 0 };
+  unsigned long LastAccess{ 0 };
+  /// Levels[i] is pyramid level i+1 (level 0 is the image itself).
+  std::vector<vtkSmartPointer<vtkImageData>> Levels;
+};
+
+struct BuildJob
+{
+  vtkImageData* Key{ nullptr };
+  vtkMTimeType ImageMTime{ 0 };
+  /// Image of level SourceLevel. For level 0 it is a deep copy of the input image,
+  /// because voxels of the original image may be modified in place (for example, by
+  /// segment editor effects) while the background thread reads them.
+  vtkSmartPointer<vtkImageData> Source;
+  int SourceLevel{ 0 };
+  int RequestedLevel{ 0 };
+};
+
+//----------------------------------------------------------------------------
+template <class T>
+inline T RoundToScalarType(double value, std::true_type vtkNotUsed(isInteger))
+{
+  return static_cast<T>(std::floor(value + 0.5));
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+inline T RoundToScalarType(double value, std::false_type vtkNotUsed(isInteger))
+{
+  return static_cast<T>(value);
+}
+
+//----------------------------------------------------------------------------
+/// Average blocks of factors[0] x factors[1] x factors[2] voxels
+/// (blocks at the image boundary may be incomplete).
+template <class T>
+void DownsampleImage(vtkImageData* input, vtkImageData* output, const int factors[3])
+{
+  int inDims[3] = { 0, 0, 0 };
+  input->GetDimensions(inDims);
+  int outDims[3] = { 0, 0, 0 };
+  output->GetDimensions(outDims);
+  const int numberOfComponents = input->GetNumberOfScalarComponents();
+  const vtkIdType inIncY = static_cast<vtkIdType>(inDims[0]) * numberOfComponents;
+  const vtkIdType inIncZ = inIncY * inDims[1];
+  const T* inPtr = static_cast<const T*>(input->GetScalarPointer());
+  T* outPtr = static_cast<T*>(output->GetScalarPointer());
+  const vtkIdType outIncY = static_cast<vtkIdType>(outDims[0]) * numberOfComponents;
+  const vtkIdType outIncZ = outIncY * outDims[1];
+
+  vtkSMPTools::For(0, outDims[2], [&](vtkIdType beginZ, vtkIdType endZ)
+  {
+    std::vector<double> sums(numberOfComponents);
+    for (vtkIdType outZ = beginZ; outZ < endZ; ++outZ)
+    {
+      const int inZ0 = static_cast<int>(outZ) * factors[2];
+      const int inZ1 = std::min(inZ0 + factors[2], inDims[2]);
+      for (int outY = 0; outY < outDims[1]; ++outY)
+      {
+        const int inY0 = outY * factors[1];
+        const int inY1 = std::min(inY0 + factors[1], inDims[1]);
+        T* outVoxelPtr = outPtr + outZ * outIncZ + outY * outIncY;
+        for (int outX = 0; outX < outDims[0]; ++outX)
+        {
+          const int inX0 = outX * factors[0];
+          const int inX1 = std::min(inX0 + factors[0], inDims[0]);
+          std::fill(sums.begin(), sums.end(), 0.0);
+          int count = 0;
+          for (int inZ = inZ0; inZ < inZ1; ++inZ)
+          {
+            for (int inY = inY0; inY < inY1; ++inY)
+            {
+              const T* inVoxelPtr = inPtr + inZ * inIncZ + inY * inIncY + static_cast<vtkIdType>(inX0) * numberOfComponents;
+              for (int inX = inX0; inX < inX1; ++inX)
+              {
+                for (int c = 0; c < numberOfComponents; ++c)
+                {
+                  sums[c] += static_cast<double>(*(inVoxelPtr++));
+                }
+                count++;
+              }
+            }
+          }
+          for (int c = 0; c < numberOfComponents; ++c)
+          {
+            *(outVoxelPtr++) = RoundToScalarType<T>(sums[c] / count, typename std::is_integral<T>::type());
+          }
+        }
+      }
+    }
+  });
+}
+
+//----------------------------------------------------------------------------
+/// Get dimensions of the next pyramid level. Returns false if the image cannot be reduced.
+bool GetNextLevelDimensions(const int dims[3], int nextDims[3], int factors[3])
+{
+  bool reduced = false;
+  for (int i = 0; i < 3; ++i)
+  {
+    factors[i] = (dims[i] > 1 ? 2 : 1);
+    nextDims[i] = (dims[i] + factors[i] - 1) / factors[i];
+    reduced = reduced || (nextDims[i] != dims[i]);
+  }
+  return reduced;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType GetLevelMemorySize(vtkImageData* level)
+{
+  vtkDataArray* scalars = level ? level->GetPointData()->GetScalars() : nullptr;
+  if (!scalars)
+  {
+    return 0;
+  }
+  return static_cast<vtkIdType>(scalars->GetDataSize()) * scalars->GetDataTypeSize();
+}
+}
+
+//----------------------------------------------------------------------------
+class vtkMRMLImagePyramidCache::vtkInternal
+{
+public:
+  vtkInternal(vtkMRMLImagePyramidCache* external)
+    : External(external)
+  {
+  }
+
+  ~vtkInternal()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->StopWorker = true;
+      this->Jobs.clear();
+    }
+    this->JobsCondition.notify_all();
+    if (this->Worker.joinable())
+    {
+      this->Worker.join();
+    }
+  }
+
+  /// Compute the next pyramid level. Only uses objects that are private to the
+  /// calling thread, therefore it may be called from the background thread.
+  static vtkSmartPointer<vtkImageData> ComputeNextLevel(vtkImageData* input)
+  {
+    int inDims[3] = { 0, 0, 0 };
+    input->GetDimensions(inDims);
+    int outDims[3] = { 0, 0, 0 };
+    int factors[3] = { 1, 1, 1 };
+    if (!GetNextLevelDimensions(inDims, outDims, factors))
+    {
+      return nullptr;
+    }
+
+    // Center of the first output voxel, in the index space of the input image
+    int* inExtent = input->GetExtent();
+    double firstVoxelCenterIndex[3] = { 0.0, 0.0, 0.0 };
+    double outSpacing[3] = { 0.0, 0.0, 0.0 };
+    for (int i = 0; i < 3; ++i)
+    {
+      firstVoxelCenterIndex[i] = inExtent[2 * i] + (factors[i] - 1) * 0.5;
+      outSpacing[i] = input->GetSpacing()[i] * factors[i];
+    }
+    double outOrigin[3] = { 0.0, 0.0, 0.0 };
+    input->TransformContinuousIndexToPhysicalPoint(firstVoxelCenterIndex, outOrigin);
+
+    vtkSmartPointer<vtkImageData> output = vtkSmartPointer<vtkImageData>::New();
+    output->SetExtent(0, outDims[0] - 1, 0, outDims[1] - 1, 0, outDims[2] - 1);
+    output->SetSpacing(outSpacing);
+    output->SetOrigin(outOrigin);
+    output->SetDirectionMatrix(input->GetDirectionMatrix());
+    output->AllocateScalars(input->GetScalarType(), input->GetNumberOfScalarComponents());
+    vtkDataArray* inScalars = input->GetPointData()->GetScalars();
+    if (inScalars->GetName())
+    {
+      output->GetPointData()->GetScalars()->SetName(inScalars->GetName());
+    }
+
+    switch (input->GetScalarType())
+    {
+      vtkTemplateMacro(DownsampleImage<VTK_TT>(input, output, factors));
+      default:
+        return nullptr;
+    }
+    return output;
+  }
+
+  /// Returns the pyramid of the image. Discards levels that belong to a previous state of the image.
+  /// Must be called from the main thread with the mutex locked.
+  ImagePyramid& GetPyramid(vtkImageData* image)
+  {
+    ImagePyramid& pyramid = this->Pyramids[image];
+    if (pyramid.Image.GetPointer() != image || pyramid.ImageMTime != image->GetMTime())
+    {
+      this->ReleaseLevels(pyramid);
+      pyramid.Image = image;
+      pyramid.ImageMTime = image->GetMTime();
+    }
+    pyramid.LastAccess = ++this->AccessCounter;
+    return pyramid;
+  }
+
+  /// Must be called with the mutex locked.
+  void ReleaseLevels(ImagePyramid& pyramid)
+  {
+    for (const vtkSmartPointer<vtkImageData>& level : pyramid.Levels)
+    {
+      this->MemorySize -= GetLevelMemorySize(level);
+    }
+    pyramid.Levels.clear();
+  }
+
+  /// Release levels of least recently used pyramids until the requested memory becomes available.
+  /// Entries are not removed (as they contain weak pointers that may only be accessed
+  /// from the main thread), only their levels are released.
+  /// Must be called with the mutex locked.
+  bool ReserveMemory(vtkIdType requestedSize, vtkImageData* keepKey)
+  {
+    const double maximumMemorySize = this->External->MaximumMemorySizeMB * 1024.0 * 1024.0;
+    while (this->MemorySize + requestedSize > maximumMemorySize)
+    {
+      std::map<vtkImageData*, ImagePyramid>::iterator oldestIt = this->Pyramids.end();
+      for (std::map<vtkImageData*, ImagePyramid>::iterator pyramidIt = this->Pyramids.begin();
+        pyramidIt != this->Pyramids.end(); ++pyramidIt)
+      {
+        if (pyramidIt->first == keepKey || pyramidIt->second.Levels.empty())
+        {
+          continue;
+        }
+        if (oldestIt == this->Pyramids.end() || pyramidIt->second.LastAccess < oldestIt->second.LastAccess)
+        {
+          oldestIt = pyramidIt;
+        }
+      }
+      if (oldestIt == this->Pyramids.end())
+      {
+        return false;
+      }
+      this->ReleaseLevels(oldestIt->second);
+    }
+    return true;
+  }
+
+  /// Remove pyramids of deleted images. Must be called from the main thread with the mutex locked.
+  void RemoveDeletedImages()
+  {
+    for (std::map<vtkImageData*, ImagePyramid>::iterator pyramidIt = this->Pyramids.begin();
+      pyramidIt != this->Pyramids.end();)
+    {
+      if (pyramidIt->second.Image.GetPointer() == nullptr)
+      {
+        this->ReleaseLevels(pyramidIt->second);
+        pyramidIt = this->Pyramids.erase(pyramidIt);
+      }
+      else
+      {
+        ++pyramidIt;
+      }
+    }
+  }
+
+  /// Compute levels of the job and store them in the pyramid.
+  /// Returns true if at least one level was added.
+  bool BuildLevels(BuildJob& job)
+  {
+    bool levelAdded = false;
+    vtkSmartPointer<vtkImageData> source = job.Source;
+    job.Source = nullptr;
+    for (int level = job.SourceLevel + 1; level <= job.RequestedLevel; ++level)
+    {
+      vtkSmartPointer<vtkImageData> nextLevel = ComputeNextLevel(source);
+      if (!nextLevel)
+      {
+        break;
+      }
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      std::map<vtkImageData*, ImagePyramid>::iterator pyramidIt = this->Pyramids.find(job.Key);
+      if (this->StopWorker
+        || pyramidIt == this->Pyramids.end()
+        || pyramidIt->second.ImageMTime != job.ImageMTime
+        || static_cast<int>(pyramidIt->second.Levels.size()) != level - 1)
+      {
+        // The image has been modified or removed meanwhile,
+        // or the level has been computed by another request.
+        break;
+      }
+      vtkIdType levelMemorySize = GetLevelMemorySize(nextLevel);
+      if (!this->ReserveMemory(levelMemorySize, job.Key))
+      {
+        break;
+      }
+      pyramidIt->second.Levels.push_back(nextLevel);
+      this->MemorySize += levelMemorySize;
+      levelAdded = true;
+      source = nextLevel;
+    }
+    return levelAdded;
+  }
+
+  void AddJob(const BuildJob& job)
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      // Only the latest request for an image is relevant
+      this->Jobs.erase(std::remove_if(this->Jobs.begin(), this->Jobs.end(),
+        [&job](const BuildJob& queuedJob) { return queuedJob.Key == job.Key; }), this->Jobs.end());
+      this->Jobs.push_back(job);
+      if (!this->Worker.joinable())
+      {
+        this->Worker = std::thread(&vtkInternal::ProcessJobs, this);
+      }
+    }
+    this->JobsCondition.notify_one();
+  }
+
+  /// Return true if a job is queued or running for the image.
+  /// Must be called with the mutex locked.
+  bool IsJobPending(vtkImageData* key, vtkMTimeType imageMTime, int requestedLevel)
+  {
+    if (this->RunningJobKey == key && this->RunningJobImageMTime == imageMTime
+      && this->RunningJobRequestedLevel >= requestedLevel)
+    {
+      return true;
+    }
+    for (const BuildJob& job : this->Jobs)
+    {
+      if (job.Key == key && job.ImageMTime == imageMTime && job.RequestedLevel >= requestedLevel)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Background thread main loop.
+  void ProcessJobs()
+  {
+    while (true)
+    {
+      BuildJob job;
+      {
+        std::unique_lock<std::mutex> lock(this->Mutex);
+        this->JobsCondition.wait(lock, [this] { return this->StopWorker || !this->Jobs.empty(); });
+        if (this->StopWorker)
+        {
+          return;
+        }
+        job = this->Jobs.front();
+        this->Jobs.pop_front();
+        this->RunningJobKey = job.Key;
+        this->RunningJobImageMTime = job.ImageMTime;
+        this->RunningJobRequestedLevel = job.RequestedLevel;
+      }
+
+      bool levelAdded = this->BuildLevels(job);
+
+      {
+        std::lock_guard<std::mutex> lock(this->Mutex);
+        this->RunningJobKey = nullptr;
+        this->RunningJobRequestedLevel = 0;
+      }
+      this->IdleCondition.notify_all();
+      if (levelAdded)
+      {
+        // Notify observers on the main thread (if the application has set up a main thread
+        // event queue, otherwise the new levels are used the next time they are requested).
+        vtkEventBroker::GetInstance()->RequestModified(this->External);
+      }
+    }
+  }
+
+  void WaitForJobs()
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->IdleCondition.wait(lock, [this] { return this->StopWorker || (this->Jobs.empty() && this->RunningJobKey == nullptr); });
+  }
+
+  vtkMRMLImagePyramidCache* External;
+
+  /// Protects all members below
+  std::mutex Mutex;
+  std::map<vtkImageData*, ImagePyramid> Pyramids;
+  unsigned long AccessCounter{ 0 };
+  double MemorySize{ 0.0 };
+
+  std::deque<BuildJob> Jobs;
+  vtkImageData* RunningJobKey{ nullptr };
+  vtkMTimeType RunningJobImageMTime{ 0 };
+  int RunningJobRequestedLevel{ 0 };
+  std::condition_variable JobsCondition;
+  std::condition_variable IdleCondition;
+  bool StopWorker{ false };
+  std::thread Worker;
+};
+
+//----------------------------------------------------------------------------
+// Up the reference count so it behaves like New
+vtkMRMLImagePyramidCache* vtkMRMLImagePyramidCache::New()
+{
+  vtkMRMLImagePyramidCache* ret = vtkMRMLImagePyramidCache::GetInstance();
+  ret->Register(nullptr);
+  return ret;
+}
+
+//----------------------------------------------------------------------------
+// Return the single instance of the vtkMRMLImagePyramidCache
+vtkMRMLImagePyramidCache* vtkMRMLImagePyramidCache::GetInstance()
+{
+  if (!vtkMRMLImagePyramidCacheInstance)
+  {
+    // Try the factory first
+    vtkMRMLImagePyramidCacheInstance = (vtkMRMLImagePyramidCache*)
+      vtkObjectFactory::CreateInstance("vtkMRMLImagePyramidCache");
+    // if the factory did not provide one, then create it here
+    if (!vtkMRMLImagePyramidCacheInstance)
+    {
+      vtkMRMLImagePyramidCacheInstance = new vtkMRMLImagePyramidCache;
+#ifdef VTK_HAS_INITIALIZE_OBJECT_BASE
+      vtkMRMLImagePyramidCacheInstance->InitializeObjectBase();
+#endif
+    }
+  }
+  // return the instance
+  return vtkMRMLImagePyramidCacheInstance;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLImagePyramidCache::classInitialize()
+{
+  // Allocate the singleton
+  vtkMRMLImagePyramidCacheInstance = vtkMRMLImagePyramidCache::GetInstance();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLImagePyramidCache::classFinalize()
+{
+  vtkMRMLImagePyramidCacheInstance->Delete();
+  vtkMRMLImagePyramidCacheInstance = nullptr;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLImagePyramidCache::vtkMRMLImagePyramidCache()
+{
+  this->MaximumMemorySizeMB = 1024.0;
+  this->MinimumLevelSize = 64;
+  this->Internal = new vtkInternal(this);
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLImagePyramidCache::~vtkMRMLImagePyramidCache()
+{
+  delete this->Internal;
+  this->Internal = nullptr;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLImagePyramidCache::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "MaximumMemorySizeMB: " << this->MaximumMemorySizeMB << "\n";
+  os << indent << "MinimumLevelSize: " << this->MinimumLevelSize << "\n";
+  os << indent << "NumberOfCachedImages: " << this->GetNumberOfCachedImages() << "\n";
+  os << indent << "MemorySizeMB: " << this->GetMemorySizeMB() << "\n";
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLImagePyramidCache::GetLevelForSamplingStep(double samplingStep)
+{
+  if (samplingStep < 2.0)
+  {
+    return 0;
+  }
+  return std::min(static_cast<int>(std::floor(std::log2(samplingStep))), MAXIMUM_NUMBER_OF_LEVELS - 1);
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLImagePyramidCache::GetMaximumNumberOfLevels(vtkImageData* image)
+{
+  if (!image || !image->GetPointData() || !image->GetPointData()->GetScalars()
+    || image->GetNumberOfPoints() < 1)
+  {
+    return 0;
+  }
+  int dims[3] = { 0, 0, 0 };
+  image->GetDimensions(dims);
+  int numberOfLevels = 1;
+  while (numberOfLevels < MAXIMUM_NUMBER_OF_LEVELS)
+  {
+    int nextDims[3] = { 0, 0, 0 };
+    int factors[3] = { 1, 1, 1 };
+    if (!GetNextLevelDimensions(dims, nextDims, factors)
+      || std::max(nextDims[0], std::max(nextDims[1], nextDims[2])) < this->MinimumLevelSize)
+    {
+      break;
+    }
+    std::copy(nextDims, nextDims + 3, dims);
+    numberOfLevels++;
+  }
+  return numberOfLevels;
+}
+
+//----------------------------------------------------------------------------
+vtkImageData* vtkMRMLImagePyramidCache::GetLevel(vtkImageData* image, int requestedLevel, int& level)
+{
+  level = 0;
+  requestedLevel = std::min(requestedLevel, this->GetMaximumNumberOfLevels(image) - 1);
+  if (requestedLevel <= 0)
+  {
+    return image;
+  }
+
+  BuildJob job;
+  vtkImageData* levelImage = image;
+  {
+    std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+    this->Internal->RemoveDeletedImages();
+    ImagePyramid& pyramid = this->Internal->GetPyramid(image);
+    int numberOfAvailableLevels = static_cast<int>(pyramid.Levels.size());
+    level = std::min(requestedLevel, numberOfAvailableLevels);
+    if (level > 0)
+    {
+      levelImage = pyramid.Levels[level - 1];
+    }
+    if (numberOfAvailableLevels >= requestedLevel
+      || this->Internal->IsJobPending(image, pyramid.ImageMTime, requestedLevel))
+    {
+      return levelImage;
+    }
+    job.Key = image;
+    job.ImageMTime = pyramid.ImageMTime;
+    job.SourceLevel = numberOfAvailableLevels;
+    job.RequestedLevel = requestedLevel;
+    if (numberOfAvailableLevels > 0)
+    {
+      job.Source = pyramid.Levels[numberOfAvailableLevels - 1];
+    }
+  }
+  if (!job.Source)
+  {
+    job.Source = vtkSmartPointer<vtkImageData>::New();
+    job.Source->DeepCopy(image);
+  }
+  this->Internal->AddJob(job);
+  return levelImage;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLImagePyramidCache::BuildLevels(vtkImageData* image, int requestedLevel)
+{
+  requestedLevel = std::min(requestedLevel, this->GetMaximumNumberOfLevels(image) - 1);
+  if (requestedLevel <= 0)
+  {
+    return image ? 1 : 0;
+  }
+  // Levels may be added by the background thread only in order, therefore it is simpler
+  // to let it complete before building the levels here.
+  this->Internal->WaitForJobs();
+  BuildJob job;
+  {
+    std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+    this->Internal->RemoveDeletedImages();
+    ImagePyramid& pyramid = this->Internal->GetPyramid(image);
+    job.Key = image;
+    job.ImageMTime = pyramid.ImageMTime;
+    job.SourceLevel = static_cast<int>(pyramid.Levels.size());
+    job.RequestedLevel = requestedLevel;
+    if (job.SourceLevel > 0)
+    {
+      job.Source = pyramid.Levels[job.SourceLevel - 1];
+    }
+  }
+  if (!job.Source)
+  {
+    job.Source = image;
+  }
+  this->Internal->BuildLevels(job);
+  return this->GetNumberOfAvailableLevels(image);
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLImagePyramidCache::GetNumberOfAvailableLevels(vtkImageData* image)
+{
+  if (!image)
+  {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  std::map<vtkImageData*, ImagePyramid>::iterator pyramidIt = this->Internal->Pyramids.find(image);
+  if (pyramidIt == this->Internal->Pyramids.end()
+    || pyramidIt->second.Image.GetPointer() != image
+    || pyramidIt->second.ImageMTime != image->GetMTime())
+  {
+    return 1;
+  }
+  return 1 + static_cast<int>(pyramidIt->second.Levels.size());
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLImagePyramidCache::RemoveImage(vtkImageData* image)
+{
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  std::map<vtkImageData*, ImagePyramid>::iterator pyramidIt = this->Internal->Pyramids.find(image);
+  if (pyramidIt == this->Internal->Pyramids.end())
+  {
+    return;
+  }
+  this->Internal->ReleaseLevels(pyramidIt->second);
+  this->Internal->Pyramids.erase(pyramidIt);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLImagePyramidCache::RemoveAllImages()
+{
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  this->Internal->Pyramids.clear();
+  this->Internal->MemorySize = 0.0;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLImagePyramidCache::GetNumberOfCachedImages()
+{
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  int numberOfCachedImages = 0;
+  for (const auto& pyramid : this->Internal->Pyramids)
+  {
+    if (!pyramid.second.Levels.empty())
+    {
+      numberOfCachedImages++;
+    }
+  }
+  return numberOfCachedImages;
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLImagePyramidCache::GetMemorySizeMB()
+{
+  std::lock_guard<std::mutex> lock(this->Internal->Mutex);
+  return this->Internal->MemorySize / (1024.0 * 1024.0);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLImagePyramidCache::WaitForBackgroundComputation()
+{
+  this->Internal->WaitForJobs();
+}
@@ -0,0 +1,143 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#ifndef __vtkMRMLImagePyramidCache_h
+#define __vtkMRMLImagePyramidCache_h
+
+// MRMLLogic includes
+#include "vtkMRMLLogicExport.h"
+
+// VTK includes
+#include <vtkObject.h>
+class vtkImageData;
+
+/// \brief Shared cache of reduced resolution versions of images.
+///
+/// Level 0 of the pyramid is the image itself, each further level is created
+/// by averaging 2x2x2 voxel blocks of the previous level (axes that have a
+/// single voxel are not reduced). Averaging acts as an anti-aliasing filter,
+/// therefore reslicing a coarser level gives a smoother result than
+/// sampling the full resolution image with large steps, and it reads much less
+/// memory.
+///
+/// Origin and spacing of each level is set so that physical coordinates
+/// are the same as in the full resolution image, so a level can replace
+/// the image as input of a reslice filter without changing the reslice transform.
+///
+/// Levels are computed in a background thread and a modified event is requested
+/// (see vtkEventBroker::RequestModified) on this object each time a new level
+/// becomes available. Levels are discarded when the image is modified.
+/// The background thread works on a copy of the full resolution image,
+/// which temporarily uses as much memory as the image itself.
+/// The total memory used by the levels is limited by MaximumMemorySizeMB,
+/// least recently used pyramids are removed first.
+///
+/// The cache is a singleton, use GetInstance() to access it.
+class VTK_MRML_LOGIC_EXPORT vtkMRMLImagePyramidCache : public vtkObject
+{
+public:
+  vtkTypeMacro(vtkMRMLImagePyramidCache, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Return the singleton instance with no reference counting.
+  static vtkMRMLImagePyramidCache* GetInstance();
+
+  /// This is a singleton pattern New. There will only be ONE
+  /// reference to a vtkMRMLImagePyramidCache object per process.
+  /// Clients that call this must call Delete on the object so that
+  /// the reference counting will work.
+  static vtkMRMLImagePyramidCache* New();
+
+  /// Get the finest available level that is not finer than the requested level.
+  /// Missing levels up to the requested level are scheduled to be computed in the background.
+  /// Returns the image itself (and sets \a level to 0) if no reduced resolution level is available yet.
+  vtkImageData* GetLevel(vtkImageData* image, int requestedLevel, int& level);
+
+  /// Compute all levels up to the requested level immediately.
+  /// Returns the number of levels that are available after the computation
+  /// (may be less than requested if the image is too small or the memory limit is reached).
+  int BuildLevels(vtkImageData* image, int requestedLevel);
+
+  /// Get the number of levels that are available for the current state of the image,
+  /// including level 0.
+  int GetNumberOfAvailableLevels(vtkImageData* image);
+
+  /// Get the number of levels that can be created for the image.
+  /// Levels are not reduced below MinimumLevelSize voxels along all axes.
+  int GetMaximumNumberOfLevels(vtkImageData* image);
+
+  /// Compute the pyramid level that matches a sampling step (distance between
+  /// neighbor samples, in voxels of the full resolution image).
+  static int GetLevelForSamplingStep(double samplingStep);
+
+  /// Remove cached levels of an image.
+  void RemoveImage(vtkImageData* image);
+
+  /// Remove all cached levels.
+  void RemoveAllImages();
+
+  /// Get the number of images that have levels in the cache.
+  int GetNumberOfCachedImages();
+
+  /// Get the memory used by all the cached levels.
+  double GetMemorySizeMB();
+
+  /// Maximum memory that all the cached levels may use.
+  /// Levels that do not fit are not created. Default is 1024MB.
+  vtkSetMacro(MaximumMemorySizeMB, double);
+  vtkGetMacro(MaximumMemorySizeMB, double);
+
+  /// Levels are not created if none of the image axes would have at least this many voxels.
+  /// Default is 64.
+  vtkSetMacro(MinimumLevelSize, int);
+  vtkGetMacro(MinimumLevelSize, int);
+
+  /// Wait until all background computations are completed.
+  /// Mostly useful for testing.
+  void WaitForBackgroundComputation();
+
+protected:
+  vtkMRMLImagePyramidCache();
+  ~vtkMRMLImagePyramidCache() override;
+  vtkMRMLImagePyramidCache(const vtkMRMLImagePyramidCache&);
+  void operator=(const vtkMRMLImagePyramidCache&);
+
+  /// Singleton management functions.
+  static void classInitialize();
+  static void classFinalize();
+
+  friend class vtkMRMLImagePyramidCacheInitialize;
+  typedef vtkMRMLImagePyramidCache Self;
+
+  double MaximumMemorySizeMB;
+  int MinimumLevelSize;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+  friend class vtkInternal;
+};
+
+/// Utility class to make sure vtkMRMLImagePyramidCache is initialized before it is used.
+class VTK_MRML_LOGIC_EXPORT vtkMRMLImagePyramidCacheInitialize
+{
+public:
+  typedef vtkMRMLImagePyramidCacheInitialize Self;
+
+  vtkMRMLImagePyramidCacheInitialize();
+  ~vtkMRMLImagePyramidCacheInitialize();
+private:
+  static unsigned int Count;
+};
+
+/// This instance will show up in any translation unit that uses
+/// vtkMRMLImagePyramidCache. It will make sure vtkMRMLImagePyramidCache
+/// is initialized before it is used.
+static vtkMRMLImagePyramidCacheInitialize vtkMRMLImagePyramidCacheInitializer;
+
+#endif
@@ -13,9 +13,11 @@
 =========================================================================auto=*/
 
 // MRMLLogic includes
+#include "vtkMRMLImagePyramidCache.h"
 #include "vtkMRMLSliceLayerLogic.h"
 
 // MRML includes
+#include "vtkEventBroker.h"
 #include "vtkMRMLLabelMapVolumeNode.h"
 #include "vtkMRMLLabelMapVolumeDisplayNode.h"
 #include "vtkMRMLVectorVolumeDisplayNode.h"
@@ -29,6 +31,7 @@
 #include <vtkAlgorithm.h>
 #include <vtkAlgorithmOutput.h>
 #include <vtkAssignAttribute.h>
+#include <vtkCallbackCommand.h>
 #include <vtkDiffusionTensorMathematics.h>
 #include <vtkFloatArray.h>
 #include <vtkGeneralTransform.h>
@@ -36,6 +39,7 @@
 #include <vtkImageReslice.h>
 #include <vtkInformation.h>
 #include <vtkInformationVector.h>
+#include <vtkMath.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
@@ -47,6 +51,7 @@
 
 //
 #include "vtkImageLabelOutline.h"
+#include "vtkImageProjectionReslice.h"
 
 // STD includes
 #include <algorithm>
@@ -122,7 +127,8 @@ vtkMRMLSliceLayerLogic::vtkMRMLSliceLayerLogic()
   this->AssignAttributeScalarsToTensorsUVW->Assign(vtkDataSetAttributes::SCALARS, vtkDataSetAttributes::TENSORS, vtkAssignAttribute::POINT_DATA);
 
   // Create the parts for the scalar layer pipeline
-  this->Reslice = vtkImageReslice::New();
+  // (thick slab reconstruction is computed by fast CPU projection when possible)
+  this->Reslice = vtkImageProjectionReslice::New();
   this->ResliceUVW = vtkImageReslice::New();
   this->LabelOutline = vtkImageLabelOutline::New();
   this->LabelOutlineUVW = vtkImageLabelOutline::New();
@@ -149,6 +155,17 @@ vtkMRMLSliceLayerLogic::vtkMRMLSliceLayerLogic()
   this->UpdatingTransforms = 0;
 
   this->InterpolationMode = VTK_RESLICE_LINEAR;
+
+  this->UseImagePyramid = false;
+  this->ImagePyramidMinimumNumberOfVoxels = 1 << 24;
+  this->ImagePyramidLevel = 0;
+  this->ImagePyramidRequestedLevel = 0;
+  this->ImagePyramidCallbackCommand = vtkCallbackCommand::New();
+  this->ImagePyramidCallbackCommand->SetClientData(this);
+  this->ImagePyramidCallbackCommand->SetCallback(vtkMRMLSliceLayerLogic::ImagePyramidModifiedCallback);
+  // The cache is neither a node nor a logic, therefore the logic callbacks cannot be used to observe it
+  vtkEventBroker::GetInstance()->AddObservation(
+    vtkMRMLImagePyramidCache::GetInstance(), vtkCommand::ModifiedEvent, this, this->ImagePyramidCallbackCommand);
 }
 
 //----------------------------------------------------------------------------
@@ -169,6 +186,10 @@ vtkMRMLSliceLayerLogic::~vtkMRMLSliceLayerLogic()
 
   this->SetSliceNode(nullptr);
   this->SetVolumeNode(nullptr);
+
+  vtkEventBroker::GetInstance()->RemoveObservations(
+    vtkMRMLImagePyramidCache::GetInstance(), vtkCommand::ModifiedEvent, this, this->ImagePyramidCallbackCommand);
+  this->ImagePyramidCallbackCommand->Delete();
   this->XYToIJKTransform->Delete();
   this->UVWToIJKTransform->Delete();
 
@@ -260,6 +281,13 @@ void vtkMRMLSliceLayerLogic::ProcessMRMLNodesEvents(vtkObject * caller,
         this->UpdateLogic();
       }
       break;
+    case vtkMRMLVolumeNode::ImageDataModifiedEvent:
+      if (caller == this->VolumeNode && this->ImagePyramidLevel > 0)
+      {
+        // The resliced pyramid level is not valid anymore
+        this->UpdateImageDisplay();
+      }
+      break;
     default:
       this->Superclass::ProcessMRMLNodesEvents(caller, event, callData);
       break;
@@ -315,6 +343,7 @@ void vtkMRMLSliceLayerLogic::SetVolumeNode(vtkMRMLVolumeNode *volumeNode)
 
   vtkNew<vtkIntArray> events;
   events->InsertNextValue(vtkMRMLTransformableNode::TransformModifiedEvent);
+  events->InsertNextValue(vtkMRMLVolumeNode::ImageDataModifiedEvent);
   events->InsertNextValue(vtkCommand::ModifiedEvent);
   vtkSetAndObserveMRMLNodeEventsMacro(this->VolumeNode, volumeNode, events.GetPointer());
 
@@ -501,6 +530,8 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
   this->XYToIJKTransform->Identity();
   this->UVWToIJKTransform->Identity();
 
+  this->ImagePyramidRequestedLevel = 0;
+
   this->XYToIJKTransform->PostMultiply();
   this->UVWToIJKTransform->PostMultiply();
 
@@ -545,6 +576,16 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
     {
       SnapToPermuteMatrix(linearXYToIJKTransform);
       this->Reslice->SetResliceTransform(linearXYToIJKTransform);
+
+      if (this->IsImagePyramidApplicable())
+      {
+        // Distance between neighbor pixels, in voxels
+        vtkMatrix4x4* xyToIJKMatrix = linearXYToIJKTransform->GetMatrix();
+        double pixelStepX[3] = { xyToIJKMatrix->GetElement(0, 0), xyToIJKMatrix->GetElement(1, 0), xyToIJKMatrix->GetElement(2, 0) };
+        double pixelStepY[3] = { xyToIJKMatrix->GetElement(0, 1), xyToIJKMatrix->GetElement(1, 1), xyToIJKMatrix->GetElement(2, 1) };
+        double samplingStep = std::min(vtkMath::Norm(pixelStepX), vtkMath::Norm(pixelStepY));
+        this->ImagePyramidRequestedLevel = vtkMRMLImagePyramidCache::GetLevelForSamplingStep(samplingStep);
+      }
     }
     else
     {
@@ -760,7 +801,7 @@ void vtkMRMLSliceLayerLogic::UpdateImageDisplay()
 //      {
 //      volumeNode->GetImageData()->Print(std::cout);
 //      }
-    this->Reslice->SetInputData(volumeNode->GetImageData());
+    this->Reslice->SetInputData(this->GetResliceInputImageData());
     this->ResliceUVW->SetInputData(volumeNode->GetImageData());
     // use the label outline if we have a label map volume, this is the label
     // layer (turned on in slice logic when the label layer is instantiated)
@@ -823,6 +864,60 @@ void vtkMRMLSliceLayerLogic::UpdateImageDisplay()
   }
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLSliceLayerLogic::IsImagePyramidApplicable()
+{
+  vtkImageData* imageData = this->VolumeNode ? this->VolumeNode->GetImageData() : nullptr;
+  if (!this->UseImagePyramid || !imageData
+    // Averaging is not applicable to labels and the other pipelines do not reslice scalars
+    || vtkMRMLLabelMapVolumeNode::SafeDownCast(this->VolumeNode)
+    || vtkMRMLDiffusionTensorVolumeNode::SafeDownCast(this->VolumeNode)
+    || vtkMRMLDiffusionWeightedVolumeNode::SafeDownCast(this->VolumeNode))
+  {
+    return false;
+  }
+  const char* pyramidAttribute = this->VolumeNode->GetAttribute("SliceLogic.ImagePyramid");
+  if (pyramidAttribute)
+  {
+    if (strcmp(pyramidAttribute, "0") == 0)
+    {
+      return false;
+    }
+    if (strcmp(pyramidAttribute, "1") == 0)
+    {
+      return true;
+    }
+  }
+  return imageData->GetNumberOfPoints() >= this->ImagePyramidMinimumNumberOfVoxels;
+}
+
+//----------------------------------------------------------------------------
+vtkImageData* vtkMRMLSliceLayerLogic::GetResliceInputImageData()
+{
+  vtkImageData* imageData = this->VolumeNode ? this->VolumeNode->GetImageData() : nullptr;
+  this->ImagePyramidLevel = 0;
+  if (!imageData || this->ImagePyramidRequestedLevel <= 0)
+  {
+    return imageData;
+  }
+  // Origin and spacing of the levels are set so that the reslice transform does not need to change.
+  return vtkMRMLImagePyramidCache::GetInstance()->GetLevel(
+    imageData, this->ImagePyramidRequestedLevel, this->ImagePyramidLevel);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLayerLogic::ImagePyramidModifiedCallback(vtkObject* vtkNotUsed(caller),
+  unsigned long vtkNotUsed(eid), void* clientData, void* vtkNotUsed(callData))
+{
+  vtkMRMLSliceLayerLogic* self = reinterpret_cast<vtkMRMLSliceLayerLogic*>(clientData);
+  if (!self || self->ImagePyramidLevel >= self->ImagePyramidRequestedLevel)
+  {
+    return;
+  }
+  // A finer level may have become available
+  self->UpdateImageDisplay();
+}
+
 //----------------------------------------------------------------------------
 vtkAlgorithmOutput* vtkMRMLSliceLayerLogic::GetSliceImageDataConnection()
 {
@@ -996,6 +1091,11 @@ void vtkMRMLSliceLayerLogic::PrintSelf(ostream& os, vtkIndent indent)
     os << indent << " (0)\n";
   }
 
+  os << indent << "UseImagePyramid: " << this->UseImagePyramid << "\n";
+  os << indent << "ImagePyramidMinimumNumberOfVoxels: " << this->ImagePyramidMinimumNumberOfVoxels << "\n";
+  os << indent << "ImagePyramidLevel: " << this->ImagePyramidLevel << "\n";
+  os << indent << "ImagePyramidRequestedLevel: " << this->ImagePyramidRequestedLevel << "\n";
+
   os << indent << "IsLabelLayer: " << this->GetIsLabelLayer() << "\n";
   os << indent << "LabelOutline:\n";
   if (this->LabelOutline)
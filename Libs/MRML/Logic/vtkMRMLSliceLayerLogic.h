@@ -48,6 +48,7 @@
 #include <vtkVersion.h>
 
 class vtkAssignAttribute;
+class vtkCallbackCommand;
 class vtkImageReslice;
 class vtkGeneralTransform;
 
@@ -85,7 +86,8 @@ public:
   void SetSliceNode (vtkMRMLSliceNode *SliceNode);
 
   ///
-  /// The image reslice or slice being used
+  /// The image reslice or slice being used.
+  /// Reslice is a vtkImageProjectionReslice, which computes thick slab reconstruction by fast CPU projection.
   vtkGetObjectMacro (Reslice, vtkImageReslice);
   vtkGetObjectMacro (ResliceUVW, vtkImageReslice);
 
@@ -135,6 +137,35 @@ public:
   vtkGetMacro(InterpolationMode, int);
   vtkSetMacro(InterpolationMode, int);
 
+  ///
+  /// Reslice a reduced resolution level of the volume (see vtkMRMLImagePyramidCache)
+  /// when the slice view is zoomed out so that a pixel covers multiple voxels.
+  /// It reduces aliasing and memory bandwidth. Levels are computed in the background,
+  /// until they are ready the full resolution volume is resliced.
+  /// Only used for scalar and vector volumes (not label maps and diffusion volumes)
+  /// that are not transformed by a non-linear transform, and only for the 2D slice pipeline.
+  /// Disabled by default.
+  vtkGetMacro(UseImagePyramid, bool);
+  vtkSetMacro(UseImagePyramid, bool);
+  vtkBooleanMacro(UseImagePyramid, bool);
+
+  ///
+  /// Image pyramid is only used for volumes that have at least this many voxels.
+  /// The volume node attribute "SliceLogic.ImagePyramid" can be set to "1" to use
+  /// the pyramid for a volume regardless of its size or to "0" to never use it.
+  /// Default is 2^24 (about 16 million voxels).
+  vtkGetMacro(ImagePyramidMinimumNumberOfVoxels, vtkIdType);
+  vtkSetMacro(ImagePyramidMinimumNumberOfVoxels, vtkIdType);
+
+  ///
+  /// Pyramid level of the volume that is currently resliced (0 is the full resolution image).
+  vtkGetMacro(ImagePyramidLevel, int);
+
+  ///
+  /// Pyramid level that matches the current slice view zoom.
+  /// ImagePyramidLevel is lower than this while the level is being computed.
+  vtkGetMacro(ImagePyramidRequestedLevel, int);
+
 protected:
   vtkMRMLSliceLayerLogic();
   ~vtkMRMLSliceLayerLogic() override;
@@ -158,6 +189,18 @@ protected:
   vtkAlgorithmOutput* GetSliceImageDataConnection();
   vtkAlgorithmOutput* GetSliceImageDataConnectionUVW();
 
+  /// Return true if the image pyramid may be used for the current volume.
+  bool IsImagePyramidApplicable();
+
+  /// Get the image that the 2D reslice pipeline uses as input:
+  /// the volume image or one of its reduced resolution levels.
+  /// Updates ImagePyramidLevel.
+  vtkImageData* GetResliceInputImageData();
+
+  /// Called when new levels of an image pyramid become available.
+  static void ImagePyramidModifiedCallback(vtkObject* caller, unsigned long eid,
+                                           void* clientData, void* callData);
+
   // Copy VolumeDisplayNodeObserved into VolumeDisplayNode
   void UpdateVolumeDisplayNode();
 
@@ -189,6 +232,12 @@ protected:
   int UpdatingTransforms;
 
   int InterpolationMode;
+
+  bool UseImagePyramid;
+  vtkIdType ImagePyramidMinimumNumberOfVoxels;
+  int ImagePyramidLevel;
+  int ImagePyramidRequestedLevel;
+  vtkCallbackCommand* ImagePyramidCallbackCommand;
 };
 
 #endif
@@ -34,6 +34,7 @@
 #include <vtkMRMLDisplayNode.h>
 #include <vtkMRMLScene.h>
 #include <vtkMRMLSelectionNode.h>
+#include <vtkMRMLTraceLogger.h>
 
 // VTK includes
 #include <vtkCollection.h>
@@ -707,6 +708,7 @@ bool qMRMLSceneModel::dropMimeData(const QMimeData *data, Qt::DropAction action,
 void qMRMLSceneModel::updateScene()
 {
   Q_D(qMRMLSceneModel);
+  MRML_TRACE_SCOPE_DETAIL("Widgets", "qMRMLSceneModel::updateScene", this->metaObject()->className());
 
   // Stop listening to all the nodes before we remove them (setRowCount) as some
   // weird behavior could arise when removing the nodes (e.g onMRMLNodeModified
@@ -1204,6 +1206,7 @@ void qMRMLSceneModel::onMRMLSceneNodeAboutToBeAdded(vtkMRMLScene* scene, vtkMRML
 void qMRMLSceneModel::onMRMLSceneNodeAdded(vtkMRMLScene* scene, vtkMRMLNode* node)
 {
   Q_D(qMRMLSceneModel);
+  MRML_TRACE_SCOPE_DETAIL("Widgets", "qMRMLSceneModel::onMRMLSceneNodeAdded", this->metaObject()->className());
   Q_UNUSED(d);
   Q_UNUSED(scene);
   Q_ASSERT(scene == d->MRMLScene);
@@ -0,0 +1,555 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// RemoteIO includes
+#include "vtkHTTPHandler.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkNew.h>
+
+// VTKSYS includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+typedef SOCKET SocketType;
+typedef int socklen_t;
+#define CloseSocket closesocket
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int SocketType;
+#define INVALID_SOCKET (-1)
+#define CloseSocket close
+#endif
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Minimal HTTP/1.1 server running on localhost, as a stand-in for a remote data server.
+/// Supports persistent connections and single "bytes=start-" range requests
+/// (with If-Range ETag validation), and counts connections and transferred bytes
+/// so that tests can check connection reuse and resumed downloads.
+class LocalHTTPServer
+{
+public:
+  ~LocalHTTPServer() { this->Stop(); }
+
+  bool Start();
+  void Stop();
+  std::string GetURL(const std::string& path) const
+  {
+    return "http://127.0.0.1:" + std::to_string(this->Port) + path;
+  }
+  void SetFile(const std::string& path, const std::string& content)
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Files[path] = content;
+  }
+  static std::string GetETag(const std::string& content)
+  {
+    return "\"" + std::to_string(std::hash<std::string>()(content)) + "\"";
+  }
+
+  /// If disabled, range requests are answered with the whole file (status 200).
+  std::atomic<bool> SupportRanges{ true };
+  /// If not 0, connections are closed after sending this number of body bytes.
+  std::atomic<size_t> InterruptAfterBytes{ 0 };
+  /// If disabled, responses do not contain an ETag header.
+  std::atomic<bool> SendETag{ true };
+
+  std::atomic<int> NumberOfConnections{ 0 };
+  std::atomic<int> NumberOfRangeRequests{ 0 };
+  std::atomic<size_t> NumberOfBodyBytesSent{ 0 };
+
+protected:
+  void AcceptConnections();
+  void ServeConnection(SocketType clientSocket);
+  bool SendAll(SocketType clientSocket, const char* data, size_t size);
+
+  SocketType ListenSocket{ INVALID_SOCKET };
+  int Port{ 0 };
+  std::atomic<bool> Stopping{ false };
+  std::mutex Mutex;
+  std::map<std::string, std::string> Files;
+  std::vector<SocketType> ClientSockets;
+  std::thread AcceptThread;
+  std::vector<std::thread> ConnectionThreads;
+};
+
+//----------------------------------------------------------------------------
+bool LocalHTTPServer::Start()
+{
+#ifdef _WIN32
+  WSADATA wsaData;
+  if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+  {
+    return false;
+  }
+#endif
+  this->ListenSocket = socket(AF_INET, SOCK_STREAM, 0);
+  if (this->ListenSocket == INVALID_SOCKET)
+  {
+    return false;
+  }
+  sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = 0; // any free port
+  socklen_t addressLength = sizeof(address);
+  if (bind(this->ListenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+    || listen(this->ListenSocket, 16) != 0
+    || getsockname(this->ListenSocket, reinterpret_cast<sockaddr*>(&address), &addressLength) != 0)
+  {
+    CloseSocket(this->ListenSocket);
+    this->ListenSocket = INVALID_SOCKET;
+    return false;
+  }
+  this->Port = ntohs(address.sin_port);
+  this->AcceptThread = std::thread(&LocalHTTPServer::AcceptConnections, this);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void LocalHTTPServer::Stop()
+{
+  if (this->ListenSocket == INVALID_SOCKET)
+  {
+    return;
+  }
+  this->Stopping = true;
+  // unblock accept() and recv() calls
+#ifdef _WIN32
+  shutdown(this->ListenSocket, SD_BOTH);
+#else
+  shutdown(this->ListenSocket, SHUT_RDWR);
+#endif
+  CloseSocket(this->ListenSocket);
+  this->ListenSocket = INVALID_SOCKET;
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    for (SocketType clientSocket : this->ClientSockets)
+    {
+#ifdef _WIN32
+      shutdown(clientSocket, SD_BOTH);
+#else
+      shutdown(clientSocket, SHUT_RDWR);
+#endif
+    }
+  }
+  if (this->AcceptThread.joinable())
+  {
+    this->AcceptThread.join();
+  }
+  for (std::thread& connectionThread : this->ConnectionThreads)
+  {
+    connectionThread.join();
+  }
+  this->ConnectionThreads.clear();
+#ifdef _WIN32
+  WSACleanup();
+#endif
+}
+
+//----------------------------------------------------------------------------
+void LocalHTTPServer::AcceptConnections()
+{
+  while (!this->Stopping)
+  {
+    SocketType clientSocket = accept(this->ListenSocket, nullptr, nullptr);
+    if (clientSocket == INVALID_SOCKET)
+    {
+      continue;
+    }
+    if (this->Stopping)
+    {
+      CloseSocket(clientSocket);
+      break;
+    }
+    this->NumberOfConnections++;
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->ClientSockets.push_back(clientSocket);
+    this->ConnectionThreads.emplace_back(&LocalHTTPServer::ServeConnection, this, clientSocket);
+  }
+}
+
+//----------------------------------------------------------------------------
+bool LocalHTTPServer::SendAll(SocketType clientSocket, const char* data, size_t size)
+{
+  while (size > 0)
+  {
+    int sent = send(clientSocket, data, static_cast<int>(std::min<size_t>(size, 65536)), 0);
+    if (sent <= 0)
+    {
+      return false;
+    }
+    data += sent;
+    size -= sent;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void LocalHTTPServer::ServeConnection(SocketType clientSocket)
+{
+  std::string received;
+  char buffer[4096];
+  bool keepAlive = true;
+  while (keepAlive && !this->Stopping)
+  {
+    // Read request header
+    size_t headerEnd = std::string::npos;
+    while ((headerEnd = received.find("\r\n\r\n")) == std::string::npos)
+    {
+      int receivedSize = recv(clientSocket, buffer, sizeof(buffer), 0);
+      if (receivedSize <= 0)
+      {
+        keepAlive = false;
+        break;
+      }
+      received.append(buffer, receivedSize);
+    }
+    if (!keepAlive)
+    {
+      break;
+    }
+    std::string header = received.substr(0, headerEnd);
+    received.erase(0, headerEnd + 4);
+
+    // Parse request line and the headers that are used
+    std::istringstream headerStream(header);
+    std::string method, path, line;
+    headerStream >> method >> path;
+    std::getline(headerStream, line);
+    long long rangeStart = -1;
+    std::string ifRange;
+    while (std::getline(headerStream, line))
+    {
+      if (!line.empty() && line.back() == '\r')
+      {
+        line.pop_back();
+      }
+      std::string lowerCaseLine = line;
+      std::transform(lowerCaseLine.begin(), lowerCaseLine.end(), lowerCaseLine.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+      if (lowerCaseLine.compare(0, 13, "range: bytes=") == 0)
+      {
+        rangeStart = std::stoll(line.substr(13));
+      }
+      else if (lowerCaseLine.compare(0, 10, "if-range: ") == 0)
+      {
+        ifRange = line.substr(10);
+      }
+      else if (lowerCaseLine.compare(0, 17, "connection: close") == 0)
+      {
+        keepAlive = false;
+      }
+    }
+
+    // Create response
+    std::string content;
+    bool found = false;
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      auto fileIt = this->Files.find(path);
+      if (fileIt != this->Files.end())
+      {
+        content = fileIt->second;
+        found = true;
+      }
+    }
+    std::ostringstream responseHeader;
+    size_t bodyStart = 0;
+    if (!found || method != "GET")
+    {
+      responseHeader << "HTTP/1.1 404 Not Found\r\n";
+      content.clear();
+    }
+    else if (rangeStart >= 0 && this->SupportRanges
+      && (ifRange.empty() || ifRange == LocalHTTPServer::GetETag(content)))
+    {
+      this->NumberOfRangeRequests++;
+      if (static_cast<size_t>(rangeStart) >= content.size())
+      {
+        responseHeader << "HTTP/1.1 416 Range Not Satisfiable\r\n"
+          << "Content-Range: bytes */" << content.size() << "\r\n";
+        content.clear();
+      }
+      else
+      {
+        bodyStart = static_cast<size_t>(rangeStart);
+        responseHeader << "HTTP/1.1 206 Partial Content\r\n"
+          << "Content-Range: bytes " << bodyStart << "-" << content.size() - 1 << "/" << content.size() << "\r\n";
+      }
+    }
+    else
+    {
+      responseHeader << "HTTP/1.1 200 OK\r\n";
+    }
+    size_t bodySize = content.size() - bodyStart;
+    responseHeader << "Content-Length: " << bodySize << "\r\n";
+    if (this->SupportRanges)
+    {
+      responseHeader << "Accept-Ranges: bytes\r\n";
+    }
+    if (found && this->SendETag)
+    {
+      responseHeader << "ETag: " << LocalHTTPServer::GetETag(content) << "\r\n";
+    }
+    responseHeader << "Connection: " << (keepAlive ? "keep-alive" : "close") << "\r\n\r\n";
+
+    // Send response
+    std::string responseHeaderString = responseHeader.str();
+    size_t interruptAfterBytes = this->InterruptAfterBytes;
+    bool interrupted = (interruptAfterBytes > 0 && bodySize > interruptAfterBytes);
+    if (interrupted)
+    {
+      bodySize = interruptAfterBytes;
+      keepAlive = false;
+    }
+    if (!this->SendAll(clientSocket, responseHeaderString.c_str(), responseHeaderString.size())
+      || !this->SendAll(clientSocket, content.c_str() + bodyStart, bodySize))
+    {
+      break;
+    }
+    this->NumberOfBodyBytesSent += bodySize;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->ClientSockets.erase(std::find(this->ClientSockets.begin(), this->ClientSockets.end(), clientSocket));
+  }
+  CloseSocket(clientSocket);
+}
+
+//----------------------------------------------------------------------------
+std::string CreateContent(size_t size, int seed)
+{
+  std::string content(size, '\0');
+  for (size_t i = 0; i < size; ++i)
+  {
+    content[i] = static_cast<char>((i * 31 + seed * 7 + i / 251) & 0xff);
+  }
+  return content;
+}
+
+//----------------------------------------------------------------------------
+std::string ReadFile(const std::string& fileName)
+{
+  std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+//----------------------------------------------------------------------------
+void WriteFile(const std::string& fileName, const std::string& content)
+{
+  std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary);
+  file.write(content.data(), content.size());
+}
+
+//----------------------------------------------------------------------------
+int TestParallelDownloads(LocalHTTPServer& server, const std::string& tempDir)
+{
+  vtkNew<vtkHTTPHandler> handler;
+  handler->SetMaximumNumberOfParallelTransfers(4);
+  CHECK_INT(handler->GetMaximumNumberOfParallelTransfers(), 4);
+
+  const int numberOfFiles = 40;
+  std::vector<std::string> sources;
+  std::vector<std::string> destinations;
+  std::vector<std::string> contents;
+  for (int fileIndex = 0; fileIndex < numberOfFiles; ++fileIndex)
+  {
+    std::string path = "/series/slice" + std::to_string(fileIndex) + ".dcm";
+    contents.push_back(CreateContent(20000 + fileIndex * 1000, fileIndex));
+    server.SetFile(path, contents.back());
+    sources.push_back(server.GetURL(path));
+    destinations.push_back(tempDir + "/slice" + std::to_string(fileIndex) + ".dcm");
+    vtksys::SystemTools::RemoveFile(destinations.back());
+  }
+
+  int numberOfConnectionsBefore = server.NumberOfConnections;
+  std::vector<bool> succeeded;
+  CHECK_INT(handler->StageFilesRead(sources, destinations, &succeeded), numberOfFiles);
+  CHECK_INT(static_cast<int>(succeeded.size()), numberOfFiles);
+  for (int fileIndex = 0; fileIndex < numberOfFiles; ++fileIndex)
+  {
+    CHECK_BOOL(succeeded[fileIndex], true);
+    CHECK_BOOL(ReadFile(destinations[fileIndex]) == contents[fileIndex], true);
+    CHECK_BOOL(vtksys::SystemTools::FileExists(destinations[fileIndex] + vtkHTTPHandler::GetPartialFileSuffix()), false);
+  }
+  // Connections are reused: at most one connection per parallel transfer
+  int numberOfNewConnections = server.NumberOfConnections - numberOfConnectionsBefore;
+  std::cout << "Downloaded " << numberOfFiles << " files using " << numberOfNewConnections << " connections" << std::endl;
+  CHECK_BOOL(numberOfNewConnections >= 1 && numberOfNewConnections <= 4, true);
+
+  // Consecutive single file downloads reuse the open connections
+  numberOfConnectionsBefore = server.NumberOfConnections;
+  for (int fileIndex = 0; fileIndex < 5; ++fileIndex)
+  {
+    vtksys::SystemTools::RemoveFile(destinations[fileIndex]);
+    handler->StageFileRead(sources[fileIndex].c_str(), destinations[fileIndex].c_str());
+    CHECK_BOOL(ReadFile(destinations[fileIndex]) == contents[fileIndex], true);
+  }
+  CHECK_BOOL(server.NumberOfConnections - numberOfConnectionsBefore <= 1, true);
+
+  // Missing files are reported, other files are downloaded
+  sources[1] = server.GetURL("/series/missing.dcm");
+  vtksys::SystemTools::RemoveFile(destinations[1]);
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  CHECK_INT(handler->StageFilesRead(sources, destinations, &succeeded), numberOfFiles - 1);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+  CHECK_BOOL(succeeded[0], true);
+  CHECK_BOOL(succeeded[1], false);
+  CHECK_BOOL(succeeded[2], true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(destinations[1]), false);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(destinations[1] + vtkHTTPHandler::GetPartialFileSuffix()), false);
+
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestResumeDownload(LocalHTTPServer& server, const std::string& tempDir)
+{
+  vtkNew<vtkHTTPHandler> handler;
+  CHECK_BOOL(handler->GetResumeDownloads(), true);
+
+  const size_t fileSize = 1000000;
+  std::string content = CreateContent(fileSize, 100);
+  server.SetFile("/large.nrrd", content);
+  std::string source = server.GetURL("/large.nrrd");
+  std::string destination = tempDir + "/large.nrrd";
+  std::string partialFileName = destination + vtkHTTPHandler::GetPartialFileSuffix();
+  vtksys::SystemTools::RemoveFile(destination);
+  vtksys::SystemTools::RemoveFile(partialFileName);
+
+  // Interrupted download keeps the received data
+  server.InterruptAfterBytes = 400000;
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  handler->StageFileRead(source.c_str(), destination.c_str());
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+  server.InterruptAfterBytes = 0;
+  CHECK_BOOL(vtksys::SystemTools::FileExists(destination), false);
+  CHECK_INT(static_cast<int>(vtksys::SystemTools::FileLength(partialFileName)), 400000);
+
+  // Next download requests only the missing bytes
+  int numberOfRangeRequestsBefore = server.NumberOfRangeRequests;
+  size_t numberOfBodyBytesSentBefore = server.NumberOfBodyBytesSent;
+  handler->StageFileRead(source.c_str(), destination.c_str());
+  CHECK_BOOL(ReadFile(destination) == content, true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(partialFileName), false);
+  CHECK_INT(server.NumberOfRangeRequests - numberOfRangeRequestsBefore, 1);
+  CHECK_INT(static_cast<int>(server.NumberOfBodyBytesSent - numberOfBodyBytesSentBefore), 600000);
+
+  // Remote file changed since the download was interrupted: download whole file
+  server.InterruptAfterBytes = 400000;
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  CHECK_BOOL(handler->StageFileReadWithStatus(source.c_str(), destination.c_str()), false);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+  server.InterruptAfterBytes = 0;
+  CHECK_INT(static_cast<int>(vtksys::SystemTools::FileLength(partialFileName)), 400000);
+  std::string changedContent = CreateContent(fileSize, 200);
+  server.SetFile("/large.nrrd", changedContent);
+  CHECK_BOOL(handler->StageFileReadWithStatus(source.c_str(), destination.c_str()), true);
+  CHECK_BOOL(ReadFile(destination) == changedContent, true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(partialFileName), false);
+
+  // Partial file of unknown origin (no validator) is not resumed
+  WriteFile(partialFileName, CreateContent(1000, 300));
+  numberOfRangeRequestsBefore = server.NumberOfRangeRequests;
+  handler->StageFileRead(source.c_str(), destination.c_str());
+  CHECK_BOOL(ReadFile(destination) == changedContent, true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(partialFileName), false);
+  CHECK_INT(server.NumberOfRangeRequests - numberOfRangeRequestsBefore, 0);
+
+  // Server that does not identify the file version: partial file is not kept
+  server.SendETag = false;
+  server.InterruptAfterBytes = 400000;
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  handler->StageFileRead(source.c_str(), destination.c_str());
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+  server.InterruptAfterBytes = 0;
+  server.SendETag = true;
+  CHECK_BOOL(vtksys::SystemTools::FileExists(partialFileName), false);
+
+  // Server that does not support range requests: download whole file
+  server.InterruptAfterBytes = 400000;
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  handler->StageFileRead(source.c_str(), destination.c_str());
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+  server.InterruptAfterBytes = 0;
+  CHECK_BOOL(vtksys::SystemTools::FileExists(partialFileName), true);
+  server.SupportRanges = false;
+  CHECK_BOOL(handler->StageFileReadWithStatus(source.c_str(), destination.c_str()), true);
+  server.SupportRanges = true;
+  CHECK_BOOL(ReadFile(destination) == changedContent, true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(partialFileName), false);
+
+  // Partial file is not used if resume is disabled
+  handler->ResumeDownloadsOff();
+  WriteFile(partialFileName, CreateContent(1000, 400));
+  numberOfRangeRequestsBefore = server.NumberOfRangeRequests;
+  handler->StageFileRead(source.c_str(), destination.c_str());
+  CHECK_BOOL(ReadFile(destination) == changedContent, true);
+  CHECK_INT(server.NumberOfRangeRequests - numberOfRangeRequestsBefore, 0);
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkHTTPHandlerTest1(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string tempDir = std::string(argv[1]) + "/vtkHTTPHandlerTest1";
+  vtksys::SystemTools::MakeDirectory(tempDir);
+
+  LocalHTTPServer server;
+  CHECK_BOOL(server.Start(), true);
+
+  vtkNew<vtkHTTPHandler> handler;
+  CHECK_INT(handler->CanHandleURI(server.GetURL("/file.txt").c_str()), 1);
+  CHECK_INT(handler->CanHandleURI("file:///tmp/file.txt"), 0);
+
+  CHECK_EXIT_SUCCESS(TestParallelDownloads(server, tempDir));
+  CHECK_EXIT_SUCCESS(TestResumeDownload(server, tempDir));
+
+  server.Stop();
+  return EXIT_SUCCESS;
+}
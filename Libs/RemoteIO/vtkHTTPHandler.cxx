@@ -5,13 +5,134 @@
 // MRML includes
 #include <vtkPermissionPrompter.h>
 
+// VTKsys includes
+#include <vtksys/SystemTools.hxx>
+
 // CURL includes
 #include <curl/curl.h>
 
+// STD includes
+#include <algorithm>
+#include <cctype>
+#include <deque>
+#include <fstream>
+#include <mutex>
+
 #if defined(_MSC_VER)
 #pragma warning ( disable : 4786 )
 #endif
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// State of a single file download
+struct DownloadTransfer
+{
+  std::string Source;
+  std::string Destination;
+  std::string PartialFileName;
+  size_t Index{ 0 };
+  CURL* Handle{ nullptr };
+  FILE* File{ nullptr };
+  curl_slist* Headers{ nullptr };
+  curl_off_t ResumeOffset{ 0 };
+  bool Restarted{ false };
+  /// Validator of the remote file that the partial file was downloaded from
+  /// (sent in If-Range header when the download is resumed)
+  std::string Validator;
+  /// Validators received in the last response
+  std::string ResponseETag;
+  std::string ResponseLastModified;
+};
+
+//----------------------------------------------------------------------------
+/// Name of the file that stores the validator (strong ETag or Last-Modified date)
+/// of the remote file that a partial file was downloaded from.
+std::string GetValidatorFileName(const std::string& partialFileName)
+{
+  return partialFileName + ".validator";
+}
+
+//----------------------------------------------------------------------------
+std::string ReadValidator(const std::string& partialFileName)
+{
+  std::ifstream validatorFile(GetValidatorFileName(partialFileName).c_str());
+  std::string validator;
+  std::getline(validatorFile, validator);
+  return validator;
+}
+
+//----------------------------------------------------------------------------
+bool WriteValidator(const std::string& partialFileName, const std::string& validator)
+{
+  std::ofstream validatorFile(GetValidatorFileName(partialFileName).c_str());
+  validatorFile << validator << "\n";
+  return validatorFile.good();
+}
+
+//----------------------------------------------------------------------------
+void RemovePartialFile(const std::string& partialFileName)
+{
+  vtksys::SystemTools::RemoveFile(partialFileName);
+  vtksys::SystemTools::RemoveFile(GetValidatorFileName(partialFileName));
+}
+
+//----------------------------------------------------------------------------
+size_t WriteDownloadData(char* buffer, size_t size, size_t nitems, void* userdata)
+{
+  DownloadTransfer* transfer = static_cast<DownloadTransfer*>(userdata);
+  if (transfer == nullptr || transfer->File == nullptr)
+  {
+    return 0;
+  }
+  return fwrite(buffer, 1, size * nitems, transfer->File);
+}
+
+//----------------------------------------------------------------------------
+size_t WriteDownloadHeader(char* buffer, size_t size, size_t nitems, void* userdata)
+{
+  DownloadTransfer* transfer = static_cast<DownloadTransfer*>(userdata);
+  size_t length = size * nitems;
+  if (transfer == nullptr)
+  {
+    return length;
+  }
+  std::string line(buffer, length);
+  while (!line.empty() && (line.back() == '\r' || line.back() == '\n'))
+  {
+    line.pop_back();
+  }
+  if (line.compare(0, 5, "HTTP/") == 0)
+  {
+    // new response (e.g., after a redirection), forget validators of the previous one
+    transfer->ResponseETag.clear();
+    transfer->ResponseLastModified.clear();
+    return length;
+  }
+  std::string::size_type separator = line.find(':');
+  if (separator == std::string::npos)
+  {
+    return length;
+  }
+  std::string name = line.substr(0, separator);
+  std::transform(name.begin(), name.end(), name.begin(),
+    [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  std::string value = line.substr(separator + 1);
+  value.erase(0, value.find_first_not_of(" \t"));
+  if (name == "etag")
+  {
+    transfer->ResponseETag = value;
+  }
+  else if (name == "last-modified")
+  {
+    transfer->ResponseLastModified = value;
+  }
+  return length;
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 class vtkHTTPHandler::vtkInternal
 {
@@ -19,9 +140,35 @@ public:
   vtkInternal(vtkHTTPHandler* external);
   ~vtkInternal();
 
+  enum DownloadResult
+  {
+    DownloadCompleted,
+    DownloadFailed,
+    DownloadRestart
+  };
+
+  /// Get a handle for a new transfer. Handles are reused and share connections,
+  /// DNS cache and TLS sessions, so that consecutive transfers to the same server
+  /// do not need to connect again.
+  CURL* AcquireHandle();
+  void ReleaseHandle(CURL* handle);
+
+  /// Open the partial file and set up the handle to download the missing bytes
+  bool StartDownload(DownloadTransfer& transfer);
+  /// Close the partial file and replace the destination file if the download is complete
+  DownloadResult FinishDownload(DownloadTransfer& transfer, CURLcode curlResult);
+
+  static void LockShare(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+  static void UnlockShare(CURL* handle, curl_lock_data data, void* userptr);
+
   vtkHTTPHandler* External;
   CURL* CurlHandle;
   int ForbidReuse;
+
+  CURLSH* Share;
+  std::mutex ShareLocks[CURL_LOCK_DATA_LAST];
+  std::mutex IdleHandlesMutex;
+  std::vector<CURL*> IdleHandles;
 };
 
 //----------------------------------------------------------------------------
@@ -32,12 +179,274 @@ vtkHTTPHandler::vtkInternal::vtkInternal(vtkHTTPHandler* external):External(exte
 {
   this->CurlHandle = nullptr;
   this->ForbidReuse = 0;
+
+  // curl_global_init is not thread-safe, call it only once
+  static std::once_flag curlGlobalInitFlag;
+  std::call_once(curlGlobalInitFlag, []() { curl_global_init(CURL_GLOBAL_ALL); });
+
+  this->Share = curl_share_init();
+  if (this->Share)
+  {
+    curl_share_setopt(this->Share, CURLSHOPT_LOCKFUNC, vtkInternal::LockShare);
+    curl_share_setopt(this->Share, CURLSHOPT_UNLOCKFUNC, vtkInternal::UnlockShare);
+    curl_share_setopt(this->Share, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(this->Share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(this->Share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+    curl_share_setopt(this->Share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+  }
 }
 
 //-----------------------------------------------------------------------------
 vtkHTTPHandler::vtkInternal::~vtkInternal()
 {
-  this->CurlHandle = nullptr;
+  if (this->CurlHandle)
+  {
+    curl_easy_cleanup(this->CurlHandle);
+    this->CurlHandle = nullptr;
+  }
+  for (CURL* handle : this->IdleHandles)
+  {
+    curl_easy_cleanup(handle);
+  }
+  this->IdleHandles.clear();
+  // share can only be cleaned up after all handles that use it
+  if (this->Share)
+  {
+    curl_share_cleanup(this->Share);
+    this->Share = nullptr;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkHTTPHandler::vtkInternal::LockShare(CURL* vtkNotUsed(handle), curl_lock_data data,
+  curl_lock_access vtkNotUsed(access), void* userptr)
+{
+  static_cast<vtkInternal*>(userptr)->ShareLocks[data].lock();
+}
+
+//-----------------------------------------------------------------------------
+void vtkHTTPHandler::vtkInternal::UnlockShare(CURL* vtkNotUsed(handle), curl_lock_data data, void* userptr)
+{
+  static_cast<vtkInternal*>(userptr)->ShareLocks[data].unlock();
+}
+
+//-----------------------------------------------------------------------------
+CURL* vtkHTTPHandler::vtkInternal::AcquireHandle()
+{
+  CURL* handle = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(this->IdleHandlesMutex);
+    if (!this->IdleHandles.empty())
+    {
+      handle = this->IdleHandles.back();
+      this->IdleHandles.pop_back();
+    }
+  }
+  if (handle)
+  {
+    // clear options of the previous transfer, open connections are kept
+    curl_easy_reset(handle);
+  }
+  else
+  {
+    handle = curl_easy_init();
+    if (handle == nullptr)
+    {
+      return nullptr;
+    }
+  }
+  if (this->Share)
+  {
+    curl_easy_setopt(handle, CURLOPT_SHARE, this->Share);
+  }
+  return handle;
+}
+
+//-----------------------------------------------------------------------------
+void vtkHTTPHandler::vtkInternal::ReleaseHandle(CURL* handle)
+{
+  if (handle == nullptr)
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(this->IdleHandlesMutex);
+  this->IdleHandles.push_back(handle);
+}
+
+//-----------------------------------------------------------------------------
+bool vtkHTTPHandler::vtkInternal::StartDownload(DownloadTransfer& transfer)
+{
+  transfer.PartialFileName = transfer.Destination + vtkHTTPHandler::GetPartialFileSuffix();
+  transfer.ResumeOffset = 0;
+  transfer.Validator.clear();
+  transfer.ResponseETag.clear();
+  transfer.ResponseLastModified.clear();
+  if (this->External->ResumeDownloads && vtksys::SystemTools::FileExists(transfer.PartialFileName, true))
+  {
+    // A partial file can only be resumed if it is known which version of the remote file
+    // it was downloaded from, otherwise bytes of different versions could be mixed.
+    transfer.Validator = ReadValidator(transfer.PartialFileName);
+    if (!transfer.Validator.empty())
+    {
+      transfer.ResumeOffset = static_cast<curl_off_t>(vtksys::SystemTools::FileLength(transfer.PartialFileName));
+    }
+  }
+  if (transfer.ResumeOffset == 0)
+  {
+    RemovePartialFile(transfer.PartialFileName);
+    transfer.Validator.clear();
+  }
+  transfer.File = fopen(transfer.PartialFileName.c_str(), transfer.ResumeOffset > 0 ? "ab" : "wb");
+  if (transfer.File == nullptr)
+  {
+    vtkErrorWithObjectMacro(this->External, "StageFileRead: unable to open file for writing: " << transfer.PartialFileName);
+    return false;
+  }
+
+  CURL* handle = transfer.Handle;
+  if (this->ForbidReuse)
+  {
+    curl_easy_setopt(handle, CURLOPT_FORBID_REUSE, 1L);
+  }
+  curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+  curl_easy_setopt(handle, CURLOPT_URL, transfer.Source.c_str());
+  curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+  // HTTP errors must not be written into the file
+  curl_easy_setopt(handle, CURLOPT_FAILONERROR, 1L);
+  curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, WriteDownloadData);
+  curl_easy_setopt(handle, CURLOPT_WRITEDATA, &transfer);
+  curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, WriteDownloadHeader);
+  curl_easy_setopt(handle, CURLOPT_HEADERDATA, &transfer);
+  curl_easy_setopt(handle, CURLOPT_RESUME_FROM_LARGE, transfer.ResumeOffset);
+  if (transfer.ResumeOffset > 0)
+  {
+    // The server only sends the requested range if the remote file has not changed,
+    // otherwise it sends the whole file (status 200) and the download is restarted.
+    std::string ifRangeHeader = "If-Range: " + transfer.Validator;
+    transfer.Headers = curl_slist_append(transfer.Headers, ifRangeHeader.c_str());
+  }
+  curl_easy_setopt(handle, CURLOPT_HTTPHEADER, transfer.Headers);
+
+  if (this->External->CaCertificatesPath)
+  {
+    curl_easy_setopt(handle, CURLOPT_CAINFO, this->External->CaCertificatesPath);
+  }
+  else
+  {
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 0L);
+  }
+
+  // quick timeout during connection phase if URL is not accessible (e.g. blocked by a firewall)
+  curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, 3L); // in seconds (type long)
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+vtkHTTPHandler::vtkInternal::DownloadResult vtkHTTPHandler::vtkInternal::FinishDownload(
+  DownloadTransfer& transfer, CURLcode curlResult)
+{
+  bool writeFailed = false;
+  if (transfer.File)
+  {
+    writeFailed = (fclose(transfer.File) != 0);
+    transfer.File = nullptr;
+  }
+  curl_easy_setopt(transfer.Handle, CURLOPT_HTTPHEADER, nullptr);
+  if (transfer.Headers)
+  {
+    curl_slist_free_all(transfer.Headers);
+    transfer.Headers = nullptr;
+  }
+  long responseCode = 0;
+  curl_easy_getinfo(transfer.Handle, CURLINFO_RESPONSE_CODE, &responseCode);
+
+  // curl reports success for "416 Range Not Satisfiable" response to a resumed download,
+  // assuming that the file is already complete. It cannot be verified, so it is downloaded again.
+  // "200 OK" response to a resumed download means that the remote file has changed
+  // (If-Range did not match) and the received data must not be appended to the partial file.
+  bool resumeRejected = (transfer.ResumeOffset > 0
+    && (curlResult == CURLE_RANGE_ERROR || responseCode == 416 || responseCode == 200));
+
+  if (curlResult == CURLE_OK && !writeFailed && !resumeRejected)
+  {
+    vtkDebugWithObjectMacro(this->External, "StageFileRead: successful return from curl, source = " << transfer.Source);
+    if (vtksys::SystemTools::FileExists(transfer.Destination, true))
+    {
+      vtksys::SystemTools::RemoveFile(transfer.Destination);
+    }
+    bool renamed = vtksys::SystemTools::RenameFile(transfer.PartialFileName, transfer.Destination);
+    RemovePartialFile(transfer.PartialFileName);
+    if (!renamed)
+    {
+      vtkErrorWithObjectMacro(this->External, "StageFileRead: unable to rename " << transfer.PartialFileName
+        << " to " << transfer.Destination);
+      return DownloadFailed;
+    }
+    return DownloadCompleted;
+  }
+
+  // Server does not support range requests or the partial file
+  // does not match the remote file anymore: download the whole file.
+  if (resumeRejected && !transfer.Restarted)
+  {
+    vtkDebugWithObjectMacro(this->External, "StageFileRead: cannot resume download, restarting: " << transfer.Source);
+    RemovePartialFile(transfer.PartialFileName);
+    transfer.Restarted = true;
+    return DownloadRestart;
+  }
+
+  if (curlResult == CURLE_HTTP_RETURNED_ERROR)
+  {
+    vtkErrorWithObjectMacro(this->External, "StageFileRead: error running curl: HTTP response code "
+      << responseCode << " for " << transfer.Source);
+  }
+  else if (curlResult != CURLE_OK)
+  {
+    vtkErrorWithObjectMacro(this->External, "StageFileRead: error running curl: "
+      << curl_easy_strerror(curlResult) << " for " << transfer.Source);
+  }
+  else if (resumeRejected)
+  {
+    vtkErrorWithObjectMacro(this->External, "StageFileRead: unable to resume download of " << transfer.Source);
+  }
+  else
+  {
+    vtkErrorWithObjectMacro(this->External, "StageFileRead: unable to write file " << transfer.PartialFileName);
+  }
+  //--- in case the permissions were not correct and that's
+  //--- the reason the read command failed,
+  //--- reset the 'remember check' in the permissions
+  //--- prompter so that new login info  will be prompted.
+  if (this->External->GetPermissionPrompter() != nullptr)
+  {
+    this->External->GetPermissionPrompter()->SetRemember(0);
+  }
+  // Keep received data for resuming the download later, along with the validator
+  // of the remote file. Weak ETags cannot be used for range requests.
+  std::string validator;
+  if (!transfer.ResponseETag.empty() && transfer.ResponseETag.compare(0, 2, "W/") != 0)
+  {
+    validator = transfer.ResponseETag;
+  }
+  else if (!transfer.ResponseLastModified.empty())
+  {
+    validator = transfer.ResponseLastModified;
+  }
+  else if (transfer.ResumeOffset > 0 && !resumeRejected)
+  {
+    // the resumed data was sent for the validator that was sent in the request
+    validator = transfer.Validator;
+  }
+  if (resumeRejected || !this->External->ResumeDownloads || validator.empty()
+    || vtksys::SystemTools::FileLength(transfer.PartialFileName) == 0
+    || !WriteValidator(transfer.PartialFileName, validator))
+  {
+    RemovePartialFile(transfer.PartialFileName);
+  }
+  return DownloadFailed;
 }
 
 //----------------------------------------------------------------------------
@@ -107,6 +516,9 @@ vtkHTTPHandler::~vtkHTTPHandler()
 void vtkHTTPHandler::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf ( os, indent );
+  os << indent << "ForbidReuse: " << this->Internal->ForbidReuse << "\n";
+  os << indent << "MaximumNumberOfParallelTransfers: " << this->MaximumNumberOfParallelTransfers << "\n";
+  os << indent << "ResumeDownloads: " << (this->ResumeDownloads ? "true" : "false") << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -165,9 +577,8 @@ int vtkHTTPHandler::GetForbidReuse()
 //----------------------------------------------------------------------------
 void vtkHTTPHandler::InitTransfer( )
 {
-  curl_global_init(CURL_GLOBAL_ALL);
   vtkDebugMacro("vtkHTTPHandler: InitTransfer: initialising CurlHandle");
-  this->Internal->CurlHandle = curl_easy_init();
+  this->Internal->CurlHandle = this->Internal->AcquireHandle();
   if (this->Internal->CurlHandle == nullptr)
   {
     vtkErrorMacro("InitTransfer: unable to initialise");
@@ -177,99 +588,203 @@ void vtkHTTPHandler::InitTransfer( )
 //----------------------------------------------------------------------------
 int vtkHTTPHandler::CloseTransfer( )
 {
-  curl_easy_cleanup(this->Internal->CurlHandle);
+  // keep the handle (and its open connections) for the next transfer
+  this->Internal->ReleaseHandle(this->Internal->CurlHandle);
+  this->Internal->CurlHandle = nullptr;
   return EXIT_SUCCESS;
 }
 
 
 //----------------------------------------------------------------------------
 void vtkHTTPHandler::StageFileRead(const char * source, const char * destination)
+{
+  this->StageFileReadWithStatus(source, destination);
+}
+
+//----------------------------------------------------------------------------
+bool vtkHTTPHandler::StageFileReadWithStatus(const char* source, const char* destination)
 {
   if (source == nullptr || destination == nullptr)
   {
     vtkErrorMacro("StageFileRead: source or dest is null!");
-    return;
+    return false;
   }
-  /*
-  if (this->LocalFile)
+
+  // Use a separate handle for each call, as networking threads may download
+  // files using the same handler at the same time.
+  DownloadTransfer transfer;
+  transfer.Source = source;
+  transfer.Destination = destination;
+  transfer.Handle = this->Internal->AcquireHandle();
+  if (transfer.Handle == nullptr)
+  {
+    vtkErrorMacro("StageFileRead: unable to initialise curl");
+    return false;
+  }
+
+  vtkInternal::DownloadResult result = vtkInternal::DownloadRestart;
+  while (result == vtkInternal::DownloadRestart)
+  {
+    if (!this->Internal->StartDownload(transfer))
     {
-    this->LocalFile->close();
-    delete this->LocalFile;
-    this->LocalFile = nullptr;
+      result = vtkInternal::DownloadFailed;
+      break;
     }
-  this->LocalFile = new std::ofstream(destination, std::ios::binary);
-  */
-  this->InitTransfer( );
+    vtkDebugMacro("StageFileRead: about to do the curl download... source = " << source << ", dest = " << destination
+      << ", resume from = " << transfer.ResumeOffset);
+    CURLcode retval = curl_easy_perform(transfer.Handle);
+    result = this->Internal->FinishDownload(transfer, retval);
+  }
 
+  this->Internal->ReleaseHandle(transfer.Handle);
+  return (result == vtkInternal::DownloadCompleted);
+}
 
-  if ( this->Internal->ForbidReuse )
+//----------------------------------------------------------------------------
+int vtkHTTPHandler::StageFilesRead(const std::vector<std::string>& sources,
+                                   const std::vector<std::string>& destinations,
+                                   std::vector<bool>* succeeded)
+{
+  if (sources.size() != destinations.size())
   {
-    curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_FORBID_REUSE, 1);
+    vtkErrorMacro("StageFilesRead: number of sources (" << sources.size()
+      << ") and destinations (" << destinations.size() << ") differ");
+    return 0;
   }
-  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_HTTPGET, 1);
-  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_URL, source);
-//  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_NOPROGRESS, false);
-  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_FOLLOWLOCATION, true);
-  // use the default curl write call back
-  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_WRITEFUNCTION, nullptr); // write_callback);
-  this->LocalFile = fopen(destination, "wb");
-  // output goes into LocalFile, must be  FILE*
-  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_WRITEDATA, this->LocalFile);
-//  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_PROGRESSDATA, nullptr);
-//  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_PROGRESSFUNCTION, ProgressCallback);
-
-  if (this->CaCertificatesPath)
+  if (succeeded)
   {
-    curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_CAINFO, this->CaCertificatesPath);
+    succeeded->assign(sources.size(), false);
   }
-  else
+  if (sources.empty())
   {
-    curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_SSL_VERIFYPEER, 0);
-    curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_SSL_VERIFYHOST, 0);
+    return 0;
   }
 
-  // quick timeout during connection phase if URL is not accessible (e.g. blocked by a firewall)
-  curl_easy_setopt(this->Internal->CurlHandle, CURLOPT_CONNECTTIMEOUT, 3); // in seconds (type long)
-
-  vtkDebugMacro("StageFileRead: about to do the curl download... source = " << source << ", dest = " << destination);
-  CURLcode retval = curl_easy_perform(this->Internal->CurlHandle);
-
-  if (retval == CURLE_OK)
+  CURLM* multiHandle = curl_multi_init();
+  if (multiHandle == nullptr)
   {
-    vtkDebugMacro("StageFileRead: successful return from curl");
+    vtkErrorMacro("StageFilesRead: unable to initialise curl");
+    return 0;
   }
-  else if (retval == CURLE_BAD_FUNCTION_ARGUMENT)
+  curl_multi_setopt(multiHandle, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(this->MaximumNumberOfParallelTransfers));
+
+  std::vector<DownloadTransfer> transfers(sources.size());
+  std::deque<DownloadTransfer*> queuedTransfers;
+  for (size_t transferIndex = 0; transferIndex < transfers.size(); ++transferIndex)
   {
-    vtkErrorMacro("StageFileRead: bad function argument to curl, did you init CurlHandle?");
+    transfers[transferIndex].Source = sources[transferIndex];
+    transfers[transferIndex].Destination = destinations[transferIndex];
+    transfers[transferIndex].Index = transferIndex;
+    queuedTransfers.push_back(&transfers[transferIndex]);
   }
-  else if (retval == CURLE_OUT_OF_MEMORY)
+
+  // Start the next queued transfer using the handle.
+  // Returns false if there are no more transfers to start.
+  std::vector<DownloadTransfer*> activeTransfers;
+  auto startNextTransfer = [&](CURL* handle) -> bool
+  {
+    while (!queuedTransfers.empty())
+    {
+      DownloadTransfer* transfer = queuedTransfers.front();
+      queuedTransfers.pop_front();
+      transfer->Handle = handle;
+      if (!this->Internal->StartDownload(*transfer))
+      {
+        continue;
+      }
+      curl_easy_setopt(handle, CURLOPT_PRIVATE, transfer);
+      curl_multi_add_handle(multiHandle, handle);
+      activeTransfers.push_back(transfer);
+      return true;
+    }
+    return false;
+  };
+
+  int numberOfSucceeded = 0;
+  size_t numberOfHandles = std::min(transfers.size(), static_cast<size_t>(this->MaximumNumberOfParallelTransfers));
+  for (size_t handleIndex = 0; handleIndex < numberOfHandles; ++handleIndex)
   {
-    vtkErrorMacro("StageFileRead: curl ran out of memory!");
+    CURL* handle = this->Internal->AcquireHandle();
+    if (handle == nullptr)
+    {
+      vtkErrorMacro("StageFilesRead: unable to initialise curl");
+      break;
+    }
+    if (!startNextTransfer(handle))
+    {
+      this->Internal->ReleaseHandle(handle);
+      break;
+    }
   }
-  else
+
+  vtkDebugMacro("StageFilesRead: downloading " << transfers.size() << " files using "
+    << activeTransfers.size() << " parallel transfers");
+  while (!activeTransfers.empty())
   {
-    const char *stringError = curl_easy_strerror(retval);
-    vtkErrorMacro("StageFileRead: error running curl: " << stringError);
-    //--- in case the permissions were not correct and that's
-    //--- the reason the read command failed,
-    //--- reset the 'remember check' in the permissions
-    //--- prompter so that new login info  will be prompted.
-    if ( this->GetPermissionPrompter() != nullptr )
+    int numberOfRunningHandles = 0;
+    CURLMcode multiResult = curl_multi_perform(multiHandle, &numberOfRunningHandles);
+    if (multiResult != CURLM_OK)
     {
-      this->GetPermissionPrompter()->SetRemember ( 0 );
+      vtkErrorMacro("StageFilesRead: error running curl: " << curl_multi_strerror(multiResult));
+      break;
+    }
+
+    CURLMsg* message = nullptr;
+    int numberOfMessagesLeft = 0;
+    while ((message = curl_multi_info_read(multiHandle, &numberOfMessagesLeft)) != nullptr)
+    {
+      if (message->msg != CURLMSG_DONE)
+      {
+        continue;
+      }
+      CURL* handle = message->easy_handle;
+      CURLcode curlResult = message->data.result;
+      char* transferPointer = nullptr;
+      curl_easy_getinfo(handle, CURLINFO_PRIVATE, &transferPointer);
+      DownloadTransfer* transfer = reinterpret_cast<DownloadTransfer*>(transferPointer);
+      curl_multi_remove_handle(multiHandle, handle);
+      activeTransfers.erase(std::find(activeTransfers.begin(), activeTransfers.end(), transfer));
+
+      vtkInternal::DownloadResult result = this->Internal->FinishDownload(*transfer, curlResult);
+      if (result == vtkInternal::DownloadCompleted)
+      {
+        ++numberOfSucceeded;
+        if (succeeded)
+        {
+          (*succeeded)[transfer->Index] = true;
+        }
+      }
+      else if (result == vtkInternal::DownloadRestart)
+      {
+        queuedTransfers.push_front(transfer);
+      }
+
+      // Reuse the handle (and its connection) for the next file
+      curl_easy_reset(handle);
+      curl_easy_setopt(handle, CURLOPT_SHARE, this->Internal->Share);
+      if (!startNextTransfer(handle))
+      {
+        this->Internal->ReleaseHandle(handle);
+      }
+    }
+
+    if (!activeTransfers.empty())
+    {
+      curl_multi_wait(multiHandle, nullptr, 0, 1000, nullptr);
     }
   }
-  this->CloseTransfer();
 
-  /*
-  this->LocalFile->close();
-  delete this->LocalFile;
-  this->LocalFile = nullptr;
-  */
-  if (this->LocalFile)
+  // Clean up transfers that were interrupted by an error
+  for (DownloadTransfer* transfer : activeTransfers)
   {
-    fclose(this->LocalFile);
+    curl_multi_remove_handle(multiHandle, transfer->Handle);
+    this->Internal->FinishDownload(*transfer, CURLE_ABORTED_BY_CALLBACK);
+    this->Internal->ReleaseHandle(transfer->Handle);
   }
+  curl_multi_cleanup(multiHandle);
+
+  vtkDebugMacro("StageFilesRead: downloaded " << numberOfSucceeded << " of " << transfers.size() << " files");
+  return numberOfSucceeded;
 }
 
 
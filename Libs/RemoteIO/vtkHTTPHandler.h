@@ -35,6 +35,11 @@ public:
   /// This function wraps curl functionality to download a specified URL to a specified dir
   void StageFileRead(const char * source, const char * destination) override;
   using vtkURIHandler::StageFileRead;
+  bool StageFileReadWithStatus(const char* source, const char* destination) override;
+  /// Download multiple files, using up to MaximumNumberOfParallelTransfers transfers at the same time.
+  int StageFilesRead(const std::vector<std::string>& sources,
+                     const std::vector<std::string>& destinations,
+                     std::vector<bool>* succeeded = nullptr) override;
   void StageFileWrite(const char * source, const char * destination) override;
   using vtkURIHandler::StageFileWrite;
   void InitTransfer () override;
@@ -44,6 +49,26 @@ public:
   vtkSetStringMacro(CaCertificatesPath);
   vtkGetStringMacro(CaCertificatesPath);
 
+  /// Maximum number of files that StageFilesRead() downloads at the same time.
+  /// Connections are kept open and reused between transfers (unless ForbidReuse is set).
+  /// Default is 4.
+  vtkSetClampMacro(MaximumNumberOfParallelTransfers, int, 1, 64);
+  vtkGetMacro(MaximumNumberOfParallelTransfers, int);
+
+  /// If enabled then files are downloaded into a partial file (destination file name
+  /// with GetPartialFileSuffix() appended) that is kept if the download fails and the
+  /// server identified the file version (by a strong ETag or Last-Modified header).
+  /// Next download of the same file requests only the missing bytes using an HTTP
+  /// range request with an If-Range header. If the remote file has changed or the
+  /// server does not support range requests then the whole file is downloaded again.
+  /// Enabled by default.
+  vtkSetMacro(ResumeDownloads, bool);
+  vtkGetMacro(ResumeDownloads, bool);
+  vtkBooleanMacro(ResumeDownloads, bool);
+
+  /// Suffix of file name of partially downloaded files.
+  static const char* GetPartialFileSuffix() { return ".part"; }
+
 protected:
   vtkHTTPHandler();
   ~vtkHTTPHandler() override;
@@ -54,6 +79,8 @@ private:
   class vtkInternal;
   vtkInternal* Internal;
   char* CaCertificatesPath{nullptr};
+  int MaximumNumberOfParallelTransfers{4};
+  bool ResumeDownloads{true};
 };
 
 #endif
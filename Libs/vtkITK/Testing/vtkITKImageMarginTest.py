@@ -0,0 +1,79 @@
+import time
+import unittest
+
+import numpy
+import vtk
+import vtkITK
+from vtk.util import numpy_support as ns
+
+
+"""
+Compares margin computation restricted to the segment bounding box with computation on the whole image
+and reports computation times for a range of margin sizes.
+
+To run as test from slicer python console, replace the following with your source tree path and paste:
+
+exec(open('/path/to/Slicer/Libs/vtkITK/Testing/vtkITKImageMarginTest.py').read()); t = vtkITKImageMarginTest(); t.runTest()
+"""
+
+
+class vtkITKImageMarginTest(unittest.TestCase):
+    def setUp(self):
+        # Small sphere in a large image with anisotropic spacing
+        dims = [200, 180, 120]
+        spacing = [0.5, 0.5, 0.8]
+        center = [100, 80, 60]
+        radiusMm = 8.0
+        k, j, i = numpy.meshgrid(numpy.arange(dims[2]), numpy.arange(dims[1]), numpy.arange(dims[0]), indexing="ij")
+        distanceMm = numpy.sqrt(((i - center[0]) * spacing[0]) ** 2
+                                + ((j - center[1]) * spacing[1]) ** 2
+                                + ((k - center[2]) * spacing[2]) ** 2)
+        voxels = (distanceMm <= radiusMm).astype(numpy.uint8)
+
+        self.image = vtk.vtkImageData()
+        self.image.SetDimensions(dims)
+        self.image.SetSpacing(spacing)
+        self.image.GetPointData().SetScalars(ns.numpy_to_vtk(voxels.ravel(), deep=True))
+
+        self.invertedImage = vtk.vtkImageData()
+        self.invertedImage.SetDimensions(dims)
+        self.invertedImage.SetSpacing(spacing)
+        self.invertedImage.GetPointData().SetScalars(ns.numpy_to_vtk((1 - voxels).ravel(), deep=True))
+
+    def computeMargin(self, image, restrictToBoundingBox, outerMarginMm, innerMarginMm=None):
+        margin = vtkITK.vtkITKImageMargin()
+        margin.SetInputData(image)
+        margin.CalculateMarginInMMOn()
+        margin.SetOuterMarginMM(outerMarginMm)
+        if innerMarginMm is not None:
+            margin.SetInnerMarginMM(innerMarginMm)
+        margin.SetRestrictToBoundingBox(restrictToBoundingBox)
+        startTime = time.time()
+        margin.Update()
+        elapsedTime = time.time() - startTime
+        return ns.vtk_to_numpy(margin.GetOutput().GetPointData().GetScalars()), elapsedTime
+
+    def compareMargin(self, name, image, outerMarginMm, innerMarginMm=None):
+        expected, fullImageTime = self.computeMargin(image, False, outerMarginMm, innerMarginMm)
+        actual, boundingBoxTime = self.computeMargin(image, True, outerMarginMm, innerMarginMm)
+        print(f"{name} outer={outerMarginMm} inner={innerMarginMm}: whole image {fullImageTime:.3f}s, bounding box {boundingBoxTime:.3f}s")
+        self.assertTrue(numpy.array_equal(expected, actual))
+
+    def test_grow(self):
+        for marginMm in [1.0, 2.0, 5.0, 10.0, 20.0]:
+            self.compareMargin("grow", self.image, marginMm)
+
+    def test_shrink(self):
+        # Shrinking is computed by growing the background
+        for marginMm in [1.0, 2.0, 5.0]:
+            self.compareMargin("shrink", self.invertedImage, marginMm)
+
+    def test_shell(self):
+        for thicknessMm in [1.0, 3.0, 6.0]:
+            self.compareMargin("shell", self.image, 0.5 * thicknessMm, -0.5 * thicknessMm)
+
+    def runTest(self):
+        self.setUp()
+        self.test_grow()
+        self.test_shrink()
+        self.test_shell()
@@ -28,6 +28,11 @@
 #include <vtkMath.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
+#include <vtkSMPTools.h>
+
+/// STD includes
+#include <algorithm>
+#include <vector>
 
 /// ITK includes
 #include <itkBinaryThresholdImageFilter.h>
@@ -50,6 +55,7 @@ vtkITKImageMargin::~vtkITKImageMargin() = default;
 void vtkITKImageMargin::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+  os << indent << "RestrictToBoundingBox: " << (this->RestrictToBoundingBox ? "true" : "false") << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -93,6 +99,86 @@ sdfMargin(itk::SmartPointer<ImageType> labelImage, int backgroundValue, double i
   return sdfTh->GetOutput();
 }
 
+//----------------------------------------------------------------------------
+// Get the bounding box of the foreground and background voxels (empty extent if there are none)
+template <class T>
+void vtkITKImageMarginGetBoundingBoxes(T* inPtr, const int dims[3], T backgroundValue,
+  int foregroundExtent[6], int backgroundExtent[6])
+{
+  // bounding boxes of each slice: foreground i and j range, background i and j range
+  std::vector<int> sliceBounds(8 * dims[2]);
+  vtkSMPTools::For(0, dims[2], [&](vtkIdType firstK, vtkIdType lastK)
+  {
+    for (vtkIdType k = firstK; k < lastK; k++)
+    {
+      int* bounds = &sliceBounds[8 * k];
+      bounds[0] = bounds[4] = dims[0];
+      bounds[1] = bounds[5] = -1;
+      bounds[2] = bounds[6] = dims[1];
+      bounds[3] = bounds[7] = -1;
+      T* voxelPtr = inPtr + k * dims[0] * dims[1];
+      for (int j = 0; j < dims[1]; j++)
+      {
+        for (int i = 0; i < dims[0]; i++, voxelPtr++)
+        {
+          int* voxelBounds = (*voxelPtr != backgroundValue ? bounds : bounds + 4);
+          voxelBounds[0] = std::min(voxelBounds[0], i);
+          voxelBounds[1] = std::max(voxelBounds[1], i);
+          voxelBounds[2] = std::min(voxelBounds[2], j);
+          voxelBounds[3] = std::max(voxelBounds[3], j);
+        }
+      }
+    }
+  });
+
+  int* extents[2] = { foregroundExtent, backgroundExtent };
+  for (int extentIndex = 0; extentIndex < 2; extentIndex++)
+  {
+    int* extent = extents[extentIndex];
+    extent[0] = dims[0];
+    extent[1] = -1;
+    extent[2] = dims[1];
+    extent[3] = -1;
+    extent[4] = dims[2];
+    extent[5] = -1;
+    for (int k = 0; k < dims[2]; k++)
+    {
+      const int* bounds = &sliceBounds[8 * k + 4 * extentIndex];
+      if (bounds[0] > bounds[1])
+      {
+        continue;
+      }
+      extent[0] = std::min(extent[0], bounds[0]);
+      extent[1] = std::max(extent[1], bounds[1]);
+      extent[2] = std::min(extent[2], bounds[2]);
+      extent[3] = std::max(extent[3], bounds[3]);
+      extent[4] = std::min(extent[4], k);
+      extent[5] = std::max(extent[5], k);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+// Number of voxels in an extent padded by the specified number of voxels and cropped to the image
+vtkIdType vtkITKImageMarginGetPaddedExtent(const int extent[6], const int padding[3], const int dims[3], int paddedExtent[6])
+{
+  vtkIdType numberOfVoxels = 1;
+  for (int i = 0; i < 3; i++)
+  {
+    if (extent[2 * i] > extent[2 * i + 1])
+    {
+      paddedExtent[2 * i] = 0;
+      paddedExtent[2 * i + 1] = -1;
+      numberOfVoxels = 0;
+      continue;
+    }
+    paddedExtent[2 * i] = std::max(extent[2 * i] - padding[i], 0);
+    paddedExtent[2 * i + 1] = std::min(extent[2 * i + 1] + padding[i], dims[i] - 1);
+    numberOfVoxels *= paddedExtent[2 * i + 1] - paddedExtent[2 * i] + 1;
+  }
+  return numberOfVoxels;
+}
+
 //----------------------------------------------------------------------------
 template <class T>
 void vtkITKImageMarginExecute(vtkITKImageMargin *self, vtkImageData* input,
@@ -105,6 +191,77 @@ void vtkITKImageMarginExecute(vtkITKImageMargin *self, vtkImageData* input,
     input->GetDimensions(dims);
     double spacing[3];
     input->GetSpacing(spacing);
+    const vtkIdType numberOfVoxels = static_cast<vtkIdType>(dims[0]) * dims[1] * dims[2];
+
+    double innerMarginDistance = self->GetInnerMarginVoxels();
+    double outerMarginDistance = self->GetOuterMarginVoxels();
+    double voxelSize[3] = { 1.0, 1.0, 1.0 };
+    if (self->GetCalculateMarginInMM())
+    {
+      innerMarginDistance = self->GetInnerMarginMM();
+      outerMarginDistance = self->GetOuterMarginMM();
+      for (int i = 0; i < 3; i++)
+      {
+        voxelSize[i] = spacing[i];
+      }
+    }
+
+    // Region where the distance map is computed (in voxel indices, starting from 0)
+    int regionExtent[6] = { 0, dims[0] - 1, 0, dims[1] - 1, 0, dims[2] - 1 };
+    vtkIdType numberOfRegionVoxels = numberOfVoxels;
+    // Output value outside the region. Same as the default inside value of itk::BinaryThresholdImageFilter.
+    const T insideValue = itk::NumericTraits<T>::max();
+    T outsideRegionValue = 0;
+
+    if (self->GetRestrictToBoundingBox())
+    {
+      // Voxels that are farther than the margins from the boundary are either fully inside or fully outside,
+      // therefore computing the distance map in the foreground bounding box padded by the margin size
+      // gives exact results (all boundary voxels and all voxels within the margin distance are in the box).
+      double maxMarginDistance = std::abs(outerMarginDistance);
+      if (innerMarginDistance > vtkMath::NegInf())
+      {
+        maxMarginDistance = std::max(maxMarginDistance, std::abs(innerMarginDistance));
+      }
+      int padding[3] = { 0, 0, 0 };
+      for (int i = 0; i < 3; i++)
+      {
+        padding[i] = static_cast<int>(std::min(ceil(maxMarginDistance / std::abs(voxelSize[i])), static_cast<double>(dims[i]))) + 2;
+      }
+      int foregroundExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      int backgroundExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      vtkITKImageMarginGetBoundingBoxes<T>(inPtr, dims, static_cast<T>(self->GetBackgroundValue()), foregroundExtent, backgroundExtent);
+      int paddedForegroundExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      int paddedBackgroundExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      vtkIdType numberOfForegroundRegionVoxels = vtkITKImageMarginGetPaddedExtent(foregroundExtent, padding, dims, paddedForegroundExtent);
+      vtkIdType numberOfBackgroundRegionVoxels = vtkITKImageMarginGetPaddedExtent(backgroundExtent, padding, dims, paddedBackgroundExtent);
+
+      // If the output contains all the foreground (no inner margin), such as when the background
+      // is grown to shrink a segment, then the background bounding box can be used the same way:
+      // voxels outside of it are all inside the output, regardless of their distance from the boundary.
+      bool outputContainsForeground = (innerMarginDistance == vtkMath::NegInf() && outerMarginDistance >= 0.0);
+      if (outputContainsForeground && numberOfBackgroundRegionVoxels < numberOfForegroundRegionVoxels)
+      {
+        std::copy(paddedBackgroundExtent, paddedBackgroundExtent + 6, regionExtent);
+        numberOfRegionVoxels = numberOfBackgroundRegionVoxels;
+        outsideRegionValue = insideValue;
+      }
+      else
+      {
+        std::copy(paddedForegroundExtent, paddedForegroundExtent + 6, regionExtent);
+        numberOfRegionVoxels = numberOfForegroundRegionVoxels;
+        outsideRegionValue = 0;
+      }
+    }
+
+    if (numberOfRegionVoxels < numberOfVoxels)
+    {
+      std::fill(outPtr, outPtr + numberOfVoxels, outsideRegionValue);
+      if (numberOfRegionVoxels == 0)
+      {
+        return;
+      }
+    }
 
     // Wrap scalars into an ITK image
     // - mostly rely on defaults for spacing, origin etc for this filter
@@ -114,28 +271,68 @@ void vtkITKImageMarginExecute(vtkITKImageMargin *self, vtkImageData* input,
     typename ImageType::IndexType index;
     typename ImageType::SizeType size;
 
-    inImage->GetPixelContainer()->SetImportPointer(inPtr, dims[0] * dims[1] * dims[2], false);
+    int regionDims[3] = { 0, 0, 0 };
+    for (int i = 0; i < 3; i++)
+    {
+      regionDims[i] = regionExtent[2 * i + 1] - regionExtent[2 * i] + 1;
+    }
+    std::vector<T> regionBuffer;
+    if (numberOfRegionVoxels < numberOfVoxels)
+    {
+      // Copy the region into a contiguous buffer
+      regionBuffer.resize(numberOfRegionVoxels);
+      vtkSMPTools::For(0, regionDims[2], [&](vtkIdType firstK, vtkIdType lastK)
+      {
+        for (vtkIdType k = firstK; k < lastK; k++)
+        {
+          for (int j = 0; j < regionDims[1]; j++)
+          {
+            T* rowPtr = inPtr + ((k + regionExtent[4]) * dims[1] + j + regionExtent[2]) * dims[0] + regionExtent[0];
+            std::copy(rowPtr, rowPtr + regionDims[0], regionBuffer.begin() + (k * regionDims[1] + j) * regionDims[0]);
+          }
+        }
+      });
+      inImage->GetPixelContainer()->SetImportPointer(regionBuffer.data(), numberOfRegionVoxels, false);
+    }
+    else
+    {
+      inImage->GetPixelContainer()->SetImportPointer(inPtr, numberOfVoxels, false);
+    }
     index[0] = index[1] = index[2] = 0;
     region.SetIndex(index);
-    size[0] = dims[0]; size[1] = dims[1]; size[2] = dims[2];
+    size[0] = regionDims[0]; size[1] = regionDims[1]; size[2] = regionDims[2];
     region.SetSize(size);
     inImage->SetLargestPossibleRegion(region);
     inImage->SetBufferedRegion(region);
-
-    double innerMarginDistance = self->GetInnerMarginVoxels();
-    double outerMarginDistance = self->GetOuterMarginVoxels();
     if (self->GetCalculateMarginInMM())
     {
       inImage->SetSpacing(spacing);
-      innerMarginDistance = self->GetInnerMarginMM();
-      outerMarginDistance = self->GetOuterMarginMM();
     }
 
     itk::SmartPointer<ImageType> outputImage;
     outputImage = sdfMargin<ImageType>(inImage, self->GetBackgroundValue(), innerMarginDistance, outerMarginDistance);
 
     // Copy to the output
-    memcpy(outPtr, outputImage->GetBufferPointer(), outputImage->GetBufferedRegion().GetNumberOfPixels() * sizeof(T));
+    T* regionOutPtr = outputImage->GetBufferPointer();
+    if (numberOfRegionVoxels < numberOfVoxels)
+    {
+      vtkSMPTools::For(0, regionDims[2], [&](vtkIdType firstK, vtkIdType lastK)
+      {
+        for (vtkIdType k = firstK; k < lastK; k++)
+        {
+          for (int j = 0; j < regionDims[1]; j++)
+          {
+            T* rowPtr = regionOutPtr + (k * regionDims[1] + j) * regionDims[0];
+            std::copy(rowPtr, rowPtr + regionDims[0],
+              outPtr + ((k + regionExtent[4]) * dims[1] + j + regionExtent[2]) * dims[0] + regionExtent[0]);
+          }
+        }
+      });
+    }
+    else
+    {
+      memcpy(outPtr, regionOutPtr, numberOfVoxels * sizeof(T));
+    }
   }
   catch (itk::ExceptionObject & err)
   {
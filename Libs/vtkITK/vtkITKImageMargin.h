@@ -69,6 +69,14 @@ class VTK_ITK_EXPORT vtkITKImageMargin : public vtkSimpleImageToImageFilter
   vtkGetMacro(InnerMarginVoxels, double);
   vtkSetMacro(InnerMarginVoxels, double);
 
+  /// If enabled (default) then the distance map is only computed in the bounding box of the foreground
+  /// (or of the background, whichever is smaller), padded by the margin size.
+  /// The result is the same as computing it for the whole image, but computation time and memory usage
+  /// depend on the size of the segment instead of the size of the image.
+  vtkGetMacro(RestrictToBoundingBox, bool);
+  vtkSetMacro(RestrictToBoundingBox, bool);
+  vtkBooleanMacro(RestrictToBoundingBox, bool);
+
 protected:
   int BackgroundValue{0};
   bool CalculateMarginInMM{true};
@@ -76,6 +84,7 @@ protected:
   double InnerMarginMM{0.0};
   double OuterMarginVoxels{0.0};
   double InnerMarginVoxels{0.0};
+  bool RestrictToBoundingBox{true};
 
 protected:
   vtkITKImageMargin();
@@ -0,0 +1,276 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkIdList.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPolyData.h>
+#include <vtkTimerLog.h>
+
+// SegmentationCore includes
+#include "vtkBinaryLabelmapToClosedSurfaceConversionRule.h"
+#include "vtkOrientedImageData.h"
+#include "vtkSegment.h"
+#include "vtkSegmentation.h"
+#include "vtkSegmentationConverterFactory.h"
+
+// STD includes
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+const int NUMBER_OF_LABELS_PER_ROW = 10;
+const int LABEL_SIZE = 8;
+const int LABEL_SPACING = 10;
+
+//----------------------------------------------------------------------------
+/// Create an atlas-like labelmap with NUMBER_OF_LABELS_PER_ROW^2 labels.
+/// Labels are blocks with rounded corners, every second row of labels touch each other.
+void CreateAtlasLabelmap(vtkOrientedImageData* labelmap)
+{
+  int size = NUMBER_OF_LABELS_PER_ROW * LABEL_SPACING;
+  labelmap->SetExtent(0, size - 1, 0, size - 1, 0, LABEL_SPACING - 1);
+  labelmap->SetSpacing(0.5, 0.6, 0.7);
+  labelmap->SetOrigin(10.0, 20.0, 30.0);
+  labelmap->AllocateScalars(VTK_SHORT, 1);
+  short* voxels = static_cast<short*>(labelmap->GetScalarPointer());
+  for (int k = 0; k < LABEL_SPACING; ++k)
+  {
+    for (int j = 0; j < size; ++j)
+    {
+      for (int i = 0; i < size; ++i)
+      {
+        int row = j / LABEL_SPACING;
+        int column = i / LABEL_SPACING;
+        // Labels in odd rows fill the whole block, so that they have common boundaries
+        int labelSize = (row % 2) ? LABEL_SPACING : LABEL_SIZE;
+        int di = i % LABEL_SPACING;
+        int dj = j % LABEL_SPACING;
+        bool corner = (di == 0 || di == labelSize - 1) && (dj == 0 || dj == labelSize - 1);
+        bool inside = di < labelSize && dj < labelSize && k > 0 && k < LABEL_SIZE && !corner;
+        *(voxels++) = inside ? static_cast<short>(row * NUMBER_OF_LABELS_PER_ROW + column + 1) : 0;
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+/// Compute signed volume enclosed by a closed surface.
+/// The volume is positive if the face normals point outward.
+double GetSignedVolume(vtkPolyData* surface)
+{
+  double volume = 0.0;
+  vtkCellArray* polys = surface->GetPolys();
+  vtkNew<vtkIdList> facePointIds;
+  for (vtkIdType faceId = 0; faceId < surface->GetNumberOfPolys(); ++faceId)
+  {
+    vtkIdType numberOfFacePoints = 0;
+    const vtkIdType* facePoints = nullptr;
+    polys->GetCellAtId(faceId, numberOfFacePoints, facePoints, facePointIds);
+    double p0[3] = { 0.0, 0.0, 0.0 };
+    surface->GetPoint(facePoints[0], p0);
+    for (vtkIdType i = 1; i + 1 < numberOfFacePoints; ++i)
+    {
+      double p1[3] = { 0.0, 0.0, 0.0 };
+      double p2[3] = { 0.0, 0.0, 0.0 };
+      surface->GetPoint(facePoints[i], p1);
+      surface->GetPoint(facePoints[i + 1], p2);
+      double cross[3] = { 0.0, 0.0, 0.0 };
+      vtkMath::Cross(p1, p2, cross);
+      volume += vtkMath::Dot(p0, cross) / 6.0;
+    }
+  }
+  return volume;
+}
+
+//----------------------------------------------------------------------------
+double ConvertToClosedSurface(vtkSegmentation* segmentation, bool multiLabel,
+  std::vector<vtkIdType>& numberOfPolys, std::vector<vtkIdType>& numberOfPoints,
+  std::vector<double>& signedVolumes)
+{
+  segmentation->SetConversionParameter(
+    vtkBinaryLabelmapToClosedSurfaceConversionRule::GetMultiLabelConversionParameterName(), multiLabel ? "1" : "0");
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  segmentation->CreateRepresentation(vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName(), true);
+  timer->StopTimer();
+  numberOfPolys.clear();
+  numberOfPoints.clear();
+  signedVolumes.clear();
+  std::vector<std::string> segmentIDs;
+  segmentation->GetSegmentIDs(segmentIDs);
+  for (const std::string& segmentID : segmentIDs)
+  {
+    vtkPolyData* surface = vtkPolyData::SafeDownCast(segmentation->GetSegment(segmentID)->GetRepresentation(
+      vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName()));
+    numberOfPolys.push_back(surface ? surface->GetNumberOfPolys() : -1);
+    numberOfPoints.push_back(surface ? surface->GetNumberOfPoints() : -1);
+    signedVolumes.push_back(surface ? GetSignedVolume(surface) : 0.0);
+  }
+  return timer->GetElapsedTime();
+}
+
+//----------------------------------------------------------------------------
+/// Check that multi-label and single-label conversion generate the same meshes with the current parameters.
+int CheckSameAsSingleLabelConversion(vtkSegmentation* segmentation, int line)
+{
+  std::vector<vtkIdType> singleLabelPolys;
+  std::vector<vtkIdType> singleLabelPoints;
+  std::vector<double> singleLabelVolumes;
+  ConvertToClosedSurface(segmentation, false, singleLabelPolys, singleLabelPoints, singleLabelVolumes);
+  std::vector<vtkIdType> multiLabelPolys;
+  std::vector<vtkIdType> multiLabelPoints;
+  std::vector<double> multiLabelVolumes;
+  ConvertToClosedSurface(segmentation, true, multiLabelPolys, multiLabelPoints, multiLabelVolumes);
+  for (size_t labelIndex = 0; labelIndex < singleLabelPolys.size(); ++labelIndex)
+  {
+    if (singleLabelPolys[labelIndex] <= 0
+      || singleLabelPolys[labelIndex] != multiLabelPolys[labelIndex]
+      || singleLabelPoints[labelIndex] != multiLabelPoints[labelIndex]
+      || std::abs(singleLabelVolumes[labelIndex] - multiLabelVolumes[labelIndex]) > 1e-6 * std::abs(singleLabelVolumes[labelIndex]))
+    {
+      std::cerr << line << ": Mismatch in surface of label " << labelIndex + 1 << ":"
+        << " single-label conversion: " << singleLabelPolys[labelIndex] << " polys, " << singleLabelPoints[labelIndex] << " points, "
+        << singleLabelVolumes[labelIndex] << " volume,"
+        << " multi-label conversion: " << multiLabelPolys[labelIndex] << " polys, " << multiLabelPoints[labelIndex] << " points, "
+        << multiLabelVolumes[labelIndex] << " volume" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+/// Check that normals of all surfaces created by multi-label conversion point outward.
+int CheckMultiLabelSurfaceOrientation(vtkSegmentation* segmentation, int line)
+{
+  std::vector<vtkIdType> multiLabelPolys;
+  std::vector<vtkIdType> multiLabelPoints;
+  std::vector<double> multiLabelVolumes;
+  ConvertToClosedSurface(segmentation, true, multiLabelPolys, multiLabelPoints, multiLabelVolumes);
+  for (size_t labelIndex = 0; labelIndex < multiLabelPolys.size(); ++labelIndex)
+  {
+    if (multiLabelPolys[labelIndex] <= 0 || multiLabelVolumes[labelIndex] <= 0.0)
+    {
+      std::cerr << line << ": Invalid surface of label " << labelIndex + 1 << ": "
+        << multiLabelPolys[labelIndex] << " polys, signed volume: " << multiLabelVolumes[labelIndex] << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int vtkBinaryLabelmapToClosedSurfaceConversionTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
+    vtkSmartPointer<vtkBinaryLabelmapToClosedSurfaceConversionRule>::New());
+
+  // Create segmentation with all segments in one shared labelmap
+  vtkNew<vtkOrientedImageData> labelmap;
+  CreateAtlasLabelmap(labelmap);
+  vtkNew<vtkSegmentation> segmentation;
+  segmentation->SetSourceRepresentationName(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName());
+  int numberOfLabels = NUMBER_OF_LABELS_PER_ROW * NUMBER_OF_LABELS_PER_ROW;
+  for (int labelValue = 1; labelValue <= numberOfLabels; ++labelValue)
+  {
+    vtkNew<vtkSegment> segment;
+    std::stringstream name;
+    name << "Label_" << labelValue;
+    segment->SetName(name.str().c_str());
+    segment->SetLabelValue(labelValue);
+    segment->AddRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName(), labelmap);
+    segmentation->AddSegment(segment);
+  }
+  if (segmentation->GetNumberOfSegments() != numberOfLabels)
+  {
+    std::cerr << __LINE__ << ": Failed to add segments to segmentation" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Without smoothing and decimation, multi-label conversion must generate the same meshes
+  // as converting each segment separately using SurfaceNets, with outward pointing normals.
+  segmentation->SetConversionParameter(vtkBinaryLabelmapToClosedSurfaceConversionRule::GetConversionMethodParameterName(),
+    vtkBinaryLabelmapToClosedSurfaceConversionRule::CONVERSION_METHOD_SURFACE_NETS);
+  segmentation->SetConversionParameter(vtkBinaryLabelmapToClosedSurfaceConversionRule::GetSmoothingFactorParameterName(), "0.0");
+  if (CheckSameAsSingleLabelConversion(segmentation, __LINE__) != EXIT_SUCCESS
+    || CheckMultiLabelSurfaceOrientation(segmentation, __LINE__) != EXIT_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Multi-label conversion is not used with flying edges conversion method
+  segmentation->SetConversionParameter(vtkBinaryLabelmapToClosedSurfaceConversionRule::GetConversionMethodParameterName(),
+    vtkBinaryLabelmapToClosedSurfaceConversionRule::CONVERSION_METHOD_FLYING_EDGES);
+  segmentation->SetConversionParameter(vtkBinaryLabelmapToClosedSurfaceConversionRule::GetSmoothingFactorParameterName(), "0.5");
+  if (CheckSameAsSingleLabelConversion(segmentation, __LINE__) != EXIT_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Multi-label conversion is not used with SurfaceNets internal smoothing without joint smoothing
+  segmentation->SetConversionParameter(vtkBinaryLabelmapToClosedSurfaceConversionRule::GetConversionMethodParameterName(),
+    vtkBinaryLabelmapToClosedSurfaceConversionRule::CONVERSION_METHOD_SURFACE_NETS);
+  segmentation->SetConversionParameter(vtkBinaryLabelmapToClosedSurfaceConversionRule::GetSurfaceNetInternalSmoothingParameterName(), "1");
+  if (CheckSameAsSingleLabelConversion(segmentation, __LINE__) != EXIT_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+  segmentation->SetConversionParameter(vtkBinaryLabelmapToClosedSurfaceConversionRule::GetSurfaceNetInternalSmoothingParameterName(), "0");
+
+  // Normals point outward after smoothing and joint smoothing
+  if (CheckMultiLabelSurfaceOrientation(segmentation, __LINE__) != EXIT_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+  segmentation->SetConversionParameter(vtkBinaryLabelmapToClosedSurfaceConversionRule::GetJointSmoothingParameterName(), "1");
+  if (CheckMultiLabelSurfaceOrientation(segmentation, __LINE__) != EXIT_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+  segmentation->SetConversionParameter(vtkBinaryLabelmapToClosedSurfaceConversionRule::GetJointSmoothingParameterName(), "0");
+
+  // Compare conversion time with default smoothing
+  std::vector<vtkIdType> singleLabelPolys;
+  std::vector<vtkIdType> singleLabelPoints;
+  std::vector<double> singleLabelVolumes;
+  double singleLabelTime = ConvertToClosedSurface(segmentation, false, singleLabelPolys, singleLabelPoints, singleLabelVolumes);
+  std::vector<vtkIdType> multiLabelPolys;
+  std::vector<vtkIdType> multiLabelPoints;
+  std::vector<double> multiLabelVolumes;
+  double multiLabelTime = ConvertToClosedSurface(segmentation, true, multiLabelPolys, multiLabelPoints, multiLabelVolumes);
+  for (int labelIndex = 0; labelIndex < numberOfLabels; ++labelIndex)
+  {
+    if (multiLabelPolys[labelIndex] <= 0)
+    {
+      std::cerr << __LINE__ << ": Multi-label conversion with smoothing failed for label " << labelIndex + 1 << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  std::cout << "Conversion of " << numberOfLabels << " labels:" << std::endl
+    << "  single-label conversion: " << singleLabelTime << "s" << std::endl
+    << "  multi-label conversion: " << multiLabelTime << "s" << std::endl;
+
+  std::cout << "Binary labelmap to closed surface conversion test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
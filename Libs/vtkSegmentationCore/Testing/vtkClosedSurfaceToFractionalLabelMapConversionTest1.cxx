@@ -132,6 +132,25 @@ int vtkClosedSurfaceToFractionalLabelMapConversionTest1(int vtkNotUsed(argc), ch
     return EXIT_FAILURE;
   }
 
+  // Scanline voxelizer must give the same extent and range, and a similar mean value
+  sphereSegmentation->SetConversionParameter(vtkClosedSurfaceToBinaryLabelmapConversionRule::GetConversionMethodParameterName(),
+    vtkClosedSurfaceToBinaryLabelmapConversionRule::CONVERSION_METHOD_SCANLINE);
+  sphereSegmentation->CreateRepresentation(vtkSegmentationConverter::GetSegmentationFractionalLabelmapRepresentationName(), true);
+  fractionalLabelmap = vtkOrientedImageData::SafeDownCast(
+    sphereSegment->GetRepresentation(vtkSegmentationConverter::GetSegmentationFractionalLabelmapRepresentationName()));
+  imageAccumulate->SetInputData(fractionalLabelmap);
+  imageAccumulate->Update();
+  if (imageAccumulate->GetVoxelCount() != expectedVoxelCount
+    || imageAccumulate->GetMax()[0] != expectedMaxValue
+    || imageAccumulate->GetMin()[0] != expectedMinValue
+    || std::abs(imageAccumulate->GetMean()[0] - expectedMeanValue) > 0.5)
+  {
+    std::cerr << __LINE__ << ": Scanline fractional labelmap mismatch: voxel count: " << imageAccumulate->GetVoxelCount()
+      << ", min: " << imageAccumulate->GetMin()[0] << ", max: " << imageAccumulate->GetMax()[0]
+      << ", mean: " << imageAccumulate->GetMean()[0] << std::endl;
+    return EXIT_FAILURE;
+  }
+
   std::cout << "Closed surface to fractional labelmap conversion test passed." << std::endl;
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,134 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VTK includes
+#include <vtkImageAccumulate.h>
+#include <vtkImageThreshold.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+
+// SegmentationCore includes
+#include "vtkClosedSurfaceToBinaryLabelmapConversionRule.h"
+#include "vtkClosedSurfaceVoxelizer.h"
+#include "vtkOrientedImageData.h"
+#include "vtkSegment.h"
+#include "vtkSegmentation.h"
+#include "vtkSegmentationConverterFactory.h"
+
+// STD includes
+#include <cmath>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+int GetVoxelCount(vtkImageData* labelmap, int labelValue)
+{
+  vtkNew<vtkImageThreshold> threshold;
+  threshold->SetInputData(labelmap);
+  threshold->SetInValue(1);
+  threshold->SetOutValue(0);
+  threshold->ThresholdBetween(labelValue, labelValue);
+  vtkNew<vtkImageAccumulate> accumulate;
+  accumulate->SetInputConnection(threshold->GetOutputPort());
+  accumulate->IgnoreZeroOn();
+  accumulate->Update();
+  return accumulate->GetVoxelCount();
+}
+
+//----------------------------------------------------------------------------
+int ConvertToLabelmap(vtkSegmentation* segmentation, const std::string& conversionMethod)
+{
+  segmentation->SetConversionParameter(
+    vtkClosedSurfaceToBinaryLabelmapConversionRule::GetConversionMethodParameterName(), conversionMethod);
+  segmentation->CreateRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName(), true);
+  vtkSegment* segment = segmentation->GetNthSegment(0);
+  vtkOrientedImageData* labelmap = vtkOrientedImageData::SafeDownCast(
+    segment->GetRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()));
+  return labelmap ? GetVoxelCount(labelmap, segment->GetLabelValue()) : -1;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int vtkClosedSurfaceVoxelizerTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
+    vtkSmartPointer<vtkClosedSurfaceToBinaryLabelmapConversionRule>::New());
+
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetCenter(12.3, -4.5, 20.1);
+  sphere->SetRadius(20.0);
+  sphere->SetThetaResolution(60);
+  sphere->SetPhiResolution(60);
+  sphere->Update();
+
+  // Oblique reference geometry with anisotropic spacing
+  vtkNew<vtkOrientedImageData> referenceGeometry;
+  vtkNew<vtkMatrix4x4> directions;
+  double angle = 0.3;
+  directions->SetElement(0, 0, std::cos(angle));
+  directions->SetElement(0, 1, -std::sin(angle));
+  directions->SetElement(1, 0, std::sin(angle));
+  directions->SetElement(1, 1, std::cos(angle));
+  referenceGeometry->SetDirectionMatrix(directions);
+  referenceGeometry->SetSpacing(0.8, 0.9, 1.3);
+  referenceGeometry->SetOrigin(-50.0, -50.0, -50.0);
+  referenceGeometry->SetExtent(0, 140, 0, 130, 0, 100);
+
+  vtkNew<vtkSegmentation> segmentation;
+  segmentation->SetSourceRepresentationName(vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName());
+  vtkNew<vtkSegment> segment;
+  segment->SetName("sphere");
+  segment->AddRepresentation(vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName(), sphere->GetOutput());
+  segmentation->AddSegment(segment);
+  segmentation->SetConversionParameter(vtkSegmentationConverter::GetReferenceImageGeometryParameterName(),
+    vtkSegmentationConverter::SerializeImageGeometry(referenceGeometry));
+
+  // Scanline voxelizer result must be close to the image stencil result
+  int stencilVoxelCount = ConvertToLabelmap(segmentation, vtkClosedSurfaceToBinaryLabelmapConversionRule::CONVERSION_METHOD_IMAGE_STENCIL);
+  int scanlineVoxelCount = ConvertToLabelmap(segmentation, vtkClosedSurfaceToBinaryLabelmapConversionRule::CONVERSION_METHOD_SCANLINE);
+  if (stencilVoxelCount <= 0 || std::abs(scanlineVoxelCount - stencilVoxelCount) > 0.01 * stencilVoxelCount)
+  {
+    std::cerr << __LINE__ << ": Voxel count mismatch: image stencil: " << stencilVoxelCount
+      << ", scanline voxelizer: " << scanlineVoxelCount << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Voxelizer must not modify voxels outside the surface, so that it can write into a shared labelmap
+  vtkOrientedImageData* labelmap = vtkOrientedImageData::SafeDownCast(
+    segment->GetRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()));
+  int* extent = labelmap->GetExtent();
+  unsigned char* cornerVoxel = static_cast<unsigned char*>(labelmap->GetScalarPointer(extent[0], extent[2], extent[4]));
+  *cornerVoxel = 5;
+  vtkNew<vtkClosedSurfaceVoxelizer> voxelizer;
+  voxelizer->SetFillValue(3);
+  if (!voxelizer->Voxelize(sphere->GetOutput(), labelmap))
+  {
+    std::cerr << __LINE__ << ": Voxelization failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (*cornerVoxel != 5 || GetVoxelCount(labelmap, 3) != scanlineVoxelCount || GetVoxelCount(labelmap, 1) != 0)
+  {
+    std::cerr << __LINE__ << ": Voxelizing into existing labelmap failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Closed surface voxelizer test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -86,6 +86,117 @@ int GetVoxelCount(vtkImageData* labelmap, int labelValue)
   return accumulate->GetVoxelCount();
 }
 
+//----------------------------------------------------------------------------
+void FillBox(vtkOrientedImageData* labelmap, int boxSize)
+{
+  unsigned char* imagePtr = static_cast<unsigned char*>(labelmap->GetScalarPointer());
+  int dims[3] = { 0, 0, 0 };
+  labelmap->GetDimensions(dims);
+  for (int k = 0; k < dims[2]; k++)
+  {
+    for (int j = 0; j < dims[1]; j++)
+    {
+      for (int i = 0; i < dims[0]; i++)
+      {
+        *(imagePtr++) = (i < boxSize && j < boxSize && k < boxSize) ? 1 : 0;
+      }
+    }
+  }
+  labelmap->Modified();
+}
+
+//----------------------------------------------------------------------------
+/// Save a state for each box size, starting with the smallest box
+void SaveBoxStates(vtkSegmentationHistory* history, vtkOrientedImageData* labelmap, const std::vector<int>& boxSizes)
+{
+  for (int boxSize : boxSizes)
+  {
+    FillBox(labelmap, boxSize);
+    history->SaveState();
+  }
+}
+
+//----------------------------------------------------------------------------
+int TestMemoryLimitEvictionOrder()
+{
+  int extent[6] = { 0, 63, 0, 63, 0, 63 };
+  const vtkTypeInt64 uncompressedImageSize = 64 * 64 * 64;
+  std::vector<int> boxSizes = { 4, 8, 12, 16, 20, 24 };
+  const int numberOfStates = static_cast<int>(boxSizes.size());
+
+  vtkNew<vtkSegment> segment;
+  segment->SetLabelValue(1);
+  vtkNew<vtkOrientedImageData> labelmap;
+  labelmap->SetExtent(extent);
+  labelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  FillBox(labelmap, 0);
+  segment->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), labelmap);
+  vtkNew<vtkSegmentation> segmentation;
+  segmentation->AddSegment(segment);
+
+  // Measure the memory used by all the states without limit
+  vtkTypeInt64 allStatesMemorySize = 0;
+  {
+    vtkNew<vtkSegmentationHistory> history;
+    history->SetMaximumMemorySizeBytes(0);
+    history->SetSegmentation(segmentation);
+    SaveBoxStates(history, labelmap, boxSizes);
+    CHECK_INT(history->GetNumberOfStates(), numberOfStates);
+    allStatesMemorySize = history->GetMemorySizeBytes();
+    if (allStatesMemorySize <= 0 || allStatesMemorySize >= uncompressedImageSize * numberOfStates / 2)
+    {
+      std::cerr << "Line " << __LINE__ << ": Unexpected memory size of compressed states: " << allStatesMemorySize << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // States are counted with their compressed size (even if saved while compression of previous states
+  // is still in progress), therefore all the states fit in the memory limit.
+  vtkNew<vtkSegmentationHistory> history;
+  history->SetMaximumMemorySizeBytes(allStatesMemorySize + 1024);
+  history->SetSegmentation(segmentation);
+  SaveBoxStates(history, labelmap, boxSizes);
+  CHECK_INT(history->GetNumberOfStates(), numberOfStates);
+
+  // Decreasing the limit removes the oldest states
+  vtkTypeInt64 memoryLimit = allStatesMemorySize * 2 / 3;
+  history->SetMaximumMemorySizeBytes(memoryLimit);
+  int numberOfRemainingStates = history->GetNumberOfStates();
+  if (numberOfRemainingStates >= numberOfStates || numberOfRemainingStates < 1)
+  {
+    std::cerr << "Line " << __LINE__ << ": Unexpected number of states after decreasing memory limit: "
+      << numberOfRemainingStates << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (numberOfRemainingStates > 1 && history->GetMemorySizeBytes() > memoryLimit)
+  {
+    std::cerr << "Line " << __LINE__ << ": Memory size " << history->GetMemorySizeBytes()
+      << " exceeds the limit " << memoryLimit << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The most recent states are kept: walk back in the history and check the restored content
+  int lastBoxSize = boxSizes[numberOfStates - 1];
+  CHECK_INT(GetVoxelCount(labelmap, 1), lastBoxSize * lastBoxSize * lastBoxSize);
+  for (int stateIndex = numberOfStates - 2; stateIndex >= numberOfStates - numberOfRemainingStates; stateIndex--)
+  {
+    CHECK_INT(history->IsRestorePreviousStateAvailable(), true);
+    CHECK_INT(history->RestorePreviousState(), true);
+    vtkOrientedImageData* restoredLabelmap = vtkOrientedImageData::SafeDownCast(
+      segment->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+    int boxSize = boxSizes[stateIndex];
+    CHECK_INT(GetVoxelCount(restoredLabelmap, 1), boxSize * boxSize * boxSize);
+  }
+  CHECK_INT(history->IsRestorePreviousStateAvailable(), false);
+
+  // The last restored state is never removed
+  history->SetMaximumMemorySizeBytes(1);
+  CHECK_INT(history->IsRestoreNextStateAvailable(), true);
+  CHECK_INT(history->IsRestorePreviousStateAvailable(), false);
+
+  return EXIT_SUCCESS;
+}
+
 //----------------------------------------------------------------------------
 int vtkSegmentationHistoryTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
 {
@@ -243,6 +354,22 @@ int vtkSegmentationHistoryTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
   // restoring previous state saves the current modified state
   CHECK_INT(history->GetNumberOfStates(), 3);
 
+  // Memory limit removes the oldest states (but not the restored state)
+  if (history->GetMemorySizeBytes() <= 0)
+  {
+    std::cerr << "Segmentation history memory size is expected to be positive" << std::endl;
+    return EXIT_FAILURE;
+  }
+  history->SetMaximumMemorySizeBytes(1);
+  CHECK_INT(history->GetNumberOfStates(), 2);
+  CHECK_INT(history->IsRestorePreviousStateAvailable(), false);
+  CHECK_INT(history->IsRestoreNextStateAvailable(), true);
+
+  if (TestMemoryLimitEvictionOrder() != EXIT_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+
   std::cout << "Segmentation history test 1 passed." << std::endl;
   return EXIT_SUCCESS;
 }
@@ -51,6 +51,7 @@
 #include <vtkUnstructuredGrid.h>
 #include <vtkWindowedSincPolyDataFilter.h>
 #include <vtkMatrix3x3.h>
+#include <vtkMatrix4x4.h>
 #include <vtkReverseSense.h>
 #include <vtkStringToNumeric.h>
 #include <vtkStringArray.h>
@@ -62,6 +63,15 @@
 #include <vtkInformation.h>
 #include <vtkExtractSelection.h>
 #include <vtkSelectionSource.h>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkIdList.h>
+#include <vtkMath.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+
+// STD includes
+#include <algorithm>
 
 //----------------------------------------------------------------------------
 const std::string vtkBinaryLabelmapToClosedSurfaceConversionRule::CONVERSION_METHOD_FLYING_EDGES = std::string("0");
@@ -70,6 +80,247 @@ const std::string vtkBinaryLabelmapToClosedSurfaceConversionRule::CONVERSION_MET
 //----------------------------------------------------------------------------
 vtkSegmentationConverterRuleNewMacro(vtkBinaryLabelmapToClosedSurfaceConversionRule);
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Get all label values that occur in the labelmap (except 0)
+std::vector<int> GetLabelValuesInImage(vtkImageData* labelmap)
+{
+  double* scalarRange = labelmap->GetScalarRange();
+  int lowLabel = (int)(floor(scalarRange[0]));
+  int highLabel = (int)(ceil(scalarRange[1]));
+
+  vtkNew<vtkImageAccumulate> imageAccumulate;
+  imageAccumulate->SetInputData(labelmap);
+  imageAccumulate->IgnoreZeroOn();
+  imageAccumulate->SetComponentOrigin(0, 0, 0);
+  imageAccumulate->SetComponentSpacing(1, 1, 1);
+  imageAccumulate->SetComponentExtent(lowLabel, highLabel, 0, 0, 0, 0);
+  imageAccumulate->Update();
+
+  std::vector<int> labelValues;
+  for (int labelValue = lowLabel; labelValue <= highLabel; ++labelValue)
+  {
+    // Add a new threshold for every level in the labelmap
+    double numberOfVoxels = imageAccumulate->GetOutput()->GetPointData()->GetScalars()->GetTuple1((int)labelValue - lowLabel);
+    if (numberOfVoxels > 0.0)
+    {
+      labelValues.push_back(labelValue);
+    }
+  }
+  return labelValues;
+}
+
+//----------------------------------------------------------------------------
+/// Number of iterations of vtkSurfaceNets3D internal smoothing
+int GetSurfaceNetsSmoothingIterations(double smoothingFactor)
+{
+  // This formula maps (input) -> (iteration count)
+  // 0.0  ->  0   (almost no smoothing)
+  // 0.2  ->  2   (little smoothing)
+  // 0.5  ->  8   (average smoothing)
+  // 0.7  ->  14  (strong smoothing)
+  // 1.0  ->  24  (very strong smoothing)
+  double fCount = 15.0 * smoothingFactor * smoothingFactor + 9.0 * smoothingFactor;
+  return floor(fCount);
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> SmoothSurface(vtkPolyData* surface, double smoothingFactor)
+{
+  vtkSmartPointer<vtkWindowedSincPolyDataFilter> smoother = vtkSmartPointer<vtkWindowedSincPolyDataFilter>::New();
+  smoother->SetInputData(surface);
+
+  // Smoothing factor is a user-friendly linear scale that we need to maps to low-pass filter parameters.
+  // Default smoothing aims for removing blocky appearance (staircase artifacts) while avoiding shrinking.
+  // Typically a few ten iterations are sufficient, but stronger smoothing requires more iterations.
+  //
+  //   Smoothing factor                             Passband   Iterations
+  //
+  //     0.0  (almost no smoothing, blocky)      ->   1.0          20
+  //     0.25 (less smoothing, somewhat blocky)  ->   0.1          30
+  //     0.5  (default smoothing)                ->   0.01         40
+  //     0.75 (more smoothing, somewhat shrinks) ->   0.001        50
+  //     1.0  (very strong smoothing, shrinks)   ->   0.0001       60
+  //
+  double passBand = pow(10.0, -4.0 * smoothingFactor);
+  int numberOfIterations = 20 + smoothingFactor * 40;
+
+  smoother->SetNumberOfIterations(numberOfIterations);
+  smoother->SetPassBand(passBand);
+  smoother->BoundarySmoothingOff();
+  smoother->FeatureEdgeSmoothingOff();
+  smoother->NonManifoldSmoothingOn();
+  smoother->NormalizeCoordinatesOn();
+  smoother->Update();
+  return smoother->GetOutput();
+}
+
+//----------------------------------------------------------------------------
+/// Get which side of the faces of a multi-label vtkSurfaceNets3D output the face normals point to.
+/// The surface must be in the IJK coordinate system of the labelmap (origin 0, spacing 1).
+/// The label on that side is sampled at half voxel distance from the face center along the face normal.
+/// Returns 0 or 1 (index of the BoundaryLabels component), or -1 if it cannot be determined.
+int GetFaceNormalSide(vtkPolyData* surface, vtkDataArray* boundaryLabels, vtkImageData* labelmap)
+{
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  labelmap->GetExtent(extent);
+  vtkCellArray* polys = surface->GetPolys();
+  vtkNew<vtkIdList> facePointIds;
+  // A few faces are enough, the first faces are checked only to be robust against degenerate faces
+  const vtkIdType maximumNumberOfFacesToCheck = 100;
+  vtkIdType numberOfFacesToCheck = std::min(surface->GetNumberOfPolys(), maximumNumberOfFacesToCheck);
+  for (vtkIdType faceId = 0; faceId < numberOfFacesToCheck; ++faceId)
+  {
+    vtkIdType numberOfFacePoints = 0;
+    const vtkIdType* facePoints = nullptr;
+    polys->GetCellAtId(faceId, numberOfFacePoints, facePoints, facePointIds);
+    if (numberOfFacePoints < 3)
+    {
+      continue;
+    }
+    // Newell's method for polygon normal
+    double center[3] = { 0.0, 0.0, 0.0 };
+    double normal[3] = { 0.0, 0.0, 0.0 };
+    for (vtkIdType i = 0; i < numberOfFacePoints; ++i)
+    {
+      double p0[3] = { 0.0, 0.0, 0.0 };
+      double p1[3] = { 0.0, 0.0, 0.0 };
+      surface->GetPoint(facePoints[i], p0);
+      surface->GetPoint(facePoints[(i + 1) % numberOfFacePoints], p1);
+      normal[0] += (p0[1] - p1[1]) * (p0[2] + p1[2]);
+      normal[1] += (p0[2] - p1[2]) * (p0[0] + p1[0]);
+      normal[2] += (p0[0] - p1[0]) * (p0[1] + p1[1]);
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        center[axis] += p0[axis] / numberOfFacePoints;
+      }
+    }
+    if (vtkMath::Normalize(normal) == 0.0)
+    {
+      continue;
+    }
+    int ijk[3] = { 0, 0, 0 };
+    bool insideExtent = true;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      ijk[axis] = vtkMath::Round(center[axis] + 0.5 * normal[axis]);
+      insideExtent = insideExtent && ijk[axis] >= extent[axis * 2] && ijk[axis] <= extent[axis * 2 + 1];
+    }
+    if (!insideExtent)
+    {
+      continue;
+    }
+    double labelValue = labelmap->GetScalarComponentAsDouble(ijk[0], ijk[1], ijk[2], 0);
+    double side0Label = boundaryLabels->GetComponent(faceId, 0);
+    double side1Label = boundaryLabels->GetComponent(faceId, 1);
+    if (side0Label == side1Label)
+    {
+      continue;
+    }
+    if (labelValue == side0Label)
+    {
+      return 0;
+    }
+    if (labelValue == side1Label)
+    {
+      return 1;
+    }
+  }
+  return -1;
+}
+
+//----------------------------------------------------------------------------
+/// Extract surface of each label from a multi-label vtkSurfaceNets3D output and post-process them.
+/// Each face of the input is added to the surfaces of the labels on both sides of the face.
+/// Faces where the label is on the side that the face normal points to are flipped, so that
+/// normals of all surfaces point outward, as in surfaces created from a single label.
+class SplitMultiLabelSurfaceFunctor
+{
+public:
+  SplitMultiLabelSurfaceFunctor(vtkPolyData* multiLabelSurface,
+    const std::vector<std::vector<vtkIdType> >& labelFaces,
+    std::vector<vtkSmartPointer<vtkPolyData> >& labelSurfaces)
+    : MultiLabelSurface(multiLabelSurface)
+    , LabelFaces(labelFaces)
+    , LabelSurfaces(labelSurfaces)
+  {
+  }
+
+  void Initialize()
+  {
+    this->PointIdMap.Local().assign(this->MultiLabelSurface->GetNumberOfPoints(), -1);
+  }
+
+  void operator()(vtkIdType beginLabelIndex, vtkIdType endLabelIndex)
+  {
+    std::vector<vtkIdType>& pointIdMap = this->PointIdMap.Local();
+    vtkPoints* inputPoints = this->MultiLabelSurface->GetPoints();
+    vtkCellArray* inputPolys = this->MultiLabelSurface->GetPolys();
+    vtkNew<vtkIdList> facePointIds;
+    std::vector<vtkIdType> usedPointIds;
+    std::vector<vtkIdType> outputFacePointIds;
+    for (vtkIdType labelIndex = beginLabelIndex; labelIndex < endLabelIndex; ++labelIndex)
+    {
+      const std::vector<vtkIdType>& faces = this->LabelFaces[labelIndex];
+      vtkNew<vtkPoints> points;
+      points->SetDataType(inputPoints->GetDataType());
+      vtkNew<vtkCellArray> polys;
+      polys->AllocateEstimate(faces.size(), 4);
+      usedPointIds.clear();
+      for (vtkIdType face : faces)
+      {
+        // Flipped faces are stored as negative values
+        bool flip = (face < 0);
+        vtkIdType faceId = flip ? -face - 1 : face;
+        vtkIdType numberOfFacePoints = 0;
+        const vtkIdType* facePoints = nullptr;
+        inputPolys->GetCellAtId(faceId, numberOfFacePoints, facePoints, facePointIds);
+        outputFacePointIds.resize(numberOfFacePoints);
+        for (vtkIdType i = 0; i < numberOfFacePoints; ++i)
+        {
+          vtkIdType inputPointId = facePoints[i];
+          if (pointIdMap[inputPointId] < 0)
+          {
+            double point[3] = { 0.0, 0.0, 0.0 };
+            inputPoints->GetPoint(inputPointId, point);
+            pointIdMap[inputPointId] = points->InsertNextPoint(point);
+            usedPointIds.push_back(inputPointId);
+          }
+          outputFacePointIds[i] = pointIdMap[inputPointId];
+        }
+        if (flip)
+        {
+          std::reverse(outputFacePointIds.begin(), outputFacePointIds.end());
+        }
+        polys->InsertNextCell(numberOfFacePoints, outputFacePointIds.data());
+      }
+      // Reset the map for the next label (only the entries that were used)
+      for (vtkIdType inputPointId : usedPointIds)
+      {
+        pointIdMap[inputPointId] = -1;
+      }
+      vtkSmartPointer<vtkPolyData> labelSurface = vtkSmartPointer<vtkPolyData>::New();
+      labelSurface->SetPoints(points);
+      labelSurface->SetPolys(polys);
+      this->LabelSurfaces[labelIndex] = labelSurface;
+    }
+  }
+
+  void Reduce()
+  {
+  }
+
+private:
+  vtkPolyData* MultiLabelSurface;
+  const std::vector<std::vector<vtkIdType> >& LabelFaces;
+  std::vector<vtkSmartPointer<vtkPolyData> >& LabelSurfaces;
+  vtkSMPThreadLocal<std::vector<vtkIdType> > PointIdMap;
+};
+
+}
+
 //----------------------------------------------------------------------------
 vtkBinaryLabelmapToClosedSurfaceConversionRule::vtkBinaryLabelmapToClosedSurfaceConversionRule()
 {
@@ -89,6 +340,10 @@ vtkBinaryLabelmapToClosedSurfaceConversionRule::vtkBinaryLabelmapToClosedSurface
     "1 = Smoothing done in surface nets filter.");
   this->ConversionParameters->SetParameter(GetJointSmoothingParameterName(), "0",
     "Perform joint smoothing.");
+  this->ConversionParameters->SetParameter(GetMultiLabelConversionParameterName(), "0",
+    "Multi-label conversion. 0 (default) = each segment is converted separately. "
+    "1 = if vtkSurfaceNets3D conversion method is used then all segments of a shared labelmap are converted "
+    "by a single vtkSurfaceNets3D pass (faster if many segments are converted).");
 }
 
 //----------------------------------------------------------------------------
@@ -169,33 +424,30 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::Convert(vtkSegment* segment
   double smoothingFactor = this->ConversionParameters->GetValueAsDouble(GetSmoothingFactorParameterName());
   int jointSmoothing = this->ConversionParameters->GetValueAsInt(GetJointSmoothingParameterName());
 
-  if (jointSmoothing > 0 && smoothingFactor > 0)
+  int multiLabelConversion = this->ConversionParameters->GetValueAsInt(GetMultiLabelConversionParameterName());
+  std::string conversionMethod = this->ConversionParameters->GetValue(GetConversionMethodParameterName());
+  int surfaceNetsSmoothing = this->ConversionParameters->GetValueAsInt(GetSurfaceNetInternalSmoothingParameterName());
+
+  // Multi-label conversion is only available for SurfaceNets. SurfaceNets internal smoothing
+  // smooths all the labels that are contoured together, therefore in that case multi-label
+  // conversion would give different results than per-segment conversion unless joint smoothing is requested.
+  bool useMultiLabelConversion = multiLabelConversion > 0
+    && conversionMethod == vtkBinaryLabelmapToClosedSurfaceConversionRule::CONVERSION_METHOD_SURFACE_NETS
+    && (surfaceNetsSmoothing == 0 || (jointSmoothing > 0 && smoothingFactor > 0));
+
+  if (useMultiLabelConversion)
+  {
+    if (!this->GetMultiLabelSurface(orientedBinaryLabelmap, segment->GetLabelValue(),
+      jointSmoothing > 0 && smoothingFactor > 0, closedSurfacePolyData))
+    {
+      return false;
+    }
+  }
+  else if (jointSmoothing > 0 && smoothingFactor > 0)
   {
     if (this->JointSmoothCache.find(orientedBinaryLabelmap) == this->JointSmoothCache.end())
     {
-      double* scalarRange = orientedBinaryLabelmap->GetScalarRange();
-      int lowLabel = (int)(floor(scalarRange[0]));
-      int highLabel = (int)(ceil(scalarRange[1]));
-
-      vtkNew<vtkImageAccumulate> imageAccumulate;
-      imageAccumulate->SetInputData(orientedBinaryLabelmap);
-      imageAccumulate->IgnoreZeroOn();
-      imageAccumulate->SetComponentOrigin(0, 0, 0);
-      imageAccumulate->SetComponentSpacing(1, 1, 1);
-      imageAccumulate->SetComponentExtent(lowLabel, highLabel, 0, 0, 0, 0);
-      imageAccumulate->Update();
-
-      std::vector<int> labelValues;
-      for (int labelValue = lowLabel; labelValue <= highLabel; ++labelValue)
-      {
-        // Add a new threshold for every level in the labelmap
-        double numberOfVoxels = imageAccumulate->GetOutput()->GetPointData()->GetScalars()->GetTuple1((int)labelValue - lowLabel);
-        if (numberOfVoxels > 0.0)
-        {
-          labelValues.push_back(labelValue);
-        }
-      }
-
+      std::vector<int> labelValues = GetLabelValuesInImage(orientedBinaryLabelmap);
       vtkSmartPointer<vtkPolyData> jointSmoothedSurface = vtkSmartPointer<vtkPolyData>::New();
       this->CreateClosedSurface(orientedBinaryLabelmap, jointSmoothedSurface, labelValues);
       this->JointSmoothCache[orientedBinaryLabelmap] = jointSmoothedSurface;
@@ -278,27 +530,7 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrie
     return true;
   }
 
-  /// If input labelmap has non-background border voxels, then those regions remain open in the output closed surface.
-  /// This function adds a 1 voxel padding to the labelmap in these cases.
-  bool paddingNecessary = this->IsLabelmapPaddingNecessary(binaryLabelmap);
-  if (paddingNecessary)
-  {
-    vtkSmartPointer<vtkImageConstantPad> padder = vtkSmartPointer<vtkImageConstantPad>::New();
-    padder->SetInputData(binaryLabelmap);
-    int extent[6] = { 0, -1, 0, -1, 0, -1 };
-    binaryLabelmap->GetExtent(extent);
-    // Set the output extent to the new size
-    padder->SetOutputWholeExtent(extent[0] - 1, extent[1] + 1, extent[2] - 1, extent[3] + 1, extent[4] - 1, extent[5] + 1);
-    padder->Update();
-    binaryLabelmap = padder->GetOutput();
-  }
-
-  // Clone labelmap and set identity geometry so that the whole transform can be done in IJK space and then
-  // the whole transform can be applied on the poly data to transform it to the world coordinate system
-  vtkSmartPointer<vtkImageData> binaryLabelmapWithIdentityGeometry = vtkSmartPointer<vtkImageData>::New();
-  binaryLabelmapWithIdentityGeometry->ShallowCopy(binaryLabelmap);
-  binaryLabelmapWithIdentityGeometry->SetOrigin(0, 0, 0);
-  binaryLabelmapWithIdentityGeometry->SetSpacing(1.0, 1.0, 1.0);
+  vtkSmartPointer<vtkImageData> binaryLabelmapWithIdentityGeometry = this->CreateLabelmapForContouring(binaryLabelmap);
 
   // Get conversion parameters
   double decimationFactor = this->ConversionParameters->GetValueAsDouble(GetDecimationFactorParameterName());
@@ -351,16 +583,7 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrie
     if (surfaceNetsSmoothing == 1)
     {
       surfaceNets->SmoothingOn();
-
-      // This formula maps (input) -> (iteration count)
-      // 0.0  ->  0   (almost no smoothing)
-      // 0.2  ->  2   (little smoothing)
-      // 0.5  ->  8   (average smoothing)
-      // 0.7  ->  14  (strong smoothing)
-      // 1.0  ->  24  (very strong smoothing)
-      double fCount = 15.0 * smoothingFactor * smoothingFactor + 9.0 * smoothingFactor;
-      int iterationCount = floor(fCount);
-      surfaceNets->SetNumberOfIterations(iterationCount);
+      surfaceNets->SetNumberOfIterations(GetSurfaceNetsSmoothingIterations(smoothingFactor));
     }
 
     int valueIndex = 0;
@@ -400,6 +623,22 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrie
     return true;
   }
 
+  vtkNew<vtkMatrix4x4> labelmapImageToWorldMatrix;
+  orientedBinaryLabelmap->GetImageToWorldMatrix(labelmapImageToWorldMatrix);
+  this->PostProcessSurface(processingResult, labelmapImageToWorldMatrix, decimationFactor,
+    (surfaceNetsSmoothing == 0 ? smoothingFactor : 0.0),
+    computeSurfaceNormals > 0 && conversionMethod == vtkBinaryLabelmapToClosedSurfaceConversionRule::CONVERSION_METHOD_FLYING_EDGES,
+    closedSurfacePolyData);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkBinaryLabelmapToClosedSurfaceConversionRule::PostProcessSurface(vtkPolyData* surfaceIJK,
+  vtkMatrix4x4* imageToWorldMatrix, double decimationFactor, double smoothingFactor, bool computeSurfaceNormals,
+  vtkPolyData* closedSurfacePolyData)
+{
+  vtkSmartPointer<vtkPolyData> processingResult = surfaceIJK;
+
   // Decimate
   if (decimationFactor > 0.0)
   {
@@ -414,47 +653,21 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrie
     processingResult = decimator->GetOutput();
   }
 
-  if (smoothingFactor > 0 && surfaceNetsSmoothing == 0)
-  {
-    vtkSmartPointer<vtkWindowedSincPolyDataFilter> smoother = vtkSmartPointer<vtkWindowedSincPolyDataFilter>::New();
-    smoother->SetInputData(processingResult);
-
-    // Smoothing factor is a user-friendly linear scale that we need to maps to low-pass filter parameters.
-    // Default smoothing aims for removing blocky appearance (staircase artifacts) while avoiding shrinking.
-    // Typically a few ten iterations are sufficient, but stronger smoothing requires more iterations.
-    //
-    //   Smoothing factor                             Passband   Iterations
-    //
-    //     0.0  (almost no smoothing, blocky)      ->   1.0          20
-    //     0.25 (less smoothing, somewhat blocky)  ->   0.1          30
-    //     0.5  (default smoothing)                ->   0.01         40
-    //     0.75 (more smoothing, somewhat shrinks) ->   0.001        50
-    //     1.0  (very strong smoothing, shrinks)   ->   0.0001       60
-    //
-    double passBand = pow(10.0, -4.0 * smoothingFactor);
-    int numberOfIterations = 20 + smoothingFactor * 40;
-
-    smoother->SetNumberOfIterations(numberOfIterations);
-    smoother->SetPassBand(passBand);
-    smoother->BoundarySmoothingOff();
-    smoother->FeatureEdgeSmoothingOff();
-    smoother->NonManifoldSmoothingOn();
-    smoother->NormalizeCoordinatesOn();
-    smoother->Update();
-    processingResult = smoother->GetOutput();
+  if (smoothingFactor > 0)
+  {
+    processingResult = SmoothSurface(processingResult, smoothingFactor);
   }
 
   // Transform the result surface from labelmap IJK to world coordinate system
   vtkSmartPointer<vtkTransform> labelmapGeometryTransform = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkMatrix4x4> labelmapImageToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
-  orientedBinaryLabelmap->GetImageToWorldMatrix(labelmapImageToWorldMatrix);
-  labelmapGeometryTransform->SetMatrix(labelmapImageToWorldMatrix);
+  labelmapGeometryTransform->SetMatrix(imageToWorldMatrix);
 
   vtkSmartPointer<vtkTransformPolyDataFilter> transformPolyDataFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
   transformPolyDataFilter->SetInputData(processingResult);
   transformPolyDataFilter->SetTransform(labelmapGeometryTransform);
 
-  if (computeSurfaceNormals > 0 && conversionMethod == vtkBinaryLabelmapToClosedSurfaceConversionRule::CONVERSION_METHOD_FLYING_EDGES)
+  vtkSmartPointer<vtkPolyData> convertedSegment = vtkSmartPointer<vtkPolyData>::New();
+  if (computeSurfaceNormals)
   {
     vtkSmartPointer<vtkPolyDataNormals> polyDataNormals = vtkSmartPointer<vtkPolyDataNormals>::New();
     polyDataNormals->SetInputConnection(transformPolyDataFilter->GetOutputPort());
@@ -472,6 +685,212 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrie
   }
 
   closedSurfacePolyData->ShallowCopy(convertedSegment);
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateLabelmapForContouring(
+  vtkImageData* binaryLabelmap)
+{
+  vtkSmartPointer<vtkImageData> paddedLabelmap = binaryLabelmap;
+
+  /// If input labelmap has non-background border voxels, then those regions remain open in the output closed surface.
+  /// This function adds a 1 voxel padding to the labelmap in these cases.
+  bool paddingNecessary = this->IsLabelmapPaddingNecessary(binaryLabelmap);
+  if (paddingNecessary)
+  {
+    vtkSmartPointer<vtkImageConstantPad> padder = vtkSmartPointer<vtkImageConstantPad>::New();
+    padder->SetInputData(binaryLabelmap);
+    int extent[6] = { 0, -1, 0, -1, 0, -1 };
+    binaryLabelmap->GetExtent(extent);
+    // Set the output extent to the new size
+    padder->SetOutputWholeExtent(extent[0] - 1, extent[1] + 1, extent[2] - 1, extent[3] + 1, extent[4] - 1, extent[5] + 1);
+    padder->Update();
+    paddedLabelmap = padder->GetOutput();
+  }
+
+  // Clone labelmap and set identity geometry so that the whole transform can be done in IJK space and then
+  // the whole transform can be applied on the poly data to transform it to the world coordinate system
+  vtkSmartPointer<vtkImageData> binaryLabelmapWithIdentityGeometry = vtkSmartPointer<vtkImageData>::New();
+  binaryLabelmapWithIdentityGeometry->ShallowCopy(paddedLabelmap);
+  binaryLabelmapWithIdentityGeometry->SetOrigin(0, 0, 0);
+  binaryLabelmapWithIdentityGeometry->SetSpacing(1.0, 1.0, 1.0);
+  return binaryLabelmapWithIdentityGeometry;
+}
+
+//----------------------------------------------------------------------------
+bool vtkBinaryLabelmapToClosedSurfaceConversionRule::GetMultiLabelSurface(vtkOrientedImageData* binaryLabelmap,
+  int labelValue, bool jointSmoothing, vtkPolyData* closedSurfacePolyData)
+{
+  MultiLabelSurfaces& multiLabelSurfaces = this->MultiLabelSurfaceCache[binaryLabelmap];
+  std::map<int, vtkSmartPointer<vtkPolyData> >::iterator surfaceIt = multiLabelSurfaces.Surfaces.find(labelValue);
+  if (surfaceIt == multiLabelSurfaces.Surfaces.end() && !multiLabelSurfaces.AllLabelsComputed)
+  {
+    std::vector<int> labelValues;
+    if (jointSmoothing || !multiLabelSurfaces.Surfaces.empty())
+    {
+      // Compute surfaces of all the remaining labels in one pass
+      for (int imageLabelValue : GetLabelValuesInImage(binaryLabelmap))
+      {
+        if (multiLabelSurfaces.Surfaces.find(imageLabelValue) == multiLabelSurfaces.Surfaces.end())
+        {
+          labelValues.push_back(imageLabelValue);
+        }
+      }
+      multiLabelSurfaces.AllLabelsComputed = true;
+    }
+    else
+    {
+      // This may be the only segment that is converted in this labelmap,
+      // so do not compute all the other labels yet
+      labelValues.push_back(labelValue);
+    }
+    if (!this->CreateClosedSurfacesMultiLabel(binaryLabelmap, labelValues, jointSmoothing, multiLabelSurfaces.Surfaces))
+    {
+      return false;
+    }
+    surfaceIt = multiLabelSurfaces.Surfaces.find(labelValue);
+  }
+  if (surfaceIt == multiLabelSurfaces.Surfaces.end() || !surfaceIt->second)
+  {
+    // label is not present in the labelmap
+    closedSurfacePolyData->Initialize();
+    return true;
+  }
+  closedSurfacePolyData->ShallowCopy(surfaceIt->second);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurfacesMultiLabel(vtkOrientedImageData* binaryLabelmap,
+  const std::vector<int>& labelValues, bool jointSmoothing, std::map<int, vtkSmartPointer<vtkPolyData> >& closedSurfaces)
+{
+  if (labelValues.empty() || binaryLabelmap->IsEmpty())
+  {
+    return true;
+  }
+
+  // Get conversion parameters
+  double decimationFactor = this->ConversionParameters->GetValueAsDouble(GetDecimationFactorParameterName());
+  double smoothingFactor = this->ConversionParameters->GetValueAsDouble(GetSmoothingFactorParameterName());
+  int surfaceNetsSmoothing = this->ConversionParameters->GetValueAsInt(GetSurfaceNetInternalSmoothingParameterName());
+
+  vtkSmartPointer<vtkImageData> binaryLabelmapWithIdentityGeometry = this->CreateLabelmapForContouring(binaryLabelmap);
+  vtkNew<vtkSurfaceNets3D> surfaceNets;
+  surfaceNets->SetInputData(binaryLabelmapWithIdentityGeometry);
+  surfaceNets->SmoothingOff();
+  if (surfaceNetsSmoothing == 1 && jointSmoothing)
+  {
+    // Internal smoothing of SurfaceNets smooths all labels together, therefore it is only used
+    // for joint smoothing (Convert() uses per-segment conversion otherwise)
+    surfaceNets->SmoothingOn();
+    surfaceNets->SetNumberOfIterations(GetSurfaceNetsSmoothingIterations(smoothingFactor));
+    smoothingFactor = 0.0;
+  }
+  int valueIndex = 0;
+  for (int labelValue : labelValues)
+  {
+    surfaceNets->SetValue(valueIndex, labelValue);
+    ++valueIndex;
+  }
+  try
+  {
+    surfaceNets->Update();
+  }
+  catch (...)
+  {
+    vtkErrorMacro("Convert: Error while running surface nets!");
+    return false;
+  }
+
+  vtkSmartPointer<vtkPolyData> multiLabelSurface = surfaceNets->GetOutput();
+
+  // Each face has the two labels on its two sides in BoundaryLabels cell data.
+  vtkDataArray* boundaryLabels = multiLabelSurface->GetCellData()->GetArray("BoundaryLabels");
+  if (!boundaryLabels)
+  {
+    boundaryLabels = multiLabelSurface->GetCellData()->GetScalars();
+  }
+  vtkIdType numberOfFaces = multiLabelSurface->GetNumberOfPolys();
+  if (numberOfFaces > 0 && (!boundaryLabels || boundaryLabels->GetNumberOfComponents() < 2
+    || boundaryLabels->GetNumberOfTuples() != numberOfFaces))
+  {
+    vtkErrorMacro("CreateClosedSurfacesMultiLabel: Boundary labels are not available in SurfaceNets output");
+    return false;
+  }
+
+  // Faces are flipped in surfaces of labels that are on the side where the face normal points to.
+  // The side is determined from the labelmap (before smoothing moves the points).
+  int faceNormalSide = 0;
+  if (numberOfFaces > 0)
+  {
+    faceNormalSide = GetFaceNormalSide(multiLabelSurface, boundaryLabels, binaryLabelmapWithIdentityGeometry);
+    if (faceNormalSide < 0)
+    {
+      vtkErrorMacro("CreateClosedSurfacesMultiLabel: Failed to determine face orientation of SurfaceNets output");
+      return false;
+    }
+  }
+
+  if (jointSmoothing && smoothingFactor > 0.0)
+  {
+    // Smooth all the surfaces together (face labels are preserved)
+    multiLabelSurface = SmoothSurface(multiLabelSurface, smoothingFactor);
+    smoothingFactor = 0.0;
+  }
+
+  // Collect faces of each label (in one pass through all the faces).
+  std::map<int, int> labelIndices;
+  for (int labelIndex = 0; labelIndex < static_cast<int>(labelValues.size()); ++labelIndex)
+  {
+    labelIndices[labelValues[labelIndex]] = labelIndex;
+  }
+  std::vector<std::vector<vtkIdType> > labelFaces(labelValues.size());
+  for (vtkIdType faceId = 0; faceId < numberOfFaces; ++faceId)
+  {
+    for (int side = 0; side < 2; ++side)
+    {
+      std::map<int, int>::iterator labelIndexIt = labelIndices.find(static_cast<int>(boundaryLabels->GetComponent(faceId, side)));
+      if (labelIndexIt != labelIndices.end())
+      {
+        // Faces that need to be flipped are stored as negative values
+        labelFaces[labelIndexIt->second].push_back(side == faceNormalSide ? -faceId - 1 : faceId);
+      }
+    }
+  }
+
+  // Split surface by labels
+  std::vector<vtkSmartPointer<vtkPolyData> > labelSurfaces(labelValues.size());
+  SplitMultiLabelSurfaceFunctor splitFunctor(multiLabelSurface, labelFaces, labelSurfaces);
+  vtkSMPTools::For(0, static_cast<vtkIdType>(labelValues.size()), splitFunctor);
+
+  // Decimate, smooth, and transform the surfaces in parallel
+  vtkNew<vtkMatrix4x4> labelmapImageToWorldMatrix;
+  binaryLabelmap->GetImageToWorldMatrix(labelmapImageToWorldMatrix);
+  vtkSMPTools::For(0, static_cast<vtkIdType>(labelValues.size()),
+    [&](vtkIdType beginLabelIndex, vtkIdType endLabelIndex)
+    {
+      for (vtkIdType labelIndex = beginLabelIndex; labelIndex < endLabelIndex; ++labelIndex)
+      {
+        vtkPolyData* labelSurface = labelSurfaces[labelIndex];
+        if (labelSurface->GetNumberOfPolys() == 0)
+        {
+          continue;
+        }
+        vtkSmartPointer<vtkPolyData> closedSurface = vtkSmartPointer<vtkPolyData>::New();
+        PostProcessSurface(labelSurface, labelmapImageToWorldMatrix, decimationFactor, smoothingFactor, false, closedSurface);
+        labelSurfaces[labelIndex] = closedSurface;
+      }
+    });
+
+  for (int labelIndex = 0; labelIndex < static_cast<int>(labelValues.size()); ++labelIndex)
+  {
+    if (labelSurfaces[labelIndex]->GetNumberOfPolys() == 0)
+    {
+      // Empty surface is stored to indicate that the label has been processed
+      labelSurfaces[labelIndex]->Initialize();
+    }
+    closedSurfaces[labelValues[labelIndex]] = labelSurfaces[labelIndex];
+  }
   return true;
 }
 
@@ -479,6 +898,7 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrie
 bool vtkBinaryLabelmapToClosedSurfaceConversionRule::PostConvert(vtkSegmentation* vtkNotUsed(segmentation))
 {
   this->JointSmoothCache.clear();
+  this->MultiLabelSurfaceCache.clear();
   return true;
 }
 
@@ -29,6 +29,9 @@
 
 // VTK includes
 #include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+class vtkMatrix4x4;
 
 /// \brief Convert binary labelmap representation (vtkOrientedImageData type) to
 ///   closed surface representation (vtkPolyData type). The conversion algorithm
@@ -54,6 +57,13 @@ public:
   /// If joint smoothing is enabled, surfaces will be created and smoothed as one vtkPolyData.
   /// Joint smoothing converts all segments in shared labelmap together, reducing smoothing artifacts.
   static const std::string GetJointSmoothingParameterName() { return "Joint smoothing"; };
+  /// Conversion parameter: multi-label conversion
+  /// If enabled and the conversion method is SurfaceNets, surfaces of all segments in a shared
+  /// labelmap are created by a single multi-label vtkSurfaceNets3D pass, and then the per-segment
+  /// surfaces are decimated and smoothed in parallel. The parameter is ignored if flying edges
+  /// conversion method is used, or if SurfaceNets internal smoothing is used without joint smoothing
+  /// (as internal smoothing of a multi-label surface is always joint smoothing).
+  static const std::string GetMultiLabelConversionParameterName() { return "Multi-label conversion"; };
 
   // Conversion methods
   static const std::string CONVERSION_METHOD_FLYING_EDGES;
@@ -101,6 +111,31 @@ protected:
   /// This function checks whether this is the case.
   bool IsLabelmapPaddingNecessary(vtkImageData* binaryLabelMap);
 
+  /// Pad the labelmap if needed and set identity geometry, so that contouring can be done in IJK space.
+  vtkSmartPointer<vtkImageData> CreateLabelmapForContouring(vtkImageData* binaryLabelmap);
+
+  /// Get surface of a label using multi-label conversion.
+  /// Surfaces of all labels in the labelmap are computed and cached when the second segment
+  /// of the same labelmap is converted (or at the first segment if joint smoothing is enabled),
+  /// so that converting a single segment does not require computing surfaces of all labels.
+  bool GetMultiLabelSurface(vtkOrientedImageData* binaryLabelmap, int labelValue, bool jointSmoothing,
+    vtkPolyData* closedSurfacePolyData);
+
+  /// Create closed surfaces of the specified labels using a single multi-label SurfaceNets pass.
+  /// The surface of each label is extracted from the multi-label surface in linear time, then
+  /// surfaces are decimated, smoothed, and transformed to world coordinate system in parallel.
+  /// If joint smoothing is enabled then the multi-label surface is smoothed before splitting.
+  /// Face orientation of the SurfaceNets output is determined from the labelmap, so that normals
+  /// of all the extracted surfaces point outward.
+  bool CreateClosedSurfacesMultiLabel(vtkOrientedImageData* binaryLabelmap, const std::vector<int>& labelValues,
+    bool jointSmoothing, std::map<int, vtkSmartPointer<vtkPolyData> >& closedSurfaces);
+
+  /// Decimate and smooth a surface (in IJK space) then transform it to world coordinate system.
+  /// Smoothing is skipped if smoothingFactor is 0. The method does not use any member variables,
+  /// therefore it can be called from multiple threads in parallel.
+  static void PostProcessSurface(vtkPolyData* surfaceIJK, vtkMatrix4x4* imageToWorldMatrix,
+    double decimationFactor, double smoothingFactor, bool computeSurfaceNormals, vtkPolyData* closedSurfacePolyData);
+
 protected:
   vtkBinaryLabelmapToClosedSurfaceConversionRule();
   ~vtkBinaryLabelmapToClosedSurfaceConversionRule() override;
@@ -110,6 +145,15 @@ protected:
   /// The key used is the binary labelmap representation, which maps to the combined vtkPolyData containing surfaces for all segments in the segmentation
   std::map<vtkOrientedImageData*, vtkSmartPointer<vtkPolyData> > JointSmoothCache;
 
+  struct MultiLabelSurfaces
+  {
+    std::map<int, vtkSmartPointer<vtkPolyData> > Surfaces;
+    bool AllLabelsComputed{ false };
+  };
+  /// Cache for storing surfaces created by multi-label conversion.
+  /// The key used is the binary labelmap representation, which maps to the surfaces of each label value.
+  std::map<vtkOrientedImageData*, MultiLabelSurfaces> MultiLabelSurfaceCache;
+
 private:
   vtkBinaryLabelmapToClosedSurfaceConversionRule(const vtkBinaryLabelmapToClosedSurfaceConversionRule&) = delete;
   void operator=(const vtkBinaryLabelmapToClosedSurfaceConversionRule&) = delete;
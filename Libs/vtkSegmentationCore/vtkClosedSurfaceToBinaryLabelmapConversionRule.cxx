@@ -24,6 +24,7 @@
 
 #include "vtkOrientedImageData.h"
 #include "vtkCalculateOversamplingFactor.h"
+#include "vtkClosedSurfaceVoxelizer.h"
 
 // Slicer includes
 #include "vtkLoggingMacros.h"
@@ -48,6 +49,9 @@
 
 int DEFAULT_LABEL_VALUE = 1;
 
+const std::string vtkClosedSurfaceToBinaryLabelmapConversionRule::CONVERSION_METHOD_IMAGE_STENCIL = std::string("0");
+const std::string vtkClosedSurfaceToBinaryLabelmapConversionRule::CONVERSION_METHOD_SCANLINE = std::string("1");
+
 //----------------------------------------------------------------------------
 vtkSegmentationConverterRuleNewMacro(vtkClosedSurfaceToBinaryLabelmapConversionRule);
 
@@ -72,6 +76,10 @@ vtkClosedSurfaceToBinaryLabelmapConversionRule::vtkClosedSurfaceToBinaryLabelmap
   this->ConversionParameters->SetParameter(GetCollapseLabelmapsParameterName(), "1",
     "Merge the labelmaps into as few shared labelmaps as possible"
     " 1 = created labelmaps will be shared if possible without overwriting each other.");
+  // Conversion method parameter
+  this->ConversionParameters->SetParameter(GetConversionMethodParameterName(), CONVERSION_METHOD_IMAGE_STENCIL,
+    "Conversion method. 0 (default) = vtkPolyDataToImageStencil is used to fill the labelmap."
+    " 1 = parallel scanline voxelizer (faster, tolerates small surface defects).");
 }
 
 //----------------------------------------------------------------------------
@@ -187,6 +195,21 @@ bool vtkClosedSurfaceToBinaryLabelmapConversionRule::Convert(vtkSegment* segment
 
   // Perform conversion
 
+  std::string conversionMethod = this->ConversionParameters->GetValue(GetConversionMethodParameterName());
+  if (conversionMethod == CONVERSION_METHOD_SCANLINE)
+  {
+    // The voxelizer works directly in the oriented image geometry
+    vtkNew<vtkClosedSurfaceVoxelizer> voxelizer;
+    voxelizer->SetFillValue(DEFAULT_LABEL_VALUE);
+    if (!voxelizer->Voxelize(closedSurfacePolyData, binaryLabelmap))
+    {
+      vtkErrorMacro("Convert: Failed to voxelize closed surface!");
+      return false;
+    }
+    segment->SetLabelValue(DEFAULT_LABEL_VALUE);
+    return true;
+  }
+
   // Now the output labelmap image data contains the right geometry.
   // We need to apply inverse of geometry matrix to the input poly data so that we can perform
   // the conversion in IJK space, because the filters do not support oriented image data.
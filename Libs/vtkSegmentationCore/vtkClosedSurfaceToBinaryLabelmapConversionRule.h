@@ -45,6 +45,14 @@ public:
   /// Determines if the output binary labelmaps should be reduced to as few shared labelmaps as possible after conversion.
   /// A value of 1 means that the labelmaps will be collapsed, while a value of 0 means that they will not be collapsed.
   static const std::string GetCollapseLabelmapsParameterName() { return "Collapse labelmaps"; };
+  /// Conversion parameter: Conversion method (image stencil or scanline voxelizer)
+  /// The scanline voxelizer (vtkClosedSurfaceVoxelizer) fills the labelmap in parallel and tolerates
+  /// small defects in the surface. Voxels on the boundary may be different from the image stencil result.
+  static const std::string GetConversionMethodParameterName() { return "Conversion method"; };
+
+  // Conversion methods
+  static const std::string CONVERSION_METHOD_IMAGE_STENCIL;
+  static const std::string CONVERSION_METHOD_SCANLINE;
 
 public:
   static vtkClosedSurfaceToBinaryLabelmapConversionRule* New();
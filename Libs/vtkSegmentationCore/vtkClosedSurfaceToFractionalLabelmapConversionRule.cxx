@@ -20,6 +20,7 @@
 #include "vtkClosedSurfaceToFractionalLabelmapConversionRule.h"
 
 // SegmentationCore includes
+#include "vtkClosedSurfaceVoxelizer.h"
 #include "vtkOrientedImageData.h"
 #include "vtkPolyDataToFractionalLabelmapFilter.h"
 
@@ -29,6 +30,7 @@
 #include <vtkDoubleArray.h>
 #include <vtkIntArray.h>
 #include <vtkFieldData.h>
+#include <vtkNew.h>
 
 // SegmentationCore includes
 #include "vtkSegment.h"
@@ -134,17 +136,35 @@ bool vtkClosedSurfaceToFractionalLabelmapConversionRule::Convert(vtkSegment* seg
   }
   fractionalLabelMap->SetExtent(extent);
 
-  vtkSmartPointer<vtkMatrix4x4> imageToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
-  fractionalLabelMap->GetImageToWorldMatrix(imageToWorldMatrix);
-
-  // Create a fractional labelmap from the closed surface
-  vtkSmartPointer<vtkPolyDataToFractionalLabelmapFilter> polyDataToLabelmapFilter = vtkSmartPointer<vtkPolyDataToFractionalLabelmapFilter>::New();
-  polyDataToLabelmapFilter->SetInputData(closedSurfacePolyData);
-  polyDataToLabelmapFilter->SetOutputImageToWorldMatrix(imageToWorldMatrix);
-  polyDataToLabelmapFilter->SetNumberOfOffsets(this->NumberOfOffsets);
-  polyDataToLabelmapFilter->SetOutputWholeExtent(fractionalLabelMap->GetExtent());
-  polyDataToLabelmapFilter->Update();
-  fractionalLabelMap->DeepCopy(polyDataToLabelmapFilter->GetOutput());
+  std::string conversionMethod = this->ConversionParameters->GetValue(GetConversionMethodParameterName());
+  if (conversionMethod == CONVERSION_METHOD_SCANLINE)
+  {
+    // Compute voxel coverage directly using parallel supersampled scanlines.
+    // Each voxel is sampled by NumberOfOffsets x NumberOfOffsets rays, similarly to the offsets of the stencil method.
+    fractionalLabelMap->AllocateScalars(VTK_FRACTIONAL_DATA_TYPE, 1);
+    vtkNew<vtkClosedSurfaceVoxelizer> voxelizer;
+    voxelizer->SetNumberOfSubdivisions(this->NumberOfOffsets);
+    voxelizer->SetFractionalRange(FRACTIONAL_MIN, FRACTIONAL_MAX);
+    if (!voxelizer->VoxelizeFractional(closedSurfacePolyData, fractionalLabelMap))
+    {
+      vtkErrorMacro("Convert: Failed to voxelize closed surface!");
+      return false;
+    }
+  }
+  else
+  {
+    vtkSmartPointer<vtkMatrix4x4> imageToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    fractionalLabelMap->GetImageToWorldMatrix(imageToWorldMatrix);
+
+    // Create a fractional labelmap from the closed surface
+    vtkSmartPointer<vtkPolyDataToFractionalLabelmapFilter> polyDataToLabelmapFilter = vtkSmartPointer<vtkPolyDataToFractionalLabelmapFilter>::New();
+    polyDataToLabelmapFilter->SetInputData(closedSurfacePolyData);
+    polyDataToLabelmapFilter->SetOutputImageToWorldMatrix(imageToWorldMatrix);
+    polyDataToLabelmapFilter->SetNumberOfOffsets(this->NumberOfOffsets);
+    polyDataToLabelmapFilter->SetOutputWholeExtent(fractionalLabelMap->GetExtent());
+    polyDataToLabelmapFilter->Update();
+    fractionalLabelMap->DeepCopy(polyDataToLabelmapFilter->GetOutput());
+  }
 
   // Specify the scalar range of values in the labelmap
   vtkSmartPointer<vtkDoubleArray> scalarRange = vtkSmartPointer<vtkDoubleArray>::New();
@@ -37,7 +37,9 @@ class vtkPolyData;
 
 /// \brief Convert closed surface representation (vtkPolyData type) to fractional
 ///   labelmap representation (vtkOrientedImageData type). The conversion algorithm
-///   is based on image stencil.
+///   is based on image stencil, or on parallel supersampled scanlines (see vtkClosedSurfaceVoxelizer)
+///   if the scanline conversion method is selected. In both cases the fractional labelmap
+///   is stored as a dense image that covers the extent of the surface.
 class vtkSegmentationCore_EXPORT vtkClosedSurfaceToFractionalLabelmapConversionRule
   : public vtkClosedSurfaceToBinaryLabelmapConversionRule
 {
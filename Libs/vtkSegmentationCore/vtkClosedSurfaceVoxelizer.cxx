@@ -0,0 +1,582 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkClosedSurfaceVoxelizer.h"
+#include "vtkOrientedImageData.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkIdList.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+
+// STD includes
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkClosedSurfaceVoxelizer);
+
+namespace
+{
+
+/// Crossing of a scanline with the surface
+struct Crossing
+{
+  double Position;
+  /// +1 or -1, depending on the orientation of the crossed triangle
+  int Orientation;
+  bool operator<(const Crossing& other) const { return this->Position < other.Position; }
+};
+
+//----------------------------------------------------------------------------
+/// Compute edge function (twice the signed area of the triangle p0, p1, (y, z)) in the JK plane.
+/// The result is computed from the endpoints in a fixed order, so that it is exactly
+/// the negative for the reversed edge. This makes sure that a ray that hits a shared edge
+/// is assigned to exactly one of the adjacent triangles.
+double EdgeFunction(const double* p0, const double* p1, double y, double z)
+{
+  bool reversed = (p1[1] < p0[1]) || (p1[1] == p0[1] && p1[2] < p0[2]);
+  if (reversed)
+  {
+    std::swap(p0, p1);
+  }
+  double value = (p1[1] - p0[1]) * (z - p0[2]) - (p1[2] - p0[2]) * (y - p0[1]);
+  return reversed ? -value : value;
+}
+
+//----------------------------------------------------------------------------
+/// Decide if a point on an edge belongs to the triangle ("top-left" rule).
+/// The direction (dy, dz) is the edge direction in the counter-clockwise triangle,
+/// so the two triangles that share an edge see it in opposite directions.
+bool IsEdgeIncluded(double dy, double dz)
+{
+  return dz < 0.0 || (dz == 0.0 && dy > 0.0);
+}
+
+//----------------------------------------------------------------------------
+/// Get the first integer that is not smaller than value, clamped to [minimum, maximum + 1]
+int CeilInRange(double value, int minimum, int maximum)
+{
+  return static_cast<int>(std::min(std::max(std::ceil(value), static_cast<double>(minimum)), maximum + 1.0));
+}
+
+//----------------------------------------------------------------------------
+/// Get the last integer that is not larger than value, clamped to [minimum - 1, maximum]
+int FloorInRange(double value, int minimum, int maximum)
+{
+  return static_cast<int>(std::min(std::max(std::floor(value), minimum - 1.0), static_cast<double>(maximum)));
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void FillScanline(T* voxels, vtkIdType stride, int numberOfVoxels, double fillValue)
+{
+  T value = static_cast<T>(fillValue);
+  for (int i = 0; i < numberOfVoxels; ++i, voxels += stride)
+  {
+    *voxels = value;
+  }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void WriteFractionalRow(T* voxels, vtkIdType stride, const std::vector<double>& coverage, double minimumValue, double maximumValue)
+{
+  for (double fraction : coverage)
+  {
+    double value = minimumValue + std::min(fraction, 1.0) * (maximumValue - minimumValue);
+    *voxels = static_cast<T>(std::is_integral<T>::value ? std::floor(value + 0.5) : value);
+    voxels += stride;
+  }
+}
+
+//----------------------------------------------------------------------------
+/// Triangles of the surface in IJK coordinates, sorted into K slices
+struct SlicedTriangleMesh
+{
+  /// Point positions in IJK coordinates
+  std::vector<double> Points;
+  std::vector<std::array<vtkIdType, 3> > Triangles;
+  /// Triangle indices of each K slice, slice k is TriangleBins[BinStart[k]] ... TriangleBins[BinStart[k+1]-1]
+  std::vector<vtkIdType> BinStart;
+  std::vector<vtkIdType> TriangleBins;
+
+  //----------------------------------------------------------------------------
+  void SetSurface(vtkPolyData* closedSurface, vtkMatrix4x4* worldToImageMatrix)
+  {
+    // Transform points to IJK coordinate system of the labelmap
+    vtkPoints* points = closedSurface->GetPoints();
+    vtkIdType numberOfPoints = points->GetNumberOfPoints();
+    this->Points.resize(3 * numberOfPoints);
+    vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType firstPointId, vtkIdType lastPointId)
+    {
+      double point[4] = { 0.0, 0.0, 0.0, 1.0 };
+      double pointIjk[4] = { 0.0, 0.0, 0.0, 1.0 };
+      for (vtkIdType pointId = firstPointId; pointId < lastPointId; ++pointId)
+      {
+        points->GetPoint(pointId, point);
+        worldToImageMatrix->MultiplyPoint(point, pointIjk);
+        std::copy(pointIjk, pointIjk + 3, &this->Points[3 * pointId]);
+      }
+    });
+
+    // Collect triangles from polygons (fan triangulation) and triangle strips
+    this->Triangles.clear();
+    vtkNew<vtkIdList> cellPointIds;
+    vtkCellArray* polys = closedSurface->GetPolys();
+    for (polys->InitTraversal(); polys->GetNextCell(cellPointIds);)
+    {
+      for (vtkIdType i = 2; i < cellPointIds->GetNumberOfIds(); ++i)
+      {
+        this->Triangles.push_back({ cellPointIds->GetId(0), cellPointIds->GetId(i - 1), cellPointIds->GetId(i) });
+      }
+    }
+    vtkCellArray* strips = closedSurface->GetStrips();
+    for (strips->InitTraversal(); strips->GetNextCell(cellPointIds);)
+    {
+      for (vtkIdType i = 2; i < cellPointIds->GetNumberOfIds(); ++i)
+      {
+        // Every second triangle of a strip has reversed point order
+        if (i % 2)
+        {
+          this->Triangles.push_back({ cellPointIds->GetId(i - 1), cellPointIds->GetId(i - 2), cellPointIds->GetId(i) });
+        }
+        else
+        {
+          this->Triangles.push_back({ cellPointIds->GetId(i - 2), cellPointIds->GetId(i - 1), cellPointIds->GetId(i) });
+        }
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  /// Sort triangles into K slices. A triangle is added to slice k if it intersects the
+  /// [k - margin, k + margin] range in K and the extent (expanded by margin) in J.
+  /// Triangles outside the I range are kept, as they still determine the parity of the crossings.
+  void BuildSliceBins(const int extent[6], double margin)
+  {
+    int numberOfSlices = extent[5] - extent[4] + 1;
+    std::vector<std::array<int, 2> > triangleSliceRanges(this->Triangles.size());
+    this->BinStart.assign(numberOfSlices + 1, 0);
+    for (size_t triangleIndex = 0; triangleIndex < this->Triangles.size(); ++triangleIndex)
+    {
+      double minJ = VTK_DOUBLE_MAX;
+      double maxJ = VTK_DOUBLE_MIN;
+      double minK = VTK_DOUBLE_MAX;
+      double maxK = VTK_DOUBLE_MIN;
+      for (vtkIdType pointId : this->Triangles[triangleIndex])
+      {
+        minJ = std::min(minJ, this->Points[3 * pointId + 1]);
+        maxJ = std::max(maxJ, this->Points[3 * pointId + 1]);
+        minK = std::min(minK, this->Points[3 * pointId + 2]);
+        maxK = std::max(maxK, this->Points[3 * pointId + 2]);
+      }
+      std::array<int, 2>& sliceRange = triangleSliceRanges[triangleIndex];
+      sliceRange[0] = CeilInRange(minK - margin, extent[4], extent[5]);
+      sliceRange[1] = FloorInRange(maxK + margin, extent[4], extent[5]);
+      if (CeilInRange(minJ - margin, extent[2], extent[3]) > FloorInRange(maxJ + margin, extent[2], extent[3]))
+      {
+        sliceRange[1] = sliceRange[0] - 1;
+      }
+      for (int k = sliceRange[0]; k <= sliceRange[1]; ++k)
+      {
+        ++this->BinStart[k - extent[4] + 1];
+      }
+    }
+    for (int sliceIndex = 0; sliceIndex < numberOfSlices; ++sliceIndex)
+    {
+      this->BinStart[sliceIndex + 1] += this->BinStart[sliceIndex];
+    }
+    this->TriangleBins.resize(this->BinStart[numberOfSlices]);
+    std::vector<vtkIdType> binFill(this->BinStart.begin(), this->BinStart.end() - 1);
+    for (size_t triangleIndex = 0; triangleIndex < this->Triangles.size(); ++triangleIndex)
+    {
+      const std::array<int, 2>& sliceRange = triangleSliceRanges[triangleIndex];
+      for (int k = sliceRange[0]; k <= sliceRange[1]; ++k)
+      {
+        this->TriangleBins[binFill[k - extent[4]]++] = static_cast<vtkIdType>(triangleIndex);
+      }
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+/// Common part of binary and fractional scanline filling: computing sorted crossings of scanlines
+class ScanlineFunctorBase
+{
+public:
+  const SlicedTriangleMesh* Mesh{ nullptr };
+  int Extent[6] = { 0, -1, 0, -1, 0, -1 };
+  void* Voxels{ nullptr };
+  int ScalarType{ VTK_UNSIGNED_CHAR };
+  int ScalarSize{ 1 };
+  vtkIdType Increments[3] = { 0, 0, 0 };
+
+  vtkSMPThreadLocal<std::vector<std::vector<Crossing> > > Rows;
+
+protected:
+  void InitializeRows()
+  {
+    this->Rows.Local().resize(this->Extent[3] - this->Extent[2] + 1);
+  }
+
+  /// Add crossings of the triangle with scanlines (j + offsetJ, z) to the rows
+  void AddTriangleCrossings(const std::array<vtkIdType, 3>& triangle, double offsetJ, double z, std::vector<std::vector<Crossing> >& rows)
+  {
+    const double* a = &this->Mesh->Points[3 * triangle[0]];
+    const double* b = &this->Mesh->Points[3 * triangle[1]];
+    const double* c = &this->Mesh->Points[3 * triangle[2]];
+
+    double area = EdgeFunction(a, b, c[1], c[2]);
+    if (area == 0.0)
+    {
+      // Triangle is parallel to the scanlines
+      return;
+    }
+    int orientation = (area > 0.0 ? 1 : -1);
+    // Edge directions in counter-clockwise order
+    bool includeBC = IsEdgeIncluded(orientation * (c[1] - b[1]), orientation * (c[2] - b[2]));
+    bool includeCA = IsEdgeIncluded(orientation * (a[1] - c[1]), orientation * (a[2] - c[2]));
+    bool includeAB = IsEdgeIncluded(orientation * (b[1] - a[1]), orientation * (b[2] - a[2]));
+
+    int firstJ = CeilInRange(std::min({ a[1], b[1], c[1] }) - offsetJ, this->Extent[2], this->Extent[3]);
+    int lastJ = FloorInRange(std::max({ a[1], b[1], c[1] }) - offsetJ, this->Extent[2], this->Extent[3]);
+    for (int j = firstJ; j <= lastJ; ++j)
+    {
+      double y = j + offsetJ;
+      double wa = orientation * EdgeFunction(b, c, y, z);
+      double wb = orientation * EdgeFunction(c, a, y, z);
+      double wc = orientation * EdgeFunction(a, b, y, z);
+      if (wa < 0.0 || wb < 0.0 || wc < 0.0
+        || (wa == 0.0 && !includeBC) || (wb == 0.0 && !includeCA) || (wc == 0.0 && !includeAB))
+      {
+        continue;
+      }
+      double position = (wa * a[0] + wb * b[0] + wc * c[0]) / (wa + wb + wc);
+      rows[j - this->Extent[2]].push_back({ position, orientation });
+    }
+  }
+
+  /// Add crossings of all triangles of a K slice with scanlines (j + offsetJ, z) to the rows
+  void AddSliceCrossings(vtkIdType sliceIndex, double offsetJ, double z, std::vector<std::vector<Crossing> >& rows)
+  {
+    for (vtkIdType binIndex = this->Mesh->BinStart[sliceIndex]; binIndex < this->Mesh->BinStart[sliceIndex + 1]; ++binIndex)
+    {
+      this->AddTriangleCrossings(this->Mesh->Triangles[this->Mesh->TriangleBins[binIndex]], offsetJ, z, rows);
+    }
+  }
+
+  /// Sort crossings and merge crossings of duplicate faces (same position, same orientation).
+  /// Coincident crossings with opposite orientation are kept, they belong to touching parts of the surface.
+  /// An unmatched last crossing is caused by a defect in the surface, it is removed.
+  /// After this, crossings define inside intervals pairwise.
+  void SortCrossings(std::vector<Crossing>& crossings)
+  {
+    std::sort(crossings.begin(), crossings.end());
+    const double duplicateTolerance = 1e-6;
+    size_t numberOfCrossings = 0;
+    for (size_t crossingIndex = 0; crossingIndex < crossings.size(); ++crossingIndex)
+    {
+      if (numberOfCrossings > 0
+        && crossings[crossingIndex].Position - crossings[numberOfCrossings - 1].Position < duplicateTolerance
+        && crossings[crossingIndex].Orientation == crossings[numberOfCrossings - 1].Orientation)
+      {
+        continue;
+      }
+      crossings[numberOfCrossings++] = crossings[crossingIndex];
+    }
+    crossings.resize(numberOfCrossings - numberOfCrossings % 2);
+  }
+
+  char* GetRowPointer(int j, int k)
+  {
+    return static_cast<char*>(this->Voxels)
+      + ((j - this->Extent[2]) * this->Increments[1] + (k - this->Extent[4]) * this->Increments[2]) * this->ScalarSize;
+  }
+};
+
+//----------------------------------------------------------------------------
+class ScanlineFillFunctor : public ScanlineFunctorBase
+{
+public:
+  double FillValue{ 1.0 };
+
+  void Initialize()
+  {
+    this->InitializeRows();
+  }
+
+  void operator()(vtkIdType firstSlice, vtkIdType lastSlice)
+  {
+    std::vector<std::vector<Crossing> >& rows = this->Rows.Local();
+    for (vtkIdType sliceIndex = firstSlice; sliceIndex < lastSlice; ++sliceIndex)
+    {
+      int k = this->Extent[4] + static_cast<int>(sliceIndex);
+      this->AddSliceCrossings(sliceIndex, 0.0, k, rows);
+      for (int j = this->Extent[2]; j <= this->Extent[3]; ++j)
+      {
+        std::vector<Crossing>& crossings = rows[j - this->Extent[2]];
+        if (!crossings.empty())
+        {
+          this->FillRow(crossings, j, k);
+          crossings.clear();
+        }
+      }
+    }
+  }
+
+  void Reduce()
+  {
+  }
+
+protected:
+  void FillRow(std::vector<Crossing>& crossings, int j, int k)
+  {
+    this->SortCrossings(crossings);
+    char* rowVoxels = this->GetRowPointer(j, k);
+    for (size_t crossingIndex = 0; crossingIndex + 1 < crossings.size(); crossingIndex += 2)
+    {
+      int firstI = CeilInRange(crossings[crossingIndex].Position, this->Extent[0], this->Extent[1]);
+      int lastI = FloorInRange(crossings[crossingIndex + 1].Position, this->Extent[0], this->Extent[1]);
+      if (firstI > lastI)
+      {
+        continue;
+      }
+      void* voxels = rowVoxels + (firstI - this->Extent[0]) * this->Increments[0] * this->ScalarSize;
+      switch (this->ScalarType)
+      {
+        vtkTemplateMacro(FillScanline(static_cast<VTK_TT*>(voxels), this->Increments[0], lastI - firstI + 1, this->FillValue));
+      }
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+/// Compute the fraction of each voxel that is inside the surface.
+/// Each voxel is sampled by NumberOfSubdivisions x NumberOfSubdivisions scanlines,
+/// and the covered length along each scanline is computed exactly.
+class FractionalFillFunctor : public ScanlineFunctorBase
+{
+public:
+  int NumberOfSubdivisions{ 6 };
+  double MinimumValue{ 0.0 };
+  double MaximumValue{ 1.0 };
+
+  vtkSMPThreadLocal<std::vector<std::vector<double> > > Coverage;
+
+  void Initialize()
+  {
+    this->InitializeRows();
+    this->Coverage.Local().resize(this->Extent[3] - this->Extent[2] + 1,
+      std::vector<double>(this->Extent[1] - this->Extent[0] + 1, 0.0));
+  }
+
+  void operator()(vtkIdType firstSlice, vtkIdType lastSlice)
+  {
+    std::vector<std::vector<Crossing> >& rows = this->Rows.Local();
+    std::vector<std::vector<double> >& coverage = this->Coverage.Local();
+    double sampleWeight = 1.0 / (this->NumberOfSubdivisions * this->NumberOfSubdivisions);
+    for (vtkIdType sliceIndex = firstSlice; sliceIndex < lastSlice; ++sliceIndex)
+    {
+      int k = this->Extent[4] + static_cast<int>(sliceIndex);
+      for (int subdivisionK = 0; subdivisionK < this->NumberOfSubdivisions; ++subdivisionK)
+      {
+        double z = k + this->GetSubdivisionOffset(subdivisionK);
+        for (int subdivisionJ = 0; subdivisionJ < this->NumberOfSubdivisions; ++subdivisionJ)
+        {
+          this->AddSliceCrossings(sliceIndex, this->GetSubdivisionOffset(subdivisionJ), z, rows);
+          for (size_t rowIndex = 0; rowIndex < rows.size(); ++rowIndex)
+          {
+            if (!rows[rowIndex].empty())
+            {
+              this->AddRowCoverage(rows[rowIndex], sampleWeight, coverage[rowIndex]);
+              rows[rowIndex].clear();
+            }
+          }
+        }
+      }
+      for (int j = this->Extent[2]; j <= this->Extent[3]; ++j)
+      {
+        std::vector<double>& rowCoverage = coverage[j - this->Extent[2]];
+        switch (this->ScalarType)
+        {
+          vtkTemplateMacro(WriteFractionalRow(reinterpret_cast<VTK_TT*>(this->GetRowPointer(j, k)), this->Increments[0],
+            rowCoverage, this->MinimumValue, this->MaximumValue));
+        }
+        std::fill(rowCoverage.begin(), rowCoverage.end(), 0.0);
+      }
+    }
+  }
+
+  void Reduce()
+  {
+  }
+
+protected:
+  double GetSubdivisionOffset(int subdivision)
+  {
+    return (subdivision + 0.5) / this->NumberOfSubdivisions - 0.5;
+  }
+
+  void AddRowCoverage(std::vector<Crossing>& crossings, double sampleWeight, std::vector<double>& rowCoverage)
+  {
+    this->SortCrossings(crossings);
+    for (size_t crossingIndex = 0; crossingIndex + 1 < crossings.size(); crossingIndex += 2)
+    {
+      // Voxel i covers the [i - 0.5, i + 0.5] range
+      double start = std::max(crossings[crossingIndex].Position, this->Extent[0] - 0.5);
+      double end = std::min(crossings[crossingIndex + 1].Position, this->Extent[1] + 0.5);
+      if (start >= end)
+      {
+        continue;
+      }
+      int firstI = FloorInRange(start + 0.5, this->Extent[0], this->Extent[1]);
+      int lastI = CeilInRange(end - 0.5, this->Extent[0], this->Extent[1]);
+      for (int i = firstI; i <= lastI; ++i)
+      {
+        double length = std::min(end, i + 0.5) - std::max(start, i - 0.5);
+        if (length > 0.0)
+        {
+          rowCoverage[i - this->Extent[0]] += length * sampleWeight;
+        }
+      }
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+/// Get extent of the labelmap and check that voxels can be written
+bool GetOutputExtent(vtkOrientedImageData* labelmap, int extent[6], bool& empty)
+{
+  labelmap->GetExtent(extent);
+  empty = (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5]);
+  return empty || labelmap->GetScalarPointer() != nullptr;
+}
+
+}
+
+//----------------------------------------------------------------------------
+vtkClosedSurfaceVoxelizer::vtkClosedSurfaceVoxelizer() = default;
+
+//----------------------------------------------------------------------------
+vtkClosedSurfaceVoxelizer::~vtkClosedSurfaceVoxelizer() = default;
+
+//----------------------------------------------------------------------------
+void vtkClosedSurfaceVoxelizer::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "FillValue: " << this->FillValue << "\n";
+  os << indent << "NumberOfSubdivisions: " << this->NumberOfSubdivisions << "\n";
+  os << indent << "FractionalRange: " << this->FractionalRange[0] << ", " << this->FractionalRange[1] << "\n";
+}
+
+//----------------------------------------------------------------------------
+bool vtkClosedSurfaceVoxelizer::Voxelize(vtkPolyData* closedSurface, vtkOrientedImageData* labelmap)
+{
+  if (!closedSurface || !labelmap)
+  {
+    vtkErrorMacro("Voxelize: Invalid input surface or output labelmap");
+    return false;
+  }
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  bool empty = true;
+  if (!GetOutputExtent(labelmap, extent, empty))
+  {
+    vtkErrorMacro("Voxelize: Labelmap scalars are not allocated");
+    return false;
+  }
+  if (empty || !closedSurface->GetPoints() || closedSurface->GetNumberOfPoints() == 0)
+  {
+    return true;
+  }
+
+  vtkNew<vtkMatrix4x4> worldToImageMatrix;
+  labelmap->GetWorldToImageMatrix(worldToImageMatrix);
+  SlicedTriangleMesh mesh;
+  mesh.SetSurface(closedSurface, worldToImageMatrix);
+  mesh.BuildSliceBins(extent, 0.0);
+
+  // Fill slices in parallel
+  ScanlineFillFunctor functor;
+  functor.Mesh = &mesh;
+  std::copy(extent, extent + 6, functor.Extent);
+  functor.Voxels = labelmap->GetScalarPointer();
+  functor.ScalarType = labelmap->GetScalarType();
+  functor.ScalarSize = labelmap->GetScalarSize();
+  labelmap->GetIncrements(functor.Increments);
+  functor.FillValue = this->FillValue;
+  vtkSMPTools::For(0, extent[5] - extent[4] + 1, functor);
+
+  labelmap->Modified();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkClosedSurfaceVoxelizer::VoxelizeFractional(vtkPolyData* closedSurface, vtkOrientedImageData* fractionalLabelmap)
+{
+  if (!closedSurface || !fractionalLabelmap)
+  {
+    vtkErrorMacro("VoxelizeFractional: Invalid input surface or output labelmap");
+    return false;
+  }
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  bool empty = true;
+  if (!GetOutputExtent(fractionalLabelmap, extent, empty))
+  {
+    vtkErrorMacro("VoxelizeFractional: Labelmap scalars are not allocated");
+    return false;
+  }
+  if (empty)
+  {
+    return true;
+  }
+
+  SlicedTriangleMesh mesh;
+  if (closedSurface->GetPoints() && closedSurface->GetNumberOfPoints() > 0)
+  {
+    vtkNew<vtkMatrix4x4> worldToImageMatrix;
+    fractionalLabelmap->GetWorldToImageMatrix(worldToImageMatrix);
+    mesh.SetSurface(closedSurface, worldToImageMatrix);
+  }
+  // Scanlines of a voxel are at most half voxel away from the voxel center
+  mesh.BuildSliceBins(extent, 0.5);
+
+  // Compute slices in parallel. All voxels are written, voxels without coverage get the minimum value.
+  FractionalFillFunctor functor;
+  functor.Mesh = &mesh;
+  std::copy(extent, extent + 6, functor.Extent);
+  functor.Voxels = fractionalLabelmap->GetScalarPointer();
+  functor.ScalarType = fractionalLabelmap->GetScalarType();
+  functor.ScalarSize = fractionalLabelmap->GetScalarSize();
+  fractionalLabelmap->GetIncrements(functor.Increments);
+  functor.NumberOfSubdivisions = this->NumberOfSubdivisions;
+  functor.MinimumValue = this->FractionalRange[0];
+  functor.MaximumValue = this->FractionalRange[1];
+  vtkSMPTools::For(0, extent[5] - extent[4] + 1, functor);
+
+  fractionalLabelmap->Modified();
+  return true;
+}
@@ -0,0 +1,91 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkClosedSurfaceVoxelizer_h
+#define __vtkClosedSurfaceVoxelizer_h
+
+// VTK includes
+#include <vtkObject.h>
+
+#include "vtkSegmentationCoreConfigure.h"
+
+class vtkOrientedImageData;
+class vtkPolyData;
+
+/// \brief Fill the inside of a closed triangle mesh in an oriented image data using parallel scanlines.
+///
+/// Rays are cast along the I axis through each voxel center of the image. Crossings with the
+/// surface are computed by projecting each triangle onto the JK plane, using a consistent
+/// tie-breaking rule so that a ray that hits an edge or vertex shared by several triangles is
+/// counted only once. Voxels between pairs of crossings are set to FillValue, all other voxels
+/// are left unchanged, therefore the output can be an existing labelmap that is shared
+/// between several segments. K slices are processed in parallel.
+///
+/// Small defects of the surface are tolerated: crossings of duplicate faces are merged
+/// and if a ray has an odd number of crossings then the last one is ignored.
+///
+/// Fractional labelmaps are computed the same way, using NumberOfSubdivisions x NumberOfSubdivisions
+/// rays per voxel. The inside length along each ray is computed exactly, so only voxels
+/// that the surface passes through get partial values. This makes the computation faster
+/// than accumulating oversampled stencils, but the output is still a dense image: all voxels
+/// of the extent are stored, including fully inside and fully outside voxels.
+class vtkSegmentationCore_EXPORT vtkClosedSurfaceVoxelizer : public vtkObject
+{
+public:
+  static vtkClosedSurfaceVoxelizer *New();
+  vtkTypeMacro(vtkClosedSurfaceVoxelizer, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Value that is written into voxels inside the surface. Default is 1.
+  vtkSetMacro(FillValue, double);
+  vtkGetMacro(FillValue, double);
+
+  /// Number of rays per voxel along J and K axes for fractional voxelization. Default is 6.
+  vtkSetClampMacro(NumberOfSubdivisions, int, 1, 64);
+  vtkGetMacro(NumberOfSubdivisions, int);
+
+  /// Voxel values for fractional voxelization: value for voxels fully outside and fully inside the surface.
+  /// Default is (0.0, 1.0).
+  vtkSetVector2Macro(FractionalRange, double);
+  vtkGetVector2Macro(FractionalRange, double);
+
+  /// Fill voxels of the labelmap that are inside the closed surface.
+  /// The surface is specified in world coordinates and may contain polygons and triangle strips.
+  /// Scalars of the labelmap must be allocated, only voxels within the extent of the labelmap are modified.
+  /// \return Success flag
+  bool Voxelize(vtkPolyData* closedSurface, vtkOrientedImageData* labelmap);
+
+  /// Compute the fraction of each voxel of the labelmap that is inside the closed surface.
+  /// Scalars of the labelmap must be allocated, all voxels within the extent are overwritten by
+  /// the fraction mapped linearly to FractionalRange (rounded if the scalar type is integer).
+  /// \return Success flag
+  bool VoxelizeFractional(vtkPolyData* closedSurface, vtkOrientedImageData* fractionalLabelmap);
+
+protected:
+  double FillValue{1.0};
+  int NumberOfSubdivisions{6};
+  double FractionalRange[2]{0.0, 1.0};
+
+protected:
+  vtkClosedSurfaceVoxelizer();
+  ~vtkClosedSurfaceVoxelizer() override;
+
+private:
+  vtkClosedSurfaceVoxelizer(const vtkClosedSurfaceVoxelizer&) = delete;
+  void operator=(const vtkClosedSurfaceVoxelizer&) = delete;
+};
+
+#endif
@@ -22,14 +22,405 @@
 #include "vtkSegmentationHistory.h"
 #include "vtkSegmentationConverterFactory.h"
 #include "vtkSegmentation.h"
+#include "vtkOrientedImageData.h"
 
 // VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkDataArray.h>
+#include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
-#include <vtkCallbackCommand.h>
+#include <vtkPointData.h>
+#include <vtkSMPTools.h>
 
 // std includes
 #include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <set>
+
+//----------------------------------------------------------------------------
+namespace
+{
+/// Size of compressed image blocks along each axis (in voxels)
+const int COMPRESSED_BLOCK_SIZE = 32;
+
+//----------------------------------------------------------------------------
+/// Encode the scalars of a block as a sequence of (number of repeats, value) pairs.
+/// Returns false if all the values in the block are zero.
+template <class T>
+bool EncodeBlock(const T* imagePtr, const int dims[3], int numberOfComponents, const int blockExtent[6],
+  std::vector<unsigned char>& encoded)
+{
+  encoded.clear();
+  bool nonZeroFound = false;
+  uint32_t runLength = 0;
+  T runValue = 0;
+  auto appendRun = [&]()
+  {
+    size_t offset = encoded.size();
+    encoded.resize(offset + sizeof(uint32_t) + sizeof(T));
+    memcpy(&encoded[offset], &runLength, sizeof(uint32_t));
+    memcpy(&encoded[offset + sizeof(uint32_t)], &runValue, sizeof(T));
+  };
+  const vtkIdType rowLength = static_cast<vtkIdType>(blockExtent[1] - blockExtent[0] + 1) * numberOfComponents;
+  for (int k = blockExtent[4]; k <= blockExtent[5]; k++)
+  {
+    for (int j = blockExtent[2]; j <= blockExtent[3]; j++)
+    {
+      const T* valuePtr = imagePtr + ((static_cast<vtkIdType>(k) * dims[1] + j) * dims[0] + blockExtent[0]) * numberOfComponents;
+      for (vtkIdType i = 0; i < rowLength; i++, valuePtr++)
+      {
+        if (runLength > 0 && *valuePtr == runValue && runLength < VTK_UNSIGNED_INT_MAX)
+        {
+          runLength++;
+          continue;
+        }
+        if (runLength > 0)
+        {
+          appendRun();
+        }
+        runValue = *valuePtr;
+        runLength = 1;
+        if (runValue != 0)
+        {
+          nonZeroFound = true;
+        }
+      }
+    }
+  }
+  if (!nonZeroFound)
+  {
+    encoded.clear();
+    return false;
+  }
+  appendRun();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Decode a block into the image. If encoded is nullptr then the block is filled with zeros.
+template <class T>
+void DecodeBlock(const std::vector<unsigned char>* encoded, T* imagePtr, const int dims[3], int numberOfComponents,
+  const int blockExtent[6])
+{
+  const vtkIdType rowLength = static_cast<vtkIdType>(blockExtent[1] - blockExtent[0] + 1) * numberOfComponents;
+  uint32_t runLength = 0;
+  T runValue = 0;
+  size_t offset = 0;
+  for (int k = blockExtent[4]; k <= blockExtent[5]; k++)
+  {
+    for (int j = blockExtent[2]; j <= blockExtent[3]; j++)
+    {
+      T* valuePtr = imagePtr + ((static_cast<vtkIdType>(k) * dims[1] + j) * dims[0] + blockExtent[0]) * numberOfComponents;
+      if (!encoded)
+      {
+        std::fill(valuePtr, valuePtr + rowLength, static_cast<T>(0));
+        continue;
+      }
+      vtkIdType remaining = rowLength;
+      while (remaining > 0)
+      {
+        if (runLength == 0)
+        {
+          if (offset + sizeof(uint32_t) + sizeof(T) > encoded->size())
+          {
+            // corrupted data, should never happen
+            std::fill(valuePtr, valuePtr + remaining, static_cast<T>(0));
+            break;
+          }
+          memcpy(&runLength, &(*encoded)[offset], sizeof(uint32_t));
+          memcpy(&runValue, &(*encoded)[offset + sizeof(uint32_t)], sizeof(T));
+          offset += sizeof(uint32_t) + sizeof(T);
+        }
+        vtkIdType count = std::min(static_cast<vtkIdType>(runLength), remaining);
+        std::fill(valuePtr, valuePtr + count, runValue);
+        valuePtr += count;
+        remaining -= count;
+        runLength -= static_cast<uint32_t>(count);
+      }
+    }
+  }
+}
+//----------------------------------------------------------------------------
+/// Same as vtkSegmentation::CopySegment, but image representations are not copied
+void CopySegmentWithoutImages(vtkSegment* destination, vtkSegment* source, vtkSegment* baseline,
+  std::map<vtkDataObject*, vtkDataObject*>& cachedRepresentations)
+{
+  destination->RemoveAllRepresentations();
+  destination->DeepCopyMetadata(source);
+
+  std::vector<std::string> representationNames;
+  source->GetContainedRepresentationNames(representationNames);
+  for (const std::string& representationName : representationNames)
+  {
+    vtkDataObject* sourceRepresentation = source->GetRepresentation(representationName);
+    if (vtkOrientedImageData::SafeDownCast(sourceRepresentation))
+    {
+      continue;
+    }
+    if (cachedRepresentations.find(sourceRepresentation) != cachedRepresentations.end())
+    {
+      destination->AddRepresentation(representationName, cachedRepresentations[sourceRepresentation]);
+      continue;
+    }
+    vtkDataObject* baselineRepresentation = (baseline ? baseline->GetRepresentation(representationName) : nullptr);
+    if (baselineRepresentation != nullptr
+      && baselineRepresentation->GetMTime() > sourceRepresentation->GetMTime())
+    {
+      destination->AddRepresentation(representationName, baselineRepresentation);
+      cachedRepresentations[sourceRepresentation] = baselineRepresentation;
+      continue;
+    }
+    vtkSmartPointer<vtkDataObject> representationCopy = vtkSmartPointer<vtkDataObject>::Take(
+      vtkSegmentationConverterFactory::GetInstance()->ConstructRepresentationObjectByClass(sourceRepresentation->GetClassName()));
+    if (!representationCopy)
+    {
+      vtkErrorWithObjectMacro(nullptr, "CopySegmentWithoutImages: Unable to construct representation type class '"
+        << sourceRepresentation->GetClassName() << "'");
+      continue;
+    }
+    representationCopy->DeepCopy(sourceRepresentation);
+    destination->AddRepresentation(representationName, representationCopy);
+    cachedRepresentations[sourceRepresentation] = representationCopy;
+  }
+}
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+class vtkSegmentationHistory::CompressedImage
+{
+public:
+  typedef std::vector<unsigned char> Block;
+
+  /// Store the image. Compression is performed in a background thread.
+  /// Blocks that are the same as in the baseline are shared with the baseline.
+  CompressedImage(vtkOrientedImageData* image, std::shared_ptr<CompressedImage> baseline)
+  {
+    image->GetExtent(this->Extent);
+    vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+    image->GetImageToWorldMatrix(imageToWorldMatrix);
+    for (int i = 0; i < 16; i++)
+    {
+      this->ImageToWorldMatrix[i] = imageToWorldMatrix->GetElement(i / 4, i % 4);
+    }
+    vtkDataArray* scalars = (image->GetPointData() ? image->GetPointData()->GetScalars() : nullptr);
+    if (!scalars || image->IsEmpty())
+    {
+      // Nothing to compress
+      this->Extent[0] = this->Extent[2] = this->Extent[4] = 0;
+      this->Extent[1] = this->Extent[3] = this->Extent[5] = -1;
+      return;
+    }
+    this->ScalarType = scalars->GetDataType();
+    this->NumberOfComponents = scalars->GetNumberOfComponents();
+    int dims[3] = { 0, 0, 0 };
+    image->GetDimensions(dims);
+    for (int i = 0; i < 3; i++)
+    {
+      this->NumberOfBlocks[i] = (dims[i] + COMPRESSED_BLOCK_SIZE - 1) / COMPRESSED_BLOCK_SIZE;
+    }
+    this->Blocks.resize(static_cast<size_t>(this->NumberOfBlocks[0]) * this->NumberOfBlocks[1] * this->NumberOfBlocks[2]);
+
+    // Copy the voxels so that the image can be modified while the compression is in progress
+    this->UncompressedSize = static_cast<vtkTypeInt64>(scalars->GetNumberOfValues()) * scalars->GetDataTypeSize();
+    std::shared_ptr<std::vector<char> > snapshot = std::make_shared<std::vector<char> >(this->UncompressedSize);
+    memcpy(snapshot->data(), scalars->GetVoidPointer(0), this->UncompressedSize);
+
+    if (baseline && !this->HasSameLayout(*baseline))
+    {
+      baseline = nullptr;
+    }
+    this->Compression = std::async(std::launch::async, [this, snapshot, baseline]() mutable
+    {
+      if (baseline)
+      {
+        baseline->WaitForCompression();
+      }
+      this->Compress(snapshot->data(), baseline.get());
+      // release references as soon as possible (the lambda is kept until the future is destroyed)
+      snapshot.reset();
+      baseline.reset();
+    }).share();
+  }
+
+  ~CompressedImage()
+  {
+    this->WaitForCompression();
+  }
+
+  void WaitForCompression()
+  {
+    if (this->Compression.valid())
+    {
+      this->Compression.wait();
+    }
+  }
+
+  bool IsCompressionCompleted()
+  {
+    return !this->Compression.valid()
+      || this->Compression.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+  }
+
+  /// Returns true if extent and scalar type are the same (blocks can be compared)
+  bool HasSameLayout(const CompressedImage& other) const
+  {
+    return std::equal(this->Extent, this->Extent + 6, other.Extent)
+      && this->ScalarType == other.ScalarType
+      && this->NumberOfComponents == other.NumberOfComponents;
+  }
+
+  bool HasSameLayout(vtkOrientedImageData* image) const
+  {
+    int extent[6] = { 0, -1, 0, -1, 0, -1 };
+    image->GetExtent(extent);
+    vtkDataArray* scalars = (image->GetPointData() ? image->GetPointData()->GetScalars() : nullptr);
+    if (this->Blocks.empty())
+    {
+      return false;
+    }
+    return scalars && std::equal(this->Extent, this->Extent + 6, extent)
+      && this->ScalarType == scalars->GetDataType()
+      && this->NumberOfComponents == scalars->GetNumberOfComponents();
+  }
+
+  /// Write the image. If the image contains the content of a previously compressed image
+  /// with the same layout then only the blocks that are different are written.
+  void Decompress(vtkOrientedImageData* image, CompressedImage* currentContent)
+  {
+    this->WaitForCompression();
+    vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+    for (int i = 0; i < 16; i++)
+    {
+      imageToWorldMatrix->SetElement(i / 4, i % 4, this->ImageToWorldMatrix[i]);
+    }
+    image->SetImageToWorldMatrix(imageToWorldMatrix);
+    if (this->Blocks.empty())
+    {
+      image->SetExtent(this->Extent);
+      image->AllocateScalars(this->ScalarType, this->NumberOfComponents);
+      return;
+    }
+    if (currentContent)
+    {
+      currentContent->WaitForCompression();
+    }
+    if (!currentContent || !this->HasSameLayout(*currentContent) || !this->HasSameLayout(image))
+    {
+      currentContent = nullptr;
+      image->SetExtent(this->Extent);
+      image->AllocateScalars(this->ScalarType, this->NumberOfComponents);
+    }
+    int dims[3] = { 0, 0, 0 };
+    image->GetDimensions(dims);
+    void* imagePtr = image->GetScalarPointer();
+    vtkSMPTools::For(0, static_cast<vtkIdType>(this->Blocks.size()), [&](vtkIdType firstBlock, vtkIdType lastBlock)
+    {
+      for (vtkIdType blockIndex = firstBlock; blockIndex < lastBlock; blockIndex++)
+      {
+        const Block* block = this->Blocks[blockIndex].get();
+        if (currentContent && currentContent->Blocks[blockIndex].get() == block)
+        {
+          // block is not changed
+          continue;
+        }
+        int blockExtent[6] = { 0, -1, 0, -1, 0, -1 };
+        this->GetBlockExtent(blockIndex, dims, blockExtent);
+        switch (this->ScalarType)
+        {
+          vtkTemplateMacro(DecodeBlock<VTK_TT>(block, static_cast<VTK_TT*>(imagePtr), dims, this->NumberOfComponents, blockExtent));
+        }
+      }
+    });
+  }
+
+  /// Add memory size of blocks that are not yet in countedBlocks
+  vtkTypeInt64 GetMemorySize(std::set<const void*>& countedBlocks)
+  {
+    if (!countedBlocks.insert(this).second)
+    {
+      return 0;
+    }
+    if (!this->IsCompressionCompleted())
+    {
+      return this->UncompressedSize;
+    }
+    vtkTypeInt64 memorySize = sizeof(CompressedImage) + this->Blocks.size() * sizeof(std::shared_ptr<const Block>);
+    for (const std::shared_ptr<const Block>& block : this->Blocks)
+    {
+      if (block && countedBlocks.insert(block.get()).second)
+      {
+        memorySize += block->capacity();
+      }
+    }
+    return memorySize;
+  }
+
+protected:
+  void GetBlockExtent(vtkIdType blockIndex, const int dims[3], int blockExtent[6]) const
+  {
+    int blockIjk[3] =
+    {
+      static_cast<int>(blockIndex % this->NumberOfBlocks[0]),
+      static_cast<int>((blockIndex / this->NumberOfBlocks[0]) % this->NumberOfBlocks[1]),
+      static_cast<int>(blockIndex / (static_cast<vtkIdType>(this->NumberOfBlocks[0]) * this->NumberOfBlocks[1]))
+    };
+    for (int i = 0; i < 3; i++)
+    {
+      blockExtent[2 * i] = blockIjk[i] * COMPRESSED_BLOCK_SIZE;
+      blockExtent[2 * i + 1] = std::min(blockExtent[2 * i] + COMPRESSED_BLOCK_SIZE, dims[i]) - 1;
+    }
+  }
+
+  void Compress(const char* imagePtr, CompressedImage* baseline)
+  {
+    int dims[3] = { 0, 0, 0 };
+    for (int i = 0; i < 3; i++)
+    {
+      dims[i] = this->Extent[2 * i + 1] - this->Extent[2 * i] + 1;
+    }
+    vtkSMPTools::For(0, static_cast<vtkIdType>(this->Blocks.size()), [&](vtkIdType firstBlock, vtkIdType lastBlock)
+    {
+      Block encoded;
+      for (vtkIdType blockIndex = firstBlock; blockIndex < lastBlock; blockIndex++)
+      {
+        int blockExtent[6] = { 0, -1, 0, -1, 0, -1 };
+        this->GetBlockExtent(blockIndex, dims, blockExtent);
+        bool nonZero = false;
+        switch (this->ScalarType)
+        {
+          vtkTemplateMacro(nonZero = EncodeBlock<VTK_TT>(reinterpret_cast<const VTK_TT*>(imagePtr), dims, this->NumberOfComponents, blockExtent, encoded));
+        }
+        if (!nonZero)
+        {
+          continue;
+        }
+        std::shared_ptr<const Block> baselineBlock = (baseline ? baseline->Blocks[blockIndex] : nullptr);
+        if (baselineBlock && *baselineBlock == encoded)
+        {
+          this->Blocks[blockIndex] = baselineBlock;
+        }
+        else
+        {
+          this->Blocks[blockIndex] = std::make_shared<const Block>(encoded.begin(), encoded.end());
+        }
+      }
+    });
+  }
+
+  int Extent[6] = { 0, -1, 0, -1, 0, -1 };
+  double ImageToWorldMatrix[16];
+  int ScalarType{ VTK_UNSIGNED_CHAR };
+  int NumberOfComponents{ 1 };
+  int NumberOfBlocks[3] = { 0, 0, 0 };
+  vtkTypeInt64 UncompressedSize{ 0 };
+  /// Run-length encoded blocks. nullptr means that all values in the block are zero.
+  std::vector<std::shared_ptr<const Block> > Blocks;
+  /// Must be the last member, so that it is destroyed first (waits for the compression to complete)
+  std::shared_future<void> Compression;
+};
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSegmentationHistory);
@@ -40,6 +431,7 @@ vtkSegmentationHistory::vtkSegmentationHistory()
   this->Segmentation = nullptr;
 
   this->MaximumNumberOfStates = 5;
+  this->MaximumMemorySizeBytes = 1024 * 1024 * 1024;
 
   this->LastRestoredState = 0;
   this->RestoreStateInProgress = false;
@@ -98,6 +490,8 @@ void vtkSegmentationHistory::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Modified Time: " << this->GetMTime() << "\n";
 
   os << indent << "Number of saved states:  " << this->SegmentationStates.size() << "\n";
+  os << indent << "MaximumNumberOfStates: " << this->MaximumNumberOfStates << "\n";
+  os << indent << "MaximumMemorySizeBytes: " << this->MaximumMemorySizeBytes << "\n";
 }
 
 //---------------------------------------------------------------------------
@@ -124,6 +518,51 @@ bool vtkSegmentationHistory::SaveState()
 
   this->RemoveAllNextStates();
 
+  // Forget about images that have been deleted
+  for (auto liveImageIt = this->LiveImages.begin(); liveImageIt != this->LiveImages.end();)
+  {
+    if (liveImageIt->second.Image.GetPointer() == nullptr)
+    {
+      liveImageIt = this->LiveImages.erase(liveImageIt);
+    }
+    else
+    {
+      ++liveImageIt;
+    }
+  }
+
+  // Image representations are compressed. If an image is not modified since it was last
+  // saved or restored then its known content is reused, otherwise it is compressed
+  // using its previous content as baseline (so that unchanged blocks are shared).
+  std::map<vtkDataObject*, std::shared_ptr<CompressedImage> > savedImages;
+  auto saveImage = [&](vtkOrientedImageData* image)
+  {
+    auto savedImageIt = savedImages.find(image);
+    if (savedImageIt != savedImages.end())
+    {
+      // shared labelmap, already saved for a previous segment
+      return savedImageIt->second;
+    }
+    std::shared_ptr<CompressedImage> baseline;
+    auto liveImageIt = this->LiveImages.find(image);
+    if (liveImageIt != this->LiveImages.end() && liveImageIt->second.Image.GetPointer() == image)
+    {
+      baseline = liveImageIt->second.Content;
+      if (liveImageIt->second.MTime == image->GetMTime())
+      {
+        savedImages[image] = baseline;
+        return baseline;
+      }
+    }
+    std::shared_ptr<CompressedImage> compressedImage = std::make_shared<CompressedImage>(image, baseline);
+    LiveImage& liveImage = this->LiveImages[image];
+    liveImage.Image = image;
+    liveImage.MTime = image->GetMTime();
+    liveImage.Content = compressedImage;
+    savedImages[image] = compressedImage;
+    return compressedImage;
+  };
+
   SegmentationState newSegmentationState;
 
   std::vector<std::string> segmentIDs;
@@ -151,8 +590,19 @@ bool vtkSegmentationHistory::SaveState()
     }
 
     vtkSmartPointer<vtkSegment> segmentClone = vtkSmartPointer<vtkSegment>::New();
-    vtkSegmentation::CopySegment(segmentClone, segment, baselineSegment, savedObjects);
+    CopySegmentWithoutImages(segmentClone, segment, baselineSegment, savedObjects);
     newSegmentationState.Segments[*segmentIDIt] = segmentClone;
+
+    std::vector<std::string> representationNames;
+    segment->GetContainedRepresentationNames(representationNames);
+    for (const std::string& representationName : representationNames)
+    {
+      vtkOrientedImageData* image = vtkOrientedImageData::SafeDownCast(segment->GetRepresentation(representationName));
+      if (image)
+      {
+        newSegmentationState.SegmentImages[*segmentIDIt][representationName] = saveImage(image);
+      }
+    }
   }
   this->SegmentationStates.push_back(newSegmentationState);
 
@@ -226,6 +676,8 @@ bool vtkSegmentationHistory::RestoreState(unsigned int stateIndex)
 
   std::set<std::string> segmentIDsToKeep;
   std::map<vtkDataObject*, vtkDataObject*> restoredRepresentations;
+  // Restored image for each compressed image (segments that shared a labelmap in the restored state will share it again)
+  std::map<CompressedImage*, vtkSmartPointer<vtkOrientedImageData> > restoredImages;
   for (SegmentsMap::iterator restoredSegmentsIt = restoredState.Segments.begin();
     restoredSegmentsIt != restoredState.Segments.end(); ++restoredSegmentsIt)
   {
@@ -240,6 +692,12 @@ bool vtkSegmentationHistory::RestoreState(unsigned int stateIndex)
 
     std::vector<std::string> restoredRepresentationNames;
     segmentToRestore->GetContainedRepresentationNames(restoredRepresentationNames);
+    const CompressedImagesMap& imagesToRestore = restoredState.SegmentImages[restoredSegmentsIt->first];
+    for (const auto& imageToRestore : imagesToRestore)
+    {
+      restoredRepresentationNames.push_back(imageToRestore.first);
+    }
+    std::sort(restoredRepresentationNames.begin(), restoredRepresentationNames.end());
     std::vector<std::string> currentRepresentationNames;
     segment->GetContainedRepresentationNames(currentRepresentationNames);
     if (restoredRepresentationNames != currentRepresentationNames)
@@ -247,7 +705,60 @@ bool vtkSegmentationHistory::RestoreState(unsigned int stateIndex)
       containedRepresentationNamesModified = true;
     }
 
-    vtkSegmentation::CopySegment(segment, segmentToRestore, nullptr, restoredRepresentations);
+    // Restore image representations. The current image object of the segment is updated if possible,
+    // in which case only the blocks that are different from its current content are written.
+    std::map<std::string, vtkSmartPointer<vtkOrientedImageData> > images;
+    for (const auto& imageToRestore : imagesToRestore)
+    {
+      CompressedImage* compressedImage = imageToRestore.second.get();
+      auto restoredImageIt = restoredImages.find(compressedImage);
+      if (restoredImageIt != restoredImages.end())
+      {
+        images[imageToRestore.first] = restoredImageIt->second;
+        continue;
+      }
+      vtkSmartPointer<vtkOrientedImageData> image = vtkOrientedImageData::SafeDownCast(segment->GetRepresentation(imageToRestore.first));
+      for (const auto& restoredImage : restoredImages)
+      {
+        if (restoredImage.second == image)
+        {
+          // this image is already used for restoring a different layer
+          image = nullptr;
+          break;
+        }
+      }
+      CompressedImage* currentContent = nullptr;
+      if (image)
+      {
+        auto liveImageIt = this->LiveImages.find(image);
+        if (liveImageIt != this->LiveImages.end() && liveImageIt->second.Image.GetPointer() == image
+          && liveImageIt->second.MTime == image->GetMTime())
+        {
+          currentContent = liveImageIt->second.Content.get();
+        }
+      }
+      else
+      {
+        image = vtkSmartPointer<vtkOrientedImageData>::New();
+      }
+      if (currentContent != compressedImage)
+      {
+        compressedImage->Decompress(image, currentContent);
+        image->Modified();
+      }
+      LiveImage& liveImage = this->LiveImages[image];
+      liveImage.Image = image;
+      liveImage.MTime = image->GetMTime();
+      liveImage.Content = imageToRestore.second;
+      restoredImages[compressedImage] = image;
+      images[imageToRestore.first] = image;
+    }
+
+    CopySegmentWithoutImages(segment, segmentToRestore, nullptr, restoredRepresentations);
+    for (const auto& image : images)
+    {
+      segment->AddRepresentation(image.first, image.second);
+    }
 
     // Remove representations that are not in the restoring segment
     for (std::string representationName : currentRepresentationNames)
@@ -323,7 +834,10 @@ void vtkSegmentationHistory::RemoveAllNextStates()
 void vtkSegmentationHistory::RemoveAllObsoleteStates()
 {
   bool modified = false;
-  while ((this->SegmentationStates.size() > this->MaximumNumberOfStates) && (!this->SegmentationStates.empty()))
+  while (!this->SegmentationStates.empty()
+    && (this->SegmentationStates.size() > this->MaximumNumberOfStates
+      || (this->MaximumMemorySizeBytes > 0 && this->SegmentationStates.size() > 1 && this->LastRestoredState > 0
+        && this->IsMemoryLimitExceeded())))
   {
     this->SegmentationStates.pop_front();
     this->LastRestoredState--;
@@ -335,6 +849,19 @@ void vtkSegmentationHistory::RemoveAllObsoleteStates()
   }
 }
 
+//---------------------------------------------------------------------------
+bool vtkSegmentationHistory::IsMemoryLimitExceeded()
+{
+  // Images that are still being compressed are counted with their uncompressed size,
+  // which overestimates the memory usage. Only wait for the compression to complete
+  // (and count the actual compressed size) if the estimate is over the limit.
+  if (this->ComputeMemorySizeBytes(false) <= this->MaximumMemorySizeBytes)
+  {
+    return false;
+  }
+  return this->ComputeMemorySizeBytes(true) > this->MaximumMemorySizeBytes;
+}
+
 //---------------------------------------------------------------------------
 void vtkSegmentationHistory::SetMaximumNumberOfStates(unsigned int maximumNumberOfStates)
 {
@@ -347,6 +874,60 @@ void vtkSegmentationHistory::SetMaximumNumberOfStates(unsigned int maximumNumber
   this->Modified();
 }
 
+//---------------------------------------------------------------------------
+void vtkSegmentationHistory::SetMaximumMemorySizeBytes(vtkTypeInt64 maximumMemorySizeBytes)
+{
+  if (maximumMemorySizeBytes == this->MaximumMemorySizeBytes)
+  {
+    return;
+  }
+  this->MaximumMemorySizeBytes = maximumMemorySizeBytes;
+  this->RemoveAllObsoleteStates();
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+vtkTypeInt64 vtkSegmentationHistory::GetMemorySizeBytes()
+{
+  return this->ComputeMemorySizeBytes(true);
+}
+
+//---------------------------------------------------------------------------
+vtkTypeInt64 vtkSegmentationHistory::ComputeMemorySizeBytes(bool waitForCompression)
+{
+  vtkTypeInt64 memorySizeBytes = 0;
+  std::set<const void*> countedObjects;
+  for (SegmentationState& state : this->SegmentationStates)
+  {
+    for (auto& segment : state.Segments)
+    {
+      std::vector<std::string> representationNames;
+      segment.second->GetContainedRepresentationNames(representationNames);
+      for (const std::string& representationName : representationNames)
+      {
+        vtkDataObject* representation = segment.second->GetRepresentation(representationName);
+        if (representation && countedObjects.insert(representation).second)
+        {
+          // GetActualMemorySize returns kibibytes
+          memorySizeBytes += static_cast<vtkTypeInt64>(representation->GetActualMemorySize()) * 1024;
+        }
+      }
+    }
+    for (auto& segmentImages : state.SegmentImages)
+    {
+      for (auto& image : segmentImages.second)
+      {
+        if (waitForCompression)
+        {
+          image.second->WaitForCompression();
+        }
+        memorySizeBytes += image.second->GetMemorySize(countedObjects);
+      }
+    }
+  }
+  return memorySizeBytes;
+}
+
 //---------------------------------------------------------------------------
 void vtkSegmentationHistory::OnSegmentationModified(vtkObject* vtkNotUsed(caller),
   unsigned long vtkNotUsed(eid),
@@ -376,6 +957,7 @@ void vtkSegmentationHistory::OnSegmentationModified(vtkObject* vtkNotUsed(caller
 void vtkSegmentationHistory::RemoveAllStates()
 {
   this->SegmentationStates.clear();
+  this->LiveImages.clear();
   this->LastRestoredState = 0;
   this->Modified();
 }
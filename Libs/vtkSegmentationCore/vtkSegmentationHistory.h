@@ -24,19 +24,28 @@
 // VTK includes
 #include <vtkObject.h>
 #include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
 
 // STD includes
 #include <deque>
 #include <map>
+#include <memory>
 #include <vector>
 
 #include "vtkSegmentationCoreConfigure.h"
 
 class vtkCallbackCommand;
 class vtkDataObject;
+class vtkOrientedImageData;
 class vtkSegment;
 class vtkSegmentation;
 
+/// \brief Undo/redo history of a segmentation.
+///
+/// Image representations (such as binary labelmap layers) are stored in blocks that are run-length encoded
+/// in a background thread. Blocks that are the same as in the previous state are shared between states,
+/// therefore a state that only changed a small region of a large labelmap uses little memory,
+/// and restoring a state only writes the blocks that are different from the current content of the labelmap.
 class vtkSegmentationCore_EXPORT vtkSegmentationHistory : public vtkObject
 {
 public:
@@ -85,6 +94,19 @@ public:
   /// Get the current number of states.
   int GetNumberOfStates();
 
+  /// Limits how much memory the stored states may use (in bytes).
+  /// If the limit is exceeded then the oldest states are removed (the most recent state is always kept).
+  /// 0 means there is no limit. Default is 1GB.
+  void SetMaximumMemorySizeBytes(vtkTypeInt64 maximumMemorySizeBytes);
+
+  /// Get the limit of how much memory the stored states may use (in bytes).
+  vtkGetMacro(MaximumMemorySizeBytes, vtkTypeInt64);
+
+  /// Get the memory used by the stored states (in bytes).
+  /// Data that is shared between states is only counted once.
+  /// Waits for completion of compression of recently saved states.
+  vtkTypeInt64 GetMemorySizeBytes();
+
 protected:
   /// Callback function called when the segmentation has been modified.
   /// It clears all states that are more recent than the last restored state.
@@ -94,8 +116,19 @@ protected:
   void RemoveAllNextStates();
 
   /// Delete all old states so that we keep only up to MaximumNumberOfStates states
+  /// and the memory size is within MaximumMemorySizeBytes
   void RemoveAllObsoleteStates();
 
+  /// Get memory used by stored states. Images that are still being compressed are counted
+  /// with their uncompressed size, unless waitForCompression is enabled.
+  vtkTypeInt64 ComputeMemorySizeBytes(bool waitForCompression);
+
+  /// Returns true if the stored states use more memory than MaximumMemorySizeBytes.
+  /// Images are counted with their compressed size: if the limit is exceeded when
+  /// pending compressions are counted with their uncompressed size then the method
+  /// waits for the compressions to complete and checks the limit again.
+  bool IsMemoryLimitExceeded();
+
   /// Restores a state defined by stateIndex.
   bool RestoreState(unsigned int stateIndex);
 
@@ -105,16 +138,36 @@ protected:
 
   typedef std::map<std::string, vtkSmartPointer<vtkSegment> > SegmentsMap;
 
+  /// Compressed copy of an image representation
+  class CompressedImage;
+  /// Compressed image representations of a segment, indexed by representation name.
+  /// Segments that share a labelmap layer point to the same compressed image.
+  typedef std::map<std::string, std::shared_ptr<CompressedImage> > CompressedImagesMap;
+
   struct SegmentationState
   {
-    SegmentsMap Segments;
+    SegmentsMap Segments; // segment metadata and non-image representations
+    std::map<std::string, CompressedImagesMap> SegmentImages; // image representations of each segment
     std::vector<std::string> SegmentIds; // order of segments
   };
 
+  /// Content of an image representation in the segmentation
+  struct LiveImage
+  {
+    vtkWeakPointer<vtkDataObject> Image;
+    vtkMTimeType MTime;
+    std::shared_ptr<CompressedImage> Content; // image content at MTime
+  };
+
   vtkSegmentation* Segmentation;
   vtkCallbackCommand* SegmentationModifiedCallbackCommand;
   std::deque<SegmentationState> SegmentationStates;
   unsigned int MaximumNumberOfStates;
+  vtkTypeInt64 MaximumMemorySizeBytes;
+
+  // Known content of image representations in the segmentation, indexed by image pointer.
+  // Used for avoiding compression of unchanged images and for restoring only changed blocks.
+  std::map<vtkDataObject*, LiveImage> LiveImages;
 
   // Index of the state in SegmentationStates that was restored last.
   // If LastRestoredState == size of states then it means that the segmentation has changed
@@ -0,0 +1,492 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// vtkTeem includes
+#include <vtkDiffusionTensorGlyph.h>
+#include <vtkDiffusionTensorMathematics.h>
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+#include <vtkTransform.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Create a small tensor volume with random orientations and positive eigenvalues
+void CreateTensorImage(vtkImageData* tensorImage)
+{
+  tensorImage->SetDimensions(7, 6, 3);
+  tensorImage->SetOrigin(-10.0, 5.0, 2.5);
+  tensorImage->SetSpacing(1.5, 2.0, 2.5);
+  vtkNew<vtkFloatArray> tensors;
+  tensors->SetNumberOfComponents(9);
+  tensors->SetName("tensors");
+  tensors->SetNumberOfTuples(tensorImage->GetNumberOfPoints());
+  tensorImage->GetPointData()->SetTensors(tensors);
+
+  vtkMath::RandomSeed(42);
+  float* ptr = tensors->GetPointer(0);
+  for (vtkIdType voxelIndex = 0; voxelIndex < tensors->GetNumberOfTuples(); ++voxelIndex, ptr += 9)
+  {
+    double l[3] = { vtkMath::Random(1.5e-3, 3.0e-3), vtkMath::Random(0.8e-3, 1.4e-3), vtkMath::Random(0.2e-3, 0.7e-3) };
+    double quaternion[4] = { vtkMath::Random(-1.0, 1.0), vtkMath::Random(-1.0, 1.0),
+      vtkMath::Random(-1.0, 1.0), vtkMath::Random(-1.0, 1.0) };
+    double norm = sqrt(quaternion[0] * quaternion[0] + quaternion[1] * quaternion[1]
+      + quaternion[2] * quaternion[2] + quaternion[3] * quaternion[3]);
+    for (int i = 0; i < 4; ++i)
+    {
+      quaternion[i] /= norm;
+    }
+    double rotation[3][3];
+    vtkMath::QuaternionToMatrix3x3(quaternion, rotation);
+    for (int i = 0; i < 3; ++i)
+    {
+      for (int j = 0; j < 3; ++j)
+      {
+        double value = 0.0;
+        for (int k = 0; k < 3; ++k)
+        {
+          value += rotation[i][k] * l[k] * rotation[j][k];
+        }
+        ptr[3 * i + j] = static_cast<float>(value);
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+// Generate glyphs the same way as the original serial implementation of
+// vtkDiffusionTensorGlyph::RequestData (glyph transforms are built with
+// vtkTransform), for unmasked input that is colored by eigenvalues.
+void ComputeReferenceGlyphs(vtkDiffusionTensorGlyph* glyphFilter, vtkImageData* input, vtkPolyData* source,
+  vtkPolyData* output)
+{
+  int numDirs = (glyphFilter->GetThreeGlyphs() ? 3 : 1) * (glyphFilter->GetSymmetric() + 1);
+  vtkDataArray* inTensors = input->GetPointData()->GetTensors();
+  vtkIdType numPts = input->GetNumberOfPoints();
+  vtkPoints* sourcePts = source->GetPoints();
+  vtkIdType numSourcePts = sourcePts->GetNumberOfPoints();
+  vtkDataArray* sourceNormals = source->GetPointData()->GetNormals();
+  vtkCellArray* sourcePolys = source->GetPolys();
+
+  vtkNew<vtkPoints> newPts;
+  vtkNew<vtkFloatArray> newNormals;
+  newNormals->SetNumberOfComponents(3);
+  vtkNew<vtkFloatArray> newScalars;
+  vtkNew<vtkCellArray> newPolys;
+
+  int skipRows = glyphFilter->GetDimensionResolution()[1];
+  int skipCols = glyphFilter->GetDimensionResolution()[0];
+  int rowLength = input->GetDimensions()[0];
+  int row = 0;
+  int col = 0;
+
+  vtkNew<vtkTransform> userVolumeTransform;
+  if (glyphFilter->GetVolumePositionMatrix())
+  {
+    userVolumeTransform->SetMatrix(glyphFilter->GetVolumePositionMatrix());
+  }
+  userVolumeTransform->PreMultiply();
+  vtkMatrix4x4* tensorRotationMatrix = glyphFilter->GetTensorRotationMatrix();
+  bool flipNormals = (tensorRotationMatrix && tensorRotationMatrix->Determinant() < 0);
+
+  vtkNew<vtkTransform> trans;
+  trans->PreMultiply();
+  vtkNew<vtkMatrix4x4> matrix;
+  vtkIdType ptOffset = 0;
+  for (vtkIdType inPtId = 0; inPtId < numPts; inPtId += skipCols)
+  {
+    if (col >= rowLength)
+    {
+      row += skipRows;
+      inPtId = row * rowLength;
+      col = 0;
+      if (inPtId >= numPts)
+      {
+        break;
+      }
+    }
+    col += skipCols;
+
+    double tensor[3][3];
+    inTensors->GetTuple(inPtId, (double*)tensor);
+    if (vtkDiffusionTensorMathematics::Trace(tensor) <= 0)
+    {
+      continue;
+    }
+
+    const vtkIdType* cellPts = nullptr;
+    vtkIdType npts = 0;
+    for (sourcePolys->InitTraversal(); sourcePolys->GetNextCell(npts, cellPts);)
+    {
+      for (int dir = 0; dir < numDirs; dir++)
+      {
+        std::vector<vtkIdType> pts(cellPts, cellPts + npts);
+        for (vtkIdType& ptId : pts)
+        {
+          ptId += ptOffset + dir * numSourcePts;
+        }
+        newPolys->InsertNextCell(npts, pts.data());
+      }
+    }
+
+    double m0[3], m1[3], m2[3], v0[3], v1[3], v2[3];
+    double* m[3] = { m0, m1, m2 };
+    double* v[3] = { v0, v1, v2 };
+    double w[3], xv[3], yv[3], zv[3];
+    if (glyphFilter->GetExtractEigenvalues())
+    {
+      for (int j = 0; j < 3; j++)
+      {
+        for (int i = 0; i < 3; i++)
+        {
+          m[i][j] = tensor[j][i];
+        }
+      }
+      vtkDiffusionTensorMathematics::TeemEigenSolver(m, w, v);
+      xv[0] = v[0][0]; xv[1] = v[1][0]; xv[2] = v[2][0];
+      yv[0] = v[0][1]; yv[1] = v[1][1]; yv[2] = v[2][1];
+      zv[0] = v[0][2]; zv[1] = v[1][2]; zv[2] = v[2][2];
+    }
+    else
+    {
+      for (int i = 0; i < 3; i++)
+      {
+        xv[i] = tensor[0][i];
+        yv[i] = tensor[1][i];
+        zv[i] = tensor[2][i];
+      }
+      w[0] = vtkMath::Normalize(xv);
+      w[1] = vtkMath::Normalize(yv);
+      w[2] = vtkMath::Normalize(zv);
+    }
+
+    vtkDiffusionTensorMathematics::FixNegativeEigenvaluesMethod(w);
+    double s = 0.0;
+    if (glyphFilter->GetExtractEigenvalues())
+    {
+      // color by orientation
+      double v_maj[3] = { v[0][0], v[1][0], v[2][0] };
+      if (tensorRotationMatrix)
+      {
+        vtkNew<vtkTransform> rotate;
+        rotate->SetMatrix(tensorRotationMatrix);
+        rotate->TransformPoint(v_maj, v_maj);
+      }
+      vtkDiffusionTensorMathematics::RGBToIndex(fabs(v_maj[0]), fabs(v_maj[1]), fabs(v_maj[2]), s);
+    }
+    else
+    {
+      s = vtkDiffusionTensorMathematics::FractionalAnisotropy(w);
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+      w[i] = sqrt(w[i]) * glyphFilter->GetScaleFactor();
+    }
+    if (glyphFilter->GetClampScaling())
+    {
+      double maxScale = std::max(fabs(w[0]), std::max(fabs(w[1]), fabs(w[2])));
+      if (maxScale > glyphFilter->GetMaxScaleFactor())
+      {
+        maxScale = glyphFilter->GetMaxScaleFactor() / maxScale;
+        for (int i = 0; i < 3; i++)
+        {
+          w[i] *= maxScale;
+        }
+      }
+    }
+
+    for (int dir = 0; dir < numDirs; dir++)
+    {
+      int eigen_dir = dir % (glyphFilter->GetThreeGlyphs() ? 3 : 1);
+      int symmetric_dir = dir / (glyphFilter->GetThreeGlyphs() ? 3 : 1);
+      trans->Identity();
+      for (vtkIdType i = 0; i < numSourcePts; i++)
+      {
+        newScalars->InsertTuple(ptOffset + i, &s);
+      }
+      double x[3], x2[3];
+      input->GetPoint(inPtId, x);
+      userVolumeTransform->TransformPoint(x, x2);
+      trans->Translate(x2[0], x2[1], x2[2]);
+      if (tensorRotationMatrix)
+      {
+        trans->Concatenate(tensorRotationMatrix);
+      }
+      matrix->Identity();
+      matrix->Element[0][0] = xv[0];
+      matrix->Element[0][1] = yv[0];
+      matrix->Element[0][2] = zv[0];
+      matrix->Element[1][0] = xv[1];
+      matrix->Element[1][1] = yv[1];
+      matrix->Element[1][2] = zv[1];
+      matrix->Element[2][0] = xv[2];
+      matrix->Element[2][1] = yv[2];
+      matrix->Element[2][2] = zv[2];
+      trans->Concatenate(matrix);
+      if (eigen_dir == 1)
+      {
+        trans->RotateZ(90.0);
+      }
+      if (eigen_dir == 2)
+      {
+        trans->RotateY(-90.0);
+      }
+      if (glyphFilter->GetThreeGlyphs())
+      {
+        trans->Scale(w[eigen_dir], glyphFilter->GetScaleFactor(), glyphFilter->GetScaleFactor());
+      }
+      else
+      {
+        trans->Scale(w[0], w[1], w[2]);
+      }
+      if (symmetric_dir == 1)
+      {
+        trans->Scale(-1., 1., 1.);
+      }
+      trans->TransformPoints(sourcePts, newPts);
+      if (flipNormals)
+      {
+        trans->Scale(-1., -1., -1.);
+        trans->TransformNormals(sourceNormals, newNormals);
+        trans->Scale(-1., -1., -1.);
+      }
+      else
+      {
+        trans->TransformNormals(sourceNormals, newNormals);
+      }
+      ptOffset += numSourcePts;
+    }
+  }
+
+  output->SetPoints(newPts);
+  output->SetPolys(newPolys);
+  output->GetPointData()->SetNormals(newNormals);
+  output->GetPointData()->SetScalars(newScalars);
+}
+
+//----------------------------------------------------------------------------
+bool CompareTuples(vtkDataArray* values, vtkDataArray* expectedValues, double relativeTolerance, const char* name)
+{
+  if (!values || !expectedValues)
+  {
+    std::cerr << "Line " << __LINE__ << ": missing " << name << std::endl;
+    return false;
+  }
+  if (values->GetNumberOfTuples() != expectedValues->GetNumberOfTuples()
+    || values->GetNumberOfComponents() != expectedValues->GetNumberOfComponents())
+  {
+    std::cerr << "Line " << __LINE__ << ": number of " << name << " mismatch: "
+      << values->GetNumberOfTuples() << " != " << expectedValues->GetNumberOfTuples() << std::endl;
+    return false;
+  }
+  double maxAbsValue = 0.0;
+  for (int component = 0; component < expectedValues->GetNumberOfComponents(); ++component)
+  {
+    double range[2] = { 0.0, 0.0 };
+    expectedValues->GetRange(range, component);
+    maxAbsValue = std::max(maxAbsValue, std::max(fabs(range[0]), fabs(range[1])));
+  }
+  const double tolerance = relativeTolerance * std::max(maxAbsValue, 1.0);
+  for (vtkIdType tupleIndex = 0; tupleIndex < expectedValues->GetNumberOfTuples(); ++tupleIndex)
+  {
+    for (int component = 0; component < expectedValues->GetNumberOfComponents(); ++component)
+    {
+      double value = values->GetComponent(tupleIndex, component);
+      double expectedValue = expectedValues->GetComponent(tupleIndex, component);
+      if (fabs(value - expectedValue) > tolerance)
+      {
+        std::cerr << "Line " << __LINE__ << ": " << name << " mismatch at tuple " << tupleIndex
+          << " component " << component << ": " << value << " != " << expectedValue << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool CompareCells(vtkCellArray* cells, vtkCellArray* expectedCells)
+{
+  if (cells->GetNumberOfCells() != expectedCells->GetNumberOfCells())
+  {
+    std::cerr << "Line " << __LINE__ << ": number of cells mismatch: "
+      << cells->GetNumberOfCells() << " != " << expectedCells->GetNumberOfCells() << std::endl;
+    return false;
+  }
+  const vtkIdType* pts = nullptr;
+  const vtkIdType* expectedPts = nullptr;
+  vtkIdType npts = 0;
+  vtkIdType expectedNpts = 0;
+  cells->InitTraversal();
+  expectedCells->InitTraversal();
+  for (vtkIdType cellId = 0; cells->GetNextCell(npts, pts) && expectedCells->GetNextCell(expectedNpts, expectedPts); ++cellId)
+  {
+    if (npts != expectedNpts || !std::equal(pts, pts + npts, expectedPts))
+    {
+      std::cerr << "Line " << __LINE__ << ": cell " << cellId << " mismatch" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool CompareWithReference(vtkDiffusionTensorGlyph* glyphFilter, vtkImageData* input, vtkPolyData* source,
+  const char* testName)
+{
+  glyphFilter->Update();
+  vtkPolyData* output = glyphFilter->GetOutput();
+  vtkNew<vtkPolyData> expectedOutput;
+  ComputeReferenceGlyphs(glyphFilter, input, source, expectedOutput);
+  std::cout << testName << ": " << output->GetNumberOfPoints() << " points" << std::endl;
+  if (expectedOutput->GetNumberOfPoints() == 0)
+  {
+    std::cerr << "Line " << __LINE__ << ": " << testName << ": no reference glyphs" << std::endl;
+    return false;
+  }
+  if (!CompareTuples(output->GetPoints()->GetData(), expectedOutput->GetPoints()->GetData(), 1e-5, "points")
+    || !CompareTuples(output->GetPointData()->GetNormals(), expectedOutput->GetPointData()->GetNormals(), 1e-4, "normals")
+    || !CompareTuples(output->GetPointData()->GetScalars(), expectedOutput->GetPointData()->GetScalars(), 1e-5, "scalars")
+    || !CompareCells(output->GetPolys(), expectedOutput->GetPolys()))
+  {
+    std::cerr << "Line " << __LINE__ << ": " << testName << ": output differs from reference implementation" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkDiffusionTensorGlyphTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkImageData> tensorImage;
+  CreateTensorImage(tensorImage);
+
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(6);
+  sphere->SetPhiResolution(5);
+  sphere->Update();
+  vtkPolyData* source = sphere->GetOutput();
+
+  vtkNew<vtkDiffusionTensorGlyph> glyphFilter;
+  glyphFilter->SetInputData(tensorImage);
+  glyphFilter->SetSourceData(source);
+  glyphFilter->SetDimensionResolution(2, 2);
+  glyphFilter->ColorGlyphsByOrientation();
+
+  // Single glyph per tensor
+  if (!CompareWithReference(glyphFilter, tensorImage, source, "Default"))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Only scale is changed: cached eigen-systems are used
+  glyphFilter->SetScaleFactor(500);
+  glyphFilter->ClampScalingOn();
+  glyphFilter->SetMaxScaleFactor(20);
+  if (!CompareWithReference(glyphFilter, tensorImage, source, "ClampScaling"))
+  {
+    return EXIT_FAILURE;
+  }
+  glyphFilter->ClampScalingOff();
+
+  // One glyph per eigenvector, and mirrored glyphs
+  glyphFilter->ThreeGlyphsOn();
+  if (!CompareWithReference(glyphFilter, tensorImage, source, "ThreeGlyphs"))
+  {
+    return EXIT_FAILURE;
+  }
+  glyphFilter->SymmetricOn();
+  if (!CompareWithReference(glyphFilter, tensorImage, source, "ThreeGlyphs Symmetric"))
+  {
+    return EXIT_FAILURE;
+  }
+  glyphFilter->ThreeGlyphsOff();
+  if (!CompareWithReference(glyphFilter, tensorImage, source, "Symmetric"))
+  {
+    return EXIT_FAILURE;
+  }
+  glyphFilter->SymmetricOff();
+
+  // Volume position and tensor rotation (with reflection, which flips normals)
+  vtkNew<vtkTransform> volumePosition;
+  volumePosition->Translate(3.0, -4.0, 12.0);
+  volumePosition->RotateX(30.0);
+  volumePosition->Scale(1.0, 1.2, 0.8);
+  vtkNew<vtkMatrix4x4> volumePositionMatrix;
+  volumePositionMatrix->DeepCopy(volumePosition->GetMatrix());
+  glyphFilter->SetVolumePositionMatrix(volumePositionMatrix);
+  vtkNew<vtkTransform> tensorRotation;
+  tensorRotation->RotateZ(35.0);
+  tensorRotation->RotateY(-20.0);
+  tensorRotation->Scale(-1.0, 1.0, 1.0);
+  vtkNew<vtkMatrix4x4> tensorRotationMatrix;
+  tensorRotationMatrix->DeepCopy(tensorRotation->GetMatrix());
+  glyphFilter->SetTensorRotationMatrix(tensorRotationMatrix);
+  if (!CompareWithReference(glyphFilter, tensorImage, source, "TensorRotationMatrix"))
+  {
+    return EXIT_FAILURE;
+  }
+  glyphFilter->ThreeGlyphsOn();
+  glyphFilter->SymmetricOn();
+  if (!CompareWithReference(glyphFilter, tensorImage, source, "TensorRotationMatrix ThreeGlyphs Symmetric"))
+  {
+    return EXIT_FAILURE;
+  }
+  glyphFilter->ThreeGlyphsOff();
+  glyphFilter->SymmetricOff();
+
+  // Tensor columns are used as eigenvectors
+  glyphFilter->ExtractEigenvaluesOff();
+  glyphFilter->ColorGlyphsByFractionalAnisotropy();
+  if (!CompareWithReference(glyphFilter, tensorImage, source, "ExtractEigenvaluesOff"))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Modified tensors are not taken from the cache
+  glyphFilter->ExtractEigenvaluesOn();
+  glyphFilter->ColorGlyphsByOrientation();
+  glyphFilter->Update();
+  vtkFloatArray* tensors = vtkFloatArray::SafeDownCast(tensorImage->GetPointData()->GetTensors());
+  for (vtkIdType valueIndex = 0; valueIndex < tensors->GetNumberOfValues(); ++valueIndex)
+  {
+    tensors->SetValue(valueIndex, 2.0f * tensors->GetValue(valueIndex));
+  }
+  tensors->Modified();
+  if (!CompareWithReference(glyphFilter, tensorImage, source, "Modified tensors"))
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
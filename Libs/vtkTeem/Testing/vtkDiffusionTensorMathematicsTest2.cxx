@@ -0,0 +1,248 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// vtkTeem includes
+#include <vtkDiffusionTensorMathematics.h>
+
+// VTK includes
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkIntArray.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Create a tensor volume with random orientations and known eigenvalues
+void CreateTensorImage(vtkImageData* tensorImage, int size, std::vector<double>& fractionalAnisotropy)
+{
+  tensorImage->SetDimensions(size, size, size);
+  vtkNew<vtkFloatArray> tensors;
+  tensors->SetNumberOfComponents(9);
+  tensors->SetName("tensors");
+  tensors->SetNumberOfTuples(size * size * size);
+  tensorImage->GetPointData()->SetTensors(tensors);
+
+  vtkMath::RandomSeed(42);
+  fractionalAnisotropy.resize(tensors->GetNumberOfTuples());
+  float* ptr = tensors->GetPointer(0);
+  for (vtkIdType voxelIndex = 0; voxelIndex < tensors->GetNumberOfTuples(); ++voxelIndex, ptr += 9)
+  {
+    // typical diffusivities (mm^2/s), well separated
+    double l[3] = { vtkMath::Random(1.5e-3, 3.0e-3), vtkMath::Random(0.8e-3, 1.4e-3), vtkMath::Random(0.2e-3, 0.7e-3) };
+    double quaternion[4] = { vtkMath::Random(-1.0, 1.0), vtkMath::Random(-1.0, 1.0),
+      vtkMath::Random(-1.0, 1.0), vtkMath::Random(-1.0, 1.0) };
+    double norm = sqrt(quaternion[0] * quaternion[0] + quaternion[1] * quaternion[1]
+      + quaternion[2] * quaternion[2] + quaternion[3] * quaternion[3]);
+    for (int i = 0; i < 4; ++i)
+    {
+      quaternion[i] /= norm;
+    }
+    double rotation[3][3];
+    vtkMath::QuaternionToMatrix3x3(quaternion, rotation);
+    // D = R * diag(l) * R^T
+    for (int i = 0; i < 3; ++i)
+    {
+      for (int j = 0; j < 3; ++j)
+      {
+        double value = 0.0;
+        for (int k = 0; k < 3; ++k)
+        {
+          value += rotation[i][k] * l[k] * rotation[j][k];
+        }
+        ptr[3 * i + j] = static_cast<float>(value);
+      }
+    }
+    fractionalAnisotropy[voxelIndex] = sqrt(0.5)
+      * sqrt((l[0] - l[1]) * (l[0] - l[1]) + (l[1] - l[2]) * (l[1] - l[2]) + (l[2] - l[0]) * (l[2] - l[0]))
+      / sqrt(l[0] * l[0] + l[1] * l[1] + l[2] * l[2]);
+  }
+}
+
+//----------------------------------------------------------------------------
+bool CompareValues(const float* values, const float* expectedValues, vtkIdType numberOfValues,
+  const char* operationName, const char* message)
+{
+  double maxAbsValue = 0.0;
+  for (vtkIdType i = 0; i < numberOfValues; ++i)
+  {
+    maxAbsValue = std::max(maxAbsValue, static_cast<double>(fabs(expectedValues[i])));
+  }
+  const double tolerance = 1e-4 * std::max(maxAbsValue, 1e-12);
+  for (vtkIdType i = 0; i < numberOfValues; ++i)
+  {
+    if (fabs(values[i] - expectedValues[i]) > tolerance)
+    {
+      std::cerr << "Line " << __LINE__ << ": " << message << " mismatch for " << operationName
+        << " at voxel " << i << ": " << values[i] << " != " << expectedValues[i] << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkDiffusionTensorMathematicsTest2(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  const int size = 40;
+  vtkNew<vtkImageData> tensorImage;
+  std::vector<double> expectedFractionalAnisotropy;
+  CreateTensorImage(tensorImage, size, expectedFractionalAnisotropy);
+  const vtkIdType numberOfVoxels = tensorImage->GetNumberOfPoints();
+
+  const int operations[] =
+  {
+    vtkDiffusionTensorMathematics::VTK_TENS_TRACE,
+    vtkDiffusionTensorMathematics::VTK_TENS_DETERMINANT,
+    vtkDiffusionTensorMathematics::VTK_TENS_RELATIVE_ANISOTROPY,
+    vtkDiffusionTensorMathematics::VTK_TENS_FRACTIONAL_ANISOTROPY,
+    vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVALUE,
+    vtkDiffusionTensorMathematics::VTK_TENS_MID_EIGENVALUE,
+    vtkDiffusionTensorMathematics::VTK_TENS_MIN_EIGENVALUE,
+    vtkDiffusionTensorMathematics::VTK_TENS_LINEAR_MEASURE,
+    vtkDiffusionTensorMathematics::VTK_TENS_PLANAR_MEASURE,
+    vtkDiffusionTensorMathematics::VTK_TENS_SPHERICAL_MEASURE,
+    vtkDiffusionTensorMathematics::VTK_TENS_MODE,
+    vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVALUE_PROJX,
+    vtkDiffusionTensorMathematics::VTK_TENS_RAI_MAX_EIGENVEC_PROJZ,
+    vtkDiffusionTensorMathematics::VTK_TENS_PARALLEL_DIFFUSIVITY,
+    vtkDiffusionTensorMathematics::VTK_TENS_PERPENDICULAR_DIFFUSIVITY,
+    vtkDiffusionTensorMathematics::VTK_TENS_MEAN_DIFFUSIVITY
+  };
+  const int numberOfOperations = sizeof(operations) / sizeof(operations[0]);
+
+  // Reference: one filter execution per measure, without eigen-system cache
+  vtkNew<vtkDiffusionTensorMathematics> referenceFilter;
+  referenceFilter->SetInputData(tensorImage);
+  if (referenceFilter->GetCacheEigenSystems())
+  {
+    std::cerr << "Line " << __LINE__ << ": eigen-system cache is expected to be disabled by default" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::vector<std::vector<float> > referenceValues(numberOfOperations);
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (int opIndex = 0; opIndex < numberOfOperations; ++opIndex)
+  {
+    referenceFilter->SetOperation(operations[opIndex]);
+    referenceFilter->Update();
+    float* outPtr = static_cast<float*>(referenceFilter->GetOutput()->GetScalarPointer());
+    referenceValues[opIndex].assign(outPtr, outPtr + numberOfVoxels);
+  }
+  timer->StopTimer();
+  double referenceTime = timer->GetElapsedTime();
+
+  // Check fractional anisotropy against the analytic value
+  for (int opIndex = 0; opIndex < numberOfOperations; ++opIndex)
+  {
+    if (operations[opIndex] != vtkDiffusionTensorMathematics::VTK_TENS_FRACTIONAL_ANISOTROPY)
+    {
+      continue;
+    }
+    for (vtkIdType i = 0; i < numberOfVoxels; ++i)
+    {
+      if (fabs(referenceValues[opIndex][i] - expectedFractionalAnisotropy[i]) > 1e-3)
+      {
+        std::cerr << "Line " << __LINE__ << ": FA mismatch at voxel " << i << ": "
+          << referenceValues[opIndex][i] << " != " << expectedFractionalAnisotropy[i] << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // Filter with eigen-system cache: eigen-systems are computed only in the first execution
+  vtkNew<vtkDiffusionTensorMathematics> cachedFilter;
+  cachedFilter->SetInputData(tensorImage);
+  cachedFilter->CacheEigenSystemsOn();
+  std::vector<std::vector<float> > cachedValues(numberOfOperations);
+  timer->StartTimer();
+  for (int opIndex = 0; opIndex < numberOfOperations; ++opIndex)
+  {
+    cachedFilter->SetOperation(operations[opIndex]);
+    cachedFilter->Update();
+    float* outPtr = static_cast<float*>(cachedFilter->GetOutput()->GetScalarPointer());
+    cachedValues[opIndex].assign(outPtr, outPtr + numberOfVoxels);
+  }
+  timer->StopTimer();
+  double cachedTime = timer->GetElapsedTime();
+  for (int opIndex = 0; opIndex < numberOfOperations; ++opIndex)
+  {
+    if (!CompareValues(cachedValues[opIndex].data(), referenceValues[opIndex].data(), numberOfVoxels,
+      vtkDiffusionTensorMathematics::GetOperationAsString(operations[opIndex]), "cached filter"))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
+  // All measures in one pass
+  vtkNew<vtkIntArray> operationArray;
+  for (int opIndex = 0; opIndex < numberOfOperations; ++opIndex)
+  {
+    operationArray->InsertNextValue(operations[opIndex]);
+  }
+  vtkNew<vtkDiffusionTensorMathematics> batchFilter;
+  vtkNew<vtkImageData> measures;
+  timer->StartTimer();
+  if (!batchFilter->ComputeMeasures(tensorImage, operationArray, measures))
+  {
+    std::cerr << "Line " << __LINE__ << ": ComputeMeasures failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+  timer->StopTimer();
+  double batchTime = timer->GetElapsedTime();
+  for (int opIndex = 0; opIndex < numberOfOperations; ++opIndex)
+  {
+    const char* operationName = vtkDiffusionTensorMathematics::GetOperationAsString(operations[opIndex]);
+    vtkFloatArray* measure = vtkFloatArray::SafeDownCast(measures->GetPointData()->GetArray(operationName));
+    if (!measure || measure->GetNumberOfTuples() != numberOfVoxels)
+    {
+      std::cerr << "Line " << __LINE__ << ": missing measure " << operationName << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (!CompareValues(measure->GetPointer(0), referenceValues[opIndex].data(), numberOfVoxels,
+      operationName, "batch"))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Color operations are not scalar measures
+  vtkNew<vtkIntArray> colorOperationArray;
+  colorOperationArray->InsertNextValue(vtkDiffusionTensorMathematics::VTK_TENS_COLOR_ORIENTATION);
+  std::cout << "Expected error follows:" << std::endl;
+  if (batchFilter->ComputeMeasures(tensorImage, colorOperationArray, measures))
+  {
+    std::cerr << "Line " << __LINE__ << ": ComputeMeasures is expected to fail for color operations" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << numberOfOperations << " measures of " << numberOfVoxels << " tensors:" << std::endl
+    << "  one execution per measure: " << referenceTime << "s" << std::endl
+    << "  one execution per measure, cached eigen-systems: " << cachedTime << "s" << std::endl
+    << "  all measures in one pass: " << batchTime << "s" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -27,7 +27,14 @@
 #include "vtkImageData.h"
 #include "vtkDiffusionTensorMathematics.h"
 
+#include <vtkIdTypeArray.h>
+#include <vtkMatrix4x4.h>
+#include <vtkSMPTools.h>
+#include <vtkWeakPointer.h>
+
+#include <algorithm>
 #include <ctime>
+#include <vector>
 
 vtkCxxSetObjectMacro(vtkDiffusionTensorGlyph,Mask,vtkImageData);
 vtkCxxSetObjectMacro(vtkDiffusionTensorGlyph,VolumePositionMatrix,vtkMatrix4x4);
@@ -35,6 +42,111 @@ vtkCxxSetObjectMacro(vtkDiffusionTensorGlyph,TensorRotationMatrix,vtkMatrix4x4);
 
 vtkStandardNewMacro(vtkDiffusionTensorGlyph);
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Eigenvalues and eigenvectors of a tensor, as used for glyphing.
+// Vectors[i] is the eigenvector that belongs to Values[i].
+struct GlyphEigenSystem
+{
+  double Values[3];
+  double Vectors[3][3];
+};
+
+//----------------------------------------------------------------------------
+// Connectivity of the source cells of one type (verts, lines, polys, or strips),
+// used as a template for generating the cells of all the glyphs.
+struct GlyphCellTemplate
+{
+  std::vector<vtkIdType> Offsets;
+  std::vector<vtkIdType> Connectivity;
+
+  void Initialize(vtkCellArray* sourceCells)
+  {
+    this->Offsets.assign(1, 0);
+    this->Connectivity.clear();
+    vtkIdType npts = 0;
+    const vtkIdType* pts = nullptr;
+    for (sourceCells->InitTraversal(); sourceCells->GetNextCell(npts, pts);)
+    {
+      this->Connectivity.insert(this->Connectivity.end(), pts, pts + npts);
+      this->Offsets.push_back(static_cast<vtkIdType>(this->Connectivity.size()));
+    }
+  }
+
+  vtkIdType GetNumberOfCells() const
+  {
+    return static_cast<vtkIdType>(this->Offsets.size()) - 1;
+  }
+
+  vtkIdType GetConnectivitySize() const
+  {
+    return static_cast<vtkIdType>(this->Connectivity.size());
+  }
+};
+
+//----------------------------------------------------------------------------
+// Apply a linear 4x4 transform to a point (same as vtkLinearTransform::TransformPoint)
+void TransformPoint(const double m[16], const double in[3], double out[3])
+{
+  double x = m[0] * in[0] + m[1] * in[1] + m[2] * in[2] + m[3];
+  double y = m[4] * in[0] + m[5] * in[1] + m[6] * in[2] + m[7];
+  double z = m[8] * in[0] + m[9] * in[1] + m[10] * in[2] + m[11];
+  out[0] = x;
+  out[1] = y;
+  out[2] = z;
+}
+
+//----------------------------------------------------------------------------
+// Append a transform, the same way as vtkTransform::Concatenate does in PreMultiply mode
+void PreMultiply(double m[16], const double op[16])
+{
+  double result[16];
+  vtkMatrix4x4::Multiply4x4(m, op, result);
+  std::copy(result, result + 16, m);
+}
+
+//----------------------------------------------------------------------------
+void PreMultiplyScale(double m[16], double sx, double sy, double sz)
+{
+  double op[16] = { sx, 0, 0, 0,  0, sy, 0, 0,  0, 0, sz, 0,  0, 0, 0, 1 };
+  PreMultiply(m, op);
+}
+
+//----------------------------------------------------------------------------
+void PreMultiplyTranslate(double m[16], double tx, double ty, double tz)
+{
+  double op[16] = { 1, 0, 0, tx,  0, 1, 0, ty,  0, 0, 1, tz,  0, 0, 0, 1 };
+  PreMultiply(m, op);
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+class vtkDiffusionTensorGlyph::vtkInternal
+{
+public:
+  /// Eigen-systems computed in the last execution.
+  /// They are reused if the glyphs are regenerated from the same tensors
+  /// (e.g., only the scale factor or coloring was changed).
+  vtkWeakPointer<vtkDataArray> CachedTensors;
+  vtkMTimeType CachedTensorsMTime = 0;
+  int CachedExtractEigenvalues = -1;
+  /// Sorted list of input point IDs and corresponding eigen-systems
+  std::vector<vtkIdType> CachedPointIds;
+  std::vector<GlyphEigenSystem> CachedEigenSystems;
+
+  void ClearCache()
+  {
+    this->CachedTensors = nullptr;
+    this->CachedTensorsMTime = 0;
+    this->CachedExtractEigenvalues = -1;
+    this->CachedPointIds.clear();
+    this->CachedEigenSystems.clear();
+  }
+};
+
 // Construct object with default values for diffusion tensor data.
 vtkDiffusionTensorGlyph::vtkDiffusionTensorGlyph()
 {
@@ -61,6 +173,8 @@ vtkDiffusionTensorGlyph::vtkDiffusionTensorGlyph()
   this->ScaleFactor = 1000;
 
   // TO DO: Use correct scaling by sqrt of eigenvalues for DTI!
+
+  this->Internal = new vtkInternal;
 }
 
 vtkDiffusionTensorGlyph::~vtkDiffusionTensorGlyph()
@@ -80,6 +194,8 @@ vtkDiffusionTensorGlyph::~vtkDiffusionTensorGlyph()
   {
     this->Mask->Delete( );
   }
+
+  delete this->Internal;
 }
 
 void vtkDiffusionTensorGlyph::ColorGlyphsByLinearMeasure() {
@@ -140,6 +256,10 @@ void vtkDiffusionTensorGlyph::ColorGlyphsBy(int invariant) {
 
 // TO DO: make input mask a point data object or scalars
 
+//----------------------------------------------------------------------------
+// Glyph generation is done in two passes. First the input points that will
+// be glyphed are determined, which gives the exact size of the output.
+// Then all output arrays are allocated and the glyphs are generated in parallel.
 int vtkDiffusionTensorGlyph::RequestData(
                                          vtkInformation *vtkNotUsed(request),
                                          vtkInformationVector **inputVector,
@@ -158,83 +278,30 @@ int vtkDiffusionTensorGlyph::RequestData(
   vtkPolyData *output = vtkPolyData::SafeDownCast(
                                                   outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-  vtkDataArray *inTensors;
-  vtkDataArray *inScalars;
-  vtkIdType numPts, numSourcePts, numSourceCells, inPtId, i;
-  int j;
-  vtkPoints *sourcePts;
-  vtkDataArray *sourceNormals;
-  vtkCellArray *sourceCells, *cells;
-  vtkPoints *newPts;
-  vtkFloatArray *newScalars=nullptr;
-  vtkFloatArray *newNormals=nullptr;
-  double x[3], x2[3], s;
-  vtkTransform *trans;
-  vtkCell *cell;
-  vtkIdList *cellPts;
-  int npts;
-  vtkIdType *pts;
-  vtkIdType cellId;
-  vtkIdType subIncr;
-  int numDirs, dir, eigen_dir, symmetric_dir;
-  vtkMatrix4x4 *matrix;
-  double *m[3], w[3], *v[3];
-  double m0[3], m1[3], m2[3];
-  double v0[3], v1[3], v2[3];
-  double xv[3], yv[3], zv[3];
-  double maxScale;
-  vtkPointData *pd, *outPD;
-
-  // Keeps track of the number of points added to the output polydata so far.
-  // this replaces variable ptIncr in superclass vtkTensorGlyph.
-  vtkIdType ptOffset = 0;
-
-  // coordinate systems for DTI
-  vtkTransform *userVolumeTransform = nullptr;
-  // masking of glyphs
-  vtkDataArray *inMask;
   // glyph timing
 #ifndef NDEBUG
   clock_t tStart = clock();
 #endif
 
-  // use simpler 3x3 array, not 9D as in vtkTensorGlyph class
-  double tensor[3][3];
-
   // the number of eigenvectors to glyph * if there are two glyphs per vector
-  numDirs = (this->ThreeGlyphs?3:1)*(this->Symmetric+1);
-
-  pts = new vtkIdType[source->GetMaxCellSize()];
-  trans = vtkTransform::New();
-  matrix = vtkMatrix4x4::New();
-
-  // set up working matrices
-  m[0] = m0; m[1] = m1; m[2] = m2;
-  v[0] = v0; v[1] = v1; v[2] = v2;
+  const int numDirs = (this->ThreeGlyphs?3:1)*(this->Symmetric+1);
 
   vtkDebugMacro(<<"Generating tensor glyphs");
 
-  pd = input->GetPointData();
-  outPD = output->GetPointData();
-  inTensors = pd->GetTensors();
-  inScalars = pd->GetScalars();
-  numPts = input->GetNumberOfPoints();
+  vtkPointData *outPD = output->GetPointData();
+  vtkDataArray *inTensors = input->GetPointData()->GetTensors();
+  vtkDataArray *inScalars = input->GetPointData()->GetScalars();
+  vtkIdType numPts = input->GetNumberOfPoints();
   if ( !inTensors || numPts < 1 )
   {
     vtkErrorMacro(<<"No data to glyph!");
-    trans->Delete();
-    matrix->Delete();
     return 1;
   }
 
   // Compute steps along dimensions
-  // and real number of input points
-  int numInputPts = numPts;
-  int skipRows = 0;
-  int skipCols = this->Resolution;
-  int rowLength = numPts;
-  int row = 0;
-  int col = 0;
+  vtkIdType skipRows = 0;
+  vtkIdType skipCols = this->Resolution;
+  vtkIdType rowLength = numPts;
   // TODO: use UpdateExtent not WholeExtent
   int inWholeExtent[6];
   inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), inWholeExtent);
@@ -247,91 +314,14 @@ int vtkDiffusionTensorGlyph::RequestData(
     skipRows = DimensionResolution[1];
     skipCols = DimensionResolution[0];
     rowLength = dimensions[0];
-    if (skipCols)
-    {
-      numInputPts = (numInputPts+1)/skipCols;
-    }
-    if (skipRows)
-    {
-      numInputPts = (numInputPts+1)/skipRows;
-    }
-  }
-
-  //
-  // Allocate storage for output PolyData
-  //
-  sourcePts = source->GetPoints();
-  numSourcePts = sourcePts->GetNumberOfPoints();
-  numSourceCells = source->GetNumberOfCells();
-
-  newPts = vtkPoints::New();
-  // Allocate as if we will glyph every point
-  // If some are masked/skipped for Resolution this will be fixed later with Squeeze
-  // TO DO allocate less for lower resolution
-  newPts->Allocate(numDirs*numInputPts*numSourcePts);
-
-  // Setting up for calls to PolyData::InsertNextCell()
-  if ( (sourceCells=source->GetVerts())->GetNumberOfCells() > 0 )
-  {
-    cells = vtkCellArray::New();
-    cells->Allocate(numDirs*numInputPts*sourceCells->GetSize());
-    output->SetVerts(cells);
-    cells->Delete();
-  }
-  if ( (sourceCells=this->GetSource()->GetLines())->GetNumberOfCells() > 0 )
-  {
-    cells = vtkCellArray::New();
-    cells->Allocate(numDirs*numInputPts*sourceCells->GetSize());
-    output->SetLines(cells);
-    cells->Delete();
-  }
-  if ( (sourceCells=this->GetSource()->GetPolys())->GetNumberOfCells() > 0 )
-  {
-    cells = vtkCellArray::New();
-    cells->Allocate(numDirs*numInputPts*sourceCells->GetSize());
-    output->SetPolys(cells);
-    cells->Delete();
   }
-  if ( (sourceCells=this->GetSource()->GetStrips())->GetNumberOfCells() > 0 )
+  if (skipCols < 1)
   {
-    cells = vtkCellArray::New();
-    cells->Allocate(numDirs*numInputPts*sourceCells->GetSize());
-    output->SetStrips(cells);
-    cells->Delete();
+    skipCols = 1;
   }
 
-  // Get point data, decide how to allocate scalars
-  pd = this->GetSource()->GetPointData();
-
-  // generate scalars if eigenvalues are chosen or if scalars exist.
-  if (this->ColorGlyphs &&
-      ((this->ColorMode == COLOR_BY_EIGENVALUES) ||
-       (inScalars && (this->ColorMode == COLOR_BY_SCALARS)) ) )
-  {
-    newScalars = vtkFloatArray::New();
-    newScalars->Allocate(numDirs*numInputPts*numSourcePts);
-  }
-  else
-  {
-    // only copy scalar data through
-    // (superclass does this but why? if user has not asked for ColorGlyphs)
-    outPD->CopyAllOff();
-    outPD->CopyScalarsOn();
-    outPD->CopyAllocate(pd,numDirs*numInputPts*numSourcePts);
-  }
-  if ( (sourceNormals = pd->GetNormals()) )
-  {
-    newNormals = vtkFloatArray::New();
-    newNormals->SetNumberOfComponents(3);
-    newNormals->Allocate(numDirs*3*numInputPts*numSourcePts);
-  }
-
-  // Don't copy all topology here as in superclass because
-  // we are not necessarily outputting a glyph for every point.
-
   // Figure out if we are masking some of the glyphs
-  inMask = nullptr;
-
+  vtkDataArray *inMask = nullptr;
   if (this->MaskGlyphs)
   {
     if (this->Mask != nullptr)
@@ -344,28 +334,16 @@ int vtkDiffusionTensorGlyph::RequestData(
     }
   }
 
-  // Figure out if we are transforming output point locations
-  if (this->VolumePositionMatrix)
-  {
-    // user transform to move points
-    userVolumeTransform = vtkTransform::New();
-
-    userVolumeTransform->SetMatrix(this->VolumePositionMatrix);
-    userVolumeTransform->PreMultiply();
-  }
-
-  vtkDebugMacro(<<"Generating tensor glyphs: TRAVERSE POINTS");
-
-  vtkDebugMacro("Scalar coloring (" <<  this->ColorMode << ")  ["<< vtkTensorGlyph::COLOR_BY_EIGENVALUES << "] is evals. Scalar Invariant (" << this->ScalarInvariant << ")") ;
-
   //
-  // Traverse all Input points, transforming glyph in this->Source by tensor,
-  // and outputting it at each point.  (Input points are not all used, only
-  // those not masked and included by this->Resolution.)
+  // First pass: find all input points that will be glyphed.
+  // (Input points are not all used, only those not masked and included
+  // by this->Resolution.)
   //
-  trans->PreMultiply();
-
-  for (inPtId=0; inPtId < numPts; inPtId += skipCols)
+  vtkDebugMacro(<<"Generating tensor glyphs: TRAVERSE POINTS");
+  std::vector<vtkIdType> glyphPointIds;
+  vtkIdType row = 0;
+  vtkIdType col = 0;
+  for (vtkIdType inPtId=0; inPtId < numPts; inPtId += skipCols)
   {
     if (col >= rowLength)
     {
@@ -381,15 +359,15 @@ int vtkDiffusionTensorGlyph::RequestData(
     // progress notification
     if ( ! (inPtId % 10000) )
     {
-      this->UpdateProgress ((double)inPtId/numPts);
-
-      vtkDebugMacro(<<"Generating diffusion tensor glyphs: PROGRESS" << (double)inPtId/numPts);
+      this->UpdateProgress (0.1 * inPtId/numPts);
       if (this->GetAbortExecute())
       {
         break;
       }
     }
 
+    // use simpler 3x3 array, not 9D as in vtkTensorGlyph class
+    double tensor[3][3];
     inTensors->GetTuple(inPtId, (double *)tensor);
 
     // Decide whether this tensor will be glyphed:
@@ -401,70 +379,227 @@ int vtkDiffusionTensorGlyph::RequestData(
     // b) the trace is positive and we are not masking (default).
     if (( ( inMask != nullptr ) && inMask->GetTuple1( inPtId ) ) || ( !this->MaskGlyphs && trace > 0 ))
     {
+      glyphPointIds.push_back(inPtId);
+    }
+  }
+  const vtkIdType numGlyphs = static_cast<vtkIdType>(glyphPointIds.size());
+
+  //
+  // Allocate storage for output PolyData
+  //
+  vtkPoints *sourcePts = source->GetPoints();
+  const vtkIdType numSourcePts = sourcePts->GetNumberOfPoints();
+  const vtkIdType numOutputPts = numGlyphs * numDirs * numSourcePts;
+
+  vtkNew<vtkPoints> newPts;
+  newPts->SetDataTypeToFloat();
+  newPts->SetNumberOfPoints(numOutputPts);
+  float* newPtsPtr = vtkFloatArray::SafeDownCast(newPts->GetData())->GetPointer(0);
+
+  // Each source cell is copied to each glyph and direction.
+  // Cells of each glyph are stored contiguously, in the same order as they were
+  // inserted in earlier versions of this filter: by source cell, then by direction.
+  vtkCellArray* sourceCellArrays[4] = { source->GetVerts(), source->GetLines(), source->GetPolys(), source->GetStrips() };
+  GlyphCellTemplate cellTemplates[4];
+  vtkSmartPointer<vtkIdTypeArray> outputOffsets[4];
+  vtkSmartPointer<vtkIdTypeArray> outputConnectivity[4];
+  for (int cellType = 0; cellType < 4; ++cellType)
+  {
+    if (sourceCellArrays[cellType]->GetNumberOfCells() == 0)
+    {
+      continue;
+    }
+    cellTemplates[cellType].Initialize(sourceCellArrays[cellType]);
+    outputOffsets[cellType] = vtkSmartPointer<vtkIdTypeArray>::New();
+    outputOffsets[cellType]->SetNumberOfValues(numGlyphs * numDirs * cellTemplates[cellType].GetNumberOfCells() + 1);
+    outputOffsets[cellType]->SetValue(0, 0);
+    outputConnectivity[cellType] = vtkSmartPointer<vtkIdTypeArray>::New();
+    outputConnectivity[cellType]->SetNumberOfValues(numGlyphs * numDirs * cellTemplates[cellType].GetConnectivitySize());
+  }
+
+  // Get point data, decide how to allocate scalars
+  vtkPointData *pd = source->GetPointData();
+
+  // generate scalars if eigenvalues are chosen or if scalars exist.
+  vtkSmartPointer<vtkFloatArray> newScalars;
+  if (this->ColorGlyphs &&
+      ((this->ColorMode == COLOR_BY_EIGENVALUES) ||
+       (inScalars && (this->ColorMode == COLOR_BY_SCALARS)) ) )
+  {
+    newScalars = vtkSmartPointer<vtkFloatArray>::New();
+    newScalars->SetNumberOfTuples(numOutputPts);
+  }
+  else
+  {
+    // only copy scalar data through
+    // (superclass does this but why? if user has not asked for ColorGlyphs)
+    outPD->CopyAllOff();
+    outPD->CopyScalarsOn();
+    outPD->CopyAllocate(pd,numOutputPts);
+  }
+  vtkDataArray *sourceNormals = pd->GetNormals();
+  vtkSmartPointer<vtkFloatArray> newNormals;
+  if ( sourceNormals )
+  {
+    newNormals = vtkSmartPointer<vtkFloatArray>::New();
+    newNormals->SetNumberOfComponents(3);
+    newNormals->SetNumberOfTuples(numOutputPts);
+  }
+
+  // Source geometry is copied so that it can be accessed from multiple threads
+  std::vector<double> sourcePoints(3 * numSourcePts);
+  std::vector<double> sourceNormalVectors(sourceNormals ? 3 * numSourcePts : 0);
+  for (vtkIdType i = 0; i < numSourcePts; i++)
+  {
+    sourcePts->GetPoint(i, &sourcePoints[3 * i]);
+    if ( sourceNormals )
+    {
+      sourceNormals->GetTuple(i, &sourceNormalVectors[3 * i]);
+    }
+  }
+
+  // Figure out if we are transforming output point locations
+  // or rotating tensors.
+  bool useVolumePositionMatrix = (this->VolumePositionMatrix != nullptr);
+  double volumePositionMatrix[16];
+  if (useVolumePositionMatrix)
+  {
+    vtkMatrix4x4::DeepCopy(volumePositionMatrix, this->VolumePositionMatrix);
+  }
+  bool useTensorRotationMatrix = (this->TensorRotationMatrix != nullptr);
+  double tensorRotationMatrix[16];
+  bool flipNormals = false;
+  if (useTensorRotationMatrix)
+  {
+    vtkMatrix4x4::DeepCopy(tensorRotationMatrix, this->TensorRotationMatrix);
+    flipNormals = (this->TensorRotationMatrix->Determinant() < 0);
+  }
+
+  // Eigen-systems computed in the previous execution can be reused
+  // if the tensors have not changed since then.
+  if (this->Internal->CachedTensors != inTensors
+    || this->Internal->CachedTensorsMTime != inTensors->GetMTime()
+    || this->Internal->CachedExtractEigenvalues != this->ExtractEigenvalues)
+  {
+    this->Internal->ClearCache();
+  }
+  const std::vector<vtkIdType>& cachedPointIds = this->Internal->CachedPointIds;
+  const std::vector<GlyphEigenSystem>& cachedEigenSystems = this->Internal->CachedEigenSystems;
+  std::vector<GlyphEigenSystem> eigenSystems(numGlyphs);
+
+  // Make sure that input->GetPoint is thread-safe
+  if (numGlyphs > 0)
+  {
+    double x[3];
+    input->GetPoint(glyphPointIds[0], x);
+  }
+
+  vtkDebugMacro("Scalar coloring (" <<  this->ColorMode << ")  ["<< vtkTensorGlyph::COLOR_BY_EIGENVALUES << "] is evals. Scalar Invariant (" << this->ScalarInvariant << ")") ;
+  this->UpdateProgress(0.1);
+
+  //
+  // Second pass: transform the glyph in this->Source by tensor
+  // and output it at each selected input point.
+  //
+  vtkSMPTools::For(0, numGlyphs, [&](vtkIdType beginGlyph, vtkIdType endGlyph)
+  {
+    double tensor[3][3];
+    double x[3], x2[3];
+    double w[3], xv[3], yv[3], zv[3];
+    for (vtkIdType glyphIndex = beginGlyph; glyphIndex < endGlyph; ++glyphIndex)
+    {
+      const vtkIdType inPtId = glyphPointIds[glyphIndex];
+      const vtkIdType ptOffset = glyphIndex * numDirs * numSourcePts;
+
       // copy topology of output glyph for this point
-      for (cellId=0; cellId < numSourceCells; cellId++)
+      for (int cellType = 0; cellType < 4; ++cellType)
       {
-        cell = this->GetSource()->GetCell(cellId);
-        cellPts = cell->GetPointIds();
-        npts = cellPts->GetNumberOfIds();
-        for (dir=0; dir < numDirs; dir++)
+        const GlyphCellTemplate& cellTemplate = cellTemplates[cellType];
+        if (!outputOffsets[cellType])
         {
-          // This variable may be removed, but that
-          // will not improve readability
-          //subIncr = ptIncr + dir*numSourcePts;
-
-          // Add offset calculated from all non-masked points added to output so far
-          subIncr = ptOffset + dir*numSourcePts;
-
-          for (i=0; i < npts; i++)
+          continue;
+        }
+        vtkIdType* offsets = outputOffsets[cellType]->GetPointer(0);
+        vtkIdType* connectivity = outputConnectivity[cellType]->GetPointer(0);
+        vtkIdType cellIndex = glyphIndex * numDirs * cellTemplate.GetNumberOfCells();
+        vtkIdType connectivityIndex = glyphIndex * numDirs * cellTemplate.GetConnectivitySize();
+        for (vtkIdType cellId = 0; cellId < cellTemplate.GetNumberOfCells(); cellId++)
+        {
+          const vtkIdType* cellPts = &cellTemplate.Connectivity[cellTemplate.Offsets[cellId]];
+          const vtkIdType npts = cellTemplate.Offsets[cellId + 1] - cellTemplate.Offsets[cellId];
+          for (int dir = 0; dir < numDirs; dir++)
           {
-            pts[i] = cellPts->GetId(i) + subIncr;
+            // Add offset calculated from all points added to output before this glyph
+            const vtkIdType subIncr = ptOffset + dir*numSourcePts;
+            for (vtkIdType i = 0; i < npts; i++)
+            {
+              connectivity[connectivityIndex++] = cellPts[i] + subIncr;
+            }
+            offsets[++cellIndex] = connectivityIndex;
           }
-          output->InsertNextCell(cell->GetCellType(),npts,pts);
         }
       }
 
       // compute orientation vectors and scale factors from tensor
-      if ( this->ExtractEigenvalues ) // extract appropriate eigenfunctions
+      GlyphEigenSystem& eigenSystem = eigenSystems[glyphIndex];
+      std::vector<vtkIdType>::const_iterator cachedIt =
+        std::lower_bound(cachedPointIds.begin(), cachedPointIds.end(), inPtId);
+      if (cachedIt != cachedPointIds.end() && *cachedIt == inPtId)
       {
-        for (j=0; j<3; j++)
+        eigenSystem = cachedEigenSystems[cachedIt - cachedPointIds.begin()];
+      }
+      else
+      {
+        inTensors->GetTuple(inPtId, (double *)tensor);
+        if ( this->ExtractEigenvalues ) // extract appropriate eigenfunctions
         {
-          for (i=0; i<3; i++)
+          double m0[3], m1[3], m2[3];
+          double v0[3], v1[3], v2[3];
+          double *m[3] = { m0, m1, m2 };
+          double *v[3] = { v0, v1, v2 };
+          for (int j=0; j<3; j++)
           {
-            // this line from vtkTensorGlyph actually transposes
-            //m[i][j] = tensor[i+3*j];
-            // simpler code with 3x3 array:
-            m[i][j] = tensor[j][i];
+            for (int i=0; i<3; i++)
+            {
+              m[i][j] = tensor[j][i];
+            }
           }
-        }
 
-        //vtkMath::Jacobi(m, w, v);
-        // Use superior eigensolve from teem.
-        vtkDiffusionTensorMathematics::TeemEigenSolver(m,w,v);
+          // Use superior eigensolve from teem.
+          vtkDiffusionTensorMathematics::TeemEigenSolver(m,eigenSystem.Values,v);
 
-        //copy eigenvectors
-        xv[0] = v[0][0]; xv[1] = v[1][0]; xv[2] = v[2][0];
-        yv[0] = v[0][1]; yv[1] = v[1][1]; yv[2] = v[2][1];
-        zv[0] = v[0][2]; zv[1] = v[1][2]; zv[2] = v[2][2];
-      }
-      else //use tensor columns as eigenvectors
-      {
-        for (i=0; i<3; i++)
+          //copy eigenvectors
+          for (int i=0; i<3; i++)
+          {
+            for (int j=0; j<3; j++)
+            {
+              eigenSystem.Vectors[i][j] = v[j][i];
+            }
+          }
+        }
+        else //use tensor columns as eigenvectors
         {
-          //xv[i] = tensor[i]; // from vtkTensorGlyph
-          //yv[i] = tensor[i+3];
-          //zv[i] = tensor[i+6];
-          xv[i] = tensor[0][i]; // with 3x3 matrix
-          yv[i] = tensor[1][i];
-          zv[i] = tensor[2][i];
+          for (int i=0; i<3; i++)
+          {
+            for (int j=0; j<3; j++)
+            {
+              eigenSystem.Vectors[i][j] = tensor[i][j];
+            }
+            eigenSystem.Values[i] = vtkMath::Normalize(eigenSystem.Vectors[i]);
+          }
         }
-        w[0] = vtkMath::Normalize(xv);
-        w[1] = vtkMath::Normalize(yv);
-        w[2] = vtkMath::Normalize(zv);
+      }
+      for (int i=0; i<3; i++)
+      {
+        w[i] = eigenSystem.Values[i];
+        xv[i] = eigenSystem.Vectors[0][i];
+        yv[i] = eigenSystem.Vectors[1][i];
+        zv[i] = eigenSystem.Vectors[2][i];
       }
 
       // Calculate output scalars before computing glyph scale factors from eigenvalues.
       // First, pass through input scalars if requested.
+      double s = 0.0;
       if ( inScalars && this->ColorGlyphs && ( this->ColorMode == vtkTensorGlyph::COLOR_BY_SCALARS ) )
       {
         // Copy point data from source
@@ -505,17 +640,14 @@ int vtkDiffusionTensorGlyph::RequestData(
             break;
           case vtkDiffusionTensorMathematics::VTK_TENS_COLOR_ORIENTATION:
             double v_maj[3];
-            v_maj[0]=v[0][0];
-            v_maj[1]=v[1][0];
-            v_maj[2]=v[2][0];
-            if (this->TensorRotationMatrix)
+            v_maj[0]=xv[0];
+            v_maj[1]=xv[1];
+            v_maj[2]=xv[2];
+            if (useTensorRotationMatrix)
             {
-              vtkNew<vtkTransform> rotate;
-              rotate->SetMatrix(this->TensorRotationMatrix);
-              rotate->TransformPoint(v_maj,v_maj);
+              TransformPoint(tensorRotationMatrix, v_maj, v_maj);
             }
             // TO DO: here output as RGB. Need to allocate 3-component scalars first.
-            s = 0;
             vtkDiffusionTensorMathematics::RGBToIndex(fabs(v_maj[0]),fabs(v_maj[1]),fabs(v_maj[2]),s);
             break;
           case vtkDiffusionTensorMathematics::VTK_TENS_RELATIVE_ANISOTROPY:
@@ -545,9 +677,11 @@ int vtkDiffusionTensorGlyph::RequestData(
       w[1] *= this->ScaleFactor;
       w[2] *= this->ScaleFactor;
 
+      double maxScale;
       if ( this->ClampScaling )
       {
-        for (maxScale=0.0, i=0; i<3; i++)
+        maxScale = 0.0;
+        for (int i=0; i<3; i++)
         {
           if ( maxScale < fabs(w[i]) )
           {
@@ -557,18 +691,17 @@ int vtkDiffusionTensorGlyph::RequestData(
         if ( maxScale > this->MaxScaleFactor )
         {
           maxScale = this->MaxScaleFactor / maxScale;
-          for (i=0; i<3; i++)
+          for (int i=0; i<3; i++)
           {
             w[i] *= maxScale; //preserve overall shape of glyph
           }
         }
       }
 
-      // normalization is postponed
-
       // make sure scale is okay (non-zero) and scale data
       // this scale checking is from superclass code
-      for (maxScale=0.0, i=0; i<3; i++)
+      maxScale = 0.0;
+      for (int i=0; i<3; i++)
       {
         if ( w[i] > maxScale )
         {
@@ -579,7 +712,7 @@ int vtkDiffusionTensorGlyph::RequestData(
       {
         maxScale = 1.0;
       }
-      for (i=0; i<3; i++)
+      for (int i=0; i<3; i++)
       {
         if ( w[i] == 0.0 )
         {
@@ -587,99 +720,86 @@ int vtkDiffusionTensorGlyph::RequestData(
         }
       }
 
-      // Now do the real work for each "direction"
-      // This is a loop over each eigenvector allowing
-      // a separate glyph for each (or two loops per eigenvector
-      // allowing two symmetric glyphs for each)
+      // translate Source to Input point
+      input->GetPoint(inPtId, x);
 
-      int flipNormals = 0;
-      if ( this->TensorRotationMatrix && this->TensorRotationMatrix->Determinant() < 0 )
+      // If we have a user-specified matrix modifying the output point locations
+      if ( useVolumePositionMatrix )
       {
-        flipNormals = 1;
+        TransformPoint(volumePositionMatrix, x, x2);
       }
-
-      for (dir=0; dir < numDirs; dir++)
+      else
       {
-        eigen_dir = dir%(this->ThreeGlyphs?3:1);
-        symmetric_dir = dir/(this->ThreeGlyphs?3:1);
+        x2[0] = x[0];
+        x2[1] = x[1];
+        x2[2] = x[2];
+      }
 
-        // Remove previous scales ...
-        trans->Identity();
+      // Now do the real work for each "direction"
+      // This is a loop over each eigenvector allowing
+      // a separate glyph for each (or two loops per eigenvector
+      // allowing two symmetric glyphs for each)
+      for (int dir=0; dir < numDirs; dir++)
+      {
+        const int eigen_dir = dir%(this->ThreeGlyphs?3:1);
+        const int symmetric_dir = dir/(this->ThreeGlyphs?3:1);
+        const vtkIdType dirOffset = ptOffset + dir*numSourcePts;
 
         // Actually output the scalar invariant calculated above
-        if ( newScalars != nullptr )
-        {
-          for (i=0; i < numSourcePts; i++)
-          {
-            newScalars->InsertTuple(ptOffset+i, &s);
-          }
-        }
-        else
+        if ( newScalars )
         {
-          for (i=0; i < numSourcePts; i++)
-          {
-            // TO DO: why does superclass have this if no scalar output?
-            // in this case it appears copy scalars is on (above in
-            // scalar allocation section).
-            outPD->CopyData(pd,i,ptOffset+i);
-          }
+          float* scalarsPtr = newScalars->GetPointer(dirOffset);
+          std::fill(scalarsPtr, scalarsPtr + numSourcePts, static_cast<float>(s));
         }
 
-        // translate Source to Input point
-        input->GetPoint(inPtId, x);
-
-        // If we have a user-specified matrix modifying the output point locations
-        if ( userVolumeTransform != nullptr )
-        {
-          userVolumeTransform->TransformPoint(x,x2);
-          trans->Translate(x2[0], x2[1], x2[2]);
-        }
-        else
-        {
-          trans->Translate(x[0], x[1], x[2]);
-        }
+        // Compose the glyph transform (same order as vtkTransform in PreMultiply mode)
+        double trans[16];
+        vtkMatrix4x4::Identity(trans);
+        PreMultiplyTranslate(trans, x2[0], x2[1], x2[2]);
 
         // If we have a user-specified matrix rotating each tensor
-        if (this->TensorRotationMatrix)
+        if (useTensorRotationMatrix)
         {
-          trans->Concatenate(this->TensorRotationMatrix);
+          PreMultiply(trans, tensorRotationMatrix);
         }
 
         // normalized eigenvectors rotate object for eigen direction 0
-        matrix->Element[0][0] = xv[0];
-        matrix->Element[0][1] = yv[0];
-        matrix->Element[0][2] = zv[0];
-        matrix->Element[1][0] = xv[1];
-        matrix->Element[1][1] = yv[1];
-        matrix->Element[1][2] = zv[1];
-        matrix->Element[2][0] = xv[2];
-        matrix->Element[2][1] = yv[2];
-        matrix->Element[2][2] = zv[2];
-        trans->Concatenate(matrix);
+        double matrix[16] =
+          {
+          xv[0], yv[0], zv[0], 0,
+          xv[1], yv[1], zv[1], 0,
+          xv[2], yv[2], zv[2], 0,
+          0, 0, 0, 1
+          };
+        PreMultiply(trans, matrix);
 
         if (eigen_dir == 1)
         {
-          trans->RotateZ(90.0);
+          // RotateZ(90.0)
+          double rotate[16] = { 0, -1, 0, 0,  1, 0, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1 };
+          PreMultiply(trans, rotate);
         }
 
         if (eigen_dir == 2)
         {
-          trans->RotateY(-90.0);
+          // RotateY(-90.0)
+          double rotate[16] = { 0, 0, -1, 0,  0, 1, 0, 0,  1, 0, 0, 0,  0, 0, 0, 1 };
+          PreMultiply(trans, rotate);
         }
 
         if (this->ThreeGlyphs)
         {
-          trans->Scale(w[eigen_dir], this->ScaleFactor, this->ScaleFactor);
+          PreMultiplyScale(trans, w[eigen_dir], this->ScaleFactor, this->ScaleFactor);
         }
         else
         {
-          trans->Scale(w[0], w[1], w[2]);
+          PreMultiplyScale(trans, w[0], w[1], w[2]);
         }
 
         // Mirror second set to the symmetric position
         if (symmetric_dir == 1)
         {
-          trans->Scale(-1.,1.,1.);
+          PreMultiplyScale(trans, -1., 1., 1.);
         }
 
         // if the eigenvalue is negative, shift to reverse direction.
@@ -688,67 +808,109 @@ int vtkDiffusionTensorGlyph::RequestData(
         // in case there is an oriented glyph, e.g. an arrow.
         if (w[eigen_dir] < 0 && numDirs > 1)
         {
-          trans->Translate(-this->Length, 0., 0.);
+          PreMultiplyTranslate(trans, -this->Length, 0., 0.);
         }
 
-        // multiply points (and normals if available) by resulting
-        // matrix.
-        // This also appends them to the output "new" data.
-        trans->TransformPoints(sourcePts,newPts);
+        // multiply points (and normals if available) by resulting matrix.
+        double point[3];
+        float* outPoint = newPtsPtr + 3 * dirOffset;
+        for (vtkIdType i = 0; i < numSourcePts; i++, outPoint += 3)
+        {
+          TransformPoint(trans, &sourcePoints[3 * i], point);
+          outPoint[0] = static_cast<float>(point[0]);
+          outPoint[1] = static_cast<float>(point[1]);
+          outPoint[2] = static_cast<float>(point[2]);
+        }
 
-        // Apply the transformation to a series of points,
-        // and append the results to outPts.
+        // Normals are transformed by the inverse transpose of the matrix
+        // (same as vtkLinearTransform::TransformNormals)
         if ( newNormals )
         {
-          if ( flipNormals )
+          double inverseMatrix[16];
+          double normalMatrix[16];
+          vtkMatrix4x4::Invert(trans, inverseMatrix);
+          vtkMatrix4x4::Transpose(inverseMatrix, normalMatrix);
+          float* outNormal = newNormals->GetPointer(3 * dirOffset);
+          for (vtkIdType i = 0; i < numSourcePts; i++, outNormal += 3)
           {
-            trans->Scale(-1.,-1.,-1.);
-            trans->TransformNormals(sourceNormals,newNormals);
-            trans->Scale(-1.,-1.,-1.);
-          }
-          else
-          {
-            trans->TransformNormals(sourceNormals,newNormals);
+            const double* n = &sourceNormalVectors[3 * i];
+            double normal[3] =
+              {
+              normalMatrix[0] * n[0] + normalMatrix[1] * n[1] + normalMatrix[2] * n[2],
+              normalMatrix[4] * n[0] + normalMatrix[5] * n[1] + normalMatrix[6] * n[2],
+              normalMatrix[8] * n[0] + normalMatrix[9] * n[1] + normalMatrix[10] * n[2]
+              };
+            vtkMath::Normalize(normal);
+            if ( flipNormals )
+            {
+              normal[0] = -normal[0];
+              normal[1] = -normal[1];
+              normal[2] = -normal[2];
+            }
+            outNormal[0] = static_cast<float>(normal[0]);
+            outNormal[1] = static_cast<float>(normal[1]);
+            outNormal[2] = static_cast<float>(normal[2]);
           }
         }
-
-        // Keep track of the number of points output so far.
-        ptOffset += numSourcePts;
       } // end for number of dirs
-    } // end if mask is 1 OR trace is ok (so tensor was glyphed)
-  } // end loop over input points
+    } // end loop over glyphs
+  });
+
+  // Copy scalar data of the source through if no scalars are generated
+  if ( !newScalars )
+  {
+    for (vtkIdType glyphIndex = 0; glyphIndex < numGlyphs * numDirs; glyphIndex++)
+    {
+      for (vtkIdType i = 0; i < numSourcePts; i++)
+      {
+        outPD->CopyData(pd, i, glyphIndex * numSourcePts + i);
+      }
+    }
+  }
 
-  vtkDebugMacro(<<"Generated " << numInputPts <<" tensor glyphs");
+  // Store the eigen-systems for the next execution
+  this->Internal->CachedTensors = inTensors;
+  this->Internal->CachedTensorsMTime = inTensors->GetMTime();
+  this->Internal->CachedExtractEigenvalues = this->ExtractEigenvalues;
+  this->Internal->CachedPointIds.swap(glyphPointIds);
+  this->Internal->CachedEigenSystems.swap(eigenSystems);
+
+  vtkDebugMacro(<<"Generated " << numGlyphs <<" tensor glyphs");
 
   //
-  // Update output and release memory
+  // Update output
   //
-  delete [] pts;
-
   output->SetPoints(newPts);
-  newPts->Delete();
+
+  for (int cellType = 0; cellType < 4; ++cellType)
+  {
+    if (!outputOffsets[cellType])
+    {
+      continue;
+    }
+    vtkNew<vtkCellArray> cells;
+    cells->SetData(outputOffsets[cellType], outputConnectivity[cellType]);
+    switch (cellType)
+    {
+      case 0: output->SetVerts(cells); break;
+      case 1: output->SetLines(cells); break;
+      case 2: output->SetPolys(cells); break;
+      default: output->SetStrips(cells); break;
+    }
+  }
 
   if ( newScalars )
   {
     int idx = outPD->AddArray(newScalars);
     outPD->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
-    newScalars->Delete();
   }
 
   if ( newNormals )
   {
     outPD->SetNormals(newNormals);
-    newNormals->Delete();
   }
 
-  output->Squeeze();
-  trans->Delete();
-  matrix->Delete();
-
-  if ( userVolumeTransform )
-  {
-    userVolumeTransform->Delete();
-  }
+  this->UpdateProgress(1.0);
 
   vtkDebugMacro("glyph time: " << clock() - tStart );
 
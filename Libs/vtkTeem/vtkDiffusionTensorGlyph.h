@@ -65,6 +65,14 @@ class vtkMatrix4x4;
 /// functions are scalar invariants of the diffusion tensor.  They are selected
 /// by calling ColorGlyphsByFractionalAnisotropy, etc.
 ///
+/// Glyphs are generated in parallel. Eigenvalues and eigenvectors are kept
+/// between executions and reused while the input tensors are not modified,
+/// therefore changing only display parameters (scale factor, coloring, etc.)
+/// does not require recomputing the eigen-systems.
+/// The cache is only reused for the same tensor array: if the input is a
+/// resliced slice (as in slice views) then a new tensor array is generated
+/// each time the slice is moved and all eigen-systems are computed again.
+///
 /// \sa vtkTensorGlyph
 /// \sa vtkDiffusionTensorMathematics
 /// \sa vtkSuperquadricTensorGlyph
@@ -186,6 +194,9 @@ protected:
 
   vtkImageData *Mask;  /// display glyphs at points where mask is nonzero
 
+  class vtkInternal;
+  vtkInternal* Internal;
+
 private:
   vtkDiffusionTensorGlyph(const vtkDiffusionTensorGlyph&) = delete;
   void operator=(const vtkDiffusionTensorGlyph&) = delete;
@@ -36,8 +36,16 @@ extern "C" {
 #include "teem/ten.h"
 }
 
+#include <vtkFloatArray.h>
+#include <vtkIntArray.h>
+#include <vtkNew.h>
+#include <vtkSMPTools.h>
+#include <vtkWeakPointer.h>
+
+#include <algorithm>
 #include <ctime>
 #include <limits>
+#include <vector>
 
 #define VTK_EPS 1e-16
 #define MAX(a,b) (((a)>(b))?(a):(b))
@@ -52,6 +60,63 @@ vtkCxxSetObjectMacro(vtkDiffusionTensorMathematics,ScalarMask,vtkImageData);
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkDiffusionTensorMathematics);
 
+//----------------------------------------------------------------------------
+class vtkDiffusionTensorMathematics::vtkInternal
+{
+public:
+  /// Make the cache ready for storing eigen-systems of the tensors.
+  /// Previously computed eigen-systems are kept if the tensors have not changed.
+  void Prepare(vtkDataArray* tensors, int extractEigenvalues, bool enabled)
+  {
+    if (!enabled || !tensors)
+    {
+      this->Clear();
+      return;
+    }
+    vtkIdType numberOfTensors = tensors->GetNumberOfTuples();
+    if (this->Tensors == tensors
+      && this->TensorsMTime == tensors->GetMTime()
+      && this->ExtractEigenvalues == extractEigenvalues
+      && static_cast<vtkIdType>(this->EigenSystemsValid.size()) == numberOfTensors)
+    {
+      return;
+    }
+    this->Tensors = tensors;
+    this->TensorsMTime = tensors->GetMTime();
+    this->ExtractEigenvalues = extractEigenvalues;
+    this->EigenSystems.resize(12 * numberOfTensors);
+    this->EigenSystemsValid.assign(numberOfTensors, 0);
+  }
+
+  void Clear()
+  {
+    this->Tensors = nullptr;
+    this->TensorsMTime = 0;
+    this->ExtractEigenvalues = -1;
+    std::vector<double>().swap(this->EigenSystems);
+    std::vector<unsigned char>().swap(this->EigenSystemsValid);
+  }
+
+  double* GetEigenSystems()
+  {
+    return this->EigenSystems.empty() ? nullptr : this->EigenSystems.data();
+  }
+
+  unsigned char* GetEigenSystemsValid()
+  {
+    return this->EigenSystemsValid.empty() ? nullptr : this->EigenSystemsValid.data();
+  }
+
+  vtkWeakPointer<vtkDataArray> Tensors;
+  vtkMTimeType TensorsMTime = 0;
+  int ExtractEigenvalues = -1;
+  /// 12 values per tensor, see vtkDiffusionTensorMathematicsEigenSystem().
+  /// Stored in double precision so that results do not depend on whether
+  /// the eigen-system was computed or taken from the cache.
+  std::vector<double> EigenSystems;
+  std::vector<unsigned char> EigenSystemsValid;
+};
+
 
 //----------------------------------------------------------------------------
 vtkDiffusionTensorMathematics::vtkDiffusionTensorMathematics()
@@ -65,6 +130,8 @@ vtkDiffusionTensorMathematics::vtkDiffusionTensorMathematics()
   this->MaskWithScalars = 0;
   this->FixNegativeEigenvalues = 1;
   this->MaskLabelValue = 1;
+  this->CacheEigenSystems = false;
+  this->Internal = new vtkInternal;
 }
 
 //----------------------------------------------------------------------------
@@ -78,6 +145,7 @@ vtkDiffusionTensorMathematics::vtkDiffusionTensorMathematics()
    {
      this->ScalarMask->Delete();
    }
+   delete this->Internal;
  }
 
 //----------------------------------------------------------------------------
@@ -142,6 +210,18 @@ int vtkDiffusionTensorMathematics
 ::RequestData(vtkInformation* request, vtkInformationVector** inputVector,
               vtkInformationVector* outputVector)
 {
+  // Eigen-systems are shared between the threads, the cache must be ready before they start
+  vtkImageData* inData = vtkImageData::GetData(inputVector[0]);
+  vtkDataArray* inTensors = inData ? inData->GetPointData()->GetTensors() : nullptr;
+  if (!this->CacheEigenSystems)
+  {
+    this->Internal->Clear();
+  }
+  else if (vtkDiffusionTensorMathematics::IsEigenOperation(this->Operation))
+  {
+    this->Internal->Prepare(inTensors, this->ExtractEigenvalues, true);
+  }
+
   int res = this->Superclass::RequestData(request, inputVector, outputVector);
   for (int i = 0; i < this->GetNumberOfOutputPorts(); ++i)
   {
@@ -363,6 +443,154 @@ inline Type tensor_math_clamp(const Type a,
                   const Type b,
                   const Type c) { return (a) > (b) ? ((a) < (c) ? (a) : (c)) : (b) ; }
 
+//----------------------------------------------------------------------------
+// Compute eigenvalues (w) and eigenvectors (v) of a tensor.
+// If a cache entry is provided, then the eigen-system is read from it if it
+// was computed already, otherwise the computed eigen-system is stored in it.
+// Cache entries contain 12 values: w[0..2] then v[0][0..2], v[1][0..2], v[2][0..2].
+static void vtkDiffusionTensorMathematicsEigenSystem(double tensor[3][3], int extractEigenvalues,
+  double w[3], double **v, double* cachedEigenSystem, unsigned char* cachedEigenSystemValid)
+{
+  if (cachedEigenSystem && *cachedEigenSystemValid)
+  {
+    for (int i=0; i<3; i++)
+    {
+      w[i] = cachedEigenSystem[i];
+      for (int j=0; j<3; j++)
+      {
+        v[i][j] = cachedEigenSystem[3 + 3*i + j];
+      }
+    }
+    return;
+  }
+
+  if (extractEigenvalues)
+  {
+    double m0[3], m1[3], m2[3];
+    double *m[3] = { m0, m1, m2 };
+    for (int j=0; j<3; j++)
+    {
+      for (int i=0; i<3; i++)
+      {
+        // transpose
+        m[i][j] = tensor[j][i];
+      }
+    }
+    // compute eigensystem
+    //vtkMath::Jacobi(m, w, v);
+    vtkDiffusionTensorMathematics::TeemEigenSolver(m,w,v);
+  }
+  else
+  {
+    // tensor columns are evectors scaled by evals
+    for (int i=0; i<3; i++)
+    {
+      v[0][i] = tensor[i][0];
+      v[1][i] = tensor[i][1];
+      v[2][i] = tensor[i][2];
+    }
+    w[0] = vtkMath::Normalize(v[0]);
+    w[1] = vtkMath::Normalize(v[1]);
+    w[2] = vtkMath::Normalize(v[2]);
+  }
+
+  if (cachedEigenSystem)
+  {
+    for (int i=0; i<3; i++)
+    {
+      cachedEigenSystem[i] = w[i];
+      for (int j=0; j<3; j++)
+      {
+        cachedEigenSystem[3 + 3*i + j] = v[i][j];
+      }
+    }
+    *cachedEigenSystemValid = 1;
+  }
+}
+
+//----------------------------------------------------------------------------
+static void vtkDiffusionTensorMathematicsFixNegativeEigenvalues(int fixNegativeEigenvalues, double w[3])
+{
+  //Correct for negative eigenvalues. Three possible options:
+  //  1. Round to zero
+  //  2. Take absolute value
+  //  3. Increase eigenvalues by negative part
+  // The two first options have been problematic. Try 3
+  if (fixNegativeEigenvalues==1){
+    const double min_eval = MIN3(w[0], w[1], w[2]);
+    if (min_eval < 0)
+    {
+        const double add_to_eval = -min_eval + VTK_EPS;
+        w[0] += add_to_eval;
+        w[1] += add_to_eval;
+        w[2] += add_to_eval;
+    }
+    if ((w[0] < 0) || (w[1] < 0) || (w[2] < 0))
+      vtkGenericWarningMacro( "Warning: Negative Eigenvalues after positivity fix" );
+  } else {
+    if (w[0] < 0)
+      w[0] = 0;
+    if (w[1] < 0)
+      w[1] = 0;
+    if (w[2] < 0)
+      w[2] = 0;
+  }
+}
+
+//----------------------------------------------------------------------------
+// Scalar measures that are computed from the eigen-system.
+// Color operations are not handled here.
+static double vtkDiffusionTensorMathematicsEigenMeasure(int op, double w[3], double **v)
+{
+  switch (op)
+  {
+  case vtkDiffusionTensorMathematics::VTK_TENS_RELATIVE_ANISOTROPY:
+    return vtkDiffusionTensorMathematics::RelativeAnisotropy(w);
+  case vtkDiffusionTensorMathematics::VTK_TENS_FRACTIONAL_ANISOTROPY:
+    return vtkDiffusionTensorMathematics::FractionalAnisotropy(w);
+  case vtkDiffusionTensorMathematics::VTK_TENS_LINEAR_MEASURE:
+    return vtkDiffusionTensorMathematics::LinearMeasure(w);
+  case vtkDiffusionTensorMathematics::VTK_TENS_PLANAR_MEASURE:
+    return vtkDiffusionTensorMathematics::PlanarMeasure(w);
+  case vtkDiffusionTensorMathematics::VTK_TENS_SPHERICAL_MEASURE:
+    return vtkDiffusionTensorMathematics::SphericalMeasure(w);
+  case vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVALUE:
+    return w[0];
+  case vtkDiffusionTensorMathematics::VTK_TENS_MID_EIGENVALUE:
+    return w[1];
+  case vtkDiffusionTensorMathematics::VTK_TENS_MIN_EIGENVALUE:
+    return w[2];
+  case vtkDiffusionTensorMathematics::VTK_TENS_PARALLEL_DIFFUSIVITY:
+    return vtkDiffusionTensorMathematics::ParallelDiffusivity(w);
+  case vtkDiffusionTensorMathematics::VTK_TENS_PERPENDICULAR_DIFFUSIVITY:
+    return vtkDiffusionTensorMathematics::PerpendicularDiffusivity(w);
+  case vtkDiffusionTensorMathematics::VTK_TENS_MEAN_DIFFUSIVITY:
+    return vtkDiffusionTensorMathematics::MeanDiffusivity(w);
+  case vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVALUE_PROJX:
+    return vtkDiffusionTensorMathematics::MaxEigenvalueProjectionX(v,w);
+  case vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVALUE_PROJY:
+    return vtkDiffusionTensorMathematics::MaxEigenvalueProjectionY(v,w);
+  case vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVALUE_PROJZ:
+    return vtkDiffusionTensorMathematics::MaxEigenvalueProjectionZ(v,w);
+  case vtkDiffusionTensorMathematics::VTK_TENS_RAI_MAX_EIGENVEC_PROJX:
+    return vtkDiffusionTensorMathematics::RAIMaxEigenvecX(v,w);
+  case vtkDiffusionTensorMathematics::VTK_TENS_RAI_MAX_EIGENVEC_PROJY:
+    return vtkDiffusionTensorMathematics::RAIMaxEigenvecY(v,w);
+  case vtkDiffusionTensorMathematics::VTK_TENS_RAI_MAX_EIGENVEC_PROJZ:
+    return vtkDiffusionTensorMathematics::RAIMaxEigenvecZ(v,w);
+  case vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVEC_PROJX:
+    return vtkDiffusionTensorMathematics::MaxEigenvecX(v,w);
+  case vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVEC_PROJY:
+    return vtkDiffusionTensorMathematics::MaxEigenvecY(v,w);
+  case vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVEC_PROJZ:
+    return vtkDiffusionTensorMathematics::MaxEigenvecZ(v,w);
+  case vtkDiffusionTensorMathematics::VTK_TENS_MODE:
+    return vtkDiffusionTensorMathematics::Mode(w);
+  default:
+    return 0.0;
+  }
+}
+
 //----------------------------------------------------------------------------
 // This templated function executes the filter for any type of data.
 // Handles the one input operations.
@@ -372,7 +600,8 @@ static void vtkDiffusionTensorMathematicsExecute1Eigen(vtkDiffusionTensorMathema
                           vtkImageData *in1Data,
                           vtkImageData *outData,
                           T *outPtr,
-                          int outExt[6], int id)
+                          int outExt[6], int id,
+                          double* eigenCache, unsigned char* eigenCacheValid)
 {
   // image variables
   int idxR, idxY, idxZ;
@@ -396,13 +625,10 @@ static void vtkDiffusionTensorMathematicsExecute1Eigen(vtkDiffusionTensorMathema
   tStart = clock();
 #endif
   // working matrices
-  double *m[3], w[3], *v[3];
-  double m0[3], m1[3], m2[3];
+  double w[3], *v[3];
   double v0[3], v1[3], v2[3];
   double v_maj[3];
-  m[0] = m0; m[1] = m1; m[2] = m2;
   v[0] = v0; v[1] = v1; v[2] = v2;
-  int i, j;
   double r, g, b;
   int extractEigenvalues;
   double cl;
@@ -447,6 +673,8 @@ static void vtkDiffusionTensorMathematicsExecute1Eigen(vtkDiffusionTensorMathema
   // unsigned char RGBA depending on the Operation selected.
   // See RequestInformation above.
   float* inPtr = reinterpret_cast<float*>(in1Data->GetArrayPointerForExtent(inTensors, outExt));
+  // first tensor of the image, for finding the voxel index in the eigen-system cache
+  const float* tensorBasePtr = reinterpret_cast<float*>(inTensors->GetVoidPointer(0));
 
   // decide whether to extract eigenfunctions or just use input cols
   extractEigenvalues = self->GetExtractEigenvalues();
@@ -523,149 +751,16 @@ static void vtkDiffusionTensorMathematicsExecute1Eigen(vtkDiffusionTensorMathema
           tensor[2][2] = static_cast<double>(inPtr[8]);
 
           // get eigenvalues and eigenvectors appropriately
-          if (extractEigenvalues)
-          {
-            for (j=0; j<3; j++)
-            {
-              for (i=0; i<3; i++)
-              {
-                // transpose
-                m[i][j] = tensor[j][i];
-              }
-            }
-            // compute eigensystem
-            //vtkMath::Jacobi(m, w, v);
-            vtkDiffusionTensorMathematics::TeemEigenSolver(m,w,v);
-          }
-          else
-          {
-            // tensor columns are evectors scaled by evals
-            for (i=0; i<3; i++)
-            {
-              v0[i] = tensor[i][0];
-              v1[i] = tensor[i][1];
-              v2[i] = tensor[i][2];
-            }
-            w[0] = vtkMath::Normalize(v0);
-            w[1] = vtkMath::Normalize(v1);
-            w[2] = vtkMath::Normalize(v2);
-          }
+          vtkIdType voxelIndex = static_cast<vtkIdType>(inPtr - tensorBasePtr) / 9;
+          vtkDiffusionTensorMathematicsEigenSystem(tensor, extractEigenvalues, w, v,
+            eigenCache ? eigenCache + 12 * voxelIndex : nullptr,
+            eigenCacheValid ? eigenCacheValid + voxelIndex : nullptr);
 
-          //Correct for negative eigenvalues. Three possible options:
-          //  1. Round to zero
-          //  2. Take absolute value
-          //  3. Increase eigenvalues by negative part
-          // The two first options have been problematic. Try 3
-          if (self->GetFixNegativeEigenvalues()==1){
-            const double min_eval = MIN3(w[0], w[1], w[2]);
-            if (min_eval < 0)
-            {
-                const double add_to_eval = -min_eval + VTK_EPS;
-                w[0] += add_to_eval;
-                w[1] += add_to_eval;
-                w[2] += add_to_eval;
-            }
-//            if (vtkDiffusionTensorMathematics::FixNegativeEigenvaluesMethod(w)) {
-//              vtkGenericWarningMacro( "Warning: Eigenvalues are not properly sorted" );
-//            }
-            if ((w[0] < 0) || (w[1] < 0) || (w[2] < 0))
-              vtkGenericWarningMacro( "Warning: Negative Eigenvalues after positivity fix" );
-          } else {
-            if (w[0] < 0)
-              w[0] = 0;
-            if (w[1] < 0)
-              w[1] = 0;
-            if (w[2] < 0)
-              w[2] = 0;
-          }
+          vtkDiffusionTensorMathematicsFixNegativeEigenvalues(self->GetFixNegativeEigenvalues(), w);
 
           // pixel operation
           switch (op)
           {
-          case vtkDiffusionTensorMathematics::VTK_TENS_RELATIVE_ANISOTROPY:
-            *outPtr = static_cast<T> (vtkDiffusionTensorMathematics::RelativeAnisotropy(w));
-            break;
-          case vtkDiffusionTensorMathematics::VTK_TENS_FRACTIONAL_ANISOTROPY:
-            *outPtr = static_cast<T> (vtkDiffusionTensorMathematics::FractionalAnisotropy(w));
-            break;
-
-          case vtkDiffusionTensorMathematics::VTK_TENS_LINEAR_MEASURE:
-            *outPtr = static_cast<T> (vtkDiffusionTensorMathematics::LinearMeasure(w));
-            break;
-
-          case vtkDiffusionTensorMathematics::VTK_TENS_PLANAR_MEASURE:
-            *outPtr = static_cast<T> (vtkDiffusionTensorMathematics::PlanarMeasure(w));
-            break;
-
-          case vtkDiffusionTensorMathematics::VTK_TENS_SPHERICAL_MEASURE:
-            *outPtr = static_cast<T> (vtkDiffusionTensorMathematics::SphericalMeasure(w));
-            break;
-
-          case vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVALUE:
-            *outPtr = (T)w[0];
-            break;
-
-          case vtkDiffusionTensorMathematics::VTK_TENS_MID_EIGENVALUE:
-            *outPtr = (T)w[1];
-            break;
-
-          case vtkDiffusionTensorMathematics::VTK_TENS_MIN_EIGENVALUE:
-            *outPtr = (T)w[2];
-            break;
-
-          case vtkDiffusionTensorMathematics::VTK_TENS_PARALLEL_DIFFUSIVITY:
-            *outPtr = static_cast<T> (vtkDiffusionTensorMathematics::ParallelDiffusivity(w));
-            break;
-
-          case vtkDiffusionTensorMathematics::VTK_TENS_PERPENDICULAR_DIFFUSIVITY:
-            *outPtr = static_cast<T> (vtkDiffusionTensorMathematics::PerpendicularDiffusivity(w));
-            break;
-
-          case vtkDiffusionTensorMathematics::VTK_TENS_MEAN_DIFFUSIVITY:
-            *outPtr = static_cast<T> (vtkDiffusionTensorMathematics::MeanDiffusivity(w));
-            break;
-
-          case vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVALUE_PROJX:
-            *outPtr = static_cast<T> (vtkDiffusionTensorMathematics::MaxEigenvalueProjectionX(v,w));
-            break;
-
-          case vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVALUE_PROJY:
-            *outPtr = static_cast<T> (vtkDiffusionTensorMathematics::MaxEigenvalueProjectionY(v,w));
-            break;
-
-          case vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVALUE_PROJZ:
-            *outPtr = static_cast<T> (vtkDiffusionTensorMathematics::MaxEigenvalueProjectionZ(v,w));
-            break;
-
-      case vtkDiffusionTensorMathematics::VTK_TENS_RAI_MAX_EIGENVEC_PROJX:
-        *outPtr = static_cast<T> (vtkDiffusionTensorMathematics::RAIMaxEigenvecX(v,w));
-        break;
-
-      case vtkDiffusionTensorMathematics::VTK_TENS_RAI_MAX_EIGENVEC_PROJY:
-        *outPtr = static_cast<T> (vtkDiffusionTensorMathematics::RAIMaxEigenvecY(v,w));
-        break;
-
-      case vtkDiffusionTensorMathematics::VTK_TENS_RAI_MAX_EIGENVEC_PROJZ:
-        *outPtr = static_cast<T> (vtkDiffusionTensorMathematics::RAIMaxEigenvecZ(v,w));
-        break;
-
-      case vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVEC_PROJX:
-        *outPtr = static_cast<T> (vtkDiffusionTensorMathematics::MaxEigenvecX(v,w));
-        break;
-
-      case vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVEC_PROJY:
-        *outPtr = static_cast<T> (vtkDiffusionTensorMathematics::MaxEigenvecY(v,w));
-        break;
-
-      case vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVEC_PROJZ:
-        *outPtr = static_cast<T> (vtkDiffusionTensorMathematics::MaxEigenvecZ(v,w));
-        break;
-
-
-      case vtkDiffusionTensorMathematics::VTK_TENS_MODE:
-            *outPtr = static_cast<T> (vtkDiffusionTensorMathematics::Mode(w));
-            break;
-
           case vtkDiffusionTensorMathematics::VTK_TENS_COLOR_MODE:
 
             vtkDiffusionTensorMathematics::ColorByMode(w,r,g,b);
@@ -767,7 +862,9 @@ static void vtkDiffusionTensorMathematicsExecute1Eigen(vtkDiffusionTensorMathema
 
             break;
 
-
+          default:
+            *outPtr = static_cast<T> (vtkDiffusionTensorMathematicsEigenMeasure(op, w, v));
+            break;
           }
 
           // scale double if the user requested this
@@ -902,7 +999,8 @@ void vtkDiffusionTensorMathematics::ThreadedRequestData(
       {
         vtkTemplateMacro(vtkDiffusionTensorMathematicsExecute1Eigen(
                 this,inData[0][0], outData[0],
-                static_cast<VTK_TT*>(outPtr), outExt, id));
+                static_cast<VTK_TT*>(outPtr), outExt, id,
+                this->Internal->GetEigenSystems(), this->Internal->GetEigenSystemsValid()));
         default:
         vtkErrorMacro(<< "Execute: Unknown ScalarType");
         return;
@@ -1152,6 +1250,219 @@ void vtkDiffusionTensorMathematics::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os,indent);
 
   os << indent << "Operation: " << this->Operation << "\n";
+  os << indent << "CacheEigenSystems: " << (this->CacheEigenSystems ? "On" : "Off") << "\n";
+}
+
+//----------------------------------------------------------------------------
+bool vtkDiffusionTensorMathematics::IsEigenOperation(int operation)
+{
+  switch (operation)
+  {
+    case VTK_TENS_TRACE:
+    case VTK_TENS_DETERMINANT:
+    case VTK_TENS_D11:
+    case VTK_TENS_D22:
+    case VTK_TENS_D33:
+      return false;
+    default:
+      return true;
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkDiffusionTensorMathematics::IsColorOperation(int operation)
+{
+  return operation == VTK_TENS_COLOR_ORIENTATION
+    || operation == VTK_TENS_COLOR_MODE
+    || operation == VTK_TENS_COLOR_ORIENTATION_MIDDLE_EIGENVECTOR
+    || operation == VTK_TENS_COLOR_ORIENTATION_MIN_EIGENVECTOR;
+}
+
+//----------------------------------------------------------------------------
+const char* vtkDiffusionTensorMathematics::GetOperationAsString(int operation)
+{
+  switch (operation)
+  {
+    case VTK_TENS_TRACE: return "Trace";
+    case VTK_TENS_DETERMINANT: return "Determinant";
+    case VTK_TENS_RELATIVE_ANISOTROPY: return "RelativeAnisotropy";
+    case VTK_TENS_FRACTIONAL_ANISOTROPY: return "FractionalAnisotropy";
+    case VTK_TENS_MAX_EIGENVALUE: return "MaxEigenvalue";
+    case VTK_TENS_MID_EIGENVALUE: return "MidEigenvalue";
+    case VTK_TENS_MIN_EIGENVALUE: return "MinEigenvalue";
+    case VTK_TENS_LINEAR_MEASURE: return "LinearMeasure";
+    case VTK_TENS_PLANAR_MEASURE: return "PlanarMeasure";
+    case VTK_TENS_SPHERICAL_MEASURE: return "SphericalMeasure";
+    case VTK_TENS_COLOR_ORIENTATION: return "ColorOrientation";
+    case VTK_TENS_D11: return "D11";
+    case VTK_TENS_D22: return "D22";
+    case VTK_TENS_D33: return "D33";
+    case VTK_TENS_MODE: return "Mode";
+    case VTK_TENS_COLOR_MODE: return "ColorMode";
+    case VTK_TENS_MAX_EIGENVALUE_PROJX: return "MaxEigenvalueProjectionX";
+    case VTK_TENS_MAX_EIGENVALUE_PROJY: return "MaxEigenvalueProjectionY";
+    case VTK_TENS_MAX_EIGENVALUE_PROJZ: return "MaxEigenvalueProjectionZ";
+    case VTK_TENS_RAI_MAX_EIGENVEC_PROJX: return "RAIMaxEigenvecX";
+    case VTK_TENS_RAI_MAX_EIGENVEC_PROJY: return "RAIMaxEigenvecY";
+    case VTK_TENS_RAI_MAX_EIGENVEC_PROJZ: return "RAIMaxEigenvecZ";
+    case VTK_TENS_MAX_EIGENVEC_PROJX: return "MaxEigenvecX";
+    case VTK_TENS_MAX_EIGENVEC_PROJY: return "MaxEigenvecY";
+    case VTK_TENS_MAX_EIGENVEC_PROJZ: return "MaxEigenvecZ";
+    case VTK_TENS_PARALLEL_DIFFUSIVITY: return "ParallelDiffusivity";
+    case VTK_TENS_PERPENDICULAR_DIFFUSIVITY: return "PerpendicularDiffusivity";
+    case VTK_TENS_COLOR_ORIENTATION_MIDDLE_EIGENVECTOR: return "ColorOrientationMiddleEigenvector";
+    case VTK_TENS_COLOR_ORIENTATION_MIN_EIGENVECTOR: return "ColorOrientationMinEigenvector";
+    case VTK_TENS_MEAN_DIFFUSIVITY: return "MeanDiffusivity";
+    default: return "";
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkDiffusionTensorMathematics::ComputeMeasures(vtkImageData* tensorImage,
+  vtkIntArray* operations, vtkImageData* output)
+{
+  if (!tensorImage || !operations || !output)
+  {
+    vtkErrorMacro("ComputeMeasures: invalid input");
+    return false;
+  }
+  vtkDataArray* inTensors = tensorImage->GetPointData()->GetTensors();
+  if (!inTensors || inTensors->GetDataType() != VTK_FLOAT || inTensors->GetNumberOfComponents() != 9)
+  {
+    vtkErrorMacro("ComputeMeasures: input must have float tensors with 9 components");
+    return false;
+  }
+  const int numberOfOperations = static_cast<int>(operations->GetNumberOfValues());
+  std::vector<int> ops(numberOfOperations);
+  bool computeEigenSystems = false;
+  for (int opIndex = 0; opIndex < numberOfOperations; ++opIndex)
+  {
+    ops[opIndex] = operations->GetValue(opIndex);
+    if (ops[opIndex] < VTK_TENS_TRACE || ops[opIndex] > VTK_TENS_MEAN_DIFFUSIVITY
+      || vtkDiffusionTensorMathematics::IsColorOperation(ops[opIndex]))
+    {
+      vtkErrorMacro("ComputeMeasures: operation " << ops[opIndex] << " is not a scalar measure");
+      return false;
+    }
+    computeEigenSystems |= vtkDiffusionTensorMathematics::IsEigenOperation(ops[opIndex]);
+  }
+
+  // Mask is used the same way as in the filter, but it must have the same extent as the tensors
+  const short* maskPtr = nullptr;
+  if (this->MaskWithScalars && this->ScalarMask && this->ScalarMask->GetPointData()->GetScalars())
+  {
+    int* tensorExtent = tensorImage->GetExtent();
+    int* maskExtent = this->ScalarMask->GetExtent();
+    if (this->ScalarMask->GetScalarType() != VTK_SHORT
+      || !std::equal(tensorExtent, tensorExtent + 6, maskExtent))
+    {
+      vtkErrorMacro("ComputeMeasures: scalar mask must be short and must have the same extent as the tensors");
+      return false;
+    }
+    maskPtr = static_cast<short*>(this->ScalarMask->GetScalarPointer());
+  }
+
+  const vtkIdType numberOfVoxels = tensorImage->GetNumberOfPoints();
+  output->CopyStructure(tensorImage);
+  output->GetPointData()->Initialize();
+  std::vector<float*> outPtrs(numberOfOperations);
+  for (int opIndex = 0; opIndex < numberOfOperations; ++opIndex)
+  {
+    vtkNew<vtkFloatArray> measure;
+    measure->SetName(vtkDiffusionTensorMathematics::GetOperationAsString(ops[opIndex]));
+    measure->SetNumberOfTuples(numberOfVoxels);
+    output->GetPointData()->AddArray(measure);
+    outPtrs[opIndex] = measure->GetPointer(0);
+  }
+  if (numberOfOperations > 0)
+  {
+    output->GetPointData()->SetActiveScalars(vtkDiffusionTensorMathematics::GetOperationAsString(ops[0]));
+  }
+
+  if (!this->CacheEigenSystems)
+  {
+    this->Internal->Clear();
+  }
+  else if (computeEigenSystems)
+  {
+    this->Internal->Prepare(inTensors, this->ExtractEigenvalues, true);
+  }
+  double* eigenCache = this->Internal->GetEigenSystems();
+  unsigned char* eigenCacheValid = this->Internal->GetEigenSystemsValid();
+  const float* tensorPtr = static_cast<float*>(inTensors->GetVoidPointer(0));
+  const double scaleFactor = this->ScaleFactor;
+  const int extractEigenvalues = this->ExtractEigenvalues;
+  const int fixNegativeEigenvalues = this->FixNegativeEigenvalues;
+  const int maskLabelValue = this->MaskLabelValue;
+
+  // Each voxel is decomposed once and all the requested measures are computed from it
+  vtkSMPTools::For(0, numberOfVoxels, [&](vtkIdType beginVoxel, vtkIdType endVoxel)
+  {
+    double tensor[3][3];
+    double w[3], v0[3], v1[3], v2[3];
+    double* v[3] = { v0, v1, v2 };
+    for (vtkIdType voxelIndex = beginVoxel; voxelIndex < endVoxel; ++voxelIndex)
+    {
+      if (maskPtr && maskPtr[voxelIndex] != maskLabelValue)
+      {
+        for (int opIndex = 0; opIndex < numberOfOperations; ++opIndex)
+        {
+          outPtrs[opIndex][voxelIndex] = 0.0f;
+        }
+        continue;
+      }
+      const float* inPtr = tensorPtr + 9 * voxelIndex;
+      for (int i = 0; i < 3; i++)
+      {
+        for (int j = 0; j < 3; j++)
+        {
+          tensor[i][j] = static_cast<double>(inPtr[3*i + j]);
+        }
+      }
+      if (computeEigenSystems)
+      {
+        vtkDiffusionTensorMathematicsEigenSystem(tensor, extractEigenvalues, w, v,
+          eigenCache ? eigenCache + 12 * voxelIndex : nullptr,
+          eigenCacheValid ? eigenCacheValid + voxelIndex : nullptr);
+        vtkDiffusionTensorMathematicsFixNegativeEigenvalues(fixNegativeEigenvalues, w);
+      }
+      for (int opIndex = 0; opIndex < numberOfOperations; ++opIndex)
+      {
+        const int op = ops[opIndex];
+        switch (op)
+        {
+          // same scaling as in the filter
+          case VTK_TENS_D11:
+            outPtrs[opIndex][voxelIndex] = static_cast<float>(scaleFactor*tensor[0][0]);
+            break;
+          case VTK_TENS_D22:
+            outPtrs[opIndex][voxelIndex] = static_cast<float>(scaleFactor*tensor[1][1]);
+            break;
+          case VTK_TENS_D33:
+            outPtrs[opIndex][voxelIndex] = static_cast<float>(scaleFactor*tensor[2][2]);
+            break;
+          case VTK_TENS_TRACE:
+            outPtrs[opIndex][voxelIndex] = static_cast<float>(scaleFactor*vtkDiffusionTensorMathematics::Trace(tensor));
+            break;
+          case VTK_TENS_DETERMINANT:
+            outPtrs[opIndex][voxelIndex] = static_cast<float>(scaleFactor*vtkDiffusionTensorMathematics::Determinant(tensor));
+            break;
+          default:
+          {
+            float value = static_cast<float>(vtkDiffusionTensorMathematicsEigenMeasure(op, w, v));
+            if (scaleFactor != 1)
+            {
+              value = static_cast<float>(value * scaleFactor);
+            }
+            outPtrs[opIndex][voxelIndex] = value;
+            break;
+          }
+        }
+      }
+    }
+  });
+
+  return true;
 }
 
 // Colormap: convert our mode value (-1..1) to RGB
@@ -172,6 +172,18 @@ void qSlicerColorsModuleWidget::setMRMLScene(vtkMRMLScene *scene)
   d->setDefaultColorNode();
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerColorsModuleWidget::enter()
+{
+  Q_D(qSlicerColorsModuleWidget);
+  if (d->colorLogic())
+  {
+    // Default color nodes may be created on demand, the module lists all of them
+    d->colorLogic()->MaterializeDefaultColorNodes();
+  }
+  this->Superclass::enter();
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerColorsModuleWidget::setCurrentColorNode(vtkMRMLNode* colorNode)
 {
@@ -44,6 +44,9 @@ public:
 
   bool setEditedNode(vtkMRMLNode* node, QString role = QString(), QString context = QString()) override;
 
+  /// Make sure all the default color nodes are available for selection
+  void enter() override;
+
 public slots:
   void setCurrentColorNode(vtkMRMLNode*);
   void updateNumberOfColors();
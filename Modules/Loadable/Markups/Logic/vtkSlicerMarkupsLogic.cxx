@@ -1774,6 +1774,8 @@ void vtkSlicerMarkupsLogic::ConvertAnnotationHierarchyToSubjectHierarchy(vtkMRML
   vtkSmartPointer<vtkCollection> mhNodes = vtkSmartPointer<vtkCollection>::Take(scene->GetNodesByClass("vtkMRMLAnnotationHierarchyNode"));
   std::string newFolderName = vtkMRMLSubjectHierarchyConstants::GetSubjectHierarchyNewItemNamePrefix()
     + vtkMRMLSubjectHierarchyConstants::GetSubjectHierarchyLevelFolder();
+  // Reparenting is batched so that the views are updated only once after the conversion
+  shNode->StartBatchUpdate();
   std::map<std::string, vtkIdType> mhNodeIdToShItemIdMap;
   std::map<std::string, std::string> mhNodeIdToParentNodeIdMap;
   for (mhNodes->InitTraversal(mhIt); (node = (vtkMRMLNode*)mhNodes->GetNextItemAsObject(mhIt)) ;)
@@ -1853,6 +1855,7 @@ void vtkSlicerMarkupsLogic::ConvertAnnotationHierarchyToSubjectHierarchy(vtkMRML
     // Set parent in subject hierarchy
     shNode->SetItemParent(currentItemID, parentItemID, true);
   }
+  shNode->EndBatchUpdate();
 
   // Remove annotation hierarchy nodes from the scene
   for (std::map<std::string, vtkIdType>::iterator it = mhNodeIdToShItemIdMap.begin();
@@ -720,6 +720,7 @@ bool vtkMRMLMarkupsJsonStorageNode::ReadControlPoints(vtkMRMLMarkupsJsonElement*
   bool wasUpdatingPoints = markupsNode->IsUpdatingPoints;
   markupsNode->IsUpdatingPoints = true;
   int numberOfControlPoints = controlPointsArray->GetArraySize();
+  markupsNode->ControlPoints.reserve(markupsNode->ControlPoints.size() + numberOfControlPoints);
   for (int controlPointIndex = 0; controlPointIndex < numberOfControlPoints; ++controlPointIndex)
   {
     vtkSmartPointer<vtkMRMLMarkupsJsonElement> controlPointItem
@@ -1016,8 +1017,7 @@ bool vtkMRMLMarkupsJsonStorageNode::WriteControlPoints(
 
     if(cp->PositionStatus == vtkMRMLMarkupsNode::PositionDefined)
     {
-      double xyz[3] = { 0.0, 0.0, 0.0 };
-      markupsNode->GetNthControlPointPosition(controlPointIndex, xyz);
+      double xyz[3] = { cp->Position[0], cp->Position[1], cp->Position[2] };
       if (coordinateSystem == vtkMRMLStorageNode::CoordinateSystemLPS)
       {
         xyz[0] = -xyz[0];
@@ -1029,7 +1029,7 @@ bool vtkMRMLMarkupsJsonStorageNode::WriteControlPoints(
     {
       writer->WriteStringProperty("position", "");
     }
-    double* orientationMatrix = markupsNode->GetNthControlPointOrientationMatrix(controlPointIndex);
+    double* orientationMatrix = cp->OrientationMatrix;
     if (coordinateSystem == vtkMRMLStorageNode::CoordinateSystemLPS)
     {
       double orientationMatrixLPS[9] = {
@@ -38,6 +38,7 @@
 #include <vtkCallbackCommand.h>
 #include <vtkCellLocator.h>
 #include <vtkCollection.h>
+#include <vtkDoubleArray.h>
 #include <vtkParallelTransportFrame.h>
 #include <vtkGeneralTransform.h>
 #include <vtkMatrix3x3.h>
@@ -58,6 +59,18 @@
 #include <sstream>
 #include <algorithm>
 
+namespace
+{
+//----------------------------------------------------------------------------
+std::string FormatControlPointLabel(const std::string& formatString, int controlPointNumber)
+{
+  char buf[128];
+  buf[sizeof(buf) - 1] = 0; // make sure the string is zero-terminated
+  snprintf(buf, sizeof(buf) - 1, formatString.c_str(), controlPointNumber);
+  return std::string(buf);
+}
+}
+
 //----------------------------------------------------------------------------
 vtkMRMLMarkupsNode::vtkMRMLMarkupsNode()
 {
@@ -699,6 +712,9 @@ int vtkMRMLMarkupsNode::AddNControlPoints(int n, std::string label /*=std::strin
     return -1;
   }
 
+  // Adding multiple points: process events and update curve only once
+  int wasModified = (n > 1 ? this->StartModify() : this->GetDisableModifiedEvent());
+  this->ControlPoints.reserve(this->ControlPoints.size() + n);
   int controlPointIndex = -1;
   for (int i = 0; i < n; i++)
   {
@@ -717,6 +733,10 @@ int vtkMRMLMarkupsNode::AddNControlPoints(int n, std::string label /*=std::strin
     }
     controlPointIndex = this->AddControlPoint(controlPoint);
   }
+  if (n > 1)
+  {
+    this->EndModify(wasModified);
+  }
 
   return controlPointIndex;
 }
@@ -961,12 +981,14 @@ void vtkMRMLMarkupsNode::UpdateCurvePolyFromControlPoints()
     points->Squeeze();
   }
 
+  points->SetNumberOfPoints(numberOfDefinedControlPoints);
+  vtkIdType curvePointIndex = 0;
   for (int i = 0; i < numberOfControlPoints; i++)
   {
     if (this->ControlPoints[i]->PositionStatus == PositionDefined ||
       this->ControlPoints[i]->PositionStatus == PositionPreview)
     {
-      points->InsertNextPoint(this->ControlPoints[i]->Position);
+      points->SetPoint(curvePointIndex++, this->ControlPoints[i]->Position);
     }
   }
   points->Modified();
@@ -1860,20 +1882,31 @@ void vtkMRMLMarkupsNode::ApplyTransform(vtkAbstractTransform* transform, bool ap
     }
   }
 
-  int numControlPoints = this->GetNumberOfControlPoints();
-  double xyzIn[3];
+  // Positions are updated directly (instead of calling SetNthControlPointPosition for each point)
+  // so that events and display updates are only processed once.
   double xyzOut[3];
-  for (int controlPointIndex = 0; controlPointIndex < numControlPoints; controlPointIndex++)
+  bool controlPointsModified = false;
+  for (ControlPointsListType::iterator controlPointIt = this->ControlPoints.begin();
+    controlPointIt != this->ControlPoints.end(); ++controlPointIt)
   {
-    if (!applyToLockedControlPoints && this->GetNthControlPointLocked(controlPointIndex))
+    ControlPoint* controlPoint = *controlPointIt;
+    if (!applyToLockedControlPoints && controlPoint->Locked)
     {
       continue;
     }
-
-    this->GetNthControlPointPosition(controlPointIndex, xyzIn);
-    transform->TransformPoint(xyzIn,xyzOut);
-    int status = this->GetNthControlPointPositionStatus(controlPointIndex);
-    this->SetNthControlPointPosition(controlPointIndex, xyzOut, status);
+    transform->TransformPoint(controlPoint->Position, xyzOut);
+    controlPoint->Position[0] = xyzOut[0];
+    controlPoint->Position[1] = xyzOut[1];
+    controlPoint->Position[2] = xyzOut[2];
+    controlPointsModified = true;
+  }
+  if (controlPointsModified)
+  {
+    this->InvokeCustomModifiedEvent(vtkMRMLMarkupsNode::PointModifiedEvent);
+    if (this->GetDisplayNode())
+    {
+      this->GetDisplayNode()->UpdateScalarRange();
+    }
   }
   this->StorableModifiedTime.Modified();
   this->Modified();
@@ -1961,11 +1994,7 @@ std::string vtkMRMLMarkupsNode::GenerateUniqueControlPointID()
 //---------------------------------------------------------------------------
 std::string vtkMRMLMarkupsNode::GenerateControlPointLabel(int controlPointIndex)
 {
-  std::string formatString = this->ReplaceListNameInControlPointLabelFormat();
-  char buf[128];
-  buf[sizeof(buf) - 1] = 0; // make sure the string is zero-terminated
-  snprintf(buf, sizeof(buf) - 1, formatString.c_str(), controlPointIndex);
-  return std::string(buf);
+  return FormatControlPointLabel(this->ReplaceListNameInControlPointLabelFormat(), controlPointIndex);
 }
 
 //---------------------------------------------------------------------------
@@ -2515,6 +2544,48 @@ void vtkMRMLMarkupsNode::GetControlPointLabels(vtkStringArray* labels)
 
 //---------------------------------------------------------------------------
 void vtkMRMLMarkupsNode::SetControlPointPositionsWorld(vtkPoints* points, bool setUndefinedPoints/*=true*/)
+{
+  vtkMRMLTransformNode* transformNode = this->GetParentTransformNode();
+  if (!points || !transformNode)
+  {
+    this->SetControlPointPositions(points, setUndefinedPoints);
+    return;
+  }
+
+  // Get the transform once and transform all the points at once
+  vtkNew<vtkGeneralTransform> worldToNodeTransform;
+  transformNode->GetTransformFromWorld(worldToNodeTransform);
+  vtkNew<vtkPoints> pointsNode;
+  pointsNode->SetDataTypeToDouble();
+  worldToNodeTransform->TransformPoints(points, pointsNode);
+  this->SetControlPointPositions(pointsNode, setUndefinedPoints);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsNode::GetControlPointPositionsWorld(vtkPoints* points)
+{
+  if (!points)
+  {
+    return;
+  }
+  vtkMRMLTransformNode* transformNode = this->GetParentTransformNode();
+  if (!transformNode)
+  {
+    this->GetControlPointPositions(points);
+    return;
+  }
+
+  vtkNew<vtkPoints> pointsNode;
+  pointsNode->SetDataTypeToDouble();
+  this->GetControlPointPositions(pointsNode);
+  vtkNew<vtkGeneralTransform> nodeToWorldTransform;
+  transformNode->GetTransformToWorld(nodeToWorldTransform);
+  points->Reset();
+  nodeToWorldTransform->TransformPoints(pointsNode, points);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsNode::SetControlPointPositions(vtkPoints* points, bool setUndefinedPoints/*=true*/)
 {
   if (!points)
   {
@@ -2525,29 +2596,93 @@ void vtkMRMLMarkupsNode::SetControlPointPositionsWorld(vtkPoints* points, bool s
   int wasModified = this->StartModify();
   this->IsUpdatingPoints = true;
 
-  vtkIdType numberOfPoints = points->GetNumberOfPoints();
-  for (vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++)
+  int numberOfPoints = static_cast<int>(points->GetNumberOfPoints());
+  int numberOfExistingControlPoints = this->GetNumberOfControlPoints();
+
+  // Update existing control points
+  bool positionsModified = false;
+  bool positionDefined = false;
+  bool positionNonMissing = false;
+  for (int pointIndex = 0; pointIndex < std::min(numberOfPoints, numberOfExistingControlPoints); pointIndex++)
   {
-    double* posWorld = points->GetPoint(pointIndex);
-    if (pointIndex < this->GetNumberOfControlPoints())
+    ControlPoint* controlPoint = this->ControlPoints[pointIndex];
+    if (!setUndefinedPoints && controlPoint->PositionStatus != PositionDefined)
     {
-      // point already exists, just update it
-      if (setUndefinedPoints || this->GetNthControlPointPositionStatus(pointIndex) == PositionDefined)
-      {
-        this->SetNthControlPointPositionWorld(pointIndex, posWorld);
-      }
+      continue;
     }
-    else
+    points->GetPoint(pointIndex, controlPoint->Position);
+    if (controlPoint->PositionStatus == PositionMissing)
+    {
+      positionNonMissing = true;
+    }
+    if (controlPoint->PositionStatus != PositionDefined)
+    {
+      positionDefined = true;
+      controlPoint->PositionStatus = PositionDefined;
+    }
+    positionsModified = true;
+  }
+
+  // Add new control points
+  int numberOfPointsToAdd = numberOfPoints - numberOfExistingControlPoints;
+  if (numberOfPointsToAdd > 0)
+  {
+    if (this->GetFixedNumberOfControlPoints())
+    {
+      vtkErrorMacro("SetControlPointPositions: Markup node control point number is locked.");
+      numberOfPointsToAdd = 0;
+    }
+    else if (this->MaximumNumberOfControlPoints >= 0 && numberOfPoints > this->MaximumNumberOfControlPoints)
+    {
+      vtkErrorMacro("SetControlPointPositions: requested number of points (" << numberOfPoints
+        << ") is more than maximum number of control points allowed (" << this->MaximumNumberOfControlPoints << ")");
+      numberOfPointsToAdd = std::max(0, this->MaximumNumberOfControlPoints - numberOfExistingControlPoints);
+    }
+  }
+  if (numberOfPointsToAdd > 0)
+  {
+    // The label format is the same for all new points, only compute it once
+    std::string labelFormat = this->ReplaceListNameInControlPointLabelFormat();
+    this->ControlPoints.reserve(numberOfExistingControlPoints + numberOfPointsToAdd);
+    for (int pointIndex = numberOfExistingControlPoints; pointIndex < numberOfExistingControlPoints + numberOfPointsToAdd; pointIndex++)
     {
-      // need to add a new point
-      vtkMRMLMarkupsNode::AddControlPointWorld(vtkVector3d(posWorld));
+      ControlPoint* controlPoint = new ControlPoint;
+      points->GetPoint(pointIndex, controlPoint->Position);
+      controlPoint->PositionStatus = PositionDefined;
+      controlPoint->ID = this->GenerateUniqueControlPointID();
+      controlPoint->Label = FormatControlPointLabel(labelFormat, this->LastUsedControlPointNumber);
+      this->ControlPoints.push_back(controlPoint);
     }
+    this->InvokeCustomModifiedEvent(vtkMRMLMarkupsNode::PointAddedEvent);
+    positionsModified = true;
+    positionDefined = true;
+  }
+
+  if (positionsModified)
+  {
+    this->InvokeCustomModifiedEvent(vtkMRMLMarkupsNode::PointModifiedEvent);
+    this->StorableModifiedTime.Modified();
   }
+  if (positionDefined)
+  {
+    this->InvokeCustomModifiedEvent(vtkMRMLMarkupsNode::PointPositionDefinedEvent);
+  }
+  if (positionNonMissing)
+  {
+    this->InvokeCustomModifiedEvent(vtkMRMLMarkupsNode::PointPositionNonMissingEvent);
+  }
+
+  // Remove extra control points
   while (this->GetNumberOfControlPoints() > numberOfPoints)
   {
     this->RemoveNthControlPoint(this->GetNumberOfControlPoints() - 1);
   }
 
+  if (positionsModified && this->GetDisplayNode())
+  {
+    this->GetDisplayNode()->UpdateScalarRange();
+  }
+
   this->IsUpdatingPoints = false;
   // No need to call UpdateAllMeasurements(), because it is automatically
   // called in EndModify().
@@ -2555,7 +2690,7 @@ void vtkMRMLMarkupsNode::SetControlPointPositionsWorld(vtkPoints* points, bool s
 }
 
 //---------------------------------------------------------------------------
-void vtkMRMLMarkupsNode::GetControlPointPositionsWorld(vtkPoints* points)
+void vtkMRMLMarkupsNode::GetControlPointPositions(vtkPoints* points)
 {
   if (!points)
   {
@@ -2563,11 +2698,50 @@ void vtkMRMLMarkupsNode::GetControlPointPositionsWorld(vtkPoints* points)
   }
   int numberOfControlPoints = this->GetNumberOfControlPoints();
   points->SetNumberOfPoints(numberOfControlPoints);
-  double posWorld[3] = { 0.0, 0.0, 0.0 };
   for (int controlPointIndex = 0; controlPointIndex < numberOfControlPoints; controlPointIndex++)
   {
-    this->GetNthControlPointPositionWorld(controlPointIndex, posWorld);
-    points->SetPoint(controlPointIndex, posWorld);
+    points->SetPoint(controlPointIndex, this->ControlPoints[controlPointIndex]->Position);
+  }
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLMarkupsNode::SetControlPointOrientationMatrices(vtkDoubleArray* orientationMatrices)
+{
+  if (!orientationMatrices || orientationMatrices->GetNumberOfComponents() != 9
+    || orientationMatrices->GetNumberOfTuples() != this->GetNumberOfControlPoints())
+  {
+    vtkErrorMacro("SetControlPointOrientationMatrices failed: the array must have 9 components"
+      " and one tuple for each control point");
+    return false;
+  }
+  int numberOfControlPoints = this->GetNumberOfControlPoints();
+  if (numberOfControlPoints == 0)
+  {
+    return true;
+  }
+  MRMLNodeModifyBlocker blocker(this);
+  for (int controlPointIndex = 0; controlPointIndex < numberOfControlPoints; controlPointIndex++)
+  {
+    orientationMatrices->GetTypedTuple(controlPointIndex, this->ControlPoints[controlPointIndex]->OrientationMatrix);
+  }
+  this->InvokeCustomModifiedEvent(vtkMRMLMarkupsNode::PointModifiedEvent);
+  this->StorableModifiedTime.Modified();
+  return true;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLMarkupsNode::GetControlPointOrientationMatrices(vtkDoubleArray* orientationMatrices)
+{
+  if (!orientationMatrices)
+  {
+    return;
+  }
+  int numberOfControlPoints = this->GetNumberOfControlPoints();
+  orientationMatrices->SetNumberOfComponents(9);
+  orientationMatrices->SetNumberOfTuples(numberOfControlPoints);
+  for (int controlPointIndex = 0; controlPointIndex < numberOfControlPoints; controlPointIndex++)
+  {
+    orientationMatrices->SetTypedTuple(controlPointIndex, this->ControlPoints[controlPointIndex]->OrientationMatrix);
   }
 }
 
@@ -2895,22 +3069,40 @@ void vtkMRMLMarkupsNode::UpdateInteractionHandleToWorldMatrix()
 {
   // The origin of the coordinate system is at the center of mass of the control points
   double origin_World[3] = { 0 };
-  int numberOfControlPoints = this->GetNumberOfControlPoints();
   int numberOfMovableControlPoints = this->GetNumberOfMovableControlPoints();
   vtkNew<vtkPoints> controlPoints_World;
-  for (int i = 0; i < numberOfControlPoints; ++i)
+  controlPoints_World->SetDataTypeToDouble();
   {
-    double controlPointPosition_World[3] = { 0.0, 0.0, 0.0 };
-    if (!this->GetNthControlPointLocked(i) && this->GetNthControlPointPositionStatus(i) == PositionDefined)
+    vtkNew<vtkPoints> controlPoints_Node;
+    controlPoints_Node->SetDataTypeToDouble();
+    controlPoints_Node->Allocate(numberOfMovableControlPoints);
+    for (ControlPointsListType::iterator controlPointIt = this->ControlPoints.begin();
+      controlPointIt != this->ControlPoints.end(); ++controlPointIt)
     {
-      this->GetNthControlPointPositionWorld(i, controlPointPosition_World);
-
-      origin_World[0] += controlPointPosition_World[0] / numberOfMovableControlPoints;
-      origin_World[1] += controlPointPosition_World[1] / numberOfMovableControlPoints;
-      origin_World[2] += controlPointPosition_World[2] / numberOfMovableControlPoints;
-
-      controlPoints_World->InsertNextPoint(controlPointPosition_World);
+      if (!(*controlPointIt)->Locked && (*controlPointIt)->PositionStatus == PositionDefined)
+      {
+        controlPoints_Node->InsertNextPoint((*controlPointIt)->Position);
+      }
     }
+    // Get the transform once and transform all the points at once
+    vtkMRMLTransformNode* transformNode = this->GetParentTransformNode();
+    if (transformNode)
+    {
+      vtkNew<vtkGeneralTransform> nodeToWorldTransform;
+      transformNode->GetTransformToWorld(nodeToWorldTransform);
+      nodeToWorldTransform->TransformPoints(controlPoints_Node, controlPoints_World);
+    }
+    else
+    {
+      controlPoints_World->ShallowCopy(controlPoints_Node);
+    }
+  }
+  for (vtkIdType i = 0; i < controlPoints_World->GetNumberOfPoints(); ++i)
+  {
+    double* controlPointPosition_World = controlPoints_World->GetPoint(i);
+    origin_World[0] += controlPointPosition_World[0] / numberOfMovableControlPoints;
+    origin_World[1] += controlPointPosition_World[1] / numberOfMovableControlPoints;
+    origin_World[2] += controlPointPosition_World[2] / numberOfMovableControlPoints;
   }
 
   for (int i = 0; i < 3; ++i)
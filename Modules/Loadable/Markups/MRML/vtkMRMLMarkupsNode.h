@@ -33,6 +33,7 @@
 #include <vtkSmartPointer.h>
 #include <vtkVector.h>
 
+class vtkDoubleArray;
 class vtkMatrix3x3;
 class vtkMRMLUnitNode;
 
@@ -318,6 +319,25 @@ public:
   /// Get a copy of all control point positions in world coordinate system
   void GetControlPointPositionsWorld(vtkPoints* points);
 
+  /// Set all control point positions from a point list, in the node coordinate system.
+  /// Behaves the same way as \sa SetControlPointPositionsWorld.
+  /// All control points are updated and added in one step and events are invoked once,
+  /// therefore this is much faster than setting positions of many control points one by one.
+  void SetControlPointPositions(vtkPoints* points, bool setUndefinedPoints=true);
+
+  /// Get a copy of all control point positions in the node coordinate system
+  void GetControlPointPositions(vtkPoints* points);
+
+  /// Set orientation matrices of all control points, in the node coordinate system.
+  /// The array must have 9 components (see \sa GetNthControlPointOrientationMatrix)
+  /// and one tuple for each control point.
+  /// \return Success flag
+  bool SetControlPointOrientationMatrices(vtkDoubleArray* orientationMatrices);
+
+  /// Get a copy of orientation matrices of all control points, in the node coordinate system.
+  /// The array is set to have 9 components and one tuple for each control point.
+  void GetControlPointOrientationMatrices(vtkDoubleArray* orientationMatrices);
+
   ///@{
   /// Add a new control point, returning the point index, -1 on failure.
   int AddControlPoint(vtkVector3d point, std::string label = std::string());
@@ -23,10 +23,12 @@
 #include "vtkMRMLStorageNode.h"
 
 // VTK includes
+#include <vtkDoubleArray.h>
 #include <vtkIndent.h>
 #include <vtkMath.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
+#include <vtkPoints.h>
 #include <vtkTestingOutputWindow.h>
 
 // STL includes
@@ -365,5 +367,55 @@ int vtkMRMLMarkupsNodeTest1(int , char * [] )
   }
   CHECK_INT(commandLine3.size(), 2);
 
+  // bulk position and orientation access
+  vtkNew<vtkMRMLMarkupsFiducialNode> node2;
+  scene->AddNode(node2.GetPointer());
+  node2->AddControlPoint(vtkVector3d(-1.0, -2.0, -3.0), "existing");
+  node2->UnsetNthControlPointPosition(0);
+  vtkNew<vtkPoints> points;
+  const int numberOfBulkPoints = 1000;
+  for (int pointIndex = 0; pointIndex < numberOfBulkPoints; pointIndex++)
+  {
+    points->InsertNextPoint(pointIndex, 2.0 * pointIndex, -pointIndex);
+  }
+  node2->SetControlPointPositions(points, false);
+  CHECK_INT(node2->GetNumberOfControlPoints(), numberOfBulkPoints);
+  // undefined point is not updated if setUndefinedPoints is false
+  CHECK_INT(node2->GetNthControlPointPositionStatus(0), vtkMRMLMarkupsNode::PositionUndefined);
+  CHECK_STD_STRING(node2->GetNthControlPointLabel(0), "existing");
+  CHECK_INT(node2->GetNthControlPointPositionStatus(10), vtkMRMLMarkupsNode::PositionDefined);
+  CHECK_BOOL(node2->GetNthControlPointPositionVector(10) == vtkVector3d(10.0, 20.0, -10.0), true);
+  CHECK_BOOL(node2->GetNthControlPointID(10) != node2->GetNthControlPointID(11), true);
+  CHECK_BOOL(node2->GetNthControlPointLabel(10).empty(), false);
+  CHECK_INT(node2->GetNumberOfDefinedControlPoints(), numberOfBulkPoints - 1);
+
+  node2->SetControlPointPositions(points);
+  CHECK_INT(node2->GetNthControlPointPositionStatus(0), vtkMRMLMarkupsNode::PositionDefined);
+  CHECK_INT(node2->GetNumberOfDefinedControlPoints(), numberOfBulkPoints);
+
+  vtkNew<vtkPoints> pointsOut;
+  node2->GetControlPointPositionsWorld(pointsOut);
+  CHECK_INT(pointsOut->GetNumberOfPoints(), numberOfBulkPoints);
+  CHECK_DOUBLE(pointsOut->GetPoint(999)[1], 1998.0);
+
+  // fewer points remove the extra control points
+  points->SetNumberOfPoints(10);
+  node2->SetControlPointPositionsWorld(points);
+  CHECK_INT(node2->GetNumberOfControlPoints(), 10);
+
+  vtkNew<vtkDoubleArray> orientations;
+  node2->GetControlPointOrientationMatrices(orientations);
+  CHECK_INT(orientations->GetNumberOfComponents(), 9);
+  CHECK_INT(orientations->GetNumberOfTuples(), 10);
+  CHECK_DOUBLE(orientations->GetComponent(3, 4), 1.0);
+  orientations->SetComponent(3, 0, -1.0);
+  orientations->SetComponent(3, 4, -1.0);
+  CHECK_BOOL(node2->SetControlPointOrientationMatrices(orientations), true);
+  CHECK_DOUBLE(node2->GetNthControlPointOrientationMatrix(3)[4], -1.0);
+  orientations->SetNumberOfTuples(5);
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  CHECK_BOOL(node2->SetControlPointOrientationMatrices(orientations), false);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+
   return EXIT_SUCCESS;
 }
@@ -29,6 +29,7 @@
 #include "vtkLine.h"
 #include "vtkLineSource.h"
 #include "vtkLookupTable.h"
+#include "vtkMath.h"
 #include "vtkMarkupsGlyphSource2D.h"
 #include "vtkMRMLSliceNode.h"
 #include "vtkMRMLViewNode.h"
@@ -51,6 +52,10 @@
 #include <vtkMRMLInteractionEventData.h>
 #include <vtkMRMLTransformNode.h>
 
+// STD includes
+#include <algorithm>
+#include <cmath>
+
 //----------------------------------------------------------------------
 vtkSlicerMarkupsWidgetRepresentation::ControlPointsPipeline::ControlPointsPipeline()
 {
@@ -510,6 +515,9 @@ void vtkSlicerMarkupsWidgetRepresentation::UpdateFromMRMLInternal(
     this->MarkupsTransformModifiedTime.Modified();
   }
 
+  // Control point positions or visibility may have changed
+  this->ControlPointPickingIndexInputs.clear();
+
   if (!event || event == vtkMRMLDisplayableNode::DisplayModifiedEvent)
   {
     // Update MRML data node from display node
@@ -814,3 +822,146 @@ int vtkSlicerMarkupsWidgetRepresentation::GetGlyphTypeSourceFromDisplay(int glyp
       return -1;
   }
 }
+
+//----------------------------------------------------------------------
+void vtkSlicerMarkupsWidgetRepresentation::ControlPointPickingGrid::Initialize()
+{
+  this->Points.clear();
+  this->CellPointIds.clear();
+  this->CellOffsets.clear();
+  this->Dimensions[0] = 0;
+  this->Dimensions[1] = 0;
+  this->MaximumTolerance = 0.0;
+}
+
+//----------------------------------------------------------------------
+void vtkSlicerMarkupsWidgetRepresentation::ControlPointPickingGrid::AddPoint(
+  int controlPointIndex, const double position[3], double tolerance)
+{
+  if (!std::isfinite(position[0]) || !std::isfinite(position[1]) || !std::isfinite(position[2])
+    || tolerance <= 0.0 || std::fabs(position[2]) >= tolerance)
+  {
+    // the point cannot be picked
+    return;
+  }
+  PickablePoint point;
+  point.ControlPointIndex = controlPointIndex;
+  point.Position[0] = position[0];
+  point.Position[1] = position[1];
+  point.Position[2] = position[2];
+  point.Tolerance2 = tolerance * tolerance;
+  this->Points.push_back(point);
+  this->MaximumTolerance = std::max(this->MaximumTolerance, tolerance);
+}
+
+//----------------------------------------------------------------------
+void vtkSlicerMarkupsWidgetRepresentation::ControlPointPickingGrid::Build()
+{
+  this->CellPointIds.clear();
+  this->CellOffsets.clear();
+  this->Dimensions[0] = 0;
+  this->Dimensions[1] = 0;
+  int numberOfPoints = static_cast<int>(this->Points.size());
+  if (numberOfPoints == 0)
+  {
+    return;
+  }
+
+  double bounds[4] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN };
+  for (const PickablePoint& point : this->Points)
+  {
+    bounds[0] = std::min(bounds[0], point.Position[0]);
+    bounds[1] = std::max(bounds[1], point.Position[0]);
+    bounds[2] = std::min(bounds[2], point.Position[1]);
+    bounds[3] = std::max(bounds[3], point.Position[1]);
+  }
+  this->Origin[0] = bounds[0];
+  this->Origin[1] = bounds[2];
+
+  // Cells must not be smaller than the largest tolerance so that checking the neighbor cells
+  // is always sufficient. Cells are made larger if points are scattered over a large area
+  // to keep the number of cells proportional to the number of points.
+  this->CellSize = std::max(this->MaximumTolerance, 1.0);
+  const double maximumNumberOfCells = 4.0 * numberOfPoints + 16.0;
+  double numberOfCells = (floor((bounds[1] - bounds[0]) / this->CellSize) + 1.0)
+    * (floor((bounds[3] - bounds[2]) / this->CellSize) + 1.0);
+  if (numberOfCells > maximumNumberOfCells)
+  {
+    this->CellSize *= sqrt(numberOfCells / maximumNumberOfCells) * 1.01;
+  }
+  this->Dimensions[0] = static_cast<int>(floor((bounds[1] - bounds[0]) / this->CellSize)) + 1;
+  this->Dimensions[1] = static_cast<int>(floor((bounds[3] - bounds[2]) / this->CellSize)) + 1;
+
+  // Counting sort of point indices by cell
+  std::vector<int> pointCellIds(numberOfPoints);
+  this->CellOffsets.assign(this->Dimensions[0] * this->Dimensions[1] + 1, 0);
+  for (int pointId = 0; pointId < numberOfPoints; ++pointId)
+  {
+    const PickablePoint& point = this->Points[pointId];
+    int i = std::min(static_cast<int>((point.Position[0] - this->Origin[0]) / this->CellSize), this->Dimensions[0] - 1);
+    int j = std::min(static_cast<int>((point.Position[1] - this->Origin[1]) / this->CellSize), this->Dimensions[1] - 1);
+    pointCellIds[pointId] = j * this->Dimensions[0] + i;
+    this->CellOffsets[pointCellIds[pointId] + 1]++;
+  }
+  for (size_t cellId = 1; cellId < this->CellOffsets.size(); ++cellId)
+  {
+    this->CellOffsets[cellId] += this->CellOffsets[cellId - 1];
+  }
+  this->CellPointIds.resize(numberOfPoints);
+  std::vector<int> insertPositions(this->CellOffsets.begin(), this->CellOffsets.end() - 1);
+  for (int pointId = 0; pointId < numberOfPoints; ++pointId)
+  {
+    this->CellPointIds[insertPositions[pointCellIds[pointId]]++] = pointId;
+  }
+}
+
+//----------------------------------------------------------------------
+int vtkSlicerMarkupsWidgetRepresentation::ControlPointPickingGrid::FindClosestPoint(
+  const double position[3], double& closestDistance2) const
+{
+  if (this->Dimensions[0] <= 0 || this->Dimensions[1] <= 0)
+  {
+    return -1;
+  }
+  double cellPosition[2] =
+  {
+    floor((position[0] - this->Origin[0]) / this->CellSize),
+    floor((position[1] - this->Origin[1]) / this->CellSize)
+  };
+  if (cellPosition[0] < -1.0 || cellPosition[0] > this->Dimensions[0]
+    || cellPosition[1] < -1.0 || cellPosition[1] > this->Dimensions[1])
+  {
+    // far from all the points
+    return -1;
+  }
+  int iMin = std::max(static_cast<int>(cellPosition[0]) - 1, 0);
+  int iMax = std::min(static_cast<int>(cellPosition[0]) + 1, this->Dimensions[0] - 1);
+  int jMin = std::max(static_cast<int>(cellPosition[1]) - 1, 0);
+  int jMax = std::min(static_cast<int>(cellPosition[1]) + 1, this->Dimensions[1] - 1);
+
+  int closestControlPointIndex = -1;
+  for (int j = jMin; j <= jMax; ++j)
+  {
+    for (int i = iMin; i <= iMax; ++i)
+    {
+      int cellId = j * this->Dimensions[0] + i;
+      for (int offset = this->CellOffsets[cellId]; offset < this->CellOffsets[cellId + 1]; ++offset)
+      {
+        const PickablePoint& point = this->Points[this->CellPointIds[offset]];
+        double dist2 = vtkMath::Distance2BetweenPoints(point.Position, position);
+        if (dist2 >= point.Tolerance2)
+        {
+          continue;
+        }
+        // Prefer lower control point index if distances are equal (same as iterating through all the points)
+        if (dist2 < closestDistance2
+          || (dist2 == closestDistance2 && closestControlPointIndex >= 0 && point.ControlPointIndex < closestControlPointIndex))
+        {
+          closestDistance2 = dist2;
+          closestControlPointIndex = point.ControlPointIndex;
+        }
+      }
+    }
+  }
+  return closestControlPointIndex;
+}
@@ -67,6 +67,9 @@
 #include "vtkTransformPolyDataFilter.h"
 #include "vtkTubeFilter.h"
 
+// STD includes
+#include <vector>
+
 class vtkMRMLInteractionEventData;
 
 class VTK_SLICER_MARKUPS_MODULE_VTKWIDGETS_EXPORT vtkSlicerMarkupsWidgetRepresentation : public vtkMRMLAbstractWidgetRepresentation
@@ -179,6 +182,43 @@ protected:
     vtkSmartPointer<vtkTextProperty> TextProperty;
   };
 
+  /// Uniform grid of control point positions in display coordinates.
+  /// It allows finding the control point that is closest to the mouse position
+  /// without projecting all the control points at each mouse move.
+  /// Cell size is set to the largest picking tolerance, therefore only the cell
+  /// that contains the query position and its 8 neighbors have to be checked.
+  class ControlPointPickingGrid
+  {
+  public:
+    /// Remove all points.
+    void Initialize();
+    /// Add a point that can be picked if it is closer than tolerance to the query position.
+    /// Third coordinate of the position is taken into account when computing distance
+    /// (it is the distance from the slice plane in slice views).
+    void AddPoint(int controlPointIndex, const double position[3], double tolerance);
+    /// Sort points into grid cells. Must be called after all the points are added.
+    void Build();
+    /// Get index of the closest control point that is within its picking tolerance.
+    /// Returns -1 if no point is found, or no point is closer than closestDistance2.
+    int FindClosestPoint(const double position[3], double& closestDistance2) const;
+    int GetNumberOfPoints() const { return static_cast<int>(this->Points.size()); }
+
+  protected:
+    struct PickablePoint
+    {
+      int ControlPointIndex;
+      double Position[3];
+      double Tolerance2;
+    };
+    std::vector<PickablePoint> Points;
+    std::vector<int> CellPointIds;
+    std::vector<int> CellOffsets;
+    double Origin[2] = { 0.0, 0.0 };
+    double CellSize = { 1.0 };
+    int Dimensions[2] = { 0, 0 };
+    double MaximumTolerance = { 0.0 };
+  };
+
   // Calculate view size and scale factor
   virtual void UpdateViewScaleFactor() = 0;
 
@@ -218,6 +258,12 @@ protected:
 
   vtkTimeStamp MarkupsTransformModifiedTime;
 
+  // Index of pickable control points and all the inputs it was built from
+  // (view geometry, visibility, tolerances). Inputs are cleared when the representation
+  // is updated from MRML so that the index is rebuilt at the next picking request.
+  ControlPointPickingGrid ControlPointPickingIndex;
+  std::vector<double> ControlPointPickingIndexInputs;
+
   double* GetWidgetColor(int controlPointType) VTK_SIZEHINT(3);
 
   ControlPointsPipeline* ControlPoints[NumberOfControlPointTypes]; // Unselected, Selected, Active, Project, ProjectBehind
@@ -543,7 +543,49 @@ void vtkSlicerMarkupsWidgetRepresentation2D::CanInteract(
     }
   }
 
-  vtkIdType numberOfPoints = markupsNode->GetNumberOfControlPoints();
+  this->UpdateControlPointPickingIndex();
+  int closestControlPointIndex = this->ControlPointPickingIndex.FindClosestPoint(displayPosition3, closestDistance2);
+  if (closestControlPointIndex >= 0)
+  {
+    foundComponentType = vtkMRMLMarkupsDisplayNode::ComponentControlPoint;
+    foundComponentIndex = closestControlPointIndex;
+  }
+}
+
+//----------------------------------------------------------------------
+void vtkSlicerMarkupsWidgetRepresentation2D::UpdateControlPointPickingIndex()
+{
+  vtkMRMLSliceNode* sliceNode = this->GetSliceNode();
+  vtkMRMLMarkupsNode* markupsNode = this->GetMarkupsNode();
+  if (!sliceNode || !markupsNode || !this->MarkupsDisplayNode)
+  {
+    this->ControlPointPickingIndex.Initialize();
+    this->ControlPointPickingIndexInputs.clear();
+    return;
+  }
+
+  // Control point positions in the slice view only depend on the slice position and orientation
+  // (control point changes clear the inputs when the representation is updated from MRML).
+  std::vector<double> inputs;
+  inputs.push_back(static_cast<double>(sliceNode->GetXYToRAS()->GetMTime()));
+  inputs.push_back(this->ControlPointSize);
+  inputs.push_back(this->PickingTolerance);
+  inputs.push_back(this->ScreenScaleFactor);
+  inputs.push_back(this->MarkupsDisplayNode->GetSliceProjection() ? 1.0 : 0.0);
+  if (inputs == this->ControlPointPickingIndexInputs)
+  {
+    return;
+  }
+  this->ControlPointPickingIndexInputs = inputs;
+
+  this->ControlPointPickingIndex.Initialize();
+  double maxPickingDistanceFromControlPoint = sqrt(this->GetMaximumControlPointPickingDistance2());
+  bool sliceProjection = this->MarkupsDisplayNode->GetSliceProjection();
+
+  vtkNew<vtkPoints> pointsWorld;
+  pointsWorld->SetDataTypeToDouble();
+  markupsNode->GetControlPointPositionsWorld(pointsWorld);
+  vtkIdType numberOfPoints = pointsWorld->GetNumberOfPoints();
 
   double pointDisplayPos[4] = { 0.0, 0.0, 0.0, 1.0 };
   double pointWorldPos[4] = { 0.0, 0.0, 0.0, 1.0 };
@@ -556,20 +598,15 @@ void vtkSlicerMarkupsWidgetRepresentation2D::CanInteract(
     {
       continue;
     }
-    markupsNode->GetNthControlPointPositionWorld(i, pointWorldPos);
+    pointsWorld->GetPoint(i, pointWorldPos);
     rasToxyMatrix->MultiplyPoint(pointWorldPos, pointDisplayPos);
-    if (this->MarkupsDisplayNode->GetSliceProjection())
-    {
-      pointDisplayPos[2] = displayPosition3[2];
-    }
-    double dist2 = vtkMath::Distance2BetweenPoints(pointDisplayPos, displayPosition3);
-    if (dist2 < maxPickingDistanceFromControlPoint2 && dist2 < closestDistance2)
+    if (sliceProjection)
     {
-      closestDistance2 = dist2;
-      foundComponentType = vtkMRMLMarkupsDisplayNode::ComponentControlPoint;
-      foundComponentIndex = i;
+      pointDisplayPos[2] = 0.0;
     }
+    this->ControlPointPickingIndex.AddPoint(i, pointDisplayPos, maxPickingDistanceFromControlPoint);
   }
+  this->ControlPointPickingIndex.Build();
 }
 
 //----------------------------------------------------------------------
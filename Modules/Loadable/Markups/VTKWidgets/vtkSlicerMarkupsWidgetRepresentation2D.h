@@ -110,6 +110,9 @@ protected:
   // in pixels.
   double GetMaximumControlPointPickingDistance2();
 
+  /// Rebuild the picking index of control points if the slice or the markups changed.
+  void UpdateControlPointPickingIndex();
+
   bool GetAllControlPointsVisible() override;
 
   /// Check, if the point is displayable in the current slice geometry
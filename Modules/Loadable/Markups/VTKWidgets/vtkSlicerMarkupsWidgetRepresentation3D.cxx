@@ -405,102 +405,164 @@ void vtkSlicerMarkupsWidgetRepresentation3D::CanInteract(
     }
   }
 
-  vtkIdType numberOfPoints = markupsNode->GetNumberOfControlPoints();
+  if (interactionEventData->IsDisplayPositionValid())
+  {
+    this->UpdateControlPointPickingIndex(interactionEventData);
+    int closestControlPointIndex = this->ControlPointPickingIndex.FindClosestPoint(displayPosition3, closestDistance2);
+    if (closestControlPointIndex >= 0)
+    {
+      foundComponentType = vtkMRMLMarkupsDisplayNode::ComponentControlPoint;
+      foundComponentIndex = closestControlPointIndex;
+    }
+    return;
+  }
+
+  // Virtual reality: there are only a few points in a typical scene and view geometry
+  // changes continuously, therefore distances are computed directly in world coordinate system.
+  std::vector<bool> pointsViewVisibility;
+  this->GetControlPointsViewVisibility(pointsViewVisibility);
+  vtkNew<vtkPoints> pointsWorld;
+  pointsWorld->SetDataTypeToDouble();
+  markupsNode->GetControlPointPositionsWorld(pointsWorld);
+  const double* worldPosition = interactionEventData->GetWorldPosition();
+  double worldTolerance = this->ControlPointSize / 2.0 +
+    this->PickingTolerance / interactionEventData->GetWorldToPhysicalScale();
+  vtkIdType numberOfPoints = std::min(pointsWorld->GetNumberOfPoints(), static_cast<vtkIdType>(pointsViewVisibility.size()));
   for (int i = 0; i < numberOfPoints; i++)
   {
-    if (!(markupsNode->GetNthControlPointPositionVisibility(i)
-      && markupsNode->GetNthControlPointVisibility(i)))
+    if (!pointsViewVisibility[i])
     {
       continue;
     }
-    double centerPosWorld[4] = { 0.0, 0.0, 0.0, 1.0 };
-    double centerPosDisplay[4] = { 0.0, 0.0, 0.0, 1.0 };
-    markupsNode->GetNthControlPointPositionWorld(i, centerPosWorld);
-    this->Renderer->SetWorldPoint(centerPosWorld);
-
-    // Check SelectVisiblePoints output to see if the point is occluded or not.
-    // SelectVisiblePoints is very sensitive to when it is executed (it has to check the z buffer after
-    // opaque geometry is rendered but 2D labels are not yet), therefore we do not
-    // update its output but just use the last output generated for the last rendering.
-    bool pointVisible = false;
-    if (this->MarkupsDisplayNode
-      && this->MarkupsDisplayNode->GetOccludedVisibility()
-      && this->MarkupsDisplayNode->GetOccludedOpacity() > 0.0)
+    double centerPosWorld[3] = { 0.0, 0.0, 0.0 };
+    pointsWorld->GetPoint(i, centerPosWorld);
+    double dist2 = vtkMath::Distance2BetweenPoints(centerPosWorld, worldPosition);
+    if (dist2 < worldTolerance * worldTolerance && dist2 < closestDistance2)
     {
-      pointVisible = true;
+      closestDistance2 = dist2;
+      foundComponentType = vtkMRMLMarkupsDisplayNode::ComponentControlPoint;
+      foundComponentIndex = i;
     }
-    for (int controlPointType = 0; controlPointType <= Active && !pointVisible; ++controlPointType)
+  }
+}
+
+//----------------------------------------------------------------------
+void vtkSlicerMarkupsWidgetRepresentation3D::GetControlPointsViewVisibility(std::vector<bool>& pointsViewVisibility)
+{
+  pointsViewVisibility.clear();
+  vtkMRMLMarkupsNode* markupsNode = this->GetMarkupsNode();
+  if (!markupsNode)
+  {
+    return;
+  }
+  int numberOfPoints = markupsNode->GetNumberOfControlPoints();
+  pointsViewVisibility.resize(numberOfPoints, false);
+
+  // Occluded points can be picked if they are displayed
+  bool occludedPointsVisible = (this->MarkupsDisplayNode
+    && this->MarkupsDisplayNode->GetOccludedVisibility()
+    && this->MarkupsDisplayNode->GetOccludedOpacity() > 0.0);
+  if (occludedPointsVisible)
+  {
+    for (int i = 0; i < numberOfPoints; i++)
     {
-      if ((controlPointType == Unselected && markupsNode->GetNthControlPointSelected(i))
-        || (controlPointType == Selected && !markupsNode->GetNthControlPointSelected(i)))
-      {
-        continue;
-      }
-      ControlPointsPipeline3D* controlPoints = this->GetControlPointsPipeline(controlPointType);
-      if (!controlPoints->VisiblePointsPolyData->GetPointData())
-      {
-        continue;
-      }
-      vtkIdTypeArray* visiblePointIndices = vtkIdTypeArray::SafeDownCast(
-        controlPoints->VisiblePointsPolyData->GetPointData()->GetAbstractArray("controlPointIndices"));
-      if (!visiblePointIndices)
-      {
-        continue;
-      }
-      if (visiblePointIndices->LookupValue(i) >= 0)
-      {
-        // visible
-        pointVisible = true;
-        break;
-      }
+      pointsViewVisibility[i] = (markupsNode->GetNthControlPointPositionVisibility(i)
+        && markupsNode->GetNthControlPointVisibility(i));
+    }
+    return;
+  }
+
+  // Check SelectVisiblePoints output to see if the point is occluded or not.
+  // SelectVisiblePoints is very sensitive to when it is executed (it has to check the z buffer after
+  // opaque geometry is rendered but 2D labels are not yet), therefore we do not
+  // update its output but just use the last output generated for the last rendering.
+  for (int controlPointType = 0; controlPointType <= Active; ++controlPointType)
+  {
+    ControlPointsPipeline3D* controlPoints = this->GetControlPointsPipeline(controlPointType);
+    if (!controlPoints->VisiblePointsPolyData->GetPointData())
+    {
+      continue;
     }
-    if (!pointVisible)
+    vtkIdTypeArray* visiblePointIndices = vtkIdTypeArray::SafeDownCast(
+      controlPoints->VisiblePointsPolyData->GetPointData()->GetAbstractArray("controlPointIndices"));
+    if (!visiblePointIndices)
     {
       continue;
     }
-    if (interactionEventData->IsDisplayPositionValid())
+    vtkIdType numberOfVisiblePoints = visiblePointIndices->GetNumberOfValues();
+    for (vtkIdType visiblePointIndex = 0; visiblePointIndex < numberOfVisiblePoints; ++visiblePointIndex)
     {
-      double pixelTolerance = this->ControlPointSize / 2.0 / this->GetViewScaleFactorAtPosition(centerPosWorld, interactionEventData)
-        + this->PickingTolerance * this->ScreenScaleFactor;
-      interactionEventData->WorldToDisplay(centerPosWorld, centerPosDisplay);
-      double dist2 = vtkMath::Distance2BetweenPoints(centerPosDisplay, displayPosition3);
-      if (dist2 < pixelTolerance * pixelTolerance && dist2 < closestDistance2)
+      vtkIdType i = visiblePointIndices->GetValue(visiblePointIndex);
+      if (i < 0 || i >= numberOfPoints || pointsViewVisibility[i])
       {
-        closestDistance2 = dist2;
-        foundComponentType = vtkMRMLMarkupsDisplayNode::ComponentControlPoint;
-        foundComponentIndex = i;
+        continue;
       }
-    }
-    else
-    {
-      const double* worldPosition = interactionEventData->GetWorldPosition();
-      double worldTolerance = this->ControlPointSize / 2.0 +
-        this->PickingTolerance / interactionEventData->GetWorldToPhysicalScale();
-      double dist2 = vtkMath::Distance2BetweenPoints(centerPosWorld, worldPosition);
-      if (dist2 < worldTolerance * worldTolerance && dist2 < closestDistance2)
+      if ((controlPointType == Unselected && markupsNode->GetNthControlPointSelected(i))
+        || (controlPointType == Selected && !markupsNode->GetNthControlPointSelected(i)))
       {
-        closestDistance2 = dist2;
-        foundComponentType = vtkMRMLMarkupsDisplayNode::ComponentControlPoint;
-        foundComponentIndex = i;
+        continue;
       }
+      pointsViewVisibility[i] = (markupsNode->GetNthControlPointPositionVisibility(i)
+        && markupsNode->GetNthControlPointVisibility(i));
     }
   }
+}
 
-  /* This would probably faster for many points:
-
-  this->BuildLocator();
-
-  double closestDistance2 = VTK_DOUBLE_MAX;
-  int closestNode = static_cast<int> (this->Locator->FindClosestPointWithinRadius(
-    this->PixelTolerance, displayPos, closestDistance2));
+//----------------------------------------------------------------------
+void vtkSlicerMarkupsWidgetRepresentation3D::UpdateControlPointPickingIndex(vtkMRMLInteractionEventData* interactionEventData)
+{
+  vtkMRMLMarkupsNode* markupsNode = this->GetMarkupsNode();
+  if (!markupsNode || !this->Renderer || !this->Renderer->GetActiveCamera() || !this->Renderer->GetVTKWindow())
+  {
+    this->ControlPointPickingIndex.Initialize();
+    this->ControlPointPickingIndexInputs.clear();
+    return;
+  }
 
-  if (closestNode != this->GetActiveNode())
+  // Display positions depend on the camera and the renderer geometry, visibility depends on the
+  // last rendering. The index is rebuilt only if any of these changed since the last build.
+  std::vector<double> inputs;
+  inputs.push_back(static_cast<double>(this->Renderer->GetActiveCamera()->GetMTime()));
+  const int* windowSize = this->Renderer->GetVTKWindow()->GetSize();
+  inputs.push_back(windowSize[0]);
+  inputs.push_back(windowSize[1]);
+  const double* viewport = this->Renderer->GetViewport();
+  inputs.insert(inputs.end(), viewport, viewport + 4);
+  for (int controlPointType = 0; controlPointType <= Active; ++controlPointType)
+  {
+    inputs.push_back(static_cast<double>(this->GetControlPointsPipeline(controlPointType)->VisiblePointsPolyData->GetMTime()));
+  }
+  inputs.push_back(this->ControlPointSize);
+  inputs.push_back(this->PickingTolerance);
+  inputs.push_back(this->ScreenScaleFactor);
+  if (inputs == this->ControlPointPickingIndexInputs)
+  {
+    return;
+  }
+  this->ControlPointPickingIndexInputs = inputs;
+
+  this->ControlPointPickingIndex.Initialize();
+  std::vector<bool> pointsViewVisibility;
+  this->GetControlPointsViewVisibility(pointsViewVisibility);
+  vtkNew<vtkPoints> pointsWorld;
+  pointsWorld->SetDataTypeToDouble();
+  markupsNode->GetControlPointPositionsWorld(pointsWorld);
+  vtkIdType numberOfPoints = std::min(pointsWorld->GetNumberOfPoints(), static_cast<vtkIdType>(pointsViewVisibility.size()));
+  for (int i = 0; i < numberOfPoints; i++)
+  {
+    if (!pointsViewVisibility[i])
     {
-    this->SetActiveNode(closestNode);
-    this->NeedToRender = 1;
+      continue;
     }
-  return (this->GetActiveNode() >= 0);
-  */
+    double centerPosWorld[3] = { 0.0, 0.0, 0.0 };
+    double centerPosDisplay[3] = { 0.0, 0.0, 0.0 };
+    pointsWorld->GetPoint(i, centerPosWorld);
+    double pixelTolerance = this->ControlPointSize / 2.0 / this->GetViewScaleFactorAtPosition(centerPosWorld, interactionEventData)
+      + this->PickingTolerance * this->ScreenScaleFactor;
+    interactionEventData->WorldToDisplay(centerPosWorld, centerPosDisplay);
+    this->ControlPointPickingIndex.AddPoint(i, centerPosDisplay, pixelTolerance);
+  }
+  this->ControlPointPickingIndex.Build();
 }
 
 //----------------------------------------------------------------------
@@ -31,6 +31,7 @@
 #include "vtkSlicerMarkupsWidgetRepresentation.h"
 
 #include <map>
+#include <vector>
 
 class vtkActor;
 class vtkActor2D;
@@ -136,6 +137,13 @@ protected:
 
   ControlPointsPipeline3D* GetControlPointsPipeline(int controlPointType);
 
+  /// Get visibility of each control point in the view, as of the last rendering.
+  /// A point is visible if it is displayed and it is not occluded (or occluded points are displayed).
+  void GetControlPointsViewVisibility(std::vector<bool>& pointsViewVisibility);
+
+  /// Rebuild the display-space picking index of control points if the view or the markups changed.
+  void UpdateControlPointPickingIndex(vtkMRMLInteractionEventData* interactionEventData);
+
   virtual void UpdateControlPointGlyphOrientation();
 
   virtual void UpdateNthPointAndLabelFromMRML(int n);
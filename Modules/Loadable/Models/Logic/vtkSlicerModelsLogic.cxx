@@ -91,6 +91,8 @@ void vtkSlicerModelsLogic::OnMRMLSceneEndImport()
   vtkCollection* mhNodes = scene->GetNodesByClass("vtkMRMLModelHierarchyNode");
   std::string newFolderName = vtkMRMLSubjectHierarchyConstants::GetSubjectHierarchyNewItemNamePrefix()
     + vtkMRMLSubjectHierarchyConstants::GetSubjectHierarchyLevelFolder();
+  // Reparenting is batched so that the views are updated only once after the conversion
+  shNode->StartBatchUpdate();
   std::map<std::string, vtkIdType> mhNodeIdToShItemIdMap;
   std::map<std::string, std::string> mhNodeIdToParentNodeIdMap;
   for (mhNodes->InitTraversal(mhIt); (node = (vtkMRMLNode*)mhNodes->GetNextItemAsObject(mhIt)) ;)
@@ -161,6 +163,7 @@ void vtkSlicerModelsLogic::OnMRMLSceneEndImport()
     // Set parent in subject hierarchy
     shNode->SetItemParent(currentItemID, parentItemID, true);
   }
+  shNode->EndBatchUpdate();
 
   // Remove model hierarchy nodes from the scene
   for (std::map<std::string, vtkIdType>::iterator it = mhNodeIdToShItemIdMap.begin();
@@ -238,6 +241,13 @@ int vtkSlicerModelsLogic::AddModels (const char* dirname, const char* suffix,
 vtkMRMLModelNode* vtkSlicerModelsLogic::AddModel(const char* filename,
   int coordinateSystem/*=vtkMRMLStorageNode::CoordinateSystemLPS*/,
   vtkMRMLMessageCollection* userMessages/*=nullptr*/)
+{
+  return this->AddModel(filename, coordinateSystem, userMessages, nullptr, -1);
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLModelNode* vtkSlicerModelsLogic::AddModel(const char* filename, int coordinateSystem,
+  vtkMRMLMessageCollection* userMessages, vtkPointSet* preReadMesh, int preReadMeshCoordinateSystem)
 {
   if (this->GetMRMLScene() == nullptr || filename == nullptr)
   {
@@ -295,6 +305,10 @@ vtkMRMLModelNode* vtkSlicerModelsLogic::AddModel(const char* filename,
   // Read the model file
   vtkDebugMacro("AddModel: calling read on the storage node");
   storageNode->SetCoordinateSystem(coordinateSystem);
+  if (preReadMesh)
+  {
+    storageNode->SetPreReadMesh(storageNode->GetFullNameFromFileName().c_str(), preReadMesh, preReadMeshCoordinateSystem);
+  }
   int success = storageNode->ReadData(modelNode);
   if (!success)
   {
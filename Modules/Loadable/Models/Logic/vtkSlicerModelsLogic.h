@@ -30,6 +30,7 @@ class vtkMRMLModelNode;
 class vtkMRMLStorageNode;
 class vtkMRMLTransformNode;
 class vtkAlgorithmOutput;
+class vtkPointSet;
 class vtkPolyData;
 
 class VTK_SLICER_MODELS_MODULE_LOGIC_EXPORT vtkSlicerModelsLogic
@@ -62,6 +63,14 @@ class VTK_SLICER_MODELS_MODULE_LOGIC_EXPORT vtkSlicerModelsLogic
   vtkMRMLModelNode* AddModel(const char* filename, int coordinateSystem = vtkMRMLStorageNode::CoordinateSystemLPS,
     vtkMRMLMessageCollection* userMessages = nullptr);
 
+  /// Add into the scene a new mrml model node, using a mesh that has been already
+  /// read from the file by vtkMRMLModelStorageNode::ReadMeshFromFile (for example, in a background thread).
+  /// Storage and display nodes are added the same way as when the mesh is read from the file.
+  /// \param preReadMesh mesh read from the file. If nullptr then the mesh is read from the file.
+  /// \param preReadMeshCoordinateSystem coordinate system specified in the file header (-1 if not specified).
+  vtkMRMLModelNode* AddModel(const char* filename, int coordinateSystem, vtkMRMLMessageCollection* userMessages,
+    vtkPointSet* preReadMesh, int preReadMeshCoordinateSystem);
+
   /// Create model nodes and
   /// read their polydata from a specified directory
   /// \param coordinateSystem If coordinate system is not specified
@@ -32,18 +32,46 @@
 #include "vtkSlicerModelsLogic.h"
 
 // MRML includes
+#include <vtkCacheManager.h>
 #include "vtkMRMLDisplayNode.h"
 #include "vtkMRMLMessageCollection.h"
 #include "vtkMRMLModelNode.h"
+#include "vtkMRMLModelStorageNode.h"
 #include <vtkMRMLScene.h>
 
 // VTK includes
+#include <vtkCollection.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointSet.h>
 #include <vtkSmartPointer.h>
 
+//-----------------------------------------------------------------------------
+/// Stores the mesh that is read from file in a background thread.
+class vtkModelsReaderBackgroundReadJob : public vtkObject
+{
+public:
+  static vtkModelsReaderBackgroundReadJob* New();
+  vtkTypeMacro(vtkModelsReaderBackgroundReadJob, vtkObject);
+
+  vtkSmartPointer<vtkPointSet> Mesh;
+  int CoordinateSystemInFileHeader{ -1 };
+
+protected:
+  vtkModelsReaderBackgroundReadJob() = default;
+  ~vtkModelsReaderBackgroundReadJob() override = default;
+  vtkModelsReaderBackgroundReadJob(const vtkModelsReaderBackgroundReadJob&) = delete;
+  void operator=(const vtkModelsReaderBackgroundReadJob&) = delete;
+};
+
+vtkStandardNewMacro(vtkModelsReaderBackgroundReadJob);
+
 //-----------------------------------------------------------------------------
 class qSlicerModelsReaderPrivate
 {
 public:
+  /// Set name and reset 3D views for the loaded model, as requested in the properties
+  void updateLoadedModel(vtkMRMLModelNode* node, const qSlicerIO::IOProperties& properties);
+
   vtkSmartPointer<vtkSlicerModelsLogic> ModelsLogic;
 };
 
@@ -129,6 +157,43 @@ double qSlicerModelsReader::canLoadFileConfidence(const QString& fileName)const
   return confidence;
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerModelsReaderPrivate::updateLoadedModel(vtkMRMLModelNode* node, const qSlicerIO::IOProperties& properties)
+{
+  vtkMRMLScene* scene = node->GetScene();
+  if (properties.contains("name"))
+  {
+    std::string uname = scene->GetUniqueNameByString(
+      properties["name"].toString().toUtf8());
+    node->SetName(uname.c_str());
+  }
+
+  // If no other nodes are displayed then reset the field of view
+  bool otherNodesAreAlreadyVisible = false;
+  vtkSmartPointer<vtkCollection> displayNodes = vtkSmartPointer<vtkCollection>::Take(
+    scene->GetNodesByClass("vtkMRMLDisplayNode"));
+  for(int displayNodeIndex = 0; displayNodeIndex < displayNodes->GetNumberOfItems(); ++displayNodeIndex)
+  {
+    vtkMRMLDisplayNode* displayNode = vtkMRMLDisplayNode::SafeDownCast(
+      displayNodes->GetItemAsObject(displayNodeIndex));
+    if (displayNode->GetDisplayableNode()
+      && displayNode->GetVisibility()
+      && displayNode->GetDisplayableNode() != node)
+    {
+      otherNodesAreAlreadyVisible = true;
+      break;
+    }
+  }
+  if (!otherNodesAreAlreadyVisible)
+  {
+    qSlicerApplication* app = qSlicerApplication::application();
+    if (app && app->layoutManager())
+    {
+      app->layoutManager()->resetThreeDViews();
+    }
+  }
+}
+
 //-----------------------------------------------------------------------------
 bool qSlicerModelsReader::load(const IOProperties& properties)
 {
@@ -155,38 +220,67 @@ bool qSlicerModelsReader::load(const IOProperties& properties)
     // errors are already logged and userMessages contain details that can be displayed to users
     return false;
   }
+  d->updateLoadedModel(node, properties);
   this->setLoadedNodes( QStringList(QString(node->GetID())) );
-  if (properties.contains("name"))
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkObject> qSlicerModelsReader::prepareBackgroundRead(const IOProperties& properties)
+{
+  Q_D(qSlicerModelsReader);
+  if (!d->ModelsLogic || !this->mrmlScene())
   {
-    std::string uname = this->mrmlScene()->GetUniqueNameByString(
-      properties["name"].toString().toUtf8());
-    node->SetName(uname.c_str());
+    return nullptr;
   }
-
-  // If no other nodes are displayed then reset the field of view
-  bool otherNodesAreAlreadyVisible = false;
-  vtkSmartPointer<vtkCollection> displayNodes = vtkSmartPointer<vtkCollection>::Take(
-    this->mrmlScene()->GetNodesByClass("vtkMRMLDisplayNode"));
-  for(int displayNodeIndex = 0; displayNodeIndex < displayNodes->GetNumberOfItems(); ++displayNodeIndex)
+  vtkCacheManager* cacheManager = this->mrmlScene()->GetCacheManager();
+  if (cacheManager && cacheManager->IsRemoteReference(properties["fileName"].toString().toUtf8()))
   {
-    vtkMRMLDisplayNode* displayNode = vtkMRMLDisplayNode::SafeDownCast(
-      displayNodes->GetItemAsObject(displayNodeIndex));
-    if (displayNode->GetDisplayableNode()
-      && displayNode->GetVisibility()
-      && displayNode->GetDisplayableNode() != node)
-    {
-      otherNodesAreAlreadyVisible = true;
-      break;
-    }
+    // Remote files are downloaded by load()
+    return nullptr;
   }
-  if (!otherNodesAreAlreadyVisible)
+  return vtkSmartPointer<vtkModelsReaderBackgroundReadJob>::New();
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerModelsReader::readData(const IOProperties& properties, vtkObject* readJob,
+  vtkMRMLMessageCollection* userMessages)const
+{
+  // Only the mesh is read here, nodes are created in loadData() (in the main thread)
+  vtkModelsReaderBackgroundReadJob* job = vtkModelsReaderBackgroundReadJob::SafeDownCast(readJob);
+  if (!job || !userMessages)
   {
-    qSlicerApplication* app = qSlicerApplication::application();
-    if (app && app->layoutManager())
-    {
-      app->layoutManager()->resetThreeDViews();
-    }
+    return false;
   }
+  job->Mesh.TakeReference(vtkMRMLModelStorageNode::ReadMeshFromFile(
+    properties["fileName"].toString().toUtf8(), job->CoordinateSystemInFileHeader, userMessages));
+  return (job->Mesh != nullptr);
+}
 
+//-----------------------------------------------------------------------------
+bool qSlicerModelsReader::loadData(const IOProperties& properties, vtkObject* readJob)
+{
+  Q_D(qSlicerModelsReader);
+  this->setLoadedNodes(QStringList());
+  vtkModelsReaderBackgroundReadJob* job = vtkModelsReaderBackgroundReadJob::SafeDownCast(readJob);
+  if (!d->ModelsLogic || !job || !job->Mesh)
+  {
+    return false;
+  }
+  int coordinateSystem = vtkMRMLStorageNode::CoordinateSystemLPS; // default
+  if (properties.contains("coordinateSystem"))
+  {
+    coordinateSystem = properties["coordinateSystem"].toInt();
+  }
+  this->userMessages()->ClearMessages();
+  vtkMRMLModelNode* node = d->ModelsLogic->AddModel(properties["fileName"].toString().toUtf8(),
+    coordinateSystem, this->userMessages(), job->Mesh, job->CoordinateSystemInFileHeader);
+  if (!node)
+  {
+    // errors are already logged and userMessages contain details that can be displayed to users
+    return false;
+  }
+  d->updateLoadedModel(node, properties);
+  this->setLoadedNodes( QStringList(QString(node->GetID())) );
   return true;
 }
@@ -54,6 +54,14 @@ public:
 
   bool load(const IOProperties& properties) override;
 
+  /// Meshes of local model files are read in a background thread,
+  /// model nodes are created in the main thread by loadData().
+  /// \sa qSlicerFileReader::prepareBackgroundRead()
+  vtkSmartPointer<vtkObject> prepareBackgroundRead(const IOProperties& properties) override;
+  bool readData(const IOProperties& properties, vtkObject* readJob,
+    vtkMRMLMessageCollection* userMessages)const override;
+  bool loadData(const IOProperties& properties, vtkObject* readJob) override;
+
 protected:
   QScopedPointer<qSlicerModelsReaderPrivate> d_ptr;
 
@@ -106,10 +106,8 @@ class SegmentEditorGrowFromSeedsEffect(AbstractScriptedSegmentEditorAutoComplete
             self.delayedAutoUpdateTimer.start()
 
     def computePreviewLabelmap(self, mergedImage, outputLabelmap):
-        import vtkITK
-
         if not self.growCutFilter:
-            self.growCutFilter = vtkITK.vtkITKGrowCut()
+            self.growCutFilter = slicer.vtkImageGrowCutSegment()
             self.growCutFilter.SetIntensityVolume(self.clippedMasterImageData)
             self.growCutFilter.SetMaskVolume(self.clippedMaskImageData)
             maskExtent = self.clippedMaskImageData.GetExtent() if self.clippedMaskImageData else None
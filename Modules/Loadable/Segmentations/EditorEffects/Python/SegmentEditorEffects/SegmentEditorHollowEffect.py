@@ -213,8 +213,6 @@ class SegmentEditorHollowEffect(AbstractScriptedSegmentEditorEffect):
             margin.SetOuterMarginMM(0.0)
             margin.SetInnerMarginMM(-shellThicknessMM + voxelDiameter)
 
-        modifierLabelmap.DeepCopy(margin.GetOutput())
-
         margin.Update()
         modifierLabelmap.ShallowCopy(margin.GetOutput())
 
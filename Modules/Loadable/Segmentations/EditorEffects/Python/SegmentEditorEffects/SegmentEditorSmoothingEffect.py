@@ -238,19 +238,6 @@ If segments overlap, segment higher in the segments table will have priority. <b
         finally:
             qt.QApplication.restoreOverrideCursor()
 
-    def clipImage(self, inputImage, maskExtent, margin):
-        clipper = vtk.vtkImageClip()
-        clipper.SetOutputWholeExtent(maskExtent[0] - margin[0], maskExtent[1] + margin[0],
-                                     maskExtent[2] - margin[1], maskExtent[3] + margin[1],
-                                     maskExtent[4] - margin[2], maskExtent[5] + margin[2])
-        clipper.SetInputData(inputImage)
-        clipper.SetClipData(True)
-        clipper.Update()
-        clippedImage = slicer.vtkOrientedImageData()
-        clippedImage.ShallowCopy(clipper.GetOutput())
-        clippedImage.CopyDirections(inputImage)
-        return clippedImage
-
     def modifySelectedSegmentByLabelmap(self, smoothedImage, selectedSegmentLabelmap, modifierLabelmap, maskImage, maskExtent):
         if maskImage:
             smoothedClippedSelectedSegmentLabelmap = slicer.vtkOrientedImageData()
@@ -287,81 +274,37 @@ If segments overlap, segment higher in the segments table will have priority. <b
 
             smoothingMethod = self.scriptedEffect.parameter("SmoothingMethod")
 
+            smoothing = slicer.vtkImageLabelmapSmoothing()
             if smoothingMethod == GAUSSIAN:
-                maxValue = 255
                 radiusFactor = 4.0
                 standardDeviationMM = self.scriptedEffect.doubleParameter("GaussianStandardDeviationMm")
                 spacing = modifierLabelmap.GetSpacing()
-                standardDeviationPixel = [1.0, 1.0, 1.0]
-                radiusPixel = [3, 3, 3]
-                for idx in range(3):
-                    standardDeviationPixel[idx] = standardDeviationMM / spacing[idx]
-                    radiusPixel[idx] = int(standardDeviationPixel[idx] * radiusFactor) + 1
-                if maskExtent:
-                    clippedSelectedSegmentLabelmap = self.clipImage(selectedSegmentLabelmap, maskExtent, radiusPixel)
-                else:
-                    clippedSelectedSegmentLabelmap = selectedSegmentLabelmap
-
-                thresh = vtk.vtkImageThreshold()
-                thresh.SetInputData(clippedSelectedSegmentLabelmap)
-                thresh.ThresholdByLower(0)
-                thresh.SetInValue(0)
-                thresh.SetOutValue(maxValue)
-                thresh.SetOutputScalarType(vtk.VTK_UNSIGNED_CHAR)
-
-                gaussianFilter = vtk.vtkImageGaussianSmooth()
-                gaussianFilter.SetInputConnection(thresh.GetOutputPort())
-                gaussianFilter.SetStandardDeviation(*standardDeviationPixel)
-                gaussianFilter.SetRadiusFactor(radiusFactor)
-
-                thresh2 = vtk.vtkImageThreshold()
-                thresh2.SetInputConnection(gaussianFilter.GetOutputPort())
-                thresh2.ThresholdByUpper(int(maxValue / 2))
-                thresh2.SetInValue(1)
-                thresh2.SetOutValue(0)
-                thresh2.SetOutputScalarType(selectedSegmentLabelmap.GetScalarType())
-                thresh2.Update()
-
-                self.modifySelectedSegmentByLabelmap(thresh2.GetOutput(), selectedSegmentLabelmap, modifierLabelmap, maskImage, maskExtent)
-
+                margin = [int(standardDeviationMM / spacing[idx] * radiusFactor) + 1 for idx in range(3)]
+                smoothing.SetSmoothingMethodToGaussian()
+                smoothing.SetGaussianStandardDeviationMm(standardDeviationMM)
             else:
                 # size rounded to nearest odd number. If kernel size is even then image gets shifted.
                 kernelSizePixel = self.getKernelSizePixel()
-
-                if maskExtent:
-                    clippedSelectedSegmentLabelmap = self.clipImage(selectedSegmentLabelmap, maskExtent, kernelSizePixel)
-                else:
-                    clippedSelectedSegmentLabelmap = selectedSegmentLabelmap
-
+                margin = kernelSizePixel
                 if smoothingMethod == MEDIAN:
-                    # Median filter does not require a particular label value
-                    smoothingFilter = vtk.vtkImageMedian3D()
-                    smoothingFilter.SetInputData(clippedSelectedSegmentLabelmap)
-
-                else:
-                    # We need to know exactly the value of the segment voxels, apply threshold to make force the selected label value
-                    labelValue = 1
-                    backgroundValue = 0
-                    thresh = vtk.vtkImageThreshold()
-                    thresh.SetInputData(clippedSelectedSegmentLabelmap)
-                    thresh.ThresholdByLower(0)
-                    thresh.SetInValue(backgroundValue)
-                    thresh.SetOutValue(labelValue)
-                    thresh.SetOutputScalarType(clippedSelectedSegmentLabelmap.GetScalarType())
-
-                    smoothingFilter = vtk.vtkImageOpenClose3D()
-                    smoothingFilter.SetInputConnection(thresh.GetOutputPort())
-                    if smoothingMethod == MORPHOLOGICAL_OPENING:
-                        smoothingFilter.SetOpenValue(labelValue)
-                        smoothingFilter.SetCloseValue(backgroundValue)
-                    else:  # must be smoothingMethod == MORPHOLOGICAL_CLOSING:
-                        smoothingFilter.SetOpenValue(backgroundValue)
-                        smoothingFilter.SetCloseValue(labelValue)
-
-                smoothingFilter.SetKernelSize(kernelSizePixel[0], kernelSizePixel[1], kernelSizePixel[2])
-                smoothingFilter.Update()
-
-                self.modifySelectedSegmentByLabelmap(smoothingFilter.GetOutput(), selectedSegmentLabelmap, modifierLabelmap, maskImage, maskExtent)
+                    smoothing.SetSmoothingMethodToMedian()
+                elif smoothingMethod == MORPHOLOGICAL_OPENING:
+                    smoothing.SetSmoothingMethodToMorphologicalOpening()
+                else:  # must be smoothingMethod == MORPHOLOGICAL_CLOSING:
+                    smoothing.SetSmoothingMethodToMorphologicalClosing()
+                smoothing.SetKernelSizePixel(kernelSizePixel[0], kernelSizePixel[1], kernelSizePixel[2])
+
+            if maskExtent:
+                smoothing.SetOutputExtent(maskExtent[0] - margin[0], maskExtent[1] + margin[0],
+                                          maskExtent[2] - margin[1], maskExtent[3] + margin[1],
+                                          maskExtent[4] - margin[2], maskExtent[5] + margin[2])
+
+            smoothedImage = slicer.vtkOrientedImageData()
+            if not smoothing.SmoothBinaryLabelmap(selectedSegmentLabelmap, smoothedImage):
+                logging.error("apply: Failed to apply smoothing")
+                return
+
+            self.modifySelectedSegmentByLabelmap(smoothedImage, selectedSegmentLabelmap, modifierLabelmap, maskImage, maskExtent)
 
         except IndexError:
             logging.error("apply: Failed to apply smoothing")
@@ -390,67 +333,12 @@ If segments overlap, segment higher in the segments table will have priority. <b
             segmentId = visibleSegmentIds.GetValue(i)
             segmentLabelValues.append([segmentId, i + 1])
 
-        # Perform smoothing in voxel space
-        ici = vtk.vtkImageChangeInformation()
-        ici.SetInputData(mergedImage)
-        ici.SetOutputSpacing(1, 1, 1)
-        ici.SetOutputOrigin(0, 0, 0)
-
-        # Convert labelmap to combined polydata
-        # vtkDiscreteFlyingEdges3D cannot be used here, as in the output of that filter,
-        # each labeled region is completely disconnected from neighboring regions, and
-        # for joint smoothing it is essential for the points to move together.
-        convertToPolyData = vtk.vtkDiscreteMarchingCubes()
-        convertToPolyData.SetInputConnection(ici.GetOutputPort())
-        convertToPolyData.SetNumberOfContours(len(segmentLabelValues))
-
-        contourIndex = 0
-        for segmentId, labelValue in segmentLabelValues:
-            convertToPolyData.SetValue(contourIndex, labelValue)
-            contourIndex += 1
-
-        # Low-pass filtering using Taubin's method
-        smoothingFactor = self.scriptedEffect.doubleParameter("JointTaubinSmoothingFactor")
-        smoothingIterations = 100  # according to VTK documentation 10-20 iterations could be enough but we use a higher value to reduce chance of shrinking
-        passBand = pow(10.0, -4.0 * smoothingFactor)  # gives a nice range of 1-0.0001 from a user input of 0-1
-        smoother = vtk.vtkWindowedSincPolyDataFilter()
-        smoother.SetInputConnection(convertToPolyData.GetOutputPort())
-        smoother.SetNumberOfIterations(smoothingIterations)
-        smoother.BoundarySmoothingOff()
-        smoother.FeatureEdgeSmoothingOff()
-        smoother.SetFeatureAngle(90.0)
-        smoother.SetPassBand(passBand)
-        smoother.NonManifoldSmoothingOn()
-        smoother.NormalizeCoordinatesOn()
-
-        # Extract a label
-        threshold = vtk.vtkThreshold()
-        threshold.SetInputConnection(smoother.GetOutputPort())
-
-        # Convert to polydata
-        geometryFilter = vtk.vtkGeometryFilter()
-        geometryFilter.SetInputConnection(threshold.GetOutputPort())
-
-        # Convert polydata to stencil
-        polyDataToImageStencil = vtk.vtkPolyDataToImageStencil()
-        polyDataToImageStencil.SetInputConnection(geometryFilter.GetOutputPort())
-        polyDataToImageStencil.SetOutputSpacing(1, 1, 1)
-        polyDataToImageStencil.SetOutputOrigin(0, 0, 0)
-        polyDataToImageStencil.SetOutputWholeExtent(mergedImage.GetExtent())
-
-        # Convert stencil to image
-        stencil = vtk.vtkImageStencil()
-        emptyBinaryLabelMap = vtk.vtkImageData()
-        emptyBinaryLabelMap.SetExtent(mergedImage.GetExtent())
-        emptyBinaryLabelMap.AllocateScalars(vtk.VTK_UNSIGNED_CHAR, 1)
-        vtkSegmentationCore.vtkOrientedImageDataResample.FillImage(emptyBinaryLabelMap, 0)
-        stencil.SetInputData(emptyBinaryLabelMap)
-        stencil.SetStencilConnection(polyDataToImageStencil.GetOutputPort())
-        stencil.ReverseStencilOn()
-        stencil.SetBackgroundValue(1)  # General foreground value is 1 (background value because of reverse stencil)
-
-        imageToWorldMatrix = vtk.vtkMatrix4x4()
-        mergedImage.GetImageToWorldMatrix(imageToWorldMatrix)
+        # Smooth surface of all segments together
+        smoothing = slicer.vtkImageLabelmapSmoothing()
+        smoothing.SetJointSmoothingFactor(self.scriptedEffect.doubleParameter("JointTaubinSmoothingFactor"))
+        if not smoothing.ComputeJointSmoothing(mergedImage, len(segmentLabelValues)):
+            logging.error("Failed to apply smoothing")
+            return
 
         # TODO: Temporarily setting the overwrite mode to OverwriteVisibleSegments is an approach that should be change once additional
         # layer control options have been implemented. Users may wish to keep segments on separate layers, and not allow them to be
@@ -458,13 +346,8 @@ If segments overlap, segment higher in the segments table will have priority. <b
         oldOverwriteMode = self.scriptedEffect.parameterSetNode().GetOverwriteMode()
         self.scriptedEffect.parameterSetNode().SetOverwriteMode(slicer.vtkMRMLSegmentEditorNode.OverwriteVisibleSegments)
         for segmentId, labelValue in segmentLabelValues:
-            threshold.SetLowerThreshold(labelValue)
-            threshold.SetUpperThreshold(labelValue)
-            threshold.SetThresholdFunction(vtk.vtkThreshold.THRESHOLD_BETWEEN)
-            stencil.Update()
             smoothedBinaryLabelMap = slicer.vtkOrientedImageData()
-            smoothedBinaryLabelMap.ShallowCopy(stencil.GetOutput())
-            smoothedBinaryLabelMap.SetImageToWorldMatrix(imageToWorldMatrix)
+            smoothing.GetJointSmoothingResult(labelValue, smoothedBinaryLabelMap)
             self.scriptedEffect.modifySegmentByLabelmap(segmentationNode, segmentId, smoothedBinaryLabelMap,
                                                         slicer.qSlicerSegmentEditorAbstractEffect.ModificationModeSet, False)
         self.scriptedEffect.parameterSetNode().SetOverwriteMode(oldOverwriteMode)
@@ -48,10 +48,6 @@
 #include <vtkGlyph2D.h>
 #include <vtkGlyph3D.h>
 #include <vtkIdList.h>
-#include <vtkImageChangeInformation.h>
-#include <vtkImageStencil.h>
-#include <vtkImageStencilData.h>
-#include <vtkImageStencilToImage.h>
 #include <vtkMath.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
@@ -62,7 +58,6 @@
 #include <vtkPolyDataMapper.h>
 #include <vtkPolyDataMapper2D.h>
 #include <vtkPolyDataNormals.h>
-#include <vtkPolyDataToImageStencil.h>
 #include <vtkProperty2D.h>
 #include <vtkProperty.h>
 #include <vtkPropPicker.h>
@@ -94,7 +89,6 @@
 #include "qSlicerApplication.h"
 #include "vtkMRMLSliceLogic.h"
 #include "vtkMRMLSliceLayerLogic.h"
-#include "vtkOrientedImageDataResample.h"
 
 //-----------------------------------------------------------------------------
 /// Visualization objects and pipeline for each slice view for the paint brush
@@ -244,6 +238,7 @@ qSlicerSegmentEditorPaintEffectPrivate::qSlicerSegmentEditorPaintEffectPrivate(q
   , BrushPixelModeCheckbox(nullptr)
 {
   this->PaintCoordinates_World = vtkSmartPointer<vtkPoints>::New();
+  this->PaintStrokeStartPointIds = vtkSmartPointer<vtkIdList>::New();
   this->FeedbackPointsPolyData = vtkSmartPointer<vtkPolyData>::New();
   this->FeedbackPointsPolyData->SetPoints(this->PaintCoordinates_World);
 
@@ -263,13 +258,7 @@ qSlicerSegmentEditorPaintEffectPrivate::qSlicerSegmentEditorPaintEffectPrivate(q
   this->WorldOriginToWorldTransformer->SetTransform(this->WorldOriginToWorldTransform);
   this->WorldOriginToWorldTransformer->SetInputConnection(this->BrushPolyDataNormals->GetOutputPort());
 
-  this->WorldOriginToModifierLabelmapIjkTransformer = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-  this->WorldOriginToModifierLabelmapIjkTransform = vtkSmartPointer<vtkTransform>::New();
-  this->WorldOriginToModifierLabelmapIjkTransformer->SetTransform(this->WorldOriginToModifierLabelmapIjkTransform);
-  this->WorldOriginToModifierLabelmapIjkTransformer->SetInputConnection(this->BrushPolyDataNormals->GetOutputPort());
-  this->BrushPolyDataToStencil = vtkSmartPointer<vtkPolyDataToImageStencil>::New();
-  this->BrushPolyDataToStencil->SetOutputSpacing(1.0,1.0,1.0);
-  this->BrushPolyDataToStencil->SetInputConnection(this->WorldOriginToModifierLabelmapIjkTransformer->GetOutputPort());
+  this->BrushRasterizer = vtkSmartPointer<vtkImageBrushStrokeRasterizer>::New();
 
   this->FeedbackGlyphFilter = vtkSmartPointer<vtkGlyph3D>::New();
   this->FeedbackGlyphFilter->SetInputData(this->FeedbackPointsPolyData);
@@ -340,7 +329,12 @@ void qSlicerSegmentEditorPaintEffectPrivate::paintAddPoint(qMRMLWidget* viewWidg
 {
   Q_Q(qSlicerSegmentEditorPaintEffect);
 
-  if (lastBrushPosition_World)
+  if (!lastBrushPosition_World)
+  {
+    // start of a new stroke, do not connect it to the previous point
+    this->PaintStrokeStartPointIds->InsertNextId(this->PaintCoordinates_World->GetNumberOfPoints());
+  }
+  else
   {
     double strokeLength = sqrt(vtkMath::Distance2BetweenPoints(brushPosition_World, lastBrushPosition_World));
     double maximumDistanceBetweenPoints = this->MaximumPointDistanceInStroke * q->doubleParameter("BrushAbsoluteDiameter");
@@ -368,55 +362,51 @@ void qSlicerSegmentEditorPaintEffectPrivate::paintAddPoint(qMRMLWidget* viewWidg
 }
 
 //-----------------------------------------------------------------------------
-void qSlicerSegmentEditorPaintEffectPrivate::updateBrushStencil(qMRMLWidget* viewWidget)
+bool qSlicerSegmentEditorPaintEffectPrivate::updateBrushRasterizer(qMRMLWidget* viewWidget, vtkOrientedImageData* labelmap)
 {
   Q_Q(qSlicerSegmentEditorPaintEffect);
-  Q_UNUSED(viewWidget);
 
   if (!q->parameterSetNode())
   {
     qCritical() << Q_FUNC_INFO << ": Invalid segment editor parameter set node!";
-    return;
+    return false;
   }
   vtkMRMLSegmentationNode* segmentationNode = q->parameterSetNode()->GetSegmentationNode();
   if (!segmentationNode)
   {
     qCritical() << Q_FUNC_INFO << ": Invalid segmentationNode";
-    return;
+    return false;
   }
-  vtkOrientedImageData* modifierLabelmap = q->modifierLabelmap();
-  if (!modifierLabelmap)
+  if (!labelmap)
   {
-    qCritical() << Q_FUNC_INFO << ": Invalid modifierLabelmap";
-    return;
+    qCritical() << Q_FUNC_INFO << ": Invalid labelmap";
+    return false;
   }
 
-  // Brush stencil transform
-
-  this->WorldOriginToModifierLabelmapIjkTransform->Identity();
-
-  vtkNew<vtkMatrix4x4> segmentationToSegmentationIjkTransformMatrix;
-  modifierLabelmap->GetImageToWorldMatrix(segmentationToSegmentationIjkTransformMatrix.GetPointer());
-  segmentationToSegmentationIjkTransformMatrix->Invert();
-  segmentationToSegmentationIjkTransformMatrix->SetElement(0,3, 0);
-  segmentationToSegmentationIjkTransformMatrix->SetElement(1,3, 0);
-  segmentationToSegmentationIjkTransformMatrix->SetElement(2,3, 0);
-  this->WorldOriginToModifierLabelmapIjkTransform->Concatenate(segmentationToSegmentationIjkTransformMatrix.GetPointer());
+  // Brush shape (same as the brush model, see updateBrushModel)
+  double diameterMm = q->doubleParameter("BrushAbsoluteDiameter");
+  this->BrushRasterizer->SetBrushRadius(diameterMm / 2.0);
+  qMRMLSliceWidget* sliceWidget = qobject_cast<qMRMLSliceWidget*>(viewWidget);
+  if (!sliceWidget || q->integerParameter("BrushSphere"))
+  {
+    this->BrushRasterizer->SetBrushShapeToSphere();
+  }
+  else
+  {
+    this->BrushRasterizer->SetBrushShapeToCylinder();
+    this->BrushRasterizer->SetBrushHeight(qSlicerSegmentEditorAbstractEffect::sliceSpacing(sliceWidget));
+    // cylinder axis is the slice normal
+    vtkMatrix4x4* sliceToRAS = sliceWidget->sliceLogic()->GetSliceNode()->GetSliceToRAS();
+    this->BrushRasterizer->SetBrushAxis(sliceToRAS->GetElement(0, 2), sliceToRAS->GetElement(1, 2), sliceToRAS->GetElement(2, 2));
+  }
+  this->BrushRasterizer->SetFillValue(q->m_FillValue);
 
-  vtkNew<vtkMatrix4x4> worldToSegmentationTransformMatrix;
   // We don't support painting in non-linearly transformed node (it could be implemented, but would probably slow down things too much)
   // TODO: show a meaningful error message to the user if attempted
-  vtkMRMLTransformNode::GetMatrixTransformBetweenNodes(nullptr, segmentationNode->GetParentTransformNode(), worldToSegmentationTransformMatrix.GetPointer());
-  worldToSegmentationTransformMatrix->SetElement(0,3, 0);
-  worldToSegmentationTransformMatrix->SetElement(1,3, 0);
-  worldToSegmentationTransformMatrix->SetElement(2,3, 0);
-  this->WorldOriginToModifierLabelmapIjkTransform->Concatenate(worldToSegmentationTransformMatrix.GetPointer());
-
-  this->WorldOriginToModifierLabelmapIjkTransformer->Update();
-  vtkPolyData* brushModel_ModifierLabelmapIjk = this->WorldOriginToModifierLabelmapIjkTransformer->GetOutput();
-  double* boundsIjk = brushModel_ModifierLabelmapIjk->GetBounds();
-  this->BrushPolyDataToStencil->SetOutputWholeExtent(floor(boundsIjk[0])-1, ceil(boundsIjk[1])+1,
-    floor(boundsIjk[2])-1, ceil(boundsIjk[3])+1, floor(boundsIjk[4])-1, ceil(boundsIjk[5])+1);
+  vtkNew<vtkMatrix4x4> segmentationToWorldTransformMatrix;
+  vtkMRMLTransformNode::GetMatrixTransformBetweenNodes(segmentationNode->GetParentTransformNode(), nullptr, segmentationToWorldTransformMatrix.GetPointer());
+  this->BrushRasterizer->SetLabelmapToWorldMatrix(segmentationToWorldTransformMatrix);
+  return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -523,73 +513,23 @@ void qSlicerSegmentEditorPaintEffectPrivate::paintBrushes(
   int updateExtent[6])
 {
   Q_UNUSED(pixelPositions_World);
-  Q_Q(qSlicerSegmentEditorPaintEffect);
-
-  this->updateBrushStencil(viewWidget);
 
   if (!modifierLabelmap)
   {
     return;
   }
-
-  vtkMRMLSegmentationNode* segmentationNode = q->parameterSetNode()->GetSegmentationNode();
-  if (!segmentationNode)
+  if (!this->updateBrushRasterizer(viewWidget, modifierLabelmap))
   {
-    qCritical() << Q_FUNC_INFO << ": Invalid segmentationNode";
     return;
   }
 
-  this->BrushPolyDataToStencil->Update();
-  vtkImageStencilData* stencilData = this->BrushPolyDataToStencil->GetOutput();
-  int stencilExtent[6]={0,-1,0,-1,0,-1};
-  stencilData->GetExtent(stencilExtent);
-
-  vtkNew<vtkPoints> paintCoordinates_Ijk;
-  this->transformPointsFromWorldToIJK(modifierLabelmap, segmentationNode, this->PaintCoordinates_World, paintCoordinates_Ijk);
-
-  vtkNew<vtkImageStencilToImage> stencilToImage;
-  stencilToImage->SetInputConnection(this->BrushPolyDataToStencil->GetOutputPort());
-  stencilToImage->SetInsideValue(q->m_FillValue);
-  stencilToImage->SetOutsideValue(q->m_EraseValue);
-  stencilToImage->SetOutputScalarType(modifierLabelmap->GetScalarType());
-
-  vtkNew<vtkImageChangeInformation> brushPositioner;
-  brushPositioner->SetInputConnection(stencilToImage->GetOutputPort());
-  brushPositioner->SetOutputSpacing(modifierLabelmap->GetSpacing());
-  brushPositioner->SetOutputOrigin(modifierLabelmap->GetOrigin());
-
-  vtkIdType numberOfPoints = this->PaintCoordinates_World->GetNumberOfPoints();
-  for (int pointIndex = 0; pointIndex < numberOfPoints; pointIndex++)
+  // The brush is swept along the stroke directly in the labelmap voxels
+  int modifiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  this->BrushRasterizer->Paint(modifierLabelmap, this->PaintCoordinates_World, this->PaintStrokeStartPointIds, modifiedExtent);
+  if (updateExtent)
   {
-    double* shiftDouble = paintCoordinates_Ijk->GetPoint(pointIndex);
-    int shift[3] = {vtkMath::Round(shiftDouble[0]), vtkMath::Round(shiftDouble[1]), vtkMath::Round(shiftDouble[2])};
-    brushPositioner->SetExtentTranslation(shift);
-    brushPositioner->Update();
-    vtkNew<vtkOrientedImageData> orientedBrushPositionerOutput;
-    orientedBrushPositionerOutput->ShallowCopy(brushPositioner->GetOutput());
-    orientedBrushPositionerOutput->CopyDirections(modifierLabelmap);
-    if (pointIndex == 0)
-    {
-      orientedBrushPositionerOutput->GetExtent(updateExtent);
-    }
-    else
-    {
-      int* brushExtent = orientedBrushPositionerOutput->GetExtent();
-      for (int i = 0; i < 3; i++)
-      {
-        if (brushExtent[i * 2] < updateExtent[i * 2])
-        {
-          updateExtent[i * 2] = brushExtent[i * 2];
-        }
-        if (brushExtent[i * 2 + 1] > updateExtent[i * 2 + 1])
-        {
-          updateExtent[i * 2 + 1] = brushExtent[i * 2 + 1];
-        }
-      }
-    }
-    vtkOrientedImageDataResample::ModifyImage(modifierLabelmap, orientedBrushPositionerOutput.GetPointer(), vtkOrientedImageDataResample::OPERATION_MAXIMUM);
+    std::copy(modifiedExtent, modifiedExtent + 6, updateExtent);
   }
-  modifierLabelmap->Modified();
 }
 
 //-----------------------------------------------------------------------------
@@ -1014,6 +954,7 @@ void qSlicerSegmentEditorPaintEffect::deactivate()
   d->IsPainting = false;
   d->clearBrushPipelines();
   d->PaintCoordinates_World->Reset();
+  d->PaintStrokeStartPointIds->Reset();
   d->ActiveViewWidget = nullptr;
 }
 
@@ -1774,6 +1715,7 @@ void qSlicerSegmentEditorPaintEffect::paintApply(qMRMLWidget* viewWidget)
   // "No input data"
   d->clearBrushPipelines();
   d->PaintCoordinates_World->Reset();
+  d->PaintStrokeStartPointIds->Reset();
 }
 
 //-----------------------------------------------------------------------------
@@ -1798,6 +1740,7 @@ void qSlicerSegmentEditorPaintEffect::clearBrushes()
   // "No input data"
   d->clearBrushPipelines();
   d->PaintCoordinates_World->Reset();
+  d->PaintStrokeStartPointIds->Reset();
 }
 
 //-----------------------------------------------------------------------------
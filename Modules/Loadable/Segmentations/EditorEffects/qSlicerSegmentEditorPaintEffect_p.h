@@ -37,9 +37,13 @@
 
 #include "qSlicerSegmentEditorPaintEffect.h"
 
+// Segmentations includes
+#include "vtkImageBrushStrokeRasterizer.h"
+
 // VTK includes
 #include <vtkCutter.h>
 #include <vtkCylinderSource.h>
+#include <vtkIdList.h>
 #include <vtkSmartPointer.h>
 #include <vtkSphereSource.h>
 #include <vtkTransform.h>
@@ -64,7 +68,6 @@ class vtkActor2D;
 class vtkGlyph3D;
 class vtkPoints;
 class vtkPolyDataNormals;
-class vtkPolyDataToImageStencil;
 
 /// \brief Private implementation of the segment editor paint effect
 class qSlicerSegmentEditorPaintEffectPrivate: public QObject
@@ -93,9 +96,9 @@ public:
   /// Update brush model (shape and position)
   void updateBrushModel(qMRMLWidget* viewWidget, double brushPosition_World[3]);
 
-  /// Updates the brush stencil that can be used to quickly paint the brush shape into
-  /// modifierLabelmap at many different positions.
-  void updateBrushStencil(qMRMLWidget* viewWidget);
+  /// Updates brush shape and labelmap geometry in the brush rasterizer
+  /// that is used for painting the brush stroke into a labelmap.
+  bool updateBrushRasterizer(qMRMLWidget* viewWidget, vtkOrientedImageData* labelmap);
 
 protected:
   /// Get brush object for widget. Create if does not exist
@@ -142,13 +145,13 @@ public:
   vtkSmartPointer<vtkTransformPolyDataFilter> WorldOriginToWorldTransformer;
   vtkSmartPointer<vtkTransform> WorldOriginToWorldTransform;
   vtkSmartPointer<vtkPolyDataNormals> BrushPolyDataNormals;
-  vtkSmartPointer<vtkTransformPolyDataFilter> WorldOriginToModifierLabelmapIjkTransformer;
-  vtkSmartPointer<vtkTransform> WorldOriginToModifierLabelmapIjkTransform; // transforms from polydata source to modifierLabelmap's IJK coordinate system (brush origin in IJK origin)
-  vtkSmartPointer<vtkPolyDataToImageStencil> BrushPolyDataToStencil;
+  vtkSmartPointer<vtkImageBrushStrokeRasterizer> BrushRasterizer;
 
   vtkSmartPointer<vtkGlyph3D> FeedbackGlyphFilter;
 
   vtkSmartPointer<vtkPoints> PaintCoordinates_World;
+  /// Indices of points in PaintCoordinates_World that are not connected to the previous point
+  vtkSmartPointer<vtkIdList> PaintStrokeStartPointIds;
   vtkSmartPointer<vtkPolyData> FeedbackPointsPolyData;
 
   /// If a new point is added at less than this squared distance
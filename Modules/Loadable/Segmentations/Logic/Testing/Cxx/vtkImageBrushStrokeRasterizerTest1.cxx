@@ -0,0 +1,432 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Segmentations includes
+#include "vtkImageBrushStrokeRasterizer.h"
+
+// SegmentationCore includes
+#include "vtkOrientedImageData.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkCylinderSource.h>
+#include <vtkDataArray.h>
+#include <vtkIdList.h>
+#include <vtkImageStencilData.h>
+#include <vtkLine.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataToImageStencil.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+#include <vtkTransform.h>
+#include <vtkTransformPolyDataFilter.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+const double BrushRadius = 4.5;
+const double SliceSpacing = 1.5;
+
+//----------------------------------------------------------------------------
+/// Anisotropic labelmap with oblique axes
+vtkSmartPointer<vtkOrientedImageData> CreateLabelmap()
+{
+  vtkSmartPointer<vtkOrientedImageData> labelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+  labelmap->SetExtent(0, 59, 0, 59, 0, 23);
+  labelmap->SetSpacing(0.8, 1.0, 2.5);
+  labelmap->SetOrigin(-20.0, 15.0, -30.0);
+  vtkNew<vtkTransform> directions;
+  directions->RotateWXYZ(30.0, 1.0, 1.0, 0.0);
+  labelmap->SetDirectionMatrix(directions->GetMatrix());
+  labelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  labelmap->GetPointData()->GetScalars()->Fill(0);
+  return labelmap;
+}
+
+//----------------------------------------------------------------------------
+/// Slice plane orientation that is not aligned with the labelmap axes
+void GetSliceToWorldMatrix(vtkOrientedImageData* labelmap, vtkMatrix4x4* sliceToWorld)
+{
+  vtkNew<vtkTransform> sliceToWorldTransform;
+  sliceToWorldTransform->RotateZ(35.0);
+  sliceToWorldTransform->RotateX(20.0);
+  sliceToWorld->DeepCopy(sliceToWorldTransform->GetMatrix());
+  // Slice plane goes through the center of the labelmap
+  vtkNew<vtkMatrix4x4> ijkToWorld;
+  labelmap->GetImageToWorldMatrix(ijkToWorld);
+  int* extent = labelmap->GetExtent();
+  double centerIjk[4] = { (extent[0] + extent[1]) / 2.0, (extent[2] + extent[3]) / 2.0, (extent[4] + extent[5]) / 2.0, 1.0 };
+  double centerWorld[4] = { 0.0, 0.0, 0.0, 1.0 };
+  ijkToWorld->MultiplyPoint(centerIjk, centerWorld);
+  for (int i = 0; i < 3; i++)
+  {
+    sliceToWorld->SetElement(i, 3, centerWorld[i]);
+  }
+}
+
+//----------------------------------------------------------------------------
+/// Stroke control points in slice coordinates. The second stroke is not connected to the first one.
+void GetStrokes(vtkMatrix4x4* sliceToWorld, std::vector<std::vector<std::vector<double>>>& strokes_World)
+{
+  const double strokes_Slice[2][3][2] =
+  {
+    { { -12.0, -8.0 }, { 3.0, -2.5 }, { 6.0, 9.0 } },
+    { { -10.0, 10.0 }, { -4.0, 11.0 }, { -4.0, 11.0 } }
+  };
+  strokes_World.clear();
+  for (int strokeIndex = 0; strokeIndex < 2; strokeIndex++)
+  {
+    std::vector<std::vector<double>> stroke;
+    for (int pointIndex = 0; pointIndex < 3; pointIndex++)
+    {
+      double point_Slice[4] = { strokes_Slice[strokeIndex][pointIndex][0], strokes_Slice[strokeIndex][pointIndex][1], 0.0, 1.0 };
+      double point_World[4] = { 0.0, 0.0, 0.0, 1.0 };
+      sliceToWorld->MultiplyPoint(point_Slice, point_World);
+      stroke.push_back(std::vector<double>(point_World, point_World + 3));
+    }
+    strokes_World.push_back(stroke);
+  }
+}
+
+//----------------------------------------------------------------------------
+/// Densely sampled stroke points, as they are recorded by the paint effect while the mouse is moved
+void GetStrokePoints(const std::vector<std::vector<std::vector<double>>>& strokes_World,
+  vtkPoints* strokePoints_World, vtkIdList* strokeStartPointIds)
+{
+  const double pointSpacing = 0.2;
+  for (const std::vector<std::vector<double>>& stroke : strokes_World)
+  {
+    strokeStartPointIds->InsertNextId(strokePoints_World->GetNumberOfPoints());
+    strokePoints_World->InsertNextPoint(stroke[0].data());
+    for (size_t pointIndex = 1; pointIndex < stroke.size(); pointIndex++)
+    {
+      const double* start = stroke[pointIndex - 1].data();
+      const double* end = stroke[pointIndex].data();
+      int numberOfSteps = std::max(1, static_cast<int>(std::ceil(sqrt(vtkMath::Distance2BetweenPoints(start, end)) / pointSpacing)));
+      for (int step = 1; step <= numberOfSteps; step++)
+      {
+        double t = static_cast<double>(step) / numberOfSteps;
+        strokePoints_World->InsertNextPoint(start[0] + t * (end[0] - start[0]),
+          start[1] + t * (end[1] - start[1]), start[2] + t * (end[2] - start[2]));
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+double DistanceToSegment(const double point[3], const double start[3], const double end[3])
+{
+  double t = 0.0;
+  double closestPoint[3] = { 0.0, 0.0, 0.0 };
+  return sqrt(vtkLine::DistanceToLine(point, start, end, t, closestPoint));
+}
+
+//----------------------------------------------------------------------------
+/// Signed distance from the surface of the brush swept along the strokes (negative inside).
+/// For cylinder brush it is only exact at the sign change, which is sufficient for the test.
+double GetSignedDistance(const double point_World[3], bool cylinder, vtkMatrix4x4* sliceToWorld,
+  const std::vector<std::vector<std::vector<double>>>& strokes_World)
+{
+  double pointToSlice[3] = { 0.0, 0.0, 0.0 };
+  double normal[3] = { sliceToWorld->GetElement(0, 2), sliceToWorld->GetElement(1, 2), sliceToWorld->GetElement(2, 2) };
+  double sliceOrigin[3] = { sliceToWorld->GetElement(0, 3), sliceToWorld->GetElement(1, 3), sliceToWorld->GetElement(2, 3) };
+  vtkMath::Subtract(point_World, sliceOrigin, pointToSlice);
+  double distanceAlongNormal = vtkMath::Dot(pointToSlice, normal);
+  double projectedPoint_World[3] = { point_World[0], point_World[1], point_World[2] };
+  if (cylinder)
+  {
+    // Strokes are in the slice plane, therefore the in-plane distance is computed from the projected point
+    for (int i = 0; i < 3; i++)
+    {
+      projectedPoint_World[i] -= distanceAlongNormal * normal[i];
+    }
+  }
+  double distance = VTK_DOUBLE_MAX;
+  for (const std::vector<std::vector<double>>& stroke : strokes_World)
+  {
+    for (size_t pointIndex = 1; pointIndex < stroke.size(); pointIndex++)
+    {
+      distance = std::min(distance, DistanceToSegment(projectedPoint_World, stroke[pointIndex - 1].data(), stroke[pointIndex].data()));
+    }
+  }
+  double signedDistance = distance - BrushRadius;
+  if (cylinder)
+  {
+    signedDistance = std::max(signedDistance, std::fabs(distanceAlongNormal) - SliceSpacing / 2.0);
+  }
+  return signedDistance;
+}
+
+//----------------------------------------------------------------------------
+void GetVoxelPosition(vtkMatrix4x4* ijkToWorld, int i, int j, int k, double point_World[3])
+{
+  double point_Ijk[4] = { static_cast<double>(i), static_cast<double>(j), static_cast<double>(k), 1.0 };
+  double point4_World[4] = { 0.0, 0.0, 0.0, 1.0 };
+  ijkToWorld->MultiplyPoint(point_Ijk, point4_World);
+  std::copy(point4_World, point4_World + 3, point_World);
+}
+
+//----------------------------------------------------------------------------
+/// Previous implementation of the paint effect: the brush polydata is converted to a stencil
+/// in the voxel coordinate system, which is then stamped at each stroke point (rounded to the nearest voxel).
+void PaintWithBrushStencil(vtkOrientedImageData* labelmap, bool cylinder, vtkMatrix4x4* sliceToWorld,
+  vtkPoints* strokePoints_World)
+{
+  vtkSmartPointer<vtkPolyData> brushModel;
+  if (cylinder)
+  {
+    vtkNew<vtkCylinderSource> cylinderSource;
+    cylinderSource->SetRadius(BrushRadius);
+    cylinderSource->SetResolution(32);
+    cylinderSource->SetHeight(SliceSpacing);
+    cylinderSource->Update();
+    brushModel = cylinderSource->GetOutput();
+  }
+  else
+  {
+    vtkNew<vtkSphereSource> sphereSource;
+    sphereSource->SetRadius(BrushRadius);
+    sphereSource->SetPhiResolution(32);
+    sphereSource->SetThetaResolution(32);
+    sphereSource->Update();
+    brushModel = sphereSource->GetOutput();
+  }
+
+  vtkNew<vtkMatrix4x4> worldToIjk;
+  labelmap->GetWorldToImageMatrix(worldToIjk);
+  vtkNew<vtkTransform> brushToIjkTransform;
+  brushToIjkTransform->Concatenate(worldToIjk);
+  vtkNew<vtkMatrix4x4> sliceToWorldRotation;
+  sliceToWorldRotation->DeepCopy(sliceToWorld);
+  for (int i = 0; i < 3; i++)
+  {
+    sliceToWorldRotation->SetElement(i, 3, 0.0);
+  }
+  brushToIjkTransform->Concatenate(sliceToWorldRotation);
+  brushToIjkTransform->RotateX(90); // cylinder's long axis is the Y axis, we need to rotate it to Z axis
+  vtkNew<vtkMatrix4x4> brushToIjkMatrix;
+  brushToIjkMatrix->DeepCopy(brushToIjkTransform->GetMatrix());
+  for (int i = 0; i < 3; i++)
+  {
+    brushToIjkMatrix->SetElement(i, 3, 0.0);
+  }
+  vtkNew<vtkTransform> brushToIjkLinearTransform;
+  brushToIjkLinearTransform->SetMatrix(brushToIjkMatrix);
+  vtkNew<vtkTransformPolyDataFilter> brushTransformer;
+  brushTransformer->SetInputData(brushModel);
+  brushTransformer->SetTransform(brushToIjkLinearTransform);
+  brushTransformer->Update();
+
+  double* boundsIjk = brushTransformer->GetOutput()->GetBounds();
+  vtkNew<vtkPolyDataToImageStencil> brushToStencil;
+  brushToStencil->SetOutputSpacing(1.0, 1.0, 1.0);
+  brushToStencil->SetOutputOrigin(0.0, 0.0, 0.0);
+  brushToStencil->SetOutputWholeExtent(floor(boundsIjk[0]) - 1, ceil(boundsIjk[1]) + 1,
+    floor(boundsIjk[2]) - 1, ceil(boundsIjk[3]) + 1, floor(boundsIjk[4]) - 1, ceil(boundsIjk[5]) + 1);
+  brushToStencil->SetInputConnection(brushTransformer->GetOutputPort());
+  brushToStencil->Update();
+  vtkImageStencilData* stencil = brushToStencil->GetOutput();
+  int stencilExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  stencil->GetExtent(stencilExtent);
+
+  int* extent = labelmap->GetExtent();
+  for (vtkIdType pointIndex = 0; pointIndex < strokePoints_World->GetNumberOfPoints(); pointIndex++)
+  {
+    double point_World[4] = { 0.0, 0.0, 0.0, 1.0 };
+    strokePoints_World->GetPoint(pointIndex, point_World);
+    double point_Ijk[4] = { 0.0, 0.0, 0.0, 1.0 };
+    worldToIjk->MultiplyPoint(point_World, point_Ijk);
+    int shift[3] = { vtkMath::Round(point_Ijk[0]), vtkMath::Round(point_Ijk[1]), vtkMath::Round(point_Ijk[2]) };
+    for (int k = stencilExtent[4]; k <= stencilExtent[5]; k++)
+    {
+      for (int j = stencilExtent[2]; j <= stencilExtent[3]; j++)
+      {
+        for (int i = stencilExtent[0]; i <= stencilExtent[1]; i++)
+        {
+          int voxel[3] = { i + shift[0], j + shift[1], k + shift[2] };
+          if (voxel[0] < extent[0] || voxel[0] > extent[1] || voxel[1] < extent[2] || voxel[1] > extent[3]
+            || voxel[2] < extent[4] || voxel[2] > extent[5] || !stencil->IsInside(i, j, k))
+          {
+            continue;
+          }
+          *static_cast<unsigned char*>(labelmap->GetScalarPointer(voxel)) = 1;
+        }
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+int TestStroke(bool cylinder)
+{
+  vtkSmartPointer<vtkOrientedImageData> labelmap = CreateLabelmap();
+  vtkNew<vtkMatrix4x4> sliceToWorld;
+  GetSliceToWorldMatrix(labelmap, sliceToWorld);
+  std::vector<std::vector<std::vector<double>>> strokes_World;
+  GetStrokes(sliceToWorld, strokes_World);
+  vtkNew<vtkPoints> strokePoints_World;
+  vtkNew<vtkIdList> strokeStartPointIds;
+  GetStrokePoints(strokes_World, strokePoints_World, strokeStartPointIds);
+
+  // Voxels outside the brush must not be changed
+  int* extent = labelmap->GetExtent();
+  *static_cast<unsigned char*>(labelmap->GetScalarPointer(extent[0], extent[2], extent[4])) = 5;
+  *static_cast<unsigned char*>(labelmap->GetScalarPointer(extent[1], extent[3], extent[5])) = 5;
+
+  vtkNew<vtkImageBrushStrokeRasterizer> rasterizer;
+  rasterizer->SetBrushRadius(BrushRadius);
+  if (cylinder)
+  {
+    rasterizer->SetBrushShapeToCylinder();
+    rasterizer->SetBrushHeight(SliceSpacing);
+    rasterizer->SetBrushAxis(sliceToWorld->GetElement(0, 2), sliceToWorld->GetElement(1, 2), sliceToWorld->GetElement(2, 2));
+  }
+  else
+  {
+    rasterizer->SetBrushShapeToSphere();
+  }
+  int modifiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  rasterizer->Paint(labelmap, strokePoints_World, strokeStartPointIds, modifiedExtent);
+
+  CHECK_INT(*static_cast<unsigned char*>(labelmap->GetScalarPointer(extent[0], extent[2], extent[4])), 5);
+  CHECK_INT(*static_cast<unsigned char*>(labelmap->GetScalarPointer(extent[1], extent[3], extent[5])), 5);
+  *static_cast<unsigned char*>(labelmap->GetScalarPointer(extent[0], extent[2], extent[4])) = 0;
+  *static_cast<unsigned char*>(labelmap->GetScalarPointer(extent[1], extent[3], extent[5])) = 0;
+
+  vtkSmartPointer<vtkOrientedImageData> previousLabelmap = CreateLabelmap();
+  PaintWithBrushStencil(previousLabelmap, cylinder, sliceToWorld, strokePoints_World);
+
+  // Previous implementation snapped the brush to the voxel grid and approximated it by a polygonal model,
+  // therefore results may differ near the brush surface (by up to half voxel diagonal).
+  double* spacing = labelmap->GetSpacing();
+  double tolerance = 0.5 * sqrt(vtkMath::Dot(spacing, spacing)) + 0.02 * BrushRadius;
+
+  vtkNew<vtkMatrix4x4> ijkToWorld;
+  labelmap->GetImageToWorldMatrix(ijkToWorld);
+  int numberOfFilledVoxels = 0;
+  int numberOfPreviouslyFilledVoxels = 0;
+  int numberOfCommonFilledVoxels = 0;
+  for (int k = extent[4]; k <= extent[5]; k++)
+  {
+    for (int j = extent[2]; j <= extent[3]; j++)
+    {
+      for (int i = extent[0]; i <= extent[1]; i++)
+      {
+        double point_World[3] = { 0.0, 0.0, 0.0 };
+        GetVoxelPosition(ijkToWorld, i, j, k, point_World);
+        double signedDistance = GetSignedDistance(point_World, cylinder, sliceToWorld, strokes_World);
+        bool filled = (*static_cast<unsigned char*>(labelmap->GetScalarPointer(i, j, k)) != 0);
+        bool previouslyFilled = (*static_cast<unsigned char*>(previousLabelmap->GetScalarPointer(i, j, k)) != 0);
+        numberOfFilledVoxels += (filled ? 1 : 0);
+        numberOfPreviouslyFilledVoxels += (previouslyFilled ? 1 : 0);
+
+        // Voxels are filled if their center is in the swept brush
+        if (std::fabs(signedDistance) > 1e-6 && filled != (signedDistance < 0))
+        {
+          std::cerr << "Voxel (" << i << ", " << j << ", " << k << ") is " << (filled ? "filled" : "not filled")
+            << ", but its signed distance from the brush surface is " << signedDistance << std::endl;
+          return EXIT_FAILURE;
+        }
+        // Filled voxels are within the modified extent
+        if (filled && (i < modifiedExtent[0] || i > modifiedExtent[1] || j < modifiedExtent[2] || j > modifiedExtent[3]
+          || k < modifiedExtent[4] || k > modifiedExtent[5]))
+        {
+          std::cerr << "Filled voxel (" << i << ", " << j << ", " << k << ") is outside of the modified extent" << std::endl;
+          return EXIT_FAILURE;
+        }
+        // Same result as the previous implementation, except near the surface
+        if (filled != previouslyFilled && std::fabs(signedDistance) > tolerance)
+        {
+          std::cerr << "Voxel (" << i << ", " << j << ", " << k << ") is " << (filled ? "filled" : "not filled")
+            << ", but it was " << (previouslyFilled ? "filled" : "not filled") << " by the previous implementation."
+            << " Signed distance from brush surface: " << signedDistance << std::endl;
+          return EXIT_FAILURE;
+        }
+        numberOfCommonFilledVoxels += (filled && previouslyFilled ? 1 : 0);
+      }
+    }
+  }
+  std::cout << (cylinder ? "Cylinder" : "Sphere") << " brush: " << numberOfFilledVoxels << " voxels filled ("
+    << numberOfPreviouslyFilledVoxels << " by previous implementation)" << std::endl;
+  // Make sure that the comparison is meaningful
+  CHECK_BOOL(numberOfFilledVoxels > 0, true);
+  CHECK_BOOL(numberOfCommonFilledVoxels > 0, true);
+  if (!cylinder)
+  {
+    // Cylinder brush is thinner than the voxels, therefore most of its voxels are near the surface
+    CHECK_BOOL(numberOfCommonFilledVoxels > numberOfFilledVoxels / 2, true);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestStrokeStartPoints()
+{
+  vtkSmartPointer<vtkOrientedImageData> labelmap = CreateLabelmap();
+  vtkNew<vtkMatrix4x4> ijkToWorld;
+  labelmap->GetImageToWorldMatrix(ijkToWorld);
+  double start_World[3] = { 0.0, 0.0, 0.0 };
+  double end_World[3] = { 0.0, 0.0, 0.0 };
+  GetVoxelPosition(ijkToWorld, 10, 30, 12, start_World);
+  GetVoxelPosition(ijkToWorld, 50, 30, 12, end_World);
+
+  vtkNew<vtkPoints> strokePoints_World;
+  strokePoints_World->InsertNextPoint(start_World);
+  strokePoints_World->InsertNextPoint(end_World);
+
+  vtkNew<vtkImageBrushStrokeRasterizer> rasterizer;
+  rasterizer->SetBrushRadius(2.0);
+  rasterizer->SetFillValue(3);
+  int modifiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+
+  // Two separate strokes: the segment between them is not painted
+  vtkNew<vtkIdList> strokeStartPointIds;
+  strokeStartPointIds->InsertNextId(1);
+  rasterizer->Paint(labelmap, strokePoints_World, strokeStartPointIds, modifiedExtent);
+  CHECK_INT(*static_cast<unsigned char*>(labelmap->GetScalarPointer(10, 30, 12)), 3);
+  CHECK_INT(*static_cast<unsigned char*>(labelmap->GetScalarPointer(50, 30, 12)), 3);
+  CHECK_INT(*static_cast<unsigned char*>(labelmap->GetScalarPointer(30, 30, 12)), 0);
+
+  // Single stroke: the segment is painted
+  rasterizer->Paint(labelmap, strokePoints_World, nullptr, modifiedExtent);
+  CHECK_INT(*static_cast<unsigned char*>(labelmap->GetScalarPointer(30, 30, 12)), 3);
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImageBrushStrokeRasterizerTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  CHECK_EXIT_SUCCESS(TestStroke(false));
+  CHECK_EXIT_SUCCESS(TestStroke(true));
+  CHECK_EXIT_SUCCESS(TestStrokeStartPoints());
+  return EXIT_SUCCESS;
+}
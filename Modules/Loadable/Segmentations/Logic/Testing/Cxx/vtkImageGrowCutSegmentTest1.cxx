@@ -0,0 +1,423 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Segmentations includes
+#include "vtkImageGrowCutSegment.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace
+{
+
+// The volume is thicker than the block size of the filter (16 slices)
+// so that propagation between blocks is tested.
+const int DimX = 30;
+const int DimY = 26;
+const int DimZ = 40;
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> CreateImage(int scalarType)
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(DimX, DimY, DimZ);
+  image->SetSpacing(1.0, 1.2, 2.0);
+  image->SetOrigin(10.0, -5.0, 3.0);
+  image->AllocateScalars(scalarType, 1);
+  return image;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType GetIndex(int x, int y, int z)
+{
+  return x + DimX * (y + static_cast<vtkIdType>(DimY) * z);
+}
+
+//----------------------------------------------------------------------------
+/// Two bright blobs on a dark background, with noise.
+/// Noise is not quantized so that there are no ties between path lengths of different labels.
+vtkSmartPointer<vtkImageData> CreateIntensityVolume()
+{
+  vtkSmartPointer<vtkImageData> image = CreateImage(VTK_FLOAT);
+  float* ptr = static_cast<float*>(image->GetScalarPointer());
+  std::mt19937 randomGenerator(12345);
+  std::uniform_real_distribution<float> noise(0.0f, 10.0f);
+  for (int z = 0; z < DimZ; z++)
+  {
+    for (int y = 0; y < DimY; y++)
+    {
+      for (int x = 0; x < DimX; x++)
+      {
+        float value = 0.0f;
+        if ((x - 10) * (x - 10) + (y - 12) * (y - 12) + (z - 14) * (z - 14) < 36)
+        {
+          value = 100.0f;
+        }
+        else if ((x - 20) * (x - 20) + (y - 14) * (y - 14) + (z - 28) * (z - 28) < 49)
+        {
+          value = 50.0f;
+        }
+        ptr[GetIndex(x, y, z)] = value + noise(randomGenerator);
+      }
+    }
+  }
+  return image;
+}
+
+//----------------------------------------------------------------------------
+/// Mask that excludes voxels outside the [minimumIntensity, maximumIntensity] range,
+/// the same way as the intensity range option of segment editor effects.
+void UpdateIntensityRangeMask(vtkImageData* intensityVolume, vtkImageData* mask,
+  float minimumIntensity, float maximumIntensity)
+{
+  const float* intensityPtr = static_cast<float*>(intensityVolume->GetScalarPointer());
+  unsigned char* maskPtr = static_cast<unsigned char*>(mask->GetScalarPointer());
+  for (vtkIdType index = 0; index < static_cast<vtkIdType>(DimX) * DimY * DimZ; index++)
+  {
+    maskPtr[index] = (intensityPtr[index] < minimumIntensity || intensityPtr[index] > maximumIntensity) ? 1 : 0;
+  }
+  mask->Modified();
+}
+
+//----------------------------------------------------------------------------
+void SetSeed(vtkImageData* seeds, int x, int y, int z, int radius, short label)
+{
+  for (int dz = -radius; dz <= radius; dz++)
+  {
+    for (int dy = -radius; dy <= radius; dy++)
+    {
+      for (int dx = -radius; dx <= radius; dx++)
+      {
+        static_cast<short*>(seeds->GetScalarPointer())[GetIndex(x + dx, y + dy, z + dz)] = label;
+      }
+    }
+  }
+  seeds->Modified();
+}
+
+//----------------------------------------------------------------------------
+/// Straightforward Dijkstra shortest path computation from the seeds of a single label,
+/// using the same neighborhood and cost function as the filter.
+/// Voxels at the image boundary get labels but do not propagate them.
+void ComputeReferenceDistances(vtkImageData* intensityVolume, vtkImageData* seeds, vtkImageData* mask,
+  double distancePenalty, short label, std::vector<double>& distances)
+{
+  const float* intensityPtr = static_cast<float*>(intensityVolume->GetScalarPointer());
+  const short* seedPtr = static_cast<short*>(seeds->GetScalarPointer());
+  const unsigned char* maskPtr = mask ? static_cast<unsigned char*>(mask->GetScalarPointer()) : nullptr;
+  double* spacing = intensityVolume->GetSpacing();
+  const vtkIdType numberOfVoxels = static_cast<vtkIdType>(DimX) * DimY * DimZ;
+
+  distances.assign(numberOfVoxels, std::numeric_limits<double>::infinity());
+  typedef std::pair<double, vtkIdType> QueueItem;
+  std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+  for (vtkIdType index = 0; index < numberOfVoxels; index++)
+  {
+    if (seedPtr[index] == label && !(maskPtr && maskPtr[index]))
+    {
+      distances[index] = 0.0;
+      queue.push(QueueItem(0.0, index));
+    }
+  }
+  while (!queue.empty())
+  {
+    QueueItem item = queue.top();
+    queue.pop();
+    vtkIdType index = item.second;
+    if (item.first > distances[index])
+    {
+      continue;
+    }
+    int x = index % DimX;
+    int y = (index / DimX) % DimY;
+    int z = static_cast<int>(index / (static_cast<vtkIdType>(DimX) * DimY));
+    if (x == 0 || y == 0 || z == 0 || x == DimX - 1 || y == DimY - 1 || z == DimZ - 1)
+    {
+      continue;
+    }
+    for (int dz = -1; dz <= 1; dz++)
+    {
+      for (int dy = -1; dy <= 1; dy++)
+      {
+        for (int dx = -1; dx <= 1; dx++)
+        {
+          vtkIdType neighborIndex = GetIndex(x + dx, y + dy, z + dz);
+          if (neighborIndex == index || (maskPtr && maskPtr[neighborIndex]))
+          {
+            continue;
+          }
+          double neighborDistance = distances[index] + std::fabs(intensityPtr[index] - intensityPtr[neighborIndex])
+            + distancePenalty * std::sqrt(dx * dx * spacing[0] * spacing[0]
+              + dy * dy * spacing[1] * spacing[1] + dz * dz * spacing[2] * spacing[2]);
+          if (neighborDistance < distances[neighborIndex])
+          {
+            distances[neighborIndex] = neighborDistance;
+            queue.push(QueueItem(neighborDistance, neighborIndex));
+          }
+        }
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+/// Compare the filter output with the label of the nearest seed computed by ComputeReferenceDistances.
+/// Voxels that are at almost the same distance from two different labels are not compared,
+/// as the filter computes distances in single precision.
+int CheckResult(vtkImageGrowCutSegment* filter, vtkImageData* intensityVolume, vtkImageData* seeds,
+  vtkImageData* mask, int line)
+{
+  vtkImageData* result = filter->GetOutput();
+  CHECK_NOT_NULL(result);
+  CHECK_INT(result->GetScalarType(), VTK_SHORT);
+  int* resultExtent = result->GetExtent();
+  int* seedExtent = seeds->GetExtent();
+  for (int i = 0; i < 6; i++)
+  {
+    CHECK_INT(resultExtent[i], seedExtent[i]);
+  }
+
+  const short* seedPtr = static_cast<short*>(seeds->GetScalarPointer());
+  const unsigned char* maskPtr = mask ? static_cast<unsigned char*>(mask->GetScalarPointer()) : nullptr;
+  const vtkIdType numberOfVoxels = static_cast<vtkIdType>(DimX) * DimY * DimZ;
+  std::set<short> labels;
+  for (vtkIdType index = 0; index < numberOfVoxels; index++)
+  {
+    if (seedPtr[index] != 0 && !(maskPtr && maskPtr[index]))
+    {
+      labels.insert(seedPtr[index]);
+    }
+  }
+
+  std::vector<std::vector<double>> labelDistances(labels.size());
+  std::vector<short> labelValues(labels.begin(), labels.end());
+  for (size_t labelIndex = 0; labelIndex < labelValues.size(); labelIndex++)
+  {
+    ComputeReferenceDistances(intensityVolume, seeds, mask, filter->GetDistancePenalty(),
+      labelValues[labelIndex], labelDistances[labelIndex]);
+  }
+
+  const short* resultPtr = static_cast<short*>(result->GetScalarPointer());
+  vtkIdType numberOfComparedVoxels = 0;
+  vtkIdType numberOfMismatches = 0;
+  for (vtkIdType index = 0; index < numberOfVoxels; index++)
+  {
+    short expectedLabel = 0;
+    double closestDistance = std::numeric_limits<double>::infinity();
+    double secondClosestDistance = std::numeric_limits<double>::infinity();
+    for (size_t labelIndex = 0; labelIndex < labelValues.size(); labelIndex++)
+    {
+      double distance = labelDistances[labelIndex][index];
+      if (distance < closestDistance)
+      {
+        secondClosestDistance = closestDistance;
+        closestDistance = distance;
+        expectedLabel = labelValues[labelIndex];
+      }
+      else if (distance < secondClosestDistance)
+      {
+        secondClosestDistance = distance;
+      }
+    }
+    if (maskPtr && maskPtr[index])
+    {
+      // masked voxels are never labeled
+      expectedLabel = 0;
+    }
+    else if (secondClosestDistance - closestDistance < 1e-3 * (1.0 + closestDistance))
+    {
+      continue;
+    }
+    numberOfComparedVoxels++;
+    if (resultPtr[index] != expectedLabel)
+    {
+      if (numberOfMismatches < 10)
+      {
+        std::cerr << "Line " << line << ": label mismatch at voxel (" << index % DimX << ", "
+          << (index / DimX) % DimY << ", " << index / (static_cast<vtkIdType>(DimX) * DimY) << "): expected "
+          << expectedLabel << ", got " << resultPtr[index] << std::endl;
+      }
+      numberOfMismatches++;
+    }
+  }
+  if (numberOfMismatches > 0)
+  {
+    std::cerr << "Line " << line << ": " << numberOfMismatches << " of " << numberOfComparedVoxels
+      << " voxels have incorrect label" << std::endl;
+    return EXIT_FAILURE;
+  }
+  // Make sure that the comparison is meaningful (almost all voxels are compared)
+  if (numberOfComparedVoxels < numberOfVoxels * 9 / 10)
+  {
+    std::cerr << "Line " << line << ": only " << numberOfComparedVoxels << " of " << numberOfVoxels
+      << " voxels could be compared" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestIncrementalSeedUpdates(double distancePenalty)
+{
+  vtkSmartPointer<vtkImageData> intensityVolume = CreateIntensityVolume();
+  vtkSmartPointer<vtkImageData> seeds = CreateImage(VTK_SHORT);
+  seeds->GetPointData()->GetScalars()->Fill(0);
+  SetSeed(seeds, 10, 12, 14, 1, 1); // bright blob
+  SetSeed(seeds, 3, 3, 3, 1, 2); // background
+  SetSeed(seeds, 26, 22, 36, 1, 2); // background
+
+  vtkNew<vtkImageGrowCutSegment> filter;
+  filter->SetDistancePenalty(distancePenalty);
+  filter->SetIntensityVolume(intensityVolume);
+  filter->SetSeedLabelVolume(seeds);
+  filter->Update();
+  CHECK_EXIT_SUCCESS(CheckResult(filter, intensityVolume, seeds, nullptr, __LINE__));
+
+  // Add seeds of a new label
+  SetSeed(seeds, 20, 14, 28, 1, 3);
+  filter->Update();
+  CHECK_EXIT_SUCCESS(CheckResult(filter, intensityVolume, seeds, nullptr, __LINE__));
+
+  // Add seeds of an existing label
+  SetSeed(seeds, 3, 22, 36, 1, 2);
+  filter->Update();
+  CHECK_EXIT_SUCCESS(CheckResult(filter, intensityVolume, seeds, nullptr, __LINE__));
+
+  // Remove some seeds of a label
+  SetSeed(seeds, 3, 3, 3, 1, 0);
+  filter->Update();
+  CHECK_EXIT_SUCCESS(CheckResult(filter, intensityVolume, seeds, nullptr, __LINE__));
+
+  // Change label of seeds
+  SetSeed(seeds, 20, 14, 28, 1, 4);
+  filter->Update();
+  CHECK_EXIT_SUCCESS(CheckResult(filter, intensityVolume, seeds, nullptr, __LINE__));
+
+  // Computation from scratch gives the same result
+  vtkNew<vtkImageGrowCutSegment> referenceFilter;
+  referenceFilter->SetDistancePenalty(distancePenalty);
+  referenceFilter->SetIntensityVolume(intensityVolume);
+  referenceFilter->SetSeedLabelVolume(seeds);
+  referenceFilter->Update();
+  CHECK_EXIT_SUCCESS(CheckResult(referenceFilter, intensityVolume, seeds, nullptr, __LINE__));
+
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestMask()
+{
+  vtkSmartPointer<vtkImageData> intensityVolume = CreateIntensityVolume();
+  vtkSmartPointer<vtkImageData> seeds = CreateImage(VTK_SHORT);
+  seeds->GetPointData()->GetScalars()->Fill(0);
+  SetSeed(seeds, 10, 12, 14, 1, 1); // bright blob
+  SetSeed(seeds, 20, 14, 28, 1, 2); // medium blob
+  SetSeed(seeds, 3, 3, 3, 1, 3); // background, excluded by the mask
+  vtkSmartPointer<vtkImageData> mask = CreateImage(VTK_UNSIGNED_CHAR);
+
+  // Only the blobs are editable
+  UpdateIntensityRangeMask(intensityVolume, mask, 40.0f, 200.0f);
+  vtkNew<vtkImageGrowCutSegment> filter;
+  filter->SetIntensityVolume(intensityVolume);
+  filter->SetSeedLabelVolume(seeds);
+  filter->SetMaskVolume(mask);
+  filter->Update();
+  CHECK_EXIT_SUCCESS(CheckResult(filter, intensityVolume, seeds, mask, __LINE__));
+  // Seeds in the masked region are ignored
+  const short* resultPtr = static_cast<short*>(filter->GetOutput()->GetScalarPointer());
+  CHECK_INT(resultPtr[GetIndex(3, 3, 3)], 0);
+  CHECK_INT(resultPtr[GetIndex(10, 12, 14)], 1);
+  CHECK_INT(resultPtr[GetIndex(20, 14, 28)], 2);
+
+  // Incremental update with mask
+  SetSeed(seeds, 11, 12, 14, 0, 4);
+  filter->Update();
+  CHECK_EXIT_SUCCESS(CheckResult(filter, intensityVolume, seeds, mask, __LINE__));
+
+  // Changing the mask restarts the computation
+  UpdateIntensityRangeMask(intensityVolume, mask, -10.0f, 80.0f);
+  filter->Update();
+  CHECK_EXIT_SUCCESS(CheckResult(filter, intensityVolume, seeds, mask, __LINE__));
+  resultPtr = static_cast<short*>(filter->GetOutput()->GetScalarPointer());
+  CHECK_INT(resultPtr[GetIndex(3, 3, 3)], 3);
+  CHECK_INT(resultPtr[GetIndex(10, 12, 14)], 0);
+
+  // Removing the mask restarts the computation
+  filter->SetMaskVolume(nullptr);
+  filter->Update();
+  CHECK_EXIT_SUCCESS(CheckResult(filter, intensityVolume, seeds, nullptr, __LINE__));
+
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestIntensityVolumeChange()
+{
+  vtkSmartPointer<vtkImageData> intensityVolume = CreateIntensityVolume();
+  vtkSmartPointer<vtkImageData> seeds = CreateImage(VTK_SHORT);
+  seeds->GetPointData()->GetScalars()->Fill(0);
+  SetSeed(seeds, 10, 12, 14, 1, 1);
+  SetSeed(seeds, 3, 3, 3, 1, 2);
+
+  vtkNew<vtkImageGrowCutSegment> filter;
+  filter->SetIntensityVolume(intensityVolume);
+  filter->SetSeedLabelVolume(seeds);
+  filter->Update();
+  CHECK_EXIT_SUCCESS(CheckResult(filter, intensityVolume, seeds, nullptr, __LINE__));
+
+  // Modify intensities in place: previous result must not be reused
+  float* intensityPtr = static_cast<float*>(intensityVolume->GetScalarPointer());
+  for (int z = 10; z < 30; z++)
+  {
+    for (int y = 1; y < DimY - 1; y++)
+    {
+      intensityPtr[GetIndex(15, y, z)] += 300.0f;
+    }
+  }
+  intensityVolume->Modified();
+  filter->Update();
+  CHECK_EXIT_SUCCESS(CheckResult(filter, intensityVolume, seeds, nullptr, __LINE__));
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImageGrowCutSegmentTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  CHECK_EXIT_SUCCESS(TestIncrementalSeedUpdates(0.0));
+  CHECK_EXIT_SUCCESS(TestIncrementalSeedUpdates(2.5));
+  CHECK_EXIT_SUCCESS(TestMask());
+  CHECK_EXIT_SUCCESS(TestIntensityVolumeChange());
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,499 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Segmentations includes
+#include "vtkImageLabelmapSmoothing.h"
+
+// SegmentationCore includes
+#include "vtkOrientedImageData.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+#include <vtkTransform.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+const int InputExtent[6] = { -4, 25, 3, 28, -2, 17 };
+const short LabelValue = 5;
+
+//----------------------------------------------------------------------------
+/// Binary image of the input extent, used for computing reference results
+class BinaryImage
+{
+public:
+  BinaryImage()
+  {
+    this->Voxels.assign(static_cast<size_t>(GetDimension(0)) * GetDimension(1) * GetDimension(2), 0);
+  }
+  static int GetDimension(int axis)
+  {
+    return InputExtent[2 * axis + 1] - InputExtent[2 * axis] + 1;
+  }
+  static bool IsInside(int i, int j, int k)
+  {
+    return i >= InputExtent[0] && i <= InputExtent[1] && j >= InputExtent[2] && j <= InputExtent[3]
+      && k >= InputExtent[4] && k <= InputExtent[5];
+  }
+  unsigned char& operator()(int i, int j, int k)
+  {
+    return this->Voxels[(i - InputExtent[0])
+      + GetDimension(0) * ((j - InputExtent[2]) + static_cast<size_t>(GetDimension(1)) * (k - InputExtent[4]))];
+  }
+  void SetBox(int i0, int i1, int j0, int j1, int k0, int k1, unsigned char value)
+  {
+    for (int k = k0; k <= k1; k++)
+    {
+      for (int j = j0; j <= j1; j++)
+      {
+        for (int i = i0; i <= i1; i++)
+        {
+          (*this)(i, j, k) = value;
+        }
+      }
+    }
+  }
+  std::vector<unsigned char> Voxels;
+};
+
+//----------------------------------------------------------------------------
+/// Large box with a hole and a thin protrusion, a small blob, and a single voxel
+void CreateTestShapes(BinaryImage& image)
+{
+  image.SetBox(0, 14, 8, 22, 2, 10, 1);
+  image.SetBox(7, 7, 15, 15, 6, 6, 0);
+  image.SetBox(15, 18, 15, 15, 6, 6, 1);
+  image.SetBox(19, 20, 6, 7, 13, 14, 1);
+  image.SetBox(21, 21, 25, 25, 15, 15, 1);
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkOrientedImageData> CreateLabelmap(BinaryImage& binaryImage, int scalarType)
+{
+  vtkSmartPointer<vtkOrientedImageData> labelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+  labelmap->SetExtent(const_cast<int*>(InputExtent));
+  labelmap->SetSpacing(1.0, 1.0, 2.0);
+  labelmap->SetOrigin(12.0, -3.0, 40.0);
+  vtkNew<vtkTransform> directions;
+  directions->RotateZ(90.0);
+  labelmap->SetDirectionMatrix(directions->GetMatrix());
+  labelmap->AllocateScalars(scalarType, 1);
+  for (int k = InputExtent[4]; k <= InputExtent[5]; k++)
+  {
+    for (int j = InputExtent[2]; j <= InputExtent[3]; j++)
+    {
+      for (int i = InputExtent[0]; i <= InputExtent[1]; i++)
+      {
+        labelmap->SetScalarComponentFromDouble(i, j, k, 0, binaryImage(i, j, k) ? LabelValue : 0);
+      }
+    }
+  }
+  return labelmap;
+}
+
+//----------------------------------------------------------------------------
+enum ReferenceOperation
+{
+  ReferenceMedian,
+  ReferenceErode,
+  ReferenceDilate
+};
+
+//----------------------------------------------------------------------------
+/// Straightforward implementation of binary median (box kernel) and erosion/dilation (ellipsoid kernel).
+/// Kernel voxels outside the image are ignored.
+void ComputeReference(BinaryImage& input, const int kernelSize[3], ReferenceOperation operation, BinaryImage& output)
+{
+  double radius[3] = { 0.0, 0.0, 0.0 };
+  int halfSize[3] = { 0, 0, 0 };
+  for (int axis = 0; axis < 3; axis++)
+  {
+    radius[axis] = std::max(kernelSize[axis], 1) / 2.0;
+    halfSize[axis] = (operation == ReferenceMedian ? std::max(kernelSize[axis] - 1, 0) / 2 : static_cast<int>(floor(radius[axis])));
+  }
+  for (int k = InputExtent[4]; k <= InputExtent[5]; k++)
+  {
+    for (int j = InputExtent[2]; j <= InputExtent[3]; j++)
+    {
+      for (int i = InputExtent[0]; i <= InputExtent[1]; i++)
+      {
+        int numberOfVoxels = 0;
+        int numberOfForegroundVoxels = 0;
+        for (int dz = -halfSize[2]; dz <= halfSize[2]; dz++)
+        {
+          for (int dy = -halfSize[1]; dy <= halfSize[1]; dy++)
+          {
+            for (int dx = -halfSize[0]; dx <= halfSize[0]; dx++)
+            {
+              if (!BinaryImage::IsInside(i + dx, j + dy, k + dz))
+              {
+                continue;
+              }
+              if (operation != ReferenceMedian && (dx / radius[0]) * (dx / radius[0])
+                + (dy / radius[1]) * (dy / radius[1]) + (dz / radius[2]) * (dz / radius[2]) > 1.0)
+              {
+                continue;
+              }
+              numberOfVoxels++;
+              numberOfForegroundVoxels += input(i + dx, j + dy, k + dz);
+            }
+          }
+        }
+        switch (operation)
+        {
+          case ReferenceMedian: output(i, j, k) = (2 * numberOfForegroundVoxels > numberOfVoxels ? 1 : 0); break;
+          case ReferenceErode: output(i, j, k) = (numberOfForegroundVoxels == numberOfVoxels ? 1 : 0); break;
+          case ReferenceDilate: output(i, j, k) = (numberOfForegroundVoxels > 0 ? 1 : 0); break;
+        }
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void ComputeReferenceSmoothing(BinaryImage& input, int smoothingMethod, const int kernelSize[3], BinaryImage& output)
+{
+  BinaryImage intermediate;
+  switch (smoothingMethod)
+  {
+    case vtkImageLabelmapSmoothing::Median:
+      ComputeReference(input, kernelSize, ReferenceMedian, output);
+      break;
+    case vtkImageLabelmapSmoothing::MorphologicalOpening:
+      ComputeReference(input, kernelSize, ReferenceErode, intermediate);
+      ComputeReference(intermediate, kernelSize, ReferenceDilate, output);
+      break;
+    case vtkImageLabelmapSmoothing::MorphologicalClosing:
+      ComputeReference(input, kernelSize, ReferenceDilate, intermediate);
+      ComputeReference(intermediate, kernelSize, ReferenceErode, output);
+      break;
+  }
+}
+
+//----------------------------------------------------------------------------
+/// Check that output geometry matches the input and output voxels are equal to expected values.
+/// Expected value is 0 for all voxels outside the output extent.
+int CheckOutput(vtkOrientedImageData* input, vtkOrientedImageData* output, BinaryImage& expected, int line)
+{
+  CHECK_INT(output->GetScalarType(), input->GetScalarType());
+  CHECK_INT(output->GetNumberOfScalarComponents(), 1);
+  vtkNew<vtkMatrix4x4> inputImageToWorld;
+  input->GetImageToWorldMatrix(inputImageToWorld);
+  vtkNew<vtkMatrix4x4> outputImageToWorld;
+  output->GetImageToWorldMatrix(outputImageToWorld);
+  for (int r = 0; r < 4; r++)
+  {
+    for (int c = 0; c < 4; c++)
+    {
+      if (std::fabs(inputImageToWorld->GetElement(r, c) - outputImageToWorld->GetElement(r, c)) > 1e-6)
+      {
+        std::cerr << "Line " << line << ": output geometry does not match input geometry" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  int* outputExtent = output->GetExtent();
+  for (int axis = 0; axis < 3; axis++)
+  {
+    if (outputExtent[2 * axis] < InputExtent[2 * axis] || outputExtent[2 * axis + 1] > InputExtent[2 * axis + 1])
+    {
+      std::cerr << "Line " << line << ": output extent is outside of the input extent" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  for (int k = InputExtent[4]; k <= InputExtent[5]; k++)
+  {
+    for (int j = InputExtent[2]; j <= InputExtent[3]; j++)
+    {
+      for (int i = InputExtent[0]; i <= InputExtent[1]; i++)
+      {
+        bool inOutputExtent = (i >= outputExtent[0] && i <= outputExtent[1] && j >= outputExtent[2]
+          && j <= outputExtent[3] && k >= outputExtent[4] && k <= outputExtent[5]);
+        double value = (inOutputExtent ? output->GetScalarComponentAsDouble(i, j, k, 0) : 0.0);
+        if (value != expected(i, j, k))
+        {
+          std::cerr << "Line " << line << ": voxel (" << i << ", " << j << ", " << k << ") value is " << value
+            << ", expected " << static_cast<int>(expected(i, j, k)) << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+  }
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestNeighborhoodSmoothing(int smoothingMethod, int scalarType)
+{
+  BinaryImage inputImage;
+  CreateTestShapes(inputImage);
+  vtkSmartPointer<vtkOrientedImageData> input = CreateLabelmap(inputImage, scalarType);
+
+  const int kernelSizes[3][3] = { { 1, 1, 1 }, { 3, 3, 3 }, { 5, 3, 1 } };
+  for (int kernelIndex = 0; kernelIndex < 3; kernelIndex++)
+  {
+    BinaryImage expected;
+    ComputeReferenceSmoothing(inputImage, smoothingMethod, kernelSizes[kernelIndex], expected);
+
+    vtkNew<vtkImageLabelmapSmoothing> smoothing;
+    smoothing->SetSmoothingMethod(smoothingMethod);
+    smoothing->SetKernelSizePixel(const_cast<int*>(kernelSizes[kernelIndex]));
+
+    // Default output extent: bounding box of the segment, padded by the kernel size
+    vtkNew<vtkOrientedImageData> output;
+    CHECK_BOOL(smoothing->SmoothBinaryLabelmap(input, output), true);
+    CHECK_EXIT_SUCCESS(CheckOutput(input, output, expected, __LINE__));
+
+    // Output extent is the same as the input extent
+    smoothing->SetOutputExtent(const_cast<int*>(InputExtent));
+    CHECK_BOOL(smoothing->SmoothBinaryLabelmap(input, output), true);
+    CHECK_EXIT_SUCCESS(CheckOutput(input, output, expected, __LINE__));
+    int* outputExtent = output->GetExtent();
+    for (int i = 0; i < 6; i++)
+    {
+      CHECK_INT(outputExtent[i], InputExtent[i]);
+    }
+  }
+
+  // Effect of the parameters on the test shapes
+  const int noSmoothing[3] = { 1, 1, 1 };
+  const int kernelSize3[3] = { 3, 3, 3 };
+  BinaryImage unchanged;
+  ComputeReferenceSmoothing(inputImage, smoothingMethod, noSmoothing, unchanged);
+  CHECK_BOOL(unchanged.Voxels == inputImage.Voxels, true);
+  BinaryImage smoothed;
+  ComputeReferenceSmoothing(inputImage, smoothingMethod, kernelSize3, smoothed);
+  CHECK_INT(smoothed(4, 12, 4), 1); // inside the large box
+  switch (smoothingMethod)
+  {
+    case vtkImageLabelmapSmoothing::Median:
+      CHECK_INT(smoothed(21, 25, 15), 0); // single voxel removed
+      CHECK_INT(smoothed(7, 15, 6), 1); // hole filled
+      break;
+    case vtkImageLabelmapSmoothing::MorphologicalOpening:
+      CHECK_INT(smoothed(21, 25, 15), 0); // single voxel removed
+      CHECK_INT(smoothed(19, 6, 13), 0); // small blob removed
+      CHECK_INT(smoothed(17, 15, 6), 0); // protrusion removed
+      break;
+    case vtkImageLabelmapSmoothing::MorphologicalClosing:
+      CHECK_INT(smoothed(21, 25, 15), 1); // single voxel kept
+      CHECK_INT(smoothed(7, 15, 6), 1); // hole filled
+      CHECK_INT(smoothed(14, 7, 6), 0); // box is not grown
+      break;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestGaussianSmoothing()
+{
+  BinaryImage inputImage;
+  CreateTestShapes(inputImage);
+  vtkSmartPointer<vtkOrientedImageData> input = CreateLabelmap(inputImage, VTK_UNSIGNED_CHAR);
+
+  vtkNew<vtkImageLabelmapSmoothing> smoothing;
+  smoothing->SetSmoothingMethodToGaussian();
+  smoothing->SetOutputExtent(const_cast<int*>(InputExtent));
+
+  // Standard deviation is much smaller than the voxel size: no change
+  smoothing->SetGaussianStandardDeviationMm(0.1);
+  vtkNew<vtkOrientedImageData> output;
+  CHECK_BOOL(smoothing->SmoothBinaryLabelmap(input, output), true);
+  CHECK_EXIT_SUCCESS(CheckOutput(input, output, inputImage, __LINE__));
+
+  // Small features are removed, large box is preserved
+  smoothing->SetGaussianStandardDeviationMm(1.0);
+  CHECK_BOOL(smoothing->SmoothBinaryLabelmap(input, output), true);
+  int* outputExtent = output->GetExtent();
+  for (int i = 0; i < 6; i++)
+  {
+    CHECK_INT(outputExtent[i], InputExtent[i]);
+  }
+  CHECK_INT(output->GetScalarType(), VTK_UNSIGNED_CHAR);
+  CHECK_INT(output->GetScalarComponentAsDouble(4, 12, 4, 0), 1);
+  CHECK_INT(output->GetScalarComponentAsDouble(21, 25, 15, 0), 0);
+  CHECK_INT(output->GetScalarComponentAsDouble(19, 6, 13, 0), 0);
+  CHECK_INT(output->GetScalarComponentAsDouble(7, 15, 6, 0), 1);
+  CHECK_INT(output->GetScalarComponentAsDouble(-4, 3, -2, 0), 0);
+  double range[2] = { 0.0, 0.0 };
+  output->GetPointData()->GetScalars()->GetRange(range);
+  CHECK_INT(range[0], 0);
+  CHECK_INT(range[1], 1);
+
+  // Empty input
+  BinaryImage emptyImage;
+  vtkSmartPointer<vtkOrientedImageData> emptyInput = CreateLabelmap(emptyImage, VTK_UNSIGNED_CHAR);
+  CHECK_BOOL(smoothing->SmoothBinaryLabelmap(emptyInput, output), true);
+  output->GetPointData()->GetScalars()->GetRange(range);
+  CHECK_INT(range[1], 0);
+
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int GetNumberOfForegroundVoxels(vtkOrientedImageData* labelmap)
+{
+  int numberOfVoxels = 0;
+  vtkDataArray* scalars = labelmap->GetPointData()->GetScalars();
+  for (vtkIdType index = 0; index < scalars->GetNumberOfTuples(); index++)
+  {
+    numberOfVoxels += (scalars->GetTuple1(index) != 0 ? 1 : 0);
+  }
+  return numberOfVoxels;
+}
+
+//----------------------------------------------------------------------------
+double GetValue(vtkOrientedImageData* labelmap, int i, int j, int k)
+{
+  int* extent = labelmap->GetExtent();
+  if (i < extent[0] || i > extent[1] || j < extent[2] || j > extent[3] || k < extent[4] || k > extent[5])
+  {
+    return 0.0;
+  }
+  return labelmap->GetScalarComponentAsDouble(i, j, k, 0);
+}
+
+//----------------------------------------------------------------------------
+int TestJointSmoothing()
+{
+  // Two boxes that touch each other and a separate box
+  const int mergedExtent[6] = { 0, 29, 0, 24, 0, 19 };
+  const int boxes[3][6] = { { 4, 11, 4, 15, 4, 13 }, { 12, 19, 4, 15, 4, 13 }, { 22, 26, 16, 21, 10, 16 } };
+  const int boxCenters[3][3] = { { 8, 10, 8 }, { 16, 10, 8 }, { 24, 18, 13 } };
+  vtkNew<vtkOrientedImageData> merged;
+  merged->SetExtent(const_cast<int*>(mergedExtent));
+  merged->SetSpacing(0.5, 0.5, 1.0);
+  merged->SetOrigin(-10.0, 20.0, 5.0);
+  merged->AllocateScalars(VTK_SHORT, 1);
+  merged->GetPointData()->GetScalars()->Fill(0);
+  for (int label = 1; label <= 3; label++)
+  {
+    const int* box = boxes[label - 1];
+    for (int k = box[4]; k <= box[5]; k++)
+    {
+      for (int j = box[2]; j <= box[3]; j++)
+      {
+        for (int i = box[0]; i <= box[1]; i++)
+        {
+          merged->SetScalarComponentFromDouble(i, j, k, 0, label);
+        }
+      }
+    }
+  }
+
+  vtkNew<vtkImageLabelmapSmoothing> smoothing;
+  vtkNew<vtkOrientedImageData> output;
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  CHECK_BOOL(smoothing->GetJointSmoothingResult(1, output), false);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+
+  vtkSmartPointer<vtkOrientedImageData> weakSmoothingResults[3];
+  const double smoothingFactors[2] = { 0.0, 1.0 };
+  for (double smoothingFactor : smoothingFactors)
+  {
+    smoothing->SetJointSmoothingFactor(smoothingFactor);
+    CHECK_BOOL(smoothing->ComputeJointSmoothing(merged, 4), true);
+    for (int label = 1; label <= 3; label++)
+    {
+      CHECK_BOOL(smoothing->GetJointSmoothingResult(label, output), true);
+      // Each label is preserved, and it does not get into other labels
+      for (int otherLabel = 1; otherLabel <= 3; otherLabel++)
+      {
+        const int* center = boxCenters[otherLabel - 1];
+        CHECK_INT(GetValue(output, center[0], center[1], center[2]), (otherLabel == label ? 1 : 0));
+      }
+      int* outputExtent = output->GetExtent();
+      for (int axis = 0; axis < 3; axis++)
+      {
+        CHECK_BOOL(outputExtent[2 * axis] >= mergedExtent[2 * axis], true);
+        CHECK_BOOL(outputExtent[2 * axis + 1] <= mergedExtent[2 * axis + 1], true);
+      }
+      vtkNew<vtkMatrix4x4> mergedImageToWorld;
+      merged->GetImageToWorldMatrix(mergedImageToWorld);
+      vtkNew<vtkMatrix4x4> outputImageToWorld;
+      output->GetImageToWorldMatrix(outputImageToWorld);
+      for (int r = 0; r < 4; r++)
+      {
+        for (int c = 0; c < 4; c++)
+        {
+          CHECK_DOUBLE_TOLERANCE(outputImageToWorld->GetElement(r, c), mergedImageToWorld->GetElement(r, c), 1e-6);
+        }
+      }
+      const int* box = boxes[label - 1];
+      int numberOfBoxVoxels = (box[1] - box[0] + 1) * (box[3] - box[2] + 1) * (box[5] - box[4] + 1);
+      if (smoothingFactor == 0.0)
+      {
+        // Weak smoothing keeps most of the box
+        CHECK_BOOL(GetNumberOfForegroundVoxels(output) > numberOfBoxVoxels / 2, true);
+        weakSmoothingResults[label - 1] = vtkSmartPointer<vtkOrientedImageData>::New();
+        weakSmoothingResults[label - 1]->DeepCopy(output);
+      }
+      else
+      {
+        // Strong smoothing changes the shape (rounds the corners)
+        int numberOfChangedVoxels = 0;
+        for (int k = mergedExtent[4]; k <= mergedExtent[5]; k++)
+        {
+          for (int j = mergedExtent[2]; j <= mergedExtent[3]; j++)
+          {
+            for (int i = mergedExtent[0]; i <= mergedExtent[1]; i++)
+            {
+              numberOfChangedVoxels += (GetValue(output, i, j, k) != GetValue(weakSmoothingResults[label - 1], i, j, k) ? 1 : 0);
+            }
+          }
+        }
+        CHECK_BOOL(numberOfChangedVoxels > 0, true);
+      }
+    }
+
+    // Label that is not present in the merged labelmap
+    CHECK_BOOL(smoothing->GetJointSmoothingResult(4, output), true);
+    CHECK_INT(GetNumberOfForegroundVoxels(output), 0);
+    int* outputExtent = output->GetExtent();
+    for (int i = 0; i < 6; i++)
+    {
+      CHECK_INT(outputExtent[i], mergedExtent[i]);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImageLabelmapSmoothingTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  CHECK_EXIT_SUCCESS(TestNeighborhoodSmoothing(vtkImageLabelmapSmoothing::Median, VTK_SHORT));
+  CHECK_EXIT_SUCCESS(TestNeighborhoodSmoothing(vtkImageLabelmapSmoothing::MorphologicalOpening, VTK_SHORT));
+  CHECK_EXIT_SUCCESS(TestNeighborhoodSmoothing(vtkImageLabelmapSmoothing::MorphologicalClosing, VTK_UNSIGNED_CHAR));
+  CHECK_EXIT_SUCCESS(TestGaussianSmoothing());
+  CHECK_EXIT_SUCCESS(TestJointSmoothing());
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,382 @@
+#include "vtkImageBrushStrokeRasterizer.h"
+
+// SegmentationCore includes
+#include "vtkOrientedImageData.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkIdList.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkSMPTools.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+vtkStandardNewMacro(vtkImageBrushStrokeRasterizer);
+
+//----------------------------------------------------------------------------
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Line segment swept by the brush (start and end are the same for a single brush stamp).
+struct BrushSegment
+{
+  double Start[3];
+  double End[3];
+};
+
+//----------------------------------------------------------------------------
+/// Squared distance of a point from a line segment
+double DistanceToSegment2(const double point[3], const double start[3], const double end[3])
+{
+  double direction[3] = { end[0] - start[0], end[1] - start[1], end[2] - start[2] };
+  double startToPoint[3] = { point[0] - start[0], point[1] - start[1], point[2] - start[2] };
+  double length2 = vtkMath::Dot(direction, direction);
+  double t = (length2 > 0.0 ? std::max(0.0, std::min(1.0, vtkMath::Dot(startToPoint, direction) / length2)) : 0.0);
+  double closestToPoint[3] =
+  {
+    startToPoint[0] - t * direction[0],
+    startToPoint[1] - t * direction[1],
+    startToPoint[2] - t * direction[2]
+  };
+  return vtkMath::Dot(closestToPoint, closestToPoint);
+}
+
+//----------------------------------------------------------------------------
+/// Analytic inside test for the brush swept along a segment.
+/// Positions are specified relative to the segment start point.
+class SweptBrushShape
+{
+public:
+  SweptBrushShape(const BrushSegment& segment, bool cylinder, double radius, double height, const double axis[3])
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      this->Direction[i] = segment.End[i] - segment.Start[i];
+      this->Axis[i] = axis[i];
+    }
+    this->Cylinder = cylinder;
+    this->Radius2 = radius * radius;
+    this->HalfHeight = height / 2.0;
+    if (this->Cylinder)
+    {
+      // The brush moves within the plane of the disk (normal to the axis),
+      // the closest point is searched in the projection to this plane.
+      this->DirectionAlongAxis = vtkMath::Dot(this->Direction, this->Axis);
+      for (int i = 0; i < 3; i++)
+      {
+        this->Direction[i] -= this->DirectionAlongAxis * this->Axis[i];
+      }
+    }
+    this->DirectionLength2 = vtkMath::Dot(this->Direction, this->Direction);
+  }
+
+  bool IsInside(const double startToPoint[3]) const
+  {
+    double projected[3] = { startToPoint[0], startToPoint[1], startToPoint[2] };
+    double positionAlongAxis = 0.0;
+    if (this->Cylinder)
+    {
+      positionAlongAxis = vtkMath::Dot(startToPoint, this->Axis);
+      for (int i = 0; i < 3; i++)
+      {
+        projected[i] -= positionAlongAxis * this->Axis[i];
+      }
+    }
+    double t = 0.0;
+    if (this->DirectionLength2 > 0.0)
+    {
+      t = std::max(0.0, std::min(1.0, vtkMath::Dot(projected, this->Direction) / this->DirectionLength2));
+    }
+    double closestToPoint[3] =
+    {
+      projected[0] - t * this->Direction[0],
+      projected[1] - t * this->Direction[1],
+      projected[2] - t * this->Direction[2]
+    };
+    if (vtkMath::Dot(closestToPoint, closestToPoint) > this->Radius2)
+    {
+      return false;
+    }
+    if (this->Cylinder && std::fabs(positionAlongAxis - t * this->DirectionAlongAxis) > this->HalfHeight)
+    {
+      return false;
+    }
+    return true;
+  }
+
+protected:
+  bool Cylinder;
+  double Direction[3];
+  double DirectionLength2;
+  double Axis[3];
+  double DirectionAlongAxis = 0.0;
+  double Radius2;
+  double HalfHeight;
+};
+
+//----------------------------------------------------------------------------
+template <class T>
+void PaintSegment(vtkOrientedImageData* labelmap, const int extent[6], const double ijkToWorld[3][4],
+  const BrushSegment& segment, const SweptBrushShape& shape, double fillValue)
+{
+  const T value = static_cast<T>(fillValue);
+  T* extentStartPtr = static_cast<T*>(labelmap->GetScalarPointer(extent[0], extent[2], extent[4]));
+  vtkIdType increments[3] = { 0, 0, 0 };
+  labelmap->GetIncrements(increments);
+
+  vtkSMPTools::For(extent[4], extent[5] + 1, [&](vtkIdType firstK, vtkIdType lastK)
+  {
+    for (vtkIdType k = firstK; k < lastK; k++)
+    {
+      for (int j = extent[2]; j <= extent[3]; j++)
+      {
+        // Voxel position relative to the segment start point, updated incrementally along the row
+        double startToPoint[3] = { 0.0, 0.0, 0.0 };
+        for (int r = 0; r < 3; r++)
+        {
+          startToPoint[r] = ijkToWorld[r][0] * extent[0] + ijkToWorld[r][1] * j + ijkToWorld[r][2] * k
+            + ijkToWorld[r][3] - segment.Start[r];
+        }
+        T* voxelPtr = extentStartPtr + (k - extent[4]) * increments[2] + (j - extent[2]) * increments[1];
+        for (int i = extent[0]; i <= extent[1]; i++)
+        {
+          if (shape.IsInside(startToPoint))
+          {
+            *voxelPtr = value;
+          }
+          startToPoint[0] += ijkToWorld[0][0];
+          startToPoint[1] += ijkToWorld[1][0];
+          startToPoint[2] += ijkToWorld[2][0];
+          voxelPtr += increments[0];
+        }
+      }
+    }
+  });
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkImageBrushStrokeRasterizer::vtkImageBrushStrokeRasterizer()
+{
+  this->BrushShape = BrushShapeSphere;
+  this->BrushRadius = 1.0;
+  this->BrushHeight = 1.0;
+  this->BrushAxis[0] = 0.0;
+  this->BrushAxis[1] = 0.0;
+  this->BrushAxis[2] = 1.0;
+  this->FillValue = 1.0;
+  this->LabelmapToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+}
+
+//----------------------------------------------------------------------------
+vtkImageBrushStrokeRasterizer::~vtkImageBrushStrokeRasterizer() = default;
+
+//----------------------------------------------------------------------------
+void vtkImageBrushStrokeRasterizer::PrintSelf(ostream &os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "BrushShape: " << (this->BrushShape == BrushShapeSphere ? "Sphere" : "Cylinder") << "\n";
+  os << indent << "BrushRadius: " << this->BrushRadius << "\n";
+  os << indent << "BrushHeight: " << this->BrushHeight << "\n";
+  os << indent << "BrushAxis: " << this->BrushAxis[0] << ", " << this->BrushAxis[1] << ", " << this->BrushAxis[2] << "\n";
+  os << indent << "FillValue: " << this->FillValue << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkImageBrushStrokeRasterizer::SetLabelmapToWorldMatrix(vtkMatrix4x4* labelmapToWorldMatrix)
+{
+  if (labelmapToWorldMatrix)
+  {
+    this->LabelmapToWorldMatrix->DeepCopy(labelmapToWorldMatrix);
+  }
+  else
+  {
+    this->LabelmapToWorldMatrix->Identity();
+  }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+vtkMatrix4x4* vtkImageBrushStrokeRasterizer::GetLabelmapToWorldMatrix()
+{
+  return this->LabelmapToWorldMatrix;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageBrushStrokeRasterizer::Paint(vtkOrientedImageData* labelmap, vtkPoints* strokePoints_World,
+  vtkIdList* strokeStartPointIds, int modifiedExtent[6])
+{
+  for (int i = 0; i < 3; i++)
+  {
+    modifiedExtent[2 * i] = 0;
+    modifiedExtent[2 * i + 1] = -1;
+  }
+  if (!labelmap || !labelmap->GetPointData() || !labelmap->GetPointData()->GetScalars()
+    || !strokePoints_World || strokePoints_World->GetNumberOfPoints() < 1)
+  {
+    return;
+  }
+  int labelmapExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  labelmap->GetExtent(labelmapExtent);
+  if (labelmapExtent[0] > labelmapExtent[1] || labelmapExtent[2] > labelmapExtent[3] || labelmapExtent[4] > labelmapExtent[5])
+  {
+    return;
+  }
+
+  vtkNew<vtkMatrix4x4> ijkToWorldMatrix;
+  labelmap->GetImageToWorldMatrix(ijkToWorldMatrix);
+  vtkMatrix4x4::Multiply4x4(this->LabelmapToWorldMatrix, ijkToWorldMatrix, ijkToWorldMatrix);
+  vtkNew<vtkMatrix4x4> worldToIjkMatrix;
+  vtkMatrix4x4::Invert(ijkToWorldMatrix, worldToIjkMatrix);
+  double ijkToWorld[3][4];
+  for (int r = 0; r < 3; r++)
+  {
+    for (int c = 0; c < 4; c++)
+    {
+      ijkToWorld[r][c] = ijkToWorldMatrix->GetElement(r, c);
+    }
+  }
+
+  bool cylinder = (this->BrushShape == BrushShapeCylinder);
+  double axis[3] = { this->BrushAxis[0], this->BrushAxis[1], this->BrushAxis[2] };
+  if (cylinder && vtkMath::Normalize(axis) == 0.0)
+  {
+    vtkErrorMacro("Paint: invalid brush axis");
+    return;
+  }
+
+  // Half size of the bounding box of the brush along world axes
+  double brushHalfSize[3] = { this->BrushRadius, this->BrushRadius, this->BrushRadius };
+  if (cylinder)
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      brushHalfSize[i] = this->BrushRadius * sqrt(std::max(0.0, 1.0 - axis[i] * axis[i]))
+        + this->BrushHeight / 2.0 * std::fabs(axis[i]);
+    }
+  }
+
+  // Build list of segments. Points that lie on the segment between their neighbors
+  // (within a small fraction of the voxel size) are skipped.
+  double minimumVoxelSize = VTK_DOUBLE_MAX;
+  for (int c = 0; c < 3; c++)
+  {
+    double columnLength = sqrt(ijkToWorld[0][c] * ijkToWorld[0][c] + ijkToWorld[1][c] * ijkToWorld[1][c]
+      + ijkToWorld[2][c] * ijkToWorld[2][c]);
+    minimumVoxelSize = std::min(minimumVoxelSize, columnLength);
+  }
+  double collinearTolerance2 = (1e-3 * minimumVoxelSize) * (1e-3 * minimumVoxelSize);
+
+  vtkIdType numberOfPoints = strokePoints_World->GetNumberOfPoints();
+  std::vector<bool> strokeStart(numberOfPoints, false);
+  strokeStart[0] = true;
+  if (strokeStartPointIds)
+  {
+    for (vtkIdType i = 0; i < strokeStartPointIds->GetNumberOfIds(); i++)
+    {
+      vtkIdType pointId = strokeStartPointIds->GetId(i);
+      if (pointId >= 0 && pointId < numberOfPoints)
+      {
+        strokeStart[pointId] = true;
+      }
+    }
+  }
+  std::vector<BrushSegment> segments;
+  BrushSegment currentSegment;
+  for (vtkIdType pointId = 0; pointId < numberOfPoints; pointId++)
+  {
+    double point[3] = { 0.0, 0.0, 0.0 };
+    strokePoints_World->GetPoint(pointId, point);
+    if (strokeStart[pointId])
+    {
+      if (pointId > 0)
+      {
+        segments.push_back(currentSegment);
+      }
+      std::copy(point, point + 3, currentSegment.Start);
+      std::copy(point, point + 3, currentSegment.End);
+      continue;
+    }
+    bool singlePoint = (vtkMath::Distance2BetweenPoints(currentSegment.Start, currentSegment.End) == 0.0);
+    if (!singlePoint && DistanceToSegment2(currentSegment.End, currentSegment.Start, point) > collinearTolerance2)
+    {
+      // Direction changed, start a new segment
+      segments.push_back(currentSegment);
+      std::copy(currentSegment.End, currentSegment.End + 3, currentSegment.Start);
+    }
+    std::copy(point, point + 3, currentSegment.End);
+  }
+  segments.push_back(currentSegment);
+
+  for (const BrushSegment& segment : segments)
+  {
+    // Get extent of the segment bounding box in the labelmap
+    double boundsWorld[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    for (int i = 0; i < 3; i++)
+    {
+      boundsWorld[2 * i] = std::min(segment.Start[i], segment.End[i]) - brushHalfSize[i];
+      boundsWorld[2 * i + 1] = std::max(segment.Start[i], segment.End[i]) + brushHalfSize[i];
+    }
+    double boundsIjk[6] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN };
+    for (int corner = 0; corner < 8; corner++)
+    {
+      double cornerWorld[4] = { boundsWorld[corner & 1], boundsWorld[2 + ((corner >> 1) & 1)], boundsWorld[4 + ((corner >> 2) & 1)], 1.0 };
+      double cornerIjk[4] = { 0.0, 0.0, 0.0, 1.0 };
+      worldToIjkMatrix->MultiplyPoint(cornerWorld, cornerIjk);
+      for (int i = 0; i < 3; i++)
+      {
+        boundsIjk[2 * i] = std::min(boundsIjk[2 * i], cornerIjk[i]);
+        boundsIjk[2 * i + 1] = std::max(boundsIjk[2 * i + 1], cornerIjk[i]);
+      }
+    }
+    int segmentExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    bool emptyExtent = false;
+    for (int i = 0; i < 3; i++)
+    {
+      segmentExtent[2 * i] = std::max(static_cast<int>(floor(boundsIjk[2 * i])), labelmapExtent[2 * i]);
+      segmentExtent[2 * i + 1] = std::min(static_cast<int>(ceil(boundsIjk[2 * i + 1])), labelmapExtent[2 * i + 1]);
+      if (segmentExtent[2 * i] > segmentExtent[2 * i + 1])
+      {
+        emptyExtent = true;
+      }
+    }
+    if (emptyExtent)
+    {
+      continue;
+    }
+
+    SweptBrushShape shape(segment, cylinder, this->BrushRadius, this->BrushHeight, axis);
+    switch (labelmap->GetScalarType())
+    {
+      vtkTemplateMacro(PaintSegment<VTK_TT>(labelmap, segmentExtent, ijkToWorld, segment, shape, this->FillValue));
+      default:
+        vtkErrorMacro("Paint: unknown labelmap scalar type");
+        return;
+    }
+
+    if (modifiedExtent[0] > modifiedExtent[1])
+    {
+      std::copy(segmentExtent, segmentExtent + 6, modifiedExtent);
+    }
+    else
+    {
+      for (int i = 0; i < 3; i++)
+      {
+        modifiedExtent[2 * i] = std::min(modifiedExtent[2 * i], segmentExtent[2 * i]);
+        modifiedExtent[2 * i + 1] = std::max(modifiedExtent[2 * i + 1], segmentExtent[2 * i + 1]);
+      }
+    }
+  }
+  labelmap->Modified();
+}
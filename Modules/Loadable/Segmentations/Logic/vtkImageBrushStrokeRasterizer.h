@@ -0,0 +1,92 @@
+#ifndef vtkImageBrushStrokeRasterizer_h
+#define vtkImageBrushStrokeRasterizer_h
+
+#include "vtkSlicerSegmentationsModuleLogicExport.h"
+
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+
+class vtkIdList;
+class vtkMatrix4x4;
+class vtkOrientedImageData;
+class vtkPoints;
+
+/// \brief Paint a brush stroke directly into a labelmap.
+///
+/// The brush is a sphere or a cylinder (disk with a height, oriented along BrushAxis)
+/// that is swept along the line segments between consecutive stroke points.
+/// Voxels are filled if their center is inside the swept shape, which is computed
+/// analytically for each voxel in physical coordinates, so arbitrarily oriented
+/// and anisotropic voxel grids are handled exactly, without creating brush polydata
+/// and image stencils. Each stroke segment is rasterized within its bounding box only,
+/// in parallel, split into slices of the labelmap.
+///
+/// Points that are collinear with their neighbors (such as points interpolated between
+/// mouse positions) are merged into a single segment as they do not change the swept shape.
+class VTK_SLICER_SEGMENTATIONS_LOGIC_EXPORT vtkImageBrushStrokeRasterizer : public vtkObject
+{
+public:
+  static vtkImageBrushStrokeRasterizer* New();
+  vtkTypeMacro(vtkImageBrushStrokeRasterizer, vtkObject);
+  void PrintSelf(ostream &os, vtkIndent indent) override;
+
+  enum
+  {
+    BrushShapeSphere,
+    BrushShapeCylinder
+  };
+
+  /// Shape of the brush. Default is sphere.
+  vtkSetClampMacro(BrushShape, int, BrushShapeSphere, BrushShapeCylinder);
+  vtkGetMacro(BrushShape, int);
+  void SetBrushShapeToSphere() { this->SetBrushShape(BrushShapeSphere); }
+  void SetBrushShapeToCylinder() { this->SetBrushShape(BrushShapeCylinder); }
+
+  /// Radius of the brush in world coordinate system. Default is 1.0.
+  vtkSetMacro(BrushRadius, double);
+  vtkGetMacro(BrushRadius, double);
+
+  /// Height of the cylinder brush in world coordinate system. Default is 1.0.
+  vtkSetMacro(BrushHeight, double);
+  vtkGetMacro(BrushHeight, double);
+
+  /// Direction of the cylinder brush axis in world coordinate system
+  /// (typically the normal of the slice view). Default is (0, 0, 1).
+  vtkSetVector3Macro(BrushAxis, double);
+  vtkGetVector3Macro(BrushAxis, double);
+
+  /// Value that is written into voxels covered by the brush. Default is 1.0.
+  vtkSetMacro(FillValue, double);
+  vtkGetMacro(FillValue, double);
+
+  /// Transform from the physical coordinate system of the labelmap to world coordinate system.
+  /// Only linear transforms are supported. Identity if not set.
+  void SetLabelmapToWorldMatrix(vtkMatrix4x4* labelmapToWorldMatrix);
+  vtkMatrix4x4* GetLabelmapToWorldMatrix();
+
+  /// Paint the brush along the stroke points (in world coordinate system) into the labelmap.
+  /// If strokeStartPointIds is specified then a point with an index in this list
+  /// is not connected to the previous point (it starts a new stroke).
+  /// Voxels outside the brush are not changed.
+  /// Returns the extent that may have been modified in modifiedExtent
+  /// (empty extent if no voxels were modified).
+  void Paint(vtkOrientedImageData* labelmap, vtkPoints* strokePoints_World, vtkIdList* strokeStartPointIds,
+    int modifiedExtent[6]);
+
+protected:
+  vtkImageBrushStrokeRasterizer();
+  ~vtkImageBrushStrokeRasterizer() override;
+
+  int BrushShape;
+  double BrushRadius;
+  double BrushHeight;
+  double BrushAxis[3];
+  double FillValue;
+  vtkSmartPointer<vtkMatrix4x4> LabelmapToWorldMatrix;
+
+private:
+  vtkImageBrushStrokeRasterizer(const vtkImageBrushStrokeRasterizer&) = delete;
+  void operator=(const vtkImageBrushStrokeRasterizer&) = delete;
+};
+
+#endif
@@ -7,6 +7,16 @@
 #include <vtkImageData.h>
 #include <vtkInformation.h>
 
+/// \brief Grow-cut segmentation of an intensity volume from seed labels.
+///
+/// Each voxel gets the label of the seed that can be reached through the path
+/// with the smallest accumulated intensity difference (plus optional distance penalty).
+/// Paths are computed using a bucketed (quantized distance) priority queue,
+/// the volume is split into slabs that are processed in parallel.
+///
+/// Results of the previous execution are kept and only the region affected by
+/// added, removed, or changed seeds is recomputed in the next execution,
+/// which makes repeated updates during interactive seed editing fast.
 class VTK_SLICER_SEGMENTATIONS_LOGIC_EXPORT vtkImageGrowCutSegment : public vtkImageAlgorithm
 {
 public:
@@ -27,7 +37,8 @@ public:
   void SetMaskVolume(vtkImageData* labelImage) { this->SetInputData(2, labelImage); }
 
   /// Reset to initial state. This forces full recomputation of the result label volume.
-  /// This method has to be called if intensity volume changes or if seeds are deleted after initial computation.
+  /// Computation is restarted automatically if the intensity or mask volume is modified,
+  /// therefore calling this method is usually not necessary.
   void Reset();
 
   /// Spatial regularization factor, which can force growing in nearby regions.
@@ -0,0 +1,749 @@
+#include "vtkImageLabelmapSmoothing.h"
+
+// SegmentationCore includes
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkDataArray.h>
+#include <vtkDiscreteMarchingCubes.h>
+#include <vtkIdList.h>
+#include <vtkImageData.h>
+#include <vtkImageStencilData.h>
+#include <vtkImageStencilToImage.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataToImageStencil.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkWindowedSincPolyDataFilter.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <vector>
+
+vtkStandardNewMacro(vtkImageLabelmapSmoothing);
+
+//----------------------------------------------------------------------------
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Box-shaped part of the image where a temporary buffer is allocated
+struct Region
+{
+  int Extent[6];
+  int Dimensions[3];
+
+  void SetExtent(const int extent[6])
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      this->Extent[2 * i] = extent[2 * i];
+      this->Extent[2 * i + 1] = extent[2 * i + 1];
+      this->Dimensions[i] = std::max(0, extent[2 * i + 1] - extent[2 * i] + 1);
+    }
+  }
+  bool IsEmpty() const
+  {
+    return this->Dimensions[0] == 0 || this->Dimensions[1] == 0 || this->Dimensions[2] == 0;
+  }
+  vtkIdType GetNumberOfVoxels() const
+  {
+    return static_cast<vtkIdType>(this->Dimensions[0]) * this->Dimensions[1] * this->Dimensions[2];
+  }
+  vtkIdType GetRowIndex(int j, int k) const
+  {
+    return static_cast<vtkIdType>(k - this->Extent[4]) * this->Dimensions[1] + (j - this->Extent[2]);
+  }
+  vtkIdType GetIndex(int i, int j, int k) const
+  {
+    return this->GetRowIndex(j, k) * this->Dimensions[0] + (i - this->Extent[0]);
+  }
+  bool ContainsRow(int j, int k) const
+  {
+    return j >= this->Extent[2] && j <= this->Extent[3] && k >= this->Extent[4] && k <= this->Extent[5];
+  }
+};
+
+//----------------------------------------------------------------------------
+/// Pad an extent by the specified number of voxels along each axis and crop it to a bounding extent
+void PadExtent(const int extent[6], const int padding[3], const int boundingExtent[6], int paddedExtent[6])
+{
+  for (int i = 0; i < 3; i++)
+  {
+    paddedExtent[2 * i] = std::max(extent[2 * i] - padding[i], boundingExtent[2 * i]);
+    paddedExtent[2 * i + 1] = std::min(extent[2 * i + 1] + padding[i], boundingExtent[2 * i + 1]);
+  }
+}
+
+//----------------------------------------------------------------------------
+/// A row of the neighborhood kernel: the kernel contains voxels with
+/// offsets (-HalfWidth...HalfWidth, OffsetY, OffsetZ).
+struct KernelRow
+{
+  int OffsetY;
+  int OffsetZ;
+  int HalfWidth;
+};
+
+//----------------------------------------------------------------------------
+/// Box kernel, same as in vtkImageMedian3D
+std::vector<KernelRow> GetBoxKernel(const int kernelSize[3])
+{
+  int halfSize[3] = { 0, 0, 0 };
+  for (int i = 0; i < 3; i++)
+  {
+    halfSize[i] = std::max(kernelSize[i] - 1, 0) / 2;
+  }
+  std::vector<KernelRow> kernel;
+  for (int dz = -halfSize[2]; dz <= halfSize[2]; dz++)
+  {
+    for (int dy = -halfSize[1]; dy <= halfSize[1]; dy++)
+    {
+      kernel.push_back({ dy, dz, halfSize[0] });
+    }
+  }
+  return kernel;
+}
+
+//----------------------------------------------------------------------------
+/// Ellipsoid kernel, same as in vtkImageDilateErode3D
+std::vector<KernelRow> GetEllipsoidKernel(const int kernelSize[3])
+{
+  double radius[3] = { 0.0, 0.0, 0.0 };
+  int halfSize[3] = { 0, 0, 0 };
+  for (int i = 0; i < 3; i++)
+  {
+    radius[i] = std::max(kernelSize[i], 1) / 2.0;
+    halfSize[i] = static_cast<int>(floor(radius[i]));
+  }
+  std::vector<KernelRow> kernel;
+  for (int dz = -halfSize[2]; dz <= halfSize[2]; dz++)
+  {
+    for (int dy = -halfSize[1]; dy <= halfSize[1]; dy++)
+    {
+      double remaining = 1.0 - (dy / radius[1]) * (dy / radius[1]) - (dz / radius[2]) * (dz / radius[2]);
+      if (remaining < 0.0)
+      {
+        continue;
+      }
+      int halfWidth = std::min(static_cast<int>(floor(radius[0] * sqrt(remaining) + 1e-6)), halfSize[0]);
+      kernel.push_back({ dy, dz, halfWidth });
+    }
+  }
+  return kernel;
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void ReadBinaryLabelmap(vtkImageData* image, const Region& region, std::vector<unsigned char>& buffer)
+{
+  buffer.resize(region.GetNumberOfVoxels());
+  vtkIdType increments[3] = { 0, 0, 0 };
+  image->GetIncrements(increments);
+  T* regionStartPtr = static_cast<T*>(image->GetScalarPointer(region.Extent[0], region.Extent[2], region.Extent[4]));
+  vtkSMPTools::For(region.Extent[4], region.Extent[5] + 1, [&](vtkIdType firstK, vtkIdType lastK)
+  {
+    for (int k = firstK; k < lastK; k++)
+    {
+      for (int j = region.Extent[2]; j <= region.Extent[3]; j++)
+      {
+        T* inputPtr = regionStartPtr + (k - region.Extent[4]) * increments[2] + (j - region.Extent[2]) * increments[1];
+        unsigned char* outputPtr = &buffer[region.GetIndex(region.Extent[0], j, k)];
+        for (int i = 0; i < region.Dimensions[0]; i++, inputPtr += increments[0])
+        {
+          outputPtr[i] = (*inputPtr != 0 ? 1 : 0);
+        }
+      }
+    }
+  });
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void GetForegroundExtent(vtkImageData* image, int foregroundExtent[6])
+{
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  image->GetExtent(extent);
+  Region region;
+  region.SetExtent(extent);
+  vtkIdType increments[3] = { 0, 0, 0 };
+  image->GetIncrements(increments);
+  T* startPtr = static_cast<T*>(image->GetScalarPointer());
+
+  // Foreground extent of each slice
+  std::vector<int> sliceExtents(6 * region.Dimensions[2]);
+  vtkSMPTools::For(extent[4], extent[5] + 1, [&](vtkIdType firstK, vtkIdType lastK)
+  {
+    for (int k = firstK; k < lastK; k++)
+    {
+      int* sliceExtent = &sliceExtents[6 * (k - extent[4])];
+      sliceExtent[0] = extent[1] + 1;
+      sliceExtent[1] = extent[0] - 1;
+      sliceExtent[2] = extent[3] + 1;
+      sliceExtent[3] = extent[2] - 1;
+      for (int j = extent[2]; j <= extent[3]; j++)
+      {
+        T* inputPtr = startPtr + (k - extent[4]) * increments[2] + (j - extent[2]) * increments[1];
+        for (int i = extent[0]; i <= extent[1]; i++, inputPtr += increments[0])
+        {
+          if (*inputPtr == 0)
+          {
+            continue;
+          }
+          sliceExtent[0] = std::min(sliceExtent[0], i);
+          sliceExtent[1] = std::max(sliceExtent[1], i);
+          sliceExtent[2] = std::min(sliceExtent[2], j);
+          sliceExtent[3] = std::max(sliceExtent[3], j);
+        }
+      }
+    }
+  });
+
+  foregroundExtent[0] = extent[1] + 1;
+  foregroundExtent[1] = extent[0] - 1;
+  foregroundExtent[2] = extent[3] + 1;
+  foregroundExtent[3] = extent[2] - 1;
+  foregroundExtent[4] = extent[5] + 1;
+  foregroundExtent[5] = extent[4] - 1;
+  for (int k = extent[4]; k <= extent[5]; k++)
+  {
+    const int* sliceExtent = &sliceExtents[6 * (k - extent[4])];
+    if (sliceExtent[0] > sliceExtent[1])
+    {
+      continue;
+    }
+    foregroundExtent[0] = std::min(foregroundExtent[0], sliceExtent[0]);
+    foregroundExtent[1] = std::max(foregroundExtent[1], sliceExtent[1]);
+    foregroundExtent[2] = std::min(foregroundExtent[2], sliceExtent[2]);
+    foregroundExtent[3] = std::max(foregroundExtent[3], sliceExtent[3]);
+    foregroundExtent[4] = std::min(foregroundExtent[4], k);
+    foregroundExtent[5] = std::max(foregroundExtent[5], k);
+  }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void WriteBinaryLabelmap(const std::vector<unsigned char>& buffer, const Region& region, vtkImageData* image)
+{
+  T* outputPtr = static_cast<T*>(image->GetScalarPointer());
+  vtkSMPTools::For(0, region.GetNumberOfVoxels(), [&](vtkIdType first, vtkIdType last)
+  {
+    for (vtkIdType index = first; index < last; index++)
+    {
+      outputPtr[index] = static_cast<T>(buffer[index]);
+    }
+  });
+}
+
+//----------------------------------------------------------------------------
+/// Number of foreground voxels in each row prefix. Prefix sums of a row are stored
+/// in Dimensions[0]+1 consecutive elements (the first element is always 0).
+void ComputeRowPrefixSums(const std::vector<unsigned char>& buffer, const Region& region, std::vector<int>& prefixSums)
+{
+  vtkIdType numberOfRows = static_cast<vtkIdType>(region.Dimensions[1]) * region.Dimensions[2];
+  int rowLength = region.Dimensions[0];
+  prefixSums.resize(numberOfRows * (rowLength + 1));
+  vtkSMPTools::For(0, numberOfRows, [&](vtkIdType firstRow, vtkIdType lastRow)
+  {
+    for (vtkIdType row = firstRow; row < lastRow; row++)
+    {
+      const unsigned char* inputPtr = &buffer[row * rowLength];
+      int* outputPtr = &prefixSums[row * (rowLength + 1)];
+      outputPtr[0] = 0;
+      for (int i = 0; i < rowLength; i++)
+      {
+        outputPtr[i + 1] = outputPtr[i] + inputPtr[i];
+      }
+    }
+  });
+}
+
+//----------------------------------------------------------------------------
+enum NeighborhoodOperation
+{
+  OperationErode,
+  OperationDilate,
+  OperationMajority
+};
+
+//----------------------------------------------------------------------------
+/// Compute binary erosion, dilation, or majority (median) in outputRegion.
+/// Kernel voxels outside inputRegion are ignored, therefore inputRegion must contain
+/// all the voxels of the padded output region that are inside the image.
+void ApplyNeighborhoodOperation(const std::vector<int>& prefixSums, const Region& inputRegion,
+  const std::vector<KernelRow>& kernel, NeighborhoodOperation operation,
+  const Region& outputRegion, std::vector<unsigned char>& output)
+{
+  output.resize(outputRegion.GetNumberOfVoxels());
+  const int inputRowLength = inputRegion.Dimensions[0];
+  vtkSMPTools::For(outputRegion.Extent[4], outputRegion.Extent[5] + 1, [&](vtkIdType firstK, vtkIdType lastK)
+  {
+    for (int k = firstK; k < lastK; k++)
+    {
+      for (int j = outputRegion.Extent[2]; j <= outputRegion.Extent[3]; j++)
+      {
+        unsigned char* outputPtr = &output[outputRegion.GetIndex(outputRegion.Extent[0], j, k)];
+        for (int i = outputRegion.Extent[0]; i <= outputRegion.Extent[1]; i++)
+        {
+          int numberOfForegroundVoxels = 0;
+          int numberOfVoxels = 0;
+          bool decided = false;
+          unsigned char value = 0;
+          for (const KernelRow& kernelRow : kernel)
+          {
+            int rowJ = j + kernelRow.OffsetY;
+            int rowK = k + kernelRow.OffsetZ;
+            if (!inputRegion.ContainsRow(rowJ, rowK))
+            {
+              continue;
+            }
+            int firstI = std::max(i - kernelRow.HalfWidth, inputRegion.Extent[0]) - inputRegion.Extent[0];
+            int lastI = std::min(i + kernelRow.HalfWidth, inputRegion.Extent[1]) - inputRegion.Extent[0];
+            if (firstI > lastI)
+            {
+              continue;
+            }
+            const int* rowPrefixSums = &prefixSums[inputRegion.GetRowIndex(rowJ, rowK) * (inputRowLength + 1)];
+            int rowForegroundVoxels = rowPrefixSums[lastI + 1] - rowPrefixSums[firstI];
+            int rowVoxels = lastI - firstI + 1;
+            if (operation == OperationErode && rowForegroundVoxels < rowVoxels)
+            {
+              value = 0;
+              decided = true;
+              break;
+            }
+            if (operation == OperationDilate && rowForegroundVoxels > 0)
+            {
+              value = 1;
+              decided = true;
+              break;
+            }
+            numberOfForegroundVoxels += rowForegroundVoxels;
+            numberOfVoxels += rowVoxels;
+          }
+          if (!decided)
+          {
+            switch (operation)
+            {
+              case OperationErode: value = (numberOfVoxels > 0 ? 1 : 0); break;
+              case OperationDilate: value = 0; break;
+              default: value = (2 * numberOfForegroundVoxels > numberOfVoxels ? 1 : 0); break;
+            }
+          }
+          *(outputPtr++) = value;
+        }
+      }
+    }
+  });
+}
+
+//----------------------------------------------------------------------------
+/// Separable Gaussian smoothing of a buffer, along one axis.
+/// The kernel is truncated at the region boundary and normalized.
+void GaussianSmoothAlongAxis(std::vector<float>& values, const Region& region, int axis,
+  const std::vector<double>& weights)
+{
+  const int radius = static_cast<int>(weights.size()) - 1;
+  if (radius < 1)
+  {
+    return;
+  }
+  const vtkIdType strides[3] = { 1, region.Dimensions[0], static_cast<vtkIdType>(region.Dimensions[0]) * region.Dimensions[1] };
+  const int lineLength = region.Dimensions[axis];
+  const vtkIdType numberOfLines = region.GetNumberOfVoxels() / lineLength;
+  // Other two axes, lines are enumerated along these
+  const int axis1 = (axis == 0 ? 1 : 0);
+  const int axis2 = (axis == 2 ? 1 : 2);
+  vtkSMPTools::For(0, numberOfLines, [&](vtkIdType firstLine, vtkIdType lastLine)
+  {
+    std::vector<float> line(lineLength);
+    for (vtkIdType lineIndex = firstLine; lineIndex < lastLine; lineIndex++)
+    {
+      vtkIdType lineStart = (lineIndex % region.Dimensions[axis1]) * strides[axis1]
+        + (lineIndex / region.Dimensions[axis1]) * strides[axis2];
+      for (int p = 0; p < lineLength; p++)
+      {
+        line[p] = values[lineStart + p * strides[axis]];
+      }
+      for (int p = 0; p < lineLength; p++)
+      {
+        double sum = 0.0;
+        double weightSum = 0.0;
+        int firstOffset = std::max(-radius, -p);
+        int lastOffset = std::min(radius, lineLength - 1 - p);
+        for (int offset = firstOffset; offset <= lastOffset; offset++)
+        {
+          double weight = weights[std::abs(offset)];
+          sum += weight * line[p + offset];
+          weightSum += weight;
+        }
+        values[lineStart + p * strides[axis]] = static_cast<float>(sum / weightSum);
+      }
+    }
+  });
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+class vtkImageLabelmapSmoothing::vtkInternal
+{
+public:
+  /// Smoothed surface of all labels, in IJK coordinate system of the merged labelmap
+  vtkSmartPointer<vtkPolyData> JointSmoothedSurface;
+  /// Polygons of each label, referring to points of JointSmoothedSurface
+  std::map<int, vtkSmartPointer<vtkCellArray> > LabelPolys;
+  std::map<int, std::vector<double> > LabelBounds;
+  vtkNew<vtkMatrix4x4> ImageToWorldMatrix;
+  int Extent[6] = { 0, -1, 0, -1, 0, -1 };
+};
+
+//----------------------------------------------------------------------------
+vtkImageLabelmapSmoothing::vtkImageLabelmapSmoothing()
+{
+  this->Internal = new vtkInternal();
+  this->SmoothingMethod = Median;
+  this->KernelSizePixel[0] = 3;
+  this->KernelSizePixel[1] = 3;
+  this->KernelSizePixel[2] = 3;
+  this->GaussianStandardDeviationMm = 3.0;
+  for (int i = 0; i < 3; i++)
+  {
+    this->OutputExtent[2 * i] = 0;
+    this->OutputExtent[2 * i + 1] = -1;
+  }
+  this->JointSmoothingFactor = 0.5;
+}
+
+//----------------------------------------------------------------------------
+vtkImageLabelmapSmoothing::~vtkImageLabelmapSmoothing()
+{
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelmapSmoothing::PrintSelf(ostream &os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "SmoothingMethod: " << this->SmoothingMethod << "\n";
+  os << indent << "KernelSizePixel: " << this->KernelSizePixel[0] << ", " << this->KernelSizePixel[1]
+    << ", " << this->KernelSizePixel[2] << "\n";
+  os << indent << "GaussianStandardDeviationMm: " << this->GaussianStandardDeviationMm << "\n";
+  os << indent << "OutputExtent: " << this->OutputExtent[0] << ", " << this->OutputExtent[1] << ", "
+    << this->OutputExtent[2] << ", " << this->OutputExtent[3] << ", "
+    << this->OutputExtent[4] << ", " << this->OutputExtent[5] << "\n";
+  os << indent << "JointSmoothingFactor: " << this->JointSmoothingFactor << "\n";
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageLabelmapSmoothing::SmoothBinaryLabelmap(vtkOrientedImageData* inputLabelmap, vtkOrientedImageData* outputLabelmap)
+{
+  if (!inputLabelmap || !outputLabelmap || !inputLabelmap->GetPointData() || !inputLabelmap->GetPointData()->GetScalars())
+  {
+    vtkErrorMacro("SmoothBinaryLabelmap: invalid input or output labelmap");
+    return false;
+  }
+  int inputExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  inputLabelmap->GetExtent(inputExtent);
+  int scalarType = inputLabelmap->GetScalarType();
+
+  // Number of voxels that the result depends on around each voxel
+  // and the number of voxels that the segment may grow by
+  int kernelRadius[3] = { 0, 0, 0 };
+  int inputPadding[3] = { 0, 0, 0 };
+  std::vector<double> gaussianWeights[3];
+  for (int i = 0; i < 3; i++)
+  {
+    if (this->SmoothingMethod == Gaussian)
+    {
+      double standardDeviationPixel = this->GaussianStandardDeviationMm / inputLabelmap->GetSpacing()[i];
+      // same as in vtkImageGaussianSmooth with radius factor of 4
+      kernelRadius[i] = (standardDeviationPixel > 0.0 ? static_cast<int>(standardDeviationPixel * 4.0) : 0);
+      for (int offset = 0; offset <= kernelRadius[i]; offset++)
+      {
+        gaussianWeights[i].push_back(exp(-offset * offset / (2.0 * standardDeviationPixel * standardDeviationPixel)));
+      }
+      inputPadding[i] = kernelRadius[i];
+    }
+    else if (this->SmoothingMethod == Median)
+    {
+      kernelRadius[i] = std::max(this->KernelSizePixel[i] - 1, 0) / 2;
+      inputPadding[i] = kernelRadius[i];
+    }
+    else
+    {
+      kernelRadius[i] = std::max(this->KernelSizePixel[i], 1) / 2;
+      // erosion and dilation are applied after each other
+      inputPadding[i] = 2 * kernelRadius[i];
+    }
+  }
+
+  // Output extent
+  int outputExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  if (this->OutputExtent[0] <= this->OutputExtent[1]
+    && this->OutputExtent[2] <= this->OutputExtent[3]
+    && this->OutputExtent[4] <= this->OutputExtent[5])
+  {
+    int noPadding[3] = { 0, 0, 0 };
+    PadExtent(this->OutputExtent, noPadding, inputExtent, outputExtent);
+  }
+  else
+  {
+    // Smoothing may extend the segment at most by the kernel radius
+    int foregroundExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    switch (scalarType)
+    {
+      vtkTemplateMacro(GetForegroundExtent<VTK_TT>(inputLabelmap, foregroundExtent));
+      default:
+        vtkErrorMacro("SmoothBinaryLabelmap: unknown scalar type");
+        return false;
+    }
+    PadExtent(foregroundExtent, kernelRadius, inputExtent, outputExtent);
+  }
+  Region outputRegion;
+  outputRegion.SetExtent(outputExtent);
+  if (outputRegion.IsEmpty())
+  {
+    // Empty segment
+    outputRegion.SetExtent(inputExtent);
+  }
+
+  int inputRegionExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  PadExtent(outputRegion.Extent, inputPadding, inputExtent, inputRegionExtent);
+  Region inputRegion;
+  inputRegion.SetExtent(inputRegionExtent);
+
+  std::vector<unsigned char> inputBuffer;
+  std::vector<unsigned char> outputBuffer;
+  if (!inputRegion.IsEmpty())
+  {
+    switch (scalarType)
+    {
+      vtkTemplateMacro(ReadBinaryLabelmap<VTK_TT>(inputLabelmap, inputRegion, inputBuffer));
+      default:
+        vtkErrorMacro("SmoothBinaryLabelmap: unknown scalar type");
+        return false;
+    }
+  }
+
+  if (inputRegion.IsEmpty())
+  {
+    outputBuffer.assign(outputRegion.GetNumberOfVoxels(), 0);
+  }
+  else if (this->SmoothingMethod == Gaussian)
+  {
+    std::vector<float> values(inputBuffer.begin(), inputBuffer.end());
+    for (int axis = 0; axis < 3; axis++)
+    {
+      GaussianSmoothAlongAxis(values, inputRegion, axis, gaussianWeights[axis]);
+    }
+    // Threshold at half intensity (127 of 255, as in the previous unsigned char implementation)
+    const float threshold = 127.0f / 255.0f;
+    outputBuffer.resize(outputRegion.GetNumberOfVoxels());
+    vtkSMPTools::For(outputRegion.Extent[4], outputRegion.Extent[5] + 1, [&](vtkIdType firstK, vtkIdType lastK)
+    {
+      for (int k = firstK; k < lastK; k++)
+      {
+        for (int j = outputRegion.Extent[2]; j <= outputRegion.Extent[3]; j++)
+        {
+          const float* inputPtr = &values[inputRegion.GetIndex(outputRegion.Extent[0], j, k)];
+          unsigned char* outputPtr = &outputBuffer[outputRegion.GetIndex(outputRegion.Extent[0], j, k)];
+          for (int i = 0; i < outputRegion.Dimensions[0]; i++)
+          {
+            outputPtr[i] = (inputPtr[i] >= threshold ? 1 : 0);
+          }
+        }
+      }
+    });
+  }
+  else
+  {
+    std::vector<int> prefixSums;
+    ComputeRowPrefixSums(inputBuffer, inputRegion, prefixSums);
+    if (this->SmoothingMethod == Median)
+    {
+      ApplyNeighborhoodOperation(prefixSums, inputRegion, GetBoxKernel(this->KernelSizePixel), OperationMajority,
+        outputRegion, outputBuffer);
+    }
+    else
+    {
+      std::vector<KernelRow> kernel = GetEllipsoidKernel(this->KernelSizePixel);
+      int intermediateExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      PadExtent(outputRegion.Extent, kernelRadius, inputExtent, intermediateExtent);
+      Region intermediateRegion;
+      intermediateRegion.SetExtent(intermediateExtent);
+      std::vector<unsigned char> intermediateBuffer;
+      bool opening = (this->SmoothingMethod == MorphologicalOpening);
+      ApplyNeighborhoodOperation(prefixSums, inputRegion, kernel, opening ? OperationErode : OperationDilate,
+        intermediateRegion, intermediateBuffer);
+      ComputeRowPrefixSums(intermediateBuffer, intermediateRegion, prefixSums);
+      ApplyNeighborhoodOperation(prefixSums, intermediateRegion, kernel, opening ? OperationDilate : OperationErode,
+        outputRegion, outputBuffer);
+    }
+  }
+
+  // Write output
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  inputLabelmap->GetImageToWorldMatrix(imageToWorldMatrix);
+  outputLabelmap->Initialize();
+  outputLabelmap->SetImageToWorldMatrix(imageToWorldMatrix);
+  outputLabelmap->SetExtent(outputRegion.Extent);
+  outputLabelmap->AllocateScalars(scalarType, 1);
+  switch (scalarType)
+  {
+    vtkTemplateMacro(WriteBinaryLabelmap<VTK_TT>(outputBuffer, outputRegion, outputLabelmap));
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageLabelmapSmoothing::ComputeJointSmoothing(vtkOrientedImageData* mergedLabelmap, int numberOfLabels)
+{
+  this->Internal->JointSmoothedSurface = nullptr;
+  this->Internal->LabelPolys.clear();
+  this->Internal->LabelBounds.clear();
+  if (!mergedLabelmap || !mergedLabelmap->GetPointData() || !mergedLabelmap->GetPointData()->GetScalars() || numberOfLabels < 1)
+  {
+    vtkErrorMacro("ComputeJointSmoothing: invalid input");
+    return false;
+  }
+  mergedLabelmap->GetImageToWorldMatrix(this->Internal->ImageToWorldMatrix);
+  mergedLabelmap->GetExtent(this->Internal->Extent);
+
+  // Perform smoothing in voxel space
+  vtkNew<vtkImageData> mergedLabelmapIjk;
+  mergedLabelmapIjk->ShallowCopy(mergedLabelmap);
+  mergedLabelmapIjk->SetSpacing(1.0, 1.0, 1.0);
+  mergedLabelmapIjk->SetOrigin(0.0, 0.0, 0.0);
+
+  // vtkDiscreteFlyingEdges3D cannot be used here, as in the output of that filter,
+  // each labeled region is completely disconnected from neighboring regions, and
+  // for joint smoothing it is essential for the points to move together.
+  vtkNew<vtkDiscreteMarchingCubes> convertToPolyData;
+  convertToPolyData->SetInputData(mergedLabelmapIjk);
+  convertToPolyData->GenerateValues(numberOfLabels, 1, numberOfLabels);
+
+  // Low-pass filtering using Taubin's method
+  // according to VTK documentation 10-20 iterations could be enough but we use a higher value to reduce chance of shrinking
+  const int smoothingIterations = 100;
+  double passBand = pow(10.0, -4.0 * this->JointSmoothingFactor); // gives a nice range of 1-0.0001 from a user input of 0-1
+  vtkNew<vtkWindowedSincPolyDataFilter> smoother;
+  smoother->SetInputConnection(convertToPolyData->GetOutputPort());
+  smoother->SetNumberOfIterations(smoothingIterations);
+  smoother->BoundarySmoothingOff();
+  smoother->FeatureEdgeSmoothingOff();
+  smoother->SetFeatureAngle(90.0);
+  smoother->SetPassBand(passBand);
+  smoother->NonManifoldSmoothingOn();
+  smoother->NormalizeCoordinatesOn();
+  smoother->Update();
+  vtkPolyData* surface = smoother->GetOutput();
+  this->Internal->JointSmoothedSurface = surface;
+
+  // Split polygons by label in one pass (instead of thresholding the whole surface for each label)
+  vtkDataArray* cellLabels = surface->GetCellData() ? surface->GetCellData()->GetScalars() : nullptr;
+  vtkDataArray* pointLabels = surface->GetPointData() ? surface->GetPointData()->GetScalars() : nullptr;
+  vtkCellArray* polys = surface->GetPolys();
+  if (!polys || (!cellLabels && !pointLabels))
+  {
+    // no surface
+    return true;
+  }
+  vtkPoints* points = surface->GetPoints();
+  vtkNew<vtkIdList> pointIds;
+  vtkIdType cellId = 0;
+  for (polys->InitTraversal(); polys->GetNextCell(pointIds); cellId++)
+  {
+    if (pointIds->GetNumberOfIds() < 1)
+    {
+      continue;
+    }
+    int label = static_cast<int>(cellLabels ? cellLabels->GetTuple1(cellId) : pointLabels->GetTuple1(pointIds->GetId(0)));
+    vtkSmartPointer<vtkCellArray>& labelPolys = this->Internal->LabelPolys[label];
+    std::vector<double>& bounds = this->Internal->LabelBounds[label];
+    if (!labelPolys)
+    {
+      labelPolys = vtkSmartPointer<vtkCellArray>::New();
+      bounds = { VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN };
+    }
+    labelPolys->InsertNextCell(pointIds);
+    for (vtkIdType pointIndex = 0; pointIndex < pointIds->GetNumberOfIds(); pointIndex++)
+    {
+      double* point = points->GetPoint(pointIds->GetId(pointIndex));
+      for (int i = 0; i < 3; i++)
+      {
+        bounds[2 * i] = std::min(bounds[2 * i], point[i]);
+        bounds[2 * i + 1] = std::max(bounds[2 * i + 1], point[i]);
+      }
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageLabelmapSmoothing::GetJointSmoothingResult(int labelValue, vtkOrientedImageData* outputLabelmap)
+{
+  if (!outputLabelmap)
+  {
+    vtkErrorMacro("GetJointSmoothingResult: invalid output labelmap");
+    return false;
+  }
+  if (!this->Internal->JointSmoothedSurface)
+  {
+    vtkErrorMacro("GetJointSmoothingResult: joint smoothing has not been computed");
+    return false;
+  }
+
+  auto labelPolysIt = this->Internal->LabelPolys.find(labelValue);
+  if (labelPolysIt == this->Internal->LabelPolys.end())
+  {
+    // Empty segment
+    outputLabelmap->Initialize();
+    outputLabelmap->SetImageToWorldMatrix(this->Internal->ImageToWorldMatrix);
+    outputLabelmap->SetExtent(this->Internal->Extent);
+    outputLabelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+    vtkOrientedImageDataResample::FillImage(outputLabelmap, 0);
+    return true;
+  }
+
+  // Rasterize the label surface within its bounding box
+  const std::vector<double>& bounds = this->Internal->LabelBounds[labelValue];
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  for (int i = 0; i < 3; i++)
+  {
+    extent[2 * i] = std::max(static_cast<int>(floor(bounds[2 * i])) - 1, this->Internal->Extent[2 * i]);
+    extent[2 * i + 1] = std::min(static_cast<int>(ceil(bounds[2 * i + 1])) + 1, this->Internal->Extent[2 * i + 1]);
+  }
+
+  vtkNew<vtkPolyData> labelSurface;
+  labelSurface->SetPoints(this->Internal->JointSmoothedSurface->GetPoints());
+  labelSurface->SetPolys(labelPolysIt->second);
+
+  vtkNew<vtkPolyDataToImageStencil> polyDataToImageStencil;
+  polyDataToImageStencil->SetInputData(labelSurface);
+  polyDataToImageStencil->SetOutputSpacing(1.0, 1.0, 1.0);
+  polyDataToImageStencil->SetOutputOrigin(0.0, 0.0, 0.0);
+  polyDataToImageStencil->SetOutputWholeExtent(extent);
+
+  vtkNew<vtkImageStencilToImage> stencilToImage;
+  stencilToImage->SetInputConnection(polyDataToImageStencil->GetOutputPort());
+  stencilToImage->SetInsideValue(1);
+  stencilToImage->SetOutsideValue(0);
+  stencilToImage->SetOutputScalarType(VTK_UNSIGNED_CHAR);
+  stencilToImage->Update();
+
+  outputLabelmap->ShallowCopy(stencilToImage->GetOutput());
+  outputLabelmap->SetImageToWorldMatrix(this->Internal->ImageToWorldMatrix);
+  return true;
+}
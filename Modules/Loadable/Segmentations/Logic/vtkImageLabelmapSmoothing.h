@@ -0,0 +1,98 @@
+#ifndef vtkImageLabelmapSmoothing_h
+#define vtkImageLabelmapSmoothing_h
+
+#include "vtkSlicerSegmentationsModuleLogicExport.h"
+
+#include <vtkObject.h>
+
+class vtkOrientedImageData;
+
+/// \brief Smoothing of segment labelmaps, used by the Smoothing segment editor effect.
+///
+/// Binary smoothing methods (median, morphological opening and closing, Gaussian) are applied
+/// to a single segment. Voxels are processed in parallel, using only a few temporary buffers
+/// that cover the output extent padded by the kernel radius. Neighborhood sums are computed from
+/// per-row prefix sums, so the cost does not depend on the kernel width along the row direction.
+/// Kernel shapes match the VTK filters that were used before (box for median, ellipsoid
+/// for opening and closing, truncated Gaussian with radius factor 4).
+///
+/// Joint smoothing creates a surface mesh from all labels of a merged labelmap in one pass,
+/// smoothes it with a windowed sinc filter, and then rasterizes each label separately
+/// within its own bounding box.
+class VTK_SLICER_SEGMENTATIONS_LOGIC_EXPORT vtkImageLabelmapSmoothing : public vtkObject
+{
+public:
+  static vtkImageLabelmapSmoothing* New();
+  vtkTypeMacro(vtkImageLabelmapSmoothing, vtkObject);
+  void PrintSelf(ostream &os, vtkIndent indent) override;
+
+  enum
+  {
+    Median,
+    MorphologicalOpening,
+    MorphologicalClosing,
+    Gaussian
+  };
+
+  /// Smoothing method used by SmoothBinaryLabelmap. Default is Median.
+  vtkSetClampMacro(SmoothingMethod, int, Median, Gaussian);
+  vtkGetMacro(SmoothingMethod, int);
+  void SetSmoothingMethodToMedian() { this->SetSmoothingMethod(Median); }
+  void SetSmoothingMethodToMorphologicalOpening() { this->SetSmoothingMethod(MorphologicalOpening); }
+  void SetSmoothingMethodToMorphologicalClosing() { this->SetSmoothingMethod(MorphologicalClosing); }
+  void SetSmoothingMethodToGaussian() { this->SetSmoothingMethod(Gaussian); }
+
+  /// Kernel size in voxels for median and morphological methods. Default is 3x3x3.
+  /// Odd numbers should be used, otherwise the result is shifted.
+  vtkSetVector3Macro(KernelSizePixel, int);
+  vtkGetVector3Macro(KernelSizePixel, int);
+
+  /// Standard deviation of the Gaussian kernel in physical units. Default is 3.0.
+  vtkSetMacro(GaussianStandardDeviationMm, double);
+  vtkGetMacro(GaussianStandardDeviationMm, double);
+
+  /// Extent of the output of SmoothBinaryLabelmap.
+  /// If the extent is empty (default) then the output extent is the bounding box
+  /// of the segment, padded by the size of the kernel.
+  vtkSetVector6Macro(OutputExtent, int);
+  vtkGetVector6Macro(OutputExtent, int);
+
+  /// Smooth a binary labelmap (nonzero voxels are inside the segment).
+  /// The output contains 1 inside and 0 outside the smoothed segment, it has the same scalar type
+  /// and geometry as the input, and its extent is set by OutputExtent.
+  /// Voxels outside the output extent are read from the input as needed.
+  bool SmoothBinaryLabelmap(vtkOrientedImageData* inputLabelmap, vtkOrientedImageData* outputLabelmap);
+
+  /// Smoothing factor for joint smoothing, between 0 (weak) and 1 (strong). Default is 0.5.
+  vtkSetClampMacro(JointSmoothingFactor, double, 0.0, 1.0);
+  vtkGetMacro(JointSmoothingFactor, double);
+
+  /// Compute jointly smoothed surface for all labels (1, 2, ... numberOfLabels) of a merged labelmap.
+  /// Results can be retrieved using GetJointSmoothingResult.
+  bool ComputeJointSmoothing(vtkOrientedImageData* mergedLabelmap, int numberOfLabels);
+
+  /// Get binary labelmap of a label after joint smoothing. The labelmap has the geometry
+  /// of the merged labelmap and its extent is cropped to the smoothed label
+  /// (if the label has no surface then the output is empty, with the extent of the merged labelmap).
+  /// Returns false if joint smoothing has not been computed.
+  bool GetJointSmoothingResult(int labelValue, vtkOrientedImageData* outputLabelmap);
+
+protected:
+  vtkImageLabelmapSmoothing();
+  ~vtkImageLabelmapSmoothing() override;
+
+  int SmoothingMethod;
+  int KernelSizePixel[3];
+  double GaussianStandardDeviationMm;
+  int OutputExtent[6];
+  double JointSmoothingFactor;
+
+private:
+  vtkImageLabelmapSmoothing(const vtkImageLabelmapSmoothing&) = delete;
+  void operator=(const vtkImageLabelmapSmoothing&) = delete;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+};
+
+#endif
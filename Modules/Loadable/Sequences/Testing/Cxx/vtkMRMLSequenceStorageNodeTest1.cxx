@@ -24,10 +24,12 @@
 #include <vtkMRMLLinearTransformNode.h>
 #include <vtkMRMLLinearTransformSequenceStorageNode.h>
 #include <vtkMRMLModelNode.h>
+#include <vtkMRMLParser.h>
 #include <vtkMRMLScalarVolumeNode.h>
 #include <vtkMRMLScene.h>
 #include <vtkMRMLSequenceNode.h>
 #include <vtkMRMLSequenceStorageNode.h>
+#include <vtkMRMLTextNode.h>
 #include <vtkMRMLTransformNode.h>
 #include <vtkMRMLVolumeSequenceStorageNode.h>
 
@@ -37,6 +39,9 @@
 #include <vtkNew.h>
 #include <vtkPolyData.h>
 
+// VTKSYS includes
+#include <vtksys/SystemTools.hxx>
+
 #include "vtkMRMLCoreTestingMacros.h"
 
 //-----------------------------------------------------------------------------
@@ -70,6 +75,69 @@ int TestWriteReadSequence(const std::string& tempDir, vtkMRMLSequenceNode* seque
   return EXIT_SUCCESS;
 }
 
+//-----------------------------------------------------------------------------
+int TestWriteReadBinarySequenceScene(const std::string& tempDir, vtkMRMLScene* scene)
+{
+  // Sequence bundles are always saved with a binary scene file, check that
+  // all items are restored exactly.
+  const int numberOfItems = 50;
+  vtkMRMLSequenceNode* sequenceNode = vtkMRMLSequenceNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLSequenceNode"));
+  sequenceNode->SetIndexName("frame");
+  sequenceNode->SetIndexUnit("ms");
+  for (int itemIndex = 0; itemIndex < numberOfItems; ++itemIndex)
+  {
+    vtkNew<vtkMRMLTextNode> textNode;
+    std::stringstream textSS;
+    textSS << "Item " << itemIndex << "\nwith 'quotes' & \"double quotes\" <tag>";
+    textNode->SetText(textSS.str());
+    textNode->SetAttribute("ItemIndex", std::to_string(itemIndex).c_str());
+    sequenceNode->SetDataNodeAtValue(textNode, std::to_string(itemIndex * 10));
+  }
+  sequenceNode->AddDefaultStorageNode();
+  vtkMRMLSequenceStorageNode* storageNode = vtkMRMLSequenceStorageNode::SafeDownCast(sequenceNode->GetStorageNode());
+  CHECK_NOT_NULL(storageNode);
+
+  std::string fullFilePath = tempDir + "/TestBinarySceneSequence.seq.mrb";
+  if (vtksys::SystemTools::FileExists(fullFilePath.c_str(), true))
+  {
+    vtksys::SystemTools::RemoveFile(fullFilePath.c_str());
+  }
+  storageNode->SetFileName(fullFilePath.c_str());
+  CHECK_BOOL(storageNode->WriteData(sequenceNode), true);
+  // Binary format is only forced while writing the bundle
+  CHECK_BOOL(sequenceNode->GetSequenceScene()->GetSaveInBinaryFormat(), false);
+
+  // Scene file in the bundle is in binary format
+  std::string unpackDir = tempDir + "/TestBinarySceneSequence";
+  vtksys::SystemTools::RemoveADirectory(unpackDir);
+  CHECK_BOOL(vtksys::SystemTools::MakeDirectory(unpackDir), true);
+  std::string sceneFileName = vtkMRMLScene::UnpackSlicerDataBundle(fullFilePath.c_str(), unpackDir.c_str());
+  CHECK_BOOL(sceneFileName.empty(), false);
+  CHECK_BOOL(vtkMRMLParser::IsBinarySceneFile(sceneFileName.c_str()), true);
+
+  vtkNew<vtkMRMLSequenceNode> readSequenceNode;
+  scene->AddNode(readSequenceNode);
+  vtkNew<vtkMRMLSequenceStorageNode> readStorageNode;
+  scene->AddNode(readStorageNode);
+  readStorageNode->SetFileName(fullFilePath.c_str());
+  CHECK_BOOL(readStorageNode->ReadData(readSequenceNode), true);
+
+  CHECK_STD_STRING(readSequenceNode->GetIndexName(), "frame");
+  CHECK_STD_STRING(readSequenceNode->GetIndexUnit(), "ms");
+  CHECK_INT(readSequenceNode->GetNumberOfDataNodes(), numberOfItems);
+  for (int itemIndex = 0; itemIndex < numberOfItems; ++itemIndex)
+  {
+    CHECK_STD_STRING(readSequenceNode->GetNthIndexValue(itemIndex), sequenceNode->GetNthIndexValue(itemIndex));
+    vtkMRMLTextNode* originalTextNode = vtkMRMLTextNode::SafeDownCast(sequenceNode->GetNthDataNode(itemIndex));
+    vtkMRMLTextNode* readTextNode = vtkMRMLTextNode::SafeDownCast(readSequenceNode->GetNthDataNode(itemIndex));
+    CHECK_NOT_NULL(originalTextNode);
+    CHECK_NOT_NULL(readTextNode);
+    CHECK_STD_STRING(readTextNode->GetText(), originalTextNode->GetText());
+    CHECK_STRING(readTextNode->GetAttribute("ItemIndex"), std::to_string(itemIndex).c_str());
+  }
+  return EXIT_SUCCESS;
+}
+
 //-----------------------------------------------------------------------------
 int vtkMRMLSequenceStorageNodeTest1( int argc, char * argv[] )
 {
@@ -123,6 +191,9 @@ int vtkMRMLSequenceStorageNodeTest1( int argc, char * argv[] )
     CHECK_EXIT_SUCCESS(TestWriteReadSequence(tempDir, transformSequenceNode, addedTransformStorageNode, "TestTransformSequence"));
   }
 
+  // Write and read sequence with binary scene file
+  CHECK_EXIT_SUCCESS(TestWriteReadBinarySequenceScene(tempDir, scene));
+
   // Create generic node sequence
   {
     vtkSmartPointer<vtkMRMLSequenceNode> genericSequenceNode = vtkMRMLSequenceNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLSequenceNode"));
@@ -301,6 +301,8 @@ void qMRMLSubjectHierarchyModel::setSubjectHierarchyNode(vtkMRMLSubjectHierarchy
     shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemTransformModifiedEvent, d->CallBack, -10.0);
     shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemDisplayModifiedEvent, d->CallBack, -10.0);
     shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemReparentedEvent, d->CallBack, -10.0);
+    shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyStartBatchUpdateEvent, d->CallBack, -10.0);
+    shNode->AddObserver(vtkMRMLSubjectHierarchyNode::SubjectHierarchyEndBatchUpdateEvent, d->CallBack, -10.0);
   }
 }
 
@@ -1447,6 +1449,16 @@ void qMRMLSubjectHierarchyModel::onEvent(
   // Get node for scene events
   vtkMRMLNode* node = reinterpret_cast<vtkMRMLNode*>(callData);
 
+  // Individual item events are ignored during batch update of the subject hierarchy,
+  // the model is rebuilt when the batch update ends
+  vtkMRMLSubjectHierarchyNode* modelShNode = sceneModel->subjectHierarchyNode();
+  if ( modelShNode && modelShNode->IsBatchUpdating()
+    && event >= vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemAddedEvent
+    && event <= vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemReparentedEvent )
+  {
+    return;
+  }
+
   switch (event)
   {
     case vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemAddedEvent:
@@ -1464,6 +1476,12 @@ void qMRMLSubjectHierarchyModel::onEvent(
     case vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemReparentedEvent:
       sceneModel->onSubjectHierarchyItemModified(itemID);
       break;
+    case vtkMRMLSubjectHierarchyNode::SubjectHierarchyStartBatchUpdateEvent:
+      sceneModel->onSubjectHierarchyStartBatchUpdate();
+      break;
+    case vtkMRMLSubjectHierarchyNode::SubjectHierarchyEndBatchUpdateEvent:
+      sceneModel->onSubjectHierarchyEndBatchUpdate();
+      break;
     case vtkMRMLScene::EndImportEvent:
       sceneModel->onMRMLSceneImported(scene);
       break;
@@ -1559,6 +1577,24 @@ void qMRMLSubjectHierarchyModel::onSubjectHierarchyItemModified(vtkIdType itemID
   this->updateModelItems(itemID);
 }
 
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyModel::onSubjectHierarchyStartBatchUpdate()
+{
+  emit subjectHierarchyAboutToBeUpdated();
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyModel::onSubjectHierarchyEndBatchUpdate()
+{
+  Q_D(qMRMLSubjectHierarchyModel);
+  if (d->MRMLScene && d->MRMLScene->IsBatchProcessing())
+  {
+    // Model is rebuilt when the scene batch processing ends
+    return;
+  }
+  this->rebuildFromSubjectHierarchy();
+}
+
 //------------------------------------------------------------------------------
 void qMRMLSubjectHierarchyModel::onMRMLSceneImported(vtkMRMLScene* scene)
 {
@@ -196,6 +196,8 @@ protected slots:
   virtual void onSubjectHierarchyItemAboutToBeRemoved(vtkIdType itemID);
   virtual void onSubjectHierarchyItemRemoved(vtkIdType itemID);
   virtual void onSubjectHierarchyItemModified(vtkIdType itemID);
+  virtual void onSubjectHierarchyStartBatchUpdate();
+  virtual void onSubjectHierarchyEndBatchUpdate();
 
   virtual void onMRMLSceneImported(vtkMRMLScene* scene);
   virtual void onMRMLSceneClosed(vtkMRMLScene* scene);
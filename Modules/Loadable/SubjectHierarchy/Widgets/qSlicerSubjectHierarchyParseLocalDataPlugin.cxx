@@ -241,7 +241,9 @@ void qSlicerSubjectHierarchyParseLocalDataPlugin::createHierarchyFromLoadedDirec
   while (firstComponentMatch);
 
   // Create hierarchy
+  // (batched so that the views are updated only once after all the items are reparented)
   QList<vtkIdType> createdItemIDs;
+  shNode->StartBatchUpdate();
   for (int nodeIndex=0; nodeIndex<loadedNodes.count(); ++nodeIndex)
   {
     vtkIdType parentItemID = shNode->GetSceneItemID(); // Start from the scene
@@ -272,6 +274,7 @@ void qSlicerSubjectHierarchyParseLocalDataPlugin::createHierarchyFromLoadedDirec
     }
     shNode->ItemModified(parentItemID); // Update subject hierarchy items in the tree
   }
+  shNode->EndBatchUpdate();
 
   // Expand generated branches
   foreach(vtkIdType createdItemID, createdItemIDs)
@@ -525,6 +525,25 @@ vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume(
   return this->AddArchetypeVolume(this->VolumeRegistry, filename, volname, loadingOptions, fileList);
 }
 
+//----------------------------------------------------------------------------
+vtkITKArchetypeImageSeriesReader* vtkSlicerVolumesLogic::PreReadArchetypeScalarVolume(
+  const char* filename, int loadingOptions, vtkStringArray* fileList)
+{
+  // Same settings as in the storage nodes created by the scalar and labelmap volume node set factories
+  return vtkMRMLVolumeArchetypeStorageNode::PreReadScalarImage(filename, fileList,
+    (loadingOptions & vtkSlicerVolumesLogic::SingleFile) != 0,
+    (loadingOptions & vtkSlicerVolumesLogic::DiscardOrientation) == 0,
+    (loadingOptions & vtkSlicerVolumesLogic::CenterImage) != 0);
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume(
+    const char* filename, const char* volname, int loadingOptions,
+    vtkStringArray *fileList, vtkITKArchetypeImageSeriesReader* preReadReader)
+{
+  return this->AddArchetypeVolume(this->VolumeRegistry, filename, volname, loadingOptions, fileList, preReadReader);
+}
+
 //----------------------------------------------------------------------------
 vtkMRMLScalarVolumeNode* vtkSlicerVolumesLogic::AddArchetypeScalarVolume(
     const char* filename, const char* volname, int loadingOptions, vtkStringArray *fileList)
@@ -545,7 +564,7 @@ vtkMRMLScalarVolumeNode* vtkSlicerVolumesLogic::AddArchetypeScalarVolume(
 vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume (
     const NodeSetFactoryRegistry& volumeRegistry,
     const char* filename, const char* volname, int loadingOptions,
-    vtkStringArray *fileList)
+    vtkStringArray *fileList, vtkITKArchetypeImageSeriesReader* preReadReader/*=nullptr*/)
 {
   if (this->GetMRMLScene() == nullptr)
   {
@@ -609,6 +628,16 @@ vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume (
 
       this->InitializeStorageNode(nodeSet.StorageNode, filename, fileList, testScene.GetPointer());
 
+      // Use the image that is already read if the file is read as a scalar volume
+      vtkMRMLVolumeArchetypeStorageNode* archetypeStorageNode =
+        vtkMRMLVolumeArchetypeStorageNode::SafeDownCast(nodeSet.StorageNode);
+      if (preReadReader && archetypeStorageNode
+        && !nodeSet.Node->IsA("vtkMRMLVectorVolumeNode")
+        && !nodeSet.Node->IsA("vtkMRMLDiffusionTensorVolumeNode"))
+      {
+        archetypeStorageNode->SetPreReadScalarImageReader(preReadReader);
+      }
+
       vtkDebugMacro("Attempt to read file as a volume of type "
                     << nodeSet.Node->GetNodeTagName() << " using "
                     << nodeSet.Node->GetClassName() << " [filename = " << filename << "]");
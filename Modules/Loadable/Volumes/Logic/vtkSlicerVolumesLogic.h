@@ -37,6 +37,7 @@
 
 #include "vtkSlicerVolumesModuleLogicExport.h"
 
+class vtkITKArchetypeImageSeriesReader;
 class vtkMRMLLabelMapVolumeNode;
 class vtkMRMLScalarVolumeNode;
 class vtkMRMLScalarVolumeDisplayNode;
@@ -139,6 +140,23 @@ public:
     return this->AddArchetypeVolume( filename, volname, 0, nullptr);
   }
 
+  /// Read the image of a scalar volume file, without accessing the scene or any MRML node.
+  /// It can be called from a background thread, for example to read multiple files in parallel.
+  /// The returned reader can be passed to AddArchetypeVolume() to add the volume to the scene
+  /// without reading the file again. Only local files are supported.
+  /// Returns nullptr if the file could not be read as a scalar volume.
+  /// The caller is responsible for deleting the returned reader.
+  /// \sa AddArchetypeVolume(const char*, const char*, int, vtkStringArray*, vtkITKArchetypeImageSeriesReader*)
+  VTK_NEWINSTANCE
+  static vtkITKArchetypeImageSeriesReader* PreReadArchetypeScalarVolume(
+    const char* filename, int loadingOptions, vtkStringArray* fileList);
+
+  /// Same as AddArchetypeVolume(filename, volname, loadingOptions, fileList) but if the file is
+  /// loaded as a scalar volume (or labelmap volume) then the image that was read by
+  /// PreReadArchetypeScalarVolume() is used instead of reading the file again.
+  vtkMRMLVolumeNode* AddArchetypeVolume(const char* filename, const char* volname, int loadingOptions,
+    vtkStringArray* fileList, vtkITKArchetypeImageSeriesReader* preReadReader);
+
   /// Load a scalar volume function directly, bypassing checks of all factories done in AddArchetypeVolume.
   /// \sa AddArchetypeVolume(const NodeSetFactoryRegistry& volumeRegistry, const char* filename, const char* volname, int loadingOptions, vtkStringArray *fileList)
   vtkMRMLScalarVolumeNode* AddArchetypeScalarVolume(const char* filename, const char* volname, int loadingOptions, vtkStringArray *fileList);
@@ -333,10 +351,12 @@ protected:
 
   /// Convenience function allowing to try to load a volume using a given
   /// list of \a NodeSetFactoryRegistry
+  /// If \a preReadReader is specified then it is used by the scalar volume storage nodes
+  /// instead of reading the file again.
   vtkMRMLVolumeNode* AddArchetypeVolume(
       const NodeSetFactoryRegistry& volumeRegistry,
       const char* filename, const char* volname, int loadingOptions,
-      vtkStringArray *fileList);
+      vtkStringArray *fileList, vtkITKArchetypeImageSeriesReader* preReadReader = nullptr);
 
 protected:
 
@@ -0,0 +1,213 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QDir>
+
+// Slicer includes
+#include <qMRMLWidget.h>
+#include <qSlicerApplication.h>
+#include <qSlicerCoreIOManager.h>
+#include <vtkSlicerApplicationLogic.h>
+
+// Models includes
+#include "qSlicerModelsModule.h"
+
+// Volumes includes
+#include "qSlicerVolumesModule.h"
+
+// MRML includes
+#include <vtkMRMLColorLogic.h>
+#include <vtkMRMLMessageCollection.h>
+#include <vtkMRMLModelNode.h>
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLVolumeArchetypeStorageNode.h>
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataWriter.h>
+#include <vtkSphereSource.h>
+#include <vtkXMLPolyDataWriter.h>
+
+// ITK includes
+#include <itkConfigure.h>
+#include <itkFactoryRegistration.h>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+int WriteTestVolume(const QString& fileName, int fileIndex)
+{
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(10 + fileIndex, 8, 6);
+  imageData->AllocateScalars(VTK_SHORT, 1);
+  imageData->GetPointData()->GetScalars()->Fill(fileIndex + 1);
+
+  vtkNew<vtkMRMLScene> writeScene;
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  writeScene->AddNode(volumeNode);
+  volumeNode->SetAndObserveImageData(imageData);
+  vtkNew<vtkMRMLVolumeArchetypeStorageNode> storageNode;
+  writeScene->AddNode(storageNode);
+  storageNode->SetFileName(fileName.toUtf8());
+  CHECK_BOOL(storageNode->WriteData(volumeNode) != 0, true);
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int WriteTestModel(const QString& fileName, int fileIndex, vtkIdType& numberOfPoints)
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(8 + fileIndex);
+  sphere->SetPhiResolution(6 + fileIndex);
+  sphere->Update();
+  numberOfPoints = sphere->GetOutput()->GetNumberOfPoints();
+  if (fileName.endsWith(".vtp"))
+  {
+    vtkNew<vtkXMLPolyDataWriter> writer;
+    writer->SetInputConnection(sphere->GetOutputPort());
+    writer->SetFileName(fileName.toUtf8());
+    CHECK_INT(writer->Write(), 1);
+  }
+  else
+  {
+    vtkNew<vtkPolyDataWriter> writer;
+    writer->SetInputConnection(sphere->GetOutputPort());
+    writer->SetFileName(fileName.toUtf8());
+    CHECK_INT(writer->Write(), 1);
+  }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int qSlicerVolumesReaderLoadNodesTest1(int argc, char* argv[])
+{
+  itk::itkFactoryRegistration();
+
+  qMRMLWidget::preInitializeApplication();
+  qSlicerApplication app(argc, argv);
+  qMRMLWidget::postInitializeApplication();
+
+  if (argc < 2)
+  {
+    std::cerr << "Usage: qSlicerVolumesReaderLoadNodesTest1 /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+  }
+  QDir tempDir(QString::fromUtf8(argv[1]));
+  CHECK_BOOL(tempDir.mkpath("qSlicerVolumesReaderLoadNodesTest1"), true);
+  CHECK_BOOL(tempDir.cd("qSlicerVolumesReaderLoadNodesTest1"), true);
+
+  vtkMRMLScene* scene = app.mrmlScene();
+  CHECK_NOT_NULL(scene);
+
+  // Add Color logic (used by volumes logic)
+  vtkNew<vtkMRMLColorLogic> colorLogic;
+  colorLogic->SetMRMLScene(scene);
+  colorLogic->SetMRMLApplicationLogic(app.applicationLogic());
+  app.applicationLogic()->SetModuleLogic("Colors", colorLogic);
+
+  // Modules register their readers in the application IO manager
+  qSlicerVolumesModule volumesModule;
+  volumesModule.setMRMLScene(scene);
+  volumesModule.initialize(app.applicationLogic());
+  qSlicerModelsModule modelsModule;
+  modelsModule.setMRMLScene(scene);
+  modelsModule.initialize(app.applicationLogic());
+
+  qSlicerCoreIOManager* ioManager = app.coreIOManager();
+
+  // Write volumes and models, interleaved, so that nodes of both types
+  // are read in parallel in the same loadNodes() call.
+  const int numberOfFiles = 8;
+  QList<qSlicerIO::IOProperties> files;
+  QList<vtkIdType> expectedNumberOfPoints;
+  for (int fileIndex = 0; fileIndex < numberOfFiles; ++fileIndex)
+  {
+    qSlicerIO::IOProperties properties;
+    vtkIdType numberOfPoints = 0;
+    QString name = QString("TestNode%1").arg(fileIndex);
+    if (fileIndex % 2 == 0)
+    {
+      QString fileName = tempDir.absoluteFilePath(name + ".nrrd");
+      CHECK_EXIT_SUCCESS(WriteTestVolume(fileName, fileIndex));
+      properties["fileName"] = fileName;
+      properties["fileType"] = QString("VolumeFile");
+    }
+    else
+    {
+      QString fileName = tempDir.absoluteFilePath(name + (fileIndex % 4 == 1 ? ".vtk" : ".vtp"));
+      CHECK_EXIT_SUCCESS(WriteTestModel(fileName, fileIndex, numberOfPoints));
+      properties["fileName"] = fileName;
+      properties["fileType"] = QString("ModelFile");
+    }
+    properties["name"] = name;
+    files << properties;
+    expectedNumberOfPoints << numberOfPoints;
+  }
+
+  vtkNew<vtkCollection> loadedNodes;
+  vtkNew<vtkMRMLMessageCollection> userMessages;
+  CHECK_BOOL(ioManager->loadNodes(files, loadedNodes, userMessages), true);
+  CHECK_INT(userMessages->GetNumberOfMessagesOfType(vtkCommand::ErrorEvent), 0);
+
+  // Nodes are added in the order of the files
+  CHECK_INT(loadedNodes->GetNumberOfItems(), numberOfFiles);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLScalarVolumeNode"), numberOfFiles / 2);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelNode"), numberOfFiles / 2);
+  for (int fileIndex = 0; fileIndex < numberOfFiles; ++fileIndex)
+  {
+    vtkMRMLNode* node = vtkMRMLNode::SafeDownCast(loadedNodes->GetItemAsObject(fileIndex));
+    CHECK_NOT_NULL(node);
+    CHECK_STRING(node->GetName(), QString("TestNode%1").arg(fileIndex).toUtf8().constData());
+    if (fileIndex % 2 == 0)
+    {
+      vtkMRMLScalarVolumeNode* volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(node);
+      CHECK_NOT_NULL(volumeNode);
+      CHECK_NOT_NULL(volumeNode->GetStorageNode());
+      CHECK_NOT_NULL(volumeNode->GetDisplayNode());
+      vtkImageData* imageData = volumeNode->GetImageData();
+      CHECK_NOT_NULL(imageData);
+      int* dimensions = imageData->GetDimensions();
+      CHECK_INT(dimensions[0], 10 + fileIndex);
+      CHECK_INT(dimensions[1], 8);
+      CHECK_INT(dimensions[2], 6);
+      double range[2] = { 0.0, 0.0 };
+      imageData->GetScalarRange(range);
+      CHECK_DOUBLE(range[0], fileIndex + 1);
+      CHECK_DOUBLE(range[1], fileIndex + 1);
+    }
+    else
+    {
+      vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(node);
+      CHECK_NOT_NULL(modelNode);
+      CHECK_NOT_NULL(modelNode->GetStorageNode());
+      CHECK_NOT_NULL(modelNode->GetDisplayNode());
+      CHECK_NOT_NULL(modelNode->GetPolyData());
+      CHECK_INT(modelNode->GetPolyData()->GetNumberOfPoints(), expectedNumberOfPoints[fileIndex]);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
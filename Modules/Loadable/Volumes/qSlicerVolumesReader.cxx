@@ -35,22 +35,54 @@
 #include "vtkSlicerVolumesLogic.h"
 
 // MRML includes
+#include <vtkCacheManager.h>
 #include <vtkMRMLDisplayNode.h>
 #include <vtkMRMLLabelMapVolumeNode.h>
 #include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
 #include <vtkMRMLSelectionNode.h>
 
 // VTK includes
+#include <vtkObjectFactory.h>
 #include <vtkSmartPointer.h>
 #include <vtkStringArray.h>
+#include <vtkWeakPointer.h>
 
 // ITK includes
 #include <itkArchetypeSeriesFileNames.h>
 
+// vtkITK includes
+#include <vtkITKArchetypeImageSeriesReader.h>
+
+//-----------------------------------------------------------------------------
+/// Stores the reader that read the image from file in a background thread.
+class vtkVolumesReaderBackgroundReadJob : public vtkObject
+{
+public:
+  static vtkVolumesReaderBackgroundReadJob* New();
+  vtkTypeMacro(vtkVolumesReaderBackgroundReadJob, vtkObject);
+
+  vtkSmartPointer<vtkITKArchetypeImageSeriesReader> Reader;
+
+protected:
+  vtkVolumesReaderBackgroundReadJob() = default;
+  ~vtkVolumesReaderBackgroundReadJob() override = default;
+  vtkVolumesReaderBackgroundReadJob(const vtkVolumesReaderBackgroundReadJob&) = delete;
+  void operator=(const vtkVolumesReaderBackgroundReadJob&) = delete;
+};
+
+vtkStandardNewMacro(vtkVolumesReaderBackgroundReadJob);
+
 //-----------------------------------------------------------------------------
 class qSlicerVolumesReaderPrivate
 {
   public:
+  static int loadingOptions(const qSlicerIO::IOProperties& properties);
+  static vtkSmartPointer<vtkStringArray> fileList(const qSlicerIO::IOProperties& properties);
+  static QString volumeName(const qSlicerIO::IOProperties& properties);
+  /// Set color and show the volume in slice views, as requested in the properties
+  void updateLoadedVolume(vtkMRMLVolumeNode* node, const qSlicerIO::IOProperties& properties);
+
   vtkSmartPointer<vtkSlicerVolumesLogic> Logic;
 };
 
@@ -119,17 +151,8 @@ qSlicerIOOptions* qSlicerVolumesReader::options()const
 }
 
 //-----------------------------------------------------------------------------
-bool qSlicerVolumesReader::load(const IOProperties& properties)
+int qSlicerVolumesReaderPrivate::loadingOptions(const qSlicerIO::IOProperties& properties)
 {
-  Q_D(qSlicerVolumesReader);
-  Q_ASSERT(properties.contains("fileName"));
-  QString fileName = properties["fileName"].toString();
-
-  QString name = QFileInfo(fileName).baseName();
-  if (properties.contains("name"))
-  {
-    name = properties["name"].toString();
-  }
   int options = 0;
   if (properties.contains("labelmap"))
   {
@@ -151,11 +174,12 @@ bool qSlicerVolumesReader::load(const IOProperties& properties)
   {
     options |= properties["discardOrientation"].toBool() ? 0x10 : 0x0;
   }
-  bool propagateVolumeSelection = true;
-  if (properties.contains("show"))
-  {
-    propagateVolumeSelection = properties["show"].toBool();
-  }
+  return options;
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkStringArray> qSlicerVolumesReaderPrivate::fileList(const qSlicerIO::IOProperties& properties)
+{
   vtkSmartPointer<vtkStringArray> fileList;
   if (properties.contains("fileNames"))
   {
@@ -165,6 +189,69 @@ bool qSlicerVolumesReader::load(const IOProperties& properties)
       fileList->InsertNextValue(file.toUtf8());
     }
   }
+  return fileList;
+}
+
+//-----------------------------------------------------------------------------
+QString qSlicerVolumesReaderPrivate::volumeName(const qSlicerIO::IOProperties& properties)
+{
+  if (properties.contains("name"))
+  {
+    return properties["name"].toString();
+  }
+  return QFileInfo(properties["fileName"].toString()).baseName();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerVolumesReaderPrivate::updateLoadedVolume(vtkMRMLVolumeNode* node, const qSlicerIO::IOProperties& properties)
+{
+  QString colorNodeID = properties.value("colorNodeID", QString()).toString();
+  if (!colorNodeID.isEmpty())
+  {
+    vtkMRMLVolumeDisplayNode* displayNode = node->GetVolumeDisplayNode();
+    if (displayNode)
+    {
+      displayNode->SetAndObserveColorNodeID(colorNodeID.toUtf8());
+    }
+  }
+  bool propagateVolumeSelection = true;
+  if (properties.contains("show"))
+  {
+    propagateVolumeSelection = properties["show"].toBool();
+  }
+  if (propagateVolumeSelection)
+  {
+    vtkSlicerApplicationLogic* appLogic =
+      this->Logic->GetApplicationLogic();
+    vtkMRMLSelectionNode* selectionNode =
+      appLogic ? appLogic->GetSelectionNode() : nullptr;
+    if (selectionNode)
+    {
+      if (vtkMRMLLabelMapVolumeNode::SafeDownCast(node))
+      {
+        selectionNode->SetActiveLabelVolumeID(node->GetID());
+      }
+      else
+      {
+        selectionNode->SetActiveVolumeID(node->GetID());
+      }
+      if (appLogic)
+      {
+        appLogic->PropagateVolumeSelection(); // includes FitSliceToAll by default
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerVolumesReader::load(const IOProperties& properties)
+{
+  Q_D(qSlicerVolumesReader);
+  Q_ASSERT(properties.contains("fileName"));
+  QString fileName = properties["fileName"].toString();
+  QString name = d->volumeName(properties);
+  int options = d->loadingOptions(properties);
+  vtkSmartPointer<vtkStringArray> fileList = d->fileList(properties);
   Q_ASSERT(d->Logic);
   // Weak pointer is used because the node may be deleted if the scene is closed
   // right after reading.
@@ -175,37 +262,7 @@ bool qSlicerVolumesReader::load(const IOProperties& properties)
     fileList.GetPointer());
   if (node)
   {
-    QString colorNodeID = properties.value("colorNodeID", QString()).toString();
-    if (!colorNodeID.isEmpty())
-    {
-      vtkMRMLVolumeDisplayNode* displayNode = node->GetVolumeDisplayNode();
-      if (displayNode)
-      {
-        displayNode->SetAndObserveColorNodeID(colorNodeID.toUtf8());
-      }
-    }
-    if (propagateVolumeSelection)
-    {
-      vtkSlicerApplicationLogic* appLogic =
-        d->Logic->GetApplicationLogic();
-      vtkMRMLSelectionNode* selectionNode =
-        appLogic ? appLogic->GetSelectionNode() : nullptr;
-      if (selectionNode)
-      {
-        if (vtkMRMLLabelMapVolumeNode::SafeDownCast(node))
-        {
-          selectionNode->SetActiveLabelVolumeID(node->GetID());
-        }
-        else
-        {
-          selectionNode->SetActiveVolumeID(node->GetID());
-        }
-        if (appLogic)
-        {
-          appLogic->PropagateVolumeSelection(); // includes FitSliceToAll by default
-        }
-      }
-    }
+    d->updateLoadedVolume(node, properties);
     this->setLoadedNodes(QStringList(QString(node->GetID())));
   }
   else
@@ -215,6 +272,73 @@ bool qSlicerVolumesReader::load(const IOProperties& properties)
   return node != nullptr;
 }
 
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkObject> qSlicerVolumesReader::prepareBackgroundRead(const IOProperties& properties)
+{
+  Q_D(qSlicerVolumesReader);
+  if (!d->Logic || !this->mrmlScene())
+  {
+    return nullptr;
+  }
+  vtkCacheManager* cacheManager = this->mrmlScene()->GetCacheManager();
+  if (cacheManager && cacheManager->IsRemoteReference(properties["fileName"].toString().toUtf8()))
+  {
+    // Remote files are downloaded by load()
+    return nullptr;
+  }
+  return vtkSmartPointer<vtkVolumesReaderBackgroundReadJob>::New();
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerVolumesReader::readData(const IOProperties& properties, vtkObject* readJob,
+  vtkMRMLMessageCollection* userMessages)const
+{
+  Q_UNUSED(userMessages);
+  Q_D(const qSlicerVolumesReader);
+  // Only the image is read here, nodes are created in loadData() (in the main thread).
+  // If the file cannot be read as a scalar volume then it is loaded by load(),
+  // which reports the errors.
+  vtkVolumesReaderBackgroundReadJob* job = vtkVolumesReaderBackgroundReadJob::SafeDownCast(readJob);
+  if (!job)
+  {
+    return false;
+  }
+  vtkSmartPointer<vtkStringArray> fileList = d->fileList(properties);
+  job->Reader.TakeReference(vtkSlicerVolumesLogic::PreReadArchetypeScalarVolume(
+    properties["fileName"].toString().toUtf8(), d->loadingOptions(properties), fileList));
+  return (job->Reader != nullptr);
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerVolumesReader::loadData(const IOProperties& properties, vtkObject* readJob)
+{
+  Q_D(qSlicerVolumesReader);
+  this->setLoadedNodes(QStringList());
+  vtkVolumesReaderBackgroundReadJob* job = vtkVolumesReaderBackgroundReadJob::SafeDownCast(readJob);
+  if (!d->Logic || !job || !job->Reader)
+  {
+    return false;
+  }
+  vtkSmartPointer<vtkStringArray> fileList = d->fileList(properties);
+  // Weak pointer is used because the node may be deleted if the scene is closed
+  // right after reading.
+  vtkWeakPointer<vtkMRMLVolumeNode> node = d->Logic->AddArchetypeVolume(
+    properties["fileName"].toString().toUtf8(),
+    d->volumeName(properties).toUtf8(),
+    d->loadingOptions(properties),
+    fileList.GetPointer(),
+    job->Reader);
+  // Release the reader, the volume node keeps a reference to the image
+  job->Reader = nullptr;
+  if (!node)
+  {
+    return false;
+  }
+  d->updateLoadedVolume(node, properties);
+  this->setLoadedNodes(QStringList(QString(node->GetID())));
+  return true;
+}
+
 //-----------------------------------------------------------------------------
 bool qSlicerVolumesReader::examineFileInfoList(QFileInfoList &fileInfoList, QFileInfo &archetypeFileInfo, qSlicerIO::IOProperties &ioProperties)const
 {
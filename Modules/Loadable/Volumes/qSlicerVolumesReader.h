@@ -47,6 +47,14 @@ public:
 
   bool load(const IOProperties& properties) override;
 
+  /// Images of local scalar volume files are read in a background thread,
+  /// volume nodes are created in the main thread by loadData().
+  /// \sa qSlicerFileReader::prepareBackgroundRead()
+  vtkSmartPointer<vtkObject> prepareBackgroundRead(const IOProperties& properties) override;
+  bool readData(const IOProperties& properties, vtkObject* readJob,
+    vtkMRMLMessageCollection* userMessages)const override;
+  bool loadData(const IOProperties& properties, vtkObject* readJob) override;
+
   /// Implements the file list examination for the corresponding method in the core
   /// IO manager.
   /// \sa qSlicerCoreIOManager
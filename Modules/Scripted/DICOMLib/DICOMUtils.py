@@ -802,39 +802,45 @@ def loadLoadables(loadablesByPlugin, messages=None, progressCallback=None):
 
     sceneObserverTag = slicer.mrmlScene.AddObserver(slicer.vtkMRMLScene.NodeAddedEvent, onNodeAdded)
 
-    for step, (loadable, plugin) in enumerate(selectedLoadables.items(), start=1):
-        if progressCallback:
-            cancelled = progressCallback(loadable.name, step * 100 / len(selectedLoadables))
-            if cancelled:
-                break
+    # Batch subject hierarchy updates so that views are refreshed only once after all series are loaded
+    shNode = slicer.mrmlScene.GetSubjectHierarchyNode()
+    shNode.StartBatchUpdate()
+    try:
+        for step, (loadable, plugin) in enumerate(selectedLoadables.items(), start=1):
+            if progressCallback:
+                cancelled = progressCallback(loadable.name, step * 100 / len(selectedLoadables))
+                if cancelled:
+                    break
 
-        try:
-            loadSuccess = plugin.load(loadable)
-        except:
-            loadSuccess = False
-            import traceback
-            logging.error("DICOM plugin failed to load '"
-                          + loadable.name + "' as a '" + plugin.loadType + "'.\n"
-                          + traceback.format_exc())
-        if (not loadSuccess) and (messages is not None):
-            messages.append(f"Could not load: {loadable.name} as a {plugin.loadType}")
+            try:
+                loadSuccess = plugin.load(loadable)
+            except:
+                loadSuccess = False
+                import traceback
+                logging.error("DICOM plugin failed to load '"
+                              + loadable.name + "' as a '" + plugin.loadType + "'.\n"
+                              + traceback.format_exc())
+            if (not loadSuccess) and (messages is not None):
+                messages.append(f"Could not load: {loadable.name} as a {plugin.loadType}")
 
-        cancelled = False
-        try:
-            # DICOM reader plugins (for example, in PETDICOM extension) may generate additional DICOM files
-            # during loading. These must be added to the database.
-            for derivedItem in loadable.derivedItems:
-                indexer = ctk.ctkDICOMIndexer()
-                if progressCallback:
-                    cancelled = progressCallback(f"{loadable.name} ({derivedItem})", step * 100 / len(selectedLoadables))
-                    if cancelled:
-                        break
-                indexer.addFile(slicer.dicomDatabase, derivedItem)
-        except AttributeError:
-            # no derived items or some other attribute error
-            pass
-        if cancelled:
-            break
+            cancelled = False
+            try:
+                # DICOM reader plugins (for example, in PETDICOM extension) may generate additional DICOM files
+                # during loading. These must be added to the database.
+                for derivedItem in loadable.derivedItems:
+                    indexer = ctk.ctkDICOMIndexer()
+                    if progressCallback:
+                        cancelled = progressCallback(f"{loadable.name} ({derivedItem})", step * 100 / len(selectedLoadables))
+                        if cancelled:
+                            break
+                    indexer.addFile(slicer.dicomDatabase, derivedItem)
+            except AttributeError:
+                # no derived items or some other attribute error
+                pass
+            if cancelled:
+                break
+    finally:
+        shNode.EndBatchUpdate()
 
     slicer.mrmlScene.RemoveObserver(sceneObserverTag)
 
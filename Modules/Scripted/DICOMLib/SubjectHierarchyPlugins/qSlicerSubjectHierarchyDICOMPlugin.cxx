@@ -579,11 +579,13 @@ void qSlicerSubjectHierarchyDICOMPlugin::openDICOMExportDialog()
         }
 
         // Move selected item and all items it references under the study
+        shNode->StartBatchUpdate();
         shNode->SetItemParent(currentItemID, studyItemID);
         for (std::vector<vtkIdType>::iterator itemIt=referencedItems.begin(); itemIt!=referencedItems.end(); itemIt++)
         {
           shNode->SetItemParent(*itemIt, studyItemID);
         }
+        shNode->EndBatchUpdate();
       }
     }
     else